@@ -52,6 +52,18 @@ public:
         run();
     }
 
+    AsyncQObject(QAbstractEventDispatcher *pEventDispatcher, Args... args) :
+        m_thread(new QThread),
+        m_args(std::forward<Args>(args)...),
+        m_object(nullptr, &deleteQObjectLater)
+    {
+        if (pEventDispatcher)
+            m_thread->setEventDispatcher(pEventDispatcher);
+        QObject::connect(m_thread.get(), &QThread::started, [this]() {this->on_thread_started();});
+        QObject::connect(m_thread.get(), &QThread::finished, [this]() {this->on_thread_finished();});
+        run();
+    }
+
     ~AsyncQObject()
     {
         stop();
@@ -0,0 +1,138 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+#include "BufferPool.h"
+#include "NoDestroy.h"
+#include <algorithm>
+
+
+namespace Kourier
+{
+
+BufferPool::BufferPool(size_t blockSize, size_t lowWatermark, size_t highWatermark) :
+    m_blockSize(blockSize),
+    m_lowWatermark(std::min(lowWatermark, highWatermark)),
+    m_highWatermark(highWatermark)
+{
+    assert(m_blockSize > 0);
+}
+
+BufferPool::~BufferPool()
+{
+    trimIdleBlocks(m_idleBlocks.size());
+}
+
+// The thread's reference to its pool is dropped when the thread finishes. Pools registered
+// in a BufferPoolRegistry outlive their threads so that their statistics can still be read.
+static std::shared_ptr<BufferPool> *sharedThreadInstanceHolder()
+{
+    static thread_local NoDestroy<std::shared_ptr<BufferPool>*> pThreadLocalBufferPool(new std::shared_ptr<BufferPool>(new BufferPool));
+    static thread_local NoDestroyPtrDeleter<std::shared_ptr<BufferPool>*> bufferPoolDeleter(pThreadLocalBufferPool);
+    return pThreadLocalBufferPool();
+}
+
+BufferPool *BufferPool::threadInstance()
+{
+    auto pBufferPool = sharedThreadInstanceHolder();
+    return pBufferPool ? pBufferPool->get() : nullptr;
+}
+
+std::shared_ptr<BufferPool> BufferPool::sharedThreadInstance()
+{
+    auto pBufferPool = sharedThreadInstanceHolder();
+    return pBufferPool ? *pBufferPool : std::shared_ptr<BufferPool>{};
+}
+
+char *BufferPool::acquireBlock()
+{
+    char *pBlock = nullptr;
+    if (!m_idleBlocks.empty())
+    {
+        pBlock = m_idleBlocks.back();
+        m_idleBlocks.pop_back();
+        m_idleBlockCount.store(m_idleBlocks.size(), std::memory_order_relaxed);
+    }
+    else
+    {
+        pBlock = new char[m_blockSize];
+        const auto blockCount = m_blocksInUse.load(std::memory_order_relaxed) + 1 + m_idleBlocks.size();
+        if (blockCount > m_peakBlockCount.load(std::memory_order_relaxed))
+            m_peakBlockCount.store(blockCount, std::memory_order_relaxed);
+    }
+    m_blocksInUse.fetch_add(1, std::memory_order_relaxed);
+    return pBlock;
+}
+
+void BufferPool::releaseBlock(char *pBlock)
+{
+    assert(pBlock != nullptr && m_blocksInUse.load(std::memory_order_relaxed) > 0);
+    m_blocksInUse.fetch_sub(1, std::memory_order_relaxed);
+    m_idleBlocks.push_back(pBlock);
+    // Idle blocks are given back to the system in batches, once they exceed the high watermark.
+    if (m_idleBlocks.size() > m_highWatermark)
+        trimIdleBlocks(m_idleBlocks.size() - m_lowWatermark);
+    m_idleBlockCount.store(m_idleBlocks.size(), std::memory_order_relaxed);
+}
+
+void BufferPool::setWatermarks(size_t lowWatermark, size_t highWatermark)
+{
+    m_highWatermark = highWatermark;
+    m_lowWatermark = std::min(lowWatermark, highWatermark);
+    if (m_idleBlocks.size() > m_highWatermark)
+        trimIdleBlocks(m_idleBlocks.size() - m_lowWatermark);
+    m_idleBlockCount.store(m_idleBlocks.size(), std::memory_order_relaxed);
+}
+
+BufferPool::Statistics BufferPool::statistics() const
+{
+    Statistics statistics;
+    statistics.blockSize = m_blockSize;
+    statistics.blocksInUse = m_blocksInUse.load(std::memory_order_relaxed);
+    statistics.idleBlocks = m_idleBlockCount.load(std::memory_order_relaxed);
+    statistics.peakBlockCount = m_peakBlockCount.load(std::memory_order_relaxed);
+    statistics.unpooledBytes = m_unpooledBytes.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+void BufferPool::trimIdleBlocks(size_t count)
+{
+    assert(count <= m_idleBlocks.size());
+    for (size_t i = 0; i < count; ++i)
+    {
+        delete [] m_idleBlocks.back();
+        m_idleBlocks.pop_back();
+    }
+}
+
+void BufferPoolRegistry::add(std::shared_ptr<BufferPool> pBufferPool)
+{
+    if (!pBufferPool)
+        return;
+    QMutexLocker locker(&m_lock);
+    m_bufferPools.push_back(pBufferPool);
+}
+
+std::vector<BufferPool::Statistics> BufferPoolRegistry::statistics() const
+{
+    std::vector<BufferPool::Statistics> statistics;
+    QMutexLocker locker(&m_lock);
+    statistics.reserve(m_bufferPools.size());
+    for (const auto &pBufferPool : m_bufferPools)
+        statistics.push_back(pBufferPool->statistics());
+    return statistics;
+}
+
+}
@@ -0,0 +1,96 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef KOURIER_BUFFER_POOL_H
+#define KOURIER_BUFFER_POOL_H
+
+#include "SDK.h"
+#include <QMutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+
+namespace Kourier
+{
+
+// Blocks are allocated one by one instead of being carved from larger slabs, so that
+// trimming idle blocks down to the low watermark always gives their memory back to the system.
+class KOURIER_EXPORT BufferPool
+{
+public:
+    struct Statistics
+    {
+        size_t blockSize = 0;
+        size_t blocksInUse = 0;
+        size_t idleBlocks = 0;
+        size_t peakBlockCount = 0;
+        size_t unpooledBytes = 0;
+        inline size_t pooledBytes() const {return (blocksInUse + idleBlocks) * blockSize;}
+    };
+    BufferPool(size_t blockSize = defaultBlockSize(),
+               size_t lowWatermark = defaultLowWatermark(),
+               size_t highWatermark = defaultHighWatermark());
+    ~BufferPool();
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+    static BufferPool *threadInstance();
+    static std::shared_ptr<BufferPool> sharedThreadInstance();
+    inline size_t blockSize() const {return m_blockSize;}
+    char *acquireBlock();
+    void releaseBlock(char *pBlock);
+    inline size_t lowWatermark() const {return m_lowWatermark;}
+    inline size_t highWatermark() const {return m_highWatermark;}
+    void setWatermarks(size_t lowWatermark, size_t highWatermark);
+    inline void addUnpooledBytes(size_t count) {m_unpooledBytes.fetch_add(count, std::memory_order_relaxed);}
+    inline void removeUnpooledBytes(size_t count) {m_unpooledBytes.fetch_sub(count, std::memory_order_relaxed);}
+    Statistics statistics() const;
+    static constexpr size_t defaultBlockSize() {return 4096;}
+    static constexpr size_t defaultLowWatermark() {return 64;}
+    static constexpr size_t defaultHighWatermark() {return 1024;}
+
+private:
+    void trimIdleBlocks(size_t count);
+
+private:
+    const size_t m_blockSize;
+    size_t m_lowWatermark;
+    size_t m_highWatermark;
+    std::vector<char*> m_idleBlocks;
+    std::atomic_size_t m_blocksInUse = 0;
+    std::atomic_size_t m_idleBlockCount = 0;
+    std::atomic_size_t m_peakBlockCount = 0;
+    std::atomic_size_t m_unpooledBytes = 0;
+};
+
+class KOURIER_EXPORT BufferPoolRegistry
+{
+public:
+    BufferPoolRegistry() = default;
+    ~BufferPoolRegistry() = default;
+    BufferPoolRegistry(const BufferPoolRegistry &) = delete;
+    BufferPoolRegistry &operator=(const BufferPoolRegistry &) = delete;
+    void add(std::shared_ptr<BufferPool> pBufferPool);
+    std::vector<BufferPool::Statistics> statistics() const;
+
+private:
+    mutable QMutex m_lock;
+    std::vector<std::shared_ptr<BufferPool>> m_bufferPools;
+};
+
+}
+
+#endif // KOURIER_BUFFER_POOL_H
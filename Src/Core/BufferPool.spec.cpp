@@ -0,0 +1,310 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+#include "BufferPool.h"
+#include "RingBuffer.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <Spectator>
+
+
+using Kourier::BufferPool;
+using Kourier::BufferPoolRegistry;
+using Kourier::RingBuffer;
+
+
+SCENARIO("BufferPool reuses released blocks")
+{
+    GIVEN("a buffer pool")
+    {
+        BufferPool bufferPool(1024, 2, 4);
+        REQUIRE(bufferPool.blockSize() == 1024);
+        REQUIRE(bufferPool.statistics().blocksInUse == 0);
+        REQUIRE(bufferPool.statistics().idleBlocks == 0);
+
+        WHEN("a block is acquired and released")
+        {
+            auto *pBlock = bufferPool.acquireBlock();
+            REQUIRE(pBlock != nullptr);
+            REQUIRE(bufferPool.statistics().blocksInUse == 1);
+            bufferPool.releaseBlock(pBlock);
+
+            THEN("pool keeps the block idle")
+            {
+                const auto statistics = bufferPool.statistics();
+                REQUIRE(statistics.blocksInUse == 0);
+                REQUIRE(statistics.idleBlocks == 1);
+                REQUIRE(statistics.peakBlockCount == 1);
+                REQUIRE(statistics.pooledBytes() == 1024);
+
+                AND_WHEN("a block is acquired again")
+                {
+                    auto *pReusedBlock = bufferPool.acquireBlock();
+
+                    THEN("pool returns the idle block")
+                    {
+                        REQUIRE(pReusedBlock == pBlock);
+                        REQUIRE(bufferPool.statistics().blocksInUse == 1);
+                        REQUIRE(bufferPool.statistics().idleBlocks == 0);
+                        REQUIRE(bufferPool.statistics().peakBlockCount == 1);
+                        bufferPool.releaseBlock(pReusedBlock);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+SCENARIO("BufferPool trims idle blocks down to low watermark when they exceed high watermark")
+{
+    GIVEN("a buffer pool with low and high watermarks")
+    {
+        const auto watermarks = GENERATE(AS(std::pair<size_t, size_t>), {0, 0}, {1, 3}, {2, 4}, {4, 4}, {8, 2});
+        BufferPool bufferPool(512, watermarks.first, watermarks.second);
+        const auto expectedLowWatermark = std::min(watermarks.first, watermarks.second);
+        REQUIRE(bufferPool.lowWatermark() == expectedLowWatermark);
+        REQUIRE(bufferPool.highWatermark() == watermarks.second);
+
+        WHEN("blocks are released")
+        {
+            std::vector<char*> blocks;
+            const size_t blockCount = 16;
+            for (size_t i = 0; i < blockCount; ++i)
+                blocks.push_back(bufferPool.acquireBlock());
+            REQUIRE(bufferPool.statistics().blocksInUse == blockCount);
+            REQUIRE(bufferPool.statistics().peakBlockCount == blockCount);
+            for (size_t i = 0; i < blockCount; ++i)
+            {
+                bufferPool.releaseBlock(blocks[i]);
+                const auto statistics = bufferPool.statistics();
+                REQUIRE(statistics.blocksInUse == blockCount - i - 1);
+                REQUIRE(statistics.idleBlocks <= watermarks.second);
+            }
+
+            THEN("pool never keeps more idle blocks than the high watermark")
+            {
+                const auto statistics = bufferPool.statistics();
+                REQUIRE(statistics.blocksInUse == 0);
+                REQUIRE(statistics.idleBlocks >= expectedLowWatermark);
+                REQUIRE(statistics.idleBlocks <= watermarks.second);
+                REQUIRE(statistics.peakBlockCount == blockCount);
+            }
+        }
+
+        WHEN("watermarks are lowered while the pool keeps idle blocks")
+        {
+            for (size_t i = 0; i < 4; ++i)
+                bufferPool.releaseBlock(bufferPool.acquireBlock());
+            bufferPool.setWatermarks(0, 0);
+
+            THEN("pool releases all idle blocks")
+            {
+                REQUIRE(bufferPool.lowWatermark() == 0);
+                REQUIRE(bufferPool.highWatermark() == 0);
+                REQUIRE(bufferPool.statistics().idleBlocks == 0);
+            }
+        }
+    }
+}
+
+
+SCENARIO("BufferPool accounts for bytes that are not stored in pool blocks")
+{
+    GIVEN("a buffer pool")
+    {
+        BufferPool bufferPool;
+
+        WHEN("unpooled bytes are added and removed")
+        {
+            bufferPool.addUnpooledBytes(10000);
+            bufferPool.addUnpooledBytes(5000);
+            REQUIRE(bufferPool.statistics().unpooledBytes == 15000);
+            bufferPool.removeUnpooledBytes(10000);
+
+            THEN("pool reports the remaining unpooled bytes")
+            {
+                REQUIRE(bufferPool.statistics().unpooledBytes == 5000);
+                REQUIRE(bufferPool.statistics().pooledBytes() == 0);
+            }
+        }
+    }
+}
+
+
+SCENARIO("BufferPoolRegistry reports statistics of registered pools")
+{
+    GIVEN("a registry with registered pools")
+    {
+        BufferPoolRegistry registry;
+        REQUIRE(registry.statistics().empty());
+        std::shared_ptr<BufferPool> pFirstPool(new BufferPool(1024));
+        std::shared_ptr<BufferPool> pSecondPool(new BufferPool(2048));
+        registry.add(pFirstPool);
+        registry.add(pSecondPool);
+        registry.add({});
+
+        WHEN("blocks are acquired from pools")
+        {
+            auto *pFirstBlock = pFirstPool->acquireBlock();
+            auto *pSecondBlock = pSecondPool->acquireBlock();
+            auto *pThirdBlock = pSecondPool->acquireBlock();
+            const auto statistics = registry.statistics();
+            pFirstPool->releaseBlock(pFirstBlock);
+            pSecondPool->releaseBlock(pSecondBlock);
+            pSecondPool->releaseBlock(pThirdBlock);
+
+            THEN("registry reports statistics of each pool in registration order")
+            {
+                REQUIRE(statistics.size() == 2);
+                REQUIRE(statistics[0].blockSize == 1024);
+                REQUIRE(statistics[0].blocksInUse == 1);
+                REQUIRE(statistics[1].blockSize == 2048);
+                REQUIRE(statistics[1].blocksInUse == 2);
+            }
+        }
+    }
+}
+
+
+SCENARIO("BufferPool provides a pool for each thread")
+{
+    GIVEN("the current thread's pool")
+    {
+        auto *pBufferPool = BufferPool::threadInstance();
+
+        WHEN("the shared instance is fetched")
+        {
+            const auto pSharedBufferPool = BufferPool::sharedThreadInstance();
+
+            THEN("both refer to the same pool")
+            {
+                REQUIRE(pBufferPool != nullptr);
+                REQUIRE(pSharedBufferPool.get() == pBufferPool);
+                REQUIRE(pBufferPool->blockSize() == BufferPool::defaultBlockSize());
+            }
+        }
+    }
+}
+
+
+SCENARIO("RingBuffer borrows storage from its pool only while it holds data")
+{
+    GIVEN("a ring buffer that uses a buffer pool")
+    {
+        std::shared_ptr<BufferPool> pBufferPool(new BufferPool(4096, 4, 8));
+        const auto capacity = GENERATE(AS(size_t), 0, 16, 1024, 8192);
+        RingBuffer ringBuffer(capacity, pBufferPool);
+        REQUIRE(ringBuffer.bufferPool() == pBufferPool);
+
+        THEN("ring buffer holds no storage until data is written to it")
+        {
+            REQUIRE(!ringBuffer.hasStorage());
+            REQUIRE(ringBuffer.isEmpty());
+            REQUIRE(pBufferPool->statistics().blocksInUse == 0);
+            REQUIRE(pBufferPool->statistics().unpooledBytes == 0);
+        }
+
+        WHEN("data that fits in a block is written")
+        {
+            const std::string data("abcdefghijklmnopqrstuvwxyz");
+            REQUIRE(ringBuffer.write(data.data(), data.size()) == (capacity == 0 ? data.size() : std::min(capacity, data.size())));
+
+            THEN("ring buffer stores data in a pool block")
+            {
+                REQUIRE(ringBuffer.hasStorage());
+                REQUIRE(pBufferPool->statistics().blocksInUse == 1);
+                REQUIRE(pBufferPool->statistics().unpooledBytes == 0);
+                REQUIRE(ringBuffer.peekAll() == std::string_view(data).substr(0, ringBuffer.size()));
+
+                AND_WHEN("storage is released while ring buffer holds data")
+                {
+                    const auto released = ringBuffer.releaseStorage();
+
+                    THEN("ring buffer keeps its storage")
+                    {
+                        REQUIRE(!released);
+                        REQUIRE(ringBuffer.hasStorage());
+                        REQUIRE(pBufferPool->statistics().blocksInUse == 1);
+                    }
+                }
+
+                AND_WHEN("data is read and storage is released")
+                {
+                    ringBuffer.popFront(ringBuffer.size());
+                    const auto released = ringBuffer.releaseStorage();
+
+                    THEN("ring buffer gives the block back to the pool")
+                    {
+                        REQUIRE(released);
+                        REQUIRE(!ringBuffer.hasStorage());
+                        REQUIRE(ringBuffer.capacity() == capacity);
+                        REQUIRE(pBufferPool->statistics().blocksInUse == 0);
+                        REQUIRE(pBufferPool->statistics().idleBlocks == 1);
+
+                        AND_WHEN("data is written again")
+                        {
+                            REQUIRE(ringBuffer.write(data.data(), 10) == std::min<size_t>(capacity == 0 ? 10 : capacity, 10));
+
+                            THEN("ring buffer borrows the idle block")
+                            {
+                                REQUIRE(ringBuffer.hasStorage());
+                                REQUIRE(pBufferPool->statistics().blocksInUse == 1);
+                                REQUIRE(pBufferPool->statistics().idleBlocks == 0);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        WHEN("data larger than a block is written")
+        {
+            const std::string data(6000, 'a');
+            const auto dataWritten = ringBuffer.write(data.data(), data.size());
+            REQUIRE(dataWritten == (capacity == 0 ? data.size() : std::min(capacity, data.size())));
+
+            THEN("ring buffer stores data in a pool block only if it fits in a block")
+            {
+                REQUIRE(ringBuffer.hasStorage());
+                if (dataWritten < pBufferPool->blockSize())
+                {
+                    REQUIRE(pBufferPool->statistics().blocksInUse == 1);
+                    REQUIRE(pBufferPool->statistics().unpooledBytes == 0);
+                }
+                else
+                {
+                    REQUIRE(pBufferPool->statistics().blocksInUse == 0);
+                    REQUIRE(pBufferPool->statistics().unpooledBytes > dataWritten);
+                }
+
+                AND_WHEN("data is read and storage is released")
+                {
+                    ringBuffer.clear();
+                    ringBuffer.releaseStorage();
+
+                    THEN("ring buffer holds no memory")
+                    {
+                        REQUIRE(!ringBuffer.hasStorage());
+                        REQUIRE(pBufferPool->statistics().blocksInUse == 0);
+                        REQUIRE(pBufferPool->statistics().unpooledBytes == 0);
+                    }
+                }
+            }
+        }
+    }
+}
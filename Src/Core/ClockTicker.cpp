@@ -18,7 +18,10 @@
 #include "ClockTicker.h"
 #include "UnixUtils.h"
 #include "EpollEventNotifier.h"
+#include <algorithm>
 #include <chrono>
+#include <cerrno>
+#include <linux/io_uring.h>
 #include <sys/timerfd.h>
 
 
@@ -54,12 +57,44 @@ void ClockTicker::setEnabled(bool enabled)
     }
 }
 
+// Single-shot ticks are armed on the timer file descriptor at an absolute time of the
+// monotonic clock, which is the clock behind std::chrono::steady_clock on Linux.
+void ClockTicker::scheduleTick(std::chrono::nanoseconds tickTime)
+{
+    if (m_enabled && !m_isSingleShot)
+        deactivateTicker();
+    m_enabled = true;
+    m_isSingleShot = true;
+    m_scheduledTickTime = tickTime;
+    struct itimerspec newValue{0,0,0,0};
+    struct itimerspec oldValue{0,0,0,0};
+    using SecType = decltype(newValue.it_value.tv_sec);
+    using NSecType = decltype(newValue.it_value.tv_nsec);
+    newValue.it_value.tv_sec = static_cast<SecType>(std::max<int64_t>(tickTime.count(), 1) / 1000000000);
+    newValue.it_value.tv_nsec = static_cast<NSecType>(std::max<int64_t>(tickTime.count(), 1) % 1000000000);
+    if (-1 == timerfd_settime(m_timerFd, TFD_TIMER_ABSTIME, &newValue, &oldValue))
+        qFatal("ClockTicker::scheduleTick failed. Failed to set timer. Exiting.");
+}
+
 void ClockTicker::onEvent(uint32_t epollEvents)
 {
     if (epollEvents & EPOLLIN)
     {
         uint64_t expiryCount = 0;
         UnixUtils::safeRead(m_timerFd, (char*)&expiryCount, sizeof(expiryCount));
+        if (expiryCount > 0)
+            ++m_wakeupCount;
+        if (m_isSingleShot)
+        {
+            if (expiryCount > 0 && m_enabled)
+            {
+                m_enabled = false;
+                m_isSingleShot = false;
+                m_currentTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+                tick();
+            }
+            return;
+        }
         for (auto i = 0; i < expiryCount; ++i)
         {
             m_currentTime += m_resolution;
@@ -68,9 +103,30 @@ void ClockTicker::onEvent(uint32_t epollEvents)
     }
 }
 
+// Multishot timeouts can post several expirations before they are processed. Ticks are
+// emitted for all resolution periods elapsed since the last tick, as with timer file descriptors.
+void ClockTicker::onCompletion(int32_t result, uint32_t flags)
+{
+    if (result != -ETIME)
+        return;
+    ++m_wakeupCount;
+    const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+    while ((m_currentTime + m_resolution) <= now && m_enabled)
+    {
+        m_currentTime += m_resolution;
+        tick();
+    }
+    if (!(flags & IORING_CQE_F_MORE) && m_enabled)
+        startTimeout(m_resolution);
+}
+
+// On threads that use io_uring, tickers use a multishot timeout on the ring instead of
+// arming their timer file descriptor, saving the read syscall on every expiration.
 void ClockTicker::activateTicker()
 {
     m_currentTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch());
+    if (startTimeout(m_resolution))
+        return;
     // Setting time
     struct itimerspec newValue{0,0,0,0};
     struct itimerspec oldValue{0,0,0,0};
@@ -87,6 +143,12 @@ void ClockTicker::activateTicker()
 void ClockTicker::deactivateTicker()
 {
     m_currentTime = std::chrono::milliseconds(0);
+    m_isSingleShot = false;
+    if (hasRingOperation())
+    {
+        cancelRingOperation();
+        return;
+    }
     uint64_t tmp = 0;
     UnixUtils::safeRead(m_timerFd, (char*)&tmp, sizeof(tmp));
     struct itimerspec newValue{0,0,0,0};
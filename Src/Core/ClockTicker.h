@@ -34,19 +34,27 @@ public:
     Signal tick();
     void setEnabled(bool enabled);
     inline bool isEnabled() const {return m_enabled;}
+    void scheduleTick(std::chrono::nanoseconds tickTime);
+    inline std::chrono::nanoseconds scheduledTickTime() const {return m_scheduledTickTime;}
+    inline bool isSingleShot() const {return m_isSingleShot;}
     inline std::chrono::milliseconds currentTime() const {return m_currentTime;}
+    inline uint64_t wakeupCount() const {return m_wakeupCount;}
     int64_t fileDescriptor() const override {return m_timerFd;}
 
 private:
     void onEvent(uint32_t epollEvents) override;
+    void onCompletion(int32_t result, uint32_t flags) override;
     void activateTicker();
     void deactivateTicker();
 
 private:
     const std::chrono::milliseconds m_resolution = std::chrono::milliseconds(0);
     std::chrono::milliseconds m_currentTime = std::chrono::milliseconds(0);
+    std::chrono::nanoseconds m_scheduledTickTime = std::chrono::nanoseconds(0);
     const int64_t m_timerFd;
+    uint64_t m_wakeupCount = 0;
     bool m_enabled = false;
+    bool m_isSingleShot = false;
 };
 
 }
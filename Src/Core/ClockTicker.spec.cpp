@@ -18,6 +18,7 @@
 #include "ClockTicker.h"
 #include <Spectator>
 #include <QSemaphore>
+#include <QDeadlineTimer>
 #include <chrono>
 #include <cmath>
 
@@ -61,3 +62,42 @@ SCENARIO("ClockTicker ticks at specified resolution")
         }
     }
 }
+
+
+SCENARIO("ClockTicker ticks once at scheduled time")
+{
+    GIVEN("a clock ticker")
+    {
+        ClockTicker clockTicker(1ms);
+
+        WHEN("a tick is scheduled")
+        {
+            const auto delay = GENERATE(AS(std::chrono::milliseconds), 0ms, 2ms, 5ms);
+            std::chrono::nanoseconds tickedTime(0);
+            size_t tickCount = 0;
+            QSemaphore tickSemaphore;
+            Object::connect(&clockTicker, &ClockTicker::tick, [&]()
+            {
+                tickedTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());
+                ++tickCount;
+                tickSemaphore.release();
+            });
+            const auto tickTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()) + delay;
+            clockTicker.scheduleTick(tickTime);
+            REQUIRE(clockTicker.isEnabled());
+            REQUIRE(clockTicker.isSingleShot());
+            REQUIRE(clockTicker.scheduledTickTime() == tickTime);
+
+            THEN("clock ticker ticks once at scheduled time and becomes disabled")
+            {
+                REQUIRE(TRY_ACQUIRE(tickSemaphore, 10));
+                REQUIRE(tickTime <= tickedTime);
+                REQUIRE((tickedTime - tickTime) < 1ms);
+                REQUIRE(!clockTicker.isEnabled());
+                REQUIRE(!clockTicker.isSingleShot());
+                REQUIRE(!TRY_ACQUIRE(tickSemaphore, QDeadlineTimer(10)));
+                REQUIRE(tickCount == 1);
+            }
+        }
+    }
+}
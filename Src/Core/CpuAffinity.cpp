@@ -0,0 +1,142 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "CpuAffinity.h"
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+namespace Kourier
+{
+
+std::vector<int> CpuAffinity::allowedCpus()
+{
+    std::vector<int> cpus;
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet) != 0)
+        return cpus;
+    for (auto cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &cpuSet))
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+std::vector<int> CpuAffinity::numaSpreadCpus()
+{
+    // Returns allowed cpus taking one from each NUMA node in turn, so that
+    // workers placed in order are spread among memory controllers.
+    const auto cpus = allowedCpus();
+    std::map<int, std::vector<int>> cpusPerNode;
+    std::error_code errorCode;
+    for (const auto &entry : std::filesystem::directory_iterator("/sys/devices/system/node", errorCode))
+    {
+        const auto name = entry.path().filename().string();
+        int node = -1;
+        if (!name.starts_with("node") || std::from_chars(name.data() + 4, name.data() + name.size(), node).ec != std::errc())
+            continue;
+        std::ifstream cpuListFile(entry.path() / "cpulist");
+        std::string cpuList;
+        std::getline(cpuListFile, cpuList);
+        for (const auto cpu : parseCpuList(cpuList))
+        {
+            if (std::binary_search(cpus.cbegin(), cpus.cend(), cpu))
+                cpusPerNode[node].push_back(cpu);
+        }
+    }
+    if (cpusPerNode.size() <= 1)
+        return cpus;
+    std::vector<int> spreadCpus;
+    spreadCpus.reserve(cpus.size());
+    for (size_t i = 0; spreadCpus.size() < cpus.size(); ++i)
+    {
+        for (const auto &[node, nodeCpus] : cpusPerNode)
+        {
+            if (i < nodeCpus.size())
+                spreadCpus.push_back(nodeCpus[i]);
+        }
+    }
+    return spreadCpus;
+}
+
+bool CpuAffinity::pinCurrentThread(int cpu)
+{
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+        return false;
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+        return false;
+    // Prefers memory from the node the thread runs on regardless of the process' memory policy.
+    // Failing to set it is harmless, as the default first-touch policy already favours the local node.
+    syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0);
+    return true;
+}
+
+int CpuAffinity::currentThreadCpu()
+{
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0 || CPU_COUNT(&cpuSet) != 1)
+        return -1;
+    for (auto cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &cpuSet))
+            return cpu;
+    }
+    return -1;
+}
+
+std::vector<int> CpuAffinity::parseCpuList(std::string_view cpuList)
+{
+    // Parses lists in the kernel's cpulist format (e.g. "0-3,8,10-11").
+    std::vector<int> cpus;
+    while (!cpuList.empty())
+    {
+        const auto commaPos = cpuList.find(',');
+        auto range = cpuList.substr(0, commaPos);
+        cpuList = (commaPos != std::string_view::npos) ? cpuList.substr(commaPos + 1) : std::string_view{};
+        while (!range.empty() && (range.back() == '\n' || range.back() == ' '))
+            range.remove_suffix(1);
+        const auto dashPos = range.find('-');
+        int first = -1;
+        int last = -1;
+        if (std::from_chars(range.data(), range.data() + range.size(), first).ec != std::errc() || first < 0)
+            return {};
+        if (dashPos == std::string_view::npos)
+            last = first;
+        else if (std::from_chars(range.data() + dashPos + 1, range.data() + range.size(), last).ec != std::errc() || last < first)
+            return {};
+        for (auto cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+}
@@ -0,0 +1,43 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_CPU_AFFINITY_H
+#define KOURIER_CPU_AFFINITY_H
+
+#include <string_view>
+#include <vector>
+
+
+namespace Kourier
+{
+
+struct CpuAffinity
+{
+    static std::vector<int> allowedCpus();
+    static std::vector<int> numaSpreadCpus();
+    static bool pinCurrentThread(int cpu);
+    static int currentThreadCpu();
+    static std::vector<int> parseCpuList(std::string_view cpuList);
+
+private:
+    CpuAffinity() = delete;
+    ~CpuAffinity() = delete;
+};
+
+}
+
+#endif // KOURIER_CPU_AFFINITY_H
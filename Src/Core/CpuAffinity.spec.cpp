@@ -0,0 +1,106 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "CpuAffinity.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <Spectator>
+
+
+using Kourier::CpuAffinity;
+
+
+SCENARIO("CpuAffinity parses kernel cpu lists")
+{
+    GIVEN("a cpu list")
+    {
+        const auto cpuListAndExpectedCpus = GENERATE(AS(std::pair<std::string_view, std::vector<int>>),
+                                                     {"", {}},
+                                                     {"0", {0}},
+                                                     {"0\n", {0}},
+                                                     {"0-3", {0, 1, 2, 3}},
+                                                     {"0-1,8,10-11\n", {0, 1, 8, 10, 11}},
+                                                     {"3-1", {}},
+                                                     {"a-b", {}});
+
+        WHEN("cpu list is parsed")
+        {
+            const auto cpus = CpuAffinity::parseCpuList(cpuListAndExpectedCpus.first);
+
+            THEN("expected cpus are returned")
+            {
+                REQUIRE(cpus == cpuListAndExpectedCpus.second);
+            }
+        }
+    }
+}
+
+
+SCENARIO("CpuAffinity pins threads to allowed cpus")
+{
+    GIVEN("the cpus the process is allowed to run on")
+    {
+        const auto allowedCpus = CpuAffinity::allowedCpus();
+        REQUIRE(!allowedCpus.empty());
+        REQUIRE(std::is_sorted(allowedCpus.cbegin(), allowedCpus.cend()));
+
+        WHEN("cpus are spread among NUMA nodes")
+        {
+            auto numaSpreadCpus = CpuAffinity::numaSpreadCpus();
+
+            THEN("spread cpus are a permutation of allowed cpus")
+            {
+                REQUIRE(numaSpreadCpus.size() == allowedCpus.size());
+                std::sort(numaSpreadCpus.begin(), numaSpreadCpus.end());
+                REQUIRE(numaSpreadCpus == allowedCpus);
+            }
+        }
+
+        WHEN("a thread is pinned to each allowed cpu")
+        {
+            std::vector<int> pinnedCpus;
+            for (const auto cpu : allowedCpus)
+            {
+                std::thread thread([&pinnedCpus, cpu]()
+                {
+                    if (CpuAffinity::pinCurrentThread(cpu))
+                        pinnedCpus.push_back(CpuAffinity::currentThreadCpu());
+                });
+                thread.join();
+            }
+
+            THEN("each thread runs on the cpu it was pinned to")
+            {
+                REQUIRE(pinnedCpus == allowedCpus);
+            }
+        }
+
+        WHEN("a thread is pinned to an invalid cpu")
+        {
+            const auto cpu = GENERATE(AS(int), -1, 1 << 20);
+            bool pinned = true;
+            std::thread thread([&](){pinned = CpuAffinity::pinCurrentThread(cpu);});
+            thread.join();
+
+            THEN("pinning fails")
+            {
+                REQUIRE(!pinned);
+            }
+        }
+    }
+}
@@ -0,0 +1,199 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "DeadlineTracker.h"
+#include "LazyTimer.h"
+#include "NoDestroy.h"
+#include <algorithm>
+#include <bit>
+
+
+namespace Kourier
+{
+
+DeadlineTracker::DeadlineTracker() :
+    m_lastSweepTime(currentTime())
+{
+    for (uint32_t i = 0; i < m_slotCount; ++i)
+    {
+        m_slots[i].pNext = &m_slots[i];
+        m_slots[i].pPrevious = &m_slots[i];
+        m_slots[i].idxSlot = i;
+    }
+    m_sweepTimer.setSingleShot(true);
+    m_sweepTimer.setTimerType(Timer::TimerType::Precise);
+    Object::connect(&m_sweepTimer, &Timer::timeout, [this](){sweep();});
+}
+
+DeadlineTracker *DeadlineTracker::current()
+{
+    static thread_local NoDestroy<DeadlineTracker> deadlineTracker;
+    return &(deadlineTracker());
+}
+
+// Deadlines are rounded to the nearest millisecond, which is the resolution of the wheel.
+// Restarting a timer to a later deadline only updates its deadline. The timer stays in
+// its slot and is moved to the slot of its new deadline when the sweep reaches it.
+void DeadlineTracker::start(LazyTimer *pTimer, std::chrono::milliseconds interval)
+{
+    assert(pTimer);
+    const auto deadline = std::chrono::steady_clock::now().time_since_epoch() + std::max(interval, std::chrono::milliseconds(0));
+    pTimer->m_deadline = std::chrono::round<std::chrono::milliseconds>(deadline).count();
+    pTimer->m_isActive = true;
+    if (pTimer->m_node.isLinked() && pTimer->m_checkTime <= pTimer->m_deadline)
+        return;
+    schedule(pTimer, pTimer->m_deadline);
+}
+
+// Stopped timers stay in their slots until the sweep reaches them, as they are usually
+// restarted soon after, which does not move them if their new deadline is later.
+void DeadlineTracker::stop(LazyTimer *pTimer)
+{
+    assert(pTimer);
+    pTimer->m_isActive = false;
+}
+
+void DeadlineTracker::remove(LazyTimer *pTimer)
+{
+    assert(pTimer);
+    pTimer->m_isActive = false;
+    if (pTimer->m_node.isLinked())
+        unlink(&pTimer->m_node);
+}
+
+void DeadlineTracker::schedule(LazyTimer *pTimer, int64_t checkTime)
+{
+    if (pTimer->m_node.isLinked())
+        unlink(&pTimer->m_node);
+    pTimer->m_checkTime = checkTime;
+    link(m_slots[checkTime & (m_slotCount - 1)], &pTimer->m_node);
+    ++m_rescheduleCount;
+    if (!m_isSweeping && (!m_sweepTimer.isActive() || checkTime < m_sweepTime))
+        scheduleSweep(checkTime);
+}
+
+void DeadlineTracker::link(DeadlineTrackerNode &list, DeadlineTrackerNode *pNode)
+{
+    pNode->pPrevious = list.pPrevious;
+    pNode->pNext = &list;
+    list.pPrevious->pNext = pNode;
+    list.pPrevious = pNode;
+    pNode->idxSlot = list.idxSlot;
+    if (list.idxSlot < m_slotCount)
+        m_nonEmptySlots[list.idxSlot / 64] |= (uint64_t(1) << (list.idxSlot % 64));
+}
+
+void DeadlineTracker::unlink(DeadlineTrackerNode *pNode)
+{
+    pNode->pPrevious->pNext = pNode->pNext;
+    pNode->pNext->pPrevious = pNode->pPrevious;
+    pNode->pNext = nullptr;
+    pNode->pPrevious = nullptr;
+    const auto idxSlot = pNode->idxSlot;
+    if (idxSlot < m_slotCount && m_slots[idxSlot].pNext == &m_slots[idxSlot])
+        m_nonEmptySlots[idxSlot / 64] &= ~(uint64_t(1) << (idxSlot % 64));
+}
+
+void DeadlineTracker::scheduleSweep(int64_t sweepTime)
+{
+    m_sweepTime = sweepTime;
+    const auto interval = std::chrono::milliseconds(sweepTime) - std::chrono::steady_clock::now().time_since_epoch();
+    m_sweepTimer.start(std::max(std::chrono::ceil<std::chrono::milliseconds>(interval), std::chrono::milliseconds(0)));
+}
+
+void DeadlineTracker::sweep()
+{
+    m_isSweeping = true;
+    ++m_sweepCount;
+    const auto now = currentTime();
+    DeadlineTrackerNode expiredTimers;
+    expiredTimers.pNext = &expiredTimers;
+    expiredTimers.pPrevious = &expiredTimers;
+    expiredTimers.idxSlot = m_expiredListIdx;
+    // The slot of the last sweep is visited again, as timers may have been started to expire on it after that sweep.
+    const auto slotsToVisit = std::min<int64_t>(now - m_lastSweepTime + 1, m_slotCount);
+    for (int64_t time = m_lastSweepTime; time < (m_lastSweepTime + slotsToVisit); ++time)
+    {
+        const uint32_t idxSlot = time & (m_slotCount - 1);
+        if (!(m_nonEmptySlots[idxSlot / 64] & (uint64_t(1) << (idxSlot % 64))))
+            continue;
+        auto &slot = m_slots[idxSlot];
+        auto *pNode = slot.pNext;
+        // Timers moved to this slot are appended to it and have check times in later laps of the wheel.
+        while (pNode != &slot)
+        {
+            auto * const pNextNode = pNode->pNext;
+            auto * const pTimer = pNode->pTimer;
+            if (!pTimer->m_isActive)
+                unlink(pNode);
+            else if (pTimer->m_checkTime <= now)
+            {
+                if (pTimer->m_deadline <= now)
+                {
+                    unlink(pNode);
+                    link(expiredTimers, pNode);
+                }
+                else
+                    schedule(pTimer, pTimer->m_deadline);
+            }
+            pNode = pNextNode;
+        }
+    }
+    m_lastSweepTime = now;
+    // Timers can be restarted, stopped or deleted by timeout handlers of other timers.
+    while (expiredTimers.pNext != &expiredTimers)
+    {
+        auto * const pTimer = expiredTimers.pNext->pTimer;
+        unlink(&pTimer->m_node);
+        if (!pTimer->m_isActive)
+            continue;
+        else if (pTimer->m_deadline <= now)
+        {
+            pTimer->m_isActive = false;
+            pTimer->timeout();
+        }
+        else
+            schedule(pTimer, pTimer->m_deadline);
+    }
+    m_isSweeping = false;
+    // Timeout handlers may have started timers whose deadlines round to the millisecond just swept. Their
+    // slot is only searched from the next lap on, so it is swept again right away if they are in it.
+    const auto &currentSlot = m_slots[now & (m_slotCount - 1)];
+    for (auto *pNode = currentSlot.pNext; pNode != &currentSlot; pNode = pNode->pNext)
+    {
+        if (pNode->pTimer->m_checkTime <= now)
+        {
+            scheduleSweep(now);
+            return;
+        }
+    }
+    for (uint32_t distance = 1; distance <= m_slotCount;)
+    {
+        const uint32_t idxSlot = (now + distance) & (m_slotCount - 1);
+        const auto slotBits = m_nonEmptySlots[idxSlot / 64] >> (idxSlot % 64);
+        if (slotBits != 0)
+        {
+            const auto slotDistance = distance + std::countr_zero(slotBits);
+            scheduleSweep(now + std::min<uint32_t>(slotDistance, m_slotCount));
+            return;
+        }
+        distance += 64 - (idxSlot % 64);
+    }
+    m_sweepTimer.stop();
+}
+
+}
@@ -0,0 +1,73 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_DEADLINE_TRACKER_H
+#define KOURIER_DEADLINE_TRACKER_H
+
+#include "DeadlineTrackerNode.h"
+#include "Timer.h"
+#include <chrono>
+#include <cstdint>
+
+
+namespace Kourier
+{
+
+class LazyTimer;
+
+// Each thread has a tracker that keeps its lazy timers in a wheel of 1ms slots. Timers are
+// placed in the slot of their deadline and are only moved when restarted with an earlier
+// deadline. A single sweep timer checks, at expiry, if timers in the expired slots were
+// restarted to a later deadline, in which case they are moved to the slot of the new deadline.
+class DeadlineTracker
+{
+public:
+    DeadlineTracker();
+    ~DeadlineTracker() = default;
+    DeadlineTracker(const DeadlineTracker&) = delete;
+    DeadlineTracker &operator=(const DeadlineTracker&) = delete;
+    static DeadlineTracker *current();
+    void start(LazyTimer *pTimer, std::chrono::milliseconds interval);
+    void stop(LazyTimer *pTimer);
+    void remove(LazyTimer *pTimer);
+    inline uint64_t rescheduleCount() const {return m_rescheduleCount;}
+    inline uint64_t sweepCount() const {return m_sweepCount;}
+    inline static int64_t currentTime() {return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();}
+
+private:
+    void schedule(LazyTimer *pTimer, int64_t checkTime);
+    void link(DeadlineTrackerNode &list, DeadlineTrackerNode *pNode);
+    void unlink(DeadlineTrackerNode *pNode);
+    void scheduleSweep(int64_t sweepTime);
+    void sweep();
+
+private:
+    static constexpr uint32_t m_slotCount = 4096;
+    static constexpr uint32_t m_expiredListIdx = m_slotCount;
+    DeadlineTrackerNode m_slots[m_slotCount];
+    uint64_t m_nonEmptySlots[m_slotCount / 64] = {};
+    Timer m_sweepTimer;
+    int64_t m_lastSweepTime = 0;
+    int64_t m_sweepTime = 0;
+    uint64_t m_rescheduleCount = 0;
+    uint64_t m_sweepCount = 0;
+    bool m_isSweeping = false;
+};
+
+}
+
+#endif // KOURIER_DEADLINE_TRACKER_H
@@ -0,0 +1,40 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_DEADLINE_TRACKER_NODE_H
+#define KOURIER_DEADLINE_TRACKER_NODE_H
+
+#include <cstdint>
+
+
+namespace Kourier
+{
+
+class LazyTimer;
+
+struct DeadlineTrackerNode
+{
+    DeadlineTrackerNode *pNext = nullptr;
+    DeadlineTrackerNode *pPrevious = nullptr;
+    LazyTimer *pTimer = nullptr;
+    uint32_t idxSlot = 0;
+    inline bool isLinked() const {return pNext != nullptr;}
+};
+
+}
+
+#endif // KOURIER_DEADLINE_TRACKER_NODE_H
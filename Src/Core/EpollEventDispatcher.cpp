@@ -0,0 +1,412 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "EpollEventDispatcher.h"
+#include "EpollEventNotifier.h"
+#include "EpollEventSource.h"
+#include "UnixUtils.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <algorithm>
+#include <limits>
+#include <poll.h>
+#include <sys/eventfd.h>
+
+
+namespace Kourier
+{
+
+class EpollSocketNotifierEventSource : public EpollEventSource
+{
+KOURIER_OBJECT(Kourier::EpollSocketNotifierEventSource)
+public:
+    EpollSocketNotifierEventSource(qintptr socketDescriptor, EpollEventDispatcher *pDispatcher, EpollEventNotifier *pEventNotifier) :
+        EpollEventSource(0, pEventNotifier),
+        m_pDispatcher(pDispatcher),
+        m_socketDescriptor(socketDescriptor)
+    {
+        assert(m_pDispatcher);
+    }
+    ~EpollSocketNotifierEventSource() override = default;
+    int64_t fileDescriptor() const override {return m_socketDescriptor;}
+    inline QSocketNotifier *&notifier(QSocketNotifier::Type type) {return m_notifiers[type];}
+    inline bool hasNotifiers() const {return m_notifiers[QSocketNotifier::Read] || m_notifiers[QSocketNotifier::Write] || m_notifiers[QSocketNotifier::Exception];}
+    inline uint32_t requestedEventTypes() const
+    {
+        return (m_notifiers[QSocketNotifier::Read] ? EPOLLIN : 0)
+               | (m_notifiers[QSocketNotifier::Write] ? EPOLLOUT : 0)
+               | (m_notifiers[QSocketNotifier::Exception] ? EPOLLPRI : 0);
+    }
+
+private:
+    void onEvent(uint32_t epollEvents) override {m_pDispatcher->activateSocketNotifiers(this, epollEvents);}
+
+private:
+    EpollEventDispatcher * const m_pDispatcher;
+    const qintptr m_socketDescriptor;
+    QSocketNotifier *m_notifiers[3] = {nullptr, nullptr, nullptr};
+};
+
+class EpollWakeUpEventSource : public EpollEventSource
+{
+KOURIER_OBJECT(Kourier::EpollWakeUpEventSource)
+public:
+    EpollWakeUpEventSource(EpollEventDispatcher *pDispatcher, EpollEventNotifier *pEventNotifier) :
+        EpollEventSource(EPOLLIN, pEventNotifier),
+        m_pDispatcher(pDispatcher)
+    {
+        assert(m_pDispatcher);
+    }
+    ~EpollWakeUpEventSource() override {setEnabled(false);}
+    int64_t fileDescriptor() const override {return m_pDispatcher->m_wakeUpEventFd;}
+
+private:
+    void onEvent(uint32_t epollEvents) override
+    {
+        if (EPOLLIN == (epollEvents & EPOLLIN))
+            m_pDispatcher->onWakeUp();
+    }
+
+private:
+    EpollEventDispatcher * const m_pDispatcher;
+};
+
+/*!
+\class Kourier::EpollEventDispatcher
+\brief The EpollEventDispatcher class runs the thread's event loop natively on Kourier's epoll instance.
+
+By default, Kourier nests its epoll instance inside Qt's event dispatcher and only polls it when
+Qt's dispatcher reports it as readable, which costs two poll layers per I/O wakeup. Setting an EpollEventDispatcher on
+a QThread before starting it makes the thread's event loop block directly on Kourier's epoll instance.
+Kourier timers, deleters and ready events are serviced as any other epoll event source, socket notifiers are added to the
+same epoll instance, Qt timers are kept in a deadline list that bounds the time the dispatcher waits on epoll,
+and Qt posted events are only sent when Qt wakes the dispatcher up or when a nested event loop exits.
+*/
+
+EpollEventDispatcher::EpollEventDispatcher(QObject *pParent) :
+    QAbstractEventDispatcher(pParent),
+    m_wakeUpEventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    if (-1 == m_wakeUpEventFd)
+        qFatal("Failed to create wake up event for epoll-based event dispatcher. Exiting.");
+}
+
+EpollEventDispatcher::~EpollEventDispatcher()
+{
+    for (auto &it : m_socketEventSources)
+    {
+        for (auto &type : {QSocketNotifier::Read, QSocketNotifier::Write, QSocketNotifier::Exception})
+            it.second->notifier(type) = nullptr;
+        removeSocketEventSource(it.second);
+        delete it.second;
+    }
+    m_socketEventSources.clear();
+    delete m_pWakeUpEventSource;
+    UnixUtils::safeClose(m_wakeUpEventFd);
+}
+
+bool EpollEventDispatcher::isRunningOnCurrentThread()
+{
+    return qobject_cast<EpollEventDispatcher*>(QAbstractEventDispatcher::instance()) != nullptr;
+}
+
+bool EpollEventDispatcher::processEvents(QEventLoop::ProcessEventsFlags flags)
+{
+    auto * const pEventNotifier = eventNotifier();
+    m_flags = flags;
+    m_isInterrupted.store(false, std::memory_order_relaxed);
+    emit awake();
+    sendPostedEvents();
+    int timeoutInMSecs = 0;
+    if (flags.testFlag(QEventLoop::WaitForMoreEvents) && !m_isInterrupted.load(std::memory_order_relaxed))
+    {
+        timeoutInMSecs = flags.testFlag(QEventLoop::X11ExcludeTimers) ? -1 : timeToNextTimerInMSecs();
+        if (timeoutInMSecs != 0)
+            emit aboutToBlock();
+    }
+    bool hasProcessedEvents = false;
+    if (!pEventNotifier->m_isProcessingEvents)
+        hasProcessedEvents = pEventNotifier->processEvents(timeoutInMSecs);
+    else
+        waitForWakeUp(timeoutInMSecs);
+    if (!flags.testFlag(QEventLoop::X11ExcludeTimers))
+        hasProcessedEvents = activateTimers() || hasProcessedEvents;
+    if (m_hasPendingPostedEvents)
+    {
+        hasProcessedEvents = true;
+        sendPostedEvents();
+    }
+    return hasProcessedEvents;
+}
+
+void EpollEventDispatcher::registerSocketNotifier(QSocketNotifier *pNotifier)
+{
+    assert(pNotifier);
+    const auto socketDescriptor = pNotifier->socket();
+    auto &pEventSource = m_socketEventSources[socketDescriptor];
+    if (!pEventSource)
+        pEventSource = new EpollSocketNotifierEventSource(socketDescriptor, this, eventNotifier());
+    auto *&pRegisteredNotifier = pEventSource->notifier(pNotifier->type());
+    if (pRegisteredNotifier && pRegisteredNotifier != pNotifier)
+        qWarning("EpollEventDispatcher: multiple socket notifiers for same socket %lld and type %d.", static_cast<long long>(socketDescriptor), pNotifier->type());
+    pRegisteredNotifier = pNotifier;
+    updateSocketEventSource(pEventSource);
+}
+
+void EpollEventDispatcher::unregisterSocketNotifier(QSocketNotifier *pNotifier)
+{
+    assert(pNotifier);
+    auto it = m_socketEventSources.find(pNotifier->socket());
+    if (it == m_socketEventSources.end())
+        return;
+    auto *pEventSource = it->second;
+    auto *&pRegisteredNotifier = pEventSource->notifier(pNotifier->type());
+    if (pRegisteredNotifier != pNotifier)
+        return;
+    pRegisteredNotifier = nullptr;
+    if (pEventSource->hasNotifiers())
+        updateSocketEventSource(pEventSource);
+    else
+    {
+        m_socketEventSources.erase(it);
+        removeSocketEventSource(pEventSource);
+        // The event source can be unregistered while it is activating notifiers.
+        pEventSource->scheduleForDeletion();
+    }
+}
+
+void EpollEventDispatcher::registerTimer(int timerId, qint64 interval, Qt::TimerType timerType, QObject *pObject)
+{
+    assert(timerId > 0 && interval >= 0 && pObject);
+    m_timers.push_back({.id = timerId,
+                        .intervalInMSecs = interval,
+                        .type = timerType,
+                        .pObject = pObject,
+                        .deadline = Clock::now() + std::chrono::milliseconds(interval)});
+}
+
+bool EpollEventDispatcher::unregisterTimer(int timerId)
+{
+    auto it = findTimer(timerId);
+    if (it == m_timers.end())
+        return false;
+    else
+    {
+        m_timers.erase(it);
+        return true;
+    }
+}
+
+bool EpollEventDispatcher::unregisterTimers(QObject *pObject)
+{
+    const auto timerCount = m_timers.size();
+    std::erase_if(m_timers, [pObject](const QtTimer &timer) {return timer.pObject == pObject;});
+    return timerCount != m_timers.size();
+}
+
+QList<QAbstractEventDispatcher::TimerInfo> EpollEventDispatcher::registeredTimers(QObject *pObject) const
+{
+    QList<TimerInfo> timers;
+    for (const auto &timer : m_timers)
+    {
+        if (timer.pObject == pObject)
+            timers.append(TimerInfo(timer.id, static_cast<int>(timer.intervalInMSecs), timer.type));
+    }
+    return timers;
+}
+
+int EpollEventDispatcher::remainingTime(int timerId)
+{
+    auto it = findTimer(timerId);
+    if (it == m_timers.end())
+        return -1;
+    const auto remainingTime = std::chrono::ceil<std::chrono::milliseconds>(it->deadline - Clock::now()).count();
+    return static_cast<int>(std::max<int64_t>(0, remainingTime));
+}
+
+void EpollEventDispatcher::wakeUp()
+{
+    if (!m_hasPendingWakeUp.exchange(true, std::memory_order_acq_rel))
+    {
+        const uint64_t value = 1;
+        UnixUtils::safeWrite(m_wakeUpEventFd, (const char*)&value, sizeof(value));
+    }
+}
+
+void EpollEventDispatcher::interrupt()
+{
+    m_isInterrupted.store(true, std::memory_order_relaxed);
+    wakeUp();
+}
+
+EpollEventNotifier *EpollEventDispatcher::eventNotifier()
+{
+    if (!m_pEventNotifier)
+    {
+        m_pEventNotifier = EpollEventNotifier::current();
+        m_pWakeUpEventSource = new EpollWakeUpEventSource(this, m_pEventNotifier);
+        m_pWakeUpEventSource->setEnabled(true);
+        m_lastLoopLevel = QThread::currentThread()->loopLevel();
+    }
+    return m_pEventNotifier;
+}
+
+void EpollEventDispatcher::onWakeUp()
+{
+    // Reading the event before clearing the flag guarantees that wake ups issued after
+    // the read are either seen through the flag or through a new write to the event.
+    uint64_t value = 0;
+    UnixUtils::safeRead(m_wakeUpEventFd, (char*)&value, sizeof(value));
+    m_hasPendingWakeUp.store(false, std::memory_order_release);
+    m_hasPendingPostedEvents = true;
+}
+
+void EpollEventDispatcher::waitForWakeUp(int timeoutInMSecs)
+{
+    // Nested event loops started from within an epoll event handler can only service Qt events,
+    // as the epoll instance is still being processed by an outer loop.
+    pollfd wakeUpFd{.fd = m_wakeUpEventFd, .events = POLLIN, .revents = 0};
+    if (::poll(&wakeUpFd, 1, timeoutInMSecs) > 0 && (wakeUpFd.revents & POLLIN))
+        onWakeUp();
+}
+
+void EpollEventDispatcher::sendPostedEvents()
+{
+    // Deferred deletions posted inside a nested event loop are only sent after the loop exits,
+    // and Qt does not wake the dispatcher up when it re-posts them.
+    const auto loopLevel = QThread::currentThread()->loopLevel();
+    const bool hasExitedNestedLoop = loopLevel < m_lastLoopLevel;
+    m_lastLoopLevel = loopLevel;
+    if (m_hasPendingPostedEvents || hasExitedNestedLoop)
+    {
+        m_hasPendingPostedEvents = false;
+        QCoreApplication::sendPostedEvents();
+    }
+}
+
+void EpollEventDispatcher::activateSocketNotifiers(EpollSocketNotifierEventSource *pEventSource, uint32_t epollEvents)
+{
+    assert(pEventSource);
+    if (m_flags.testFlag(QEventLoop::ExcludeSocketNotifiers))
+        return;
+    static constexpr std::pair<QSocketNotifier::Type, uint32_t> notifierEvents[] = {{QSocketNotifier::Read, EPOLLIN | EPOLLHUP | EPOLLERR},
+                                                                                    {QSocketNotifier::Write, EPOLLOUT | EPOLLHUP | EPOLLERR},
+                                                                                    {QSocketNotifier::Exception, EPOLLPRI}};
+    for (const auto &notifierEvent : notifierEvents)
+    {
+        if (!(epollEvents & notifierEvent.second))
+            continue;
+        // Notifiers can be unregistered by previously activated ones.
+        auto *pNotifier = pEventSource->notifier(notifierEvent.first);
+        if (pNotifier && pNotifier->isEnabled())
+        {
+            QEvent event(QEvent::SockAct);
+            QCoreApplication::sendEvent(pNotifier, &event);
+        }
+    }
+}
+
+void EpollEventDispatcher::updateSocketEventSource(EpollSocketNotifierEventSource *pEventSource)
+{
+    assert(pEventSource && m_pEventNotifier);
+    const auto eventTypes = pEventSource->requestedEventTypes();
+    if (pEventSource->m_enabled && pEventSource->m_eventTypes == eventTypes)
+        return;
+    pEventSource->m_eventTypes = eventTypes;
+    epoll_event epollEvent{0, nullptr};
+    epollEvent.events = eventTypes;
+    epollEvent.data.ptr = pEventSource;
+    const auto operation = pEventSource->m_enabled ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    ++m_pEventNotifier->m_epollCtlCount;
+    if (0 == epoll_ctl(m_pEventNotifier->m_epollInstanceFd, operation, pEventSource->fileDescriptor(), &epollEvent))
+    {
+        pEventSource->m_enabled = true;
+        m_pEventNotifier->removeEventSourceFromPendingEvents(pEventSource);
+    }
+    else
+        qWarning("EpollEventDispatcher: failed to register socket notifier for socket %lld.", static_cast<long long>(pEventSource->fileDescriptor()));
+}
+
+void EpollEventDispatcher::removeSocketEventSource(EpollSocketNotifierEventSource *pEventSource)
+{
+    assert(pEventSource);
+    if (!pEventSource->m_enabled)
+        return;
+    pEventSource->m_enabled = false;
+    // Qt may close the socket before unregistering its notifiers, in which
+    // case the kernel has already removed it from the epoll instance.
+    if (m_pEventNotifier->m_isActive)
+    {
+        ++m_pEventNotifier->m_epollCtlCount;
+        epoll_ctl(m_pEventNotifier->m_epollInstanceFd, EPOLL_CTL_DEL, pEventSource->fileDescriptor(), nullptr);
+        m_pEventNotifier->removeEventSourceFromPendingEvents(pEventSource);
+    }
+}
+
+bool EpollEventDispatcher::activateTimers()
+{
+    if (m_timers.empty())
+        return false;
+    const auto now = Clock::now();
+    std::vector<int> expiredTimerIds;
+    for (const auto &timer : m_timers)
+    {
+        if (timer.deadline <= now && !timer.isBeingActivated)
+            expiredTimerIds.push_back(timer.id);
+    }
+    for (const auto timerId : expiredTimerIds)
+    {
+        // Timers can be unregistered by previously activated ones.
+        auto it = findTimer(timerId);
+        if (it == m_timers.end())
+            continue;
+        const auto interval = std::chrono::milliseconds(it->intervalInMSecs);
+        it->deadline = (it->type == Qt::PreciseTimer) ? std::max(it->deadline + interval, now) : (now + interval);
+        it->isBeingActivated = true;
+        auto *pObject = it->pObject;
+        QTimerEvent event(timerId);
+        QCoreApplication::sendEvent(pObject, &event);
+        it = findTimer(timerId);
+        if (it != m_timers.end())
+            it->isBeingActivated = false;
+    }
+    return !expiredTimerIds.empty();
+}
+
+int EpollEventDispatcher::timeToNextTimerInMSecs() const
+{
+    if (m_timers.empty())
+        return -1;
+    auto nextDeadline = Clock::time_point::max();
+    for (const auto &timer : m_timers)
+    {
+        if (!timer.isBeingActivated)
+            nextDeadline = std::min(nextDeadline, timer.deadline);
+    }
+    if (nextDeadline == Clock::time_point::max())
+        return -1;
+    const auto timeToNextTimer = std::chrono::ceil<std::chrono::milliseconds>(nextDeadline - Clock::now()).count();
+    return static_cast<int>(std::clamp<int64_t>(timeToNextTimer, 0, std::numeric_limits<int>::max()));
+}
+
+std::vector<EpollEventDispatcher::QtTimer>::iterator EpollEventDispatcher::findTimer(int timerId)
+{
+    return std::find_if(m_timers.begin(), m_timers.end(), [timerId](const QtTimer &timer) {return timer.id == timerId;});
+}
+
+}
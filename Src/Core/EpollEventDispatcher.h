@@ -0,0 +1,96 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#ifndef KOURIER_EPOLL_EVENT_DISPATCHER_H
+#define KOURIER_EPOLL_EVENT_DISPATCHER_H
+
+#include "SDK.h"
+#include <QAbstractEventDispatcher>
+#include <QSocketNotifier>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+
+namespace Kourier
+{
+
+class EpollEventNotifier;
+class EpollEventSource;
+class EpollSocketNotifierEventSource;
+class EpollWakeUpEventSource;
+
+class KOURIER_EXPORT EpollEventDispatcher : public QAbstractEventDispatcher
+{
+Q_OBJECT
+public:
+    explicit EpollEventDispatcher(QObject *pParent = nullptr);
+    ~EpollEventDispatcher() override;
+    static bool isRunningOnCurrentThread();
+    bool processEvents(QEventLoop::ProcessEventsFlags flags) override;
+    void registerSocketNotifier(QSocketNotifier *pNotifier) override;
+    void unregisterSocketNotifier(QSocketNotifier *pNotifier) override;
+    void registerTimer(int timerId, qint64 interval, Qt::TimerType timerType, QObject *pObject) override;
+    bool unregisterTimer(int timerId) override;
+    bool unregisterTimers(QObject *pObject) override;
+    QList<TimerInfo> registeredTimers(QObject *pObject) const override;
+    int remainingTime(int timerId) override;
+    void wakeUp() override;
+    void interrupt() override;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    struct QtTimer
+    {
+        int id = 0;
+        qint64 intervalInMSecs = 0;
+        Qt::TimerType type = Qt::CoarseTimer;
+        QObject *pObject = nullptr;
+        Clock::time_point deadline;
+        bool isBeingActivated = false;
+    };
+    EpollEventNotifier *eventNotifier();
+    void onWakeUp();
+    void waitForWakeUp(int timeoutInMSecs);
+    void sendPostedEvents();
+    void activateSocketNotifiers(EpollSocketNotifierEventSource *pEventSource, uint32_t epollEvents);
+    void updateSocketEventSource(EpollSocketNotifierEventSource *pEventSource);
+    void removeSocketEventSource(EpollSocketNotifierEventSource *pEventSource);
+    bool activateTimers();
+    int timeToNextTimerInMSecs() const;
+    std::vector<QtTimer>::iterator findTimer(int timerId);
+
+private:
+    EpollEventNotifier *m_pEventNotifier = nullptr;
+    EpollWakeUpEventSource *m_pWakeUpEventSource = nullptr;
+    std::unordered_map<qintptr, EpollSocketNotifierEventSource*> m_socketEventSources;
+    std::vector<QtTimer> m_timers;
+    const int m_wakeUpEventFd = -1;
+    int m_lastLoopLevel = 0;
+    QEventLoop::ProcessEventsFlags m_flags;
+    std::atomic_bool m_hasPendingWakeUp = false;
+    std::atomic_bool m_isInterrupted = false;
+    bool m_hasPendingPostedEvents = true;
+    friend class EpollSocketNotifierEventSource;
+    friend class EpollWakeUpEventSource;
+};
+
+}
+
+#endif // KOURIER_EPOLL_EVENT_DISPATCHER_H
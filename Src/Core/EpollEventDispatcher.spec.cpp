@@ -0,0 +1,202 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "EpollEventDispatcher.h"
+#include "Timer.h"
+#include <QThread>
+#include <QTimer>
+#include <QSemaphore>
+#include <QSocketNotifier>
+#include <atomic>
+#include <memory>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <Spectator>
+
+
+using Kourier::EpollEventDispatcher;
+using Kourier::Timer;
+using Kourier::Object;
+using Spectator::SemaphoreAwaiter;
+
+
+namespace
+{
+
+struct DispatcherThread
+{
+    DispatcherThread()
+    {
+        thread.setEventDispatcher(new EpollEventDispatcher);
+        thread.start();
+        pContext = new QObject;
+        pContext->moveToThread(&thread);
+    }
+    ~DispatcherThread()
+    {
+        pContext->deleteLater();
+        thread.quit();
+        thread.wait();
+    }
+    template <class Fcn>
+    void run(Fcn fcn) {QMetaObject::invokeMethod(pContext, fcn, Qt::QueuedConnection);}
+    QThread thread;
+    QObject *pContext = nullptr;
+};
+
+}
+
+
+SCENARIO("EpollEventDispatcher runs queued invocations on the thread it is installed on")
+{
+    GIVEN("a thread running an epoll event dispatcher")
+    {
+        DispatcherThread dispatcherThread;
+        REQUIRE(!EpollEventDispatcher::isRunningOnCurrentThread());
+
+        WHEN("functions are invoked on the thread")
+        {
+            const auto invocationCount = GENERATE(AS(int), 1, 3, 128);
+            QSemaphore semaphore;
+            std::atomic_int executedCount = 0;
+            std::atomic_bool wasRunningOnEpollDispatcher = true;
+            for (auto i = 0; i < invocationCount; ++i)
+            {
+                dispatcherThread.run([&]()
+                {
+                    wasRunningOnEpollDispatcher = wasRunningOnEpollDispatcher && EpollEventDispatcher::isRunningOnCurrentThread();
+                    if (++executedCount == invocationCount)
+                        semaphore.release();
+                });
+            }
+
+            THEN("all functions run on the thread driven by the epoll event dispatcher")
+            {
+                REQUIRE(SemaphoreAwaiter::signalSlotAwareWait(semaphore, 10));
+                REQUIRE(executedCount == invocationCount);
+                REQUIRE(wasRunningOnEpollDispatcher);
+            }
+        }
+    }
+}
+
+
+SCENARIO("EpollEventDispatcher activates Qt timers")
+{
+    GIVEN("a thread running an epoll event dispatcher")
+    {
+        DispatcherThread dispatcherThread;
+
+        WHEN("a repeating Qt timer is started on the thread")
+        {
+            const auto timerType = GENERATE(AS(Qt::TimerType), Qt::PreciseTimer, Qt::CoarseTimer, Qt::VeryCoarseTimer);
+            const int intervalInMSecs = (timerType == Qt::VeryCoarseTimer) ? 1000 : 5;
+            static constexpr int expectedTimeoutCount = 3;
+            QSemaphore semaphore;
+            dispatcherThread.run([&]()
+            {
+                auto *pTimer = new QTimer(dispatcherThread.pContext);
+                pTimer->setTimerType(timerType);
+                pTimer->setInterval(intervalInMSecs);
+                auto timeoutCount = std::make_shared<int>(0);
+                QObject::connect(pTimer, &QTimer::timeout, pTimer, [&semaphore, pTimer, timeoutCount]()
+                {
+                    if (++(*timeoutCount) == expectedTimeoutCount)
+                    {
+                        pTimer->stop();
+                        semaphore.release();
+                    }
+                });
+                pTimer->start();
+            });
+
+            THEN("timer times out repeatedly until it is stopped")
+            {
+                REQUIRE(SemaphoreAwaiter::signalSlotAwareWait(semaphore, 10));
+            }
+        }
+    }
+}
+
+
+SCENARIO("EpollEventDispatcher processes Kourier event sources")
+{
+    GIVEN("a thread running an epoll event dispatcher")
+    {
+        DispatcherThread dispatcherThread;
+
+        WHEN("a Kourier timer is started on the thread")
+        {
+            QSemaphore semaphore;
+            dispatcherThread.run([&]()
+            {
+                auto *pTimer = new Timer;
+                pTimer->setSingleShot(true);
+                Object::connect(pTimer, &Timer::timeout, [&semaphore, pTimer]()
+                {
+                    pTimer->scheduleForDeletion();
+                    semaphore.release();
+                });
+                pTimer->start(std::chrono::milliseconds(5));
+            });
+
+            THEN("timer times out")
+            {
+                REQUIRE(SemaphoreAwaiter::signalSlotAwareWait(semaphore, 10));
+            }
+        }
+    }
+}
+
+
+SCENARIO("EpollEventDispatcher activates Qt socket notifiers")
+{
+    GIVEN("a thread running an epoll event dispatcher and a connected pair of sockets")
+    {
+        DispatcherThread dispatcherThread;
+        int socketPair[2] = {-1, -1};
+        REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, socketPair) == 0);
+
+        WHEN("a read notifier is created for one socket and data is written on the other")
+        {
+            QSemaphore notifierCreatedSemaphore;
+            QSemaphore notifierDeletedSemaphore;
+            dispatcherThread.run([&]()
+            {
+                auto *pNotifier = new QSocketNotifier(socketPair[0], QSocketNotifier::Read, dispatcherThread.pContext);
+                QObject::connect(pNotifier, &QSocketNotifier::activated, pNotifier, [&, pNotifier]()
+                {
+                    char data = 0;
+                    REQUIRE(::read(socketPair[0], &data, 1) == 1);
+                    REQUIRE(data == 'k');
+                    pNotifier->deleteLater();
+                    notifierDeletedSemaphore.release();
+                });
+                notifierCreatedSemaphore.release();
+            });
+            REQUIRE(SemaphoreAwaiter::signalSlotAwareWait(notifierCreatedSemaphore, 10));
+            REQUIRE(::write(socketPair[1], "k", 1) == 1);
+
+            THEN("notifier is activated on the dispatcher thread")
+            {
+                REQUIRE(SemaphoreAwaiter::signalSlotAwareWait(notifierDeletedSemaphore, 10));
+            }
+        }
+        ::close(socketPair[0]);
+        ::close(socketPair[1]);
+    }
+}
@@ -16,25 +16,34 @@
 //
 
 #include "EpollEventNotifier.h"
+#include "EpollEventDispatcher.h"
 #include "EpollEventSource.h"
 #include "EpollTimerRegistrar.h"
 #include "EpollObjectDeleter.h"
 #include "EpollReadyEventSourceRegistrar.h"
+#include "IoUring.h"
 #include "UnixUtils.h"
 #include "NoDestroy.h"
+#include <sys/socket.h>
+#include <poll.h>
 
 
 namespace Kourier
 {
 
 EpollEventNotifier::EpollEventNotifier()
-    : m_epollInstanceFd(epoll_create1(0)),
-    m_pEpollSocketNotifier(new QSocketNotifier(m_epollInstanceFd, QSocketNotifier::Read))
+    : m_epollInstanceFd(epoll_create1(0))
 {
     if (m_epollInstanceFd < 0)
         qFatal("Failed to create epoll instance. Exiting.");
     m_epollEventsCache.resize(m_maxNumberOfTriggeredEvents);
-    QObject::connect(m_pEpollSocketNotifier, &QSocketNotifier::activated, m_pEpollSocketNotifier, [this]{this->processEvents();});
+    // When the thread runs on an EpollEventDispatcher, the dispatcher blocks on our epoll
+    // instance directly. Otherwise, we nest our epoll instance inside Qt's event dispatcher.
+    if (!EpollEventDispatcher::isRunningOnCurrentThread())
+    {
+        m_pEpollSocketNotifier = new QSocketNotifier(m_epollInstanceFd, QSocketNotifier::Read);
+        QObject::connect(m_pEpollSocketNotifier, &QSocketNotifier::activated, m_pEpollSocketNotifier, [this]{this->processEvents();});
+    }
     m_pTimerRegistrar = new EpollTimerRegistrar(this);
     m_pTimerRegistrar->m_enabled = true;
     add(m_pTimerRegistrar);
@@ -84,6 +93,17 @@ void EpollEventNotifier::removePostedEvents(EpollEventSource *pEpollEventSource)
         m_pReadyEventRegistrar->removeReadyEvent(pEpollEventSource);
 }
 
+// Returns true if the current thread's notifier waits for events on an io_uring instance.
+bool EpollEventNotifier::enableIoUringOnCurrentThread()
+{
+    return current()->enableIoUring();
+}
+
+bool EpollEventNotifier::isUsingIoUringOnCurrentThread()
+{
+    return current()->isUsingIoUring();
+}
+
 EpollEventNotifier *EpollEventNotifier::current()
 {
     static thread_local NoDestroy<EpollEventNotifier> epollEventNotifier;
@@ -91,31 +111,35 @@ EpollEventNotifier *EpollEventNotifier::current()
     return &(epollEventNotifier());
 }
 
-void EpollEventNotifier::add(EpollEventSource *pEpollEventSource) const
+void EpollEventNotifier::add(EpollEventSource *pEpollEventSource)
 {
     if (m_isActive)
     {
         epoll_event epollEvent{0, nullptr};
         epollEvent.events = pEpollEventSource->eventTypes();
         epollEvent.data.ptr = pEpollEventSource;
+        ++m_epollCtlCount;
         if (0 == epoll_ctl(m_epollInstanceFd, EPOLL_CTL_ADD, pEpollEventSource->fileDescriptor(), &epollEvent))
-            return;
+            pEpollEventSource->m_registeredEventTypes = pEpollEventSource->eventTypes();
         else
             qFatal("Failed to add event source to epoll instance. Exiting.");
     }
 }
 
+// Changes to the event types of sources made while events are being processed are journaled and
+// applied once, after all events of the iteration are processed. Sources that change their event
+// types back and forth within an iteration do not cost any epoll_ctl call.
 void EpollEventNotifier::modify(EpollEventSource *pEpollEventSource)
 {
     if (m_isActive)
     {
-        epoll_event epollEvent{0, nullptr};
-        epollEvent.events = pEpollEventSource->eventTypes();
-        epollEvent.data.ptr = pEpollEventSource;
-        if (0 == epoll_ctl(m_epollInstanceFd, EPOLL_CTL_MOD, pEpollEventSource->fileDescriptor(), &epollEvent))
-            removeEventSourceFromPendingEvents(pEpollEventSource);
-        else
-            qFatal("Failed to modify event source of epoll instance. Exiting.");
+        if (!m_isProcessingEvents)
+            applyModification(pEpollEventSource);
+        else if (!pEpollEventSource->m_hasPendingModification)
+        {
+            pEpollEventSource->m_hasPendingModification = true;
+            m_pendingModifications.push_back(pEpollEventSource);
+        }
     }
 }
 
@@ -123,6 +147,13 @@ void EpollEventNotifier::remove(EpollEventSource *pEpollEventSource)
 {
     if (m_isActive)
     {
+        cancelRingOperation(pEpollEventSource);
+        if (pEpollEventSource->m_hasPendingModification)
+        {
+            pEpollEventSource->m_hasPendingModification = false;
+            std::erase(m_pendingModifications, pEpollEventSource);
+        }
+        ++m_epollCtlCount;
         if (0 == epoll_ctl(m_epollInstanceFd, EPOLL_CTL_DEL, pEpollEventSource->fileDescriptor(), nullptr))
             removeEventSourceFromPendingEvents(pEpollEventSource);
         else
@@ -130,22 +161,83 @@ void EpollEventNotifier::remove(EpollEventSource *pEpollEventSource)
     }
 }
 
-void EpollEventNotifier::processEvents()
+bool EpollEventNotifier::processEvents(int timeoutInMSecs)
 {
     if (m_isActive && !m_isProcessingEvents)
     {
         m_isProcessingEvents = true;
-        // no problem if we get interrupted by a signal
-        auto * const pData = m_epollEventsCache.data();
-        m_triggeredEventsCount = ::epoll_wait(m_epollInstanceFd, pData, EpollEventNotifier::m_maxNumberOfTriggeredEvents, 0);
-        for (m_idx = 0; m_idx < m_triggeredEventsCount; ++m_idx)
+        ++m_iterationCount;
+        bool hasProcessedEvents = false;
+        if (!m_pIoUring)
+            hasProcessedEvents = (dispatchEpollEvents(timeoutInMSecs) > 0);
+        else
         {
-            auto *pEvent = static_cast<EpollEventSource*>(pData[m_idx].data.ptr);
-            if (pEvent && pEvent->isEnabled())
-                pEvent->onEvent(pData[m_idx].events);
+            // Requests queued since the last iteration are submitted by the same syscall that
+            // waits for completions. Readiness of epoll-based sources arrives as a completion too.
+            m_pIoUring->submitAndWait(timeoutInMSecs);
+            hasProcessedEvents = m_pIoUring->processCompletions([this](uint64_t userData, int32_t result, uint32_t flags)
+            {
+                onRingCompletion(userData, result, flags);
+            }) > 0;
         }
+        applyPendingModifications();
         m_isProcessingEvents = false;
+        if (m_pIoUring)
+            submitIfNested();
+        return hasProcessedEvents;
+    }
+    else
+        return false;
+}
+
+int EpollEventNotifier::dispatchEpollEvents(int timeoutInMSecs)
+{
+    // no problem if we get interrupted by a signal
+    auto * const pData = m_epollEventsCache.data();
+    const int triggeredEventsCount = ::epoll_wait(m_epollInstanceFd, pData, EpollEventNotifier::m_maxNumberOfTriggeredEvents, timeoutInMSecs);
+    m_triggeredEventsCount = triggeredEventsCount;
+    for (m_idx = 0; m_idx < m_triggeredEventsCount; ++m_idx)
+    {
+        auto *pEvent = static_cast<EpollEventSource*>(pData[m_idx].data.ptr);
+        if (pEvent && pEvent->isEnabled())
+        {
+            // Sources whose event types changed earlier in this iteration only get the events they still want.
+            const uint32_t events = !pEvent->m_hasPendingModification
+                                        ? pData[m_idx].events
+                                        : (pData[m_idx].events & (pEvent->eventTypes() | EPOLLERR | EPOLLHUP));
+            if (events != 0)
+                pEvent->onEvent(events);
+        }
     }
+    m_triggeredEventsCount = 0;
+    return triggeredEventsCount;
+}
+
+void EpollEventNotifier::applyModification(EpollEventSource *pEpollEventSource)
+{
+    if (pEpollEventSource->eventTypes() == pEpollEventSource->m_registeredEventTypes)
+        return;
+    epoll_event epollEvent{0, nullptr};
+    epollEvent.events = pEpollEventSource->eventTypes();
+    epollEvent.data.ptr = pEpollEventSource;
+    ++m_epollCtlCount;
+    if (0 == epoll_ctl(m_epollInstanceFd, EPOLL_CTL_MOD, pEpollEventSource->fileDescriptor(), &epollEvent))
+    {
+        pEpollEventSource->m_registeredEventTypes = pEpollEventSource->eventTypes();
+        removeEventSourceFromPendingEvents(pEpollEventSource);
+    }
+    else
+        qFatal("Failed to modify event source of epoll instance. Exiting.");
+}
+
+void EpollEventNotifier::applyPendingModifications()
+{
+    for (auto *pEpollEventSource : m_pendingModifications)
+    {
+        pEpollEventSource->m_hasPendingModification = false;
+        applyModification(pEpollEventSource);
+    }
+    m_pendingModifications.clear();
 }
 
 void EpollEventNotifier::removeEventSourceFromPendingEvents(EpollEventSource *pEventSource)
@@ -169,6 +261,11 @@ void EpollEventNotifier::clear()
     {
         delete m_pEpollSocketNotifier;
         m_pEpollSocketNotifier = nullptr;
+        // Closing the ring cancels all of its requests.
+        m_pIoUring.reset();
+        m_ringOperations.clear();
+        m_freeRingOperations.clear();
+        m_pendingModifications.clear();
         m_epollEventsCache.clear();
         m_epollEventsCache.squeeze();
         m_pTimerRegistrar->m_enabled = false;
@@ -185,4 +282,191 @@ void EpollEventNotifier::clear()
     }
 }
 
+// Threads can switch to io_uring once, before any ring operation is requested. The epoll instance is kept
+// and polled through the ring, so that event sources that are not ring-aware work unchanged. Sockets,
+// listeners and clock tickers use ring operations when they start after the switch.
+bool EpollEventNotifier::enableIoUring()
+{
+    if (m_pIoUring)
+        return true;
+    if (!m_isActive || !IoUring::isSupported())
+        return false;
+    // Deferring kernel work to the next io_uring_enter call is only safe when this notifier drives the
+    // event loop. Otherwise, Qt's dispatcher waits for the ring's file descriptor to become readable.
+    const bool isNestedInQt = (m_pEpollSocketNotifier != nullptr);
+    auto pIoUring = std::make_unique<IoUring>(1024, 16384, !isNestedInQt);
+    if (!pIoUring->isValid() || !pIoUring->setupProvidedBuffers(m_receiveBufferGroupId, m_receiveBufferCount, m_receiveBufferSize))
+        return false;
+    m_pIoUring = std::move(pIoUring);
+    if (isNestedInQt)
+    {
+        delete m_pEpollSocketNotifier;
+        m_pEpollSocketNotifier = new QSocketNotifier(m_pIoUring->fileDescriptor(), QSocketNotifier::Read);
+        QObject::connect(m_pEpollSocketNotifier, &QSocketNotifier::activated, m_pEpollSocketNotifier, [this]{this->processEvents();});
+    }
+    pollEpollInstance();
+    m_pIoUring->submit();
+    return true;
+}
+
+bool EpollEventNotifier::startReceive(EpollEventSource *pEventSource)
+{
+    if (!m_isActive || !m_pIoUring)
+        return false;
+    if (pEventSource->m_ringOperation != 0)
+        return true;
+    const auto operation = addRingOperation(pEventSource, RingOperationType::Receive);
+    auto * const pSqe = m_pIoUring->getSubmissionQueueEntry();
+    if (!pSqe) [[unlikely]]
+        qFatal("Failed to queue receive operation on io_uring instance. Exiting.");
+    pSqe->opcode = IORING_OP_RECV;
+    pSqe->fd = static_cast<int32_t>(pEventSource->fileDescriptor());
+    pSqe->ioprio = IORING_RECV_MULTISHOT;
+    pSqe->flags = IOSQE_BUFFER_SELECT;
+    pSqe->buf_group = m_receiveBufferGroupId;
+    pSqe->user_data = operation;
+    submitIfNested();
+    return true;
+}
+
+bool EpollEventNotifier::startAccept(EpollEventSource *pEventSource)
+{
+    if (!m_isActive || !m_pIoUring)
+        return false;
+    if (pEventSource->m_ringOperation != 0)
+        return true;
+    const auto operation = addRingOperation(pEventSource, RingOperationType::Accept);
+    auto * const pSqe = m_pIoUring->getSubmissionQueueEntry();
+    if (!pSqe) [[unlikely]]
+        qFatal("Failed to queue accept operation on io_uring instance. Exiting.");
+    pSqe->opcode = IORING_OP_ACCEPT;
+    pSqe->fd = static_cast<int32_t>(pEventSource->fileDescriptor());
+    pSqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    pSqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    pSqe->user_data = operation;
+    submitIfNested();
+    return true;
+}
+
+bool EpollEventNotifier::startTimeout(EpollEventSource *pEventSource, std::chrono::milliseconds interval)
+{
+    if (!m_isActive || !m_pIoUring)
+        return false;
+    if (pEventSource->m_ringOperation != 0)
+        return true;
+    const auto operation = addRingOperation(pEventSource, RingOperationType::Timeout);
+    auto * const pSqe = m_pIoUring->getSubmissionQueueEntry();
+    if (!pSqe) [[unlikely]]
+        qFatal("Failed to queue timeout operation on io_uring instance. Exiting.");
+    // The kernel reads the interval when the request is submitted, which happens right away.
+    const __kernel_timespec timeout{.tv_sec = interval.count() / 1000, .tv_nsec = (interval.count() % 1000) * 1000000};
+    pSqe->opcode = IORING_OP_TIMEOUT;
+    pSqe->addr = reinterpret_cast<uint64_t>(&timeout);
+    pSqe->len = 1;
+    pSqe->timeout_flags = IORING_TIMEOUT_MULTISHOT;
+    pSqe->user_data = operation;
+    if (m_pIoUring->submit() < 0) [[unlikely]]
+        qFatal("Failed to submit timeout operation to io_uring instance. Exiting.");
+    return true;
+}
+
+// Cancelled operations keep their slot until their last completion arrives, as completions
+// posted before the cancellation are still to be processed. Only the source is detached.
+void EpollEventNotifier::cancelRingOperation(EpollEventSource *pEventSource)
+{
+    if (!m_isActive || !m_pIoUring || pEventSource->m_ringOperation == 0)
+        return;
+    const uint32_t operation = pEventSource->m_ringOperation - 1;
+    pEventSource->m_ringOperation = 0;
+    m_ringOperations[operation].pEventSource = nullptr;
+    auto * const pSqe = m_pIoUring->getSubmissionQueueEntry();
+    if (!pSqe) [[unlikely]]
+        qFatal("Failed to queue cancel operation on io_uring instance. Exiting.");
+    pSqe->opcode = (m_ringOperations[operation].type == RingOperationType::Timeout) ? IORING_OP_TIMEOUT_REMOVE : IORING_OP_ASYNC_CANCEL;
+    pSqe->addr = operation;
+    pSqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+    pSqe->user_data = m_ignoredUserData;
+    submitIfNested();
+}
+
+const char *EpollEventNotifier::receivedData(uint16_t bufferId) const
+{
+    return m_pIoUring ? m_pIoUring->providedBuffer(bufferId) : nullptr;
+}
+
+void EpollEventNotifier::recycleReceiveBuffer(uint16_t bufferId)
+{
+    if (m_pIoUring)
+        m_pIoUring->recycleProvidedBuffer(bufferId);
+}
+
+uint32_t EpollEventNotifier::addRingOperation(EpollEventSource *pEventSource, RingOperationType type)
+{
+    uint32_t operation = 0;
+    if (!m_freeRingOperations.empty())
+    {
+        operation = m_freeRingOperations.back();
+        m_freeRingOperations.pop_back();
+    }
+    else
+    {
+        operation = static_cast<uint32_t>(m_ringOperations.size());
+        m_ringOperations.emplace_back();
+    }
+    m_ringOperations[operation] = RingOperation{pEventSource, type};
+    pEventSource->m_ringOperation = operation + 1;
+    return operation;
+}
+
+void EpollEventNotifier::onRingCompletion(uint64_t userData, int32_t result, uint32_t flags)
+{
+    if (userData == m_epollInstanceUserData)
+    {
+        dispatchEpollEvents(0);
+        if (m_isActive)
+            pollEpollInstance();
+        return;
+    }
+    else if (userData == m_ignoredUserData)
+        return;
+    const auto operation = static_cast<uint32_t>(userData);
+    assert(operation < m_ringOperations.size());
+    auto * const pEventSource = m_ringOperations[operation].pEventSource;
+    const auto type = m_ringOperations[operation].type;
+    if (!(flags & IORING_CQE_F_MORE))
+    {
+        m_ringOperations[operation].pEventSource = nullptr;
+        m_freeRingOperations.push_back(operation);
+        if (pEventSource)
+            pEventSource->m_ringOperation = 0;
+    }
+    if (pEventSource)
+        pEventSource->onCompletion(result, flags);
+    else if (type == RingOperationType::Receive && (flags & IORING_CQE_F_BUFFER))
+        m_pIoUring->recycleProvidedBuffer(static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT));
+    else if (type == RingOperationType::Accept && result >= 0)
+        UnixUtils::safeClose(result);
+}
+
+// The epoll instance is polled with one-shot requests that are rearmed after its events are
+// dispatched, as epoll instances stay readable until all of their events are fetched.
+void EpollEventNotifier::pollEpollInstance()
+{
+    auto * const pSqe = m_pIoUring->getSubmissionQueueEntry();
+    if (!pSqe) [[unlikely]]
+        qFatal("Failed to queue poll operation on io_uring instance. Exiting.");
+    pSqe->opcode = IORING_OP_POLL_ADD;
+    pSqe->fd = m_epollInstanceFd;
+    pSqe->poll32_events = POLLIN;
+    pSqe->user_data = m_epollInstanceUserData;
+}
+
+// When nested in Qt's event dispatcher, nothing else submits queued requests, as
+// Qt only waits for the ring's file descriptor to become readable.
+void EpollEventNotifier::submitIfNested()
+{
+    if (m_pEpollSocketNotifier && !m_isProcessingEvents)
+        m_pIoUring->submit();
+}
+
 }
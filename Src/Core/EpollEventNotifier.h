@@ -22,6 +22,9 @@
 #include <QSocketNotifier>
 #include <sys/epoll.h>
 #include <memory.h>
+#include <chrono>
+#include <memory>
+#include <vector>
 
 
 namespace Kourier
@@ -33,6 +36,7 @@ class TimerPrivate;
 class EpollObjectDeleter;
 class Object;
 class EpollReadyEventSourceRegistrar;
+class IoUring;
 
 class KOURIER_EXPORT EpollEventNotifier
 {
@@ -44,19 +48,50 @@ public:
     void scheduleForDeletion(Object *pObject);
     void postEvent(EpollEventSource *pEpollEventSource, uint32_t events);
     void removePostedEvents(EpollEventSource *pEpollEventSource);
+    static bool enableIoUringOnCurrentThread();
+    static bool isUsingIoUringOnCurrentThread();
+    inline bool isUsingIoUring() const {return m_pIoUring != nullptr;}
+    inline uint64_t iterationCount() const {return m_iterationCount;}
+    inline uint64_t epollCtlCount() const {return m_epollCtlCount;}
+
+private:
+    enum class RingOperationType : uint8_t {Receive, Accept, Timeout};
+    struct RingOperation
+    {
+        EpollEventSource *pEventSource = nullptr;
+        RingOperationType type = RingOperationType::Receive;
+    };
 
 private:
     static EpollEventNotifier *current();
-    void add(EpollEventSource *pEpollEventSource) const;
+    void add(EpollEventSource *pEpollEventSource);
     void modify(EpollEventSource *pEpollEventSource);
     void remove(EpollEventSource *pEpollEventSource);
-    void discard(EpollEventSource *pEpollEventSource);
-    void processEvents();
+    void applyModification(EpollEventSource *pEpollEventSource);
+    void applyPendingModifications();
+    bool processEvents(int timeoutInMSecs = 0);
     void removeEventSourceFromPendingEvents(EpollEventSource *pEventSource);
     void clear();
+    int dispatchEpollEvents(int timeoutInMSecs);
+    bool enableIoUring();
+    bool startReceive(EpollEventSource *pEventSource);
+    bool startAccept(EpollEventSource *pEventSource);
+    bool startTimeout(EpollEventSource *pEventSource, std::chrono::milliseconds interval);
+    void cancelRingOperation(EpollEventSource *pEventSource);
+    const char *receivedData(uint16_t bufferId) const;
+    void recycleReceiveBuffer(uint16_t bufferId);
+    uint32_t addRingOperation(EpollEventSource *pEventSource, RingOperationType type);
+    void onRingCompletion(uint64_t userData, int32_t result, uint32_t flags);
+    void pollEpollInstance();
+    void submitIfNested();
 
 private:
     static constexpr size_t m_maxNumberOfTriggeredEvents = static_cast<size_t>(1) << 16;
+    static constexpr uint16_t m_receiveBufferCount = 1024;
+    static constexpr uint32_t m_receiveBufferSize = 4096;
+    static constexpr uint16_t m_receiveBufferGroupId = 0;
+    static constexpr uint64_t m_epollInstanceUserData = static_cast<uint64_t>(1) << 32;
+    static constexpr uint64_t m_ignoredUserData = static_cast<uint64_t>(2) << 32;
     EpollTimerRegistrar *m_pTimerRegistrar = nullptr;
     EpollObjectDeleter *m_pObjectDeleter = nullptr;
     EpollReadyEventSourceRegistrar *m_pReadyEventRegistrar = nullptr;
@@ -65,8 +100,15 @@ private:
     int m_idx = 0;
     QSocketNotifier *m_pEpollSocketNotifier = nullptr;
     QVector<epoll_event> m_epollEventsCache;
+    std::unique_ptr<IoUring> m_pIoUring;
+    std::vector<RingOperation> m_ringOperations;
+    std::vector<uint32_t> m_freeRingOperations;
+    std::vector<EpollEventSource*> m_pendingModifications;
+    uint64_t m_iterationCount = 0;
+    uint64_t m_epollCtlCount = 0;
     bool m_isProcessingEvents = false;
     bool m_isActive = true;
+    friend class EpollEventDispatcher;
     friend class EpollEventSource;
     friend class EpollEventNotifierCleaner;
     friend class Object;
@@ -77,6 +119,7 @@ private:
     friend class TimerWheel;
     friend class ClockTicker;
     friend class TimerNotifier;
+    friend class TcpSocketDataSource;
 };
 
 }
@@ -20,6 +20,7 @@
 
 #include "EpollEventNotifier.h"
 #include "Object.h"
+#include <chrono>
 #include <cstdint>
 
 
@@ -63,15 +64,25 @@ public:
 
 protected:
     virtual void onEvent(uint32_t epollEvents) = 0;
+    virtual void onCompletion(int32_t result, uint32_t flags) {}
+    inline bool hasRingOperation() const {return m_ringOperation != 0;}
+    inline bool startReceive() {return m_pEventNotifier->startReceive(this);}
+    inline bool startAccept() {return m_pEventNotifier->startAccept(this);}
+    inline bool startTimeout(std::chrono::milliseconds interval) {return m_pEventNotifier->startTimeout(this, interval);}
+    inline void cancelRingOperation() {m_pEventNotifier->cancelRingOperation(this);}
 
 private:
     EpollEventNotifier * const m_pEventNotifier;
     EpollEventSource *m_pNext = nullptr;
     EpollEventSource *m_pPrevious = nullptr;
     uint32_t m_eventTypes = 0;
+    uint32_t m_registeredEventTypes = 0;
     uint32_t m_postedEventTypes = 0;
+    uint32_t m_ringOperation = 0;
     bool m_enabled = false;
     bool m_isInReadyList = false;
+    bool m_hasPendingModification = false;
+    friend class EpollEventDispatcher;
     friend class EpollEventNotifier;
     friend class EpollReadyEventSourceRegistrar;
 };
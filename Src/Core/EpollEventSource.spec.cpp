@@ -21,6 +21,7 @@
 #include <Spectator>
 #include <sys/eventfd.h>
 #include <memory.h>
+#include <vector>
 
 using Kourier::EpollEventSource;
 using Kourier::EpollEventNotifier;
@@ -59,6 +60,7 @@ public:
     inline size_t eventCount() const {return m_eventCount;}
     inline uint32_t epollEvents() const {return m_epollEvents;}
     inline void setEventToBeDeleted(std::unique_ptr<EpollEventSourceTest> *pEvent) {m_pOtherEventSourceToBeDeleted = pEvent;}
+    inline void setEventTypesToSetOnEvent(std::vector<uint32_t> eventTypes) {m_eventTypesToSetOnEvent = std::move(eventTypes);}
 
 private:
     void onEvent(uint32_t epollEvents) override
@@ -72,6 +74,8 @@ private:
             m_pOtherEventSourceToBeDeleted->reset(nullptr);
             m_pOtherEventSourceToBeDeleted = nullptr;
         }
+        for (const auto eventTypes : m_eventTypesToSetOnEvent)
+            setEventTypes(eventTypes);
     }
 
 private:
@@ -80,6 +84,7 @@ private:
     size_t &m_eventCount;
     uint32_t m_epollEvents = 0;
     std::unique_ptr<EpollEventSourceTest> *m_pOtherEventSourceToBeDeleted = nullptr;
+    std::vector<uint32_t> m_eventTypesToSetOnEvent;
 };
 
 
@@ -258,3 +263,59 @@ SCENARIO("EpollEventSource can be discarded while events are still pending to be
         }
     }
 }
+
+
+SCENARIO("EpollEventSource applies event type changes made while processing events once per iteration")
+{
+    GIVEN("an epoll event source for a file descriptor-based event that is set to be informed when file descriptor is available for read operations")
+    {
+        const uint32_t eventTypes = EPOLLIN;
+        size_t eventCount = 0;
+        std::unique_ptr<EpollEventSourceTest> pEpollEventSource(new EpollEventSourceTest(eventTypes, eventCount));
+        REQUIRE(pEpollEventSource->eventTypes() == eventTypes);
+        auto * const pEventNotifier = pEpollEventSource->eventNotifier();
+        const uint64_t counter = 1;
+
+        WHEN("event source changes its event types back and forth upon receiving an event")
+        {
+            pEpollEventSource->setEventTypesToSetOnEvent({0, EPOLLIN | EPOLLPRI, EPOLLIN});
+            const auto epollCtlCount = pEventNotifier->epollCtlCount();
+            REQUIRE(sizeof(counter) == UnixUtils::safeWrite(pEpollEventSource->fileDescriptor(), (const char*)&counter, sizeof(counter)));
+            QCoreApplication::processEvents();
+
+            THEN("event notifier does not call epoll_ctl")
+            {
+                REQUIRE(pEpollEventSource->eventCount() == 1);
+                REQUIRE(pEpollEventSource->eventTypes() == eventTypes);
+                REQUIRE(pEventNotifier->epollCtlCount() == epollCtlCount);
+            }
+        }
+
+        WHEN("event source changes its event types several times upon receiving an event")
+        {
+            pEpollEventSource->setEventTypesToSetOnEvent({EPOLLIN | EPOLLPRI, EPOLLIN, 0});
+            const auto epollCtlCount = pEventNotifier->epollCtlCount();
+            REQUIRE(sizeof(counter) == UnixUtils::safeWrite(pEpollEventSource->fileDescriptor(), (const char*)&counter, sizeof(counter)));
+            QCoreApplication::processEvents();
+
+            THEN("event notifier applies the net change with a single epoll_ctl call")
+            {
+                REQUIRE(pEpollEventSource->eventCount() == 1);
+                REQUIRE(pEpollEventSource->eventTypes() == 0);
+                REQUIRE(pEventNotifier->epollCtlCount() == (epollCtlCount + 1));
+
+                AND_WHEN("event is set again")
+                {
+                    REQUIRE(sizeof(counter) == UnixUtils::safeWrite(pEpollEventSource->fileDescriptor(), (const char*)&counter, sizeof(counter)));
+
+                    THEN("onEvent method does not get called")
+                    {
+                        QCoreApplication::processEvents();
+                        REQUIRE(pEpollEventSource->eventCount() == 1);
+                    }
+                }
+            }
+        }
+    }
+}
+
@@ -36,6 +36,24 @@ Writing to IOChannel never fails, as IOChannel grows the internal write buffer i
 IOChannel emits the [sentData](@ref Kourier::IOChannel::sentData) signal whenever it writes to the channel data from its internal
 buffer. You can use the [sentData](@ref Kourier::IOChannel::sentData) signal to adjust data writing according to the channel
 bandwidth to prevent too much memory usage.
+
+IOChannel takes the storage of its buffers from the [BufferPool](@ref Kourier::BufferPool) of the thread that creates it, and only when
+data has to be buffered. Sockets give the storage of empty buffers back to the pool once the slots connected to
+[receivedData](@ref Kourier::IOChannel::receivedData) return and once all pending data is sent, so that idle connections hold no
+buffer memory. Data returned by [readAll](@ref Kourier::IOChannel::readAll) and [slice](@ref Kourier::IOChannel::slice) must not be
+used after the slot returns.
+
+Data written while a [WriteBatch](@ref Kourier::IOChannel::WriteBatch) is alive is only accumulated in the write buffer and is handed
+to the channel with a single write when the outermost batch ends. A response assembled from several small writes then leaves as a
+single send on TCP and as full-size records on TLS, instead of one send or one record per write.
+*/
+
+/*!
+\class Kourier::IOChannel::WriteBatch
+\brief The WriteBatch class accumulates the data written to an IOChannel during its lifetime.
+
+WriteBatch calls [beginWriteBatch](@ref Kourier::IOChannel::beginWriteBatch) when created and
+[flushWriteBatch](@ref Kourier::IOChannel::flushWriteBatch) when destroyed. The IOChannel must outlive the WriteBatch.
 */
 
 /*!
@@ -44,7 +62,8 @@ data read from the channel. The read buffer can grow up to \a readBufferCapacity
 is zero, no limit is set on how much the read buffer can grow.
 */
 IOChannel::IOChannel(const size_t readBufferCapacity)
-    : m_readBuffer(readBufferCapacity)
+    : m_readBuffer(readBufferCapacity, BufferPool::sharedThreadInstance()),
+      m_writeBuffer(0, BufferPool::sharedThreadInstance())
 {
 }
 
@@ -89,6 +108,11 @@ IOChannel::IOChannel(const size_t readBufferCapacity)
  removes up to \a maxSize from the beginning of the read buffer. Returns the number of bytes removed.
 */
 
+/*!
+ \fn IOChannel::moveReadData(size_t targetPos, size_t sourcePos, size_t count)
+ moves \a count bytes of the read buffer starting at \a sourcePos to \a targetPos, which must not be after \a sourcePos. Bytes between \a targetPos and \a sourcePos are overwritten.
+*/
+
 /*!
  \fn IOChannel::read(char *pBuffer, size_t maxSize)
  reads up to \a maxSize from the read buffer into the buffer pointed by \a pBuffer. Returns the number of bytes read from the read buffer.
@@ -104,6 +128,29 @@ IOChannel::IOChannel(const size_t readBufferCapacity)
  writes \a data into the write buffer.
 */
 
+/*!
+ \fn IOChannel::writev(const std::string_view *pSlices, size_t count)
+ writes the \a count slices pointed by \a pSlices, in order, into the write buffer. Subclasses can override this method
+ to gather all slices into a single write to the channel.
+*/
+
+/*!
+ \fn IOChannel::beginWriteBatch()
+ starts a write batch. Until the matching call to [flushWriteBatch](@ref Kourier::IOChannel::flushWriteBatch), written data is only
+ accumulated in the write buffer. Batches can be nested.
+*/
+
+/*!
+ \fn IOChannel::flushWriteBatch()
+ ends the write batch started by the matching call to [beginWriteBatch](@ref Kourier::IOChannel::beginWriteBatch). When the outermost
+ batch ends, all accumulated data is handed to the channel at once.
+*/
+
+/*!
+ \fn IOChannel::isBatchingWrites()
+ returns true if a write batch is in progress.
+*/
+
 /*!
  \fn IOChannel::readBufferCapacity()
  returns the read buffer capacity. A value of zero means that capacity is not limited. If the returned value is positive,
@@ -118,6 +165,21 @@ IOChannel::IOChannel(const size_t readBufferCapacity)
  in the read buffer.
 */
 
+/*!
+ \fn IOChannel::isReadBufferMirrored()
+ returns true if the read buffer maps its pages twice, back to back, so that data wrapping around the end of the buffer is
+ contiguous in memory.
+*/
+
+/*!
+ \fn IOChannel::setReadBufferMirrored(bool mirrored)
+ Sets whether the read buffer maps its pages twice, back to back. Mirrored read buffers let [slice](@ref Kourier::IOChannel::slice)
+ and the request parsers access data that wraps around the end of the buffer without copying it. Mirrored buffers are mapped
+ in whole pages and round their capacity up to a multiple of the page size. Returns true if the read buffer is in the requested mode.
+ Data in the read buffer is preserved. Enabling mirroring fails, and the read buffer keeps being heap-allocated, if the system
+ can not mirror the pages.
+*/
+
 /*!
  \fn IOChannel::clear()
  clears data in read/write buffers and restores them to their initial states. This method preserves the read buffer's
@@ -152,6 +214,7 @@ size_t IOChannel::readDataFromChannel()
 size_t IOChannel::writeDataToChannel()
 {
     const size_t dataSent = m_writeBuffer.isEmpty() ? 0 : m_writeBuffer.read(dataSink());
+    m_writeBuffer.releaseStorage();
     setWriteChannelNotificationEnabled(!m_writeBuffer.isEmpty());
     return dataSent;
 }
@@ -29,12 +29,24 @@ class KOURIER_EXPORT IOChannel : public Object
 {
 KOURIER_OBJECT(Kourier::IOChannel)
 public:
+    class WriteBatch
+    {
+    public:
+        explicit WriteBatch(IOChannel &ioChannel) : m_ioChannel(ioChannel) {m_ioChannel.beginWriteBatch();}
+        WriteBatch(const WriteBatch&) = delete;
+        WriteBatch &operator=(const WriteBatch&) = delete;
+        ~WriteBatch() {m_ioChannel.flushWriteBatch();}
+
+    private:
+        IOChannel &m_ioChannel;
+    };
     IOChannel(const size_t readBufferCapacity = 0);
     ~IOChannel() override = default;
     virtual size_t dataAvailable() const {return m_readBuffer.size();}
     virtual size_t dataToWrite() const {return m_writeBuffer.size();}
     inline char peekChar(size_t index) const {return m_readBuffer.peekChar(index);}
     inline std::string_view slice(size_t pos, size_t count) {return m_readBuffer.slice(pos, count);}
+    inline std::pair<std::string_view, std::string_view> peekSlices(size_t pos, size_t count) const {return m_readBuffer.peekSlices(pos, count);}
     inline std::string_view peekAll() {return m_readBuffer.peekAll();}
     virtual std::string_view readAll()
     {
@@ -51,6 +63,7 @@ public:
         setReadChannelNotificationEnabled((poppedBytes > 0) || !isFull);
         return poppedBytes;
     }
+    inline void moveReadData(size_t targetPos, size_t sourcePos, size_t count) {m_readBuffer.moveData(targetPos, sourcePos, count);}
     virtual size_t read(char *pBuffer, size_t maxSize)
     {
         assert(pBuffer != nullptr && maxSize >= 0);
@@ -63,7 +76,7 @@ public:
     {
         assert(pData != nullptr);
         size_t bytesWritten = 0;
-        if (m_writeBuffer.isEmpty())
+        if (m_writeBuffer.isEmpty() && m_writeBatchDepth == 0)
             bytesWritten = dataSink().write(pData, count);
         if (bytesWritten < count)
             m_writeBuffer.write(pData + bytesWritten, count - bytesWritten);
@@ -71,8 +84,26 @@ public:
         return count;
     }
     inline size_t write(std::string_view data) {return !data.empty() ? write(data.data(), data.size()) : 0;}
+    virtual size_t writev(const std::string_view *pSlices, size_t count)
+    {
+        assert(pSlices != nullptr);
+        size_t bytesWritten = 0;
+        for (size_t i = 0; i < count; ++i)
+            bytesWritten += write(pSlices[i]);
+        return bytesWritten;
+    }
+    inline void beginWriteBatch() {++m_writeBatchDepth;}
+    inline void flushWriteBatch()
+    {
+        assert(m_writeBatchDepth > 0);
+        if (--m_writeBatchDepth == 0)
+            onWriteBatchFinished();
+    }
+    inline bool isBatchingWrites() const {return m_writeBatchDepth > 0;}
     inline size_t readBufferCapacity() const {return m_readBuffer.capacity();}
     inline bool setReadBufferCapacity(size_t capacity) {return m_readBuffer.setCapacity(capacity);}
+    inline bool isReadBufferMirrored() const {return m_readBuffer.isMirrored();}
+    inline bool setReadBufferMirrored(bool mirrored) {return m_readBuffer.setMirrored(mirrored);}
     inline void clear() {m_readBuffer.clear(); m_writeBuffer.clear(); m_isReadNotificationEnabled = true; m_isWriteNotificationEnabled = true;}
     inline bool reset() {return m_readBuffer.reset() && m_writeBuffer.reset();}
     Signal sentData(size_t count);
@@ -103,10 +134,12 @@ protected:
         }
     }
     inline bool isWriteNotificationEnabled() const {return m_isWriteNotificationEnabled;}
+    virtual void onWriteBatchFinished() {writeDataToChannel();}
 
 protected:
     RingBuffer m_readBuffer;
     RingBuffer m_writeBuffer;
+    size_t m_writeBatchDepth = 0;
     bool m_isReadNotificationEnabled = true;
     bool m_isWriteNotificationEnabled = true;
     friend class SimdIterator;
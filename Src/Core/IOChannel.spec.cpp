@@ -59,6 +59,7 @@ public:
     ~DataSinkTest() override = default;
     size_t write(const char *pData, size_t count) override
     {
+        m_writeCount += (count > 0) ? 1 : 0;
         const auto acceptableSize = std::min<size_t>(m_capacity, count);
         m_capacity -= acceptableSize;
         m_data.append(pData, acceptableSize);
@@ -67,9 +68,11 @@ public:
     std::string_view data() const {return m_data;}
     size_t capacity() const {return m_capacity;}
     void addCapacity(size_t capacity) {m_capacity += capacity;}
+    size_t writeCount() const {return m_writeCount;}
 
 private:
     size_t m_capacity = 0;
+    size_t m_writeCount = 0;
     std::string m_data;
 };
 
@@ -361,6 +364,80 @@ SCENARIO("IOChannel supports data writing")
 }
 
 
+SCENARIO("IOChannel supports gathered data writing")
+{
+    GIVEN("a sink with limited capacity and an IOChannel without any data in its write buffer")
+    {
+        IOChannelTest ioChannel;
+        REQUIRE(ioChannel.writeBuffer().isEmpty());
+        const auto sinkCapacity = GENERATE(AS(size_t), 0, 3, 7, 20, 64);
+        ioChannel.dataSinkTest().addCapacity(sinkCapacity);
+
+        WHEN("slices are written to IOChannel")
+        {
+            const std::string_view slices[] = {"HTTP/1.1 200 OK\r\n", "", "Content-Length: 5\r\n", "\r\n", "Hello"};
+            std::string data;
+            for (const auto slice : slices)
+                data.append(slice);
+            const auto dataWritten = ioChannel.writev(slices, std::size(slices));
+
+            THEN("IOChannel writes slices in order to sink and buffers what sink does not accept")
+            {
+                REQUIRE(dataWritten == data.size());
+                const auto bytesInSink = std::min(sinkCapacity, data.size());
+                REQUIRE(ioChannel.dataSinkTest().data() == std::string_view(data).substr(0, bytesInSink));
+                REQUIRE(ioChannel.dataToWrite() == (data.size() - bytesInSink));
+                if (ioChannel.dataToWrite() > 0)
+                    REQUIRE(ioChannel.writeBuffer().peekAll() == std::string_view(data).substr(bytesInSink));
+            }
+        }
+    }
+}
+
+
+SCENARIO("IOChannel supports batched data writing")
+{
+    GIVEN("a sink with limited capacity and an IOChannel without any data in its write buffer")
+    {
+        IOChannelTest ioChannel;
+        REQUIRE(ioChannel.writeBuffer().isEmpty());
+        REQUIRE(!ioChannel.isBatchingWrites());
+        const auto sinkCapacity = GENERATE(AS(size_t), 0, 3, 7, 20, 64);
+        ioChannel.dataSinkTest().addCapacity(sinkCapacity);
+
+        WHEN("data is written to IOChannel in nested write batches")
+        {
+            const std::string_view fragments[] = {"HTTP/1.1 200 OK\r\n", "Content-Length: 5\r\n", "\r\n", "Hello"};
+            std::string data;
+            {
+                IOChannel::WriteBatch outerWriteBatch(ioChannel);
+                {
+                    IOChannel::WriteBatch innerWriteBatch(ioChannel);
+                    for (const auto fragment : fragments)
+                    {
+                        ioChannel.write(fragment);
+                        data.append(fragment);
+                    }
+                }
+                REQUIRE(ioChannel.isBatchingWrites());
+                REQUIRE(ioChannel.dataSinkTest().writeCount() == 0);
+                REQUIRE(ioChannel.dataToWrite() == data.size());
+            }
+
+            THEN("IOChannel writes all data to sink with a single write when the outermost batch ends")
+            {
+                REQUIRE(!ioChannel.isBatchingWrites());
+                REQUIRE(ioChannel.dataSinkTest().writeCount() == 1);
+                const auto bytesInSink = std::min(sinkCapacity, data.size());
+                REQUIRE(ioChannel.dataSinkTest().data() == std::string_view(data).substr(0, bytesInSink));
+                REQUIRE(ioChannel.dataToWrite() == (data.size() - bytesInSink));
+                REQUIRE(ioChannel.isWriteNotificationEnabled() == (ioChannel.dataToWrite() > 0));
+            }
+        }
+    }
+}
+
+
 SCENARIO("IOChannel writes data to channel")
 {
     GIVEN("a sink with capacity to ingest all the data in IOChannel write buffer")
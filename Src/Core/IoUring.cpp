@@ -0,0 +1,393 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+#include "IoUring.h"
+#include "UnixUtils.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+
+namespace Kourier
+{
+
+static int ioUringSetup(uint32_t entries, io_uring_params *pParams)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, pParams));
+}
+
+static int ioUringEnter(int ringFd, uint32_t toSubmit, uint32_t minComplete, uint32_t flags, const void *pArg, size_t argSize)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, pArg, argSize));
+}
+
+static int ioUringRegister(int ringFd, uint32_t opcode, const void *pArg, uint32_t argCount)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, ringFd, opcode, pArg, argCount));
+}
+
+// The ring is set up with raw syscalls, so that Kourier does not depend on liburing. Kernels
+// that do not support the optional setup flags get a ring without them.
+IoUring::IoUring(uint32_t submissionQueueSize, uint32_t completionQueueSize, bool cooperativeTaskRunning)
+{
+    io_uring_params params;
+    const uint32_t setupFlags[] = {IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL | (cooperativeTaskRunning ? IORING_SETUP_COOP_TASKRUN : 0),
+                                   IORING_SETUP_CQSIZE};
+    for (const auto flags : setupFlags)
+    {
+        std::memset(&params, 0, sizeof(params));
+        params.flags = flags;
+        params.cq_entries = std::max(completionQueueSize, 2 * submissionQueueSize);
+        m_ringFd = ioUringSetup(submissionQueueSize, &params);
+        if (m_ringFd >= 0 || errno != EINVAL)
+            break;
+    }
+    if (m_ringFd < 0)
+        return;
+    m_features = params.features;
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP))
+    {
+        destroy();
+        return;
+    }
+    m_ringsSize = std::max<size_t>(params.sq_off.array + params.sq_entries * sizeof(uint32_t),
+                                   params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    m_pRings = ::mmap(nullptr, m_ringsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+    if (m_pRings == MAP_FAILED)
+    {
+        m_pRings = nullptr;
+        destroy();
+        return;
+    }
+    m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void *pSqes = ::mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+    if (pSqes == MAP_FAILED)
+    {
+        destroy();
+        return;
+    }
+    m_pSqes = static_cast<io_uring_sqe*>(pSqes);
+    auto * const pRings = static_cast<char*>(m_pRings);
+    m_pSqHead = reinterpret_cast<uint32_t*>(pRings + params.sq_off.head);
+    m_pSqTail = reinterpret_cast<uint32_t*>(pRings + params.sq_off.tail);
+    m_pSqFlags = reinterpret_cast<uint32_t*>(pRings + params.sq_off.flags);
+    m_sqMask = *reinterpret_cast<uint32_t*>(pRings + params.sq_off.ring_mask);
+    m_sqEntries = params.sq_entries;
+    m_sqLocalTail = *m_pSqTail;
+    // Entries are always filled in ring order, so that the indirection array is set up only once.
+    auto * const pSqArray = reinterpret_cast<uint32_t*>(pRings + params.sq_off.array);
+    for (uint32_t i = 0; i < m_sqEntries; ++i)
+        pSqArray[i] = i;
+    m_pCqHead = reinterpret_cast<uint32_t*>(pRings + params.cq_off.head);
+    m_pCqTail = reinterpret_cast<uint32_t*>(pRings + params.cq_off.tail);
+    m_cqMask = *reinterpret_cast<uint32_t*>(pRings + params.cq_off.ring_mask);
+    m_pCqes = reinterpret_cast<io_uring_cqe*>(pRings + params.cq_off.cqes);
+}
+
+IoUring::~IoUring()
+{
+    destroy();
+}
+
+// Kourier requires multishot accept, multishot recv into provided buffers and multishot timeouts, which
+// are not discoverable through IORING_REGISTER_PROBE. Thus, support is checked once by running them on
+// scratch rings. Provided buffer rings are preferred, and buffers are provided with IORING_OP_PROVIDE_BUFFERS
+// requests if the kernel does not select buffers from rings.
+const IoUring::Capabilities &IoUring::capabilities()
+{
+    static const Capabilities capabilities = []()
+    {
+        Capabilities capabilities;
+        IoUring ring(8, 16);
+        if (!ring.isValid()
+            || !(ring.features() & IORING_FEAT_NODROP)
+            || !(ring.features() & IORING_FEAT_EXT_ARG)
+            || !(ring.features() & IORING_FEAT_CQE_SKIP))
+            return capabilities;
+        capabilities.hasProvidedBufferRings = canReceiveIntoProvidedBuffers(true);
+        if (!capabilities.hasProvidedBufferRings && !canReceiveIntoProvidedBuffers(false))
+            return capabilities;
+        const __kernel_timespec interval{.tv_sec = 0, .tv_nsec = 1000000};
+        auto *pSqe = ring.getSubmissionQueueEntry();
+        pSqe->opcode = IORING_OP_TIMEOUT;
+        pSqe->addr = reinterpret_cast<uint64_t>(&interval);
+        pSqe->len = 1;
+        pSqe->timeout_flags = IORING_TIMEOUT_MULTISHOT;
+        pSqe->user_data = 1;
+        if (ring.submit() != 1)
+            return capabilities;
+        for (int i = 0; i < 10 && !capabilities.isSupported; ++i)
+        {
+            ring.submitAndWait(100);
+            ring.processCompletions([&](uint64_t userData, int32_t result, uint32_t flags)
+            {
+                capabilities.isSupported = capabilities.isSupported || (result == -ETIME && (flags & IORING_CQE_F_MORE));
+            });
+        }
+        return capabilities;
+    }();
+    return capabilities;
+}
+
+bool IoUring::canReceiveIntoProvidedBuffers(bool useProvidedBufferRing)
+{
+    IoUring ring(8, 16);
+    if (!ring.isValid() || !ring.setupProvidedBuffers(0, 2, 64, useProvidedBufferRing))
+        return false;
+    int socketPair[2] = {-1, -1};
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, socketPair) != 0)
+        return false;
+    auto *pSqe = ring.getSubmissionQueueEntry();
+    pSqe->opcode = IORING_OP_RECV;
+    pSqe->fd = socketPair[0];
+    pSqe->ioprio = IORING_RECV_MULTISHOT;
+    pSqe->flags = IOSQE_BUFFER_SELECT;
+    pSqe->buf_group = ring.providedBufferGroupId();
+    pSqe->user_data = 1;
+    bool receivedData = false;
+    bool hasFailed = false;
+    if (ring.submit() > 0 && UnixUtils::safeWrite(socketPair[1], "k", 1) == 1)
+    {
+        for (int i = 0; i < 10 && !receivedData && !hasFailed; ++i)
+        {
+            ring.submitAndWait(100);
+            ring.processCompletions([&](uint64_t userData, int32_t result, uint32_t flags)
+            {
+                receivedData = receivedData || (result == 1 && (flags & IORING_CQE_F_BUFFER) && (flags & IORING_CQE_F_MORE));
+                hasFailed = hasFailed || (result < 0);
+            });
+        }
+    }
+    UnixUtils::safeClose(socketPair[0]);
+    UnixUtils::safeClose(socketPair[1]);
+    return receivedData;
+}
+
+bool IoUring::isSupported()
+{
+    return capabilities().isSupported;
+}
+
+// Recycled buffers are given back before requests that follow them are issued.
+io_uring_sqe *IoUring::getSubmissionQueueEntry()
+{
+    assert(isValid());
+    provideRecycledBuffers();
+    auto *pSqe = reserveSubmissionQueueEntry();
+    if (!pSqe)
+    {
+        submit();
+        pSqe = reserveSubmissionQueueEntry();
+    }
+    return pSqe;
+}
+
+io_uring_sqe *IoUring::reserveSubmissionQueueEntry()
+{
+    if (pendingSubmissionCount() >= m_sqEntries)
+        return nullptr;
+    auto * const pSqe = &m_pSqes[m_sqLocalTail & m_sqMask];
+    std::memset(pSqe, 0, sizeof(io_uring_sqe));
+    ++m_sqLocalTail;
+    return pSqe;
+}
+
+int IoUring::submit()
+{
+    return (pendingSubmissionCount() > 0 || !m_recycledBufferIds.empty()) ? enter(0, 0, -1) : 0;
+}
+
+// Pending requests are submitted with the same syscall that waits for completions. The kernel is only
+// entered without waiting if there are requests to submit or completions it has yet to post.
+int IoUring::submitAndWait(int timeoutInMSecs)
+{
+    // Entering the kernel also runs deferred task work, which
+    // is what completes operations on rings with cooperative task running.
+    if (hasCompletions()
+        && pendingSubmissionCount() == 0
+        && m_recycledBufferIds.empty()
+        && !(std::atomic_ref<uint32_t>(*m_pSqFlags).load(std::memory_order_relaxed) & IORING_SQ_CQ_OVERFLOW))
+        return 0;
+    if (timeoutInMSecs == 0 || hasCompletions())
+        return enter(0, IORING_ENTER_GETEVENTS, -1);
+    else
+        return enter(1, IORING_ENTER_GETEVENTS, timeoutInMSecs);
+}
+
+int IoUring::enter(uint32_t minComplete, uint32_t flags, int timeoutInMSecs)
+{
+    provideRecycledBuffers();
+    const auto toSubmit = pendingSubmissionCount();
+    std::atomic_ref<uint32_t>(*m_pSqTail).store(m_sqLocalTail, std::memory_order_release);
+    __kernel_timespec timeout{.tv_sec = 0, .tv_nsec = 0};
+    io_uring_getevents_arg arg;
+    std::memset(&arg, 0, sizeof(arg));
+    const void *pArg = nullptr;
+    size_t argSize = 0;
+    if (minComplete > 0 && timeoutInMSecs >= 0)
+    {
+        timeout.tv_sec = timeoutInMSecs / 1000;
+        timeout.tv_nsec = (timeoutInMSecs % 1000) * 1000000ll;
+        arg.ts = reinterpret_cast<uint64_t>(&timeout);
+        flags |= IORING_ENTER_EXT_ARG;
+        pArg = &arg;
+        argSize = sizeof(arg);
+    }
+    // Signals and timeouts interrupting the wait are not errors. Requests the kernel could not
+    // take are kept in the submission queue and are submitted on the next call.
+    const int result = ioUringEnter(m_ringFd, toSubmit, minComplete, flags, pArg, argSize);
+    if (result >= 0)
+        return result;
+    else if (errno == EINTR || errno == ETIME)
+        return 0;
+    else
+        return -errno;
+}
+
+bool IoUring::setupProvidedBuffers(uint16_t groupId, uint16_t count, uint32_t size)
+{
+    return setupProvidedBuffers(groupId, count, size, capabilities().hasProvidedBufferRings);
+}
+
+// Buffer ids index fixed-size buffers in a single mapping. The kernel picks
+// buffers from the group and completions tell which buffer holds their data.
+bool IoUring::setupProvidedBuffers(uint16_t groupId, uint16_t count, uint32_t size, bool useProvidedBufferRing)
+{
+    if (!isValid() || m_hasProvidedBuffers || count == 0 || (count & (count - 1)) != 0 || size == 0)
+        return false;
+    void *pBuffers = ::mmap(nullptr, size_t(count) * size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pBuffers == MAP_FAILED)
+        return false;
+    if (useProvidedBufferRing)
+    {
+        const size_t ringSize = size_t(count) * sizeof(io_uring_buf);
+        void *pRing = ::mmap(nullptr, ringSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pRing == MAP_FAILED)
+        {
+            ::munmap(pBuffers, size_t(count) * size);
+            return false;
+        }
+        io_uring_buf_reg bufferRegistration;
+        std::memset(&bufferRegistration, 0, sizeof(bufferRegistration));
+        bufferRegistration.ring_addr = reinterpret_cast<uint64_t>(pRing);
+        bufferRegistration.ring_entries = count;
+        bufferRegistration.bgid = groupId;
+        if (ioUringRegister(m_ringFd, IORING_REGISTER_PBUF_RING, &bufferRegistration, 1) != 0)
+        {
+            ::munmap(pRing, ringSize);
+            ::munmap(pBuffers, size_t(count) * size);
+            return false;
+        }
+        m_pProvidedBufferRing = static_cast<io_uring_buf_ring*>(pRing);
+    }
+    m_pProvidedBuffers = static_cast<char*>(pBuffers);
+    m_providedBufferSize = size;
+    m_providedBufferCount = count;
+    m_providedBufferTail = 0;
+    m_providedBufferGroupId = groupId;
+    m_hasProvidedBuffers = true;
+    m_hasProvidedBufferRing = useProvidedBufferRing;
+    m_recycledBufferIds.reserve(count);
+    for (uint16_t i = 0; i < count; ++i)
+        recycleProvidedBuffer(i);
+    // Buffers are selected when requests are issued. Thus, the initial
+    // buffers are provided right away, before receive requests are queued.
+    return m_hasProvidedBufferRing || enter(0, 0, -1) >= 0;
+}
+
+// Buffers are given back to the kernel right away when using a buffer ring. Otherwise, they
+// are given back with the IORING_OP_PROVIDE_BUFFERS requests submitted on the next kernel entry.
+void IoUring::recycleProvidedBuffer(uint16_t bufferId)
+{
+    assert(m_hasProvidedBuffers && bufferId < m_providedBufferCount);
+    if (m_hasProvidedBufferRing)
+    {
+        auto &buffer = m_pProvidedBufferRing->bufs[m_providedBufferTail & (m_providedBufferCount - 1)];
+        buffer.addr = reinterpret_cast<uint64_t>(providedBuffer(bufferId));
+        buffer.len = m_providedBufferSize;
+        buffer.bid = bufferId;
+        std::atomic_ref<uint16_t>(m_pProvidedBufferRing->tail).store(++m_providedBufferTail, std::memory_order_release);
+    }
+    else
+        m_recycledBufferIds.push_back(bufferId);
+}
+
+// Consecutive buffer ids are given back with a single request. Only successful requests
+// do not post completions, and buffers whose request fails are recycled again.
+void IoUring::provideRecycledBuffers()
+{
+    if (m_recycledBufferIds.empty())
+        return;
+    std::sort(m_recycledBufferIds.begin(), m_recycledBufferIds.end());
+    size_t idx = 0;
+    while (idx < m_recycledBufferIds.size())
+    {
+        auto * const pSqe = reserveSubmissionQueueEntry();
+        if (!pSqe)
+            break;
+        const auto firstBufferId = m_recycledBufferIds[idx];
+        uint32_t bufferCount = 1;
+        while ((idx + bufferCount) < m_recycledBufferIds.size() && m_recycledBufferIds[idx + bufferCount] == firstBufferId + bufferCount)
+            ++bufferCount;
+        pSqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        pSqe->fd = static_cast<int32_t>(bufferCount);
+        pSqe->addr = reinterpret_cast<uint64_t>(providedBuffer(firstBufferId));
+        pSqe->len = m_providedBufferSize;
+        pSqe->off = firstBufferId;
+        pSqe->buf_group = m_providedBufferGroupId;
+        pSqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+        pSqe->user_data = reservedUserDataMask | (uint64_t(bufferCount) << 16) | firstBufferId;
+        idx += bufferCount;
+    }
+    m_recycledBufferIds.erase(m_recycledBufferIds.begin(), m_recycledBufferIds.begin() + idx);
+}
+
+// Closing the ring cancels its in-flight requests and unregisters its buffer ring
+// before the memory they may write to is unmapped.
+void IoUring::destroy()
+{
+    if (m_ringFd >= 0)
+    {
+        UnixUtils::safeClose(m_ringFd);
+        m_ringFd = -1;
+    }
+    if (m_pSqes)
+    {
+        ::munmap(m_pSqes, m_sqesSize);
+        m_pSqes = nullptr;
+    }
+    if (m_pRings)
+    {
+        ::munmap(m_pRings, m_ringsSize);
+        m_pRings = nullptr;
+    }
+    if (m_hasProvidedBuffers)
+    {
+        ::munmap(m_pProvidedBuffers, size_t(m_providedBufferCount) * m_providedBufferSize);
+        m_pProvidedBuffers = nullptr;
+        if (m_hasProvidedBufferRing)
+            ::munmap(m_pProvidedBufferRing, size_t(m_providedBufferCount) * sizeof(io_uring_buf));
+        m_pProvidedBufferRing = nullptr;
+        m_hasProvidedBuffers = false;
+        m_hasProvidedBufferRing = false;
+    }
+}
+
+}
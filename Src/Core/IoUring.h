@@ -0,0 +1,141 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+#ifndef KOURIER_IO_URING_H
+#define KOURIER_IO_URING_H
+
+#include <linux/io_uring.h>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef IORING_TIMEOUT_MULTISHOT
+#define IORING_TIMEOUT_MULTISHOT (1U << 6)
+#endif
+
+
+namespace Kourier
+{
+
+class IoUring
+{
+public:
+    IoUring(uint32_t submissionQueueSize = 1024, uint32_t completionQueueSize = 16384, bool cooperativeTaskRunning = false);
+    IoUring(const IoUring&) = delete;
+    IoUring &operator=(const IoUring&) = delete;
+    ~IoUring();
+    static bool isSupported();
+    inline bool isValid() const {return m_ringFd >= 0;}
+    inline int fileDescriptor() const {return m_ringFd;}
+    inline uint32_t features() const {return m_features;}
+    io_uring_sqe *getSubmissionQueueEntry();
+    inline uint32_t pendingSubmissionCount() const {return m_sqLocalTail - std::atomic_ref<uint32_t>(*m_pSqHead).load(std::memory_order_acquire);}
+    inline bool hasCompletions() const {return std::atomic_ref<uint32_t>(*m_pCqTail).load(std::memory_order_acquire) != *m_pCqHead;}
+    int submit();
+    int submitAndWait(int timeoutInMSecs);
+    template <class T>
+    size_t processCompletions(T &&onCompletion);
+    bool setupProvidedBuffers(uint16_t groupId, uint16_t count, uint32_t size);
+    inline bool hasProvidedBuffers() const {return m_hasProvidedBuffers;}
+    inline uint16_t providedBufferGroupId() const {return m_providedBufferGroupId;}
+    inline uint32_t providedBufferSize() const {return m_providedBufferSize;}
+    inline char *providedBuffer(uint16_t bufferId) const
+    {
+        assert(bufferId < m_providedBufferCount);
+        return m_pProvidedBuffers + size_t(bufferId) * m_providedBufferSize;
+    }
+    void recycleProvidedBuffer(uint16_t bufferId);
+    static constexpr uint64_t reservedUserDataMask = 1ull << 63;
+
+private:
+    struct Capabilities
+    {
+        bool isSupported = false;
+        bool hasProvidedBufferRings = false;
+    };
+    static const Capabilities &capabilities();
+    static bool canReceiveIntoProvidedBuffers(bool useProvidedBufferRing);
+    bool setupProvidedBuffers(uint16_t groupId, uint16_t count, uint32_t size, bool useProvidedBufferRing);
+    io_uring_sqe *reserveSubmissionQueueEntry();
+    void provideRecycledBuffers();
+    void destroy();
+    int enter(uint32_t minComplete, uint32_t flags, int timeoutInMSecs);
+
+private:
+    int m_ringFd = -1;
+    uint32_t m_features = 0;
+    void *m_pRings = nullptr;
+    size_t m_ringsSize = 0;
+    io_uring_sqe *m_pSqes = nullptr;
+    size_t m_sqesSize = 0;
+    uint32_t *m_pSqHead = nullptr;
+    uint32_t *m_pSqTail = nullptr;
+    uint32_t *m_pSqFlags = nullptr;
+    uint32_t m_sqMask = 0;
+    uint32_t m_sqEntries = 0;
+    uint32_t m_sqLocalTail = 0;
+    uint32_t *m_pCqHead = nullptr;
+    uint32_t *m_pCqTail = nullptr;
+    uint32_t m_cqMask = 0;
+    io_uring_cqe *m_pCqes = nullptr;
+    io_uring_buf_ring *m_pProvidedBufferRing = nullptr;
+    char *m_pProvidedBuffers = nullptr;
+    uint32_t m_providedBufferSize = 0;
+    uint16_t m_providedBufferCount = 0;
+    uint16_t m_providedBufferTail = 0;
+    uint16_t m_providedBufferGroupId = 0;
+    std::vector<uint16_t> m_recycledBufferIds;
+    bool m_hasProvidedBuffers = false;
+    bool m_hasProvidedBufferRing = false;
+};
+
+// Completions are consumed before their handler is called, so that handlers can
+// submit new requests and even process completions themselves. Only the completions
+// available when processing starts are handled, so that multishot requests do not
+// starve the callers' other work. Completions of requests the ring submits on its
+// own have reservedUserDataMask set and are not passed to the handler.
+template <class T>
+size_t IoUring::processCompletions(T &&onCompletion)
+{
+    uint32_t head = *m_pCqHead;
+    const uint32_t tail = std::atomic_ref<uint32_t>(*m_pCqTail).load(std::memory_order_acquire);
+    const size_t completionCount = tail - head;
+    while (static_cast<int32_t>(tail - head) > 0)
+    {
+        const io_uring_cqe &cqe = m_pCqes[head & m_cqMask];
+        const uint64_t userData = cqe.user_data;
+        const int32_t result = cqe.res;
+        const uint32_t flags = cqe.flags;
+        std::atomic_ref<uint32_t>(*m_pCqHead).store(++head, std::memory_order_release);
+        if (!(userData & reservedUserDataMask)) [[likely]]
+            onCompletion(userData, result, flags);
+        else if (result < 0)
+        {
+            const auto firstBufferId = static_cast<uint16_t>(userData);
+            const auto bufferCount = static_cast<uint16_t>(userData >> 16);
+            for (uint16_t i = 0; i < bufferCount; ++i)
+                m_recycledBufferIds.push_back(firstBufferId + i);
+        }
+        head = *m_pCqHead;
+    }
+    return completionCount;
+}
+
+}
+
+#endif // KOURIER_IO_URING_H
@@ -0,0 +1,297 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "IoUring.h"
+#include "UnixUtils.h"
+#include <Spectator>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+using Kourier::IoUring;
+using Kourier::UnixUtils;
+
+
+SCENARIO("IoUring receives data into provided buffers with multishot receives")
+{
+    GIVEN("a ring with provided buffers and a multishot receive on a socket")
+    {
+        if (!IoUring::isSupported())
+            return;
+        IoUring ring(8, 64);
+        REQUIRE(ring.isValid());
+        const uint16_t bufferCount = 4;
+        const uint32_t bufferSize = 16;
+        REQUIRE(ring.setupProvidedBuffers(7, bufferCount, bufferSize));
+        REQUIRE(!ring.setupProvidedBuffers(8, bufferCount, bufferSize));
+        int socketPair[2] = {-1, -1};
+        REQUIRE(::socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, socketPair) == 0);
+        const auto startReceive = [&]()
+        {
+            auto *pSqe = ring.getSubmissionQueueEntry();
+            REQUIRE(pSqe != nullptr);
+            pSqe->opcode = IORING_OP_RECV;
+            pSqe->fd = socketPair[0];
+            pSqe->ioprio = IORING_RECV_MULTISHOT;
+            pSqe->flags = IOSQE_BUFFER_SELECT;
+            pSqe->buf_group = ring.providedBufferGroupId();
+            pSqe->user_data = 1;
+        };
+        startReceive();
+        REQUIRE(ring.submit() >= 0);
+        std::string receivedData;
+        bool peerClosedConnection = false;
+        const auto processCompletions = [&]()
+        {
+            ring.submitAndWait(50);
+            ring.processCompletions([&](uint64_t userData, int32_t result, uint32_t flags)
+            {
+                REQUIRE(userData == 1);
+                if (result > 0)
+                {
+                    REQUIRE(flags & IORING_CQE_F_BUFFER);
+                    const auto bufferId = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+                    receivedData.append(ring.providedBuffer(bufferId), result);
+                    ring.recycleProvidedBuffer(bufferId);
+                }
+                else if (result == 0)
+                    peerClosedConnection = true;
+                else
+                    REQUIRE(result == -ENOBUFS);
+                if (!(flags & IORING_CQE_F_MORE) && result != 0)
+                    startReceive();
+            });
+        };
+
+        WHEN("peer sends more data than all provided buffers can hold")
+        {
+            std::string sentData;
+            for (auto i = 0; i < 10; ++i)
+            {
+                const std::string data(30, 'a' + i);
+                sentData.append(data);
+                REQUIRE(UnixUtils::safeWrite(socketPair[1], data.data(), data.size()) == data.size());
+                for (auto j = 0; j < 10 && receivedData.size() < sentData.size(); ++j)
+                    processCompletions();
+            }
+
+            THEN("ring receives all data in order as buffers are recycled")
+            {
+                REQUIRE(receivedData == sentData);
+
+                AND_WHEN("peer closes the connection")
+                {
+                    UnixUtils::safeClose(socketPair[1]);
+                    socketPair[1] = -1;
+                    for (auto j = 0; j < 10 && !peerClosedConnection; ++j)
+                        processCompletions();
+
+                    THEN("receive completes with a zero result")
+                    {
+                        REQUIRE(peerClosedConnection);
+                    }
+                }
+            }
+        }
+        UnixUtils::safeClose(socketPair[0]);
+        if (socketPair[1] >= 0)
+            UnixUtils::safeClose(socketPair[1]);
+    }
+}
+
+
+SCENARIO("IoUring posts a completion for each expiration of multishot timeouts")
+{
+    GIVEN("a ring with a multishot timeout")
+    {
+        if (!IoUring::isSupported())
+            return;
+        IoUring ring(8, 64);
+        REQUIRE(ring.isValid());
+        const __kernel_timespec interval{.tv_sec = 0, .tv_nsec = 5000000};
+        auto *pSqe = ring.getSubmissionQueueEntry();
+        pSqe->opcode = IORING_OP_TIMEOUT;
+        pSqe->addr = reinterpret_cast<uint64_t>(&interval);
+        pSqe->len = 1;
+        pSqe->timeout_flags = IORING_TIMEOUT_MULTISHOT;
+        pSqe->user_data = 1;
+        const auto startTime = std::chrono::steady_clock::now();
+        REQUIRE(ring.submit() == 1);
+
+        WHEN("ring waits for ten expirations")
+        {
+            size_t expirationCount = 0;
+            while (expirationCount < 10)
+            {
+                ring.submitAndWait(1000);
+                ring.processCompletions([&](uint64_t userData, int32_t result, uint32_t flags)
+                {
+                    REQUIRE(userData == 1);
+                    REQUIRE(result == -ETIME);
+                    REQUIRE(flags & IORING_CQE_F_MORE);
+                    ++expirationCount;
+                });
+            }
+            const auto elapsedTime = std::chrono::steady_clock::now() - startTime;
+
+            THEN("expirations happen at the given interval")
+            {
+                REQUIRE(elapsedTime >= std::chrono::milliseconds(48));
+                REQUIRE(elapsedTime < std::chrono::milliseconds(200));
+
+                AND_WHEN("timeout is removed")
+                {
+                    pSqe = ring.getSubmissionQueueEntry();
+                    pSqe->opcode = IORING_OP_TIMEOUT_REMOVE;
+                    pSqe->addr = 1;
+                    pSqe->user_data = 2;
+                    bool removedTimeout = false;
+                    bool timeoutWasCancelled = false;
+                    for (auto i = 0; i < 10 && !(removedTimeout && timeoutWasCancelled); ++i)
+                    {
+                        ring.submitAndWait(50);
+                        ring.processCompletions([&](uint64_t userData, int32_t result, uint32_t flags)
+                        {
+                            if (userData == 2)
+                                removedTimeout = (result == 0);
+                            else if (!(flags & IORING_CQE_F_MORE))
+                                timeoutWasCancelled = (result == -ECANCELED);
+                        });
+                    }
+
+                    THEN("timeout posts a final completion with -ECANCELED")
+                    {
+                        REQUIRE(removedTimeout);
+                        REQUIRE(timeoutWasCancelled);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+SCENARIO("IoUring accepts connections with multishot accepts")
+{
+    GIVEN("a ring with a multishot accept on a listening socket")
+    {
+        if (!IoUring::isSupported())
+            return;
+        IoUring ring(8, 64);
+        REQUIRE(ring.isValid());
+        const int listeningSocket = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        REQUIRE(listeningSocket >= 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t addressSize = sizeof(address);
+        REQUIRE(::bind(listeningSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+        REQUIRE(::listen(listeningSocket, 16) == 0);
+        REQUIRE(::getsockname(listeningSocket, reinterpret_cast<sockaddr*>(&address), &addressSize) == 0);
+        auto *pSqe = ring.getSubmissionQueueEntry();
+        pSqe->opcode = IORING_OP_ACCEPT;
+        pSqe->fd = listeningSocket;
+        pSqe->ioprio = IORING_ACCEPT_MULTISHOT;
+        pSqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+        pSqe->user_data = 1;
+        REQUIRE(ring.submit() == 1);
+
+        WHEN("clients connect to the listening socket")
+        {
+            const auto clientCount = GENERATE(AS(size_t), 1, 5, 12);
+            std::vector<int> clientSockets;
+            for (size_t i = 0; i < clientCount; ++i)
+            {
+                const int clientSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+                REQUIRE(clientSocket >= 0);
+                REQUIRE(::connect(clientSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+                clientSockets.push_back(clientSocket);
+            }
+            std::vector<int> acceptedSockets;
+            for (auto i = 0; i < 20 && acceptedSockets.size() < clientCount; ++i)
+            {
+                ring.submitAndWait(50);
+                ring.processCompletions([&](uint64_t userData, int32_t result, uint32_t flags)
+                {
+                    REQUIRE(userData == 1);
+                    REQUIRE(result >= 0);
+                    REQUIRE(flags & IORING_CQE_F_MORE);
+                    acceptedSockets.push_back(result);
+                });
+            }
+
+            THEN("a single accept request accepts all connections")
+            {
+                REQUIRE(acceptedSockets.size() == clientCount);
+            }
+            for (const auto socket : clientSockets)
+                UnixUtils::safeClose(socket);
+            for (const auto socket : acceptedSockets)
+                UnixUtils::safeClose(socket);
+        }
+        pSqe = ring.getSubmissionQueueEntry();
+        pSqe->opcode = IORING_OP_ASYNC_CANCEL;
+        pSqe->addr = 1;
+        pSqe->user_data = 2;
+        ring.submit();
+        UnixUtils::safeClose(listeningSocket);
+    }
+}
+
+
+SCENARIO("IoUring does not lose completions that overflow the completion queue")
+{
+    GIVEN("a ring with a small completion queue")
+    {
+        if (!IoUring::isSupported())
+            return;
+        IoUring ring(8, 16);
+        REQUIRE(ring.isValid());
+
+        WHEN("more requests than the completion queue can hold are submitted")
+        {
+            const auto requestCount = GENERATE(AS(size_t), 8, 100, 500);
+            for (size_t i = 0; i < requestCount; ++i)
+            {
+                auto *pSqe = ring.getSubmissionQueueEntry();
+                REQUIRE(pSqe != nullptr);
+                pSqe->opcode = IORING_OP_NOP;
+                pSqe->user_data = i;
+            }
+            std::vector<uint64_t> completions;
+            for (auto i = 0; i < 100 && completions.size() < requestCount; ++i)
+            {
+                ring.submitAndWait(completions.empty() ? 10 : 0);
+                ring.processCompletions([&](uint64_t userData, int32_t result, uint32_t flags)
+                {
+                    REQUIRE(result == 0);
+                    completions.push_back(userData);
+                });
+            }
+
+            THEN("ring posts all completions in order")
+            {
+                REQUIRE(completions.size() == requestCount);
+                for (size_t i = 0; i < completions.size(); ++i)
+                    REQUIRE(completions[i] == i);
+            }
+        }
+    }
+}
@@ -0,0 +1,434 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "KernelTls.h"
+#include "RuntimeError.h"
+#include <openssl/core_names.h>
+#include <openssl/kdf.h>
+#include <linux/tls.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <string_view>
+
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+
+
+namespace Kourier
+{
+
+namespace
+{
+
+constexpr unsigned char applicationDataRecordType = 23;
+constexpr unsigned char alertRecordType = 21;
+constexpr unsigned char handshakeRecordType = 22;
+constexpr unsigned char newSessionTicketMessageType = 4;
+constexpr unsigned char closeNotifyAlertDescription = 0;
+constexpr unsigned char userCanceledAlertDescription = 90;
+
+bool fromHex(std::string_view hex, unsigned char *pData, size_t capacity, size_t &size)
+{
+    if (hex.empty() || (hex.size() % 2) != 0 || (hex.size() / 2) > capacity)
+        return false;
+    auto nibble = [](char ch) -> int
+    {
+        if ('0' <= ch && ch <= '9')
+            return ch - '0';
+        else if ('a' <= ch && ch <= 'f')
+            return ch - 'a' + 10;
+        else if ('A' <= ch && ch <= 'F')
+            return ch - 'A' + 10;
+        else
+            return -1;
+    };
+    for (size_t i = 0; i < hex.size(); i += 2)
+    {
+        const auto high = nibble(hex[i]);
+        const auto low = nibble(hex[i + 1]);
+        if (high < 0 || low < 0)
+            return false;
+        pData[i / 2] = (unsigned char)((high << 4) | low);
+    }
+    size = hex.size() / 2;
+    return true;
+}
+
+// RFC8446 7.1. HKDF-Expand-Label(Secret, Label, "", Length)
+bool expandLabel(const unsigned char *pSecret, size_t secretSize, const char *pDigestName, std::string_view label, unsigned char *pOut, size_t outSize)
+{
+    static constexpr std::string_view labelPrefix("tls13 ");
+    unsigned char hkdfLabel[2 + 1 + 255 + 1];
+    size_t hkdfLabelSize = 0;
+    hkdfLabel[hkdfLabelSize++] = (unsigned char)(outSize >> 8);
+    hkdfLabel[hkdfLabelSize++] = (unsigned char)outSize;
+    hkdfLabel[hkdfLabelSize++] = (unsigned char)(labelPrefix.size() + label.size());
+    std::memcpy(hkdfLabel + hkdfLabelSize, labelPrefix.data(), labelPrefix.size());
+    hkdfLabelSize += labelPrefix.size();
+    std::memcpy(hkdfLabel + hkdfLabelSize, label.data(), label.size());
+    hkdfLabelSize += label.size();
+    hkdfLabel[hkdfLabelSize++] = 0;
+    std::unique_ptr<EVP_KDF, decltype(&EVP_KDF_free)> pKdf(EVP_KDF_fetch(nullptr, "HKDF", nullptr), &EVP_KDF_free);
+    if (!pKdf)
+        return false;
+    std::unique_ptr<EVP_KDF_CTX, decltype(&EVP_KDF_CTX_free)> pKdfContext(EVP_KDF_CTX_new(pKdf.get()), &EVP_KDF_CTX_free);
+    if (!pKdfContext)
+        return false;
+    int mode = EVP_KDF_HKDF_MODE_EXPAND_ONLY;
+    const OSSL_PARAM parameters[] = {
+        OSSL_PARAM_construct_utf8_string(OSSL_KDF_PARAM_DIGEST, const_cast<char*>(pDigestName), 0),
+        OSSL_PARAM_construct_int(OSSL_KDF_PARAM_MODE, &mode),
+        OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_KEY, const_cast<unsigned char*>(pSecret), secretSize),
+        OSSL_PARAM_construct_octet_string(OSSL_KDF_PARAM_INFO, hkdfLabel, hkdfLabelSize),
+        OSSL_PARAM_construct_end()
+    };
+    return EVP_KDF_derive(pKdfContext.get(), pOut, outSize, parameters) == 1;
+}
+
+template<class CryptoInfo>
+bool setCryptoInfo(int64_t socketDescriptor,
+                       bool isTransmit,
+                       uint16_t cipherType,
+                       const char *pDigestName,
+                       const unsigned char *pSecret,
+                       size_t secretSize,
+                       uint64_t recordSequence)
+{
+    CryptoInfo cryptoInfo = {};
+    cryptoInfo.info.version = TLS_1_3_VERSION;
+    cryptoInfo.info.cipher_type = cipherType;
+    // TLS 1.3 uses a 12-byte IV. The kernel splits it into the salt and the explicit IV fields.
+    unsigned char iv[sizeof(cryptoInfo.salt) + sizeof(cryptoInfo.iv)];
+    static_assert(sizeof(iv) == 12);
+    bool hasInstalled = expandLabel(pSecret, secretSize, pDigestName, "key", cryptoInfo.key, sizeof(cryptoInfo.key))
+                        && expandLabel(pSecret, secretSize, pDigestName, "iv", iv, sizeof(iv));
+    if (hasInstalled)
+    {
+        std::memcpy(cryptoInfo.salt, iv, sizeof(cryptoInfo.salt));
+        std::memcpy(cryptoInfo.iv, iv + sizeof(cryptoInfo.salt), sizeof(cryptoInfo.iv));
+        for (size_t i = 0; i < sizeof(cryptoInfo.rec_seq); ++i)
+            cryptoInfo.rec_seq[i] = (unsigned char)(recordSequence >> (8 * (sizeof(cryptoInfo.rec_seq) - 1 - i)));
+        hasInstalled = (::setsockopt(socketDescriptor, SOL_TLS, isTransmit ? TLS_TX : TLS_RX, &cryptoInfo, sizeof(cryptoInfo)) == 0);
+    }
+    OPENSSL_cleanse(iv, sizeof(iv));
+    OPENSSL_cleanse(&cryptoInfo, sizeof(cryptoInfo));
+    return hasInstalled;
+}
+
+bool probeKernelTls()
+{
+    // The upper layer protocol can only be installed on connected sockets, so a loopback connection is used.
+    const int listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    const int client = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    int server = -1;
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressSize = sizeof(address);
+    bool isAvailable = listener >= 0
+                       && client >= 0
+                       && ::bind(listener, (sockaddr*)&address, sizeof(address)) == 0
+                       && ::listen(listener, 1) == 0
+                       && ::getsockname(listener, (sockaddr*)&address, &addressSize) == 0
+                       && ::connect(client, (sockaddr*)&address, sizeof(address)) == 0
+                       && (server = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC)) >= 0;
+    if (isAvailable)
+    {
+        static constexpr char upperLayerProtocol[] = "tls";
+        tls12_crypto_info_aes_gcm_128 cryptoInfo = {};
+        cryptoInfo.info.version = TLS_1_3_VERSION;
+        cryptoInfo.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        isAvailable = ::setsockopt(client, SOL_TCP, TCP_ULP, upperLayerProtocol, sizeof(upperLayerProtocol)) == 0
+                      && ::setsockopt(client, SOL_TLS, TLS_RX, &cryptoInfo, sizeof(cryptoInfo)) == 0
+                      && ::setsockopt(client, SOL_TLS, TLS_TX, &cryptoInfo, sizeof(cryptoInfo)) == 0;
+    }
+    for (const int socketDescriptor : {server, client, listener})
+    {
+        if (socketDescriptor >= 0)
+            ::close(socketDescriptor);
+    }
+    return isAvailable;
+}
+
+}
+
+bool KernelTls::isAvailable()
+{
+    static const bool isAvailable = probeKernelTls();
+    return isAvailable;
+}
+
+void KernelTls::prepareContext(SSL_CTX *pContext)
+{
+    assert(pContext != nullptr);
+    SSL_CTX_set_keylog_callback(pContext, &KernelTls::onKeyLog);
+}
+
+void KernelTls::attach(SSL *pSSL)
+{
+    assert(pSSL != nullptr);
+    detach();
+    m_pSSL = pSSL;
+    SSL_set_ex_data(pSSL, exDataIndex(), this);
+    SSL_set_msg_callback(pSSL, &KernelTls::onMessage);
+    SSL_set_msg_callback_arg(pSSL, this);
+}
+
+void KernelTls::detach()
+{
+    if (m_pSSL != nullptr)
+    {
+        SSL_set_ex_data(m_pSSL, exDataIndex(), nullptr);
+        SSL_set_msg_callback(m_pSSL, nullptr);
+        SSL_set_msg_callback_arg(m_pSSL, nullptr);
+    }
+    m_pSSL = nullptr;
+    OPENSSL_cleanse(m_clientSecret.data, sizeof(m_clientSecret.data));
+    OPENSSL_cleanse(m_serverSecret.data, sizeof(m_serverSecret.data));
+    m_clientSecret.size = 0;
+    m_serverSecret.size = 0;
+    m_sentRecordCount = 0;
+    m_receivedRecordCount = 0;
+    m_hasSentFinished = false;
+    m_hasReceivedFinished = false;
+    m_hasInstalledUpperLayerProtocol = false;
+    m_hasFailed = false;
+    m_isEnabled = false;
+    m_hasSentCloseNotify = false;
+    m_hasReceivedCloseNotify = false;
+}
+
+bool KernelTls::canOffload() const
+{
+    if (m_pSSL == nullptr
+        || m_hasFailed
+        || !m_hasSentFinished
+        || !m_hasReceivedFinished
+        || m_clientSecret.size == 0
+        || m_serverSecret.size == 0
+        || SSL_version(m_pSSL) != TLS1_3_VERSION)
+        return false;
+    const auto *pCipher = SSL_get_current_cipher(m_pSSL);
+    if (pCipher == nullptr)
+        return false;
+    switch (SSL_CIPHER_get_protocol_id(pCipher))
+    {
+        case 0x1301: // TLS_AES_128_GCM_SHA256
+        case 0x1302: // TLS_AES_256_GCM_SHA384
+        case 0x1303: // TLS_CHACHA20_POLY1305_SHA256
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Reception is installed first. Kernels that decrypt records with a cipher also encrypt them, and a connection
+// whose reception could not be offloaded can still be served entirely by OpenSSL.
+bool KernelTls::enable(int64_t socketDescriptor)
+{
+    if (m_isEnabled || !canOffload())
+        return m_isEnabled;
+    if (!installUpperLayerProtocol(socketDescriptor) || !installCryptoInfo(socketDescriptor, false))
+    {
+        m_hasFailed = true;
+        return false;
+    }
+    if (!installCryptoInfo(socketDescriptor, true))
+    {
+        // The kernel already decrypts received records and cannot hand them back to OpenSSL.
+        m_hasFailed = true;
+        throw RuntimeError("Failed to enable kernel TLS transmission.", RuntimeError::ErrorType::TLS);
+    }
+    m_isEnabled = true;
+    return true;
+}
+
+KernelTls::ReceiveStatus KernelTls::receive(int64_t socketDescriptor, char *pBuffer, size_t count, size_t &bytesReceived)
+{
+    assert(m_isEnabled && pBuffer != nullptr);
+    bytesReceived = 0;
+    while (count > 0 && !m_hasReceivedCloseNotify)
+    {
+        char control[CMSG_SPACE(sizeof(unsigned char))];
+        iovec vector = {pBuffer, count};
+        msghdr message = {};
+        message.msg_iov = &vector;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        const ssize_t result = ::recvmsg(socketDescriptor, &message, 0);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            else if (errno == EBADMSG || errno == EMSGSIZE)
+                throw RuntimeError("Failed to decrypt data.", RuntimeError::ErrorType::TLS);
+            else if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return ReceiveStatus::WouldBlock;
+            else
+                return ReceiveStatus::EndOfStream;
+        }
+        else if (result == 0)
+            return ReceiveStatus::EndOfStream;
+        const cmsghdr *pControlMessage = CMSG_FIRSTHDR(&message);
+        if (pControlMessage == nullptr
+            || pControlMessage->cmsg_level != SOL_TLS
+            || pControlMessage->cmsg_type != TLS_GET_RECORD_TYPE
+            || *CMSG_DATA(pControlMessage) == applicationDataRecordType)
+        {
+            bytesReceived = result;
+            return ReceiveStatus::Received;
+        }
+        // Records other than application data are consumed here and never reach the caller.
+        switch (*CMSG_DATA(pControlMessage))
+        {
+            case alertRecordType:
+                // RFC8446 6. All alerts but close_notify and user_canceled are fatal, whatever their level.
+                if (result < 2)
+                    throw RuntimeError("Failed to decrypt data.", RuntimeError::ErrorType::TLS);
+                else if ((unsigned char)pBuffer[1] == closeNotifyAlertDescription)
+                    m_hasReceivedCloseNotify = true;
+                else if ((unsigned char)pBuffer[1] != userCanceledAlertDescription)
+                    throw RuntimeError("Received fatal TLS alert.", RuntimeError::ErrorType::TLS);
+                continue;
+            case handshakeRecordType:
+                // Session tickets are not used. Key updates would require rekeying the kernel and are rejected.
+                if ((unsigned char)pBuffer[0] == newSessionTicketMessageType)
+                    continue;
+                throw RuntimeError("Failed to process TLS handshake message received after enabling kernel TLS.", RuntimeError::ErrorType::TLS);
+            default:
+                throw RuntimeError("Failed to decrypt data.", RuntimeError::ErrorType::TLS);
+        }
+    }
+    return m_hasReceivedCloseNotify ? ReceiveStatus::ReceivedCloseNotify : ReceiveStatus::Received;
+}
+
+void KernelTls::sendCloseNotify(int64_t socketDescriptor)
+{
+    assert(m_isEnabled);
+    if (m_hasSentCloseNotify)
+        return;
+    m_hasSentCloseNotify = true;
+    unsigned char alert[2] = {1, closeNotifyAlertDescription};
+    char control[CMSG_SPACE(sizeof(unsigned char))] = {};
+    iovec vector = {alert, sizeof(alert)};
+    msghdr message = {};
+    message.msg_iov = &vector;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    cmsghdr *pControlMessage = CMSG_FIRSTHDR(&message);
+    pControlMessage->cmsg_level = SOL_TLS;
+    pControlMessage->cmsg_type = TLS_SET_RECORD_TYPE;
+    pControlMessage->cmsg_len = CMSG_LEN(sizeof(unsigned char));
+    *CMSG_DATA(pControlMessage) = alertRecordType;
+    ssize_t result = 0;
+    do
+    {
+        result = ::sendmsg(socketDescriptor, &message, MSG_NOSIGNAL);
+    }
+    while (result < 0 && errno == EINTR);
+}
+
+int KernelTls::exDataIndex()
+{
+    static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+void KernelTls::onKeyLog(const SSL *pSSL, const char *pLine)
+{
+    // Key log lines have the format <label> <client random> <secret>, all hex-encoded but the label.
+    auto *pKernelTls = (KernelTls*)SSL_get_ex_data(pSSL, exDataIndex());
+    if (pKernelTls == nullptr || pLine == nullptr)
+        return;
+    std::string_view line(pLine);
+    const auto labelEnd = line.find(' ');
+    const auto clientRandomEnd = line.find(' ', labelEnd != std::string_view::npos ? labelEnd + 1 : line.size());
+    if (clientRandomEnd == std::string_view::npos)
+        return;
+    const auto label = line.substr(0, labelEnd);
+    TrafficSecret *pTrafficSecret = nullptr;
+    if (label == "CLIENT_TRAFFIC_SECRET_0")
+        pTrafficSecret = &pKernelTls->m_clientSecret;
+    else if (label == "SERVER_TRAFFIC_SECRET_0")
+        pTrafficSecret = &pKernelTls->m_serverSecret;
+    else
+        return;
+    if (!fromHex(line.substr(clientRandomEnd + 1), pTrafficSecret->data, sizeof(pTrafficSecret->data), pTrafficSecret->size))
+        pTrafficSecret->size = 0;
+}
+
+void KernelTls::onMessage(int isWrite, int, int contentType, const void *pBuffer, size_t length, SSL*, void *pArg)
+{
+    // Records protected with the application traffic keys are the ones following each side's Finished message.
+    // Their count is the sequence number the kernel continues from.
+    auto *pKernelTls = (KernelTls*)pArg;
+    if (pKernelTls == nullptr)
+        return;
+    if (contentType == SSL3_RT_HEADER)
+    {
+        if (isWrite && pKernelTls->m_hasSentFinished)
+            ++pKernelTls->m_sentRecordCount;
+        else if (!isWrite && pKernelTls->m_hasReceivedFinished)
+            ++pKernelTls->m_receivedRecordCount;
+    }
+    else if (contentType == SSL3_RT_HANDSHAKE && length > 0 && *(const unsigned char*)pBuffer == SSL3_MT_FINISHED)
+    {
+        if (isWrite)
+            pKernelTls->m_hasSentFinished = true;
+        else
+            pKernelTls->m_hasReceivedFinished = true;
+    }
+}
+
+bool KernelTls::installUpperLayerProtocol(int64_t socketDescriptor)
+{
+    if (!m_hasInstalledUpperLayerProtocol && !m_hasFailed)
+    {
+        static constexpr char upperLayerProtocol[] = "tls";
+        m_hasInstalledUpperLayerProtocol = (::setsockopt(socketDescriptor, SOL_TCP, TCP_ULP, upperLayerProtocol, sizeof(upperLayerProtocol)) == 0);
+        m_hasFailed = !m_hasInstalledUpperLayerProtocol;
+    }
+    return m_hasInstalledUpperLayerProtocol;
+}
+
+bool KernelTls::installCryptoInfo(int64_t socketDescriptor, bool isTransmit)
+{
+    const bool isServer = (SSL_is_server(m_pSSL) == 1);
+    const auto &secret = (isTransmit == isServer) ? m_serverSecret : m_clientSecret;
+    const auto recordSequence = isTransmit ? m_sentRecordCount : m_receivedRecordCount;
+    switch (SSL_CIPHER_get_protocol_id(SSL_get_current_cipher(m_pSSL)))
+    {
+        case 0x1301:
+            return setCryptoInfo<tls12_crypto_info_aes_gcm_128>(socketDescriptor, isTransmit, TLS_CIPHER_AES_GCM_128, "SHA256", secret.data, secret.size, recordSequence);
+        case 0x1302:
+            return setCryptoInfo<tls12_crypto_info_aes_gcm_256>(socketDescriptor, isTransmit, TLS_CIPHER_AES_GCM_256, "SHA384", secret.data, secret.size, recordSequence);
+        case 0x1303:
+            return setCryptoInfo<tls12_crypto_info_chacha20_poly1305>(socketDescriptor, isTransmit, TLS_CIPHER_CHACHA20_POLY1305, "SHA256", secret.data, secret.size, recordSequence);
+        default:
+            return false;
+    }
+}
+
+}
@@ -0,0 +1,107 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_KERNEL_TLS_H
+#define KOURIER_KERNEL_TLS_H
+
+#include "RingBuffer.h"
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <cstdint>
+
+
+namespace Kourier
+{
+
+// Moves TLS 1.3 record encryption/decryption of an established connection to the kernel (kTLS).
+// OpenSSL runs the handshake as usual. The traffic secrets are captured through the context's key
+// log callback and the record sequence numbers are tracked through the connection's message callback,
+// so that the kernel can take over the record layer right where OpenSSL left it. Both directions are
+// offloaded together, as OpenSSL cannot keep reading records once the kernel encrypts the ones it sends.
+class KernelTls
+{
+public:
+    enum class ReceiveStatus {Received, WouldBlock, EndOfStream, ReceivedCloseNotify};
+    KernelTls() = default;
+    ~KernelTls() = default;
+    static bool isAvailable();
+    static void prepareContext(SSL_CTX *pContext);
+    void attach(SSL *pSSL);
+    void detach();
+    bool canOffload() const;
+    bool enable(int64_t socketDescriptor);
+    inline bool isEnabled() const {return m_isEnabled;}
+    inline bool isPending() const {return !m_isEnabled && canOffload();}
+    ReceiveStatus receive(int64_t socketDescriptor, char *pBuffer, size_t count, size_t &bytesReceived);
+    inline bool hasReceivedCloseNotify() const {return m_hasReceivedCloseNotify;}
+    void sendCloseNotify(int64_t socketDescriptor);
+
+private:
+    struct TrafficSecret
+    {
+        unsigned char data[EVP_MAX_MD_SIZE];
+        size_t size = 0;
+    };
+    static int exDataIndex();
+    static void onKeyLog(const SSL *pSSL, const char *pLine);
+    static void onMessage(int isWrite, int version, int contentType, const void *pBuffer, size_t length, SSL *pSSL, void *pArg);
+    bool installUpperLayerProtocol(int64_t socketDescriptor);
+    bool installCryptoInfo(int64_t socketDescriptor, bool isTransmit);
+
+private:
+    SSL *m_pSSL = nullptr;
+    TrafficSecret m_clientSecret;
+    TrafficSecret m_serverSecret;
+    uint64_t m_sentRecordCount = 0;
+    uint64_t m_receivedRecordCount = 0;
+    bool m_hasSentFinished = false;
+    bool m_hasReceivedFinished = false;
+    bool m_hasInstalledUpperLayerProtocol = false;
+    bool m_hasFailed = false;
+    bool m_isEnabled = false;
+    bool m_hasSentCloseNotify = false;
+    bool m_hasReceivedCloseNotify = false;
+};
+
+class KernelTlsDataSource : public DataSource
+{
+public:
+    KernelTlsDataSource(KernelTls &kernelTls, DataSource &tcpSocketDataSource, const int64_t &socketDescriptor) :
+        m_kernelTls(kernelTls),
+        m_tcpSocketDataSource(tcpSocketDataSource),
+        m_socketDescriptor(socketDescriptor) {}
+    ~KernelTlsDataSource() override = default;
+    size_t dataAvailable() const override {return m_tcpSocketDataSource.dataAvailable();}
+    size_t read(char *pBuffer, size_t count) override
+    {
+        size_t bytesReceived = 0;
+        m_lastReceiveStatus = m_kernelTls.receive(m_socketDescriptor, pBuffer, count, bytesReceived);
+        return bytesReceived;
+    }
+    bool mayHaveDataAvailable() const override {return m_lastReceiveStatus == KernelTls::ReceiveStatus::Received && dataAvailable() > 0;}
+    inline KernelTls::ReceiveStatus lastReceiveStatus() const {return m_lastReceiveStatus;}
+
+private:
+    KernelTls &m_kernelTls;
+    DataSource &m_tcpSocketDataSource;
+    const int64_t &m_socketDescriptor;
+    KernelTls::ReceiveStatus m_lastReceiveStatus = KernelTls::ReceiveStatus::WouldBlock;
+};
+
+}
+
+#endif // KOURIER_KERNEL_TLS_H
@@ -0,0 +1,48 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "LazyTimer.h"
+#include "DeadlineTracker.h"
+
+
+namespace Kourier
+{
+
+LazyTimer::LazyTimer() :
+    m_pDeadlineTracker(DeadlineTracker::current())
+{
+    m_node.pTimer = this;
+}
+
+LazyTimer::~LazyTimer()
+{
+    m_pDeadlineTracker->remove(this);
+}
+
+void LazyTimer::start(std::chrono::milliseconds interval)
+{
+    m_pDeadlineTracker->start(this, interval);
+}
+
+void LazyTimer::stop()
+{
+    m_pDeadlineTracker->stop(this);
+}
+
+Signal LazyTimer::timeout() KOURIER_SIGNAL(&LazyTimer::timeout)
+
+}
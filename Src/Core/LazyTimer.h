@@ -0,0 +1,53 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_LAZY_TIMER_H
+#define KOURIER_LAZY_TIMER_H
+
+#include "Object.h"
+#include "DeadlineTrackerNode.h"
+#include <chrono>
+
+
+namespace Kourier
+{
+
+class DeadlineTracker;
+
+class LazyTimer : public Object
+{
+KOURIER_OBJECT(Kourier::LazyTimer)
+public:
+    LazyTimer();
+    ~LazyTimer() override;
+    void start(std::chrono::milliseconds interval);
+    void stop();
+    Signal timeout();
+    inline bool isActive() const {return m_isActive;}
+
+private:
+    DeadlineTracker * const m_pDeadlineTracker;
+    DeadlineTrackerNode m_node;
+    int64_t m_deadline = 0;
+    int64_t m_checkTime = 0;
+    bool m_isActive = false;
+    friend class DeadlineTracker;
+};
+
+}
+
+#endif // KOURIER_LAZY_TIMER_H
@@ -0,0 +1,215 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "LazyTimer.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <QSemaphore>
+#include <QElapsedTimer>
+#include <QDeadlineTimer>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <Spectator>
+
+using Kourier::LazyTimer;
+using Kourier::Object;
+using namespace std::chrono_literals;
+
+
+SCENARIO("LazyTimer times out within 1ms of error")
+{
+    GIVEN("a lazy timer set to expire")
+    {
+        LazyTimer timer;
+        const auto intervalInMSecs = GENERATE(AS(std::chrono::milliseconds), 0ms, 3ms, 8ms);
+        QSemaphore semaphore;
+        QElapsedTimer elapsedTimer;
+        qint64 elapsedTimeInMSecs = 0;
+        Object::connect(&timer, &LazyTimer::timeout, [&elapsedTimeInMSecs, &elapsedTimer, &semaphore]()
+        {
+            elapsedTimeInMSecs = elapsedTimer.elapsed();
+            semaphore.release();
+        });
+        elapsedTimer.start();
+        timer.start(intervalInMSecs);
+        REQUIRE(timer.isActive());
+
+        WHEN("we wait until timer expires")
+        {
+            REQUIRE(TRY_ACQUIRE(semaphore, 10));
+
+            THEN("timer times out after given interval with max error of 1ms and becomes inactive")
+            {
+                REQUIRE(std::abs(intervalInMSecs.count() - elapsedTimeInMSecs) <= 1);
+                REQUIRE(!timer.isActive());
+            }
+        }
+    }
+}
+
+
+SCENARIO("Active LazyTimer reschedules its timeout if it is started again")
+{
+    GIVEN("an active lazy timer")
+    {
+        LazyTimer timer;
+        const auto intervalInMSecs = GENERATE(AS(std::chrono::milliseconds), 3ms, 8ms, 5000ms);
+        size_t expirationCount = 0;
+        QElapsedTimer elapsedTimer;
+        qint64 elapsedTimeInMSecs = 0;
+        QSemaphore semaphore;
+        Object::connect(&timer, &LazyTimer::timeout, [&expirationCount, &elapsedTimeInMSecs, &elapsedTimer, &semaphore]()
+        {
+            ++expirationCount;
+            elapsedTimeInMSecs = elapsedTimer.elapsed();
+            semaphore.release();
+        });
+        timer.start(intervalInMSecs);
+        QThread::msleep(2);
+        QCoreApplication::processEvents();
+        REQUIRE(expirationCount == 0);
+
+        WHEN("timer is started again with an interval that makes it expire earlier or later than before")
+        {
+            const auto newIntervalInMSecs = GENERATE(AS(std::chrono::milliseconds), 0ms, 2ms, 9ms);
+            elapsedTimer.start();
+            timer.start(newIntervalInMSecs);
+
+            THEN("timer times out only once, after the new interval")
+            {
+                REQUIRE(TRY_ACQUIRE(semaphore, 10));
+                REQUIRE(std::abs(newIntervalInMSecs.count() - elapsedTimeInMSecs) <= 1);
+                REQUIRE(!TRY_ACQUIRE(semaphore, QDeadlineTimer(intervalInMSecs.count() < 10 ? 12 : 2)));
+                REQUIRE(expirationCount == 1);
+            }
+        }
+    }
+}
+
+
+SCENARIO("LazyTimer does not emit timeout if it is stopped")
+{
+    GIVEN("an active lazy timer")
+    {
+        LazyTimer timer;
+        const auto intervalInMSecs = GENERATE(AS(std::chrono::milliseconds), 0ms, 3ms, 8ms);
+        Object::connect(&timer, &LazyTimer::timeout, [](){Spectator::FAIL("This code is supposed to be unreachable.");});
+        timer.start(intervalInMSecs);
+
+        WHEN("timer is stopped, even after its deadline has passed")
+        {
+            const auto sleepTimeInMSecs = GENERATE(AS(unsigned long), 0, 10);
+            QThread::msleep(sleepTimeInMSecs);
+            timer.stop();
+
+            THEN("timer does not emit timeout signal")
+            {
+                REQUIRE(!timer.isActive());
+                QSemaphore semaphore;
+                REQUIRE(!TRY_ACQUIRE(semaphore, QDeadlineTimer(intervalInMSecs.count() + 2)));
+            }
+        }
+    }
+}
+
+
+SCENARIO("LazyTimers can be deleted and restarted by timeout handlers of other lazy timers")
+{
+    GIVEN("lazy timers that expire at the same time")
+    {
+        static constexpr size_t timerCount = 3;
+        std::unique_ptr<LazyTimer> timers[timerCount];
+        size_t expirationCount[timerCount] = {};
+        QSemaphore semaphore;
+        for (size_t i = 0; i < timerCount; ++i)
+        {
+            timers[i].reset(new LazyTimer);
+            Object::connect(timers[i].get(), &LazyTimer::timeout, [i, &timers, &expirationCount, &semaphore]()
+            {
+                ++expirationCount[i];
+                if (i == 0)
+                {
+                    timers[1].reset();
+                    timers[2]->start(5ms);
+                }
+                semaphore.release();
+            });
+        }
+        for (auto &pTimer : timers)
+            pTimer->start(3ms);
+
+        WHEN("timers expire")
+        {
+            REQUIRE(TRY_ACQUIRE(semaphore, 10));
+
+            THEN("deleted timer does not emit timeout and restarted timer emits timeout after its new interval")
+            {
+                REQUIRE(expirationCount[0] == 1);
+                REQUIRE(expirationCount[1] == 0);
+                REQUIRE(expirationCount[2] == 0);
+                REQUIRE(timers[2]->isActive());
+                REQUIRE(TRY_ACQUIRE(semaphore, 10));
+                REQUIRE(expirationCount[2] == 1);
+                REQUIRE(!TRY_ACQUIRE(semaphore, QDeadlineTimer(10)));
+            }
+        }
+    }
+}
+
+
+SCENARIO("LazyTimer restarted with 0ms by its own timeout handler times out right away")
+{
+    GIVEN("a lazy timer that restarts itself with 0ms when it times out")
+    {
+        static constexpr size_t restartCount = 5;
+        LazyTimer timer;
+        size_t expirationCount = 0;
+        QElapsedTimer elapsedTimer;
+        qint64 elapsedTimeInMSecs = 0;
+        QSemaphore semaphore;
+        Object::connect(&timer, &LazyTimer::timeout, [&timer, &expirationCount, &elapsedTimeInMSecs, &elapsedTimer, &semaphore]()
+        {
+            elapsedTimeInMSecs = elapsedTimer.elapsed();
+            if (++expirationCount <= restartCount)
+            {
+                elapsedTimer.start();
+                timer.start(0ms);
+            }
+            semaphore.release();
+        });
+
+        WHEN("timer is started")
+        {
+            elapsedTimer.start();
+            timer.start(3ms);
+
+            THEN("timer times out again within 1ms of error each time it is restarted")
+            {
+                REQUIRE(TRY_ACQUIRE(semaphore, 10));
+                for (size_t i = 0; i < restartCount; ++i)
+                {
+                    REQUIRE(TRY_ACQUIRE(semaphore, 10));
+                    REQUIRE(elapsedTimeInMSecs <= 1);
+                }
+                REQUIRE(!TRY_ACQUIRE(semaphore, QDeadlineTimer(10)));
+                REQUIRE(expirationCount == restartCount + 1);
+                REQUIRE(!timer.isActive());
+            }
+        }
+    }
+}
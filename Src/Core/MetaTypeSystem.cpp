@@ -36,7 +36,7 @@ quint64 MetaTypeSystem::createUniqueId()
 }
 
 NoDestroy<QMutex> MetaSignalSlotConnection::m_connectionsLock;
-NoDestroy<std::forward_list<std::unique_ptr<MetaSignalSlotConnection>>> MetaSignalSlotConnection::m_connections;
+NoDestroy<std::map<std::pair<quint64, quint64>, std::unique_ptr<MetaSignalSlotConnection>>> MetaSignalSlotConnection::m_connections;
 
 }
 
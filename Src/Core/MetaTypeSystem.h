@@ -172,17 +172,23 @@ private:
 class KOURIER_EXPORT MetaSignalSlotConnection
 {
 public:
+    using T_CallSlotFunction = void (*)(MetaSignalSlotConnection *pConnection, Object *pObject, void *pPackedArgs);
     virtual ~MetaSignalSlotConnection() = default;
     virtual void callSlot(Object *pObject, void *pPackedArgs) = 0;
     quint64 signalId() {return m_signalId;}
     quint64 slotId() {return m_slotId;}
+    // Calls the slot without going through the vtable. Object caches this pointer in its connection table.
+    T_CallSlotFunction callSlotFunction() const {return m_pCallSlotFunction;}
     virtual bool isManaged() {return (m_slotId > 0);}
     template <class T_PtrToSignal, class T_PtrToSlot>
     static constexpr bool checkSignalSlotCompatibility()
     {return checkSignalSlotArgsCompatibility<typename MetaInvocable<T_PtrToSignal>::T_ArgsAsTuple, typename MetaInvocable<T_PtrToSlot>::T_ArgsAsTuple>();}
 
 protected:
-    MetaSignalSlotConnection(quint64 signalId, quint64 slotId) : m_signalId(signalId), m_slotId(slotId) {}
+    MetaSignalSlotConnection(quint64 signalId, quint64 slotId, T_CallSlotFunction pCallSlotFunction) :
+        m_signalId(signalId),
+        m_slotId(slotId),
+        m_pCallSlotFunction(pCallSlotFunction) {}
 
     template <size_t N, class T_Tuple>
     constexpr inline auto truncateTuple(T_Tuple &&tuple)
@@ -218,15 +224,16 @@ protected:
 
 protected:
     static NoDestroy<QMutex> m_connectionsLock;
-    static NoDestroy<std::forward_list<std::unique_ptr<MetaSignalSlotConnection>>> m_connections;
+    static NoDestroy<std::map<std::pair<quint64, quint64>, std::unique_ptr<MetaSignalSlotConnection>>> m_connections;
 
 private:
     const quint64 m_signalId;
     const quint64 m_slotId;
+    const T_CallSlotFunction m_pCallSlotFunction;
 };
 
 template <class T_PtrToSignal, class T_Slot>
-class MetaSignalSlotConnectionT : public MetaSignalSlotConnection
+class MetaSignalSlotConnectionT final : public MetaSignalSlotConnection
 {
 public:
     using SignalInfo = MetaInvocable<T_PtrToSignal>;
@@ -385,28 +392,31 @@ public:
             }
         }
     }
+    static void callSlotDirectly(MetaSignalSlotConnection *pConnection, Object *pObject, void *pPackedArgs)
+    {
+        static_cast<MetaSignalSlotConnectionT*>(pConnection)->MetaSignalSlotConnectionT::callSlot(pObject, pPackedArgs);
+    }
     static MetaSignalSlotConnection *create(T_PtrToSignal pSignal, T_Slot pSlot)
     {
         if constexpr (SlotInfo::type == InvocableType::Functor)
         {
-            return new MetaSignalSlotConnectionT(pSignal, pSlot);
+            return new MetaSignalSlotConnectionT(MetaTypeSystem::metaInvocableId(pSignal), 0, pSignal, pSlot);
         }
         else
         {
+            const quint64 signalId = MetaTypeSystem::metaInvocableId(pSignal);
+            const quint64 slotId = MetaTypeSystem::metaInvocableId(pSlot);
             QMutexLocker locker(&m_connectionsLock());
-            for (auto &it : m_connections())
-            {
-                if (it->signalId() == MetaTypeSystem::metaInvocableId(pSignal)
-                    && it->slotId() == MetaTypeSystem::metaInvocableId(pSlot))
-                    return it.get();
-            }
-            return m_connections().emplace_front(new MetaSignalSlotConnectionT(pSignal, pSlot)).get();
+            auto &pConnection = m_connections()[{signalId, slotId}];
+            if (!pConnection)
+                pConnection.reset(new MetaSignalSlotConnectionT(signalId, slotId, pSignal, pSlot));
+            return pConnection.get();
         }
     }
 
 private:
-    MetaSignalSlotConnectionT(T_PtrToSignal pSignal, T_Slot pSlot) :
-        MetaSignalSlotConnection(MetaTypeSystem::metaInvocableId(pSignal), MetaTypeSystem::metaInvocableId(pSlot)),
+    MetaSignalSlotConnectionT(quint64 signalId, quint64 slotId, T_PtrToSignal pSignal, T_Slot pSlot) :
+        MetaSignalSlotConnection(signalId, slotId, &MetaSignalSlotConnectionT::callSlotDirectly),
         m_pSignal(pSignal),
         m_slot(pSlot)
     {
@@ -23,9 +23,12 @@
 #include <QStringList>
 #include <QByteArray>
 #include <QString>
+#include <vector>
+#include <Tests/Resources/AllocationCounter.h>
 #include <Spectator>
 
 using Kourier::Object;
+using Kourier::TestResources::AllocationCounter;
 
 
 namespace Test::Object
@@ -4709,6 +4712,82 @@ private:
 }
 
 
+extern "C"
+{
+void *__real_malloc(size_t size);
+void *__real__Znwm(size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    if (AllocationCounter::isCounting)
+        ++AllocationCounter::count;
+    return __real_malloc(size);
+}
+
+void *__wrap__Znwm(size_t size)
+{
+    if (AllocationCounter::isCounting)
+        ++AllocationCounter::count;
+    return __real__Znwm(size);
+}
+}
+
+
+SCENARIO("Object's connect, emit and disconnect costs")
+{
+    GIVEN("an emitter and a number of receivers")
+    {
+        const auto receiverCount = GENERATE(AS(size_t), 1, 4, 16);
+        constexpr size_t repetitionCount = 100000;
+        EmitterClass emitter;
+        std::vector<TestReceiver> receivers(receiverCount);
+        for (auto &receiver : receivers)
+        {
+            Object::connect(&emitter, &EmitterClass::intSignal, &receiver, &TestReceiver::setValue);
+            Object::disconnect(&emitter, &EmitterClass::intSignal, &receiver, &TestReceiver::setValue);
+        }
+
+        WHEN("receivers are repeatedly connected to, emitted to and disconnected from emitter")
+        {
+            qint64 connectNSecs = 0;
+            qint64 emitNSecs = 0;
+            qint64 disconnectNSecs = 0;
+            size_t allocationCount = 0;
+            QElapsedTimer elapsedTimer;
+            for (size_t i = 0; i < repetitionCount; ++i)
+            {
+                AllocationCounter::start();
+                elapsedTimer.start();
+                for (auto &receiver : receivers)
+                    Object::connect(&emitter, &EmitterClass::intSignal, &receiver, &TestReceiver::setValue);
+                connectNSecs += elapsedTimer.nsecsElapsed();
+                elapsedTimer.start();
+                emitter.intSignal(static_cast<int>(i));
+                emitNSecs += elapsedTimer.nsecsElapsed();
+                elapsedTimer.start();
+                for (auto &receiver : receivers)
+                    Object::disconnect(&emitter, &EmitterClass::intSignal, &receiver, &TestReceiver::setValue);
+                disconnectNSecs += elapsedTimer.nsecsElapsed();
+                allocationCount += AllocationCounter::stop();
+            }
+            const double connectionCount = double(repetitionCount * receiverCount);
+            const double allocationsPerConnection = allocationCount / connectionCount;
+            WARN(QByteArray("Receivers: ").append(QByteArray::number(receiverCount)));
+            WARN(QByteArray("Connect (ns/connection): ").append(QByteArray::number(connectNSecs / connectionCount)));
+            WARN(QByteArray("Emit (ns/emission): ").append(QByteArray::number(emitNSecs / double(repetitionCount))));
+            WARN(QByteArray("Disconnect (ns/connection): ").append(QByteArray::number(disconnectNSecs / connectionCount)));
+            WARN(QByteArray("Allocations per connection: ").append(QByteArray::number(allocationsPerConnection)));
+
+            THEN("connections kept inline in emitter and receivers do not allocate")
+            {
+                if (receiverCount <= 4)
+                    REQUIRE(allocationsPerConnection == 0);
+            }
+        }
+    }
+}
+
+
 #include <malloc.h>
 SCENARIO("Object's signal-slot connection memory consumption")
 {
@@ -45,18 +45,18 @@ Object::~Object()
         *m_pIsDestroyed = true;
         qWarning("Deleting connected Object while emitting. This is supported by Kourier, but may not be what you want. You can use Object::scheduleForDeletion to postpone emitter deletion instead.");
     }
-    while (!m_pConnectedEmitters.empty())
+    while (!m_connectedEmitters.isEmpty())
     {
-        auto * const pObject = m_pConnectedEmitters.begin()->first;
-        m_pConnectedEmitters.erase(m_pConnectedEmitters.begin());
+        auto * const pObject = m_connectedEmitters.last().pEmitter;
+        m_connectedEmitters.removeLast();
         pObject->removeReceiver(*this);
     }
-    for (auto it = m_pSignalSlotConnections.begin(); it != m_pSignalSlotConnections.end(); ++it)
+    for (const auto &connection : m_signalSlotConnections)
     {
-        if (it->pMetaConnection && !it->pMetaConnection->isManaged())
-            delete it->pMetaConnection;
-        if (it->pReceiver)
-            static_cast<Object*>(it->pReceiver)->removeEmitter(*this);
+        if (connection.pMetaConnection && !connection.pMetaConnection->isManaged())
+            delete connection.pMetaConnection;
+        if (connection.pReceiver)
+            static_cast<Object*>(connection.pReceiver)->removeEmitter(*this);
     }
 }
 
@@ -135,14 +135,31 @@ context object, or you can call \link Object::disconnect(Object *pSender, T_PtrT
 
 void Object::addEmitter(Object &emitter)
 {
-    ++(m_pConnectedEmitters.emplace(&emitter, 0).first->second);
+    for (auto &connectedEmitter : m_connectedEmitters)
+    {
+        if (connectedEmitter.pEmitter == &emitter)
+        {
+            ++connectedEmitter.connectionCount;
+            return;
+        }
+    }
+    m_connectedEmitters.append(ConnectedEmitter{.pEmitter = &emitter, .connectionCount = 1});
 }
 
 void Object::removeEmitter(Object &emitter)
 {
-    auto it = m_pConnectedEmitters.find(&emitter);
-    if (it != m_pConnectedEmitters.end() && ((--(it->second)) == 0))
-        m_pConnectedEmitters.erase(it);
+    for (auto it = m_connectedEmitters.begin(); it != m_connectedEmitters.end(); ++it)
+    {
+        if (it->pEmitter == &emitter)
+        {
+            if ((--(it->connectionCount)) == 0)
+            {
+                *it = m_connectedEmitters.last();
+                m_connectedEmitters.removeLast();
+            }
+            return;
+        }
+    }
 }
 
 }
@@ -21,6 +21,7 @@
 #include "MetaTypeSystem.h"
 #include "EpollEventNotifier.h"
 #include <QtGlobal>
+#include <QVarLengthArray>
 
 
 namespace Kourier
@@ -58,6 +59,13 @@ private:
     }
     void addEmitter(Object &emitter);
     void removeEmitter(Object &emitter);
+    inline void addConnection(void *pReceiver, MetaSignalSlotConnection *pMetaConnection)
+    {
+        m_signalSlotConnections.append(SignalSlotConnectionData{.pReceiver = pReceiver,
+                                                                .pMetaConnection = pMetaConnection,
+                                                                .pCallSlot = pMetaConnection->callSlotFunction(),
+                                                                .signalId = pMetaConnection->signalId()});
+    }
     void removeReceiver(Object &receiver) {disconnect(this, nullptr, &receiver, nullptr);}
 
 public:
@@ -82,7 +90,7 @@ public:
         assert(pSender && pReceiver);
         if (pSender && pReceiver)
         {
-            pSender->m_pSignalSlotConnections.push_front(SignalSlotConnectionData{.pReceiver = pReceiver, .pMetaConnection = MetaSignalSlotConnectionT<T_PtrToSignal, T_PtrToSlot>::create(pSignal, pSlot)});
+            pSender->addConnection(pReceiver, MetaSignalSlotConnectionT<T_PtrToSignal, T_PtrToSlot>::create(pSignal, pSlot));
             pReceiver->addEmitter(*pSender);
         }
     }
@@ -99,7 +107,7 @@ public:
         assert(pSender);
         if (pSender)
         {
-            pSender->m_pSignalSlotConnections.push_front(SignalSlotConnectionData{.pReceiver = pReceiver, .pMetaConnection = MetaSignalSlotConnectionT<T_PtrToSignal, T_PtrToSlot>::create(pSignal, pSlot)});
+            pSender->addConnection(pReceiver, MetaSignalSlotConnectionT<T_PtrToSignal, T_PtrToSlot>::create(pSignal, pSlot));
             if (pReceiver)
                 pReceiver->addEmitter(*pSender);
         }
@@ -115,32 +123,32 @@ public:
             return;
         const quint64 signalId = MetaTypeSystem::metaInvocableId(pSignal);
         const quint64 slotId = MetaTypeSystem::metaInvocableId(pSlot);
-        auto itPrev = pSender->m_pSignalSlotConnections.before_begin();
-        for (auto it = pSender->m_pSignalSlotConnections.begin(); it != pSender->m_pSignalSlotConnections.end();)
+        auto &connections = pSender->m_signalSlotConnections;
+        for (qsizetype idx = 0; idx < connections.size();)
         {
-            if (it->pMetaConnection)
+            auto &connection = connections[idx];
+            if (connection.pMetaConnection)
             {
-                const bool hasMatchedReceiver = !pReceiver || pReceiver == it->pReceiver;
-                const bool hasMatchedSignal = !signalId || signalId == it->pMetaConnection->signalId();
-                const bool hasMatchedSlot = !slotId || slotId == it->pMetaConnection->slotId();
+                const bool hasMatchedReceiver = !pReceiver || pReceiver == connection.pReceiver;
+                const bool hasMatchedSignal = !signalId || signalId == connection.signalId;
+                const bool hasMatchedSlot = !slotId || slotId == connection.pMetaConnection->slotId();
                 if (hasMatchedReceiver && hasMatchedSignal && hasMatchedSlot)
                 {
-                    if (!it->pMetaConnection->isManaged())
-                        delete it->pMetaConnection;
-                    it->pMetaConnection = nullptr;
-                    if (it->pReceiver)
-                        static_cast<Object*>(it->pReceiver)->removeEmitter(*pSender);
+                    if (!connection.pMetaConnection->isManaged())
+                        delete connection.pMetaConnection;
+                    connection.pMetaConnection = nullptr;
+                    if (connection.pReceiver)
+                        static_cast<Object*>(connection.pReceiver)->removeEmitter(*pSender);
                     if (!pSender->m_isEmitting)
                     {
-                        it = pSender->m_pSignalSlotConnections.erase_after(itPrev);
+                        connections.remove(idx);
                         continue;
                     }
                     else
                         pSender->m_hasToCleanupConnections = true;
                 }
             }
-            itPrev = it;
-            ++it;
+            ++idx;
         }
     }
     inline void disconnect() {disconnect(this, nullptr, nullptr, nullptr);}
@@ -190,10 +198,15 @@ protected:
         m_pIsDestroyed = !m_isEmitting ? pIsDestroyed : m_pIsDestroyed;
         m_isEmitting = true;
         auto packedArgs = std::forward_as_tuple(args...);
-        for (auto it = m_pSignalSlotConnections.begin(); it != m_pSignalSlotConnections.end(); ++it)
+        // Slots are called from the most recent connection to the oldest one. Connections
+        // made while emitting are appended to the table and are not called by this emission.
+        // Slots can connect to this object and make the table grow, so entries are
+        // accessed by index instead of by reference.
+        for (auto idx = m_signalSlotConnections.size(); idx > 0;)
         {
-            if (it->pMetaConnection && it->pMetaConnection->signalId() == signalId)
-                it->pMetaConnection->callSlot(static_cast<Object*>(it->pReceiver), &packedArgs);
+            const auto &connection = m_signalSlotConnections[--idx];
+            if (connection.signalId == signalId && connection.pMetaConnection)
+                connection.pCallSlot(connection.pMetaConnection, static_cast<Object*>(connection.pReceiver), &packedArgs);
             if (*pIsDestroyed) [[unlikely]]
                 return;
         }
@@ -204,29 +217,29 @@ protected:
             if (m_hasToCleanupConnections)
             {
                 m_hasToCleanupConnections = false;
-                auto itPrev = m_pSignalSlotConnections.before_begin();
-                for (auto it = m_pSignalSlotConnections.begin(); it != m_pSignalSlotConnections.end();)
-                {
-                    if (!it->pMetaConnection)
-                        it = m_pSignalSlotConnections.erase_after(itPrev);
-                    else
-                    {
-                        itPrev = it;
-                        ++it;
-                    }
-                }
+                m_signalSlotConnections.removeIf([](const SignalSlotConnectionData &connection) {return !connection.pMetaConnection;});
             }
         }
     }
 
 private:
-    std::map<Object*, size_t> m_pConnectedEmitters;
+    // Connection tables keep their first entries inline in the object, so wiring up a
+    // typical object (e.g. a connection handler and its socket) does not allocate.
+    static constexpr qsizetype m_inlineConnectionCount = 4;
+    struct ConnectedEmitter
+    {
+        Object *pEmitter = nullptr;
+        size_t connectionCount = 0;
+    };
+    QVarLengthArray<ConnectedEmitter, m_inlineConnectionCount> m_connectedEmitters;
     struct SignalSlotConnectionData
     {
         void *pReceiver = nullptr;
         MetaSignalSlotConnection *pMetaConnection = nullptr;
+        MetaSignalSlotConnection::T_CallSlotFunction pCallSlot = nullptr;
+        quint64 signalId = 0;
     };
-    std::forward_list<SignalSlotConnectionData> m_pSignalSlotConnections;
+    QVarLengthArray<SignalSlotConnectionData, m_inlineConnectionCount> m_signalSlotConnections;
     bool * m_pIsDestroyed = nullptr;
     bool m_isEmitting = false;
     bool m_hasToCleanupConnections = false;
@@ -4004,6 +4004,47 @@ SCENARIO("Object supports connecting to multiple objects")
 }
 
 
+SCENARIO("Object supports connecting more objects than it stores inline while emitting")
+{
+    GIVEN("a functor that connects multiple objects to the signal it is connected to")
+    {
+        outerCounter = 0;
+        EmitterClass emitter;
+        TestObject testObject[10] = {};
+        bool hasConnectedObjects = false;
+        Object::connect(&emitter, &EmitterClass::signal, [&]()
+        {
+            if (hasConnectedObjects)
+                return;
+            hasConnectedObjects = true;
+            for (auto i = 0; i < 10; ++i)
+                Object::connect(&emitter, &EmitterClass::signal, &testObject[i], &TestObject::increaseOuterCounter);
+        });
+
+        WHEN("signal is emitted")
+        {
+            emitter.signal();
+
+            THEN("objects connected while emitting are not called")
+            {
+                REQUIRE(hasConnectedObjects);
+                REQUIRE(0 == outerCounter);
+
+                AND_WHEN("signal is emitted again")
+                {
+                    emitter.signal();
+
+                    THEN("all connected objects are called")
+                    {
+                        REQUIRE(10 == outerCounter);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
 SCENARIO("Object supports connecting to multiple signals")
 {
     GIVEN("an object connected to multiple signals")
@@ -21,6 +21,8 @@
 #include <vector>
 #include <cstring>
 #include <bit>
+#include <sys/mman.h>
+#include <unistd.h>
 
 
 namespace Kourier
@@ -30,19 +32,73 @@ namespace Kourier
 // to optimize data processing.
 constexpr static size_t extraSizeAtBufferEnd = 64;
 
-RingBuffer::RingBuffer(size_t capacity) :
-    m_capacity(capacity)
+static size_t pageSize()
 {
+    static const size_t size = ::sysconf(_SC_PAGESIZE);
+    return size;
+}
+
+static size_t roundUpToPageSize(size_t size)
+{
+    return ((size + pageSize() - 1) / pageSize()) * pageSize();
+}
+
+// Mirrored buffers map the same memfd pages twice, back to back, so that data wrapping
+// around the end of the buffer can be accessed as a single contiguous block. The page
+// following the mirror is kept mapped to serve the extra size used by the SIMD/Data iterators.
+static char *mapMirroredBuffer(size_t capacity)
+{
+    assert(capacity > 0 && (capacity % pageSize()) == 0);
+    const int fd = ::memfd_create("kourier_ring_buffer", MFD_CLOEXEC);
+    if (fd < 0)
+        return nullptr;
+    if (::ftruncate(fd, capacity) != 0)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+    const size_t regionSize = 2 * capacity + pageSize();
+    auto *pRegion = static_cast<char*>(::mmap(nullptr, regionSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (pRegion == MAP_FAILED)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+    if (::mmap(pRegion, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED
+        || ::mmap(pRegion + capacity, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+    {
+        ::munmap(pRegion, regionSize);
+        ::close(fd);
+        return nullptr;
+    }
+    ::close(fd);
+    return pRegion;
+}
+
+// Buffers that gave their storage back point to this block while they are empty.
+alignas(64) static char detachedBuffer[extraSizeAtBufferEnd] = {};
+
+RingBuffer::RingBuffer(size_t capacity, std::shared_ptr<BufferPool> pBufferPool) :
+    m_capacity(capacity),
+    m_pBufferPool(pBufferPool)
+{
+    if (m_pBufferPool)
+    {
+        // Buffers using a pool only take a block from it when data is written to them.
+        m_pBuffer = detachedBuffer;
+        m_pData = m_pBuffer;
+        return;
+    }
     m_currentCapacity = (m_capacity > 0) ? std::min(m_capacity, RingBuffer::defaultCapacity()) : RingBuffer::defaultCapacity();
     m_spaceAvailableAtRightSide = m_currentCapacity;
     m_pBuffer = new char[m_currentCapacity + extraSizeAtBufferEnd];
     m_pData = m_pBuffer;
+    m_storage = Storage::Heap;
 }
 
 RingBuffer::~RingBuffer()
 {
-    if (nullptr != m_pBuffer)
-        delete [] m_pBuffer;
+    releaseStorageBuffer();
 }
 
 size_t RingBuffer::read(char *pData, const size_t maxSize)
@@ -74,8 +130,38 @@ size_t RingBuffer::read(char *pData, const size_t maxSize)
     }
 }
 
+size_t DataSource::readv(char *pFirstBuffer, size_t firstCount, char *pSecondBuffer, size_t secondCount)
+{
+    const auto bytesRead = (firstCount > 0) ? read(pFirstBuffer, firstCount) : 0;
+    if (bytesRead < firstCount || secondCount == 0)
+        return bytesRead;
+    else
+        return bytesRead + read(pSecondBuffer, secondCount);
+}
+
+size_t DataSink::writev(const std::string_view *pSlices, size_t count)
+{
+    size_t bytesWritten = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (pSlices[i].empty())
+            continue;
+        const auto sliceBytesWritten = write(pSlices[i].data(), pSlices[i].size());
+        bytesWritten += sliceBytesWritten;
+        if (sliceBytesWritten < pSlices[i].size())
+            break;
+    }
+    return bytesWritten;
+}
+
 size_t RingBuffer::read(DataSink &dataSink)
 {
+    if (m_leftBlockSize > 0)
+    {
+        // Both blocks are given at once so that sinks can send them with a single gather write.
+        const std::string_view blocks[] = {{m_pData, m_rightBlockSize}, {m_pBuffer, m_leftBlockSize}};
+        return popFront(dataSink.writev(blocks, 2));
+    }
     size_t sizeRead = dataSink.write(m_pData, m_rightBlockSize);
     if (m_rightBlockSize > sizeRead)
     {
@@ -127,25 +213,32 @@ size_t RingBuffer::write(const char *pData, size_t maxSize)
 
 size_t RingBuffer::write(DataSource &dataSource)
 {
-    const size_t dataAvailable = dataSource.dataAvailable();
-    const size_t availableFreeSize = m_currentCapacity - size();
-    if (availableFreeSize < dataAvailable)
-        tryToEnlargeBuffer(dataAvailable - availableFreeSize);
-    size_t writtenSize = dataSource.read(m_pData + m_rightBlockSize, m_spaceAvailableAtRightSide);
-    if (m_spaceAvailableAtRightSide > writtenSize)
-    {
-        m_rightBlockSize += writtenSize;
-        m_spaceAvailableAtRightSide -= writtenSize;
-        return writtenSize;
-    }
-    else
+    // The source is not asked how much data it has, as sockets can only tell it with an extra syscall.
+    // Both free segments are filled with a single read and the buffer only grows when a read fills it up.
+    size_t totalWrittenSize = 0;
+    size_t freeSize = 0;
+    size_t writtenSize = 0;
+    do
     {
-        writtenSize += dataSource.read(m_pBuffer + m_leftBlockSize, m_currentCapacity - size() - m_spaceAvailableAtRightSide);
-        m_rightBlockSize += m_spaceAvailableAtRightSide;
-        m_leftBlockSize += writtenSize - m_spaceAvailableAtRightSide;
-        m_spaceAvailableAtRightSide = 0;
-        return writtenSize;
-    }
+        if (m_currentCapacity == size() && !tryToEnlargeBuffer(std::max<size_t>(1, m_currentCapacity)))
+            break;
+        freeSize = m_currentCapacity - size();
+        const auto spaceAvailableAtLeftSide = freeSize - m_spaceAvailableAtRightSide;
+        writtenSize = dataSource.readv(m_pData + m_rightBlockSize, m_spaceAvailableAtRightSide, m_pBuffer + m_leftBlockSize, spaceAvailableAtLeftSide);
+        if (m_spaceAvailableAtRightSide > writtenSize)
+        {
+            m_rightBlockSize += writtenSize;
+            m_spaceAvailableAtRightSide -= writtenSize;
+        }
+        else
+        {
+            m_rightBlockSize += m_spaceAvailableAtRightSide;
+            m_leftBlockSize += writtenSize - m_spaceAvailableAtRightSide;
+            m_spaceAvailableAtRightSide = 0;
+        }
+        totalWrittenSize += writtenSize;
+    } while (writtenSize == freeSize && dataSource.mayHaveDataAvailable());
+    return totalWrittenSize;
 }
 
 static std::vector<char> *threadLocalBuffer()
@@ -158,7 +251,7 @@ static std::vector<char> *threadLocalBuffer()
 std::string_view RingBuffer::slice(size_t pos, size_t count)
 {
     assert(count > 0 && (pos + count) <= size());
-    if ((pos + count) <= m_rightBlockSize)
+    if (m_isMirrored || (pos + count) <= m_rightBlockSize)
         return std::string_view{m_pData + pos, count};
     else if (pos >= m_rightBlockSize)
         return std::string_view{m_pBuffer + pos - m_rightBlockSize, count};
@@ -179,15 +272,7 @@ std::string_view RingBuffer::slice(size_t pos, size_t count)
         }
         else
         {
-            char *pNewBuffer = new char[m_currentCapacity + extraSizeAtBufferEnd];
-            std::memcpy(pNewBuffer, m_pData, m_rightBlockSize);
-            std::memcpy(pNewBuffer + m_rightBlockSize, m_pBuffer, m_leftBlockSize);
-            delete [] m_pBuffer;
-            m_pBuffer = pNewBuffer;
-            m_pData = pNewBuffer;
-            m_rightBlockSize += m_leftBlockSize;
-            m_leftBlockSize = 0;
-            m_spaceAvailableAtRightSide = m_currentCapacity - m_rightBlockSize;
+            moveDataToNewBuffer(m_currentCapacity, false);
             return std::string_view{m_pData + pos, count};
         }
     }
@@ -219,8 +304,30 @@ size_t RingBuffer::popFront(size_t maxSize)
     }
 }
 
+void RingBuffer::moveData(size_t targetPos, size_t sourcePos, size_t count)
+{
+    assert(targetPos <= sourcePos && (sourcePos + count) <= size());
+    if (targetPos == sourcePos)
+        return;
+    // Data is moved towards the front in runs that are contiguous at both positions.
+    // Runs are moved in order, so no run overwrites source data of a later run.
+    const auto dataAt = [this](size_t pos) {return (pos < m_rightBlockSize) ? (m_pData + pos) : (m_pBuffer + pos - m_rightBlockSize);};
+    const auto contiguousSizeAt = [this](size_t pos) {return (pos < m_rightBlockSize) ? (m_rightBlockSize - pos) : (size() - pos);};
+    while (count > 0)
+    {
+        const auto runSize = std::min({count, contiguousSizeAt(targetPos), contiguousSizeAt(sourcePos)});
+        std::memmove(dataAt(targetPos), dataAt(sourcePos), runSize);
+        targetPos += runSize;
+        sourcePos += runSize;
+        count -= runSize;
+    }
+}
+
 bool RingBuffer::setCapacity(size_t capacity)
 {
+    // Mirrored buffers are mapped in whole pages.
+    if (m_isMirrored)
+        capacity = roundUpToPageSize(capacity);
     if (capacity >= m_currentCapacity || capacity == 0)
     {
         m_capacity = capacity;
@@ -233,17 +340,8 @@ bool RingBuffer::setCapacity(size_t capacity)
         else
         {
             m_capacity = capacity;
-            const auto newCurrentCapacity = std::min<size_t>(m_capacity, std::max<size_t>(defaultCapacity(), std::bit_ceil(size())));
-            char *pNewBuffer = new char[newCurrentCapacity + extraSizeAtBufferEnd];
-            std::memcpy(pNewBuffer, m_pData, m_rightBlockSize);
-            std::memcpy(pNewBuffer + m_rightBlockSize, m_pBuffer, m_leftBlockSize);
-            delete [] m_pBuffer;
-            m_pBuffer = pNewBuffer;
-            m_pData = pNewBuffer;
-            m_currentCapacity = newCurrentCapacity;
-            m_rightBlockSize += m_leftBlockSize;
-            m_leftBlockSize = 0;
-            m_spaceAvailableAtRightSide = m_currentCapacity - m_rightBlockSize;
+            const auto newCurrentCapacity = std::min<size_t>(m_capacity, std::max<size_t>(minimumCapacity(), std::bit_ceil(size())));
+            moveDataToNewBuffer(newCurrentCapacity, m_isMirrored);
             return true;
         }
     }
@@ -251,12 +349,11 @@ bool RingBuffer::setCapacity(size_t capacity)
 
 void RingBuffer::clear()
 {
-    if (m_currentCapacity > defaultCapacity())
-    {
-        m_currentCapacity = defaultCapacity();
-        delete [] m_pBuffer;
-        m_pBuffer = new char[m_currentCapacity + extraSizeAtBufferEnd];
-    }
+    m_pData = m_pBuffer;
+    m_rightBlockSize = 0;
+    m_leftBlockSize = 0;
+    if (!releaseStorage() && m_currentCapacity > minimumCapacity())
+        moveDataToNewBuffer(minimumCapacity(), m_isMirrored);
     m_pData = m_pBuffer;
     m_rightBlockSize = 0;
     m_spaceAvailableAtRightSide = m_currentCapacity;
@@ -276,22 +373,135 @@ bool RingBuffer::reset()
 
 bool RingBuffer::tryToEnlargeBuffer(size_t count)
 {
-    if (m_currentCapacity == m_capacity)
+    if (m_currentCapacity == m_capacity && m_capacity > 0)
         return false;
-    const auto newCurrentCapacityAsPowerOfTwo = std::bit_ceil<size_t>(m_currentCapacity + count);
+    const auto newCurrentCapacityAsPowerOfTwo = std::max<size_t>(minimumCapacity(), std::bit_ceil<size_t>(m_currentCapacity + count));
     const auto newCurrentCapacity = (m_capacity > 0) ? std::min<size_t>(m_capacity, newCurrentCapacityAsPowerOfTwo) : newCurrentCapacityAsPowerOfTwo;
-    char *pNewBuffer = new char[newCurrentCapacity + extraSizeAtBufferEnd];
     assert(newCurrentCapacity > m_currentCapacity);
+    moveDataToNewBuffer(newCurrentCapacity, m_isMirrored);
+    return true;
+}
+
+bool RingBuffer::setMirrored(bool mirrored)
+{
+    if (mirrored == m_isMirrored)
+        return true;
+    if (mirrored)
+    {
+        if (m_capacity > 0)
+            m_capacity = roundUpToPageSize(m_capacity);
+        moveDataToNewBuffer(std::max<size_t>(roundUpToPageSize(m_currentCapacity), pageSize()), true);
+    }
+    else
+        moveDataToNewBuffer(m_currentCapacity, false);
+    return (mirrored == m_isMirrored);
+}
+
+void RingBuffer::setBufferPool(std::shared_ptr<BufferPool> pBufferPool)
+{
+    if (pBufferPool == m_pBufferPool)
+        return;
+    if (m_storage == Storage::PoolBlock)
+    {
+        // Blocks are given back to the pool they were taken from.
+        char *pNewBuffer = new char[m_currentCapacity + extraSizeAtBufferEnd];
+        std::memcpy(pNewBuffer, m_pData, m_rightBlockSize);
+        std::memcpy(pNewBuffer + m_rightBlockSize, m_pBuffer, m_leftBlockSize);
+        m_pBufferPool->releaseBlock(m_pBuffer);
+        m_pBuffer = pNewBuffer;
+        m_pData = pNewBuffer;
+        m_storage = Storage::Heap;
+        m_rightBlockSize += m_leftBlockSize;
+        m_leftBlockSize = 0;
+        m_spaceAvailableAtRightSide = m_currentCapacity - m_rightBlockSize;
+    }
+    else if (m_pBufferPool && m_storage != Storage::Detached)
+        m_pBufferPool->removeUnpooledBytes(storageSize(m_currentCapacity));
+    m_pBufferPool = pBufferPool;
+    if (m_pBufferPool && m_storage != Storage::Detached)
+        m_pBufferPool->addUnpooledBytes(storageSize(m_currentCapacity));
+}
+
+bool RingBuffer::releaseStorage()
+{
+    if (!m_pBufferPool || !isEmpty() || m_isMirrored)
+        return false;
+    releaseStorageBuffer();
+    m_pBuffer = detachedBuffer;
+    m_pData = m_pBuffer;
+    m_storage = Storage::Detached;
+    m_currentCapacity = 0;
+    m_rightBlockSize = 0;
+    m_leftBlockSize = 0;
+    m_spaceAvailableAtRightSide = 0;
+    return true;
+}
+
+size_t RingBuffer::minimumCapacity() const
+{
+    return m_isMirrored ? std::max<size_t>(defaultCapacity(), pageSize()) : defaultCapacity();
+}
+
+void RingBuffer::moveDataToNewBuffer(size_t newCurrentCapacity, bool mirrored)
+{
+    assert(newCurrentCapacity >= size());
+    char *pNewBuffer = mirrored ? mapMirroredBuffer(newCurrentCapacity) : nullptr;
+    auto newStorage = Storage::MirroredPages;
+    if (pNewBuffer == nullptr)
+    {
+        // Falls back to a non-mirrored buffer if pages can not be mirrored.
+        mirrored = false;
+        const auto blockCapacity = m_pBufferPool ? (m_pBufferPool->blockSize() - std::min(m_pBufferPool->blockSize(), extraSizeAtBufferEnd)) : 0;
+        if (newCurrentCapacity > 0 && newCurrentCapacity <= blockCapacity)
+        {
+            pNewBuffer = m_pBufferPool->acquireBlock();
+            newStorage = Storage::PoolBlock;
+            newCurrentCapacity = (m_capacity > 0) ? std::min(m_capacity, blockCapacity) : blockCapacity;
+        }
+        else
+        {
+            pNewBuffer = new char[newCurrentCapacity + extraSizeAtBufferEnd];
+            newStorage = Storage::Heap;
+        }
+    }
     std::memcpy(pNewBuffer, m_pData, m_rightBlockSize);
     std::memcpy(pNewBuffer + m_rightBlockSize, m_pBuffer, m_leftBlockSize);
-    delete [] m_pBuffer;
+    releaseStorageBuffer();
     m_pBuffer = pNewBuffer;
     m_pData = pNewBuffer;
+    m_storage = newStorage;
+    m_isMirrored = mirrored;
+    if (m_pBufferPool && m_storage != Storage::PoolBlock)
+        m_pBufferPool->addUnpooledBytes(storageSize(newCurrentCapacity));
     m_currentCapacity = newCurrentCapacity;
     m_rightBlockSize += m_leftBlockSize;
     m_leftBlockSize = 0;
     m_spaceAvailableAtRightSide = m_currentCapacity - m_rightBlockSize;
-    return true;
+}
+
+void RingBuffer::releaseStorageBuffer()
+{
+    switch (m_storage)
+    {
+        case Storage::Detached:
+            return;
+        case Storage::Heap:
+            delete [] m_pBuffer;
+            break;
+        case Storage::PoolBlock:
+            m_pBufferPool->releaseBlock(m_pBuffer);
+            return;
+        case Storage::MirroredPages:
+            ::munmap(m_pBuffer, 2 * m_currentCapacity + pageSize());
+            break;
+    }
+    if (m_pBufferPool)
+        m_pBufferPool->removeUnpooledBytes(storageSize(m_currentCapacity));
+}
+
+size_t RingBuffer::storageSize(size_t capacity) const
+{
+    return (m_storage == Storage::MirroredPages) ? (capacity + pageSize()) : (capacity + extraSizeAtBufferEnd);
 }
 
 }
@@ -19,7 +19,10 @@
 #define KOURIER_RING_BUFFER_H
 
 #include "SDK.h"
+#include "BufferPool.h"
+#include <memory>
 #include <string_view>
+#include <utility>
 
 
 namespace Kourier
@@ -33,7 +36,9 @@ public:
     virtual bool isFull() const {return false;}
     virtual bool needsToWrite() const {return false;}
     virtual size_t dataAvailable() const = 0;
+    virtual bool mayHaveDataAvailable() const {return dataAvailable() > 0;}
     virtual size_t read(char *pBuffer, size_t count) = 0;
+    virtual size_t readv(char *pFirstBuffer, size_t firstCount, char *pSecondBuffer, size_t secondCount);
 };
 
 class KOURIER_EXPORT DataSink
@@ -44,12 +49,13 @@ public:
     virtual bool hasPendingData() const {return false;}
     virtual bool needsToRead() const {return false;}
     virtual size_t write(const char *pData, size_t count) = 0;
+    virtual size_t writev(const std::string_view *pSlices, size_t count);
 };
 
 class KOURIER_EXPORT RingBuffer
 {
 public:
-    RingBuffer(size_t capacity = 0);
+    RingBuffer(size_t capacity = 0, std::shared_ptr<BufferPool> pBufferPool = {});
     ~RingBuffer();
     RingBuffer(const RingBuffer &) = delete;
     RingBuffer(RingBuffer &&) = delete;
@@ -61,6 +67,16 @@ public:
     size_t write(DataSource &dataSource);
     inline char peekChar(size_t index) const {return (index < m_rightBlockSize) ? m_pData[index] : m_pBuffer[index - m_rightBlockSize];}
     std::string_view slice(size_t pos, size_t count);
+    // Returns the data before and after the point where given range wraps around, without copying it.
+    inline std::pair<std::string_view, std::string_view> peekSlices(size_t pos, size_t count) const
+    {
+        if (m_isMirrored || (pos + count) <= m_rightBlockSize)
+            return {std::string_view{m_pData + pos, count}, {}};
+        else if (pos >= m_rightBlockSize)
+            return {std::string_view{m_pBuffer + pos - m_rightBlockSize, count}, {}};
+        else
+            return {std::string_view{m_pData + pos, m_rightBlockSize - pos}, std::string_view{m_pBuffer, count - (m_rightBlockSize - pos)}};
+    }
     inline std::string_view peekAll() {return (!isEmpty() ? slice(0, size()) : std::string_view{});}
     inline std::string_view readAll()
     {
@@ -72,6 +88,7 @@ public:
         return data;
     }
     size_t popFront(size_t maxSize);
+    void moveData(size_t targetPos, size_t sourcePos, size_t count);
     inline bool isEmpty() const {return size() == 0;}
     inline bool isFull() const {return (m_capacity > 0) && (size() == m_capacity);}
     inline size_t size() const {return m_rightBlockSize + m_leftBlockSize;}
@@ -80,12 +97,23 @@ public:
     bool setCapacity(size_t capacity);
     void clear();
     bool reset();
+    bool setMirrored(bool mirrored);
+    inline bool isMirrored() const {return m_isMirrored;}
+    void setBufferPool(std::shared_ptr<BufferPool> pBufferPool);
+    inline const std::shared_ptr<BufferPool> &bufferPool() const {return m_pBufferPool;}
+    bool releaseStorage();
+    inline bool hasStorage() const {return m_storage != Storage::Detached;}
     static constexpr size_t defaultCapacity() {return 128;}
 
 private:
     bool tryToEnlargeBuffer(size_t count);
+    size_t minimumCapacity() const;
+    void moveDataToNewBuffer(size_t newCurrentCapacity, bool mirrored);
+    void releaseStorageBuffer();
+    size_t storageSize(size_t capacity) const;
 
 private:
+    enum class Storage : uint8_t {Detached, Heap, PoolBlock, MirroredPages};
     char *m_pBuffer = nullptr;
     char *m_pData = nullptr;
     size_t m_rightBlockSize = 0;
@@ -93,6 +121,9 @@ private:
     size_t m_leftBlockSize = 0;
     size_t m_currentCapacity = 0;
     size_t m_capacity = 0;
+    std::shared_ptr<BufferPool> m_pBufferPool;
+    Storage m_storage = Storage::Detached;
+    bool m_isMirrored = false;
     friend class SimdIterator;
 };
 
@@ -19,7 +19,9 @@
 #include <Spectator>
 #include <QRandomGenerator>
 #include <string_view>
+#include <tuple>
 #include <cstring>
+#include <unistd.h>
 
 
 using Kourier::RingBuffer;
@@ -1314,3 +1316,124 @@ SCENARIO("RingBuffer uses all available size/capacity of data source/sink")
         }
     }
 }
+
+
+SCENARIO("Mirrored RingBuffer exposes data that wraps around the buffer end contiguously")
+{
+    GIVEN("a mirrored buffer")
+    {
+        const auto capacity = GENERATE(AS(size_t), 0, 1, 4096, 6000);
+        RingBuffer ringBuffer(capacity);
+        REQUIRE(!ringBuffer.isMirrored());
+        REQUIRE(ringBuffer.setMirrored(true));
+        REQUIRE(ringBuffer.isMirrored());
+        const auto pageSize = size_t(::sysconf(_SC_PAGESIZE));
+        REQUIRE((ringBuffer.capacity() % pageSize) == 0);
+        REQUIRE(ringBuffer.capacity() >= capacity);
+        REQUIRE((ringBuffer.availableFreeSize() % pageSize) == 0);
+        const auto currentCapacity = ringBuffer.availableFreeSize();
+        auto dataGenerator = [this](size_t size) -> std::string
+        {
+            std::string tmp(size, ' ');
+            for (auto &ch : tmp)
+                ch = QRandomGenerator::global()->bounded(0, 256);
+            return tmp;
+        };
+
+        WHEN("data is written so that it wraps around the buffer end")
+        {
+            const auto headData = dataGenerator((2 * currentCapacity) / 3);
+            REQUIRE(ringBuffer.write(headData) == headData.size());
+            REQUIRE(ringBuffer.popFront(headData.size() - 1) == (headData.size() - 1));
+            const auto data = dataGenerator(currentCapacity / 2);
+            REQUIRE(ringBuffer.write(data) == data.size());
+            REQUIRE(ringBuffer.popFront(1) == 1);
+
+            THEN("slices spanning the wrap point point into the buffer and follow the first byte")
+            {
+                const auto all = ringBuffer.peekAll();
+                REQUIRE(all == data);
+                const auto slice = ringBuffer.slice(1, data.size() - 1);
+                REQUIRE(slice.data() == all.data() + 1);
+                REQUIRE(slice == std::string_view(data).substr(1));
+                for (size_t i = 0; i < data.size(); ++i)
+                    REQUIRE(ringBuffer.peekChar(i) == data[i]);
+            }
+
+            AND_WHEN("buffer is enlarged or mirroring is disabled")
+            {
+                const auto enlarges = GENERATE(AS(bool), true, false);
+                std::string expectedData = data;
+                if (enlarges && capacity == 0)
+                {
+                    const auto moreData = dataGenerator(currentCapacity);
+                    REQUIRE(ringBuffer.write(moreData) == moreData.size());
+                    expectedData.append(moreData);
+                }
+                else
+                    REQUIRE(ringBuffer.setMirrored(false));
+
+                THEN("buffer preserves its data")
+                {
+                    REQUIRE(ringBuffer.isMirrored() == (enlarges && capacity == 0));
+                    REQUIRE(ringBuffer.size() == expectedData.size());
+                    REQUIRE(ringBuffer.peekAll() == expectedData);
+                }
+            }
+
+            AND_WHEN("buffer is emptied and cleared")
+            {
+                REQUIRE(ringBuffer.popFront(data.size()) == data.size());
+                ringBuffer.clear();
+
+                THEN("buffer keeps being mirrored and is restored to a single page")
+                {
+                    REQUIRE(ringBuffer.isMirrored());
+                    REQUIRE(ringBuffer.isEmpty());
+                    REQUIRE(ringBuffer.availableFreeSize() == std::min<size_t>(currentCapacity, std::max<size_t>(pageSize, RingBuffer::defaultCapacity())));
+                }
+            }
+        }
+    }
+}
+
+
+SCENARIO("RingBuffer moves data towards the front")
+{
+    GIVEN("a buffer whose data may wrap around the buffer end")
+    {
+        const auto isMirrored = GENERATE(AS(bool), false, true);
+        RingBuffer ringBuffer(4096);
+        REQUIRE(ringBuffer.setMirrored(isMirrored));
+        const auto capacity = ringBuffer.capacity();
+        const auto headSize = GENERATE(AS(size_t), 1, 2000, 4000);
+        REQUIRE(ringBuffer.write(std::string(headSize, '-')) == headSize);
+        REQUIRE(ringBuffer.popFront(headSize - 1) == (headSize - 1));
+        std::string data(capacity / 2, ' ');
+        for (size_t i = 0; i < data.size(); ++i)
+            data[i] = 'a' + (i % 26);
+        REQUIRE(ringBuffer.write(data) == data.size());
+        REQUIRE(ringBuffer.popFront(1) == 1);
+
+        WHEN("data is moved to a position before it")
+        {
+            const auto move = GENERATE(AS(std::tuple<size_t, size_t, size_t>),
+                                       {0, 0, 10},
+                                       {0, 1, 10},
+                                       {5, 17, 200},
+                                       {0, 1000, 1048},
+                                       {100, 101, 1500},
+                                       {10, 2000, 0});
+            const auto [targetPos, sourcePos, count] = move;
+            ringBuffer.moveData(targetPos, sourcePos, count);
+
+            THEN("moved bytes overwrite bytes at target position and remaining bytes are kept")
+            {
+                std::string expectedData = data;
+                expectedData.replace(targetPos, count, data.substr(sourcePos, count));
+                REQUIRE(ringBuffer.size() == expectedData.size());
+                REQUIRE(ringBuffer.peekAll() == expectedData);
+            }
+        }
+    }
+}
@@ -16,16 +16,24 @@
 //
 
 #include "SimdIterator.h"
+#include <algorithm>
 #include <cstring>
 
 
 namespace Kourier
 {
 
-SimdIterator::SimdIterator(const IOChannel &ioChannel) : m_ioChannel(ioChannel)
+SimdIterator::SimdIterator(const IOChannel &ioChannel) :
+    m_ioChannel(ioChannel),
+    m_isContiguous(ioChannel.m_readBuffer.m_isMirrored)
 {
-    assert(m_ioChannel.m_readBuffer.m_currentCapacity >= 32);
-    std::memcpy(m_ioChannel.m_readBuffer.m_pBuffer + m_ioChannel.m_readBuffer.m_currentCapacity, m_ioChannel.m_readBuffer.m_pBuffer, 32);
+    // Blocks read from the end of the buffer extend into the extra space the ring buffer
+    // keeps at its end, which mirrors the start of the buffer.
+    if (!m_isContiguous)
+    {
+        const auto mirroredSize = std::min<size_t>(m_extraSize, m_ioChannel.m_readBuffer.m_currentCapacity);
+        std::memcpy(m_ioChannel.m_readBuffer.m_pBuffer + m_ioChannel.m_readBuffer.m_currentCapacity, m_ioChannel.m_readBuffer.m_pBuffer, mirroredSize);
+    }
 }
 
 }
@@ -19,7 +19,6 @@
 #define KOURIER_SIMD_ITERATOR_H
 
 #include "IOChannel.h"
-#include <x86intrin.h>
 
 
 namespace Kourier
@@ -32,16 +31,21 @@ public:
     SimdIterator(const SimdIterator &) = delete;
     ~SimdIterator() = default;
     SimdIterator &operator=(const SimdIterator &) = delete;
-    inline __m256i nextAt(size_t index) const
+    // Blocks of up to maxBlockSize() bytes can be read from the returned pointer.
+    static constexpr size_t maxBlockSize() {return m_extraSize;}
+    inline const char *at(size_t index) const
     {
-        if ((index < m_ioChannel.m_readBuffer.m_rightBlockSize))
-            return _mm256_loadu_si256((__m256i_u const *)(m_ioChannel.m_readBuffer.m_pData + index));
+        // Mirrored buffers expose wrapped data contiguously.
+        if (m_isContiguous || (index < m_ioChannel.m_readBuffer.m_rightBlockSize))
+            return m_ioChannel.m_readBuffer.m_pData + index;
         else
-            return _mm256_loadu_si256((__m256i_u const *)(m_ioChannel.m_readBuffer.m_pBuffer + index - m_ioChannel.m_readBuffer.m_rightBlockSize));
+            return m_ioChannel.m_readBuffer.m_pBuffer + index - m_ioChannel.m_readBuffer.m_rightBlockSize;
     }
 
 private:
+    static constexpr size_t m_extraSize = 64;
     const IOChannel &m_ioChannel;
+    const bool m_isContiguous;
 };
 
 }
@@ -17,6 +17,7 @@
 
 #include "TcpSocket.h"
 #include "AsyncQObject.h"
+#include <Tests/Resources/SyscallCounter.h>
 #include <Tests/Resources/TcpServer.h>
 #include <Tests/Resources/TestHostNamesFetcher.h>
 #include <QTcpSocket>
@@ -29,18 +30,26 @@
 #include <QRandomGenerator64>
 #include <QHostInfo>
 #include <QHostAddress>
+#include <atomic>
 #include <chrono>
+#include <cstdarg>
 #include <memory>
 #include <fstream>
+#include <thread>
 #include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
 #include <Spectator>
 
 using Kourier::TcpServer;
 using Kourier::TcpSocket;
 using Kourier::Object;
 using Kourier::AsyncQObject;
+using Kourier::TestResources::SyscallCounter;
 using Kourier::TestResources::TestHostNamesFetcher;
 using Spectator::SemaphoreAwaiter;
 
@@ -1766,6 +1775,176 @@ SCENARIO("TcpSockets can be reused")
 }
 
 
+extern "C"
+{
+int __real_ioctl(int fd, unsigned long request, ...);
+ssize_t __real_recv(int fd, void *pBuffer, size_t count, int flags);
+ssize_t __real_readv(int fd, const iovec *pVectors, int count);
+ssize_t __real_recvmsg(int fd, msghdr *pMessage, int flags);
+ssize_t __real_send(int fd, const void *pData, size_t count, int flags);
+ssize_t __real_sendmsg(int fd, const msghdr *pMessage, int flags);
+int __real_epoll_ctl(int epfd, int operation, int fd, epoll_event *pEvent);
+
+int __wrap_ioctl(int fd, unsigned long request, ...)
+{
+    va_list arguments;
+    va_start(arguments, request);
+    void *pArgument = va_arg(arguments, void*);
+    va_end(arguments);
+    SyscallCounter::count(fd, SyscallCounter::ioctlCount);
+    return __real_ioctl(fd, request, pArgument);
+}
+
+ssize_t __wrap_recv(int fd, void *pBuffer, size_t count, int flags)
+{
+    SyscallCounter::count(fd, SyscallCounter::readCount);
+    return __real_recv(fd, pBuffer, count, flags);
+}
+
+ssize_t __wrap_readv(int fd, const iovec *pVectors, int count)
+{
+    SyscallCounter::count(fd, SyscallCounter::readCount);
+    return __real_readv(fd, pVectors, count);
+}
+
+ssize_t __wrap_recvmsg(int fd, msghdr *pMessage, int flags)
+{
+    SyscallCounter::count(fd, SyscallCounter::readCount);
+    return __real_recvmsg(fd, pMessage, flags);
+}
+
+ssize_t __wrap_send(int fd, const void *pData, size_t count, int flags)
+{
+    SyscallCounter::count(fd, SyscallCounter::writeCount);
+    SyscallCounter::countSend();
+    return __real_send(fd, pData, count, flags);
+}
+
+ssize_t __wrap_sendmsg(int fd, const msghdr *pMessage, int flags)
+{
+    SyscallCounter::count(fd, SyscallCounter::writeCount);
+    SyscallCounter::countSend();
+    return __real_sendmsg(fd, pMessage, flags);
+}
+
+int __wrap_epoll_ctl(int epfd, int operation, int fd, epoll_event *pEvent)
+{
+    SyscallCounter::count(fd, SyscallCounter::epollCtlCount);
+    return __real_epoll_ctl(epfd, operation, fd, pEvent);
+}
+}
+
+
+SCENARIO("TcpSocket reads each request with a single syscall")
+{
+    GIVEN("a server peer that responds to each request it receives")
+    {
+        const auto requestSize = GENERATE(AS(size_t), 64, 1024, 16384);
+        const size_t requestCount = (requestSize < 16384) ? 20000 : 5000;
+        static constexpr size_t responseSize = 64;
+        TcpServer server;
+        REQUIRE(server.listen(QHostAddress("127.10.20.94")));
+        std::unique_ptr<TcpSocket> serverPeer;
+        QSemaphore serverPeerConnectedSemaphore;
+        QSemaphore serverPeerRespondedSemaphore;
+        size_t pendingRequestData = 0;
+        size_t respondedRequestCount = 0;
+        const std::string response(responseSize, 'r');
+        Object::connect(&server, &TcpServer::newConnection, [&](TcpSocket *pNewSocket)
+            {
+                REQUIRE(!serverPeer);
+                serverPeer.reset(pNewSocket);
+                Object::connect(serverPeer.get(), &TcpSocket::receivedData, [&]()
+                    {
+                        pendingRequestData += serverPeer->readAll().size();
+                        while (pendingRequestData >= requestSize)
+                        {
+                            pendingRequestData -= requestSize;
+                            serverPeer->write(response);
+                            if (++respondedRequestCount == requestCount)
+                                serverPeerRespondedSemaphore.release();
+                        }
+                    });
+                serverPeerConnectedSemaphore.release();
+            });
+
+        WHEN("a client sends requests one at a time, waiting for each response")
+        {
+            QSemaphore clientCanSendRequestsSemaphore;
+            std::atomic_bool clientReceivedAllResponses = false;
+            const auto serverPort = server.serverPort();
+            std::thread client([&]()
+                {
+                    const int clientSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+                    if (clientSocket < 0)
+                        return;
+                    sockaddr_in serverAddress = {};
+                    serverAddress.sin_family = AF_INET;
+                    serverAddress.sin_port = htons(serverPort);
+                    ::inet_pton(AF_INET, "127.10.20.94", &serverAddress.sin_addr);
+                    if (::connect(clientSocket, reinterpret_cast<sockaddr*>(&serverAddress), sizeof(serverAddress)) != 0
+                        || !clientCanSendRequestsSemaphore.tryAcquire(1, 10000))
+                    {
+                        ::close(clientSocket);
+                        return;
+                    }
+                    const std::string request(requestSize, 'q');
+                    char responseBuffer[responseSize];
+                    for (size_t i = 0; i < requestCount; ++i)
+                    {
+                        if (::send(clientSocket, request.data(), request.size(), MSG_NOSIGNAL) != ssize_t(request.size()))
+                        {
+                            ::close(clientSocket);
+                            return;
+                        }
+                        size_t receivedResponseSize = 0;
+                        while (receivedResponseSize < responseSize)
+                        {
+                            const auto result = ::recv(clientSocket, responseBuffer, responseSize - receivedResponseSize, 0);
+                            if (result <= 0)
+                            {
+                                ::close(clientSocket);
+                                return;
+                            }
+                            receivedResponseSize += result;
+                        }
+                    }
+                    ::close(clientSocket);
+                    clientReceivedAllResponses = true;
+                });
+            const bool serverPeerConnected = SemaphoreAwaiter::signalSlotAwareWait(serverPeerConnectedSemaphore, 10);
+            if (serverPeerConnected)
+            {
+                SyscallCounter::reset(serverPeer->fileDescriptor());
+                clientCanSendRequestsSemaphore.release();
+            }
+            const bool respondedToAllRequests = serverPeerConnected && SemaphoreAwaiter::signalSlotAwareWait(serverPeerRespondedSemaphore, 60);
+            const size_t ioctlCount = SyscallCounter::ioctlCount;
+            const size_t readCount = SyscallCounter::readCount;
+            const size_t writeCount = SyscallCounter::writeCount;
+            const size_t epollCtlCount = SyscallCounter::epollCtlCount;
+            const size_t totalCount = SyscallCounter::totalCount();
+            SyscallCounter::reset(-1);
+            client.join();
+
+            THEN("server peer never asks the kernel how much data is available")
+            {
+                REQUIRE(respondedToAllRequests);
+                REQUIRE(clientReceivedAllResponses);
+                WARN(QByteArray("Request size: ").append(QByteArray::number(requestSize)));
+                WARN(QByteArray("Syscalls per request: ").append(QByteArray::number(double(totalCount)/requestCount)));
+                WARN(QByteArray("ioctl calls per request: ").append(QByteArray::number(double(ioctlCount)/requestCount)));
+                WARN(QByteArray("Read calls per request: ").append(QByteArray::number(double(readCount)/requestCount)));
+                WARN(QByteArray("Write calls per request: ").append(QByteArray::number(double(writeCount)/requestCount)));
+                WARN(QByteArray("epoll_ctl calls per request: ").append(QByteArray::number(double(epollCtlCount)/requestCount)));
+                REQUIRE(ioctlCount == 0);
+                REQUIRE(readCount >= requestCount);
+            }
+        }
+    }
+}
+
+
 namespace TcpSocketTests
 {
 
@@ -38,6 +38,7 @@ public:
     size_t read(char *pBuffer, size_t maxSize) override;
     size_t write(std::string_view data) {return !data.empty() ? write(data.data(), data.size()) : 0;}
     size_t write(const char *pData, size_t maxSize) override;
+    size_t writev(const std::string_view *pSlices, size_t count) override;
     std::string_view readAll() override;
     size_t skip(size_t maxSize) override;
     void setBindAddressAndPort(std::string_view address, uint16_t port = 0);
@@ -77,6 +78,7 @@ private:
     DataSink &dataSink() override;
     void onReadNotificationChanged() override;
     void onWriteNotificationChanged() override;
+    void onWriteBatchFinished() override;
 
 private:
     TcpSocketPrivate *d_ptr;
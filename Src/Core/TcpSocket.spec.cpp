@@ -28,6 +28,7 @@
 #include <QHostAddress>
 #include <chrono>
 #include <memory>
+#include <string>
 #include <sys/socket.h>
 #include <sys/mman.h>
 #include <Spectator>
@@ -429,6 +430,52 @@ SCENARIO("Connected TcpSocket peers interact with each other")
             }
         }
 
+        WHEN("TcpSocket writes data to connected peer in a write batch")
+        {
+            const bool isClientTheSendingPeer = GENERATE(AS(bool), true, false);
+            auto &pSendingPeer = isClientTheSendingPeer ? pClientPeer : pServerPeer;
+            QSemaphore sendingPeerSentDataSemaphore;
+            size_t sentDataSize = 0;
+            Object::connect(pSendingPeer.get(), &TcpSocket::sentData, [&](size_t count)
+                {
+                    sentDataSize += count;
+                    sendingPeerSentDataSemaphore.release();
+                });
+            QByteArray dataToSend;
+            {
+                TcpSocket::WriteBatch writeBatch(*pSendingPeer);
+                for (auto i = 0; i < 64; ++i)
+                {
+                    const auto fragment = std::string("fragment ").append(std::to_string(i)).append("\r\n");
+                    pSendingPeer->write(fragment);
+                    dataToSend.append(fragment.data(), fragment.size());
+                }
+                REQUIRE(pSendingPeer->isBatchingWrites());
+                REQUIRE(pSendingPeer->dataToWrite() == size_t(dataToSend.size()));
+            }
+
+            THEN("TcpSocket sends batched data as soon as the batch ends")
+            {
+                REQUIRE(!pSendingPeer->isBatchingWrites());
+                REQUIRE(pSendingPeer->dataToWrite() == 0);
+
+                AND_THEN("TcpSocket emits sentData and connected peer receives sent data")
+                {
+                    while (sentDataSize < size_t(dataToSend.size()))
+                    {
+                        REQUIRE(TRY_ACQUIRE(sendingPeerSentDataSemaphore, 1));
+                    }
+                    REQUIRE(sentDataSize == size_t(dataToSend.size()));
+                    auto &receivedData = isClientTheSendingPeer ? receivedServerPeerData : receivedClientPeerData;
+                    auto &connectedPeerReceivedDataSemaphore = isClientTheSendingPeer ? serverPeerReceivedDataSemaphore : clientPeerReceivedDataSemaphore;
+                    while(dataToSend != receivedData)
+                    {
+                        REQUIRE(TRY_ACQUIRE(connectedPeerReceivedDataSemaphore, 1));
+                    }
+                }
+            }
+        }
+
         WHEN("TcpSocket closes connection after sending data to connected peer")
         {
             const auto dataToSend = GENERATE(AS(QByteArray),
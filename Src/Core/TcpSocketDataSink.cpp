@@ -27,4 +27,9 @@ size_t TcpSocketDataSink::write(const char *pData, size_t count)
     return UnixUtils::safeSend(m_socketDescriptor, pData, count);
 }
 
+size_t TcpSocketDataSink::writev(const std::string_view *pSlices, size_t count)
+{
+    return UnixUtils::safeSendv(m_socketDescriptor, pSlices, count);
+}
+
 }
@@ -30,6 +30,7 @@ public:
         m_socketDescriptor(socketDescriptor) {}
     ~TcpSocketDataSink() override = default;
     size_t write(const char *pData, size_t count) override;
+    size_t writev(const std::string_view *pSlices, size_t count) override;
 
 private:
     const intptr_t &m_socketDescriptor;
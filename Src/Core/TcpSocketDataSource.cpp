@@ -16,8 +16,13 @@
 //
 
 #include "TcpSocketDataSource.h"
+#include "EpollEventNotifier.h"
 #include "UnixUtils.h"
 #include <sys/ioctl.h>
+#include <sys/uio.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 
 
 namespace Kourier
@@ -25,14 +30,145 @@ namespace Kourier
 
 size_t TcpSocketDataSource::dataAvailable() const
 {
+    if (m_isReceivingWithIoUring)
+        return m_receivedDataSize;
     int byteCount = 0;
     ::ioctl(m_socketDescriptor, FIONREAD, &byteCount);
-    return byteCount;
+    return m_receivedDataSize + byteCount;
 }
 
 size_t TcpSocketDataSource::read(char *pBuffer, size_t count)
 {
-    return UnixUtils::safeReceive(m_socketDescriptor, pBuffer, count);
+    if (m_isReceivingWithIoUring || m_receivedDataSize > 0)
+        return readv(pBuffer, count, nullptr, 0);
+    const auto bytesRead = UnixUtils::safeReceive(m_socketDescriptor, pBuffer, count);
+    m_mayHaveDataAvailable = (bytesRead == count);
+    return bytesRead;
+}
+
+// Data the ring received into provided buffers is handed out first. Sockets that stopped
+// receiving with io_uring read whatever did not fit in the given buffers from the socket.
+size_t TcpSocketDataSource::readv(char *pFirstBuffer, size_t firstCount, char *pSecondBuffer, size_t secondCount)
+{
+    if (m_receivedDataSize == 0 && !m_isReceivingWithIoUring)
+        return readFromSocket(pFirstBuffer, firstCount, pSecondBuffer, secondCount);
+    const auto receivedSize = readReceivedData(pFirstBuffer, firstCount, pSecondBuffer, secondCount);
+    if (m_isReceivingWithIoUring || m_receivedDataSize > 0 || receivedSize == (firstCount + secondCount) || m_socketDescriptor < 0)
+    {
+        m_mayHaveDataAvailable = (m_receivedDataSize > 0) || (!m_isReceivingWithIoUring && receivedSize == (firstCount + secondCount));
+        return receivedSize;
+    }
+    else if (receivedSize < firstCount)
+        return receivedSize + readFromSocket(pFirstBuffer + receivedSize, firstCount - receivedSize, pSecondBuffer, secondCount);
+    else
+        return receivedSize + readFromSocket(pSecondBuffer + (receivedSize - firstCount), secondCount - (receivedSize - firstCount), nullptr, 0);
+}
+
+void TcpSocketDataSource::startReceivingWithIoUring(EpollEventNotifier *pEventNotifier)
+{
+    assert(pEventNotifier);
+    m_pEventNotifier = pEventNotifier;
+    m_isReceivingWithIoUring = true;
+}
+
+void TcpSocketDataSource::stopReceivingWithIoUring()
+{
+    m_isReceivingWithIoUring = false;
+    m_mayHaveDataAvailable = true;
+}
+
+void TcpSocketDataSource::addReceivedData(uint16_t bufferId, size_t size)
+{
+    assert(m_pEventNotifier && size > 0);
+    m_receivedBuffers.push_back({bufferId, 0, static_cast<uint32_t>(size)});
+    m_receivedDataSize += size;
+    m_mayHaveDataAvailable = true;
+}
+
+void TcpSocketDataSource::clear()
+{
+    if (m_pEventNotifier)
+    {
+        for (auto i = m_firstReceivedBuffer; i < m_receivedBuffers.size(); ++i)
+            m_pEventNotifier->recycleReceiveBuffer(m_receivedBuffers[i].bufferId);
+    }
+    m_receivedBuffers.clear();
+    m_firstReceivedBuffer = 0;
+    m_receivedDataSize = 0;
+    m_pEventNotifier = nullptr;
+    m_mayHaveDataAvailable = false;
+    m_isReceivingWithIoUring = false;
+}
+
+// Buffers are given back to the ring as soon as they are drained.
+size_t TcpSocketDataSource::readReceivedData(char *pFirstBuffer, size_t firstCount, char *pSecondBuffer, size_t secondCount)
+{
+    char *buffers[] = {pFirstBuffer, pSecondBuffer};
+    size_t counts[] = {firstCount, secondCount};
+    size_t receivedSize = 0;
+    for (auto i = 0; i < 2; ++i)
+    {
+        while (counts[i] > 0 && m_firstReceivedBuffer < m_receivedBuffers.size())
+        {
+            auto &receivedBuffer = m_receivedBuffers[m_firstReceivedBuffer];
+            const char * const pData = m_pEventNotifier->receivedData(receivedBuffer.bufferId);
+            if (!pData) [[unlikely]]
+            {
+                // The thread's ring was destroyed along with its buffers.
+                m_receivedBuffers.clear();
+                m_firstReceivedBuffer = 0;
+                m_receivedDataSize = 0;
+                return receivedSize;
+            }
+            const auto count = std::min<size_t>(counts[i], receivedBuffer.size);
+            std::memcpy(buffers[i], pData + receivedBuffer.offset, count);
+            buffers[i] += count;
+            counts[i] -= count;
+            receivedBuffer.offset += count;
+            receivedBuffer.size -= count;
+            receivedSize += count;
+            m_receivedDataSize -= count;
+            if (receivedBuffer.size == 0)
+            {
+                m_pEventNotifier->recycleReceiveBuffer(receivedBuffer.bufferId);
+                ++m_firstReceivedBuffer;
+            }
+        }
+    }
+    if (m_firstReceivedBuffer == m_receivedBuffers.size())
+    {
+        m_receivedBuffers.clear();
+        m_firstReceivedBuffer = 0;
+    }
+    return receivedSize;
+}
+
+// Reads with a single syscall. A short read means that the socket was drained, so that
+// callers do not need to ask the kernel how much data is available before or after reading.
+size_t TcpSocketDataSource::readFromSocket(char *pFirstBuffer, size_t firstCount, char *pSecondBuffer, size_t secondCount)
+{
+    assert(m_socketDescriptor >= 0);
+    iovec vectors[] = {{pFirstBuffer, firstCount}, {pSecondBuffer, secondCount}};
+    const auto *pVectors = (firstCount > 0) ? vectors : (vectors + 1);
+    const int vectorCount = ((firstCount > 0) ? 1 : 0) + ((secondCount > 0) ? 1 : 0);
+    if (vectorCount == 0)
+        return 0;
+    while (true)
+    {
+        const ssize_t result = ::readv(m_socketDescriptor, pVectors, vectorCount);
+        if (result >= 0)
+        {
+            m_mayHaveDataAvailable = (size_t(result) == (firstCount + secondCount));
+            return result;
+        }
+        else if (errno == EINTR)
+            continue;
+        else
+        {
+            m_mayHaveDataAvailable = false;
+            return 0;
+        }
+    }
 }
 
 }
@@ -19,22 +19,48 @@
 #define KOURIER_TCP_SOCKET_DATA_SOURCE_H
 
 #include "RingBuffer.h"
+#include <vector>
 
 
 namespace Kourier
 {
 
+class EpollEventNotifier;
+
 class TcpSocketDataSource : public DataSource
 {
 public:
     TcpSocketDataSource(const intptr_t &socketDescriptor) :
         m_socketDescriptor(socketDescriptor) {}
-    ~TcpSocketDataSource() override = default;
+    ~TcpSocketDataSource() override {clear();}
     size_t dataAvailable() const override;
+    bool mayHaveDataAvailable() const override {return m_mayHaveDataAvailable;}
     size_t read(char *pBuffer, size_t count) override;
+    size_t readv(char *pFirstBuffer, size_t firstCount, char *pSecondBuffer, size_t secondCount) override;
+    inline bool isReceivingWithIoUring() const {return m_isReceivingWithIoUring;}
+    void startReceivingWithIoUring(EpollEventNotifier *pEventNotifier);
+    void stopReceivingWithIoUring();
+    void addReceivedData(uint16_t bufferId, size_t size);
+    void clear();
+
+private:
+    struct ReceivedBuffer
+    {
+        uint16_t bufferId = 0;
+        uint32_t offset = 0;
+        uint32_t size = 0;
+    };
+    size_t readReceivedData(char *pFirstBuffer, size_t firstCount, char *pSecondBuffer, size_t secondCount);
+    size_t readFromSocket(char *pFirstBuffer, size_t firstCount, char *pSecondBuffer, size_t secondCount);
 
 private:
     const intptr_t &m_socketDescriptor;
+    EpollEventNotifier *m_pEventNotifier = nullptr;
+    std::vector<ReceivedBuffer> m_receivedBuffers;
+    size_t m_firstReceivedBuffer = 0;
+    size_t m_receivedDataSize = 0;
+    bool m_mayHaveDataAvailable = false;
+    bool m_isReceivingWithIoUring = false;
 };
 
 }
@@ -23,6 +23,9 @@
 #include "UnixUtils.h"
 #include "NoDestroy.h"
 #include <QAtomicInt>
+#include <cerrno>
+#include <linux/io_uring.h>
+#include <utility>
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <netinet/ip.h>
@@ -92,6 +95,7 @@ void TcpSocketPrivate::setSocketDescriptor(int64_t socketDescriptor)
             m_state = TcpSocket::State::Connected;
             q->m_isReadNotificationEnabled = true;
             q->m_isWriteNotificationEnabled = false;
+            startReceivingWithIoUring();
             setEnabled(true);
             onConnected();
             return;
@@ -103,11 +107,13 @@ void TcpSocketPrivate::setSocketDescriptor(int64_t socketDescriptor)
 void TcpSocketPrivate::abort()
 {
     Q_Q(TcpSocket);
+    cancelRingOperation();
     setEnabled(false);
     eventNotifier()->removePostedEvents(this);
     setEventTypes(EPOLLRDHUP | EPOLLPRI | EPOLLET | EPOLLIN | EPOLLOUT);
     if (m_socketDescriptor >= 0)
         UnixUtils::safeClose(m_socketDescriptor);
+    m_tcpSocketDataSource.clear();
     if (m_isLookingUpHost)
     {
         m_isLookingUpHost = false;
@@ -130,6 +136,10 @@ void TcpSocketPrivate::abort()
     m_proxyPort = 0;
     m_state = TcpSocket::State::Unconnected;
     m_hasToAddSocketToReadyEventSourceListAfterReading = false;
+    m_hasAlreadyScheduledWriteEvent = false;
+    m_isEmittingReceivedData = false;
+    m_hasDeferredWrite = false;
+    m_hasRunOutOfRingBuffers = false;
     q->m_readBuffer.clear();
     q->m_writeBuffer.clear();
     q->m_isReadNotificationEnabled = true;
@@ -585,6 +595,7 @@ void TcpSocketPrivate::onEvent(const uint32_t epollEvents)
                 q->setReadChannelNotificationEnabled(true);
                 q->setWriteChannelNotificationEnabled(false);
                 setEnabled(true);
+                startReceivingWithIoUring();
                 const auto currentContextId = m_contextId;
                 onConnected();
                 if (currentContextId != m_contextId)
@@ -599,17 +610,19 @@ void TcpSocketPrivate::onEvent(const uint32_t epollEvents)
     }
     if ((epollEvents & EPOLLIN) && (m_state == TcpSocket::State::Connected))
         receivedDataSize = q->readDataFromChannel();
-    if ((epollEvents & EPOLLRDHUP)
-        || (epollEvents & EPOLLERR)
-        || (epollEvents & EPOLLHUP)
-        || (epollEvents & EPOLLPRI))
+    // Sockets receiving with io_uring learn about disconnections from the ring, after
+    // all data received before the disconnection is handed to them.
+    const uint32_t disconnectionEvents = m_tcpSocketDataSource.isReceivingWithIoUring()
+                                             ? (EPOLLRDHUP | EPOLLPRI)
+                                             : (EPOLLRDHUP | EPOLLERR | EPOLLHUP | EPOLLPRI);
+    if (epollEvents & disconnectionEvents)
     {
         m_disconnectTimer.stop();
         hasDisconnected = true;
     }
     const auto contextId = m_contextId;
     if (receivedDataSize > 0)
-        q->receivedData();
+        sentDataSize += emitReceivedData();
     if (contextId == m_contextId && sentDataSize > 0)
         q->sentData(sentDataSize);
     if (contextId == m_contextId && hasDisconnected)
@@ -637,6 +650,95 @@ void TcpSocketPrivate::onEvent(const uint32_t epollEvents)
     }
 }
 
+// Completions of the multishot receive carry the id of the provided buffer holding the received data.
+// Zero and error results mean that the connection was closed. The receive stops when the ring runs out
+// of buffers, and the socket then goes back to reading on EPOLLIN, so that no data is lost. The socket
+// issues a new multishot receive once it has drained both its received buffers and the socket, as other
+// connections have given buffers back by then in all but the most overloaded workers.
+void TcpSocketPrivate::onCompletion(int32_t result, uint32_t flags)
+{
+    if (result > 0)
+    {
+        m_tcpSocketDataSource.addReceivedData(static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT), result);
+        if (!(flags & IORING_CQE_F_MORE))
+            startReceive();
+        onEvent(EPOLLIN);
+    }
+    else if (result == -ENOBUFS)
+    {
+        m_tcpSocketDataSource.stopReceivingWithIoUring();
+        m_hasRunOutOfRingBuffers = true;
+        if (m_state == TcpSocket::State::Connected)
+        {
+            setEventTypes(eventTypes() | EPOLLIN | EPOLLRDHUP);
+            onEvent(EPOLLIN);
+        }
+        else
+            setEventTypes(eventTypes() | EPOLLRDHUP);
+    }
+    else if (result != -ECANCELED)
+        onEvent(EPOLLRDHUP);
+}
+
+// Sockets of threads that use io_uring receive data with a multishot receive
+// instead of reading on EPOLLIN. Readiness is only used for writing.
+void TcpSocketPrivate::startReceivingWithIoUring()
+{
+    m_hasRunOutOfRingBuffers = false;
+    if (!canReceiveWithIoUring() || !eventNotifier()->isUsingIoUring())
+        return;
+    setEventTypes(eventTypes() & ~(EPOLLIN | EPOLLRDHUP));
+    if (startReceive())
+        m_tcpSocketDataSource.startReceivingWithIoUring(eventNotifier());
+    else
+        setEventTypes(eventTypes() | EPOLLIN | EPOLLRDHUP);
+}
+
+void TcpSocketPrivate::scheduleWrite()
+{
+    Q_Q(TcpSocket);
+    if (m_hasAlreadyScheduledWriteEvent)
+        return;
+    m_hasAlreadyScheduledWriteEvent = true;
+    if (m_isEmittingReceivedData || q->isBatchingWrites())
+        m_hasDeferredWrite = true;
+    else
+        eventNotifier()->postEvent(this, EPOLLOUT);
+}
+
+// Data written by receivedData slots is sent with a single write once all slots return, instead of
+// in a posted event on the next event loop iteration. Pipelined requests that were read together
+// are then answered together.
+size_t TcpSocketPrivate::emitReceivedData()
+{
+    Q_Q(TcpSocket);
+    const auto contextId = m_contextId;
+    m_isEmittingReceivedData = true;
+    q->receivedData();
+    if (contextId != m_contextId)
+        return 0;
+    m_isEmittingReceivedData = false;
+    size_t sentDataSize = 0;
+    if (std::exchange(m_hasDeferredWrite, false))
+    {
+        if (m_state == TcpSocket::State::Connected)
+            sentDataSize = q->writeDataToChannel();
+        else
+            eventNotifier()->postEvent(this, EPOLLOUT);
+    }
+    releaseDrainedBuffers();
+    return sentDataSize;
+}
+
+// Connections that consumed all received data and sent all pending data give their buffers
+// back to the worker's pool, so that idle connections do not hold any buffer memory.
+void TcpSocketPrivate::releaseDrainedBuffers()
+{
+    Q_Q(TcpSocket);
+    q->m_readBuffer.releaseStorage();
+    q->m_writeBuffer.releaseStorage();
+}
+
 void TcpSocketPrivate::onConnected()
 {
     Q_Q(TcpSocket);
@@ -730,17 +832,47 @@ size_t TcpSocket::write(const char *pData, size_t maxSize)
     if (d->m_state == TcpSocket::State::Connected)
     {
         m_writeBuffer.write(pData, maxSize);
-        if (!d->m_hasAlreadyScheduledWriteEvent)
-        {
-            d->eventNotifier()->postEvent(d, EPOLLOUT);
-            d->m_hasAlreadyScheduledWriteEvent = true;
-        }
+        d->scheduleWrite();
         return maxSize;
     }
     else
         return 0;
 }
 
+size_t TcpSocket::writev(const std::string_view *pSlices, size_t count)
+{
+    assert(pSlices != nullptr);
+    Q_D(TcpSocket);
+    if (d->m_state != TcpSocket::State::Connected)
+        return 0;
+    size_t totalSize = 0;
+    for (size_t i = 0; i < count; ++i)
+        totalSize += pSlices[i].size();
+    // Large writes are sent right away with a single gather write when nothing is pending, so that
+    // large slices are not copied into the write buffer. Only what the socket does not accept is buffered.
+    // Write batches buffer everything, so that data written after the slices leaves together with them.
+    static constexpr size_t minDirectWriteSize = 16384;
+    size_t bytesSent = 0;
+    if (totalSize >= minDirectWriteSize && m_writeBuffer.isEmpty() && !isBatchingWrites())
+    {
+        bytesSent = dataSink().writev(pSlices, count);
+        d->m_directlySentDataSize += bytesSent;
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto &slice = pSlices[i];
+        if (bytesSent >= slice.size())
+            bytesSent -= slice.size();
+        else
+        {
+            m_writeBuffer.write(slice.data() + bytesSent, slice.size() - bytesSent);
+            bytesSent = 0;
+        }
+    }
+    d->scheduleWrite();
+    return totalSize;
+}
+
 std::string_view TcpSocket::readAll()
 {
     Q_D(TcpSocket);
@@ -899,20 +1031,22 @@ size_t TcpSocket::readDataFromChannel()
 {
     Q_D(TcpSocket);
     const auto bytesRead = IOChannel::readDataFromChannel();
-    if (dataSource().dataAvailable() > 0)
+    if (dataSource().mayHaveDataAvailable())
     {
         if (!m_readBuffer.isFull())
             d->eventNotifier()->postEvent(d, EPOLLIN);
         else
             d->m_hasToAddSocketToReadyEventSourceListAfterReading = true;
     }
+    else if (d->m_hasRunOutOfRingBuffers && d->m_state == TcpSocket::State::Connected)
+        d->startReceivingWithIoUring();
     return bytesRead;
 }
 
 size_t TcpSocket::writeDataToChannel()
 {
     Q_D(TcpSocket);
-    const auto bytesWritten = IOChannel::writeDataToChannel();
+    const auto bytesWritten = IOChannel::writeDataToChannel() + std::exchange(d->m_directlySentDataSize, 0);
     d->m_hasAlreadyScheduledWriteEvent = false;
     return bytesWritten;
 }
@@ -941,4 +1075,19 @@ void TcpSocket::onWriteNotificationChanged()
     d->setWriteEnabled(isWriteNotificationEnabled());
 }
 
+// Batches ending inside receivedData slots are sent once all slots return. Otherwise, the batch is sent right
+// away and the bytes sent are reported by sentData from a posted write event, as done for direct writes.
+void TcpSocket::onWriteBatchFinished()
+{
+    Q_D(TcpSocket);
+    if (d->m_isEmittingReceivedData || !std::exchange(d->m_hasDeferredWrite, false))
+        return;
+    if (d->m_state == TcpSocket::State::Connected)
+    {
+        d->m_directlySentDataSize += writeDataToChannel();
+        d->m_hasAlreadyScheduledWriteEvent = true;
+    }
+    d->eventNotifier()->postEvent(d, EPOLLOUT);
+}
+
 }
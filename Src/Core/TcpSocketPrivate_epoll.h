@@ -60,6 +60,7 @@ public:
     void setSocketOption(TcpSocket::SocketOption option, int value);
     void setConnectTimeout(std::chrono::milliseconds timeout) {m_connectTimer.setInterval(timeout);}
     void setDisconnectTimeout(std::chrono::milliseconds timeout) {m_disconnectTimer.setInterval(timeout);}
+    void scheduleWrite();
 
 private:
     void connectToHost();
@@ -68,13 +69,18 @@ private:
     bool fetchConnectionParameters();
     void setError(std::string_view errorMessage);
     void onEvent(uint32_t epollEvents) override;
+    void onCompletion(int32_t result, uint32_t flags) override;
+    void startReceivingWithIoUring();
     virtual void onConnecting() {}
     virtual void onConnected();
     void onConnectTimeout();
     void onDisconnectTimeout() {onDisconnectTimeoutImpl();}
 
 protected:
+    virtual bool canReceiveWithIoUring() const {return true;}
     virtual void onDisconnectTimeoutImpl();
+    size_t emitReceivedData();
+    virtual void releaseDrainedBuffers();
 
 private:
     TcpSocket *q_ptr;
@@ -96,6 +102,7 @@ protected:
     Timer m_connectTimer;
     Timer m_disconnectTimer;
     uint64_t m_contextId = 1;
+    size_t m_directlySentDataSize = 0;
     uint16_t m_bindPort = 0;
     uint16_t m_peerPort = 0;
     uint16_t m_localPort = 0;
@@ -103,7 +110,10 @@ protected:
     TcpSocket::State m_state = TcpSocket::State::Unconnected;
     bool m_hasToAddSocketToReadyEventSourceListAfterReading = false;
     bool m_hasAlreadyScheduledWriteEvent = false;
+    bool m_isEmittingReceivedData = false;
+    bool m_hasDeferredWrite = false;
     bool m_isLookingUpHost = false;
+    bool m_hasRunOutOfRingBuffers = false;
 };
 
 }
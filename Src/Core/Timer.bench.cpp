@@ -16,6 +16,10 @@
 //
 
 #include "Timer.h"
+#include "TimerNotifier.h"
+#include "TimerPrivate_epoll.h"
+#include "LazyTimer.h"
+#include "DeadlineTracker.h"
 #include <QTimer>
 #include <QCoreApplication>
 #include <QThread>
@@ -25,14 +29,32 @@
 #include <QDeadlineTimer>
 #include <chrono>
 #include <cmath>
+#include <memory>
+#include <vector>
 #include <Spectator>
 
 using Kourier::Timer;
+using Kourier::TimerNotifier;
+using Kourier::ClockTicker;
+using Kourier::LazyTimer;
+using Kourier::DeadlineTracker;
 using Kourier::Object;
 using Spectator::SemaphoreAwaiter;
 using namespace std::chrono_literals;
 
 
+namespace Test::TimerNotifier
+{
+    class TimerNotifierTest
+    {
+    public:
+        inline static void setTimerNotifier(Timer &timer, class TimerNotifier &timerNotifier) {timer.d_ptr->m_pTimerNotifier = &timerNotifier;}
+    };
+}
+
+using Test::TimerNotifier::TimerNotifierTest;
+
+
 SCENARIO("Timer with non-zero interval times out after given interval with 1ms of error")
 {
     GIVEN("a timer set to expire")
@@ -933,6 +955,102 @@ SCENARIO("Timers can be deleted while being processed after expiration")
 }
 
 
+namespace
+{
+
+// Mimics what connection handlers do on keep-alive connections: the timer is restarted
+// with the request timeout when a request starts and with the idle timeout when it ends.
+template <typename T>
+double nanoSecsPerRequest(std::vector<std::unique_ptr<T>> &timers, size_t requestsPerConnection)
+{
+    static constexpr auto requestTimeout = 20000ms;
+    static constexpr auto idleTimeout = 60000ms;
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    for (size_t i = 0; i < requestsPerConnection; ++i)
+    {
+        for (auto &pTimer : timers)
+            pTimer->start(requestTimeout);
+        for (auto &pTimer : timers)
+            pTimer->start(idleTimeout);
+    }
+    return double(elapsedTimer.nsecsElapsed()) / double(timers.size() * requestsPerConnection);
+}
+
+}
+
+SCENARIO("Timer operations per request of connection timeouts")
+{
+    static constexpr size_t requestsPerConnection = 64;
+    const auto connectionCount = GENERATE(AS(size_t), 1, 1000, 100000);
+
+    GIVEN("timers of keep-alive connections")
+    {
+        std::vector<std::unique_ptr<Timer>> timers;
+        std::vector<std::unique_ptr<LazyTimer>> lazyTimers;
+        for (size_t i = 0; i < connectionCount; ++i)
+        {
+            timers.emplace_back(new Timer);
+            timers.back()->setSingleShot(true);
+            lazyTimers.emplace_back(new LazyTimer);
+        }
+
+        WHEN("timers are restarted at the start and at the end of each request")
+        {
+            const auto timerNanoSecsPerRequest = nanoSecsPerRequest(timers, requestsPerConnection);
+            const auto rescheduleCount = DeadlineTracker::current()->rescheduleCount();
+            const auto lazyTimerNanoSecsPerRequest = nanoSecsPerRequest(lazyTimers, requestsPerConnection);
+            const auto reschedulesPerRequest = double(DeadlineTracker::current()->rescheduleCount() - rescheduleCount) / double(connectionCount * requestsPerConnection);
+
+            THEN("lazy timers reschedule at most once per request")
+            {
+                WARN(QByteArray("Connections: ").append(QByteArray::number(qsizetype(connectionCount))));
+                WARN(QByteArray("Timer ns per request: ").append(QByteArray::number(timerNanoSecsPerRequest)));
+                WARN(QByteArray("Timer reschedules per request: ").append(QByteArray::number(2)));
+                WARN(QByteArray("LazyTimer ns per request: ").append(QByteArray::number(lazyTimerNanoSecsPerRequest)));
+                WARN(QByteArray("LazyTimer reschedules per request: ").append(QByteArray::number(reschedulesPerRequest)));
+                REQUIRE(reschedulesPerRequest <= 1.0);
+            }
+        }
+    }
+}
+
+
+SCENARIO("Timer notifier wakeups per second")
+{
+    const auto tickMode = GENERATE(AS(TimerNotifier::TickMode), TimerNotifier::TickMode::Periodic, TimerNotifier::TickMode::Tickless);
+    const auto timerCount = GENERATE(AS(size_t), 1, 1000, 1000000);
+
+    GIVEN("timers with idle timeouts spread over one minute")
+    {
+        TimerNotifier timerNotifier(std::make_shared<ClockTicker>(64ms), std::make_shared<ClockTicker>(1ms), tickMode);
+        std::vector<Timer> timers(timerCount);
+        for (size_t i = 0; i < timerCount; ++i)
+        {
+            TimerNotifierTest::setTimerNotifier(timers[i], timerNotifier);
+            timers[i].start(std::chrono::milliseconds(1000 + (i * 7919) % 59000));
+        }
+
+        WHEN("event loop runs for two seconds")
+        {
+            const auto wakeupCount = timerNotifier.wakeupCount();
+            QSemaphore semaphore;
+            REQUIRE(!TRY_ACQUIRE(semaphore, QDeadlineTimer(2000)));
+            const auto wakeupsPerSecond = double(timerNotifier.wakeupCount() - wakeupCount) / 2.0;
+
+            THEN("tickless timer notifier only wakes up when timers are due")
+            {
+                WARN(QByteArray("Tick mode: ").append(tickMode == TimerNotifier::TickMode::Periodic ? "periodic" : "tickless"));
+                WARN(QByteArray("Timers: ").append(QByteArray::number(qsizetype(timerCount))));
+                WARN(QByteArray("Wakeups per second: ").append(QByteArray::number(wakeupsPerSecond)));
+                if (tickMode == TimerNotifier::TickMode::Tickless && timerCount == 1)
+                    REQUIRE(wakeupsPerSecond < (1000.0 / 64));
+            }
+        }
+    }
+}
+
+
 // SCENARIO("Timers fire at the right time")
 // {
 //     GIVEN("multiple timers each with a different interval")
@@ -29,12 +29,13 @@ using namespace std::chrono_literals;
 namespace Kourier
 {
 
-TimerNotifier::TimerNotifier()
+TimerNotifier::TimerNotifier(TickMode tickMode)
     : EpollEventSource(EPOLLET | EPOLLIN, EpollEventNotifier::current()),
       m_eventFd(eventfd(0, EFD_NONBLOCK)),
       m_lowResolutionTime(nsecsSinceEpoch()),
       m_pLowResolutionClockTicker(std::make_shared<ClockTicker>(std::chrono::milliseconds(64))),
-      m_pHighResolutionClockTicker(std::make_shared<ClockTicker>(std::chrono::milliseconds(1)))
+      m_pHighResolutionClockTicker(std::make_shared<ClockTicker>(std::chrono::milliseconds(1))),
+      m_tickMode(tickMode)
 {
     if (-1 == m_eventFd)
         qFatal("Failed to create event for timer notifier. Exiting.");
@@ -46,16 +47,21 @@ TimerNotifier::TimerNotifier()
     Object::connect(m_pHighResolutionClockTicker.get(), &ClockTicker::tick, this, &TimerNotifier::onHighResolutionTick);
     m_pHighResolutionClockTicker->setEnabled(false);
     m_pLowResolutionClockTicker->setEnabled(false);
-    m_pLowResolutionClockTicker->setEnabled(true);
+    if (m_tickMode == TickMode::Periodic)
+        m_pLowResolutionClockTicker->setEnabled(true);
+    else
+        m_highResolutionTime = m_lowResolutionTime;
 }
 
 TimerNotifier::TimerNotifier(std::shared_ptr<ClockTicker> pLowResolutionClockTicker,
-                             std::shared_ptr<ClockTicker> pHighResolutionClockTicker)
+                             std::shared_ptr<ClockTicker> pHighResolutionClockTicker,
+                             TickMode tickMode)
     : EpollEventSource(EPOLLET | EPOLLIN, EpollEventNotifier::current()),
       m_eventFd(eventfd(0, EFD_NONBLOCK)),
       m_lowResolutionTime(nsecsSinceEpoch()),
       m_pLowResolutionClockTicker(std::move(pLowResolutionClockTicker)),
-      m_pHighResolutionClockTicker(std::move(pHighResolutionClockTicker))
+      m_pHighResolutionClockTicker(std::move(pHighResolutionClockTicker)),
+      m_tickMode(tickMode)
 
 {
     if (-1 == m_eventFd)
@@ -68,7 +74,10 @@ TimerNotifier::TimerNotifier(std::shared_ptr<ClockTicker> pLowResolutionClockTic
     Object::connect(m_pHighResolutionClockTicker.get(), &ClockTicker::tick, this, &TimerNotifier::onHighResolutionTick);
     m_pHighResolutionClockTicker->setEnabled(false);
     m_pLowResolutionClockTicker->setEnabled(false);
-    m_pLowResolutionClockTicker->setEnabled(true);
+    if (m_tickMode == TickMode::Periodic)
+        m_pLowResolutionClockTicker->setEnabled(true);
+    else
+        m_highResolutionTime = m_lowResolutionTime;
 }
 
 TimerNotifier::~TimerNotifier()
@@ -81,6 +90,8 @@ void TimerNotifier::addTimer(TimerPrivate *pTimer)
     assert(pTimer);
     if (!m_isEnabled) [[unlikely]]
         return;
+    if (m_tickMode == TickMode::Tickless)
+        advanceClocks();
     pTimer->setExtraTimeout(std::chrono::milliseconds(0));
     pTimer->setTimeout(pTimer->interval());
     if (pTimer->timeout().count() > maxTimeout) [[unlikely]]
@@ -100,7 +111,7 @@ void TimerNotifier::addTimer(TimerPrivate *pTimer)
                     if (currentTime > m_lowResolutionTime)
                         pTimer->setExtraTimeout(std::chrono::duration_cast<std::chrono::milliseconds>(currentTime - m_lowResolutionTime));
                 }
-                else if (m_pHighResolutionClockTicker->isEnabled())
+                else if (isHighResolutionClockRunning())
                 {
                     const auto currentTime = nsecsSinceEpoch();
                     if (currentTime > m_highResolutionTime)
@@ -125,6 +136,8 @@ void TimerNotifier::addTimer(TimerPrivate *pTimer)
     }
     removeTimer(pTimer);
     addAdjustedTimer(pTimer);
+    if (m_tickMode == TickMode::Tickless)
+        scheduleClockTickers();
 }
 
 void TimerNotifier::removeTimer(TimerPrivate *pTimer)
@@ -136,7 +149,10 @@ void TimerNotifier::removeTimer(TimerPrivate *pTimer)
     if (pTimer->m_pTimerWheel) [[likely]]
     {
         pTimer->m_pTimerWheel->removeTimer(pTimer);
-        setHighResolutionClockTickerEnabled(!m_timerWheels[0].isEmpty());
+        // Clock tickers scheduled in tickless mode are left as they are. If they tick before
+        // the next timer is due, the clocks are advanced and the tickers are scheduled again.
+        if (m_tickMode == TickMode::Periodic)
+            setHighResolutionClockTickerEnabled(!m_timerWheels[0].isEmpty());
     }
     else
         m_timersToNotify.remove(pTimer);
@@ -164,10 +180,39 @@ void TimerNotifier::addAdjustedTimer(TimerPrivate *pTimer)
         pTimer->setExtraTimeout(std::chrono::milliseconds(0));
     }
     m_timerWheels[wheelIdxMap[std::countr_zero<uint64_t>(std::bit_floor<uint64_t>(std::max<uint64_t>(1ull, pTimer->timeout().count() - 1ull)))]].addTimer(pTimer);
-    setHighResolutionClockTickerEnabled(!m_timerWheels[0].isEmpty());
+    if (m_tickMode == TickMode::Periodic)
+        setHighResolutionClockTickerEnabled(!m_timerWheels[0].isEmpty());
 }
 
 void Kourier::TimerNotifier::onLowResolutionTick()
+{
+    if (m_tickMode == TickMode::Periodic)
+    {
+        tickLowResolutionClock();
+        setHighResolutionClockTickerEnabled(!m_timerWheels[0].isEmpty());
+    }
+    else
+    {
+        advanceClocks();
+        scheduleClockTickers();
+    }
+}
+
+void TimerNotifier::onHighResolutionTick()
+{
+    if (m_tickMode == TickMode::Periodic)
+    {
+        tickHighResolutionClock();
+        setHighResolutionClockTickerEnabled(!m_timerWheels[0].isEmpty());
+    }
+    else
+    {
+        advanceClocks();
+        scheduleClockTickers();
+    }
+}
+
+void TimerNotifier::tickLowResolutionClock()
 {
     m_lowResolutionTime += std::chrono::milliseconds(64);
     ++m_lowResolutionTickCounter;
@@ -187,16 +232,107 @@ void Kourier::TimerNotifier::onLowResolutionTick()
         expiredTimers.pushFront(tmpExpiredTimers);
     }
     processExpiredTimers(expiredTimers);
-    setHighResolutionClockTickerEnabled(!m_timerWheels[0].isEmpty());
 }
 
-void TimerNotifier::onHighResolutionTick()
+void TimerNotifier::tickHighResolutionClock()
 {
     m_highResolutionTime += std::chrono::milliseconds(1);
     TimerList expiredTimers;
     m_timerWheels[0].tick(expiredTimers);
     processExpiredTimers(expiredTimers);
-    setHighResolutionClockTickerEnabled(!m_timerWheels[0].isEmpty());
+}
+
+// In tickless mode, clocks are not ticked periodically. Instead, clock tickers are scheduled to
+// tick once when the next non-empty slot of the wheels expires. Clocks are brought up to date
+// whenever timers are added or tickers tick, skipping in one step all ticks that only expire
+// empty slots and cascading timers only on the ticks that expire non-empty slots.
+void TimerNotifier::advanceClocks()
+{
+    const auto currentTime = nsecsSinceEpoch();
+    if (currentTime - m_highResolutionTime >= std::chrono::milliseconds(1))
+        advanceHighResolutionClock((currentTime - m_highResolutionTime) / std::chrono::milliseconds(1));
+    if (currentTime - m_lowResolutionTime >= std::chrono::milliseconds(64))
+        advanceLowResolutionClock((currentTime - m_lowResolutionTime) / std::chrono::milliseconds(64));
+}
+
+void TimerNotifier::advanceLowResolutionClock(uint64_t tickCount)
+{
+    while (tickCount > 0)
+    {
+        const auto ticksToNextTimers = lowResolutionTicksToNextTimers();
+        if (ticksToNextTimers == 0 || ticksToNextTimers > tickCount)
+        {
+            skipLowResolutionTicks(tickCount);
+            return;
+        }
+        skipLowResolutionTicks(ticksToNextTimers - 1);
+        tickLowResolutionClock();
+        tickCount -= ticksToNextTimers;
+    }
+}
+
+void TimerNotifier::advanceHighResolutionClock(uint64_t tickCount)
+{
+    while (tickCount > 0)
+    {
+        const auto ticksToNextTimers = m_timerWheels[0].ticksToNextTimers();
+        if (ticksToNextTimers == 0 || ticksToNextTimers > tickCount)
+        {
+            m_timerWheels[0].skipTicks(tickCount);
+            m_highResolutionTime += std::chrono::milliseconds(tickCount);
+            return;
+        }
+        m_timerWheels[0].skipTicks(ticksToNextTimers - 1);
+        m_highResolutionTime += std::chrono::milliseconds(ticksToNextTimers - 1);
+        tickHighResolutionClock();
+        tickCount -= ticksToNextTimers;
+    }
+}
+
+// Wheel i, for i > 0, ticks whenever the low resolution tick counter becomes a multiple of 64^(i-1).
+void TimerNotifier::skipLowResolutionTicks(uint64_t tickCount)
+{
+    for (auto i = 1; i < 7; ++i)
+    {
+        const uint64_t wheelTickPeriod = 1ull << (6 * (i - 1));
+        m_timerWheels[i].skipTicks((m_lowResolutionTickCounter + tickCount) / wheelTickPeriod - m_lowResolutionTickCounter / wheelTickPeriod);
+    }
+    m_lowResolutionTickCounter += tickCount;
+    m_lowResolutionTime += std::chrono::milliseconds(tickCount << 6);
+}
+
+uint64_t TimerNotifier::lowResolutionTicksToNextTimers() const
+{
+    uint64_t ticksToNextTimers = 0;
+    for (auto i = 1; i < 7; ++i)
+    {
+        const auto wheelTicksToNextTimers = m_timerWheels[i].ticksToNextTimers();
+        if (wheelTicksToNextTimers == 0)
+            continue;
+        const uint64_t wheelTickPeriod = 1ull << (6 * (i - 1));
+        const auto ticks = (m_lowResolutionTickCounter / wheelTickPeriod + wheelTicksToNextTimers) * wheelTickPeriod - m_lowResolutionTickCounter;
+        if (ticksToNextTimers == 0 || ticks < ticksToNextTimers)
+            ticksToNextTimers = ticks;
+    }
+    return ticksToNextTimers;
+}
+
+void TimerNotifier::scheduleClockTickers()
+{
+    const auto highResolutionTicksToNextTimers = m_timerWheels[0].ticksToNextTimers();
+    if (highResolutionTicksToNextTimers > 0)
+        scheduleClockTick(*m_pHighResolutionClockTicker, m_highResolutionTime + std::chrono::milliseconds(highResolutionTicksToNextTimers));
+    const auto lowResolutionTicksToNextTimers = this->lowResolutionTicksToNextTimers();
+    if (lowResolutionTicksToNextTimers > 0)
+        scheduleClockTick(*m_pLowResolutionClockTicker, m_lowResolutionTime + std::chrono::milliseconds(lowResolutionTicksToNextTimers << 6));
+}
+
+// Tickers are only rescheduled to tick earlier, saving a timerfd_settime call whenever
+// the ticker is already scheduled to tick before the given time.
+void TimerNotifier::scheduleClockTick(ClockTicker &clockTicker, std::chrono::nanoseconds tickTime)
+{
+    if (!clockTicker.isEnabled() || !clockTicker.isSingleShot() || tickTime < clockTicker.scheduledTickTime())
+        clockTicker.scheduleTick(tickTime);
 }
 
 void TimerNotifier::set()
@@ -32,13 +32,17 @@ class TimerNotifier : public EpollEventSource
 {
 KOURIER_OBJECT(Kourier::TimerNotifier)
 public:
-    TimerNotifier();
+    enum class TickMode : uint8_t {Periodic, Tickless};
+    TimerNotifier(TickMode tickMode = TickMode::Tickless);
     TimerNotifier(std::shared_ptr<ClockTicker> pLowResolutionClockTicker,
-                  std::shared_ptr<ClockTicker> pHighResolutionClockTicker);
+                  std::shared_ptr<ClockTicker> pHighResolutionClockTicker,
+                  TickMode tickMode = TickMode::Periodic);
     ~TimerNotifier() override;
     void addTimer(TimerPrivate *pTimer);
     void removeTimer(TimerPrivate *pTimer);
+    inline TickMode tickMode() const {return m_tickMode;}
     inline std::chrono::nanoseconds lowResolutionTime() const {return m_lowResolutionTime;}
+    inline uint64_t wakeupCount() const {return m_pLowResolutionClockTicker->wakeupCount() + m_pHighResolutionClockTicker->wakeupCount();}
     int64_t fileDescriptor() const override {return m_eventFd;}
     inline static std::chrono::nanoseconds nsecsSinceEpoch() {return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch());}
 
@@ -46,6 +50,16 @@ private:
     void addAdjustedTimer(TimerPrivate *pTimer);
     void onLowResolutionTick();
     void onHighResolutionTick();
+    void tickLowResolutionClock();
+    void tickHighResolutionClock();
+    void advanceClocks();
+    void advanceLowResolutionClock(uint64_t tickCount);
+    void advanceHighResolutionClock(uint64_t tickCount);
+    void skipLowResolutionTicks(uint64_t tickCount);
+    uint64_t lowResolutionTicksToNextTimers() const;
+    void scheduleClockTickers();
+    static void scheduleClockTick(ClockTicker &clockTicker, std::chrono::nanoseconds tickTime);
+    inline bool isHighResolutionClockRunning() const {return m_tickMode == TickMode::Tickless || m_pHighResolutionClockTicker->isEnabled();}
     inline void setHighResolutionClockTickerEnabled(bool enabled)
     {
         if (enabled && !m_pHighResolutionClockTicker->isEnabled())
@@ -92,6 +106,7 @@ private:
                                    TimerWheel(std::chrono::milliseconds(1ull << 30)),
                                    TimerWheel(std::chrono::milliseconds(1ull << 36))};
     int64_t m_eventFd = -1;
+    const TickMode m_tickMode = TickMode::Periodic;
     bool m_eventIsSet = false;
     bool m_isNotifyingTimers = false;
     bool m_isEnabled = true;
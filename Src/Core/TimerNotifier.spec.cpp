@@ -23,7 +23,9 @@
 #include <Spectator>
 #include <QSemaphore>
 #include <QDeadlineTimer>
+#include <QElapsedTimer>
 #include <chrono>
+#include <cmath>
 #include <vector>
 #include <set>
 #include <utility>
@@ -668,3 +670,63 @@ SCENARIO("TimerNotifier moves timer on timer wheels until timer's timeout reache
         }
     }
 }
+
+
+SCENARIO("Tickless TimerNotifier schedules clock tickers to tick once when timers are due")
+{
+    GIVEN("a tickless timer notifier")
+    {
+        std::shared_ptr<ClockTicker> pLowResolutionClockTicker(new ClockTicker(std::chrono::milliseconds::max()));
+        std::shared_ptr<ClockTicker> pHighResolutionClockTicker(new ClockTicker(std::chrono::milliseconds::max()));
+        TimerNotifier timerNotifier(pLowResolutionClockTicker, pHighResolutionClockTicker, TimerNotifier::TickMode::Tickless);
+        REQUIRE(timerNotifier.tickMode() == TimerNotifier::TickMode::Tickless);
+        REQUIRE(!pLowResolutionClockTicker->isEnabled());
+        REQUIRE(!pHighResolutionClockTicker->isEnabled());
+
+        WHEN("a timer is started")
+        {
+            const auto interval = GENERATE(AS(std::chrono::milliseconds), 5ms, 64ms, 100ms, 300ms);
+            Timer timer;
+            timer.setSingleShot(true);
+            timer.setTimerType(Timer::TimerType::Precise);
+            TimerNotifierTest::setTimerNotifier(timer, timerNotifier);
+            QSemaphore timeoutSemaphore;
+            QElapsedTimer elapsedTimer;
+            qint64 elapsedTimeInMSecs = 0;
+            Object::connect(&timer, &Timer::timeout, [&]()
+            {
+                elapsedTimeInMSecs = elapsedTimer.elapsed();
+                timeoutSemaphore.release();
+            });
+            elapsedTimer.start();
+            timer.start(interval);
+
+            THEN("timer notifier schedules a single tick of the clock ticker driving the wheel the timer was added to")
+            {
+                if (interval <= 64ms)
+                {
+                    REQUIRE(pHighResolutionClockTicker->isSingleShot());
+                    REQUIRE(pHighResolutionClockTicker->scheduledTickTime() == (TimerNotifierTest::highResolutionTime(timerNotifier) + interval));
+                    REQUIRE(!pLowResolutionClockTicker->isEnabled());
+                }
+                else
+                {
+                    REQUIRE(pLowResolutionClockTicker->isSingleShot());
+                    REQUIRE(timerNotifier.lowResolutionTime() < pLowResolutionClockTicker->scheduledTickTime());
+                    REQUIRE(pLowResolutionClockTicker->scheduledTickTime() <= (timerNotifier.lowResolutionTime() + interval));
+                    REQUIRE(!pHighResolutionClockTicker->isEnabled());
+                }
+
+                AND_WHEN("control returns to the event loop until timer is due")
+                {
+                    REQUIRE(TRY_ACQUIRE(timeoutSemaphore, 10));
+
+                    THEN("timer times out after given interval with max error of 1ms")
+                    {
+                        REQUIRE(std::abs(interval.count() - elapsedTimeInMSecs) <= 1);
+                    }
+                }
+            }
+        }
+    }
+}
@@ -37,6 +37,7 @@ bool TimerWheel::addTimer(TimerPrivate *pTimer)
         pTimer->m_pTimerWheel = this;
         pTimer->m_idxTimerWheelSlot = getSlotIdx(pTimer->timeout());
         m_slots[pTimer->m_idxTimerWheelSlot].pushFront(pTimer);
+        m_nonEmptySlots |= (uint64_t(1) << pTimer->m_idxTimerWheelSlot);
         return true;
     }
     else [[unlikely]]
@@ -49,6 +50,8 @@ bool TimerWheel::removeTimer(TimerPrivate *pTimer)
     {
         --m_timerCount;
         m_slots[pTimer->m_idxTimerWheelSlot].remove(pTimer);
+        if (m_slots[pTimer->m_idxTimerWheelSlot].isEmpty())
+            m_nonEmptySlots &= ~(uint64_t(1) << pTimer->m_idxTimerWheelSlot);
         pTimer->m_pTimerWheel = nullptr;
         pTimer->m_idxTimerWheelSlot = 0;
         return true;
@@ -62,6 +65,7 @@ void TimerWheel::tick(TimerList &expiredTimers)
     ++m_tickCount;
     expiredTimers.clear();
     expiredTimers.swap(m_slots[m_idxNextTimersToExpire]);
+    m_nonEmptySlots &= ~(uint64_t(1) << m_idxNextTimersToExpire);
     if (++m_idxNextTimersToExpire == 64) [[unlikely]]
         m_idxNextTimersToExpire = 0;
     m_timerCount -= expiredTimers.size();
@@ -73,6 +77,14 @@ void TimerWheel::tick(TimerList &expiredTimers)
     }
 }
 
+// Skipped slots must be empty, which holds for the ticks that come before the next non-empty slot.
+void TimerWheel::skipTicks(uint64_t tickCount)
+{
+    assert(m_nonEmptySlots == 0 || tickCount < ticksToNextTimers());
+    m_tickCount += tickCount;
+    m_idxNextTimersToExpire = (m_idxNextTimersToExpire + tickCount) & 63;
+}
+
 std::chrono::milliseconds TimerWheel::adjustResolution(std::chrono::milliseconds resolution)
 {
     if (resolution.count() > 0) [[likely]]
@@ -20,6 +20,7 @@
 
 #include "TimerPrivate_epoll.h"
 #include "TimerList.h"
+#include <bit>
 #include <chrono>
 
 
@@ -42,6 +43,9 @@ public:
     inline size_t getSlotIdx(std::chrono::milliseconds timeout) const {return (((uint64_t)timeout.count() >> m_resolutionExponent) - 1 + m_idxNextTimersToExpire) & 63;}
     inline uint64_t timerCount() const {return m_timerCount;}
     inline uint64_t tickCount() const {return m_tickCount;}
+    // Number of ticks until the next non-empty slot expires, or zero if the wheel is empty.
+    inline uint64_t ticksToNextTimers() const {return m_nonEmptySlots ? (std::countr_zero(std::rotr(m_nonEmptySlots, int(m_idxNextTimersToExpire))) + 1) : 0;}
+    void skipTicks(uint64_t tickCount);
 
 private:
     static std::chrono::milliseconds adjustResolution(std::chrono::milliseconds resolution);
@@ -53,6 +57,7 @@ private:
     uint64_t m_idxNextTimersToExpire = 0;
     uint64_t m_timerCount = 0;
     uint64_t m_tickCount = 0;
+    uint64_t m_nonEmptySlots = 0;
     TimerList m_slots[64];
 };
 
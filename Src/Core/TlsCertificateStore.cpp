@@ -0,0 +1,164 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "TlsCertificateStore.h"
+#include "TlsConfiguration.h"
+#include "TlsContext.h"
+#include "RuntimeError.h"
+#include <openssl/evp.h>
+#include <openssl/tls1.h>
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+
+
+namespace Kourier
+{
+
+TlsCertificateStore::TlsCertificateStore() :
+    m_pEntries(std::make_shared<const Entries>())
+{
+}
+
+void TlsCertificateStore::setCertificateKeyPair(std::string_view serverName, std::string_view certificate, std::string_view key, std::string_view keyPassword)
+{
+    auto normalizedName = normalizedServerName(serverName);
+    if (normalizedName.empty())
+        throw RuntimeError(std::string("Failed to add certificate for server name ").append(serverName).append(". Server name is not valid."), RuntimeError::ErrorType::User);
+    auto pEntry = std::make_shared<Entry>();
+    pEntry->pCertificateKeyPair.reset(SSL_CTX_new(TLS_server_method()), &SSL_CTX_free);
+    if (!pEntry->pCertificateKeyPair)
+        throw RuntimeError("Failed to create OpenSSL context.", RuntimeError::ErrorType::TLS);
+    TlsConfiguration tlsConfiguration;
+    tlsConfiguration.setCertificateKeyPair(certificate, key, keyPassword);
+    TlsContext::useCertificateKeyPair(pEntry->pCertificateKeyPair.get(), tlsConfiguration);
+    // Connections take the session id context of the name they indicate, so sessions
+    // established under this name can only be resumed by clients indicating a name it covers.
+    unsigned char sessionIdContext[EVP_MAX_MD_SIZE];
+    unsigned int sessionIdContextSize = 0;
+    if (EVP_Digest(normalizedName.data(), normalizedName.size(), sessionIdContext, &sessionIdContextSize, EVP_sha256(), nullptr) != 1)
+        throw RuntimeError("Failed to set TLS session id context.", RuntimeError::ErrorType::TLS);
+    pEntry->sessionIdContextSize = std::min<unsigned int>(sessionIdContextSize, SSL_MAX_SID_CTX_LENGTH);
+    std::copy_n(sessionIdContext, pEntry->sessionIdContextSize, pEntry->sessionIdContext);
+    QMutexLocker locker(&m_updateLock);
+    auto pEntries = std::make_shared<Entries>(*m_pEntries.load());
+    (*pEntries)[std::move(normalizedName)] = std::move(pEntry);
+    m_pEntries.store(std::move(pEntries));
+}
+
+bool TlsCertificateStore::removeCertificateKeyPair(std::string_view serverName)
+{
+    const auto normalizedName = normalizedServerName(serverName);
+    QMutexLocker locker(&m_updateLock);
+    const auto pCurrentEntries = m_pEntries.load();
+    if (!pCurrentEntries->contains(normalizedName))
+        return false;
+    auto pEntries = std::make_shared<Entries>(*pCurrentEntries);
+    pEntries->erase(normalizedName);
+    m_pEntries.store(std::move(pEntries));
+    return true;
+}
+
+size_t TlsCertificateStore::size() const
+{
+    return m_pEntries.load()->size();
+}
+
+std::shared_ptr<const TlsCertificateStore::Entry> TlsCertificateStore::find(std::string_view serverName) const
+{
+    if (serverName.empty() || serverName.size() > maxServerNameSize)
+        return {};
+    const auto pEntries = m_pEntries.load();
+    if (pEntries->empty())
+        return {};
+    // Names are looked up in lower case. The leftmost label is then replaced with an asterisk in
+    // place to look up the wildcard entry covering the name.
+    char name[maxServerNameSize];
+    for (size_t i = 0; i < serverName.size(); ++i)
+        name[i] = std::tolower(static_cast<unsigned char>(serverName[i]));
+    std::string_view lowerCaseName(name, serverName.size());
+    if (const auto it = pEntries->find(lowerCaseName); it != pEntries->end())
+        return it->second;
+    const auto labelEnd = lowerCaseName.find('.');
+    if (labelEnd == std::string_view::npos || labelEnd == 0 || labelEnd == lowerCaseName.size() - 1)
+        return {};
+    name[labelEnd - 1] = '*';
+    if (const auto it = pEntries->find(lowerCaseName.substr(labelEnd - 1)); it != pEntries->end())
+        return it->second;
+    return {};
+}
+
+void TlsCertificateStore::setupContext(SSL_CTX *pContext)
+{
+    assert(pContext != nullptr);
+    SSL_CTX_set_client_hello_cb(pContext, &TlsCertificateStore::onClientHello, this);
+}
+
+std::string TlsCertificateStore::normalizedServerName(std::string_view serverName)
+{
+    // Wildcards are only allowed as the whole leftmost label of a name with at least two labels.
+    const bool isWildcard = serverName.starts_with("*.");
+    const auto name = isWildcard ? serverName.substr(2) : serverName;
+    if (name.empty()
+        || serverName.size() > maxServerNameSize
+        || name.starts_with('.')
+        || name.ends_with('.')
+        || name.find("..") != std::string_view::npos
+        || name.find('*') != std::string_view::npos
+        || (isWildcard && name.find('.') == std::string_view::npos))
+        return {};
+    std::string normalizedName(serverName);
+    for (auto &character : normalizedName)
+        character = std::tolower(static_cast<unsigned char>(character));
+    return normalizedName;
+}
+
+int TlsCertificateStore::onClientHello(SSL *pSSL, int *pAlert, void *pArgument)
+{
+    // The server_name extension holds a list of names, of which only the first one
+    // of type host_name is used: list size (2), name type (1), name size (2), name.
+    const unsigned char *pExtension = nullptr;
+    size_t extensionSize = 0;
+    if (pArgument == nullptr
+        || SSL_client_hello_get0_ext(pSSL, TLSEXT_TYPE_server_name, &pExtension, &extensionSize) != 1
+        || extensionSize < 5)
+        return SSL_CLIENT_HELLO_SUCCESS;
+    const size_t listSize = (size_t(pExtension[0]) << 8) | pExtension[1];
+    if (listSize != extensionSize - 2 || pExtension[2] != TLSEXT_NAMETYPE_host_name)
+        return SSL_CLIENT_HELLO_SUCCESS;
+    const size_t nameSize = (size_t(pExtension[3]) << 8) | pExtension[4];
+    if (nameSize > extensionSize - 5)
+        return SSL_CLIENT_HELLO_SUCCESS;
+    const auto pEntry = static_cast<TlsCertificateStore*>(pArgument)->find(std::string_view((const char*)pExtension + 5, nameSize));
+    if (!pEntry)
+        return SSL_CLIENT_HELLO_SUCCESS;
+    // Certificates of the server context are cleared first, so that OpenSSL does not pick them
+    // for signature algorithms the certificate registered for the name does not support.
+    auto *pCertificateKeyPair = pEntry->pCertificateKeyPair.get();
+    STACK_OF(X509) *pChain = nullptr;
+    SSL_certs_clear(pSSL);
+    if (SSL_CTX_get0_chain_certs(pCertificateKeyPair, &pChain) != 1
+        || SSL_use_cert_and_key(pSSL, SSL_CTX_get0_certificate(pCertificateKeyPair), SSL_CTX_get0_privatekey(pCertificateKeyPair), pChain, 1) != 1
+        || SSL_set_session_id_context(pSSL, pEntry->sessionIdContext, pEntry->sessionIdContextSize) != 1)
+    {
+        *pAlert = SSL_AD_INTERNAL_ERROR;
+        return SSL_CLIENT_HELLO_ERROR;
+    }
+    return SSL_CLIENT_HELLO_SUCCESS;
+}
+
+}
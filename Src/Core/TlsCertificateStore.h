@@ -0,0 +1,84 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_TLS_CERTIFICATE_STORE_H
+#define KOURIER_TLS_CERTIFICATE_STORE_H
+
+#include <QMutex>
+#include <openssl/ssl.h>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+
+namespace Kourier
+{
+
+// Maps server names to certificate/key pairs, so that a single server context can serve several hosts.
+// Server contexts set up with a TlsCertificateStore look up the server name the client sends (SNI) in
+// their client hello callback and replace the connection's certificate chain and key with the ones
+// registered for that name, either exactly (api.example.com) or by a wildcard (*.example.com) that covers
+// a single leftmost label. Connections keep the server context's certificate if no entry matches.
+// Connections stay on the server context, so peer verification, client CA lists and every other
+// setting of the server's TLS configuration apply to all names.
+//
+// Entries live in an immutable hash map that lookups load atomically. Changing an entry publishes a new
+// map, so certificates can be swapped while workers handshake without locking them. Handshakes that
+// already took a certificate keep it.
+class TlsCertificateStore
+{
+public:
+    TlsCertificateStore();
+    TlsCertificateStore(const TlsCertificateStore&) = delete;
+    TlsCertificateStore &operator=(const TlsCertificateStore&) = delete;
+    ~TlsCertificateStore() = default;
+    void setCertificateKeyPair(std::string_view serverName, std::string_view certificate, std::string_view key, std::string_view keyPassword = "");
+    bool removeCertificateKeyPair(std::string_view serverName);
+    struct Entry
+    {
+        // Holds the certificate chain and key loaded from the certificate/key pair.
+        std::shared_ptr<SSL_CTX> pCertificateKeyPair;
+        unsigned char sessionIdContext[SSL_MAX_SID_CTX_LENGTH];
+        unsigned int sessionIdContextSize = 0;
+    };
+    size_t size() const;
+    std::shared_ptr<const Entry> find(std::string_view serverName) const;
+    void setupContext(SSL_CTX *pContext);
+
+private:
+    static std::string normalizedServerName(std::string_view serverName);
+    static int onClientHello(SSL *pSSL, int *pAlert, void *pArgument);
+
+private:
+    static constexpr size_t maxServerNameSize = 253;
+    struct ServerNameHash
+    {
+        using is_transparent = void;
+        inline size_t operator()(std::string_view serverName) const {return std::hash<std::string_view>{}(serverName);}
+    };
+    using Entries = std::unordered_map<std::string, std::shared_ptr<const Entry>, ServerNameHash, std::equal_to<>>;
+    std::atomic<std::shared_ptr<const Entries>> m_pEntries;
+    QMutex m_updateLock;
+};
+
+}
+
+#endif // KOURIER_TLS_CERTIFICATE_STORE_H
@@ -180,6 +180,77 @@ Sets the \link TlsConfiguration::PeerVerifyMode peer verification mode\endlink.
 If \a useSystemCertificates is true, TlsConfiguration sets OpenSSL to load CA certificates from default locations.
 */
 
+/*!
+\fn TlsConfiguration::setKernelTlsEnabled(bool enabled)
+If \a enabled is true, TlsSocket hands record encryption and decryption over to the kernel (kTLS) after
+completing the handshake of TLS 1.3 connections using the TLS_AES_128_GCM_SHA256, TLS_AES_256_GCM_SHA384 or
+TLS_CHACHA20_POLY1305_SHA256 ciphers. Data is then written to and read from the socket without being copied
+through OpenSSL, which also allows sending files with sendfile(2) over encrypted connections.
+TlsSocket silently keeps encrypting data with OpenSSL if the connection does not qualify for kernel TLS
+or if the kernel does not support it. Kernel TLS is disabled by default.
+*/
+
+/*!
+\fn TlsConfiguration::setSessionCacheSize(size_t size)
+Sets the maximum number of TLS sessions to cache for resumption. Servers cache sessions by session id and share
+them among all workers, so that clients reconnecting to any worker can resume their sessions with an abbreviated
+handshake. Clients cache the last session established with each server they connect to and offer it when reconnecting.
+A \a size of zero, the default, disables the session cache.
+*/
+
+/*!
+\fn TlsConfiguration::setSessionTimeout(std::chrono::seconds timeout)
+Sets the lifetime of TLS sessions established with this configuration. Sessions older than \a timeout cannot be resumed.
+The default timeout is 7200 seconds.
+*/
+
+/*!
+\fn TlsConfiguration::setSessionTicketsEnabled(bool enabled)
+If \a enabled is true, servers issue stateless session tickets, which carry the encrypted session state and
+let clients resume sessions without the server having to store them. The keys used to encrypt tickets are kept
+in memory only, are shared by all workers and are periodically rotated
+(see [setSessionTicketKeyRotationInterval](@ref Kourier::TlsConfiguration::setSessionTicketKeyRotationInterval)).
+Clients accept session tickets from TLS 1.2 servers if \a enabled is true.
+Session tickets are disabled by default.
+*/
+
+/*!
+\fn TlsConfiguration::setSessionTicketKeyRotationInterval(std::chrono::seconds interval)
+Sets the \a interval after which servers start encrypting session tickets with a new key. Tickets encrypted with previous
+keys are accepted and renewed for as long as their sessions have not timed out. The default interval is 3600 seconds.
+*/
+
+/*!
+\fn TlsConfiguration::setMaxEarlyDataSize(uint32_t size)
+Sets the maximum amount of TLS 1.3 early data (0-RTT) servers accept on resumed sessions. Early data can be replayed
+by attackers, and HttpServer only processes requests received as early data if they target routes added with early data
+enabled using idempotent methods. Other requests are processed after the handshake completes. Early data requires
+either the session cache or session tickets to be enabled. A \a size of zero, the default, disables early data.
+*/
+
+/*!
+\fn TlsConfiguration::setDynamicRecordSizingEnabled(bool enabled)
+If \a enabled is true, TlsSocket sends data in small records, each fitting in a single TCP segment, until 128 KiB have been
+sent on the connection, and in records as large as TLS allows afterwards. Connections that have not sent any data for one second
+go back to small records. Peers can then decrypt the first bytes of a response as soon as the first segment arrives, instead
+of waiting for a whole 16 KiB record to arrive, while bulk transfers keep the lower overhead of large records. Records encrypted
+by the kernel when [kernel TLS](@ref Kourier::TlsConfiguration::setKernelTlsEnabled) is active are not resized.
+Dynamic record sizing is disabled by default.
+*/
+
+/*!
+\fn TlsConfiguration::setHandshakeThreadCount(size_t count)
+If \a count is greater than zero, server-side TlsSocket runs the steps of the TLS handshake, including its expensive
+private-key and key-exchange operations, on a dedicated pool of handshake threads. The socket's thread only relays handshake
+data while a step runs and resumes the connection once the pool posts the step's result back to the socket's event loop.
+A burst of new connections then does not stall established connections handled by the same thread.
+All TLS configurations share a single process-wide handshake pool, which runs as many threads as the largest count among the
+server configurations in use. Threads no longer needed are stopped when the servers whose configurations requested them stop.
+Connections using [kernel TLS](@ref Kourier::TlsConfiguration::setKernelTlsEnabled) or accepting
+[early data](@ref Kourier::TlsConfiguration::setMaxEarlyDataSize) always run their handshakes on the socket's thread.
+Handshakes run on the socket's thread if \a count is zero, which is the default.
+*/
+
 /*!
 \fn TlsConfiguration::certificate()
 Returns the file path of the local certificate given in [setCertificateKeyPair](@ref Kourier::TlsConfiguration::setCertificateKeyPair),
@@ -233,6 +304,46 @@ Returns the peer verify depth.
 Returns the \link TlsConfiguration::PeerVerifyMode peer verify mode\endlink.
 */
 
+/*!
+\fn TlsConfiguration::kernelTlsEnabled()
+Returns true if TlsSocket should try to offload record encryption and decryption to the kernel.
+*/
+
+/*!
+\fn TlsConfiguration::sessionCacheSize()
+Returns the maximum number of TLS sessions to cache for resumption.
+*/
+
+/*!
+\fn TlsConfiguration::sessionTimeout()
+Returns the lifetime of TLS sessions.
+*/
+
+/*!
+\fn TlsConfiguration::sessionTicketsEnabled()
+Returns true if session tickets are enabled.
+*/
+
+/*!
+\fn TlsConfiguration::sessionTicketKeyRotationInterval()
+Returns the interval at which keys encrypting session tickets are rotated.
+*/
+
+/*!
+\fn TlsConfiguration::maxEarlyDataSize()
+Returns the maximum amount of TLS 1.3 early data servers accept.
+*/
+
+/*!
+\fn TlsConfiguration::dynamicRecordSizingEnabled()
+Returns true if TlsSocket sizes records dynamically.
+*/
+
+/*!
+\fn TlsConfiguration::handshakeThreadCount()
+Returns the number of threads running TLS handshakes for server-side sockets. Zero means handshakes run on the socket's thread.
+*/
+
 struct TlsConfigurationData : public QSharedData
 {
     std::string m_certificate;
@@ -245,6 +356,14 @@ struct TlsConfigurationData : public QSharedData
     int m_peerVerifyDepth = 0;
     TlsConfiguration::PeerVerifyMode m_peerVerifyMode = TlsConfiguration::PeerVerifyMode::Auto;
     bool m_useSystemCertificates = true;
+    bool m_kernelTlsEnabled = false;
+    size_t m_sessionCacheSize = 0;
+    std::chrono::seconds m_sessionTimeout = std::chrono::seconds(7200);
+    bool m_sessionTicketsEnabled = false;
+    std::chrono::seconds m_sessionTicketKeyRotationInterval = std::chrono::seconds(3600);
+    uint32_t m_maxEarlyDataSize = 0;
+    bool m_dynamicRecordSizingEnabled = false;
+    size_t m_handshakeThreadCount = 0;
     friend inline bool operator==(const TlsConfigurationData &obj1, const TlsConfigurationData &obj2)
     {
         return obj1.m_certificate == obj2.m_certificate
@@ -256,7 +375,15 @@ struct TlsConfigurationData : public QSharedData
                && obj1.m_addedCertificates == obj2.m_addedCertificates
                && obj1.m_peerVerifyDepth == obj2.m_peerVerifyDepth
                && obj1.m_peerVerifyMode == obj2.m_peerVerifyMode
-               && obj1.m_useSystemCertificates == obj2.m_useSystemCertificates;
+               && obj1.m_useSystemCertificates == obj2.m_useSystemCertificates
+               && obj1.m_kernelTlsEnabled == obj2.m_kernelTlsEnabled
+               && obj1.m_sessionCacheSize == obj2.m_sessionCacheSize
+               && obj1.m_sessionTimeout == obj2.m_sessionTimeout
+               && obj1.m_sessionTicketsEnabled == obj2.m_sessionTicketsEnabled
+               && obj1.m_sessionTicketKeyRotationInterval == obj2.m_sessionTicketKeyRotationInterval
+               && obj1.m_maxEarlyDataSize == obj2.m_maxEarlyDataSize
+               && obj1.m_dynamicRecordSizingEnabled == obj2.m_dynamicRecordSizingEnabled
+               && obj1.m_handshakeThreadCount == obj2.m_handshakeThreadCount;
     }
 };
 
@@ -358,6 +485,48 @@ void TlsConfiguration::setUseSystemCertificates(bool useSystemCertificates)
     m_d->m_useSystemCertificates = useSystemCertificates;
 }
 
+void TlsConfiguration::setKernelTlsEnabled(bool enabled)
+{
+    m_d->m_kernelTlsEnabled = enabled;
+}
+
+void TlsConfiguration::setSessionCacheSize(size_t size)
+{
+    m_d->m_sessionCacheSize = size;
+}
+
+void TlsConfiguration::setSessionTimeout(std::chrono::seconds timeout)
+{
+    if (timeout.count() > 0)
+        m_d->m_sessionTimeout = timeout;
+}
+
+void TlsConfiguration::setSessionTicketsEnabled(bool enabled)
+{
+    m_d->m_sessionTicketsEnabled = enabled;
+}
+
+void TlsConfiguration::setSessionTicketKeyRotationInterval(std::chrono::seconds interval)
+{
+    if (interval.count() > 0)
+        m_d->m_sessionTicketKeyRotationInterval = interval;
+}
+
+void TlsConfiguration::setMaxEarlyDataSize(uint32_t size)
+{
+    m_d->m_maxEarlyDataSize = size;
+}
+
+void TlsConfiguration::setDynamicRecordSizingEnabled(bool enabled)
+{
+    m_d->m_dynamicRecordSizingEnabled = enabled;
+}
+
+void TlsConfiguration::setHandshakeThreadCount(size_t count)
+{
+    m_d->m_handshakeThreadCount = count;
+}
+
 const std::string &TlsConfiguration::certificate() const
 {
     return m_d->m_certificate;
@@ -408,6 +577,46 @@ TlsConfiguration::PeerVerifyMode TlsConfiguration::peerVerifyMode() const
     return m_d->m_peerVerifyMode;
 }
 
+bool TlsConfiguration::kernelTlsEnabled() const
+{
+    return m_d->m_kernelTlsEnabled;
+}
+
+size_t TlsConfiguration::sessionCacheSize() const
+{
+    return m_d->m_sessionCacheSize;
+}
+
+std::chrono::seconds TlsConfiguration::sessionTimeout() const
+{
+    return m_d->m_sessionTimeout;
+}
+
+bool TlsConfiguration::sessionTicketsEnabled() const
+{
+    return m_d->m_sessionTicketsEnabled;
+}
+
+std::chrono::seconds TlsConfiguration::sessionTicketKeyRotationInterval() const
+{
+    return m_d->m_sessionTicketKeyRotationInterval;
+}
+
+uint32_t TlsConfiguration::maxEarlyDataSize() const
+{
+    return m_d->m_maxEarlyDataSize;
+}
+
+bool TlsConfiguration::dynamicRecordSizingEnabled() const
+{
+    return m_d->m_dynamicRecordSizingEnabled;
+}
+
+size_t TlsConfiguration::handshakeThreadCount() const
+{
+    return m_d->m_handshakeThreadCount;
+}
+
 bool operator==(const TlsConfiguration &obj1, const TlsConfiguration &obj2)
 {
     return *(obj1.m_d.constData()) == *(obj2.m_d.constData());
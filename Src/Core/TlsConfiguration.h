@@ -22,6 +22,8 @@
 #include <QSharedDataPointer>
 #include <string>
 #include <set>
+#include <chrono>
+#include <cstdint>
 
 
 namespace Kourier
@@ -71,6 +73,14 @@ public:
     void setPeerVerifyDepth(int depth);
     void setPeerVerifyMode(PeerVerifyMode mode);
     void setUseSystemCertificates(bool useSystemCertificates);
+    void setKernelTlsEnabled(bool enabled);
+    void setSessionCacheSize(size_t size);
+    void setSessionTimeout(std::chrono::seconds timeout);
+    void setSessionTicketsEnabled(bool enabled);
+    void setSessionTicketKeyRotationInterval(std::chrono::seconds interval);
+    void setMaxEarlyDataSize(uint32_t size);
+    void setDynamicRecordSizingEnabled(bool enabled);
+    void setHandshakeThreadCount(size_t count);
     const std::string &certificate() const;
     const std::string &privateKey() const;
     const std::string &privateKeyPassword() const;
@@ -81,6 +91,14 @@ public:
     TlsVersion tlsVersion() const;
     int peerVerifyDepth() const;
     PeerVerifyMode peerVerifyMode() const;
+    bool kernelTlsEnabled() const;
+    size_t sessionCacheSize() const;
+    std::chrono::seconds sessionTimeout() const;
+    bool sessionTicketsEnabled() const;
+    std::chrono::seconds sessionTicketKeyRotationInterval() const;
+    uint32_t maxEarlyDataSize() const;
+    bool dynamicRecordSizingEnabled() const;
+    size_t handshakeThreadCount() const;
     friend bool operator==(const TlsConfiguration &obj1, const TlsConfiguration &obj2);
 
 private:
@@ -16,6 +16,9 @@
 //
 
 #include "TlsContext.h"
+#include "TlsCertificateStore.h"
+#include "TlsHandshakePool.h"
+#include "KernelTls.h"
 #include "NoDestroy.h"
 #include <forward_list>
 #include <cstdio>
@@ -106,12 +109,37 @@ private:
     std::vector<X509*> m_defaultCaCerts;
 };
 
+TlsContext::TlsContextData::TlsContextData(const TlsConfiguration &tlsConfiguration, Role role) :
+    m_tlsConfiguration(tlsConfiguration),
+    m_role(role),
+    m_pSessionCache(TlsSessionCache::fromTlsConfiguration(tlsConfiguration, role == Role::Server))
+{
+    auto *pContext = SSL_CTX_new((role == Role::Client) ? TLS_client_method() : TLS_server_method());
+    if (pContext == nullptr)
+        throw RuntimeError("Failed to create OpenSSL context.", RuntimeError::ErrorType::TLS);
+    m_pContext = pContext;
+    // The handshake pool runs as many threads as the largest count reserved by the server contexts in use.
+    // Sockets using kernel TLS always run their handshakes on their own threads.
+    if (role == Role::Server && !tlsConfiguration.kernelTlsEnabled() && tlsConfiguration.handshakeThreadCount() > 0)
+    {
+        m_reservedHandshakeThreadCount = tlsConfiguration.handshakeThreadCount();
+        TlsHandshakePool::reserveThreads(m_reservedHandshakeThreadCount);
+    }
+}
+
+TlsContext::TlsContextData::~TlsContextData()
+{
+    if (m_reservedHandshakeThreadCount > 0)
+        TlsHandshakePool::releaseThreads(m_reservedHandshakeThreadCount);
+    SSL_CTX_free(m_pContext);
+}
+
 TlsContext::TlsContext(Role role, const TlsConfiguration &tlsConfiguration)
 {
     m_pTlsContextData.reset(new TlsContextData(tlsConfiguration, role));
 }
 
-TlsContext TlsContext::fromTlsConfiguration(const TlsConfiguration &tlsConfiguration, Role role)
+TlsContext TlsContext::fromTlsConfiguration(const TlsConfiguration &tlsConfiguration, Role role, std::shared_ptr<TlsCertificateStore> pCertificateStore)
 {
     //
     // Search cache first
@@ -150,7 +178,7 @@ TlsContext TlsContext::fromTlsConfiguration(const TlsConfiguration &tlsConfigura
     {
         for (auto &it : *(pTlsContextCacheThreadData->m_pContextCache))
         {
-            if (it.role() == role && it.tlsConfiguration() == tlsConfiguration)
+            if (it.role() == role && it.certificateStore() == pCertificateStore && it.tlsConfiguration() == tlsConfiguration)
                 return it;
         }
     }
@@ -158,9 +186,7 @@ TlsContext TlsContext::fromTlsConfiguration(const TlsConfiguration &tlsConfigura
     // Create context
     //
     TlsContext tlsContext(role, tlsConfiguration);
-    PassphraseCallbackRestorer passphraseCallbackRestorer(tlsContext.context());
-    SSL_CTX_set_default_passwd_cb(tlsContext.context(), &pemPasswordCallback);
-    SSL_CTX_set_default_passwd_cb_userdata(tlsContext.context(), (void*)&tlsConfiguration);
+    tlsContext.m_pTlsContextData->m_pCertificateStore = pCertificateStore;
     //
     // Load CA Certificates
     //
@@ -210,47 +236,9 @@ TlsContext TlsContext::fromTlsConfiguration(const TlsConfiguration &tlsConfigura
     }
     X509_STORE_set_flags(pCaCertStore, X509_V_FLAG_PARTIAL_CHAIN);
     //
-    // Load private key
+    // Load certificate and private key
     //
-    if (!tlsConfiguration.privateKey().empty())
-    {
-        if (SSL_CTX_use_PrivateKey_file(tlsContext.context(), tlsConfiguration.privateKey().c_str(), SSL_FILETYPE_PEM) != 1) [[unlikely]]
-        {
-            throw RuntimeError(std::string("Failed to load private key from ")
-                                   .append(tlsConfiguration.privateKey().c_str())
-                                   .append("."), RuntimeError::ErrorType::TLS);
-        }
-    }
-    //
-    // Load local certificate
-    //
-    if (!tlsConfiguration.certificate().empty())
-    {
-        if (SSL_CTX_use_certificate_chain_file(tlsContext.context(), tlsConfiguration.certificate().c_str()) != 1) [[unlikely]]
-        {
-            throw RuntimeError(std::string("Failed to load certificate chain from ")
-                                   .append(tlsConfiguration.certificate().c_str())
-                                   .append("."), RuntimeError::ErrorType::TLS);
-        }
-    }
-    //
-    // Validate and set local certificate and private key
-    //
-    if (!tlsConfiguration.privateKey().empty() && !tlsConfiguration.certificate().empty())
-    {
-        if (SSL_CTX_check_private_key(tlsContext.context()) != 1) [[unlikely]]
-        {
-            throw RuntimeError(std::string("Failed to validate private key ")
-                                   .append(tlsConfiguration.privateKey().c_str())
-                                   .append("."), RuntimeError::ErrorType::TLS);
-        }
-        if (SSL_CTX_build_cert_chain(tlsContext.context(), SSL_BUILD_CHAIN_FLAG_IGNORE_ERROR | SSL_BUILD_CHAIN_FLAG_UNTRUSTED | SSL_BUILD_CHAIN_FLAG_NO_ROOT) != 1) [[unlikely]]
-        {
-            throw RuntimeError(std::string("Failed to validate certificate chain ")
-                                   .append(tlsConfiguration.certificate().c_str())
-                                   .append("."), RuntimeError::ErrorType::TLS);
-        }
-    }
+    useCertificateKeyPair(tlsContext.context(), tlsConfiguration);
     //
     // Setting cipher list
     //
@@ -403,15 +391,27 @@ TlsContext TlsContext::fromTlsConfiguration(const TlsConfiguration &tlsConfigura
                 throw RuntimeError("Failed to set maximum TLS protocol version to 1.2 or newer.", RuntimeError::ErrorType::TLS);
             break;
     }
-    SSL_CTX_set_session_cache_mode(tlsContext.context(), SSL_SESS_CACHE_OFF | SSL_SESS_CACHE_NO_INTERNAL);
-    if (SSL_CTX_set_num_tickets(tlsContext.context(), 0) != 1) [[unlikely]]
-        throw RuntimeError("Failed to disable sending session tickets on connections using TLS 1.3.", RuntimeError::ErrorType::TLS);
-    SSL_CTX_set_options(tlsContext.context(), SSL_OP_NO_COMPRESSION | SSL_OP_NO_RENEGOTIATION | SSL_OP_NO_TICKET | SSL_OP_CIPHER_SERVER_PREFERENCE);
-    SSL_CTX_set_num_tickets(tlsContext.context(), 0);
+    SSL_CTX_set_options(tlsContext.context(), SSL_OP_NO_COMPRESSION | SSL_OP_NO_RENEGOTIATION | SSL_OP_CIPHER_SERVER_PREFERENCE);
     SSL_CTX_set_mode(tlsContext.context(), SSL_MODE_AUTO_RETRY | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER | SSL_MODE_RELEASE_BUFFERS);
     SSL_CTX_set_read_ahead(tlsContext.context(), 0);
     SSL_CTX_set_dh_auto(tlsContext.context(), 1);
-    SSL_CTX_set_not_resumable_session_callback(tlsContext.context(), &notResumableSessionCallback);
+    //
+    // Configuring session resumption
+    //
+    if (tlsContext.sessionCache()->isEnabled())
+        tlsContext.sessionCache()->setupContext(tlsContext.context());
+    else
+    {
+        SSL_CTX_set_session_cache_mode(tlsContext.context(), SSL_SESS_CACHE_OFF | SSL_SESS_CACHE_NO_INTERNAL);
+        if (SSL_CTX_set_num_tickets(tlsContext.context(), 0) != 1) [[unlikely]]
+            throw RuntimeError("Failed to disable sending session tickets on connections using TLS 1.3.", RuntimeError::ErrorType::TLS);
+        SSL_CTX_set_options(tlsContext.context(), SSL_OP_NO_TICKET);
+        SSL_CTX_set_not_resumable_session_callback(tlsContext.context(), &notResumableSessionCallback);
+    }
+    if (tlsConfiguration.kernelTlsEnabled())
+        KernelTls::prepareContext(tlsContext.context());
+    if (role == Role::Server && pCertificateStore)
+        pCertificateStore->setupContext(tlsContext.context());
     //
     // Configuring Peer Verify Mode
     //
@@ -482,6 +482,55 @@ TlsContext TlsContext::fromTlsConfiguration(const TlsConfiguration &tlsConfigura
     return tlsContext;
 }
 
+void TlsContext::useCertificateKeyPair(SSL_CTX *pContext, const TlsConfiguration &tlsConfiguration)
+{
+    PassphraseCallbackRestorer passphraseCallbackRestorer(pContext);
+    SSL_CTX_set_default_passwd_cb(pContext, &pemPasswordCallback);
+    SSL_CTX_set_default_passwd_cb_userdata(pContext, (void*)&tlsConfiguration);
+    //
+    // Load private key
+    //
+    if (!tlsConfiguration.privateKey().empty())
+    {
+        if (SSL_CTX_use_PrivateKey_file(pContext, tlsConfiguration.privateKey().c_str(), SSL_FILETYPE_PEM) != 1) [[unlikely]]
+        {
+            throw RuntimeError(std::string("Failed to load private key from ")
+                                   .append(tlsConfiguration.privateKey().c_str())
+                                   .append("."), RuntimeError::ErrorType::TLS);
+        }
+    }
+    //
+    // Load local certificate
+    //
+    if (!tlsConfiguration.certificate().empty())
+    {
+        if (SSL_CTX_use_certificate_chain_file(pContext, tlsConfiguration.certificate().c_str()) != 1) [[unlikely]]
+        {
+            throw RuntimeError(std::string("Failed to load certificate chain from ")
+                                   .append(tlsConfiguration.certificate().c_str())
+                                   .append("."), RuntimeError::ErrorType::TLS);
+        }
+    }
+    //
+    // Validate and set local certificate and private key
+    //
+    if (!tlsConfiguration.privateKey().empty() && !tlsConfiguration.certificate().empty())
+    {
+        if (SSL_CTX_check_private_key(pContext) != 1) [[unlikely]]
+        {
+            throw RuntimeError(std::string("Failed to validate private key ")
+                                   .append(tlsConfiguration.privateKey().c_str())
+                                   .append("."), RuntimeError::ErrorType::TLS);
+        }
+        if (SSL_CTX_build_cert_chain(pContext, SSL_BUILD_CHAIN_FLAG_IGNORE_ERROR | SSL_BUILD_CHAIN_FLAG_UNTRUSTED | SSL_BUILD_CHAIN_FLAG_NO_ROOT) != 1) [[unlikely]]
+        {
+            throw RuntimeError(std::string("Failed to validate certificate chain ")
+                                   .append(tlsConfiguration.certificate().c_str())
+                                   .append("."), RuntimeError::ErrorType::TLS);
+        }
+    }
+}
+
 std::pair<bool, std::string> TlsContext::validateTlsConfiguration(const TlsConfiguration &tlsConfiguration, Role role)
 {
     auto response = std::make_pair(true, std::string{});
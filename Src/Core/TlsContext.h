@@ -19,6 +19,7 @@
 #define KOURIER_TLS_CONTEXT_H
 
 #include "TlsConfiguration.h"
+#include "TlsSessionCache.h"
 #include "RuntimeError.h"
 #include <openssl/ssl.h>
 #include <memory>
@@ -28,6 +29,8 @@
 namespace Kourier
 {
 
+class TlsCertificateStore;
+
 class TlsContext
 {
 public:
@@ -37,29 +40,28 @@ public:
     TlsContext(const TlsContext&) = default;
     ~TlsContext() = default;
     TlsContext& operator=(const TlsContext&) = default;
+    inline bool isNull() const {return !m_pTlsContextData;}
     inline SSL_CTX *context() const {assert(m_pTlsContextData); return m_pTlsContextData->m_pContext;}
     const TlsConfiguration &tlsConfiguration() const {assert(m_pTlsContextData); return m_pTlsContextData->m_tlsConfiguration;}
     Role role() const {assert(m_pTlsContextData); return m_pTlsContextData->m_role;}
-    static TlsContext fromTlsConfiguration(const TlsConfiguration &tlsConfiguration, Role role);
+    inline TlsSessionCache *sessionCache() const {assert(m_pTlsContextData); return m_pTlsContextData->m_pSessionCache.get();}
+    inline const std::shared_ptr<TlsCertificateStore> &certificateStore() const {assert(m_pTlsContextData); return m_pTlsContextData->m_pCertificateStore;}
+    static TlsContext fromTlsConfiguration(const TlsConfiguration &tlsConfiguration, Role role, std::shared_ptr<TlsCertificateStore> pCertificateStore = {});
+    static void useCertificateKeyPair(SSL_CTX *pContext, const TlsConfiguration &tlsConfiguration);
     static std::pair<bool, std::string> validateTlsConfiguration(const TlsConfiguration &tlsConfiguration, Role role);
 
 private:
     struct TlsContextData
     {
         TlsContextData() = default;
-        TlsContextData(const TlsConfiguration &tlsConfiguration, Role role) :
-            m_tlsConfiguration(tlsConfiguration),
-            m_role(role)
-        {
-            auto *pContext = SSL_CTX_new((role == Role::Client) ? TLS_client_method() : TLS_server_method());
-            if (pContext == nullptr)
-                throw RuntimeError("Failed to create OpenSSL context.", RuntimeError::ErrorType::TLS);
-            m_pContext = pContext;
-        }
-        ~TlsContextData() {SSL_CTX_free(m_pContext);}
+        TlsContextData(const TlsConfiguration &tlsConfiguration, Role role);
+        ~TlsContextData();
         SSL_CTX *m_pContext = nullptr;
         TlsConfiguration m_tlsConfiguration;
         Role m_role = Role::Client;
+        std::shared_ptr<TlsSessionCache> m_pSessionCache;
+        std::shared_ptr<TlsCertificateStore> m_pCertificateStore;
+        size_t m_reservedHandshakeThreadCount = 0;
     };
     std::shared_ptr<TlsContextData> m_pTlsContextData;
 };
@@ -0,0 +1,311 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "TlsHandshakePool.h"
+#include "EpollEventSource.h"
+#include "NoDestroy.h"
+#include "UnixUtils.h"
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <openssl/crypto.h>
+#include <openssl/err.h>
+#include <sys/eventfd.h>
+#include <algorithm>
+#include <deque>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <vector>
+
+
+namespace Kourier
+{
+
+// Steps finished by the pool are queued to the thread that started them, whose event loop is woken up
+// through an eventfd. Steps hold a reference to the queue, so that steps finishing after their thread
+// has exited can still be handed back and released.
+class TlsHandshakeCompletionQueue
+{
+public:
+    TlsHandshakeCompletionQueue() :
+        m_eventFd(eventfd(0, EFD_NONBLOCK))
+    {
+        if (-1 == m_eventFd)
+            qFatal("Failed to create event for TLS handshake pool. Exiting.");
+    }
+    ~TlsHandshakeCompletionQueue() {UnixUtils::safeClose(m_eventFd);}
+    inline int eventFd() const {return m_eventFd;}
+    void push(TlsHandshakeStep *pStep)
+    {
+        {
+            QMutexLocker locker(&m_lock);
+            if (!m_isClosed)
+            {
+                m_finishedSteps.push_back(pStep);
+                if (m_finishedSteps.size() == 1)
+                {
+                    const uint64_t value = 1;
+                    UnixUtils::safeWrite(m_eventFd, (const char*)&value, sizeof(value));
+                }
+                return;
+            }
+        }
+        SSL_free(pStep->m_pSSL);
+        delete pStep;
+    }
+    void takeFinishedSteps(std::vector<TlsHandshakeStep*> &finishedSteps)
+    {
+        uint64_t value = 0;
+        UnixUtils::safeRead(m_eventFd, (char*)&value, sizeof(value));
+        QMutexLocker locker(&m_lock);
+        finishedSteps.swap(m_finishedSteps);
+    }
+    void close(std::vector<TlsHandshakeStep*> &finishedSteps)
+    {
+        QMutexLocker locker(&m_lock);
+        m_isClosed = true;
+        finishedSteps.swap(m_finishedSteps);
+    }
+
+private:
+    const int m_eventFd = -1;
+    QMutex m_lock;
+    std::vector<TlsHandshakeStep*> m_finishedSteps;
+    bool m_isClosed = false;
+};
+
+class TlsHandshakeCompletionNotifier : public EpollEventSource
+{
+KOURIER_OBJECT(Kourier::TlsHandshakeCompletionNotifier)
+public:
+    TlsHandshakeCompletionNotifier() :
+        EpollEventSource(EPOLLET | EPOLLIN),
+        m_pCompletionQueue(std::make_shared<TlsHandshakeCompletionQueue>())
+    {
+        setEnabled(true);
+    }
+    ~TlsHandshakeCompletionNotifier() override
+    {
+        setEnabled(false);
+        std::vector<TlsHandshakeStep*> finishedSteps;
+        m_pCompletionQueue->close(finishedSteps);
+        for (auto *pStep : finishedSteps)
+        {
+            SSL_free(pStep->m_pSSL);
+            delete pStep;
+        }
+    }
+    int64_t fileDescriptor() const override {return m_pCompletionQueue->eventFd();}
+    inline const std::shared_ptr<TlsHandshakeCompletionQueue> &completionQueue() const {return m_pCompletionQueue;}
+    static TlsHandshakeCompletionNotifier *current()
+    {
+        static thread_local NoDestroy<TlsHandshakeCompletionNotifier*> pCompletionNotifier(new TlsHandshakeCompletionNotifier);
+        static thread_local NoDestroyPtrDeleter<TlsHandshakeCompletionNotifier*> completionNotifierDeleter(pCompletionNotifier);
+        return pCompletionNotifier();
+    }
+
+private:
+    void onEvent(uint32_t epollEvents) override
+    {
+        if (EPOLLIN != (epollEvents & EPOLLIN))
+            return;
+        std::vector<TlsHandshakeStep*> finishedSteps;
+        m_pCompletionQueue->takeFinishedSteps(finishedSteps);
+        for (auto *pStep : finishedSteps)
+        {
+            // Steps canceled while running no longer have a receiver and their SSL objects are released here.
+            if (pStep->m_pReceiver != nullptr)
+                pStep->m_callback(*pStep, pStep->m_pReceiver);
+            else
+                SSL_free(pStep->m_pSSL);
+            delete pStep;
+        }
+    }
+
+private:
+    const std::shared_ptr<TlsHandshakeCompletionQueue> m_pCompletionQueue;
+};
+
+// Handshake steps run on threads owned by the pool, which runs as many threads as the largest count reserved
+// by the server contexts in use. Threads no longer needed finish the step they are running and exit. They are
+// joined once they have finished and all threads are stopped and joined when the process exits.
+class TlsHandshakeThreads
+{
+public:
+    TlsHandshakeThreads() = default;
+    ~TlsHandshakeThreads() = default;
+    static TlsHandshakeThreads &instance()
+    {
+        static NoDestroy<TlsHandshakeThreads> handshakeThreads;
+        static NoDestroyCleaner<TlsHandshakeThreads> handshakeThreadsCleaner(handshakeThreads, &TlsHandshakeThreads::stop);
+        return handshakeThreads();
+    }
+    void run(TlsHandshakeStep *pStep)
+    {
+        QMutexLocker locker(&m_lock);
+        m_pendingSteps.push_back(pStep);
+        m_hasPendingSteps.wakeOne();
+    }
+    void reserve(size_t threadCount)
+    {
+        QMutexLocker locker(&m_lock);
+        ++m_reservedThreadCounts[threadCount];
+        resize();
+    }
+    void release(size_t threadCount)
+    {
+        QMutexLocker locker(&m_lock);
+        const auto it = m_reservedThreadCounts.find(threadCount);
+        assert(it != m_reservedThreadCounts.end());
+        if (--it->second == 0)
+            m_reservedThreadCounts.erase(it);
+        resize();
+    }
+    size_t threadCount()
+    {
+        QMutexLocker locker(&m_lock);
+        return m_workers.size();
+    }
+
+private:
+    struct Worker
+    {
+        std::unique_ptr<QThread> pThread;
+        bool isStopping = false;
+    };
+    void resize()
+    {
+        std::erase_if(m_stoppedWorkers, [](const auto &pWorker) {return pWorker->pThread->isFinished();});
+        const size_t threadCount = (m_isStopped || m_reservedThreadCounts.empty()) ? 0 : m_reservedThreadCounts.rbegin()->first;
+        if (m_workers.size() > threadCount)
+        {
+            // Releases can come from pool threads deleting the last step of a context, so stopped
+            // threads are not waited for here.
+            while (m_workers.size() > threadCount)
+            {
+                m_workers.back()->isStopping = true;
+                m_stoppedWorkers.push_back(std::move(m_workers.back()));
+                m_workers.pop_back();
+            }
+            m_hasPendingSteps.wakeAll();
+        }
+        while (m_workers.size() < threadCount)
+        {
+            auto pWorker = std::make_unique<Worker>();
+            pWorker->pThread.reset(QThread::create(&TlsHandshakeThreads::processSteps, this, pWorker.get()));
+            pWorker->pThread->start();
+            m_workers.push_back(std::move(pWorker));
+        }
+    }
+    void stop()
+    {
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::deque<TlsHandshakeStep*> pendingSteps;
+        {
+            QMutexLocker locker(&m_lock);
+            m_isStopped = true;
+            for (auto &pWorker : m_workers)
+                pWorker->isStopping = true;
+            workers.swap(m_workers);
+            std::move(m_stoppedWorkers.begin(), m_stoppedWorkers.end(), std::back_inserter(workers));
+            m_stoppedWorkers.clear();
+            pendingSteps.swap(m_pendingSteps);
+            m_hasPendingSteps.wakeAll();
+        }
+        for (auto &pWorker : workers)
+            pWorker->pThread->wait();
+        for (auto *pStep : pendingSteps)
+        {
+            SSL_free(pStep->m_pSSL);
+            delete pStep;
+        }
+    }
+    void processSteps(Worker *pWorker)
+    {
+        while (true)
+        {
+            TlsHandshakeStep *pStep = nullptr;
+            {
+                QMutexLocker locker(&m_lock);
+                while (m_pendingSteps.empty() && !pWorker->isStopping)
+                    m_hasPendingSteps.wait(&m_lock);
+                if (pWorker->isStopping)
+                    break;
+                pStep = m_pendingSteps.front();
+                m_pendingSteps.pop_front();
+            }
+            // OpenSSL error queues are per thread. The first error is handed to the socket's thread
+            // so that it can report why the handshake failed.
+            ERR_clear_error();
+            pStep->m_result = SSL_do_handshake(pStep->m_pSSL);
+            pStep->m_error = (pStep->m_result == 1) ? SSL_ERROR_NONE : SSL_get_error(pStep->m_pSSL, pStep->m_result);
+            pStep->m_errorCode = ERR_peek_error();
+            ERR_clear_error();
+            const auto pCompletionQueue = std::move(pStep->m_pCompletionQueue);
+            pCompletionQueue->push(pStep);
+        }
+        OPENSSL_thread_stop();
+    }
+
+private:
+    QMutex m_lock;
+    QWaitCondition m_hasPendingSteps;
+    std::deque<TlsHandshakeStep*> m_pendingSteps;
+    std::map<size_t, size_t> m_reservedThreadCounts;
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::vector<std::unique_ptr<Worker>> m_stoppedWorkers;
+    bool m_isStopped = false;
+};
+
+TlsHandshakeStep *TlsHandshakePool::runStep(SSL *pSSL, const TlsContext &tlsContext, TlsHandshakeStepCallback callback, void *pReceiver)
+{
+    assert(pSSL != nullptr && !tlsContext.isNull() && callback != nullptr && pReceiver != nullptr);
+    auto *pStep = new TlsHandshakeStep;
+    pStep->m_pSSL = pSSL;
+    pStep->m_tlsContext = tlsContext;
+    pStep->m_callback = callback;
+    pStep->m_pReceiver = pReceiver;
+    pStep->m_pCompletionQueue = TlsHandshakeCompletionNotifier::current()->completionQueue();
+    TlsHandshakeThreads::instance().run(pStep);
+    return pStep;
+}
+
+void TlsHandshakePool::cancelStep(TlsHandshakeStep *pStep)
+{
+    assert(pStep != nullptr);
+    pStep->m_pReceiver = nullptr;
+}
+
+void TlsHandshakePool::reserveThreads(size_t threadCount)
+{
+    assert(threadCount > 0);
+    TlsHandshakeThreads::instance().reserve(threadCount);
+}
+
+void TlsHandshakePool::releaseThreads(size_t threadCount)
+{
+    assert(threadCount > 0);
+    TlsHandshakeThreads::instance().release(threadCount);
+}
+
+size_t TlsHandshakePool::threadCount()
+{
+    return TlsHandshakeThreads::instance().threadCount();
+}
+
+}
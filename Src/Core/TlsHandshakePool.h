@@ -0,0 +1,75 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_TLS_HANDSHAKE_POOL_H
+#define KOURIER_TLS_HANDSHAKE_POOL_H
+
+#include "TlsContext.h"
+#include <openssl/ssl.h>
+#include <cstddef>
+#include <memory>
+
+
+namespace Kourier
+{
+
+class TlsHandshakeCompletionQueue;
+class TlsHandshakeStep;
+using TlsHandshakeStepCallback = void (*)(TlsHandshakeStep &, void *);
+
+class TlsHandshakeStep
+{
+public:
+    inline SSL *ssl() const {return m_pSSL;}
+    inline int result() const {return m_result;}
+    inline int error() const {return m_error;}
+    inline unsigned long errorCode() const {return m_errorCode;}
+
+private:
+    TlsHandshakeStep() = default;
+    ~TlsHandshakeStep() = default;
+
+private:
+    SSL *m_pSSL = nullptr;
+    // Keeps the session cache and certificate store used by the context's callbacks alive
+    // while the step runs, even if the socket that started it is gone.
+    TlsContext m_tlsContext;
+    TlsHandshakeStepCallback m_callback = nullptr;
+    void *m_pReceiver = nullptr;
+    std::shared_ptr<TlsHandshakeCompletionQueue> m_pCompletionQueue;
+    int m_result = 0;
+    int m_error = SSL_ERROR_NONE;
+    unsigned long m_errorCode = 0;
+    friend class TlsHandshakePool;
+    friend class TlsHandshakeCompletionQueue;
+    friend class TlsHandshakeCompletionNotifier;
+    friend class TlsHandshakeThreads;
+};
+
+class TlsHandshakePool
+{
+public:
+    static TlsHandshakeStep *runStep(SSL *pSSL, const TlsContext &tlsContext, TlsHandshakeStepCallback callback, void *pReceiver);
+    static void cancelStep(TlsHandshakeStep *pStep);
+    static void reserveThreads(size_t threadCount);
+    static void releaseThreads(size_t threadCount);
+    static size_t threadCount();
+};
+
+}
+
+#endif // KOURIER_TLS_HANDSHAKE_POOL_H
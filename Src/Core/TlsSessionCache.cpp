@@ -0,0 +1,390 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "TlsSessionCache.h"
+#include "RuntimeError.h"
+#include "NoDestroy.h"
+#include <openssl/core_names.h>
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+
+namespace Kourier
+{
+
+namespace
+{
+
+// Describes every setting affecting whether a session can be resumed. Contexts created from configurations
+// with the same description share sessions, and the description's digest is used as session id context.
+std::string sessionIdContextFrom(const TlsConfiguration &tlsConfiguration, bool isServer)
+{
+    std::string description(isServer ? "server" : "client");
+    auto appendField = [&description](std::string_view field)
+    {
+        description.append(std::to_string(field.size())).append(":").append(field);
+    };
+    appendField(tlsConfiguration.certificate());
+    appendField(tlsConfiguration.privateKey());
+    appendField(std::to_string((int)tlsConfiguration.tlsVersion()));
+    for (const auto cipher : tlsConfiguration.ciphers())
+        appendField(std::to_string((int)cipher));
+    description.append(";");
+    for (const auto curve : tlsConfiguration.curves())
+        appendField(std::to_string((int)curve));
+    description.append(";");
+    for (const auto &caCertificate : tlsConfiguration.addedCertificates())
+        appendField(caCertificate);
+    description.append(";");
+    appendField(std::to_string(tlsConfiguration.peerVerifyDepth()));
+    appendField(std::to_string((int)tlsConfiguration.peerVerifyMode()));
+    appendField(tlsConfiguration.useSystemCertificates() ? "1" : "0");
+    appendField(std::to_string(tlsConfiguration.sessionCacheSize()));
+    appendField(std::to_string(tlsConfiguration.sessionTimeout().count()));
+    appendField(tlsConfiguration.sessionTicketsEnabled() ? "1" : "0");
+    appendField(std::to_string(tlsConfiguration.sessionTicketKeyRotationInterval().count()));
+    appendField(std::to_string(tlsConfiguration.maxEarlyDataSize()));
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int digestSize = 0;
+    if (EVP_Digest(description.data(), description.size(), digest, &digestSize, EVP_sha256(), nullptr) != 1)
+        throw RuntimeError("Failed to compute TLS session id context.", RuntimeError::ErrorType::TLS);
+    return std::string((const char*)digest, std::min<size_t>(digestSize, SSL_MAX_SID_CTX_LENGTH));
+}
+
+bool setTicketMacKey(EVP_MAC_CTX *pMacContext, const unsigned char *pKey, size_t keySize)
+{
+    char digestName[] = "SHA256";
+    OSSL_PARAM params[] = {OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, const_cast<unsigned char*>(pKey), keySize),
+                           OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, digestName, 0),
+                           OSSL_PARAM_construct_end()};
+    return EVP_MAC_CTX_set_params(pMacContext, params) == 1;
+}
+
+}
+
+TlsSessionCache::TlsSessionCache(const TlsConfiguration &tlsConfiguration, bool isServer) :
+    m_sessionIdContext(sessionIdContextFrom(tlsConfiguration, isServer)),
+    m_isServer(isServer),
+    m_capacity(tlsConfiguration.sessionCacheSize()),
+    m_shardCapacity(std::max<size_t>(1, (m_capacity + shardCount - 1) / shardCount)),
+    m_sessionTimeout(tlsConfiguration.sessionTimeout()),
+    m_usesTickets(tlsConfiguration.sessionTicketsEnabled()),
+    m_ticketKeyRotationInterval(tlsConfiguration.sessionTicketKeyRotationInterval()),
+    m_maxEarlyDataSize(tlsConfiguration.maxEarlyDataSize())
+{
+    if (m_capacity > 0)
+        m_shards.reset(new Shard[shardCount]);
+    if (m_isServer && m_usesTickets)
+    {
+        TicketKey ticketKey;
+        if (RAND_bytes(ticketKey.name, sizeof(ticketKey.name)) != 1
+            || RAND_priv_bytes(ticketKey.aesKey, sizeof(ticketKey.aesKey)) != 1
+            || RAND_priv_bytes(ticketKey.hmacKey, sizeof(ticketKey.hmacKey)) != 1)
+            throw RuntimeError("Failed to generate session ticket keys.", RuntimeError::ErrorType::TLS);
+        ticketKey.creationTime = std::chrono::steady_clock::now();
+        m_ticketKeys.push_back(ticketKey);
+    }
+}
+
+TlsSessionCache::~TlsSessionCache()
+{
+    if (!m_ticketKeys.empty())
+        OPENSSL_cleanse(m_ticketKeys.data(), m_ticketKeys.size() * sizeof(TicketKey));
+}
+
+std::shared_ptr<TlsSessionCache> TlsSessionCache::fromTlsConfiguration(const TlsConfiguration &tlsConfiguration, bool isServer)
+{
+    static NoDestroy<QMutex> registryLock;
+    static NoDestroy<std::unordered_map<std::string, std::weak_ptr<TlsSessionCache>>> registry;
+    const auto sessionIdContext = sessionIdContextFrom(tlsConfiguration, isServer);
+    QMutexLocker locker(&registryLock());
+    std::erase_if(registry(), [](const auto &item) {return item.second.expired();});
+    auto &pWeakSessionCache = registry()[sessionIdContext];
+    auto pSessionCache = pWeakSessionCache.lock();
+    if (!pSessionCache)
+    {
+        pSessionCache = std::make_shared<TlsSessionCache>(tlsConfiguration, isServer);
+        pWeakSessionCache = pSessionCache;
+    }
+    return pSessionCache;
+}
+
+void TlsSessionCache::setupContext(SSL_CTX *pContext)
+{
+    assert(pContext != nullptr && isEnabled());
+    SSL_CTX_set_ex_data(pContext, contextExDataIndex(), this);
+    if (SSL_CTX_set_session_id_context(pContext, (const unsigned char*)m_sessionIdContext.data(), m_sessionIdContext.size()) != 1)
+        throw RuntimeError("Failed to set TLS session id context.", RuntimeError::ErrorType::TLS);
+    SSL_CTX_set_timeout(pContext, m_sessionTimeout.count());
+    if (m_isServer)
+    {
+        if (m_capacity > 0)
+        {
+            SSL_CTX_set_session_cache_mode(pContext, SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL | SSL_SESS_CACHE_NO_AUTO_CLEAR);
+            SSL_CTX_sess_set_new_cb(pContext, &TlsSessionCache::onNewSession);
+            SSL_CTX_sess_set_get_cb(pContext, &TlsSessionCache::onGetSession);
+            SSL_CTX_sess_set_remove_cb(pContext, &TlsSessionCache::onRemoveSession);
+        }
+        else
+            SSL_CTX_set_session_cache_mode(pContext, SSL_SESS_CACHE_OFF | SSL_SESS_CACHE_NO_INTERNAL);
+        if (m_usesTickets)
+        {
+            if (SSL_CTX_set_tlsext_ticket_key_evp_cb(pContext, &TlsSessionCache::onTicketKey) != 1)
+                throw RuntimeError("Failed to set session ticket key callback.", RuntimeError::ErrorType::TLS);
+        }
+        else
+            SSL_CTX_set_options(pContext, SSL_OP_NO_TICKET);
+        if (m_maxEarlyDataSize > 0)
+        {
+            if (SSL_CTX_set_max_early_data(pContext, m_maxEarlyDataSize) != 1
+                || SSL_CTX_set_recv_max_early_data(pContext, m_maxEarlyDataSize) != 1)
+                throw RuntimeError("Failed to enable TLS 1.3 early data.", RuntimeError::ErrorType::TLS);
+            // OpenSSL's replay protection requires its internal cache, which is not used here. Cached
+            // TLS 1.3 sessions are single-use instead (see onGetSession), and routes only accept early
+            // data for idempotent methods.
+            SSL_CTX_set_options(pContext, SSL_OP_NO_ANTI_REPLAY);
+        }
+    }
+    else
+    {
+        SSL_CTX_set_session_cache_mode(pContext, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL);
+        SSL_CTX_sess_set_new_cb(pContext, &TlsSessionCache::onNewSession);
+        if (!m_usesTickets)
+            SSL_CTX_set_options(pContext, SSL_OP_NO_TICKET);
+    }
+}
+
+void TlsSessionCache::setupClientSession(SSL *pSSL, const std::string &peer)
+{
+    assert(pSSL != nullptr);
+    if (m_isServer || m_capacity == 0)
+        return;
+    SSL_set_ex_data(pSSL, peerExDataIndex(), const_cast<std::string*>(&peer));
+    if (peer.empty())
+        return;
+    auto *pSession = get(peer);
+    if (pSession == nullptr)
+        return;
+    // RFC8446 C.4. Clients should not reuse a TLS 1.3 ticket.
+    if (SSL_SESSION_get_protocol_version(pSession) == TLS1_3_VERSION)
+        remove(peer);
+    SSL_set_session(pSSL, pSession);
+    SSL_SESSION_free(pSession);
+}
+
+TlsSessionCache::Shard &TlsSessionCache::shardFromKey(std::string_view key)
+{
+    assert(m_shards);
+    return m_shards[std::hash<std::string_view>{}(key) % shardCount];
+}
+
+void TlsSessionCache::add(std::string_view key, SSL_SESSION *pSession)
+{
+    if (key.empty() || SSL_SESSION_is_resumable(pSession) != 1)
+        return;
+    const auto serializedSessionSize = i2d_SSL_SESSION(pSession, nullptr);
+    if (serializedSessionSize <= 0)
+        return;
+    std::string serializedSession(serializedSessionSize, '\0');
+    auto *pSerializedSessionData = (unsigned char*)serializedSession.data();
+    if (i2d_SSL_SESSION(pSession, &pSerializedSessionData) != serializedSessionSize)
+        return;
+    const auto expirationTime = std::chrono::steady_clock::now() + std::chrono::seconds(SSL_SESSION_get_timeout(pSession));
+    auto &shard = shardFromKey(key);
+    std::string keyString(key);
+    QMutexLocker locker(&shard.lock);
+    auto it = shard.entries.find(keyString);
+    if (it != shard.entries.end())
+    {
+        it->second.session = std::move(serializedSession);
+        it->second.expirationTime = expirationTime;
+        return;
+    }
+    while (shard.entries.size() >= m_shardCapacity)
+    {
+        shard.entries.erase(shard.insertionOrder.front());
+        shard.insertionOrder.pop_front();
+    }
+    shard.insertionOrder.push_back(keyString);
+    shard.entries.emplace(std::move(keyString), Entry{std::move(serializedSession), expirationTime, std::prev(shard.insertionOrder.end())});
+}
+
+SSL_SESSION *TlsSessionCache::get(std::string_view key)
+{
+    std::string serializedSession;
+    {
+        auto &shard = shardFromKey(key);
+        QMutexLocker locker(&shard.lock);
+        auto it = shard.entries.find(std::string(key));
+        if (it == shard.entries.end())
+            return nullptr;
+        if (it->second.expirationTime <= std::chrono::steady_clock::now())
+        {
+            shard.insertionOrder.erase(it->second.insertionOrderIt);
+            shard.entries.erase(it);
+            return nullptr;
+        }
+        serializedSession = it->second.session;
+    }
+    const auto *pSerializedSessionData = (const unsigned char*)serializedSession.data();
+    return d2i_SSL_SESSION(nullptr, &pSerializedSessionData, serializedSession.size());
+}
+
+void TlsSessionCache::remove(std::string_view key)
+{
+    auto &shard = shardFromKey(key);
+    QMutexLocker locker(&shard.lock);
+    auto it = shard.entries.find(std::string(key));
+    if (it != shard.entries.end())
+    {
+        shard.insertionOrder.erase(it->second.insertionOrderIt);
+        shard.entries.erase(it);
+    }
+}
+
+// Keys are rotated lazily, when issuing tickets. Previous keys are kept for as long as tickets they
+// encrypted can be used, so that tickets are renewed with the current key instead of being rejected.
+void TlsSessionCache::rotateTicketKeysIfNeeded()
+{
+    const auto now = std::chrono::steady_clock::now();
+    {
+        QReadLocker locker(&m_ticketKeysLock);
+        if ((now - m_ticketKeys.back().creationTime) < m_ticketKeyRotationInterval)
+            return;
+    }
+    QWriteLocker locker(&m_ticketKeysLock);
+    if ((now - m_ticketKeys.back().creationTime) < m_ticketKeyRotationInterval)
+        return;
+    TicketKey ticketKey;
+    if (RAND_bytes(ticketKey.name, sizeof(ticketKey.name)) != 1
+        || RAND_priv_bytes(ticketKey.aesKey, sizeof(ticketKey.aesKey)) != 1
+        || RAND_priv_bytes(ticketKey.hmacKey, sizeof(ticketKey.hmacKey)) != 1)
+    {
+        OPENSSL_cleanse(&ticketKey, sizeof(ticketKey));
+        return;
+    }
+    ticketKey.creationTime = now;
+    m_ticketKeys.push_back(ticketKey);
+    OPENSSL_cleanse(&ticketKey, sizeof(ticketKey));
+    const auto maxTicketKeyAge = m_ticketKeyRotationInterval + m_sessionTimeout;
+    size_t expiredTicketKeyCount = 0;
+    while ((expiredTicketKeyCount + 1) < m_ticketKeys.size() && (now - m_ticketKeys[expiredTicketKeyCount].creationTime) >= maxTicketKeyAge)
+        ++expiredTicketKeyCount;
+    if (expiredTicketKeyCount > 0)
+    {
+        OPENSSL_cleanse(m_ticketKeys.data(), expiredTicketKeyCount * sizeof(TicketKey));
+        m_ticketKeys.erase(m_ticketKeys.begin(), m_ticketKeys.begin() + expiredTicketKeyCount);
+    }
+}
+
+int TlsSessionCache::contextExDataIndex()
+{
+    static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+int TlsSessionCache::peerExDataIndex()
+{
+    static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+int TlsSessionCache::onNewSession(SSL *pSSL, SSL_SESSION *pSession)
+{
+    auto *pSessionCache = (TlsSessionCache*)SSL_CTX_get_ex_data(SSL_get_SSL_CTX(pSSL), contextExDataIndex());
+    if (pSessionCache == nullptr || pSessionCache->m_capacity == 0)
+        return 0;
+    if (pSessionCache->m_isServer)
+    {
+        unsigned int sessionIdSize = 0;
+        const auto *pSessionId = SSL_SESSION_get_id(pSession, &sessionIdSize);
+        pSessionCache->add(std::string_view((const char*)pSessionId, sessionIdSize), pSession);
+    }
+    else if (const auto *pPeer = (const std::string*)SSL_get_ex_data(pSSL, peerExDataIndex()); pPeer != nullptr)
+        pSessionCache->add(*pPeer, pSession);
+    // The session is stored serialized, so OpenSSL keeps ownership of the given session.
+    return 0;
+}
+
+SSL_SESSION *TlsSessionCache::onGetSession(SSL *pSSL, const unsigned char *pSessionId, int sessionIdSize, int *pCopy)
+{
+    *pCopy = 0;
+    auto *pSessionCache = (TlsSessionCache*)SSL_CTX_get_ex_data(SSL_get_SSL_CTX(pSSL), contextExDataIndex());
+    if (pSessionCache == nullptr || pSessionCache->m_capacity == 0 || sessionIdSize <= 0)
+        return nullptr;
+    const std::string_view sessionId((const char*)pSessionId, sessionIdSize);
+    auto *pSession = pSessionCache->get(sessionId);
+    if (pSession != nullptr && pSessionCache->m_maxEarlyDataSize > 0 && SSL_version(pSSL) >= TLS1_3_VERSION)
+        pSessionCache->remove(sessionId);
+    return pSession;
+}
+
+void TlsSessionCache::onRemoveSession(SSL_CTX *pContext, SSL_SESSION *pSession)
+{
+    auto *pSessionCache = (TlsSessionCache*)SSL_CTX_get_ex_data(pContext, contextExDataIndex());
+    if (pSessionCache == nullptr || pSessionCache->m_capacity == 0)
+        return;
+    unsigned int sessionIdSize = 0;
+    const auto *pSessionId = SSL_SESSION_get_id(pSession, &sessionIdSize);
+    if (sessionIdSize > 0)
+        pSessionCache->remove(std::string_view((const char*)pSessionId, sessionIdSize));
+}
+
+int TlsSessionCache::onTicketKey(SSL *pSSL, unsigned char *pKeyName, unsigned char *pIV, EVP_CIPHER_CTX *pCipherContext, EVP_MAC_CTX *pMacContext, int encrypt)
+{
+    // Handshakes may run on handshake pool threads while another thread rotates the keys, so ticket keys are
+    // only accessed under m_ticketKeysLock. Servers using tickets always hold at least one key.
+    auto *pSessionCache = (TlsSessionCache*)SSL_CTX_get_ex_data(SSL_get_SSL_CTX(pSSL), contextExDataIndex());
+    if (pSessionCache == nullptr || !pSessionCache->m_usesTickets)
+        return -1;
+    static constexpr size_t ivSize = 16;
+    if (encrypt == 1)
+    {
+        pSessionCache->rotateTicketKeysIfNeeded();
+        QReadLocker locker(&pSessionCache->m_ticketKeysLock);
+        const auto &ticketKey = pSessionCache->m_ticketKeys.back();
+        if (RAND_bytes(pIV, ivSize) != 1)
+            return -1;
+        std::memcpy(pKeyName, ticketKey.name, sizeof(ticketKey.name));
+        if (EVP_EncryptInit_ex(pCipherContext, EVP_aes_256_cbc(), nullptr, ticketKey.aesKey, pIV) != 1
+            || !setTicketMacKey(pMacContext, ticketKey.hmacKey, sizeof(ticketKey.hmacKey)))
+            return -1;
+        return 1;
+    }
+    else
+    {
+        QReadLocker locker(&pSessionCache->m_ticketKeysLock);
+        const auto &ticketKeys = pSessionCache->m_ticketKeys;
+        for (auto it = ticketKeys.rbegin(); it != ticketKeys.rend(); ++it)
+        {
+            if (std::memcmp(pKeyName, it->name, sizeof(it->name)) != 0)
+                continue;
+            if (EVP_DecryptInit_ex(pCipherContext, EVP_aes_256_cbc(), nullptr, it->aesKey, pIV) != 1
+                || !setTicketMacKey(pMacContext, it->hmacKey, sizeof(it->hmacKey)))
+                return -1;
+            // Tickets encrypted with previous keys are accepted and renewed. TLS 1.3 tickets are always
+            // renewed, as clients use them only once and OpenSSL only issues new ones when asked to.
+            return (it == ticketKeys.rbegin() && SSL_version(pSSL) < TLS1_3_VERSION) ? 1 : 2;
+        }
+        return 0;
+    }
+}
+
+}
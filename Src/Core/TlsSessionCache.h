@@ -0,0 +1,112 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_TLS_SESSION_CACHE_H
+#define KOURIER_TLS_SESSION_CACHE_H
+
+#include "TlsConfiguration.h"
+#include <QMutex>
+#include <QReadWriteLock>
+#include <openssl/evp.h>
+#include <openssl/ssl.h>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+
+namespace Kourier
+{
+
+// Holds the session resumption state of a TLS configuration. Workers create their own OpenSSL contexts, but
+// contexts created from equal configurations share a TlsSessionCache, so that a session established on one
+// worker can be resumed on any other. Sessions are stored serialized in shards, each with its own lock, and
+// the keys protecting stateless session tickets are rotated in memory. TlsSessionCache also counts how many
+// handshakes were resumed and how many were full ones.
+class TlsSessionCache
+{
+public:
+    TlsSessionCache(const TlsConfiguration &tlsConfiguration, bool isServer);
+    TlsSessionCache(const TlsSessionCache&) = delete;
+    TlsSessionCache &operator=(const TlsSessionCache&) = delete;
+    ~TlsSessionCache();
+    static std::shared_ptr<TlsSessionCache> fromTlsConfiguration(const TlsConfiguration &tlsConfiguration, bool isServer);
+    void setupContext(SSL_CTX *pContext);
+    void setupClientSession(SSL *pSSL, const std::string &peer);
+    inline void countHandshake(bool isResumed) {(isResumed ? m_resumedHandshakeCount : m_fullHandshakeCount).fetch_add(1, std::memory_order_relaxed);}
+    inline size_t fullHandshakeCount() const {return m_fullHandshakeCount.load(std::memory_order_relaxed);}
+    inline size_t resumedHandshakeCount() const {return m_resumedHandshakeCount.load(std::memory_order_relaxed);}
+    inline bool isEnabled() const {return m_capacity > 0 || (m_isServer && m_usesTickets);}
+
+private:
+    struct Shard;
+    Shard &shardFromKey(std::string_view key);
+    void add(std::string_view key, SSL_SESSION *pSession);
+    SSL_SESSION *get(std::string_view key);
+    void remove(std::string_view key);
+    void rotateTicketKeysIfNeeded();
+    static int contextExDataIndex();
+    static int peerExDataIndex();
+    static int onNewSession(SSL *pSSL, SSL_SESSION *pSession);
+    static SSL_SESSION *onGetSession(SSL *pSSL, const unsigned char *pSessionId, int sessionIdSize, int *pCopy);
+    static void onRemoveSession(SSL_CTX *pContext, SSL_SESSION *pSession);
+    static int onTicketKey(SSL *pSSL, unsigned char *pKeyName, unsigned char *pIV, EVP_CIPHER_CTX *pCipherContext, EVP_MAC_CTX *pMacContext, int encrypt);
+
+private:
+    struct Entry
+    {
+        std::string session;
+        std::chrono::steady_clock::time_point expirationTime;
+        std::list<std::string>::iterator insertionOrderIt;
+    };
+    struct alignas(64) Shard
+    {
+        QMutex lock;
+        std::unordered_map<std::string, Entry> entries;
+        std::list<std::string> insertionOrder;
+    };
+    struct TicketKey
+    {
+        unsigned char name[16];
+        unsigned char aesKey[32];
+        unsigned char hmacKey[32];
+        std::chrono::steady_clock::time_point creationTime;
+    };
+    static constexpr size_t shardCount = 16;
+    std::string m_sessionIdContext;
+    const bool m_isServer;
+    const size_t m_capacity;
+    const size_t m_shardCapacity;
+    const std::chrono::seconds m_sessionTimeout;
+    const bool m_usesTickets;
+    const std::chrono::seconds m_ticketKeyRotationInterval;
+    const uint32_t m_maxEarlyDataSize;
+    std::unique_ptr<Shard[]> m_shards;
+    QReadWriteLock m_ticketKeysLock;
+    std::vector<TicketKey> m_ticketKeys;
+    std::atomic_size_t m_fullHandshakeCount = 0;
+    std::atomic_size_t m_resumedHandshakeCount = 0;
+};
+
+}
+
+#endif // KOURIER_TLS_SESSION_CACHE_H
@@ -16,8 +16,12 @@
 //
 
 #include "TlsSocket.h"
+#include "TlsSocketPrivate_epoll.h"
 #include "AsyncQObject.h"
 #include "TlsConfiguration.h"
+#include "TlsContext.h"
+#include "TlsCertificateStore.h"
+#include "KernelTls.h"
 #include <Tests/Resources/TlsServer.h>
 #include <Tests/Resources/TlsTestCertificates.h>
 #include <QString>
@@ -31,21 +35,34 @@
 #include <QSemaphore>
 #include <QElapsedTimer>
 #include <QtMinMax>
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 #include <memory>
 #include <cstddef>
 #include <cstdint>
 #include <fstream>
 #include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <openssl/ssl.h>
 #include <Spectator>
 
 using Kourier::TlsServer;
 using Kourier::TcpSocket;
 using Kourier::TlsSocket;
 using Kourier::TlsConfiguration;
+using Kourier::TlsContext;
+using Kourier::TlsCertificateStore;
 using Kourier::Object;
 using Kourier::AsyncQObject;
 using Spectator::SemaphoreAwaiter;
@@ -145,6 +162,7 @@ private slots:
                     return;
                 else
                 {
+                    REQUIRE(pSocket->isKernelTlsEnabled() == (m_tlsClientConfiguration.kernelTlsEnabled() && KernelTls::isAvailable()));
                     for (auto i = 0; i < m_requestsPerWorkingConnection; ++i)
                     {
                         int sum = 0;
@@ -224,6 +242,7 @@ public:
                     return;
                 else
                 {
+                    REQUIRE(pSocket->isKernelTlsEnabled() == (m_tlsServerConfiguration.kernelTlsEnabled() && KernelTls::isAvailable()));
                     for (auto i = 0; i < m_requestsPerWorkingConnection; ++i)
                     {
                         int a = 0;
@@ -304,6 +323,7 @@ using namespace TlsSocketBenchmarks;
 
 SCENARIO("TlsSocket benchmarks")
 {
+    const auto kernelTlsEnabled = GENERATE(AS(bool), false, true);
     const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
     std::string certificateFile;
     std::string privateKeyFile;
@@ -312,8 +332,12 @@ SCENARIO("TlsSocket benchmarks")
     TlsConfiguration serverTlsConfiguration;
     serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
     serverTlsConfiguration.addCaCertificate(caCertificateFile);
+    serverTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+    serverTlsConfiguration.setKernelTlsEnabled(kernelTlsEnabled);
     TlsConfiguration clientTlsConfiguration;
     clientTlsConfiguration.addCaCertificate(caCertificateFile);
+    clientTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+    clientTlsConfiguration.setKernelTlsEnabled(kernelTlsEnabled);
     static constexpr std::string_view serverHostname("ipv4-ipv6-addresses.test.local");
     static constexpr std::string_view serverAddress("127.10.20.50");
     static constexpr size_t totalConnectionsPerThread = 100;
@@ -391,6 +415,7 @@ SCENARIO("TlsSocket benchmarks")
     for (auto &client : clients)
         QMetaObject::invokeMethod(client->get(), "connectToServer", Qt::QueuedConnection);
     REQUIRE(SemaphoreAwaiter::signalSlotAwareWait(clientSocketsDisconnectedSemaphore, 10000));
+    WARN(QByteArray("Kernel TLS: ").append((kernelTlsEnabled && KernelTls::isAvailable()) ? "enabled" : "disabled"));
     WARN(QByteArray("Memory consumed after creating client sockets: ").append(QByteArray::number(memoryConsumedAfterCreatingClientSockets)));
     WARN(QByteArray("Memory consumed after connecting: ").append(QByteArray::number(memoryConsumedAfterConnecting)));
     WARN(QByteArray("Memory consumed after responses: ").append(QByteArray::number(memoryConsumedAfterResponses)));
@@ -401,6 +426,757 @@ SCENARIO("TlsSocket benchmarks")
 }
 
 
+SCENARIO("TlsSocket reconnection benchmarks")
+{
+    const auto tlsVersion = GENERATE(AS(TlsConfiguration::TlsVersion),
+                                     TlsConfiguration::TlsVersion::TLS_1_2,
+                                     TlsConfiguration::TlsVersion::TLS_1_3);
+    const auto [usesSessionCache, usesSessionTickets] = GENERATE(AS(std::pair<bool, bool>),
+                                                                 {false, false},
+                                                                 {true, false},
+                                                                 {false, true});
+    const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+    std::string certificateFile;
+    std::string privateKeyFile;
+    std::string caCertificateFile;
+    TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+    TlsConfiguration serverTlsConfiguration;
+    serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+    serverTlsConfiguration.addCaCertificate(caCertificateFile);
+    serverTlsConfiguration.setTlsVersion(tlsVersion);
+    serverTlsConfiguration.setSessionCacheSize(usesSessionCache ? 1024 : 0);
+    serverTlsConfiguration.setSessionTicketsEnabled(usesSessionTickets);
+    TlsConfiguration clientTlsConfiguration;
+    clientTlsConfiguration.addCaCertificate(caCertificateFile);
+    clientTlsConfiguration.setTlsVersion(tlsVersion);
+    clientTlsConfiguration.setSessionCacheSize((usesSessionCache || usesSessionTickets) ? 16 : 0);
+    clientTlsConfiguration.setSessionTicketsEnabled(usesSessionTickets);
+    static constexpr size_t reconnectionCount = 1000;
+    TlsServer server(serverTlsConfiguration);
+    QSemaphore serverPeerDisconnectedSemaphore;
+    std::unique_ptr<TlsSocket> pServerPeer;
+    Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+    {
+        pServerPeer.reset(pSocket);
+        Object::connect(pServerPeer.get(), &TlsSocket::encrypted, [&](){pServerPeer->disconnectFromPeer();});
+        Object::connect(pServerPeer.get(), &TlsSocket::disconnected, [&](){pServerPeer.release()->scheduleForDeletion(); serverPeerDisconnectedSemaphore.release();});
+    });
+    REQUIRE(server.listen(QHostAddress::LocalHost));
+    TlsSocket clientPeer(clientTlsConfiguration);
+    QSemaphore clientPeerDisconnectedSemaphore;
+    size_t resumedSessionCount = 0;
+    Object::connect(&clientPeer, &TlsSocket::encrypted, [&](){resumedSessionCount += clientPeer.isSessionResumed() ? 1 : 0;});
+    Object::connect(&clientPeer, &TlsSocket::disconnected, [&](){clientPeerDisconnectedSemaphore.release();});
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    for (size_t i = 0; i < reconnectionCount; ++i)
+    {
+        clientPeer.connect(server.serverAddress().toString().toStdString(), server.serverPort());
+        REQUIRE(TRY_ACQUIRE(clientPeerDisconnectedSemaphore, 10));
+        REQUIRE(TRY_ACQUIRE(serverPeerDisconnectedSemaphore, 10));
+    }
+    const double reconnectionsPerSecond = (1000.0 * reconnectionCount)/qMax<qint64>(1, elapsedTimer.elapsed());
+    WARN(QByteArray("TLS version: ").append(tlsVersion == TlsConfiguration::TlsVersion::TLS_1_2 ? "1.2" : "1.3"));
+    WARN(QByteArray("Session resumption: ").append(usesSessionCache ? "session cache" : (usesSessionTickets ? "session tickets" : "disabled")));
+    WARN(QByteArray("Resumed sessions: ").append(QByteArray::number(resumedSessionCount)));
+    WARN(QByteArray("Reconnections per second: ").append(QByteArray::number(reconnectionsPerSecond)));
+}
+
+
+namespace TlsSocketBenchmarks
+{
+
+struct TlsRecordCounter
+{
+    static inline size_t recordCount = 0;
+    static inline size_t bytesOnTheWire = 0;
+    static void reset()
+    {
+        recordCount = 0;
+        bytesOnTheWire = 0;
+    }
+    static void onMessage(int isWriting, int, int contentType, const void *pData, size_t size, SSL*, void*)
+    {
+        if (isWriting && contentType == SSL3_RT_HEADER && size == SSL3_RT_HEADER_LENGTH)
+        {
+            const auto *pHeader = static_cast<const unsigned char*>(pData);
+            ++recordCount;
+            bytesOnTheWire += SSL3_RT_HEADER_LENGTH + ((static_cast<size_t>(pHeader[3]) << 8) | pHeader[4]);
+        }
+    }
+};
+
+}
+
+
+SCENARIO("TlsSocket record coalescing benchmarks")
+{
+    const auto fragmentSize = GENERATE(AS(size_t), 16, 256, 4096);
+    const auto usesWriteBatch = GENERATE(AS(bool), false, true);
+    static constexpr size_t fragmentsPerResponse = 16;
+    static constexpr size_t responseCount = 10000;
+    const size_t responseSize = fragmentSize * fragmentsPerResponse;
+    const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+    std::string certificateFile;
+    std::string privateKeyFile;
+    std::string caCertificateFile;
+    TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+    TlsConfiguration serverTlsConfiguration;
+    serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+    serverTlsConfiguration.addCaCertificate(caCertificateFile);
+    serverTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+    serverTlsConfiguration.setSessionCacheSize(0);
+    serverTlsConfiguration.setSessionTicketsEnabled(false);
+    serverTlsConfiguration.setKernelTlsEnabled(false);
+    TlsConfiguration clientTlsConfiguration;
+    clientTlsConfiguration.addCaCertificate(caCertificateFile);
+    clientTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+    clientTlsConfiguration.setKernelTlsEnabled(false);
+    // Server sockets created on this thread share the cached context below. As kernel TLS is disabled,
+    // OpenSSL builds all records the server sends, and their headers are reported to the message callback.
+    auto *pServerContext = TlsContext::fromTlsConfiguration(serverTlsConfiguration, TlsContext::Role::Server).context();
+    SSL_CTX_set_msg_callback(pServerContext, &TlsRecordCounter::onMessage);
+    const std::string fragment(fragmentSize, 'a');
+    QObject ctxObject;
+    TlsServer server(serverTlsConfiguration);
+    QSemaphore serverPeerEncryptedSemaphore;
+    QSemaphore serverPeerDisconnectedSemaphore;
+    std::unique_ptr<TlsSocket> pServerPeer;
+    const auto writeResponse = [&]()
+    {
+        for (size_t i = 0; i < fragmentsPerResponse; ++i)
+            pServerPeer->write(fragment);
+    };
+    Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+    {
+        pServerPeer.reset(pSocket);
+        Object::connect(pServerPeer.get(), &TlsSocket::encrypted, [&](){serverPeerEncryptedSemaphore.release();});
+        Object::connect(pServerPeer.get(), &TlsSocket::receivedData, [&]()
+        {
+            if (pServerPeer->dataAvailable() < sizeof(int))
+                return;
+            pServerPeer->skip(sizeof(int));
+            // Responses are written later, as asynchronous request handlers do.
+            QMetaObject::invokeMethod(&ctxObject, [&]()
+            {
+                if (usesWriteBatch)
+                {
+                    TlsSocket::WriteBatch writeBatch(*pServerPeer);
+                    writeResponse();
+                }
+                else
+                    writeResponse();
+            }, Qt::QueuedConnection);
+        });
+        Object::connect(pServerPeer.get(), &TlsSocket::disconnected, [&](){pServerPeer.release()->scheduleForDeletion(); serverPeerDisconnectedSemaphore.release();});
+    });
+    REQUIRE(server.listen(QHostAddress::LocalHost));
+    TlsSocket clientPeer(clientTlsConfiguration);
+    QSemaphore clientPeerEncryptedSemaphore;
+    QSemaphore clientPeerReceivedResponsesSemaphore;
+    QSemaphore clientPeerDisconnectedSemaphore;
+    size_t receivedResponseCount = 0;
+    const int request = 1;
+    Object::connect(&clientPeer, &TlsSocket::encrypted, [&](){clientPeerEncryptedSemaphore.release();});
+    Object::connect(&clientPeer, &TlsSocket::receivedData, [&]()
+    {
+        while (clientPeer.dataAvailable() >= responseSize)
+        {
+            clientPeer.skip(responseSize);
+            if (++receivedResponseCount == responseCount)
+                clientPeerReceivedResponsesSemaphore.release();
+            else
+                clientPeer.write((const char*)&request, sizeof(request));
+        }
+    });
+    Object::connect(&clientPeer, &TlsSocket::disconnected, [&](){clientPeerDisconnectedSemaphore.release();});
+    clientPeer.connect(server.serverAddress().toString().toStdString(), server.serverPort());
+    REQUIRE(TRY_ACQUIRE(clientPeerEncryptedSemaphore, 10));
+    REQUIRE(TRY_ACQUIRE(serverPeerEncryptedSemaphore, 10));
+    TlsRecordCounter::reset();
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    clientPeer.write((const char*)&request, sizeof(request));
+    REQUIRE(TRY_ACQUIRE(clientPeerReceivedResponsesSemaphore, 60));
+    const double responsesPerSecond = (1000.0 * responseCount)/qMax<qint64>(1, elapsedTimer.elapsed());
+    const double recordsPerResponse = double(TlsRecordCounter::recordCount)/responseCount;
+    const double bytesOnTheWirePerResponse = double(TlsRecordCounter::bytesOnTheWire)/responseCount;
+    clientPeer.disconnectFromPeer();
+    REQUIRE(TRY_ACQUIRE(clientPeerDisconnectedSemaphore, 10));
+    REQUIRE(TRY_ACQUIRE(serverPeerDisconnectedSemaphore, 10));
+    SSL_CTX_set_msg_callback(pServerContext, nullptr);
+    WARN(QByteArray("Fragment size: ").append(QByteArray::number(fragmentSize)));
+    WARN(QByteArray("Fragments per response: ").append(QByteArray::number(fragmentsPerResponse)));
+    WARN(QByteArray("Write batch: ").append(usesWriteBatch ? "enabled" : "disabled"));
+    WARN(QByteArray("Response payload size: ").append(QByteArray::number(responseSize)));
+    WARN(QByteArray("Records per response: ").append(QByteArray::number(recordsPerResponse)));
+    WARN(QByteArray("Bytes on the wire per response: ").append(QByteArray::number(bytesOnTheWirePerResponse)));
+    WARN(QByteArray("Responses per second: ").append(QByteArray::number(responsesPerSecond)));
+}
+
+
+namespace TlsSocketBenchmarks
+{
+
+// Stands in for a network link between loopback peers. Each accepted connection is relayed to the target port in
+// segments of at most segmentSize bytes, which are paced at the link bandwidth and delivered after a one-way delay.
+class LinkEmulator
+{
+public:
+    LinkEmulator(uint16_t targetPort,
+                 std::chrono::microseconds oneWayDelay,
+                 uint64_t bitsPerSecond,
+                 size_t segmentSize = 1448) :
+        m_targetPort(targetPort),
+        m_oneWayDelay(oneWayDelay),
+        m_bitsPerSecond(bitsPerSecond),
+        m_segmentSize(segmentSize),
+        m_listeningSocket(::socket(AF_INET, SOCK_STREAM, 0))
+    {
+        REQUIRE(m_listeningSocket >= 0);
+        sockaddr_in address = loopbackAddress(0);
+        socklen_t addressSize = sizeof(address);
+        REQUIRE(::bind(m_listeningSocket, (sockaddr*)&address, addressSize) == 0);
+        REQUIRE(::listen(m_listeningSocket, 16) == 0);
+        REQUIRE(::getsockname(m_listeningSocket, (sockaddr*)&address, &addressSize) == 0);
+        m_port = ntohs(address.sin_port);
+        m_acceptingThread = std::thread([this](){acceptConnections();});
+    }
+    ~LinkEmulator()
+    {
+        ::shutdown(m_listeningSocket, SHUT_RDWR);
+        m_acceptingThread.join();
+        for (const auto socket : m_relayedSockets)
+            ::shutdown(socket, SHUT_RDWR);
+        for (auto &thread : m_relayingThreads)
+            thread.join();
+        ::close(m_listeningSocket);
+        for (const auto socket : m_relayedSockets)
+            ::close(socket);
+    }
+    uint16_t port() const {return m_port;}
+
+private:
+    struct Segment
+    {
+        std::chrono::steady_clock::time_point deliveryTime;
+        std::string data;
+    };
+    struct Direction
+    {
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<Segment> segments;
+        bool hasFinished = false;
+    };
+    static sockaddr_in loopbackAddress(uint16_t port)
+    {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        return address;
+    }
+    void acceptConnections()
+    {
+        while (true)
+        {
+            const int acceptedSocket = ::accept(m_listeningSocket, nullptr, nullptr);
+            if (acceptedSocket < 0)
+                return;
+            const int targetSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+            const auto targetAddress = loopbackAddress(m_targetPort);
+            if (targetSocket < 0 || ::connect(targetSocket, (const sockaddr*)&targetAddress, sizeof(targetAddress)) != 0)
+            {
+                ::close(acceptedSocket);
+                if (targetSocket >= 0)
+                    ::close(targetSocket);
+                continue;
+            }
+            for (const auto socket : {acceptedSocket, targetSocket})
+            {
+                const int enabled = 1;
+                ::setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+                m_relayedSockets.push_back(socket);
+            }
+            for (const auto [sourceSocket, targetSocket] : {std::pair{acceptedSocket, targetSocket}, std::pair{targetSocket, acceptedSocket}})
+            {
+                auto pDirection = std::make_shared<Direction>();
+                m_relayingThreads.emplace_back([this, pDirection, sourceSocket](){receiveSegments(*pDirection, sourceSocket);});
+                m_relayingThreads.emplace_back([this, pDirection, targetSocket](){deliverSegments(*pDirection, targetSocket);});
+            }
+        }
+    }
+    void receiveSegments(Direction &direction, int socket)
+    {
+        std::vector<char> buffer(65536);
+        auto linkFreeTime = std::chrono::steady_clock::now();
+        while (true)
+        {
+            const auto bytesReceived = ::recv(socket, buffer.data(), buffer.size(), 0);
+            const auto currentTime = std::chrono::steady_clock::now();
+            std::lock_guard lock(direction.mutex);
+            if (bytesReceived <= 0)
+            {
+                direction.hasFinished = true;
+                direction.condition.notify_one();
+                return;
+            }
+            for (size_t offset = 0; offset < size_t(bytesReceived); offset += m_segmentSize)
+            {
+                const auto segmentSize = std::min(m_segmentSize, size_t(bytesReceived) - offset);
+                const auto transmissionTime = std::chrono::nanoseconds((segmentSize * 8 * 1000000000ull) / m_bitsPerSecond);
+                linkFreeTime = std::max(linkFreeTime, currentTime) + transmissionTime;
+                direction.segments.push_back({linkFreeTime + m_oneWayDelay, std::string(buffer.data() + offset, segmentSize)});
+            }
+            direction.condition.notify_one();
+        }
+    }
+    void deliverSegments(Direction &direction, int socket)
+    {
+        while (true)
+        {
+            Segment segment;
+            {
+                std::unique_lock lock(direction.mutex);
+                direction.condition.wait(lock, [&](){return !direction.segments.empty() || direction.hasFinished;});
+                if (direction.segments.empty())
+                {
+                    ::shutdown(socket, SHUT_WR);
+                    return;
+                }
+                segment = std::move(direction.segments.front());
+                direction.segments.pop_front();
+            }
+            std::this_thread::sleep_until(segment.deliveryTime);
+            size_t bytesSent = 0;
+            while (bytesSent < segment.data.size())
+            {
+                const auto result = ::send(socket, segment.data.data() + bytesSent, segment.data.size() - bytesSent, MSG_NOSIGNAL);
+                if (result <= 0)
+                    break;
+                bytesSent += result;
+            }
+        }
+    }
+
+private:
+    const uint16_t m_targetPort;
+    const std::chrono::microseconds m_oneWayDelay;
+    const uint64_t m_bitsPerSecond;
+    const size_t m_segmentSize;
+    const int m_listeningSocket;
+    uint16_t m_port = 0;
+    std::thread m_acceptingThread;
+    std::vector<std::thread> m_relayingThreads;
+    std::vector<int> m_relayedSockets;
+};
+
+}
+
+
+SCENARIO("TlsSocket dynamic record sizing benchmarks")
+{
+    const auto dynamicRecordSizingEnabled = GENERATE(AS(bool), false, true);
+    static constexpr auto oneWayDelay = std::chrono::milliseconds(10);
+    static constexpr uint64_t linkBitsPerSecond = 50000000;
+    static constexpr size_t responseSize = 1024 * 1024;
+    static constexpr size_t connectionCount = 10;
+    const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+    std::string certificateFile;
+    std::string privateKeyFile;
+    std::string caCertificateFile;
+    TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+    TlsConfiguration serverTlsConfiguration;
+    serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+    serverTlsConfiguration.addCaCertificate(caCertificateFile);
+    serverTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+    serverTlsConfiguration.setKernelTlsEnabled(false);
+    serverTlsConfiguration.setDynamicRecordSizingEnabled(dynamicRecordSizingEnabled);
+    TlsConfiguration clientTlsConfiguration;
+    clientTlsConfiguration.addCaCertificate(caCertificateFile);
+    clientTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+    clientTlsConfiguration.setKernelTlsEnabled(false);
+    const std::string response(responseSize, 'a');
+    TlsServer server(serverTlsConfiguration);
+    QSemaphore serverPeerEncryptedSemaphore;
+    QSemaphore serverPeerDisconnectedSemaphore;
+    std::unique_ptr<TlsSocket> pServerPeer;
+    Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+    {
+        pServerPeer.reset(pSocket);
+        Object::connect(pServerPeer.get(), &TlsSocket::encrypted, [&](){serverPeerEncryptedSemaphore.release();});
+        Object::connect(pServerPeer.get(), &TlsSocket::receivedData, [&]()
+        {
+            if (pServerPeer->dataAvailable() < sizeof(int))
+                return;
+            pServerPeer->skip(sizeof(int));
+            pServerPeer->write(response);
+        });
+        Object::connect(pServerPeer.get(), &TlsSocket::disconnected, [&](){pServerPeer.release()->scheduleForDeletion(); serverPeerDisconnectedSemaphore.release();});
+    });
+    REQUIRE(server.listen(QHostAddress::LocalHost));
+    LinkEmulator link(server.serverPort(), oneWayDelay, linkBitsPerSecond);
+    TlsSocket clientPeer(clientTlsConfiguration);
+    QSemaphore clientPeerEncryptedSemaphore;
+    QSemaphore clientPeerReceivedResponseSemaphore;
+    QSemaphore clientPeerDisconnectedSemaphore;
+    QElapsedTimer elapsedTimer;
+    size_t receivedResponseSize = 0;
+    qint64 timeToFirstByte = 0;
+    qint64 timeToLastByte = 0;
+    Object::connect(&clientPeer, &TlsSocket::encrypted, [&](){clientPeerEncryptedSemaphore.release();});
+    Object::connect(&clientPeer, &TlsSocket::receivedData, [&]()
+    {
+        if (receivedResponseSize == 0)
+            timeToFirstByte = elapsedTimer.nsecsElapsed();
+        receivedResponseSize += clientPeer.skip(clientPeer.dataAvailable());
+        if (receivedResponseSize == responseSize)
+        {
+            timeToLastByte = elapsedTimer.nsecsElapsed();
+            clientPeerReceivedResponseSemaphore.release();
+        }
+    });
+    Object::connect(&clientPeer, &TlsSocket::disconnected, [&](){clientPeerDisconnectedSemaphore.release();});
+    const int request = 1;
+    double totalTimeToFirstByte = 0;
+    double totalTransferTime = 0;
+    for (size_t i = 0; i < connectionCount; ++i)
+    {
+        clientPeer.connect("127.0.0.1", link.port());
+        REQUIRE(TRY_ACQUIRE(clientPeerEncryptedSemaphore, 10));
+        REQUIRE(TRY_ACQUIRE(serverPeerEncryptedSemaphore, 10));
+        receivedResponseSize = 0;
+        elapsedTimer.start();
+        clientPeer.write((const char*)&request, sizeof(request));
+        REQUIRE(TRY_ACQUIRE(clientPeerReceivedResponseSemaphore, 30));
+        totalTimeToFirstByte += timeToFirstByte;
+        totalTransferTime += timeToLastByte - timeToFirstByte;
+        clientPeer.disconnectFromPeer();
+        REQUIRE(TRY_ACQUIRE(clientPeerDisconnectedSemaphore, 10));
+        REQUIRE(TRY_ACQUIRE(serverPeerDisconnectedSemaphore, 10));
+    }
+    const double averageTimeToFirstByteInMSecs = totalTimeToFirstByte / (connectionCount * 1e6);
+    const double bulkThroughputInMbps = (8.0 * responseSize * connectionCount) / (totalTransferTime / 1e3);
+    WARN(QByteArray("Dynamic record sizing: ").append(dynamicRecordSizingEnabled ? "enabled" : "disabled"));
+    WARN(QByteArray("Link: ").append(QByteArray::number(qint64(oneWayDelay.count()))).append(" ms one-way delay, ").append(QByteArray::number(linkBitsPerSecond / 1000000)).append(" Mbps"));
+    WARN(QByteArray("Time to first byte (ms): ").append(QByteArray::number(averageTimeToFirstByteInMSecs)));
+    WARN(QByteArray("Bulk throughput (Mbps): ").append(QByteArray::number(bulkThroughputInMbps)));
+}
+
+
+namespace TlsSocketBenchmarks
+{
+
+// Connects to a loopback server with blocking I/O on the calling thread. Returns nullptr on failure.
+static SSL *connectBlockingTlsClient(SSL_CTX *pContext, uint16_t port, int &socketDescriptor)
+{
+    socketDescriptor = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (socketDescriptor < 0)
+        return nullptr;
+    const int enabled = 1;
+    ::setsockopt(socketDescriptor, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    auto *pSSL = (::connect(socketDescriptor, (const sockaddr*)&address, sizeof(address)) == 0) ? SSL_new(pContext) : nullptr;
+    if (pSSL != nullptr)
+    {
+        SSL_set_fd(pSSL, socketDescriptor);
+        if (SSL_connect(pSSL) == 1)
+            return pSSL;
+        SSL_free(pSSL);
+    }
+    ::close(socketDescriptor);
+    socketDescriptor = -1;
+    return nullptr;
+}
+
+}
+
+
+SCENARIO("TlsSocket handshake storm benchmarks")
+{
+    const auto handshakeThreadCount = GENERATE(AS(size_t), 0, 2);
+    static constexpr size_t stormThreadCount = 4;
+    static constexpr size_t roundTripCount = 5000;
+    const auto certificateType = TlsTestCertificates::CertificateType::RSA_2048;
+    std::string certificateFile;
+    std::string privateKeyFile;
+    std::string caCertificateFile;
+    TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+    TlsConfiguration serverTlsConfiguration;
+    serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+    serverTlsConfiguration.addCaCertificate(caCertificateFile);
+    serverTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+    serverTlsConfiguration.setSessionCacheSize(0);
+    serverTlsConfiguration.setSessionTicketsEnabled(false);
+    serverTlsConfiguration.setKernelTlsEnabled(false);
+    serverTlsConfiguration.setHandshakeThreadCount(handshakeThreadCount);
+    // All server sockets live on this thread, which plays the role of a single worker. The established connection
+    // measuring round trip latency and the clients flooding the server with new connections run on their own threads.
+    TlsServer server(serverTlsConfiguration);
+    server.setListenBacklogSize(1024);
+    Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+    {
+        Object::connect(pSocket, &TlsSocket::receivedData, [pSocket](){pSocket->write(pSocket->readAll());});
+        Object::connect(pSocket, &TlsSocket::disconnected, [pSocket](){pSocket->scheduleForDeletion();});
+        Object::connect(pSocket, &TlsSocket::error, [pSocket](){pSocket->scheduleForDeletion();});
+    });
+    REQUIRE(server.listen(QHostAddress::LocalHost));
+    const auto serverPort = server.serverPort();
+    std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> pClientContext(SSL_CTX_new(TLS_client_method()), &SSL_CTX_free);
+    REQUIRE(pClientContext);
+    SSL_CTX_set_min_proto_version(pClientContext.get(), TLS1_3_VERSION);
+    SSL_CTX_set_verify(pClientContext.get(), SSL_VERIFY_NONE, nullptr);
+    std::atomic_bool isStorming = true;
+    std::atomic_size_t handshakeCount = 0;
+    QSemaphore stormThreadFinishedSemaphore;
+    std::vector<std::thread> stormThreads;
+    for (size_t i = 0; i < stormThreadCount; ++i)
+    {
+        stormThreads.emplace_back([&]()
+        {
+            while (isStorming)
+            {
+                int socketDescriptor = -1;
+                auto *pSSL = connectBlockingTlsClient(pClientContext.get(), serverPort, socketDescriptor);
+                if (pSSL == nullptr)
+                    continue;
+                ++handshakeCount;
+                SSL_free(pSSL);
+                ::close(socketDescriptor);
+            }
+            stormThreadFinishedSemaphore.release();
+        });
+    }
+    std::vector<int64_t> roundTripTimesInUSecs;
+    roundTripTimesInUSecs.reserve(roundTripCount);
+    QSemaphore roundTripsCompletedSemaphore;
+    std::thread latencyThread([&]()
+    {
+        int socketDescriptor = -1;
+        auto *pSSL = connectBlockingTlsClient(pClientContext.get(), serverPort, socketDescriptor);
+        const uint64_t request = 1;
+        for (size_t i = 0; pSSL != nullptr && i < roundTripCount; ++i)
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            if (SSL_write(pSSL, &request, sizeof(request)) != sizeof(request))
+                break;
+            uint64_t response = 0;
+            int bytesRead = 0;
+            while (bytesRead >= 0 && bytesRead < (int)sizeof(response))
+            {
+                const auto result = SSL_read(pSSL, (char*)&response + bytesRead, sizeof(response) - bytesRead);
+                bytesRead = (result > 0) ? (bytesRead + result) : -1;
+            }
+            if (bytesRead < 0)
+                break;
+            roundTripTimesInUSecs.push_back(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count());
+        }
+        if (pSSL != nullptr)
+        {
+            SSL_free(pSSL);
+            ::close(socketDescriptor);
+        }
+        roundTripsCompletedSemaphore.release();
+    });
+    QElapsedTimer elapsedTimer;
+    elapsedTimer.start();
+    REQUIRE(TRY_ACQUIRE(roundTripsCompletedSemaphore, 120));
+    const double handshakesPerSecond = (1000.0 * handshakeCount)/qMax<qint64>(1, elapsedTimer.elapsed());
+    isStorming = false;
+    // Storm threads may be waiting for handshakes this thread runs.
+    for (size_t i = 0; i < stormThreadCount; ++i)
+        REQUIRE(TRY_ACQUIRE(stormThreadFinishedSemaphore, 10));
+    latencyThread.join();
+    for (auto &stormThread : stormThreads)
+        stormThread.join();
+    REQUIRE(roundTripTimesInUSecs.size() == roundTripCount);
+    std::sort(roundTripTimesInUSecs.begin(), roundTripTimesInUSecs.end());
+    const auto percentile = [&](double p){return roundTripTimesInUSecs[std::min<size_t>(roundTripTimesInUSecs.size() - 1, p * roundTripTimesInUSecs.size())];};
+    WARN(QByteArray("Handshake threads: ").append(QByteArray::number(handshakeThreadCount)));
+    WARN(QByteArray("Handshakes per second during measurement: ").append(QByteArray::number(handshakesPerSecond)));
+    WARN(QByteArray("Established connection round trip p50 (us): ").append(QByteArray::number(percentile(0.5))));
+    WARN(QByteArray("Established connection round trip p99 (us): ").append(QByteArray::number(percentile(0.99))));
+    WARN(QByteArray("Established connection round trip max (us): ").append(QByteArray::number(roundTripTimesInUSecs.back())));
+}
+
+
+namespace TlsSocketBenchmarks
+{
+
+// Establishes connectionCount loopback connections to the listening socket. Client descriptors are kept open
+// so that accepted descriptors remain connected. Returns false on failure.
+static bool acceptLoopbackConnections(int listeningSocketDescriptor,
+                                      uint16_t port,
+                                      size_t connectionCount,
+                                      std::vector<int> &clientSocketDescriptors,
+                                      std::vector<int> &serverSocketDescriptors)
+{
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (size_t i = 0; i < connectionCount; ++i)
+    {
+        const auto clientSocketDescriptor = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (clientSocketDescriptor < 0)
+            return false;
+        clientSocketDescriptors.push_back(clientSocketDescriptor);
+        if (::connect(clientSocketDescriptor, (const sockaddr*)&address, sizeof(address)) != 0)
+            return false;
+        const auto serverSocketDescriptor = ::accept(listeningSocketDescriptor, nullptr, nullptr);
+        if (serverSocketDescriptor < 0)
+            return false;
+        serverSocketDescriptors.push_back(serverSocketDescriptor);
+    }
+    return true;
+}
+
+}
+
+
+SCENARIO("TlsSocket accept path benchmarks")
+{
+    const auto otherCachedConfigurationCount = GENERATE(AS(size_t), 0, 16);
+    static constexpr size_t connectionsPerBatch = 256;
+    static constexpr size_t batchCount = 40;
+    const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+    std::string certificateFile;
+    std::string privateKeyFile;
+    std::string caCertificateFile;
+    TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+    TlsConfiguration serverTlsConfiguration;
+    serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+    serverTlsConfiguration.addCaCertificate(caCertificateFile);
+    serverTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+    // This is what an HttpServer worker does once when it starts.
+    const auto serverTlsContext = TlsContext::fromTlsConfiguration(serverTlsConfiguration, TlsContext::Role::Server);
+    // Contexts created afterwards are placed ahead of the server's one in the thread's context cache, as happens
+    // when a worker thread also runs clients or other servers. They differ from the server's configuration only
+    // in their last compared fields, which is the worst case for the configuration-based lookup.
+    for (size_t i = 0; i < otherCachedConfigurationCount; ++i)
+    {
+        auto otherTlsConfiguration = serverTlsConfiguration;
+        otherTlsConfiguration.setHandshakeThreadCount(i + 1);
+        TlsContext::fromTlsConfiguration(otherTlsConfiguration, TlsContext::Role::Server);
+    }
+    const auto listeningSocketDescriptor = ::socket(AF_INET, SOCK_STREAM, 0);
+    REQUIRE(listeningSocketDescriptor >= 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = 0;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressLength = sizeof(address);
+    REQUIRE(::bind(listeningSocketDescriptor, (const sockaddr*)&address, sizeof(address)) == 0);
+    REQUIRE(::listen(listeningSocketDescriptor, connectionsPerBatch) == 0);
+    REQUIRE(::getsockname(listeningSocketDescriptor, (sockaddr*)&address, &addressLength) == 0);
+    const uint16_t port = ntohs(address.sin_port);
+    std::chrono::nanoseconds configurationBasedTime(0);
+    std::chrono::nanoseconds contextBasedTime(0);
+    std::vector<int> clientSocketDescriptors;
+    std::vector<int> serverSocketDescriptors;
+    std::vector<TlsSocket*> sockets;
+    clientSocketDescriptors.reserve(connectionsPerBatch);
+    serverSocketDescriptors.reserve(connectionsPerBatch);
+    sockets.reserve(connectionsPerBatch);
+    // Batches alternate between both paths so that both see the same system conditions.
+    for (size_t batch = 0; batch < (2 * batchCount); ++batch)
+    {
+        const bool usesTlsContext = (batch % 2) == 1;
+        clientSocketDescriptors.clear();
+        serverSocketDescriptors.clear();
+        sockets.clear();
+        const bool hasAcceptedConnections = acceptLoopbackConnections(listeningSocketDescriptor, port, connectionsPerBatch, clientSocketDescriptors, serverSocketDescriptors);
+        if (hasAcceptedConnections)
+        {
+            const auto startTime = std::chrono::steady_clock::now();
+            for (const auto socketDescriptor : serverSocketDescriptors)
+            {
+                if (usesTlsContext)
+                    sockets.push_back(TlsSocketPrivate::createServerSocket(socketDescriptor, serverTlsContext));
+                else
+                    sockets.push_back(new TlsSocket(socketDescriptor, serverTlsConfiguration));
+            }
+            (usesTlsContext ? contextBasedTime : configurationBasedTime) += std::chrono::steady_clock::now() - startTime;
+            serverSocketDescriptors.clear();
+        }
+        bool areSocketsConnected = true;
+        for (auto *pSocket : sockets)
+        {
+            areSocketsConnected = areSocketsConnected && (pSocket->state() == TcpSocket::State::Connected);
+            delete pSocket;
+        }
+        for (const auto socketDescriptor : serverSocketDescriptors)
+            ::close(socketDescriptor);
+        for (const auto socketDescriptor : clientSocketDescriptors)
+            ::close(socketDescriptor);
+        REQUIRE(hasAcceptedConnections);
+        REQUIRE(areSocketsConnected);
+    }
+    ::close(listeningSocketDescriptor);
+    const double socketCount = connectionsPerBatch * batchCount;
+    const double configurationBasedNSecsPerSocket = configurationBasedTime.count() / socketCount;
+    const double contextBasedNSecsPerSocket = contextBasedTime.count() / socketCount;
+    WARN(QByteArray("Other cached TLS configurations: ").append(QByteArray::number(otherCachedConfigurationCount)));
+    WARN(QByteArray("Socket creation from TLS configuration (ns): ").append(QByteArray::number(configurationBasedNSecsPerSocket)));
+    WARN(QByteArray("Socket creation from precomputed TLS context (ns): ").append(QByteArray::number(contextBasedNSecsPerSocket)));
+    WARN(QByteArray("Saving per accepted connection (ns): ").append(QByteArray::number(configurationBasedNSecsPerSocket - contextBasedNSecsPerSocket)));
+}
+
+
+SCENARIO("TlsCertificateStore lookup benchmarks")
+{
+    const auto certificateCount = GENERATE(AS(size_t), 16, 256, 4096);
+    static constexpr size_t lookupCount = 1000000;
+    std::string certificateFile;
+    std::string privateKeyFile;
+    std::string caCertificateFile;
+    TlsTestCertificates::getFilesFromCertificateType(TlsTestCertificates::CertificateType::ECDSA, certificateFile, privateKeyFile, caCertificateFile);
+    // Half of the certificates are set for host names and the other half for wildcards.
+    TlsCertificateStore certificateStore;
+    for (size_t i = 0; i < certificateCount; ++i)
+    {
+        const auto serverName = (i % 2 == 0)
+                                    ? std::string("host").append(std::to_string(i)).append(".test.local")
+                                    : std::string("*.tenant").append(std::to_string(i)).append(".test.local");
+        certificateStore.setCertificateKeyPair(serverName, certificateFile, privateKeyFile);
+    }
+    REQUIRE(certificateStore.size() == certificateCount);
+    std::vector<std::string> exactServerNames;
+    std::vector<std::string> wildcardServerNames;
+    std::vector<std::string> unknownServerNames;
+    for (size_t i = 0; i < certificateCount; i += 2)
+    {
+        exactServerNames.push_back(std::string("host").append(std::to_string(i)).append(".test.local"));
+        wildcardServerNames.push_back(std::string("www.tenant").append(std::to_string(i + 1)).append(".test.local"));
+        unknownServerNames.push_back(std::string("unknown").append(std::to_string(i)).append(".test.local"));
+    }
+    const auto nanosecondsPerLookup = [&](const std::vector<std::string> &serverNames, bool isExpectedToMatch) -> double
+    {
+        size_t matchCount = 0;
+        const auto startTime = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < lookupCount; ++i)
+        {
+            if (certificateStore.find(serverNames[i % serverNames.size()]))
+                ++matchCount;
+        }
+        const auto elapsedTime = std::chrono::steady_clock::now() - startTime;
+        REQUIRE(matchCount == (isExpectedToMatch ? lookupCount : 0));
+        return std::chrono::duration<double, std::nano>(elapsedTime).count() / lookupCount;
+    };
+    const auto exactLookupTime = nanosecondsPerLookup(exactServerNames, true);
+    const auto wildcardLookupTime = nanosecondsPerLookup(wildcardServerNames, true);
+    const auto unknownLookupTime = nanosecondsPerLookup(unknownServerNames, false);
+    WARN(QByteArray("Certificates in store: ").append(QByteArray::number(certificateCount)));
+    WARN(QByteArray("Host name lookup (ns): ").append(QByteArray::number(exactLookupTime)));
+    WARN(QByteArray("Wildcard lookup (ns): ").append(QByteArray::number(wildcardLookupTime)));
+    WARN(QByteArray("Unknown server name lookup (ns): ").append(QByteArray::number(unknownLookupTime)));
+}
+
+
 namespace TlsSocketBenchmarks
 {
 
@@ -142,6 +142,18 @@ to channel before starting disconnecting from peer.
  Returns true if TlsSocket has setup TLS encryption and can encrypt and decrypt data.
 */
 
+/*!
+ \fn TlsSocket::isSessionResumed()
+ Returns true if TlsSocket completed the TLS handshake by resuming a previously established session. Sessions are only
+ resumed if enabled in the TLS configuration. See TlsConfiguration::setSessionCacheSize and TlsConfiguration::setSessionTicketsEnabled.
+*/
+
+/*!
+ \fn TlsSocket::isKernelTlsEnabled()
+ Returns true if the kernel encrypts and decrypts the data TlsSocket exchanges with its peer. TlsSocket only offloads
+ the record layer to the kernel if enabled in the \link TlsConfiguration::setKernelTlsEnabled TLS configuration\endlink.
+*/
+
 /*!
  \fn TlsSocket::tlsConfiguration()
 Returns the [tlsConfiguration](@ref Kourier::TlsConfiguration) given in the TlsSocket constructor, which will be
@@ -26,6 +26,7 @@ namespace Kourier
 {
 
 class TlsSocketPrivate;
+class TlsContext;
 
 class KOURIER_EXPORT TlsSocket : public TcpSocket
 {
@@ -35,15 +36,20 @@ public:
     TlsSocket(int64_t socketDescriptor, const TlsConfiguration &tlsConfiguration);
     ~TlsSocket() override;
     bool isEncrypted() const;
+    bool isSessionResumed() const;
+    bool isKernelTlsEnabled() const;
     size_t dataToWrite() const override;
     size_t read(char *pBuffer, size_t maxSize) override;
     std::string_view readAll() override;
     size_t skip(size_t maxSize) override;
+    size_t writev(const std::string_view *pSlices, size_t count) override;
     const TlsConfiguration &tlsConfiguration() const;
     void setTlsHandshakeTimeout(std::chrono::milliseconds timeout);
     Signal encrypted();
 
 private:
+    TlsSocket(int64_t socketDescriptor, const TlsContext &tlsContext);
+    void adoptSocketDescriptor(int64_t socketDescriptor);
     // From IOChannel
     size_t readDataFromChannel() override;
     size_t writeDataToChannel() override;
@@ -51,6 +57,7 @@ private:
 private:
     Q_DECLARE_PRIVATE(TlsSocket)
     Q_DISABLE_COPY_MOVE(TlsSocket)
+    friend class TlsSocketPrivate;
 };
 
 }
@@ -18,6 +18,10 @@
 #include "TlsSocket.h"
 #include <Spectator>
 #include "Core/TlsConfiguration.h"
+#include "Core/TlsContext.h"
+#include "Core/TlsSocketPrivate_epoll.h"
+#include "Core/KernelTls.h"
+#include "Core/UnixUtils.h"
 #include <Tests/Resources/TcpServer.h>
 #include <Tests/Resources/TlsServer.h>
 #include <Tests/Resources/TlsTestCertificates.h>
@@ -27,16 +31,36 @@
 #include <QSemaphore>
 #include <QElapsedTimer>
 #include <QCoreApplication>
+#include <QTemporaryFile>
+#include <QTcpServer>
+#include <QMutex>
 #include <chrono>
+#include <functional>
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <netinet/in.h>
 #include <sys/socket.h>
 #include <sys/mman.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
 
 using Kourier::TcpServer;
 using Kourier::TlsServer;
 using Kourier::TcpSocket;
 using Kourier::TlsSocket;
 using Kourier::TlsConfiguration;
+using Kourier::TlsContext;
+using Kourier::TlsSocketPrivate;
+using Kourier::KernelTls;
+using Kourier::UnixUtils;
 using Kourier::Object;
 using Kourier::TestResources::TlsTestCertificateInfo;
 using Kourier::TestResources::TlsTestCertificates;
@@ -1139,7 +1163,7 @@ SCENARIO("TlsSocket fails as expected")
         serverTlsConfiguration.addCaCertificate(serverCaCertificateFile);
         TlsServer server(serverTlsConfiguration);
         QSemaphore serverPeerConnectedSemaphore;
-        QSemaphore serverPeerDisconnectedSemaphore;
+        QSemaphore serverPeerFailedSemaphore;
         std::unique_ptr<TlsSocket> pServerPeer;
         Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pNewSocket)
         {
@@ -1147,8 +1171,8 @@ SCENARIO("TlsSocket fails as expected")
             pServerPeer.reset(pNewSocket);
             Object::connect(pServerPeer.get(), &TlsSocket::connected, []() {Spectator::FAIL("This code is supposed to be unreachable.");});
             Object::connect(pServerPeer.get(), &TlsSocket::encrypted, []() {Spectator::FAIL("This code is supposed to be unreachable.");});
-            Object::connect(pServerPeer.get(), &TlsSocket::error, []() {Spectator::FAIL("This code is supposed to be unreachable.");});
-            Object::connect(pServerPeer.get(), &TlsSocket::disconnected, [&]() {serverPeerDisconnectedSemaphore.release();});
+            Object::connect(pServerPeer.get(), &TlsSocket::error, [&]() {serverPeerFailedSemaphore.release();});
+            Object::connect(pServerPeer.get(), &TlsSocket::disconnected, []() {Spectator::FAIL("This code is supposed to be unreachable.");});
             Object::connect(pServerPeer.get(), &TlsSocket::receivedData, []() {Spectator::FAIL("This code is supposed to be unreachable.");});
             serverPeerConnectedSemaphore.release();
         });
@@ -1161,12 +1185,14 @@ SCENARIO("TlsSocket fails as expected")
         {
             clientPeer.connect(hostName, server.serverPort());
 
-            THEN("peers establish a TCP connection; server peer sends to client an untrusted certificate; client aborts the connection and disconnects the server peer")
+            THEN("peers establish a TCP connection; server peer sends to client an untrusted certificate; client sends an alert to server peer and aborts the connection; server peer fails with the alert")
             {
                 REQUIRE(TRY_ACQUIRE(clientPeerConnectedSemaphore, 10));
                 REQUIRE(TRY_ACQUIRE(serverPeerConnectedSemaphore, 10));
                 REQUIRE(TRY_ACQUIRE(clientPeerFailedSemaphore, 10));
-                REQUIRE(TRY_ACQUIRE(serverPeerDisconnectedSemaphore, 10));
+                REQUIRE(TRY_ACQUIRE(serverPeerFailedSemaphore, 10));
+                REQUIRE(pServerPeer->errorMessage().starts_with("TLS handshake failed. TLS error at SSL routines."));
+                REQUIRE(pServerPeer->errorMessage().find("alert") != std::string::npos);
             }
         }
     }
@@ -1251,15 +1277,16 @@ SCENARIO("TlsSocket fails as expected")
             });
             pClientPeer->connect(hostName, server.serverPort());
 
-            THEN("peers establish TCP connection; client peer verifies server and completes its handshake after sending an untrusted certificate to server peer; server peer fails to complete TLS handshake and aborts the connection disconnecting the client peer")
+            THEN("peers establish TCP connection; client peer verifies server and completes its handshake after sending an untrusted certificate to server peer; server peer fails to complete TLS handshake, sends an alert to client peer and aborts the connection; client peer fails with the alert")
             {
                 REQUIRE(TRY_ACQUIRE(clientPeerConnectedSemaphore, 10));
                 REQUIRE(TRY_ACQUIRE(serverPeerConnectedSemaphore, 10));
                 REQUIRE(TRY_ACQUIRE(clientPeerCompletedHandshakeSemaphore, 10));
                 REQUIRE(TRY_ACQUIRE(serverPeerFailedSemaphore, 10));
                 REQUIRE(!pServerPeer->errorMessage().empty());
-                REQUIRE(TRY_ACQUIRE(clientPeerDisconnectedSemaphore, 10));
-                REQUIRE(pClientPeer->errorMessage().empty());
+                REQUIRE(TRY_ACQUIRE(clientPeerFailedSemaphore, 10));
+                REQUIRE(pClientPeer->errorMessage().starts_with("Failed to decrypt data. TLS error at SSL routines."));
+                REQUIRE(pClientPeer->errorMessage().find("alert") != std::string::npos);
             }
         }
     }
@@ -1341,15 +1368,16 @@ SCENARIO("TlsSocket fails as expected")
         {
             pClientPeer->connect(hostName, server.serverPort());
 
-            THEN("peers establish TCP connection; client peer completes it's TLS handshake; server peer's TLS handshake times out; server peer aborts the connection disconnecting the client peer")
+            THEN("peers establish TCP connection; client peer completes it's TLS handshake; server peer fails to complete TLS handshake, sends an alert to client peer and aborts the connection; client peer fails with the alert")
             {
                 REQUIRE(TRY_ACQUIRE(clientPeerConnectedSemaphore, 10));
                 REQUIRE(TRY_ACQUIRE(serverPeerConnectedSemaphore, 10));
                 REQUIRE(TRY_ACQUIRE(clientPeerCompletedHandshakeSemaphore, 10));
                 REQUIRE(TRY_ACQUIRE(serverPeerFailedSemaphore, 10));
                 REQUIRE(!pServerPeer->errorMessage().empty());
-                REQUIRE(TRY_ACQUIRE(clientPeerDisconnectedSemaphore, 10));
-                REQUIRE(pClientPeer->errorMessage().empty());
+                REQUIRE(TRY_ACQUIRE(clientPeerFailedSemaphore, 10));
+                REQUIRE(pClientPeer->errorMessage().starts_with("Failed to decrypt data. TLS error at SSL routines."));
+                REQUIRE(pClientPeer->errorMessage().find("alert") != std::string::npos);
             }
         }
     }
@@ -2362,3 +2390,1180 @@ SCENARIO("TlsSockets can be reused")
         }
     }
 }
+
+
+SCENARIO("TlsSockets resume TLS sessions")
+{
+    GIVEN("A running server that resumes sessions and whose sockets close the connections just after the TLS handshake completes")
+    {
+        const auto tlsVersion = GENERATE(AS(TlsConfiguration::TlsVersion),
+                                         TlsConfiguration::TlsVersion::TLS_1_2,
+                                         TlsConfiguration::TlsVersion::TLS_1_3);
+        const auto [usesSessionCache, usesSessionTickets] = GENERATE(AS(std::pair<bool, bool>),
+                                                                     {true, false},
+                                                                     {false, true},
+                                                                     {true, true});
+        const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.addCaCertificate(caCertificateFile);
+        serverTlsConfiguration.setTlsVersion(tlsVersion);
+        serverTlsConfiguration.setSessionCacheSize(usesSessionCache ? 64 : 0);
+        serverTlsConfiguration.setSessionTicketsEnabled(usesSessionTickets);
+        TlsServer server(serverTlsConfiguration);
+        TlsConfiguration clientTlsConfiguration;
+        clientTlsConfiguration.addCaCertificate(caCertificateFile);
+        clientTlsConfiguration.setTlsVersion(tlsVersion);
+        clientTlsConfiguration.setSessionCacheSize(16);
+        clientTlsConfiguration.setSessionTicketsEnabled(true);
+        QSemaphore serverPeerCompletedHandshakeSemaphore;
+        QSemaphore serverPeerDisconnectedSemaphore;
+        QList<bool> serverPeerResumedSessions;
+        std::unique_ptr<TlsSocket> pServerPeer;
+        Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+        {
+            REQUIRE(!pServerPeer);
+            pServerPeer.reset(pSocket);
+            Object::connect(pServerPeer.get(), &TlsSocket::encrypted, [&]()
+            {
+                serverPeerResumedSessions.append(pServerPeer->isSessionResumed());
+                pServerPeer->disconnectFromPeer();
+                serverPeerCompletedHandshakeSemaphore.release();
+            });
+            Object::connect(pServerPeer.get(), &TlsSocket::disconnected, [&](){pServerPeer.release()->scheduleForDeletion(); serverPeerDisconnectedSemaphore.release();});
+        });
+        REQUIRE(server.listen(QHostAddress::LocalHost));
+
+        WHEN("client peer connects to server three times")
+        {
+            TlsSocket clientPeer(clientTlsConfiguration);
+            QSemaphore clientPeerCompletedHandshakeSemaphore;
+            QSemaphore clientPeerDisconnectedSemaphore;
+            QList<bool> clientPeerResumedSessions;
+            Object::connect(&clientPeer, &TlsSocket::encrypted, [&]()
+            {
+                clientPeerResumedSessions.append(clientPeer.isSessionResumed());
+                clientPeerCompletedHandshakeSemaphore.release();
+            });
+            Object::connect(&clientPeer, &TlsSocket::disconnected, [&](){clientPeerDisconnectedSemaphore.release();});
+            for (auto i = 0; i < 3; ++i)
+            {
+                clientPeer.connect(server.serverAddress().toString().toStdString(), server.serverPort());
+                REQUIRE(TRY_ACQUIRE(clientPeerCompletedHandshakeSemaphore, 10));
+                REQUIRE(TRY_ACQUIRE(serverPeerCompletedHandshakeSemaphore, 10));
+                REQUIRE(TRY_ACQUIRE(clientPeerDisconnectedSemaphore, 10));
+                REQUIRE(TRY_ACQUIRE(serverPeerDisconnectedSemaphore, 10));
+            }
+
+            THEN("only the first connection performs a full handshake")
+            {
+                REQUIRE(clientPeerResumedSessions == QList<bool>({false, true, true}));
+                REQUIRE(serverPeerResumedSessions == QList<bool>({false, true, true}));
+            }
+        }
+    }
+}
+
+
+namespace TlsSocketTests
+{
+// Blocking client driven directly by OpenSSL, so that tests control the alerts TlsSockets receive and
+// see the records TlsSockets send. Received data goes through a memory BIO and can be corrupted before
+// OpenSSL decrypts it. Records are tracked on the client's own SSL object, leaving server contexts untouched.
+class OpenSslClient
+{
+public:
+    explicit OpenSslClient(const std::string &caCertificateFile, int tlsVersion = TLS1_3_VERSION) :
+        m_pContext(SSL_CTX_new(TLS_client_method()), &SSL_CTX_free)
+    {
+        SSL_CTX_set_min_proto_version(m_pContext.get(), tlsVersion);
+        SSL_CTX_set_max_proto_version(m_pContext.get(), tlsVersion);
+        SSL_CTX_load_verify_locations(m_pContext.get(), caCertificateFile.c_str(), nullptr);
+        SSL_CTX_set_verify(m_pContext.get(), SSL_VERIFY_PEER, nullptr);
+    }
+    ~OpenSslClient()
+    {
+        m_pSSL.reset();
+        if (m_socketDescriptor >= 0)
+            ::close(m_socketDescriptor);
+    }
+    bool connect(uint16_t port)
+    {
+        m_socketDescriptor = ::socket(AF_INET, SOCK_STREAM, 0);
+        const timeval timeout = {10, 0};
+        ::setsockopt(m_socketDescriptor, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(m_socketDescriptor, (sockaddr*)&address, sizeof(address)) != 0)
+            return false;
+        m_pSSL.reset(SSL_new(m_pContext.get()));
+        SSL_set_msg_callback(m_pSSL.get(), &OpenSslClient::onMessage);
+        SSL_set_msg_callback_arg(m_pSSL.get(), this);
+        SSL_set_bio(m_pSSL.get(), BIO_new(BIO_s_mem()), BIO_new_socket(m_socketDescriptor, BIO_NOCLOSE));
+        return run([this](){return SSL_connect(m_pSSL.get());}) == 1;
+    }
+    std::string read(size_t size)
+    {
+        std::string data;
+        char buffer[16384];
+        while (data.size() < size)
+        {
+            const auto bytesRead = run([&](){return SSL_read(m_pSSL.get(), buffer, sizeof(buffer));});
+            if (bytesRead <= 0)
+                break;
+            data.append(buffer, bytesRead);
+        }
+        return data;
+    }
+    bool write(std::string_view data) {return run([&](){return SSL_write(m_pSSL.get(), data.data(), data.size());}) == int(data.size());}
+    void shutdown() {SSL_shutdown(m_pSSL.get());}
+    void corruptNextReceivedData() {m_corruptsNextReceivedData = true;}
+    int lastError() const {return m_lastError;}
+    unsigned long lastErrorCode() const {return m_lastErrorCode;}
+    // Sizes of the application data records received, including the record overhead. TLS 1.3 records
+    // all look like application data on the wire, so only TLS 1.2 sizes tell data records apart.
+    const std::vector<size_t> &receivedApplicationDataRecordSizes() const {return m_receivedApplicationDataRecordSizes;}
+
+private:
+    static void onMessage(int isWriting, int, int contentType, const void *pData, size_t size, SSL*, void *pArgument)
+    {
+        if (!isWriting && contentType == SSL3_RT_HEADER && size == SSL3_RT_HEADER_LENGTH)
+        {
+            const auto *pHeader = static_cast<const unsigned char*>(pData);
+            if (pHeader[0] == SSL3_RT_APPLICATION_DATA)
+                static_cast<OpenSslClient*>(pArgument)->m_receivedApplicationDataRecordSizes.push_back((static_cast<size_t>(pHeader[3]) << 8) | pHeader[4]);
+        }
+    }
+    template <typename T>
+    int run(T function)
+    {
+        while (true)
+        {
+            const auto result = function();
+            m_lastError = (result > 0) ? SSL_ERROR_NONE : SSL_get_error(m_pSSL.get(), result);
+            if (m_lastError != SSL_ERROR_WANT_READ)
+            {
+                m_lastErrorCode = (m_lastError == SSL_ERROR_SSL) ? ERR_peek_error() : 0;
+                ERR_clear_error();
+                return result;
+            }
+            char buffer[16384];
+            const auto receivedSize = ::recv(m_socketDescriptor, buffer, sizeof(buffer), 0);
+            if (receivedSize <= 0)
+                return result;
+            if (std::exchange(m_corruptsNextReceivedData, false))
+                buffer[receivedSize - 1] ^= 1;
+            BIO_write(SSL_get_rbio(m_pSSL.get()), buffer, receivedSize);
+        }
+    }
+
+private:
+    std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> m_pContext;
+    std::unique_ptr<SSL, decltype(&SSL_free)> m_pSSL = {nullptr, &SSL_free};
+    int m_socketDescriptor = -1;
+    int m_lastError = SSL_ERROR_NONE;
+    unsigned long m_lastErrorCode = 0;
+    bool m_corruptsNextReceivedData = false;
+    std::vector<size_t> m_receivedApplicationDataRecordSizes;
+};
+}
+
+
+SCENARIO("TlsSocket gathers written slices into full-size records")
+{
+    GIVEN("a TLS 1.2 server whose sockets write slices of varied sizes adding up to whole records to connected clients")
+    {
+        static constexpr size_t recordDataSize = 16384;
+        static constexpr size_t dataSize = 1024 * recordDataSize;
+        // Records carry their data plus the explicit nonce, tag or padding of TLS 1.2 ciphers.
+        static constexpr size_t maxRecordOverhead = 64;
+        std::string data;
+        data.reserve(dataSize);
+        for (size_t i = 0; i < dataSize; ++i)
+            data.push_back('a' + ((i * 7) % 26));
+        static constexpr size_t sliceSizes[] = {1, 700, 16384, 40000, 3, 16383, 100000, 5, 65536, 1369};
+        std::vector<std::string_view> slices;
+        for (size_t offset = 0, i = 0; offset < dataSize; ++i)
+        {
+            const auto sliceSize = std::min(sliceSizes[i % std::size(sliceSizes)], dataSize - offset);
+            slices.emplace_back(data.data() + offset, sliceSize);
+            offset += sliceSize;
+        }
+        const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.addCaCertificate(caCertificateFile);
+        serverTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_2);
+        TlsServer server(serverTlsConfiguration);
+        std::unique_ptr<TlsSocket> pServerPeer;
+        QSemaphore serverPeerPartiallySentDataSemaphore;
+        Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+        {
+            REQUIRE(!pServerPeer);
+            pServerPeer.reset(pSocket);
+            Object::connect(pServerPeer.get(), &TlsSocket::encrypted, [&](){REQUIRE(pServerPeer->writev(slices.data(), slices.size()) == dataSize);});
+            Object::connect(pServerPeer.get(), &TlsSocket::sentData, [&]()
+            {
+                if (pServerPeer->dataToWrite() > 0)
+                    serverPeerPartiallySentDataSemaphore.release();
+            });
+            Object::connect(pServerPeer.get(), &TlsSocket::disconnected, [&](){pServerPeer.release()->scheduleForDeletion();});
+        });
+        REQUIRE(server.listen(QHostAddress::LocalHost));
+        const auto serverPort = server.serverPort();
+
+        WHEN("client only starts reading after server peer fills the connection and has data left to send")
+        {
+            bool clientConnected = false;
+            std::string clientReceivedData;
+            std::vector<size_t> clientReceivedRecordSizes;
+            QSemaphore clientCanReadSemaphore;
+            QSemaphore clientReceivedDataSemaphore;
+            std::thread clientThread([&]()
+            {
+                OpenSslClient client(caCertificateFile, TLS1_2_VERSION);
+                clientConnected = client.connect(serverPort);
+                clientCanReadSemaphore.tryAcquire(1, 10000);
+                clientReceivedData = client.read(dataSize);
+                clientReceivedRecordSizes = client.receivedApplicationDataRecordSizes();
+                clientReceivedDataSemaphore.release();
+            });
+            const bool serverPeerPartiallySentData = TRY_ACQUIRE(serverPeerPartiallySentDataSemaphore, 10);
+            clientCanReadSemaphore.release();
+            const bool clientReceivedAllData = TRY_ACQUIRE(clientReceivedDataSemaphore, 10);
+            clientThread.join();
+
+            THEN("client receives the data written across several writes to the socket in records that are all full-size")
+            {
+                REQUIRE(serverPeerPartiallySentData);
+                REQUIRE(clientReceivedAllData);
+                REQUIRE(clientConnected);
+                REQUIRE(clientReceivedData == data);
+                REQUIRE(clientReceivedRecordSizes.size() == dataSize / recordDataSize);
+                REQUIRE(std::all_of(clientReceivedRecordSizes.cbegin(), clientReceivedRecordSizes.cend(), [](size_t size)
+                {
+                    return size > recordDataSize && size <= recordDataSize + maxRecordOverhead;
+                }));
+            }
+        }
+    }
+}
+
+
+SCENARIO("TlsSocket sizes records dynamically if enabled in TLS configuration")
+{
+    GIVEN("a TLS 1.2 server whose sockets send a large response to connected clients and whenever they receive data")
+    {
+        const auto dynamicRecordSizingEnabled = GENERATE(AS(bool), true, false);
+        static constexpr size_t responseSize = 256 * 1024;
+        // Small records carry 1369 bytes of data plus the explicit nonce and tag of TLS 1.2 AEAD ciphers.
+        static constexpr size_t maxSmallRecordSize = 1369 + 64;
+        static constexpr size_t smallRecordCount = (128 * 1024) / 1369;
+        const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.addCaCertificate(caCertificateFile);
+        serverTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_2);
+        serverTlsConfiguration.setDynamicRecordSizingEnabled(dynamicRecordSizingEnabled);
+        TlsServer server(serverTlsConfiguration);
+        const std::string response(responseSize, 'a');
+        std::unique_ptr<TlsSocket> pServerPeer;
+        Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+        {
+            REQUIRE(!pServerPeer);
+            pServerPeer.reset(pSocket);
+            Object::connect(pServerPeer.get(), &TlsSocket::encrypted, [&](){pServerPeer->write(response);});
+            Object::connect(pServerPeer.get(), &TlsSocket::receivedData, [&](){pServerPeer->skip(pServerPeer->dataAvailable()); pServerPeer->write(response);});
+            Object::connect(pServerPeer.get(), &TlsSocket::disconnected, [&](){pServerPeer.release()->scheduleForDeletion();});
+        });
+        REQUIRE(server.listen(QHostAddress::LocalHost));
+        const auto serverPort = server.serverPort();
+        const auto isSmallRecord = [](size_t size){return size <= maxSmallRecordSize;};
+        bool clientConnected = false;
+        std::string clientReceivedData;
+        std::vector<size_t> recordSizes;
+        QSemaphore clientFinishedSemaphore;
+
+        WHEN("client connects to server and receives the response")
+        {
+            std::thread clientThread([&]()
+            {
+                OpenSslClient client(caCertificateFile, TLS1_2_VERSION);
+                clientConnected = client.connect(serverPort);
+                clientReceivedData = client.read(responseSize);
+                recordSizes = client.receivedApplicationDataRecordSizes();
+                clientFinishedSemaphore.release();
+            });
+            const bool clientFinished = TRY_ACQUIRE(clientFinishedSemaphore, 10);
+            clientThread.join();
+
+            THEN("server peer sends the first 128 KiB in small records and the remaining data in large records if dynamic record sizing is enabled")
+            {
+                REQUIRE(clientFinished);
+                REQUIRE(clientConnected);
+                REQUIRE(clientReceivedData == response);
+                REQUIRE(!recordSizes.empty());
+                if (dynamicRecordSizingEnabled)
+                {
+                    REQUIRE(recordSizes.size() > smallRecordCount);
+                    REQUIRE(std::all_of(recordSizes.cbegin(), recordSizes.cbegin() + smallRecordCount, isSmallRecord));
+                    REQUIRE(!isSmallRecord(recordSizes.back()));
+                }
+                else
+                    REQUIRE(std::none_of(recordSizes.cbegin(), recordSizes.cend(), isSmallRecord));
+            }
+        }
+
+        WHEN("client receives the response, stays idle for longer than one second and then asks for another response")
+        {
+            size_t firstResponseRecordCount = 0;
+            std::thread clientThread([&]()
+            {
+                OpenSslClient client(caCertificateFile, TLS1_2_VERSION);
+                clientConnected = client.connect(serverPort);
+                clientReceivedData = client.read(responseSize);
+                firstResponseRecordCount = client.receivedApplicationDataRecordSizes().size();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1200));
+                if (client.write("a"))
+                    clientReceivedData.append(client.read(responseSize));
+                recordSizes = client.receivedApplicationDataRecordSizes();
+                clientFinishedSemaphore.release();
+            });
+            const bool clientFinished = TRY_ACQUIRE(clientFinishedSemaphore, 10);
+            clientThread.join();
+
+            THEN("server peer goes back to small records for the second response if dynamic record sizing is enabled")
+            {
+                REQUIRE(clientFinished);
+                REQUIRE(clientConnected);
+                REQUIRE(clientReceivedData == response + response);
+                REQUIRE(firstResponseRecordCount > 0);
+                REQUIRE(recordSizes.size() > firstResponseRecordCount);
+                const auto secondResponseRecordSizesBegin = recordSizes.cbegin() + firstResponseRecordCount;
+                if (dynamicRecordSizingEnabled)
+                {
+                    REQUIRE(std::size_t(recordSizes.cend() - secondResponseRecordSizesBegin) > smallRecordCount);
+                    REQUIRE(std::all_of(secondResponseRecordSizesBegin, secondResponseRecordSizesBegin + smallRecordCount, isSmallRecord));
+                    REQUIRE(!isSmallRecord(recordSizes.back()));
+                }
+                else
+                    REQUIRE(std::none_of(secondResponseRecordSizesBegin, recordSizes.cend(), isSmallRecord));
+            }
+        }
+    }
+}
+
+
+namespace TlsSocketTests
+{
+struct HandshakeThreads
+{
+    static inline QMutex lock;
+    static inline std::set<std::thread::id> threadIds;
+    static void onInfo(const SSL*, int where, int)
+    {
+        if (where & SSL_CB_HANDSHAKE_START)
+        {
+            QMutexLocker locker(&lock);
+            threadIds.insert(std::this_thread::get_id());
+        }
+    }
+};
+}
+
+
+SCENARIO("TlsSocket runs server handshakes on handshake pool if enabled in TLS configuration")
+{
+    GIVEN("a server whose sockets echo received data")
+    {
+        const auto handshakeThreadCount = GENERATE(AS(size_t), 0, 2);
+        const auto tlsVersion = GENERATE(AS(TlsConfiguration::TlsVersion), TlsConfiguration::TlsVersion::TLS_1_2, TlsConfiguration::TlsVersion::TLS_1_3);
+        const auto certificateType = TlsTestCertificates::CertificateType::RSA_2048;
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.addCaCertificate(caCertificateFile);
+        serverTlsConfiguration.setTlsVersion(tlsVersion);
+        serverTlsConfiguration.setHandshakeThreadCount(handshakeThreadCount);
+        auto *pServerContext = TlsContext::fromTlsConfiguration(serverTlsConfiguration, TlsContext::Role::Server).context();
+        SSL_CTX_set_info_callback(pServerContext, &HandshakeThreads::onInfo);
+        HandshakeThreads::threadIds.clear();
+        TlsServer server(serverTlsConfiguration);
+        std::unique_ptr<TlsSocket> pServerPeer;
+        QSemaphore serverPeerEncryptedSemaphore;
+        QSemaphore serverPeerDisconnectedSemaphore;
+        Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+        {
+            REQUIRE(!pServerPeer);
+            pServerPeer.reset(pSocket);
+            Object::connect(pServerPeer.get(), &TlsSocket::encrypted, [&](){serverPeerEncryptedSemaphore.release();});
+            Object::connect(pServerPeer.get(), &TlsSocket::receivedData, [&](){pServerPeer->write(pServerPeer->readAll());});
+            Object::connect(pServerPeer.get(), &TlsSocket::disconnected, [&](){pServerPeer.release()->scheduleForDeletion(); serverPeerDisconnectedSemaphore.release();});
+        });
+        REQUIRE(server.listen(QHostAddress::LocalHost));
+
+        WHEN("client peer connects to server and sends data")
+        {
+            TlsConfiguration clientTlsConfiguration;
+            clientTlsConfiguration.addCaCertificate(caCertificateFile);
+            clientTlsConfiguration.setTlsVersion(tlsVersion);
+            TlsSocket clientPeer(clientTlsConfiguration);
+            const std::string data("Hello from client peer!");
+            std::string receivedData;
+            QSemaphore clientPeerReceivedDataSemaphore;
+            QSemaphore clientPeerDisconnectedSemaphore;
+            Object::connect(&clientPeer, &TlsSocket::encrypted, [&](){clientPeer.write(data);});
+            Object::connect(&clientPeer, &TlsSocket::receivedData, [&]()
+            {
+                receivedData.append(clientPeer.readAll());
+                if (receivedData.size() == data.size())
+                    clientPeerReceivedDataSemaphore.release();
+            });
+            Object::connect(&clientPeer, &TlsSocket::disconnected, [&](){clientPeerDisconnectedSemaphore.release();});
+            clientPeer.connect(server.serverAddress().toString().toStdString(), server.serverPort());
+            REQUIRE(TRY_ACQUIRE(serverPeerEncryptedSemaphore, 10));
+            REQUIRE(TRY_ACQUIRE(clientPeerReceivedDataSemaphore, 10));
+
+            THEN("server peer runs the handshake on handshake pool threads only if handshake threads are enabled")
+            {
+                REQUIRE(receivedData == data);
+                REQUIRE(pServerPeer->isEncrypted());
+                std::set<std::thread::id> serverHandshakeThreadIds;
+                {
+                    QMutexLocker locker(&HandshakeThreads::lock);
+                    serverHandshakeThreadIds = HandshakeThreads::threadIds;
+                }
+                REQUIRE(!serverHandshakeThreadIds.empty());
+                if (handshakeThreadCount == 0)
+                    REQUIRE(serverHandshakeThreadIds == std::set<std::thread::id>({std::this_thread::get_id()}));
+                else
+                    REQUIRE(!serverHandshakeThreadIds.contains(std::this_thread::get_id()));
+
+                AND_WHEN("client peer disconnects")
+                {
+                    clientPeer.disconnectFromPeer();
+
+                    THEN("both peers disconnect")
+                    {
+                        REQUIRE(TRY_ACQUIRE(clientPeerDisconnectedSemaphore, 10));
+                        REQUIRE(TRY_ACQUIRE(serverPeerDisconnectedSemaphore, 10));
+                    }
+                }
+            }
+            SSL_CTX_set_info_callback(pServerContext, nullptr);
+        }
+    }
+}
+
+
+SCENARIO("TlsSocket resumes sessions in handshakes run on handshake pool")
+{
+    GIVEN("a server with handshake threads that resumes sessions and whose sockets close the connections just after the TLS handshake completes")
+    {
+        const auto tlsVersion = GENERATE(AS(TlsConfiguration::TlsVersion),
+                                         TlsConfiguration::TlsVersion::TLS_1_2,
+                                         TlsConfiguration::TlsVersion::TLS_1_3);
+        const auto [usesSessionCache, usesSessionTickets] = GENERATE(AS(std::pair<bool, bool>),
+                                                                     {true, false},
+                                                                     {false, true});
+        const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.addCaCertificate(caCertificateFile);
+        serverTlsConfiguration.setTlsVersion(tlsVersion);
+        serverTlsConfiguration.setSessionCacheSize(usesSessionCache ? 64 : 0);
+        serverTlsConfiguration.setSessionTicketsEnabled(usesSessionTickets);
+        serverTlsConfiguration.setHandshakeThreadCount(2);
+        auto *pServerContext = TlsContext::fromTlsConfiguration(serverTlsConfiguration, TlsContext::Role::Server).context();
+        SSL_CTX_set_info_callback(pServerContext, &HandshakeThreads::onInfo);
+        HandshakeThreads::threadIds.clear();
+        TlsServer server(serverTlsConfiguration);
+        TlsConfiguration clientTlsConfiguration;
+        clientTlsConfiguration.addCaCertificate(caCertificateFile);
+        clientTlsConfiguration.setTlsVersion(tlsVersion);
+        clientTlsConfiguration.setSessionCacheSize(16);
+        clientTlsConfiguration.setSessionTicketsEnabled(true);
+        QSemaphore serverPeerCompletedHandshakeSemaphore;
+        QSemaphore serverPeerDisconnectedSemaphore;
+        QList<bool> serverPeerResumedSessions;
+        std::unique_ptr<TlsSocket> pServerPeer;
+        Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+        {
+            REQUIRE(!pServerPeer);
+            pServerPeer.reset(pSocket);
+            Object::connect(pServerPeer.get(), &TlsSocket::encrypted, [&]()
+            {
+                serverPeerResumedSessions.append(pServerPeer->isSessionResumed());
+                pServerPeer->disconnectFromPeer();
+                serverPeerCompletedHandshakeSemaphore.release();
+            });
+            Object::connect(pServerPeer.get(), &TlsSocket::disconnected, [&](){pServerPeer.release()->scheduleForDeletion(); serverPeerDisconnectedSemaphore.release();});
+        });
+        REQUIRE(server.listen(QHostAddress::LocalHost));
+
+        WHEN("client peer connects to server three times")
+        {
+            TlsSocket clientPeer(clientTlsConfiguration);
+            QSemaphore clientPeerCompletedHandshakeSemaphore;
+            QSemaphore clientPeerDisconnectedSemaphore;
+            QList<bool> clientPeerResumedSessions;
+            Object::connect(&clientPeer, &TlsSocket::encrypted, [&]()
+            {
+                clientPeerResumedSessions.append(clientPeer.isSessionResumed());
+                clientPeerCompletedHandshakeSemaphore.release();
+            });
+            Object::connect(&clientPeer, &TlsSocket::disconnected, [&](){clientPeerDisconnectedSemaphore.release();});
+            for (auto i = 0; i < 3; ++i)
+            {
+                clientPeer.connect(server.serverAddress().toString().toStdString(), server.serverPort());
+                REQUIRE(TRY_ACQUIRE(clientPeerCompletedHandshakeSemaphore, 10));
+                REQUIRE(TRY_ACQUIRE(serverPeerCompletedHandshakeSemaphore, 10));
+                REQUIRE(TRY_ACQUIRE(clientPeerDisconnectedSemaphore, 10));
+                REQUIRE(TRY_ACQUIRE(serverPeerDisconnectedSemaphore, 10));
+            }
+            SSL_CTX_set_info_callback(pServerContext, nullptr);
+
+            THEN("only the first connection performs a full handshake, with cached sessions and tickets looked up, issued and decrypted on handshake pool threads")
+            {
+                REQUIRE(clientPeerResumedSessions == QList<bool>({false, true, true}));
+                REQUIRE(serverPeerResumedSessions == QList<bool>({false, true, true}));
+                QMutexLocker locker(&HandshakeThreads::lock);
+                REQUIRE(!HandshakeThreads::threadIds.empty());
+                REQUIRE(!HandshakeThreads::threadIds.contains(std::this_thread::get_id()));
+            }
+        }
+    }
+}
+
+
+SCENARIO("TlsSocket reports handshake failures of steps run on handshake pool as it does for handshakes run on its own thread")
+{
+    GIVEN("a server that requires client certificates")
+    {
+        const auto handshakeThreadCount = GENERATE(AS(size_t), 0, 2);
+        const auto [tlsVersion, openSslTlsVersion] = GENERATE(AS(std::pair<TlsConfiguration::TlsVersion, int>),
+                                                              {TlsConfiguration::TlsVersion::TLS_1_2, TLS1_2_VERSION},
+                                                              {TlsConfiguration::TlsVersion::TLS_1_3, TLS1_3_VERSION});
+        const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setPeerVerifyMode(TlsConfiguration::PeerVerifyMode::On);
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.addCaCertificate(caCertificateFile);
+        serverTlsConfiguration.setTlsVersion(tlsVersion);
+        serverTlsConfiguration.setHandshakeThreadCount(handshakeThreadCount);
+        TlsServer server(serverTlsConfiguration);
+        std::unique_ptr<TlsSocket> pServerPeer;
+        std::string serverPeerErrorMessage;
+        QSemaphore serverPeerFailedSemaphore;
+        Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+        {
+            REQUIRE(!pServerPeer);
+            pServerPeer.reset(pSocket);
+            Object::connect(pServerPeer.get(), &TlsSocket::encrypted, [](){Spectator::FAIL("This code is supposed to be unreachable.");});
+            Object::connect(pServerPeer.get(), &TlsSocket::error, [&]()
+            {
+                serverPeerErrorMessage = pServerPeer->errorMessage();
+                serverPeerFailedSemaphore.release();
+            });
+        });
+        REQUIRE(server.listen(QHostAddress::LocalHost));
+        const auto serverPort = server.serverPort();
+
+        WHEN("a client without certificate connects to server")
+        {
+            bool clientConnected = false;
+            int clientLastError = SSL_ERROR_NONE;
+            unsigned long clientLastErrorCode = 0;
+            QSemaphore clientFinishedSemaphore;
+            std::thread clientThread([&]()
+            {
+                OpenSslClient client(caCertificateFile, openSslTlsVersion);
+                clientConnected = client.connect(serverPort);
+                if (clientConnected)
+                    client.read(1);
+                clientLastError = client.lastError();
+                clientLastErrorCode = client.lastErrorCode();
+                clientFinishedSemaphore.release();
+            });
+            const bool serverPeerFailed = TRY_ACQUIRE(serverPeerFailedSemaphore, 10);
+            const bool clientFinished = TRY_ACQUIRE(clientFinishedSemaphore, 10);
+            clientThread.join();
+
+            THEN("server peer fails with the error OpenSSL raised and client receives the alert server peer sent before aborting the connection")
+            {
+                REQUIRE(serverPeerFailed);
+                REQUIRE(clientFinished);
+                const std::string reason(ERR_reason_error_string(ERR_PACK(ERR_LIB_SSL, 0, SSL_R_PEER_DID_NOT_RETURN_A_CERTIFICATE)));
+                REQUIRE(serverPeerErrorMessage == std::string("TLS handshake failed. TLS error at SSL routines. ").append(reason));
+                // TLS 1.3 clients complete their handshakes before servers verify their certificates.
+                REQUIRE(clientConnected == (tlsVersion == TlsConfiguration::TlsVersion::TLS_1_3));
+                REQUIRE(clientLastError == SSL_ERROR_SSL);
+                const int expectedAlert = (tlsVersion == TlsConfiguration::TlsVersion::TLS_1_3) ? SSL_AD_CERTIFICATE_REQUIRED : SSL_AD_HANDSHAKE_FAILURE;
+                REQUIRE(ERR_GET_REASON(clientLastErrorCode) == SSL_AD_REASON_OFFSET + expectedAlert);
+            }
+        }
+    }
+}
+
+
+namespace TlsSocketTests
+{
+// Blocks the first handshake step started on a handshake pool thread until the test lets it finish,
+// and tells when and where the SSL object of the blocked step is released.
+struct BlockedHandshakeStep
+{
+    static inline std::atomic_bool blocksNextStep = false;
+    static inline QSemaphore startedSemaphore;
+    static inline QSemaphore canFinishSemaphore;
+    static inline QSemaphore releasedSemaphore;
+    static inline std::thread::id releasingThreadId;
+    static int exDataIndex()
+    {
+        static const int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, &BlockedHandshakeStep::onFree);
+        return index;
+    }
+    static void reset()
+    {
+        exDataIndex();
+        startedSemaphore.tryAcquire(startedSemaphore.available());
+        canFinishSemaphore.tryAcquire(canFinishSemaphore.available());
+        releasedSemaphore.tryAcquire(releasedSemaphore.available());
+        releasingThreadId = {};
+        blocksNextStep = true;
+    }
+    static void onInfo(const SSL *pSSL, int where, int)
+    {
+        if ((where & SSL_CB_HANDSHAKE_START) && blocksNextStep.exchange(false))
+        {
+            SSL_set_ex_data(const_cast<SSL*>(pSSL), exDataIndex(), &blocksNextStep);
+            startedSemaphore.release();
+            canFinishSemaphore.tryAcquire(1, 10000);
+        }
+    }
+    static void onFree(void*, void *pData, CRYPTO_EX_DATA*, int, long, void*)
+    {
+        if (pData == &blocksNextStep)
+        {
+            releasingThreadId = std::this_thread::get_id();
+            releasedSemaphore.release();
+        }
+    }
+};
+}
+
+
+SCENARIO("TlsSocket cancels handshake steps running on handshake pool when aborted")
+{
+    GIVEN("a server with handshake threads whose first handshake step blocks on the handshake pool")
+    {
+        const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.addCaCertificate(caCertificateFile);
+        // Handshake thread counts are part of TLS configurations, so no other scenario uses this context.
+        serverTlsConfiguration.setHandshakeThreadCount(3);
+        auto *pServerContext = TlsContext::fromTlsConfiguration(serverTlsConfiguration, TlsContext::Role::Server).context();
+        SSL_CTX_set_info_callback(pServerContext, &BlockedHandshakeStep::onInfo);
+        BlockedHandshakeStep::reset();
+        TlsServer server(serverTlsConfiguration);
+        bool serverPeerTimesOut = false;
+        std::unique_ptr<TlsSocket> pServerPeer;
+        QSemaphore serverPeerFailedSemaphore;
+        Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+        {
+            REQUIRE(!pServerPeer);
+            pServerPeer.reset(pSocket);
+            if (serverPeerTimesOut)
+                pServerPeer->setTlsHandshakeTimeout(std::chrono::milliseconds(200));
+            Object::connect(pServerPeer.get(), &TlsSocket::encrypted, [](){Spectator::FAIL("This code is supposed to be unreachable.");});
+            Object::connect(pServerPeer.get(), &TlsSocket::error, [&](){serverPeerFailedSemaphore.release();});
+        });
+        REQUIRE(server.listen(QHostAddress::LocalHost));
+        TlsConfiguration clientTlsConfiguration;
+        clientTlsConfiguration.addCaCertificate(caCertificateFile);
+        TlsSocket clientPeer(clientTlsConfiguration);
+        QSemaphore clientPeerClosedSemaphore;
+        Object::connect(&clientPeer, &TlsSocket::encrypted, [](){Spectator::FAIL("This code is supposed to be unreachable.");});
+        Object::connect(&clientPeer, &TlsSocket::error, [&](){clientPeerClosedSemaphore.release();});
+        Object::connect(&clientPeer, &TlsSocket::disconnected, [&](){clientPeerClosedSemaphore.release();});
+
+        WHEN("server peer is destroyed while its handshake step runs")
+        {
+            clientPeer.connect(server.serverAddress().toString().toStdString(), server.serverPort());
+            const bool stepStarted = TRY_ACQUIRE(BlockedHandshakeStep::startedSemaphore, 10);
+            const bool hadServerPeer = (pServerPeer != nullptr);
+            pServerPeer.reset();
+            BlockedHandshakeStep::canFinishSemaphore.release();
+
+            THEN("step's SSL object is released on server's thread once the step finishes and client peer is disconnected")
+            {
+                REQUIRE(stepStarted);
+                REQUIRE(hadServerPeer);
+                REQUIRE(TRY_ACQUIRE(BlockedHandshakeStep::releasedSemaphore, 10));
+                REQUIRE(BlockedHandshakeStep::releasingThreadId == std::this_thread::get_id());
+                REQUIRE(TRY_ACQUIRE(clientPeerClosedSemaphore, 10));
+            }
+        }
+
+        WHEN("server peer's handshake times out while its handshake step runs")
+        {
+            serverPeerTimesOut = true;
+            clientPeer.connect(server.serverAddress().toString().toStdString(), server.serverPort());
+            const bool stepStarted = TRY_ACQUIRE(BlockedHandshakeStep::startedSemaphore, 10);
+            const bool serverPeerFailed = TRY_ACQUIRE(serverPeerFailedSemaphore, 10);
+            BlockedHandshakeStep::canFinishSemaphore.release();
+
+            THEN("server peer fails and aborts the connection, and step's SSL object is released on server's thread once the step finishes")
+            {
+                REQUIRE(stepStarted);
+                REQUIRE(serverPeerFailed);
+                REQUIRE(pServerPeer->errorMessage().ends_with(". TLS handshake timed out."));
+                REQUIRE(pServerPeer->state() == TcpSocket::State::Unconnected);
+                REQUIRE(TRY_ACQUIRE(BlockedHandshakeStep::releasedSemaphore, 10));
+                REQUIRE(BlockedHandshakeStep::releasingThreadId == std::this_thread::get_id());
+                REQUIRE(TRY_ACQUIRE(clientPeerClosedSemaphore, 10));
+            }
+        }
+        SSL_CTX_set_info_callback(pServerContext, nullptr);
+    }
+}
+
+
+namespace TlsSocketTests
+{
+// Creates server sockets with TlsSocketPrivate::createServerSocket, as HttpConnectionHandlerFactory does.
+class TlsContextServer : private QTcpServer
+{
+public:
+    explicit TlsContextServer(const TlsContext &tlsContext) : m_tlsContext(tlsContext) {}
+    ~TlsContextServer() override {close();}
+    bool listen(const QHostAddress &address) {return QTcpServer::listen(address);}
+    QHostAddress serverAddress() const {return QTcpServer::serverAddress();}
+    quint16 serverPort() const {return QTcpServer::serverPort();}
+    std::function<void(TlsSocket*)> onNewConnection;
+
+private:
+    void incomingConnection(qintptr socketDescriptor) override
+    {
+        onNewConnection(TlsSocketPrivate::createServerSocket(socketDescriptor, m_tlsContext));
+    }
+
+private:
+    const TlsContext m_tlsContext;
+};
+}
+
+
+SCENARIO("TlsSocket creates server sockets from resolved TLS contexts")
+{
+    GIVEN("a server that creates its sockets from a resolved TLS context")
+    {
+        const auto tlsVersion = GENERATE(AS(TlsConfiguration::TlsVersion),
+                                         TlsConfiguration::TlsVersion::TLS_1_2,
+                                         TlsConfiguration::TlsVersion::TLS_1_3);
+        const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.addCaCertificate(caCertificateFile);
+        serverTlsConfiguration.setTlsVersion(tlsVersion);
+        const auto serverTlsContext = TlsContext::fromTlsConfiguration(serverTlsConfiguration, TlsContext::Role::Server);
+        REQUIRE(!serverTlsContext.isNull());
+        TlsContextServer server(serverTlsContext);
+        std::unique_ptr<TlsSocket> pServerPeer;
+        QSemaphore serverPeerCompletedHandshakeSemaphore;
+        server.onNewConnection = [&](TlsSocket *pSocket)
+        {
+            REQUIRE(!pServerPeer);
+            pServerPeer.reset(pSocket);
+            Object::connect(pServerPeer.get(), &TlsSocket::encrypted, [&](){serverPeerCompletedHandshakeSemaphore.release();});
+            Object::connect(pServerPeer.get(), &TlsSocket::receivedData, [&]()
+            {
+                if (pServerPeer->readAll() == "PING")
+                    pServerPeer->write("PONG");
+            });
+        };
+        REQUIRE(server.listen(QHostAddress::LocalHost));
+
+        WHEN("a client peer connects to server and sends a PING")
+        {
+            TlsConfiguration clientTlsConfiguration;
+            clientTlsConfiguration.addCaCertificate(caCertificateFile);
+            clientTlsConfiguration.setTlsVersion(tlsVersion);
+            TlsSocket clientPeer(clientTlsConfiguration);
+            QSemaphore clientPeerReceivedPongSemaphore;
+            Object::connect(&clientPeer, &TlsSocket::encrypted, [&](){clientPeer.write("PING");});
+            Object::connect(&clientPeer, &TlsSocket::receivedData, [&]()
+            {
+                if (clientPeer.readAll() == "PONG")
+                    clientPeerReceivedPongSemaphore.release();
+            });
+            clientPeer.connect(server.serverAddress().toString().toStdString(), server.serverPort());
+
+            THEN("server peer uses the configuration of the given context to complete the handshake and answers with a PONG")
+            {
+                REQUIRE(TRY_ACQUIRE(serverPeerCompletedHandshakeSemaphore, 10));
+                REQUIRE(TRY_ACQUIRE(clientPeerReceivedPongSemaphore, 10));
+                REQUIRE(pServerPeer->isEncrypted());
+                REQUIRE(pServerPeer->tlsConfiguration() == serverTlsConfiguration);
+            }
+        }
+
+        WHEN("a server socket is created from the context with an invalid descriptor")
+        {
+            std::unique_ptr<TlsSocket> pSocket(TlsSocketPrivate::createServerSocket(-1, serverTlsContext));
+
+            THEN("socket is unconnected")
+            {
+                REQUIRE(pSocket->state() == TcpSocket::State::Unconnected);
+                REQUIRE(!pSocket->isEncrypted());
+            }
+        }
+    }
+}
+
+
+SCENARIO("TlsSocket offloads TLS 1.3 records to the kernel if enabled in TLS configuration")
+{
+    using TlsVersion = TlsConfiguration::TlsVersion;
+    using Cipher = TlsConfiguration::Cipher;
+    GIVEN("a server with kernel TLS enabled whose sockets echo received data")
+    {
+        const auto [tlsVersion, cipher, canOffload] = GENERATE(AS(std::tuple<TlsVersion, Cipher, bool>),
+                                                               {TlsVersion::TLS_1_3, Cipher::TLS_AES_128_GCM_SHA256, true},
+                                                               {TlsVersion::TLS_1_3, Cipher::TLS_AES_256_GCM_SHA384, true},
+                                                               {TlsVersion::TLS_1_3, Cipher::TLS_CHACHA20_POLY1305_SHA256, true},
+                                                               {TlsVersion::TLS_1_2, Cipher::TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256, false},
+                                                               {TlsVersion::TLS_1_2, Cipher::TLS_ECDHE_ECDSA_WITH_AES_128_CBC_SHA256, false});
+        // Kernel TLS is optional and connections silently keep using OpenSSL where the kernel does not support it.
+        const bool usesKernelTls = canOffload && KernelTls::isAvailable();
+        const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.addCaCertificate(caCertificateFile);
+        serverTlsConfiguration.setTlsVersion(tlsVersion);
+        serverTlsConfiguration.setCiphers({cipher});
+        serverTlsConfiguration.setKernelTlsEnabled(true);
+        TlsServer server(serverTlsConfiguration);
+        std::unique_ptr<TlsSocket> pServerPeer;
+        bool serverPeerFailed = false;
+        QSemaphore serverPeerDisconnectedSemaphore;
+        Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+        {
+            REQUIRE(!pServerPeer);
+            pServerPeer.reset(pSocket);
+            Object::connect(pServerPeer.get(), &TlsSocket::receivedData, [&](){pServerPeer->write(pServerPeer->readAll());});
+            Object::connect(pServerPeer.get(), &TlsSocket::error, [&](){serverPeerFailed = true;});
+            Object::connect(pServerPeer.get(), &TlsSocket::disconnected, [&](){pServerPeer.release()->scheduleForDeletion(); serverPeerDisconnectedSemaphore.release();});
+        });
+        REQUIRE(server.listen(QHostAddress::LocalHost));
+
+        WHEN("client peer with kernel TLS enabled connects to server and sends data")
+        {
+            TlsConfiguration clientTlsConfiguration;
+            clientTlsConfiguration.addCaCertificate(caCertificateFile);
+            clientTlsConfiguration.setTlsVersion(tlsVersion);
+            clientTlsConfiguration.setCiphers({cipher});
+            clientTlsConfiguration.setKernelTlsEnabled(true);
+            TlsSocket clientPeer(clientTlsConfiguration);
+            const std::string_view data(largeData.constData(), largeData.size());
+            std::string receivedData;
+            bool clientPeerFailed = false;
+            QSemaphore clientPeerReceivedDataSemaphore;
+            QSemaphore clientPeerDisconnectedSemaphore;
+            Object::connect(&clientPeer, &TlsSocket::encrypted, [&](){clientPeer.write(data);});
+            Object::connect(&clientPeer, &TlsSocket::receivedData, [&]()
+            {
+                receivedData.append(clientPeer.readAll());
+                if (receivedData.size() == data.size())
+                    clientPeerReceivedDataSemaphore.release();
+            });
+            Object::connect(&clientPeer, &TlsSocket::error, [&](){clientPeerFailed = true;});
+            Object::connect(&clientPeer, &TlsSocket::disconnected, [&](){clientPeerDisconnectedSemaphore.release();});
+            clientPeer.connect(server.serverAddress().toString().toStdString(), server.serverPort());
+            REQUIRE(TRY_ACQUIRE(clientPeerReceivedDataSemaphore, 10));
+
+            THEN("peers exchange data with records offloaded to the kernel only if the connection uses TLS 1.3 and the kernel supports kTLS")
+            {
+                REQUIRE(receivedData == data);
+                REQUIRE(clientPeer.isKernelTlsEnabled() == usesKernelTls);
+                REQUIRE(pServerPeer->isKernelTlsEnabled() == usesKernelTls);
+
+                AND_WHEN("client peer disconnects")
+                {
+                    clientPeer.disconnectFromPeer();
+
+                    THEN("server peer receives the close_notify alert and both peers disconnect gracefully")
+                    {
+                        REQUIRE(TRY_ACQUIRE(clientPeerDisconnectedSemaphore, 10));
+                        REQUIRE(TRY_ACQUIRE(serverPeerDisconnectedSemaphore, 10));
+                        REQUIRE(!clientPeerFailed);
+                        REQUIRE(!serverPeerFailed);
+                    }
+                }
+
+                AND_WHEN("server peer disconnects")
+                {
+                    pServerPeer->disconnectFromPeer();
+
+                    THEN("client peer receives the close_notify alert and both peers disconnect gracefully")
+                    {
+                        REQUIRE(TRY_ACQUIRE(serverPeerDisconnectedSemaphore, 10));
+                        REQUIRE(TRY_ACQUIRE(clientPeerDisconnectedSemaphore, 10));
+                        REQUIRE(!clientPeerFailed);
+                        REQUIRE(!serverPeerFailed);
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+SCENARIO("TlsSocket handles alerts after offloading records to the kernel")
+{
+    GIVEN("a TLS 1.3 server with kernel TLS enabled whose sockets greet connected clients")
+    {
+        const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.addCaCertificate(caCertificateFile);
+        serverTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+        serverTlsConfiguration.setKernelTlsEnabled(true);
+        TlsServer server(serverTlsConfiguration);
+        const std::string greeting("Hello from server peer!");
+        bool serverPeerDisconnectsAfterGreeting = false;
+        bool serverPeerUsesKernelTls = false;
+        std::unique_ptr<TlsSocket> pServerPeer;
+        QSemaphore serverPeerDisconnectedSemaphore;
+        QSemaphore serverPeerFailedSemaphore;
+        Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+        {
+            REQUIRE(!pServerPeer);
+            pServerPeer.reset(pSocket);
+            Object::connect(pServerPeer.get(), &TlsSocket::encrypted, [&]()
+            {
+                pServerPeer->write(greeting);
+                serverPeerUsesKernelTls = pServerPeer->isKernelTlsEnabled();
+                if (serverPeerDisconnectsAfterGreeting)
+                    pServerPeer->disconnectFromPeer();
+            });
+            Object::connect(pServerPeer.get(), &TlsSocket::error, [&](){pServerPeer.release()->scheduleForDeletion(); serverPeerFailedSemaphore.release();});
+            Object::connect(pServerPeer.get(), &TlsSocket::disconnected, [&](){pServerPeer.release()->scheduleForDeletion(); serverPeerDisconnectedSemaphore.release();});
+        });
+        REQUIRE(server.listen(QHostAddress::LocalHost));
+        const auto serverPort = server.serverPort();
+        bool clientConnected = false;
+        std::string clientReceivedData;
+        int clientLastError = SSL_ERROR_NONE;
+
+        WHEN("client receives the greeting and sends a close_notify alert")
+        {
+            std::thread clientThread([&]()
+            {
+                OpenSslClient client(caCertificateFile);
+                clientConnected = client.connect(serverPort);
+                clientReceivedData = client.read(greeting.size());
+                client.shutdown();
+                client.read(1);
+                clientLastError = client.lastError();
+            });
+            REQUIRE(TRY_ACQUIRE(serverPeerDisconnectedSemaphore, 10));
+            clientThread.join();
+
+            THEN("server peer answers with a close_notify alert and disconnects gracefully")
+            {
+                REQUIRE(clientConnected);
+                REQUIRE(clientReceivedData == greeting);
+                REQUIRE(clientLastError == SSL_ERROR_ZERO_RETURN);
+                REQUIRE(serverPeerUsesKernelTls == KernelTls::isAvailable());
+                REQUIRE(!serverPeerFailedSemaphore.tryAcquire());
+            }
+        }
+
+        WHEN("client fails to decrypt the greeting and sends a fatal alert")
+        {
+            std::thread clientThread([&]()
+            {
+                OpenSslClient client(caCertificateFile);
+                clientConnected = client.connect(serverPort);
+                client.corruptNextReceivedData();
+                clientReceivedData = client.read(greeting.size());
+                clientLastError = client.lastError();
+            });
+            REQUIRE(TRY_ACQUIRE(serverPeerFailedSemaphore, 10));
+            clientThread.join();
+
+            THEN("server peer fails")
+            {
+                REQUIRE(clientConnected);
+                REQUIRE(clientReceivedData.empty());
+                REQUIRE(clientLastError == SSL_ERROR_SSL);
+                REQUIRE(serverPeerUsesKernelTls == KernelTls::isAvailable());
+            }
+        }
+
+        WHEN("server peer disconnects after sending the greeting")
+        {
+            serverPeerDisconnectsAfterGreeting = true;
+            std::thread clientThread([&]()
+            {
+                OpenSslClient client(caCertificateFile);
+                clientConnected = client.connect(serverPort);
+                clientReceivedData = client.read(greeting.size() + 1);
+                clientLastError = client.lastError();
+            });
+            clientThread.join();
+            REQUIRE(TRY_ACQUIRE(serverPeerDisconnectedSemaphore, 10));
+
+            THEN("client receives the greeting followed by a close_notify alert")
+            {
+                REQUIRE(clientConnected);
+                REQUIRE(clientReceivedData == greeting);
+                REQUIRE(clientLastError == SSL_ERROR_ZERO_RETURN);
+                REQUIRE(serverPeerUsesKernelTls == KernelTls::isAvailable());
+            }
+        }
+    }
+}
+
+
+SCENARIO("TlsSocket sends files with sendfile after offloading records to the kernel")
+{
+    GIVEN("a file and a TLS 1.3 server with kernel TLS enabled whose sockets send the file to connected clients")
+    {
+        std::string fileContent;
+        fileContent.reserve(4 * 1024 * 1024);
+        for (size_t i = 0; i < 4 * 1024 * 1024; ++i)
+            fileContent.push_back('a' + (i % 26));
+        QTemporaryFile file;
+        REQUIRE(file.open());
+        REQUIRE(file.write(fileContent.data(), fileContent.size()) == qint64(fileContent.size()));
+        REQUIRE(file.flush());
+        const auto certificateType = TlsTestCertificates::CertificateType::ECDSA;
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(certificateType, certificateFile, privateKeyFile, caCertificateFile);
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.addCaCertificate(caCertificateFile);
+        serverTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+        serverTlsConfiguration.setKernelTlsEnabled(true);
+        TlsServer server(serverTlsConfiguration);
+        std::unique_ptr<TlsSocket> pServerPeer;
+        size_t fileOffset = 0;
+        size_t sentFileSize = 0;
+        QSemaphore serverPeerDisconnectedSemaphore;
+        // Data is sent with sendfile until the socket is full. A chunk is then written to the channel,
+        // so that its sentData signal resumes sending the file.
+        const auto sendFile = [&]()
+        {
+            if (fileOffset == fileContent.size() || pServerPeer->dataToWrite() > 0)
+                return;
+            if (pServerPeer->isKernelTlsEnabled())
+            {
+                const auto bytesSent = UnixUtils::safeSendFile(pServerPeer->fileDescriptor(), file.handle(), fileOffset, fileContent.size() - fileOffset);
+                fileOffset += bytesSent;
+                sentFileSize += bytesSent;
+                if (fileOffset == fileContent.size())
+                    return;
+            }
+            const auto chunkSize = std::min<size_t>(16384, fileContent.size() - fileOffset);
+            pServerPeer->write(fileContent.data() + fileOffset, chunkSize);
+            fileOffset += chunkSize;
+        };
+        Object::connect(&server, &TlsServer::newConnection, [&](TlsSocket *pSocket)
+        {
+            REQUIRE(!pServerPeer);
+            pServerPeer.reset(pSocket);
+            Object::connect(pServerPeer.get(), &TlsSocket::encrypted, sendFile);
+            Object::connect(pServerPeer.get(), &TlsSocket::sentData, sendFile);
+            Object::connect(pServerPeer.get(), &TlsSocket::disconnected, [&](){pServerPeer.release()->scheduleForDeletion(); serverPeerDisconnectedSemaphore.release();});
+        });
+        REQUIRE(server.listen(QHostAddress::LocalHost));
+
+        WHEN("client peer with kernel TLS enabled connects to server and receives the file")
+        {
+            TlsConfiguration clientTlsConfiguration;
+            clientTlsConfiguration.addCaCertificate(caCertificateFile);
+            clientTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+            clientTlsConfiguration.setKernelTlsEnabled(true);
+            TlsSocket clientPeer(clientTlsConfiguration);
+            std::string receivedData;
+            QSemaphore clientPeerReceivedFileSemaphore;
+            QSemaphore clientPeerDisconnectedSemaphore;
+            Object::connect(&clientPeer, &TlsSocket::receivedData, [&]()
+            {
+                receivedData.append(clientPeer.readAll());
+                if (receivedData.size() == fileContent.size())
+                    clientPeerReceivedFileSemaphore.release();
+            });
+            Object::connect(&clientPeer, &TlsSocket::disconnected, [&](){clientPeerDisconnectedSemaphore.release();});
+            clientPeer.connect(server.serverAddress().toString().toStdString(), server.serverPort());
+            REQUIRE(TRY_ACQUIRE(clientPeerReceivedFileSemaphore, 10));
+
+            THEN("client peer receives the file, which server peer sends with sendfile if the kernel supports kTLS")
+            {
+                REQUIRE(receivedData == fileContent);
+                REQUIRE(pServerPeer->isKernelTlsEnabled() == KernelTls::isAvailable());
+                REQUIRE(clientPeer.isKernelTlsEnabled() == KernelTls::isAvailable());
+                if (KernelTls::isAvailable())
+                    REQUIRE(sentFileSize > 0);
+                else
+                    REQUIRE(sentFileSize == 0);
+
+                AND_WHEN("client peer disconnects")
+                {
+                    clientPeer.disconnectFromPeer();
+
+                    THEN("both peers disconnect")
+                    {
+                        REQUIRE(TRY_ACQUIRE(clientPeerDisconnectedSemaphore, 10));
+                        REQUIRE(TRY_ACQUIRE(serverPeerDisconnectedSemaphore, 10));
+                    }
+                }
+            }
+        }
+    }
+}
@@ -17,7 +17,11 @@
 
 #include "TlsSocketDataSink.h"
 #include "RuntimeError.h"
+#include "NoDestroy.h"
 #include <openssl/err.h>
+#include <algorithm>
+#include <vector>
+#include <cstring>
 
 
 namespace Kourier
@@ -28,10 +32,45 @@ bool TlsSocketDataSink::needsToRead() const
     return (1 == SSL_want_read(m_pSSL));
 }
 
+// With dynamic record sizing, the first bytes sent on new or idle connections are encrypted into records that fit in
+// a single TCP segment, leaving room for IPv6 and TCP headers with options and for the record overhead on 1500-byte
+// MTU links. Peers can then decrypt them as soon as the first segment arrives. Records grow to the maximum size once
+// enough data has been sent.
 size_t TlsSocketDataSink::write(const char *pData, size_t count)
 {
     if (pData == nullptr || count == 0)
         return 0;
+    if (!m_isDynamicRecordSizingEnabled)
+        return encrypt(pData, count);
+    const auto currentTime = std::chrono::steady_clock::now();
+    if ((currentTime - m_lastWriteTime) >= idleTimeout)
+        m_smallRecordDataLeft = smallRecordDataSize;
+    m_lastWriteTime = currentTime;
+    size_t bytesWritten = 0;
+    if (m_smallRecordDataLeft > 0)
+    {
+        setRecordSize(smallRecordSize);
+        const auto dataSize = std::min(count, m_smallRecordDataLeft);
+        bytesWritten = encrypt(pData, dataSize);
+        m_smallRecordDataLeft -= bytesWritten;
+        if (m_smallRecordDataLeft == 0)
+            setRecordSize(largeRecordSize);
+        if (bytesWritten < dataSize || bytesWritten == count)
+            return bytesWritten;
+    }
+    return bytesWritten + encrypt(pData + bytesWritten, count - bytesWritten);
+}
+
+void TlsSocketDataSink::setDynamicRecordSizingEnabled(bool enabled)
+{
+    m_isDynamicRecordSizingEnabled = enabled;
+    m_recordSize = largeRecordSize;
+    m_smallRecordDataLeft = enabled ? smallRecordDataSize : 0;
+    m_lastWriteTime = std::chrono::steady_clock::now();
+}
+
+size_t TlsSocketDataSink::encrypt(const char *pData, size_t count)
+{
     const auto result = SSL_write(m_pSSL, pData, count);
     if (result > 0)
     {
@@ -53,4 +92,71 @@ size_t TlsSocketDataSink::write(const char *pData, size_t count)
     }
 }
 
+void TlsSocketDataSink::setRecordSize(size_t recordSize)
+{
+    if (m_recordSize != recordSize)
+    {
+        SSL_set_max_send_fragment(m_pSSL, recordSize);
+        m_recordSize = recordSize;
+    }
+}
+
+static char *threadLocalRecordBuffer(size_t size)
+{
+    static thread_local NoDestroy<std::vector<char>*> pThreadLocalBuffer(new std::vector<char>);
+    static thread_local NoDestroyPtrDeleter<std::vector<char>*> vectorBufferDestroyer(pThreadLocalBuffer);
+    auto *pBuffer = pThreadLocalBuffer();
+    if (pBuffer == nullptr)
+        return nullptr;
+    if (pBuffer->size() < size)
+        pBuffer->resize(size);
+    return pBuffer->data();
+}
+
+// Each SSL_write call is encrypted into its own records. Slices are gathered into record-sized
+// writes, so that data buffered in pieces is sent as full-size records instead of one record per piece.
+// Only data that does not fill whole records by itself is copied.
+size_t TlsSocketDataSink::writev(const std::string_view *pSlices, size_t count)
+{
+    char *pRecord = (count > 1) ? threadLocalRecordBuffer(largeRecordSize) : nullptr;
+    if (pRecord == nullptr)
+        return DataSink::writev(pSlices, count);
+    size_t bytesWritten = 0;
+    size_t recordSize = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto slice = pSlices[i];
+        while (!slice.empty())
+        {
+            if (recordSize == 0 && slice.size() >= largeRecordSize)
+            {
+                const size_t fullRecordsSize = slice.size() - (slice.size() % largeRecordSize);
+                const auto fullRecordsBytesWritten = write(slice.data(), fullRecordsSize);
+                bytesWritten += fullRecordsBytesWritten;
+                if (fullRecordsBytesWritten < fullRecordsSize)
+                    return bytesWritten;
+                slice.remove_prefix(fullRecordsSize);
+            }
+            else
+            {
+                const auto copySize = std::min(slice.size(), largeRecordSize - recordSize);
+                std::memcpy(pRecord + recordSize, slice.data(), copySize);
+                recordSize += copySize;
+                slice.remove_prefix(copySize);
+                if (recordSize == largeRecordSize)
+                {
+                    const auto recordBytesWritten = write(pRecord, recordSize);
+                    bytesWritten += recordBytesWritten;
+                    if (recordBytesWritten < recordSize)
+                        return bytesWritten;
+                    recordSize = 0;
+                }
+            }
+        }
+    }
+    if (recordSize > 0)
+        bytesWritten += write(pRecord, recordSize);
+    return bytesWritten;
+}
+
 }
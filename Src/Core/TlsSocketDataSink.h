@@ -20,6 +20,7 @@
 
 #include "RingBuffer.h"
 #include <openssl/ssl.h>
+#include <chrono>
 
 
 namespace Kourier
@@ -32,9 +33,23 @@ public:
     ~TlsSocketDataSink() override = default;
     virtual bool needsToRead() const override;
     size_t write(const char *pData, size_t count) override;
+    size_t writev(const std::string_view *pSlices, size_t count) override;
+    void setDynamicRecordSizingEnabled(bool enabled);
+    static constexpr size_t smallRecordSize = 1369;
+    static constexpr size_t largeRecordSize = SSL3_RT_MAX_PLAIN_LENGTH;
+    static constexpr size_t smallRecordDataSize = 128 * 1024;
+    static constexpr std::chrono::milliseconds idleTimeout = std::chrono::milliseconds(1000);
+
+private:
+    size_t encrypt(const char *pData, size_t count);
+    void setRecordSize(size_t recordSize);
 
 private:
     SSL *&m_pSSL;
+    std::chrono::steady_clock::time_point m_lastWriteTime;
+    size_t m_recordSize = largeRecordSize;
+    size_t m_smallRecordDataLeft = 0;
+    bool m_isDynamicRecordSizingEnabled = false;
 };
 
 }
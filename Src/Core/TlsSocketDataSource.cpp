@@ -28,6 +28,36 @@ size_t TlsSocketDataSource::read(char *pBuffer, size_t count)
     if (pBuffer == nullptr || count == 0)
         return 0;
     int bytesDecrypted = 0;
+    // Servers accepting TLS 1.3 early data read it before the handshake can continue.
+    while (m_isReadingEarlyData)
+    {
+        size_t bytesRead = 0;
+        switch (SSL_read_early_data(m_pSSL, pBuffer + bytesDecrypted, count - bytesDecrypted, &bytesRead))
+        {
+            case SSL_READ_EARLY_DATA_SUCCESS:
+                bytesDecrypted += bytesRead;
+                if (bytesDecrypted < count)
+                    continue;
+                else
+                    return bytesDecrypted;
+            case SSL_READ_EARLY_DATA_FINISH:
+                bytesDecrypted += bytesRead;
+                m_isReadingEarlyData = false;
+                if (bytesDecrypted < count)
+                    break;
+                else
+                    return bytesDecrypted;
+            default:
+                switch (SSL_get_error(m_pSSL, 0))
+                {
+                    case SSL_ERROR_WANT_READ:
+                    case SSL_ERROR_WANT_WRITE:
+                        return bytesDecrypted;
+                    default:
+                        throw RuntimeError("Failed to decrypt early data.", RuntimeError::ErrorType::TLS);
+                }
+        }
+    }
     while (true)
     {
         const auto result = SSL_read(m_pSSL, pBuffer + bytesDecrypted, count - bytesDecrypted);
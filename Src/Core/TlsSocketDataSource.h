@@ -34,10 +34,13 @@ public:
     ~TlsSocketDataSource() override = default;
     size_t dataAvailable() const override {return m_encryptedIncomingDataBuffer.size();}
     size_t read(char *pBuffer, size_t count) override;
+    inline void setReadingEarlyData(bool isReadingEarlyData) {m_isReadingEarlyData = isReadingEarlyData;}
+    inline bool isReadingEarlyData() const {return m_isReadingEarlyData;}
 
 private:
     SSL *&m_pSSL;
     RingBuffer &m_encryptedIncomingDataBuffer;
+    bool m_isReadingEarlyData = false;
 };
 
 }
@@ -31,16 +31,8 @@ TlsSocketPrivate::TlsSocketPrivate(RingBuffer &unencryptedIncomingDataBuffer,
                                    RingBuffer &unencryptedOutgoingDataBuffer,
                                    const TlsConfiguration &tlsConfiguration,
                                    TlsContext::Role role) :
-    m_encryptedIncomingDataBuffer(m_encryptedIncomingDataBufferBIO.ringBuffer()),
-    m_unencryptedIncomingDataBuffer(unencryptedIncomingDataBuffer),
-    m_unencryptedOutgoingDataBuffer(unencryptedOutgoingDataBuffer),
-    m_encryptedOutgoingDataBuffer(m_encryptedOutgoingDataBufferBIO.ringBuffer()),
-    m_tlsDataSink(m_pSSL),
-    m_tlsDataSource(m_pSSL, m_encryptedIncomingDataBufferBIO.ringBuffer())
+    TlsSocketPrivate(unencryptedIncomingDataBuffer, unencryptedOutgoingDataBuffer, TlsContext())
 {
-    m_handshakeTimer.setSingleShot(true);
-    m_handshakeTimer.setInterval(handshakeTimeoutInMSecs);
-    Object::connect(&m_handshakeTimer, &Timer::timeout, this, &TlsSocketPrivate::onHandshakeTimeout);
     try
     {
         m_tlsContext = TlsContext::fromTlsConfiguration(tlsConfiguration, role);
@@ -53,12 +45,42 @@ TlsSocketPrivate::TlsSocketPrivate(RingBuffer &unencryptedIncomingDataBuffer,
     }
 }
 
+TlsSocketPrivate::TlsSocketPrivate(RingBuffer &unencryptedIncomingDataBuffer,
+                                   RingBuffer &unencryptedOutgoingDataBuffer,
+                                   const TlsContext &tlsContext) :
+    m_encryptedIncomingDataBuffer(m_encryptedIncomingDataBufferBIO.ringBuffer()),
+    m_unencryptedIncomingDataBuffer(unencryptedIncomingDataBuffer),
+    m_unencryptedOutgoingDataBuffer(unencryptedOutgoingDataBuffer),
+    m_encryptedOutgoingDataBuffer(m_encryptedOutgoingDataBufferBIO.ringBuffer()),
+    m_tlsDataSink(m_pSSL),
+    m_tlsDataSource(m_pSSL, m_encryptedIncomingDataBufferBIO.ringBuffer()),
+    m_kernelTlsDataSource(m_kernelTls, m_tcpSocketDataSource, m_socketDescriptor)
+{
+    m_encryptedIncomingDataBuffer.setBufferPool(BufferPool::sharedThreadInstance());
+    m_encryptedIncomingDataBuffer.releaseStorage();
+    m_encryptedOutgoingDataBuffer.setBufferPool(BufferPool::sharedThreadInstance());
+    m_encryptedOutgoingDataBuffer.releaseStorage();
+    m_handshakeTimer.setSingleShot(true);
+    m_handshakeTimer.setInterval(handshakeTimeoutInMSecs);
+    Object::connect(&m_handshakeTimer, &Timer::timeout, this, &TlsSocketPrivate::onHandshakeTimeout);
+    m_tlsContext = tlsContext;
+}
+
 TlsSocketPrivate::~TlsSocketPrivate()
 {
     assert(m_state == TcpSocket::State::Unconnected);
     abortTls();
 }
 
+// Creating a TlsSocket from a TlsConfiguration looks up the matching TLS context in a per-thread cache,
+// comparing the given configuration against each cached one. Accept paths that create many sockets from the
+// same configuration resolve the context once and create their sockets here, so that accepting a connection
+// costs no configuration comparisons. The context is an internal type, so the constructor taking it is not public.
+TlsSocket *TlsSocketPrivate::createServerSocket(int64_t socketDescriptor, const TlsContext &tlsContext)
+{
+    return new TlsSocket(socketDescriptor, tlsContext);
+}
+
 void TlsSocketPrivate::connect(std::string_view host, uint16_t port)
 {
     Q_Q(TlsSocket);
@@ -101,11 +123,7 @@ void TlsSocketPrivate::disconnectFromPeer()
             m_disconnectTimer.start(disconnectTimeoutInMSecs);
             if (m_unencryptedOutgoingDataBuffer.isEmpty())
             {
-                if ((SSL_get_shutdown(m_pSSL) & SSL_SENT_SHUTDOWN) != SSL_SENT_SHUTDOWN)
-                {
-                    SSL_shutdown(m_pSSL);
-                    eventNotifier()->postEvent(this, EPOLLOUT);
-                }
+                sendCloseNotify();
                 if (m_encryptedOutgoingDataBuffer.isEmpty())
                 {
                     q->setReadChannelNotificationEnabled(false);
@@ -168,32 +186,123 @@ void TlsSocketPrivate::doHandshake()
         return;
     if (!m_handshakeTimer.isActive())
         m_handshakeTimer.start();
-    switch (const auto ret = SSL_do_handshake(m_pSSL))
+    if (m_tlsDataSource.isReadingEarlyData())
+    {
+        q->writeDataToChannel();
+        return;
+    }
+    if (m_handshakeThreadCount > 0)
+    {
+        runHandshakeStepOnPool();
+        return;
+    }
+    const auto ret = SSL_do_handshake(m_pSSL);
+    processHandshakeResult(ret, (ret == 1) ? SSL_ERROR_NONE : SSL_get_error(m_pSSL, ret));
+}
+
+void TlsSocketPrivate::processHandshakeResult(int result, int error)
+{
+    Q_Q(TlsSocket);
+    switch (result)
     {
         case 0:
-            throw RuntimeError("TLS handshake failed.", RuntimeError::ErrorType::TLS);
+            failHandshake();
         case 1:
         {
             m_handshakeTimer.stop();
             q->writeDataToChannel();
             m_hasCompletedHandshake = true;
+            m_tlsContext.sessionCache()->countHandshake(SSL_session_reused(m_pSSL) == 1);
+            tryToEnableKernelTls();
             eventNotifier()->postEvent(this, EPOLLOUT);
             q->encrypted();
             return;
         }
         default:
-            switch (SSL_get_error(m_pSSL, ret))
+            switch (error)
             {
                 case SSL_ERROR_WANT_WRITE:
                 case SSL_ERROR_WANT_READ:
                     q->writeDataToChannel();
                     return;
                 default:
-                    throw RuntimeError("TLS handshake failed.", RuntimeError::ErrorType::TLS);
+                    failHandshake();
             }
     }
 }
 
+// The error is taken from OpenSSL before the alert OpenSSL wrote for the peer is sent, so that peers
+// learn why the handshake failed before the connection is aborted.
+void TlsSocketPrivate::failHandshake()
+{
+    Q_Q(TlsSocket);
+    RuntimeError handshakeError("TLS handshake failed.", RuntimeError::ErrorType::TLS);
+    q->writeDataToChannel();
+    throw handshakeError;
+}
+
+// While a handshake step runs on the handshake pool, the pool thread owns the SSL object, which reads
+// and writes handshake data from and to memory BIOs. The socket's thread keeps owning the ring buffers,
+// and stops reading from the socket until the step's result is posted back to it.
+// Server context callbacks then run on the pool thread too. The session cache and the ticket key callbacks
+// lock the data they share, the certificate store swaps its entries atomically, and the key log callback of
+// kernel TLS finds no socket in SSL objects, as kernel TLS keeps handshakes on the socket's thread. The step
+// keeps the socket's TlsContext, which owns the session cache and the certificate store, alive while it runs.
+void TlsSocketPrivate::runHandshakeStepOnPool()
+{
+    if (m_pHandshakeStep != nullptr || m_encryptedIncomingDataBuffer.isEmpty())
+        return;
+    auto *pIncomingDataBIO = BIO_new(BIO_s_mem());
+    auto *pOutgoingDataBIO = BIO_new(BIO_s_mem());
+    if (pIncomingDataBIO == nullptr || pOutgoingDataBIO == nullptr)
+    {
+        BIO_free(pIncomingDataBIO);
+        BIO_free(pOutgoingDataBIO);
+        throw RuntimeError("Failed to create OpenSSL BIO.", RuntimeError::ErrorType::TLS);
+    }
+    const auto incomingData = m_encryptedIncomingDataBuffer.peekAll();
+    if (BIO_write(pIncomingDataBIO, incomingData.data(), incomingData.size()) != (int)incomingData.size())
+    {
+        BIO_free(pIncomingDataBIO);
+        BIO_free(pOutgoingDataBIO);
+        throw RuntimeError("Failed to write to OpenSSL BIO.", RuntimeError::ErrorType::TLS);
+    }
+    m_handshakeStepInputSize = incomingData.size();
+    SSL_set_bio(m_pSSL, pIncomingDataBIO, pOutgoingDataBIO);
+    m_pHandshakeStep = TlsHandshakePool::runStep(m_pSSL, m_tlsContext, &TlsSocketPrivate::onHandshakeStepFinished, this);
+}
+
+void TlsSocketPrivate::onHandshakeStepFinished(TlsHandshakeStep &handshakeStep, void *pReceiver)
+{
+    auto *pSocket = static_cast<TlsSocketPrivate*>(pReceiver);
+    assert(pSocket->m_pHandshakeStep == &handshakeStep && pSocket->m_pSSL == handshakeStep.ssl());
+    pSocket->m_pHandshakeStep = nullptr;
+    auto *pIncomingDataBIO = SSL_get_rbio(pSocket->m_pSSL);
+    auto *pOutgoingDataBIO = SSL_get_wbio(pSocket->m_pSSL);
+    pSocket->m_encryptedIncomingDataBuffer.popFront(pSocket->m_handshakeStepInputSize - BIO_ctrl_pending(pIncomingDataBIO));
+    char *pOutgoingData = nullptr;
+    const auto outgoingDataSize = BIO_get_mem_data(pOutgoingDataBIO, &pOutgoingData);
+    if (outgoingDataSize > 0)
+        pSocket->m_encryptedOutgoingDataBuffer.write(pOutgoingData, outgoingDataSize);
+    BIO_up_ref(pSocket->m_encryptedIncomingDataBufferBIO.bio());
+    BIO_up_ref(pSocket->m_encryptedOutgoingDataBufferBIO.bio());
+    SSL_set_bio(pSocket->m_pSSL, pSocket->m_encryptedIncomingDataBufferBIO.bio(), pSocket->m_encryptedOutgoingDataBufferBIO.bio());
+    if (handshakeStep.result() != 1 && handshakeStep.error() != SSL_ERROR_WANT_READ && handshakeStep.errorCode() != 0)
+        ERR_raise(ERR_GET_LIB(handshakeStep.errorCode()), ERR_GET_REASON(handshakeStep.errorCode()));
+    try
+    {
+        const auto contextId = pSocket->m_contextId;
+        pSocket->processHandshakeResult(handshakeStep.result(), handshakeStep.error());
+        // Data received while the step was running is still in the socket.
+        if (contextId == pSocket->m_contextId && pSocket->m_state == TcpSocket::State::Connected)
+            pSocket->eventNotifier()->postEvent(pSocket, EPOLLIN | EPOLLOUT);
+    }
+    catch (const RuntimeError &runtimeError)
+    {
+        pSocket->setError(runtimeError.error());
+    }
+}
+
 void TlsSocketPrivate::setupTls()
 {
     abortTls();
@@ -220,12 +329,25 @@ void TlsSocketPrivate::setupTls()
                 SSL_set_tlsext_host_name(m_pSSL, m_hostAddresses[0].c_str());
                 SSL_set1_host(m_pSSL, m_hostAddresses[0].c_str());
             }
+            m_sessionPeer = !m_peerName.empty() ? m_peerName : (!m_peerAddress.empty() ? m_peerAddress : (!m_hostAddresses.empty() ? m_hostAddresses[0] : std::string{}));
+            if (!m_sessionPeer.empty())
+                m_sessionPeer.append(":").append(std::to_string(m_peerPort));
+            m_tlsContext.sessionCache()->setupClientSession(m_pSSL, m_sessionPeer);
             SSL_set_connect_state(m_pSSL);
             break;
         case TlsContext::Role::Server:
             SSL_set_accept_state(m_pSSL);
+            m_tlsDataSource.setReadingEarlyData(m_tlsContext.tlsConfiguration().maxEarlyDataSize() > 0 && m_tlsContext.sessionCache()->isEnabled());
             break;
     }
+    if (m_tlsContext.tlsConfiguration().kernelTlsEnabled())
+        m_kernelTls.attach(m_pSSL);
+    // Kernel TLS collects the connection's secrets in callbacks into the socket and early data is read
+    // while the handshake runs. Both keep handshakes on the socket's thread.
+    m_handshakeThreadCount = (m_tlsContext.role() == TlsContext::Role::Server
+                              && !m_tlsContext.tlsConfiguration().kernelTlsEnabled()
+                              && !m_tlsDataSource.isReadingEarlyData()) ? m_tlsContext.tlsConfiguration().handshakeThreadCount() : 0;
+    m_tlsDataSink.setDynamicRecordSizingEnabled(m_tlsContext.tlsConfiguration().dynamicRecordSizingEnabled());
     BIO_up_ref(m_encryptedIncomingDataBufferBIO.bio());
     BIO_up_ref(m_encryptedOutgoingDataBufferBIO.bio());
     SSL_set_bio(m_pSSL, m_encryptedIncomingDataBufferBIO.bio(), m_encryptedOutgoingDataBufferBIO.bio());
@@ -233,15 +355,45 @@ void TlsSocketPrivate::setupTls()
 
 void TlsSocketPrivate::abortTls()
 {
-    if (m_pSSL != nullptr)
+    m_kernelTls.detach();
+    // The SSL object of a running handshake step is released once the step finishes.
+    if (m_pHandshakeStep != nullptr)
+        TlsHandshakePool::cancelStep(std::exchange(m_pHandshakeStep, nullptr));
+    else if (m_pSSL != nullptr)
         SSL_free(m_pSSL);
     m_pSSL = nullptr;
+    m_handshakeThreadCount = 0;
+    m_tlsDataSource.setReadingEarlyData(false);
+    m_tlsDataSink.setDynamicRecordSizingEnabled(false);
     m_hasCompletedHandshake = false;
     m_handshakeTimer.stop();
     m_encryptedIncomingDataBufferBIO.ringBuffer().clear();
     m_encryptedOutgoingDataBufferBIO.ringBuffer().clear();
 }
 
+// The kernel can only take over the record layer at record boundaries. Both directions are handed over
+// once OpenSSL holds no received data and every record OpenSSL encrypted has been sent.
+void TlsSocketPrivate::tryToEnableKernelTls()
+{
+    if (m_hasCompletedHandshake
+        && m_kernelTls.isPending()
+        && m_encryptedIncomingDataBuffer.isEmpty()
+        && SSL_has_pending(m_pSSL) == 0
+        && m_encryptedOutgoingDataBuffer.isEmpty())
+        m_kernelTls.enable(m_socketDescriptor);
+}
+
+void TlsSocketPrivate::sendCloseNotify()
+{
+    if (m_kernelTls.isEnabled())
+        m_kernelTls.sendCloseNotify(m_socketDescriptor);
+    else if ((SSL_get_shutdown(m_pSSL) & SSL_SENT_SHUTDOWN) != SSL_SENT_SHUTDOWN)
+    {
+        SSL_shutdown(m_pSSL);
+        eventNotifier()->postEvent(this, EPOLLOUT);
+    }
+}
+
 void TlsSocketPrivate::onConnecting()
 {
     setupTls();
@@ -276,11 +428,7 @@ void TlsSocketPrivate::onEvent(uint32_t epollEvents)
                 sentDataSize = q->writeDataToChannel();
                 if (m_unencryptedOutgoingDataBuffer.isEmpty())
                 {
-                    if ((SSL_get_shutdown(m_pSSL) & SSL_SENT_SHUTDOWN) != SSL_SENT_SHUTDOWN)
-                    {
-                        SSL_shutdown(m_pSSL);
-                        eventNotifier()->postEvent(this, EPOLLOUT);
-                    }
+                    sendCloseNotify();
                     if (m_encryptedOutgoingDataBuffer.isEmpty())
                     {
                         q->setReadChannelNotificationEnabled(false);
@@ -340,7 +488,7 @@ void TlsSocketPrivate::onEvent(uint32_t epollEvents)
         }
         const auto contextId = m_contextId;
         if (receivedDataSize > 0)
-            q->receivedData();
+            sentDataSize += emitReceivedData();
         if (contextId == m_contextId && sentDataSize > 0 && hasCompletedHandshake)
             q->sentData(sentDataSize);
         if (contextId == m_contextId && hasDisconnected)
@@ -380,6 +528,13 @@ void TlsSocketPrivate::onEvent(uint32_t epollEvents)
     }
 }
 
+void TlsSocketPrivate::releaseDrainedBuffers()
+{
+    TcpSocketPrivate::releaseDrainedBuffers();
+    m_encryptedIncomingDataBuffer.releaseStorage();
+    m_encryptedOutgoingDataBuffer.releaseStorage();
+}
+
 void TlsSocketPrivate::onHandshakeTimeout()
 {
     const bool isIPv6 = (QHostAddress(QString::fromStdString(m_peerAddress)).protocol() == QAbstractSocket::IPv6Protocol);
@@ -417,6 +572,25 @@ TlsSocket::TlsSocket(int64_t socketDescriptor, const TlsConfiguration &tlsConfig
     TcpSocket(new TlsSocketPrivate(m_readBuffer, m_writeBuffer, tlsConfiguration, TlsContext::Role::Server))
 {
     d_ptr->q_ptr = this;
+    adoptSocketDescriptor(socketDescriptor);
+}
+
+TlsSocket::TlsSocket(int64_t socketDescriptor, const TlsContext &tlsContext) :
+    TcpSocket(new TlsSocketPrivate(m_readBuffer, m_writeBuffer, tlsContext))
+{
+    assert(!tlsContext.isNull() && tlsContext.role() == TlsContext::Role::Server);
+    d_ptr->q_ptr = this;
+    adoptSocketDescriptor(socketDescriptor);
+}
+
+TlsSocket::~TlsSocket()
+{
+    Q_D(TlsSocket);
+    d->abortTls();
+}
+
+void TlsSocket::adoptSocketDescriptor(int64_t socketDescriptor)
+{
     if (((TlsSocketPrivate*)d_ptr)->m_tlsErrorMessage.empty())
     {
         try
@@ -436,12 +610,6 @@ TlsSocket::TlsSocket(int64_t socketDescriptor, const TlsConfiguration &tlsConfig
     }
 }
 
-TlsSocket::~TlsSocket()
-{
-    Q_D(TlsSocket);
-    d->abortTls();
-}
-
 bool TlsSocket::isEncrypted() const
 {
     Q_D(const TlsSocket);
@@ -464,6 +632,20 @@ size_t TlsSocket::read(char *pBuffer, size_t maxSize)
     return bytesRead;
 }
 
+size_t TlsSocket::writev(const std::string_view *pSlices, size_t count)
+{
+    Q_D(TlsSocket);
+    // With kernel TLS, data is encrypted by the kernel and slices can be sent right away as in plain TCP.
+    if (d->m_kernelTls.isEnabled() && d->m_encryptedOutgoingDataBuffer.isEmpty())
+        return TcpSocket::writev(pSlices, count);
+    // Data is only encrypted when written to the channel, so slices are always buffered.
+    assert(pSlices != nullptr);
+    size_t bytesWritten = 0;
+    for (size_t i = 0; i < count; ++i)
+        bytesWritten += TcpSocket::write(pSlices[i]);
+    return bytesWritten;
+}
+
 std::string_view TlsSocket::readAll()
 {
     Q_D(TlsSocket);
@@ -484,6 +666,18 @@ size_t TlsSocket::skip(size_t maxSize)
     return poppedBytes;
 }
 
+bool TlsSocket::isSessionResumed() const
+{
+    Q_D(const TlsSocket);
+    return d->m_hasCompletedHandshake && SSL_session_reused(d->m_pSSL) == 1;
+}
+
+bool TlsSocket::isKernelTlsEnabled() const
+{
+    Q_D(const TlsSocket);
+    return d->m_kernelTls.isEnabled();
+}
+
 const TlsConfiguration &TlsSocket::tlsConfiguration() const
 {
     Q_D(const TlsSocket);
@@ -506,25 +700,72 @@ size_t TlsSocket::readDataFromChannel()
     Q_D(TlsSocket);
     if (d->m_unencryptedIncomingDataBuffer.isFull())
         return 0;
+    if (d->m_pHandshakeStep != nullptr)
+        return 0;
+    if (d->m_kernelTls.isEnabled())
+    {
+        // Incomplete records stay in the socket until the kernel can decrypt them. Read events are
+        // only posted after progress, so that waiting for the rest of a record does not spin.
+        const auto bytesRead = d->m_unencryptedIncomingDataBuffer.write(d->m_kernelTlsDataSource);
+        switch (d->m_kernelTlsDataSource.lastReceiveStatus())
+        {
+            case KernelTls::ReceiveStatus::Received:
+                if (bytesRead > 0 && dataSource().dataAvailable() > 0)
+                    d->eventNotifier()->postEvent(d, EPOLLIN);
+                break;
+            case KernelTls::ReceiveStatus::ReceivedCloseNotify:
+                disconnectFromPeer();
+                break;
+            case KernelTls::ReceiveStatus::WouldBlock:
+            case KernelTls::ReceiveStatus::EndOfStream:
+                break;
+        }
+        return bytesRead;
+    }
     const auto tlsDataSinkWasExpectingToRead = d->m_tlsDataSink.needsToRead();
     d->m_encryptedIncomingDataBuffer.write(dataSource());
-    if (dataSource().dataAvailable() > 0)
+    if (dataSource().mayHaveDataAvailable())
         d->eventNotifier()->postEvent(d, EPOLLIN);
+    // Handshake data is processed by the handshake pool.
+    if (d->m_handshakeThreadCount > 0 && !d->m_hasCompletedHandshake)
+        return 0;
     const auto encryptedOutgoingDataBufferPreviousSize = d->m_encryptedOutgoingDataBuffer.size();
     const auto bytesRead = d->m_unencryptedIncomingDataBuffer.write(d->m_tlsDataSource);
     if (tlsDataSinkWasExpectingToRead || (d->m_encryptedOutgoingDataBuffer.size() > encryptedOutgoingDataBufferPreviousSize))
         d->eventNotifier()->postEvent(d, EPOLLOUT);
     if (d->m_hasCompletedHandshake && ((SSL_get_shutdown(d->m_pSSL) & SSL_RECEIVED_SHUTDOWN) == SSL_RECEIVED_SHUTDOWN))
         disconnectFromPeer();
+    else if (d->m_kernelTls.isPending())
+        d->tryToEnableKernelTls();
     return bytesRead;
 }
 
 size_t TlsSocket::writeDataToChannel()
 {
     Q_D(TlsSocket);
+    if (d->m_pHandshakeStep != nullptr)
+    {
+        const size_t bytesWritten = d->m_encryptedOutgoingDataBuffer.isEmpty() ? 0 : d->m_encryptedOutgoingDataBuffer.read(dataSink());
+        d->m_hasAlreadyScheduledWriteEvent = false;
+        return bytesWritten;
+    }
+    if (d->m_kernelTls.isPending())
+        d->tryToEnableKernelTls();
+    if (d->m_kernelTls.isEnabled() && d->m_encryptedOutgoingDataBuffer.isEmpty())
+    {
+        const size_t bytesWritten = (d->m_unencryptedOutgoingDataBuffer.isEmpty() ? 0 : d->m_unencryptedOutgoingDataBuffer.read(dataSink()))
+                                    + std::exchange(d->m_directlySentDataSize, 0);
+        d->m_hasAlreadyScheduledWriteEvent = false;
+        return bytesWritten;
+    }
     if (d->m_hasCompletedHandshake && !d->m_unencryptedOutgoingDataBuffer.isEmpty())
         d->m_unencryptedOutgoingDataBuffer.read(d->m_tlsDataSink);
-    const size_t bytesWritten = d->m_encryptedOutgoingDataBuffer.isEmpty() ? 0 : d->m_encryptedOutgoingDataBuffer.read(dataSink());
+    const size_t bytesWritten = (d->m_encryptedOutgoingDataBuffer.isEmpty() ? 0 : d->m_encryptedOutgoingDataBuffer.read(dataSink()))
+                                + std::exchange(d->m_directlySentDataSize, 0);
+    if (d->m_kernelTls.isPending() && d->m_encryptedOutgoingDataBuffer.isEmpty())
+        d->tryToEnableKernelTls();
+    d->m_encryptedOutgoingDataBuffer.releaseStorage();
+    d->m_unencryptedOutgoingDataBuffer.releaseStorage();
     d->m_hasAlreadyScheduledWriteEvent = false;
     return bytesWritten;
 }
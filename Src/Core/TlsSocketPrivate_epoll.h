@@ -21,8 +21,10 @@
 #include "TlsSocket.h"
 #include "TcpSocketPrivate_epoll.h"
 #include "TlsContext.h"
+#include "KernelTls.h"
 #include "TlsSocketDataSink.h"
 #include "TlsSocketDataSource.h"
+#include "TlsHandshakePool.h"
 #include "RingBufferBIO.h"
 #include <openssl/ssl.h>
 
@@ -40,7 +42,11 @@ public:
                      RingBuffer &unencryptedOutgoingDataBuffer,
                      const TlsConfiguration &tlsConfiguration,
                      TlsContext::Role role);
+    TlsSocketPrivate(RingBuffer &unencryptedIncomingDataBuffer,
+                     RingBuffer &unencryptedOutgoingDataBuffer,
+                     const TlsContext &tlsContext);
     ~TlsSocketPrivate() override;
+    static TlsSocket *createServerSocket(int64_t socketDescriptor, const TlsContext &tlsContext);
     void connect(std::string_view host, uint16_t port) override;
     void disconnectFromPeer() override;
     void abort() override;
@@ -48,13 +54,21 @@ public:
     const TlsConfiguration &tlsConfiguration() const {return m_tlsContext.tlsConfiguration();}
 
 private:
+    bool canReceiveWithIoUring() const override {return false;}
     void onDisconnectTimeoutImpl() override;
     void doHandshake();
+    void processHandshakeResult(int result, int error);
+    [[noreturn]] void failHandshake();
+    void runHandshakeStepOnPool();
+    static void onHandshakeStepFinished(TlsHandshakeStep &handshakeStep, void *pReceiver);
     void setupTls();
     void abortTls();
+    void tryToEnableKernelTls();
+    void sendCloseNotify();
     void onConnecting() override;
     void onConnected() override;
     void onEvent(uint32_t epollEvents) override;
+    void releaseDrainedBuffers() override;
     void onHandshakeTimeout();
 
 private:
@@ -70,7 +84,13 @@ private:
     RingBuffer &m_encryptedOutgoingDataBuffer;
     TlsSocketDataSink m_tlsDataSink;
     TlsSocketDataSource m_tlsDataSource;
+    KernelTls m_kernelTls;
+    KernelTlsDataSource m_kernelTlsDataSource;
     std::string m_tlsErrorMessage;
+    std::string m_sessionPeer;
+    TlsHandshakeStep *m_pHandshakeStep = nullptr;
+    size_t m_handshakeThreadCount = 0;
+    size_t m_handshakeStepInputSize = 0;
     bool m_hasCompletedHandshake = false;
 };
 
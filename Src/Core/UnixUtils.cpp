@@ -16,7 +16,9 @@
 //
 
 #include "UnixUtils.h"
+#include <sys/sendfile.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 
@@ -120,4 +122,104 @@ size_t UnixUtils::safeSend(intptr_t fd, const char *pData, size_t count)
     return bytesWritten;
 }
 
+size_t UnixUtils::safeSendv(intptr_t fd, const std::string_view *pSlices, size_t count)
+{
+    assert(fd >= 0 && pSlices != nullptr);
+    static constexpr size_t maxVectorCount = 64;
+    size_t bytesWritten = 0;
+    size_t sliceIndex = 0;
+    size_t sliceOffset = 0;
+    while (sliceIndex < count)
+    {
+        iovec vectors[maxVectorCount];
+        int vectorCount = 0;
+        for (auto i = sliceIndex; i < count && vectorCount < (int)maxVectorCount; ++i)
+        {
+            const auto offset = (i == sliceIndex) ? sliceOffset : 0;
+            if (pSlices[i].size() > offset)
+            {
+                vectors[vectorCount].iov_base = const_cast<char*>(pSlices[i].data() + offset);
+                vectors[vectorCount++].iov_len = pSlices[i].size() - offset;
+            }
+        }
+        if (vectorCount == 0)
+            break;
+        msghdr message = {};
+        message.msg_iov = vectors;
+        message.msg_iovlen = vectorCount;
+        const ssize_t result = ::sendmsg(fd, &message, 0);
+        if (result > 0)
+        {
+            bytesWritten += result;
+            size_t bytesToSkip = result;
+            while (bytesToSkip > 0 && sliceIndex < count)
+            {
+                const auto sliceBytesLeft = pSlices[sliceIndex].size() - sliceOffset;
+                if (bytesToSkip >= sliceBytesLeft)
+                {
+                    bytesToSkip -= sliceBytesLeft;
+                    ++sliceIndex;
+                    sliceOffset = 0;
+                }
+                else
+                {
+                    sliceOffset += bytesToSkip;
+                    bytesToSkip = 0;
+                }
+            }
+        }
+        else
+        {
+            if (-1 == result && errno == EINTR)
+                continue;
+            else
+                return bytesWritten;
+        }
+    }
+    return bytesWritten;
+}
+
+size_t UnixUtils::safeSendFile(intptr_t socketFd, intptr_t fileFd, size_t offset, size_t count)
+{
+    assert(socketFd >= 0 && fileFd >= 0);
+    size_t bytesWritten = 0;
+    ssize_t result = 0;
+    while (bytesWritten < count)
+    {
+        off_t fileOffset = offset + bytesWritten;
+        result = ::sendfile(socketFd, fileFd, &fileOffset, count - bytesWritten);
+        if (result > 0)
+            bytesWritten += result;
+        else
+        {
+            if (-1 == result && errno == EINTR)
+                continue;
+            else
+                return bytesWritten;
+        }
+    }
+    return bytesWritten;
+}
+
+size_t UnixUtils::safeReadAt(intptr_t fd, char *pBuffer, size_t count, size_t offset)
+{
+    assert(fd >= 0 && pBuffer != nullptr);
+    size_t bytesRead = 0;
+    ssize_t result = 0;
+    while (bytesRead < count)
+    {
+        result = ::pread(fd, pBuffer + bytesRead, count - bytesRead, offset + bytesRead);
+        if (result > 0)
+            bytesRead += result;
+        else
+        {
+            if (-1 == result && errno == EINTR)
+                continue;
+            else
+                return bytesRead;
+        }
+    }
+    return bytesRead;
+}
+
 }
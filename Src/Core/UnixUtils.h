@@ -19,6 +19,7 @@
 #define KOURIER_UNIX_UTILS_H
 
 #include <QtGlobal>
+#include <string_view>
 
 
 namespace Kourier
@@ -31,6 +32,9 @@ struct UnixUtils
     static size_t safeReceive(intptr_t fd, char *pBuffer, size_t count);
     static size_t safeWrite(intptr_t fd, const char *pData, size_t count);
     static size_t safeSend(intptr_t fd, const char *pData, size_t count);
+    static size_t safeSendv(intptr_t fd, const std::string_view *pSlices, size_t count);
+    static size_t safeSendFile(intptr_t socketFd, intptr_t fileFd, size_t offset, size_t count);
+    static size_t safeReadAt(intptr_t fd, char *pBuffer, size_t count, size_t offset);
 
 private:
     UnixUtils() = delete;
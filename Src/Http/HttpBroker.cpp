@@ -330,6 +330,42 @@ Writes the last chunk to the peer if you initiated a chunked response by calling
 If \a trailers is not empty, HttpBroker writes a trailer section after the last chunk.
 */
 
+/*!
+\fn HttpBroker::writeFile(std::string_view filePath,
+                           size_t offset = 0,
+                           size_t length = std::numeric_limits<size_t>::max(),
+                           std::string_view mimeType = {})
+Writes a response with the contents of the file at \a filePath to the peer. HttpBroker sends \a length bytes
+of the file beginning at \a offset, or up to the end of the file if it is shorter. If \a mimeType is not empty,
+HttpBroker writes the <em>Content-Type</em> header. HttpBroker responds with <em>404 Not Found</em> if it cannot
+open \a filePath or if \a filePath does not refer to a regular file.
+
+HttpBroker derives the <em>ETag</em> and <em>Last-Modified</em> headers from the file's metadata and answers
+<em>If-None-Match</em> and <em>If-Modified-Since</em> conditional requests with <em>304 Not Modified</em>.
+HttpBroker honors single-range <em>Range</em> requests, relative to the selected part of the file, with
+<em>206 Partial Content</em> responses and replies with <em>416 Range Not Satisfiable</em> to unsatisfiable ranges.
+Requests for multiple ranges are served with the whole content.
+
+On unencrypted connections and on TLS connections encrypted by the kernel, HttpBroker uses sendfile(2) to send
+file contents without copying them to user space.
+File contents are sent as the peer consumes them and HttpBroker emits sentData() as they are sent. The response is
+complete only after the last byte of the file has been sent.
+
+If you call this method after writing the response, HttpBroker returns without writing another response.
+If you call this method while writing a chunked response, HttpBroker finishes the current chunked response
+and returns without writing another one.
+*/
+
+/*!
+\fn HttpBroker::writeFile(int fileDescriptor,
+                           size_t offset = 0,
+                           size_t length = std::numeric_limits<size_t>::max(),
+                           std::string_view mimeType = {})
+Writes a response with the contents of the file referred to by \a fileDescriptor to the peer.
+HttpBroker duplicates \a fileDescriptor and you remain responsible for closing it. This method
+behaves as writeFile(std::string_view filePath, size_t offset, size_t length, std::string_view mimeType).
+*/
+
 /*!
 \fn HttpBroker::bytesToSend()
 Returns the bytes pending to be sent to the peer. You can use sentData() and bytesToSend() to write
@@ -386,6 +422,8 @@ HttpBroker sets \a isLastPart to true if the request body has been fully receive
 For chunked requests, the last chunk is empty. Thus, \a data will be empty for
 chunked requests when \a isLastPart is true. In this case, you can call hasTrailers()
 to know if the peer sent a trailer section after the last chunk of the request.
+Data of chunks received together is given contiguously in a single \a data, so
+chunk boundaries are not preserved.
 */
 
 void HttpBroker::closeConnectionAfterResponding()
@@ -494,6 +532,18 @@ void HttpBroker::writeLastChunk(const std::vector<std::pair<std::string, std::st
     d->writeLastChunk(trailers);
 }
 
+void HttpBroker::writeFile(std::string_view filePath, size_t offset, size_t length, std::string_view mimeType)
+{
+    Q_D(HttpBroker);
+    d->writeFile(filePath, offset, length, mimeType);
+}
+
+void HttpBroker::writeFile(int fileDescriptor, size_t offset, size_t length, std::string_view mimeType)
+{
+    Q_D(HttpBroker);
+    d->writeFile(fileDescriptor, offset, length, mimeType);
+}
+
 size_t HttpBroker::bytesToSend() const
 {
     Q_D(const HttpBroker);
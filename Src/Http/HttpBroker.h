@@ -20,6 +20,7 @@
 
 #include "../Core/SDK.h"
 #include <initializer_list>
+#include <limits>
 #include <utility>
 #include <string>
 #include <string_view>
@@ -126,6 +127,14 @@ public:
     void writeChunk(std::string_view data);
     void writeLastChunk(std::initializer_list<std::pair<std::string, std::string>> trailers = {});
     void writeLastChunk(const std::vector<std::pair<std::string, std::string>> &trailers);
+    void writeFile(std::string_view filePath,
+                   size_t offset = 0,
+                   size_t length = std::numeric_limits<size_t>::max(),
+                   std::string_view mimeType = {});
+    void writeFile(int fileDescriptor,
+                   size_t offset = 0,
+                   size_t length = std::numeric_limits<size_t>::max(),
+                   std::string_view mimeType = {});
     size_t bytesToSend() const;
     bool hasTrailers() const;
     size_t trailersCount() const;
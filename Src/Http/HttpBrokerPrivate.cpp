@@ -20,15 +20,164 @@
 #include "../Core/TcpSocket.h"
 #include "../Core/NoDestroy.h"
 #include "../Core/Timer.h"
+#include "../Core/TlsSocket.h"
+#include "../Core/UnixUtils.h"
 #include <string>
 #include <QDateTime>
+#include <QTimeZone>
+#include <algorithm>
 #include <charconv>
+#include <cstring>
 #include <cstdio>
+#include <ctime>
+#include <limits>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <strings.h>
 
 
 namespace Kourier
 {
 
+namespace
+{
+
+std::string toHttpDate(const QDateTime &dateTimeUtc)
+{
+    QString date;
+    date.reserve(30);
+    const auto dateUtc = dateTimeUtc.date();
+    const auto timeUtc = dateTimeUtc.time();
+    const auto weekDay = dateUtc.dayOfWeek();
+    if (1 <= weekDay && weekDay <= 7 && dateUtc.isValid() && timeUtc.isValid())
+    {
+        std::string_view weekDayStrs[7] = {"Mon, ", "Tue, ", "Wed, ", "Thu, ", "Fri, ", "Sat, ", "Sun, "};
+        date.append(weekDayStrs[weekDay - 1])
+            .append(dateUtc.toString(Qt::RFC2822Date))
+            .append(" ")
+            .append(timeUtc.toString(Qt::RFC2822Date))
+            .append(" GMT");
+    }
+    return date.toStdString();
+}
+
+bool parseTwoDigits(std::string_view data, int &value)
+{
+    if (data.size() != 2 || data[0] < '0' || data[0] > '9' || data[1] < '0' || data[1] > '9')
+        return false;
+    value = (data[0] - '0') * 10 + (data[1] - '0');
+    return true;
+}
+
+// Parses IMF-fixdate (e.g. Sun, 06 Nov 1994 08:49:37 GMT), the only format HttpBroker generates.
+bool parseHttpDate(std::string_view date, time_t &secsSinceEpoch)
+{
+    static constexpr std::string_view months[12] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    if (date.size() != 29 || date.substr(3, 2) != ", " || date[7] != ' ' || date[11] != ' '
+        || date[16] != ' ' || date[19] != ':' || date[22] != ':' || date.substr(25) != " GMT")
+        return false;
+    std::tm dateTime = {};
+    int yearHigh = 0;
+    int yearLow = 0;
+    if (!parseTwoDigits(date.substr(5, 2), dateTime.tm_mday)
+        || !parseTwoDigits(date.substr(12, 2), yearHigh)
+        || !parseTwoDigits(date.substr(14, 2), yearLow)
+        || !parseTwoDigits(date.substr(17, 2), dateTime.tm_hour)
+        || !parseTwoDigits(date.substr(20, 2), dateTime.tm_min)
+        || !parseTwoDigits(date.substr(23, 2), dateTime.tm_sec))
+        return false;
+    dateTime.tm_mon = -1;
+    for (auto i = 0; i < 12; ++i)
+    {
+        if (date.substr(8, 3) == months[i])
+        {
+            dateTime.tm_mon = i;
+            break;
+        }
+    }
+    if (dateTime.tm_mon < 0 || dateTime.tm_mday < 1 || dateTime.tm_mday > 31
+        || dateTime.tm_hour > 23 || dateTime.tm_min > 59 || dateTime.tm_sec > 60)
+        return false;
+    dateTime.tm_year = yearHigh * 100 + yearLow - 1900;
+    secsSinceEpoch = ::timegm(&dateTime);
+    return secsSinceEpoch != (time_t)-1;
+}
+
+std::string_view trimmed(std::string_view data)
+{
+    while (!data.empty() && (data.front() == ' ' || data.front() == '\t'))
+        data.remove_prefix(1);
+    while (!data.empty() && (data.back() == ' ' || data.back() == '\t'))
+        data.remove_suffix(1);
+    return data;
+}
+
+// RFC9110 13.1.2. If-None-Match uses the weak comparison function.
+bool matchesAnyEntityTag(std::string_view entityTags, std::string_view entityTag)
+{
+    while (!entityTags.empty())
+    {
+        const auto commaIndex = entityTags.find(',');
+        auto candidate = trimmed(entityTags.substr(0, commaIndex));
+        entityTags.remove_prefix(commaIndex != std::string_view::npos ? commaIndex + 1 : entityTags.size());
+        if (candidate == "*")
+            return true;
+        if (candidate.starts_with("W/"))
+            candidate.remove_prefix(2);
+        if (candidate == entityTag)
+            return true;
+    }
+    return false;
+}
+
+bool parseByteOffset(std::string_view data, size_t &value)
+{
+    if (data.empty())
+        return false;
+    const auto result = std::from_chars(data.data(), data.data() + data.size(), value);
+    return result.ec == std::errc() && result.ptr == data.data() + data.size();
+}
+
+enum class RangeStatus {Ignored, Satisfiable, Unsatisfiable};
+
+// RFC9110 14.2. Only single byte ranges are served. Multiple ranges and malformed
+// Range headers are ignored and the whole content is sent with a 200 response.
+RangeStatus parseRange(std::string_view range, size_t contentSize, size_t &rangeStart, size_t &rangeSize)
+{
+    range = trimmed(range);
+    static constexpr std::string_view rangeUnit("bytes=");
+    if (range.size() <= rangeUnit.size() || strncasecmp(range.data(), rangeUnit.data(), rangeUnit.size()) != 0)
+        return RangeStatus::Ignored;
+    range = trimmed(range.substr(rangeUnit.size()));
+    const auto dashIndex = range.find('-');
+    if (dashIndex == std::string_view::npos || range.find(',') != std::string_view::npos)
+        return RangeStatus::Ignored;
+    const auto firstPos = range.substr(0, dashIndex);
+    const auto lastPos = range.substr(dashIndex + 1);
+    if (firstPos.empty())
+    {
+        size_t suffixLength = 0;
+        if (!parseByteOffset(lastPos, suffixLength))
+            return RangeStatus::Ignored;
+        if (suffixLength == 0 || contentSize == 0)
+            return RangeStatus::Unsatisfiable;
+        rangeSize = std::min(suffixLength, contentSize);
+        rangeStart = contentSize - rangeSize;
+        return RangeStatus::Satisfiable;
+    }
+    size_t first = 0;
+    size_t last = std::numeric_limits<size_t>::max();
+    if (!parseByteOffset(firstPos, first) || (!lastPos.empty() && !parseByteOffset(lastPos, last)) || last < first)
+        return RangeStatus::Ignored;
+    if (first >= contentSize)
+        return RangeStatus::Unsatisfiable;
+    rangeStart = first;
+    rangeSize = std::min(last, contentSize - 1) - first + 1;
+    return RangeStatus::Satisfiable;
+}
+
+}
+
 HttpBrokerPrivate::HttpBrokerPrivate(IOChannel *pIOChannel,
     HttpRequestParser *pRequestParser) :
     m_pIOChannel(pIOChannel),
@@ -40,6 +189,7 @@ HttpBrokerPrivate::HttpBrokerPrivate(IOChannel *pIOChannel,
 
 HttpBrokerPrivate::~HttpBrokerPrivate()
 {
+    stopWritingFile();
     if (m_pObject)
         m_pObject->deleteLater();
 }
@@ -48,10 +198,53 @@ void HttpBrokerPrivate::writeChunk(std::string_view data)
 {
     if (m_isWritingChunkedResponse && !data.empty())
     {
-        writeChunkMetadata(data.size());
-        m_pIOChannel->write(data);
-        m_pIOChannel->write("\r\n");
+        m_responseSlices.push_back(chunkMetadata(data.size()));
+        m_responseSlices.push_back(data);
+        m_responseSlices.push_back("\r\n");
+        writeResponseSlices();
+    }
+}
+
+void HttpBrokerPrivate::writeFile(std::string_view filePath, size_t offset, size_t length, std::string_view mimeType)
+{
+    if (m_wroteResponse || isWritingFile())
+        return;
+    if (m_isWritingChunkedResponse)
+    {
+        finishWritingChunkedResponse();
+        return;
+    }
+    const std::string path(filePath);
+    int fileDescriptor = -1;
+    do
+    {
+        fileDescriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    while (fileDescriptor < 0 && errno == EINTR);
+    if (fileDescriptor < 0)
+    {
+        writeResponse(HttpStatusCode::NotFound);
+        return;
+    }
+    doWriteFile(fileDescriptor, offset, length, mimeType);
+}
+
+void HttpBrokerPrivate::writeFile(int fileDescriptor, size_t offset, size_t length, std::string_view mimeType)
+{
+    if (m_wroteResponse || isWritingFile())
+        return;
+    if (m_isWritingChunkedResponse)
+    {
+        finishWritingChunkedResponse();
+        return;
     }
+    const int duplicatedFileDescriptor = (fileDescriptor >= 0) ? ::fcntl(fileDescriptor, F_DUPFD_CLOEXEC, 0) : -1;
+    if (duplicatedFileDescriptor < 0)
+    {
+        writeResponse(HttpStatusCode::NotFound);
+        return;
+    }
+    doWriteFile(duplicatedFileDescriptor, offset, length, mimeType);
 }
 
 size_t HttpBrokerPrivate::bytesToSend() const
@@ -92,9 +285,11 @@ void HttpBrokerPrivate::onSentData(size_t count)
 {
     if (m_pBroker)
         emit m_pBroker->sentData(count);
+    if (isWritingFile())
+        continueWritingFile();
 }
 
-void HttpBrokerPrivate::writeStatusLine(HttpStatusCode statusCode)
+std::string_view HttpBrokerPrivate::statusLine(HttpStatusCode statusCode)
 {
     struct StatusLines
     {
@@ -146,31 +341,32 @@ void HttpBrokerPrivate::writeStatusLine(HttpStatusCode statusCode)
         };
     };
     static constinit NoDestroy<StatusLines> statusLines;
-    m_pIOChannel->write(statusLines().statusLines[(size_t)statusCode]);
+    return statusLines().statusLines[(size_t)statusCode];
 }
 
-void HttpBrokerPrivate::writeContentLengthHeader(size_t size)
+std::string_view HttpBrokerPrivate::contentLengthHeader(size_t size)
 {
     static_assert(std::numeric_limits<size_t>::max() == 18446744073709551615ull);
-    char buffer[20];
-    std::to_chars_result result = std::to_chars(buffer, buffer + 20, size);
+    static constexpr std::string_view fieldName("Content-Length: ");
+    static_assert(sizeof(m_contentLengthHeader) >= (fieldName.size() + 20 + 2));
+    std::memcpy(m_contentLengthHeader, fieldName.data(), fieldName.size());
+    std::to_chars_result result = std::to_chars(m_contentLengthHeader + fieldName.size(), m_contentLengthHeader + fieldName.size() + 20, size);
     assert(result.ec == std::errc());
-    m_pIOChannel->write("Content-Length: ");
-    m_pIOChannel->write(buffer, result.ptr - buffer);
-    m_pIOChannel->write("\r\n");
+    std::memcpy(result.ptr, "\r\n", 2);
+    return std::string_view(m_contentLengthHeader, result.ptr + 2 - m_contentLengthHeader);
 }
 
-void HttpBrokerPrivate::writeChunkMetadata(size_t size)
+std::string_view HttpBrokerPrivate::chunkMetadata(size_t size)
 {
     static_assert(sizeof(size_t) == 8);
-    char buffer[16];
-    std::to_chars_result result = std::to_chars(buffer, buffer + 16, size, 16);
+    static_assert(sizeof(m_chunkMetadata) >= (16 + 2));
+    std::to_chars_result result = std::to_chars(m_chunkMetadata, m_chunkMetadata + 16, size, 16);
     assert(result.ec == std::errc());
-    m_pIOChannel->write(buffer, result.ptr - buffer);
-    m_pIOChannel->write("\r\n");
+    std::memcpy(result.ptr, "\r\n", 2);
+    return std::string_view(m_chunkMetadata, result.ptr + 2 - m_chunkMetadata);
 }
 
-void HttpBrokerPrivate::writeDateHeader()
+std::string_view HttpBrokerPrivate::dateHeader()
 {
     // RFC9110 5.6.7. Date/Time Formats
     // IMF-fixdate  = day-name "," SP date1 SP time-of-day SP GMT
@@ -200,59 +396,236 @@ void HttpBrokerPrivate::writeDateHeader()
     {
         firstRun() = false;
         dateTimeUtc() = new std::string;
-        *dateTimeUtc() = getCurrentDate();
+        *dateTimeUtc() = std::string("Date: ").append(getCurrentDate()).append("\r\n");
         dateTimeUpdater() = new Timer;
         dateTimeUpdater()->setSingleShot(false);
         Object::connect(dateTimeUpdater(), &Timer::timeout, []()
         {
             if (dateTimeUtc() != nullptr)
-                *dateTimeUtc() = getCurrentDate();
+                *dateTimeUtc() = std::string("Date: ").append(getCurrentDate()).append("\r\n");
         });
         dateTimeUpdater()->start(std::chrono::milliseconds(1000));
     }
     if (dateTimeUtc() != nullptr && !dateTimeUtc()->empty())
+        return *dateTimeUtc();
+    else
+    {
+        m_dateHeader = std::string("Date: ").append(getCurrentDate()).append("\r\n");
+        return m_dateHeader;
+    }
+}
+
+void HttpBrokerPrivate::finishWritingChunkedResponse()
+{
+    m_pIOChannel->write("0\r\n\r\n");
+    finishResponseWritingAndEmitWroteResponse();
+}
+
+std::string HttpBrokerPrivate::getCurrentDate()
+{
+    return toHttpDate(QDateTime::currentDateTimeUtc());
+}
+
+// Takes ownership of fileDescriptor. The header block is written right away and the file content
+// is sent as the channel drains, so that the file is never fully loaded into memory.
+void HttpBrokerPrivate::doWriteFile(int fileDescriptor, size_t offset, size_t length, std::string_view mimeType)
+{
+    struct stat fileStatus;
+    if (::fstat(fileDescriptor, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode))
+    {
+        UnixUtils::safeClose(fileDescriptor);
+        writeResponse(HttpStatusCode::NotFound);
+        return;
+    }
+    const size_t fileSize = fileStatus.st_size;
+    const size_t contentStart = std::min(offset, fileSize);
+    const size_t contentSize = std::min(length, fileSize - contentStart);
+    char entityTagBuffer[3 * 16 + 4];
+    char *pEntityTagEnd = entityTagBuffer;
+    *pEntityTagEnd++ = '"';
+    pEntityTagEnd = std::to_chars(pEntityTagEnd, entityTagBuffer + sizeof(entityTagBuffer), (uint64_t)fileStatus.st_mtim.tv_sec, 16).ptr;
+    *pEntityTagEnd++ = '-';
+    pEntityTagEnd = std::to_chars(pEntityTagEnd, entityTagBuffer + sizeof(entityTagBuffer), (uint64_t)fileStatus.st_mtim.tv_nsec, 16).ptr;
+    *pEntityTagEnd++ = '-';
+    pEntityTagEnd = std::to_chars(pEntityTagEnd, entityTagBuffer + sizeof(entityTagBuffer), (uint64_t)fileSize, 16).ptr;
+    *pEntityTagEnd++ = '"';
+    const std::string_view entityTag(entityTagBuffer, pEntityTagEnd - entityTagBuffer);
+    const std::string lastModified = toHttpDate(QDateTime::fromSecsSinceEpoch(fileStatus.st_mtim.tv_sec, QTimeZone::UTC));
+    const auto &request = m_pRequestParser->request();
+    const bool isHeadRequest = (request.method() == HttpRequest::Method::HEAD);
+    const bool isGetOrHeadRequest = isHeadRequest || (request.method() == HttpRequest::Method::GET);
+    // RFC9110 13.2.2. If-None-Match takes precedence over If-Modified-Since.
+    bool isNotModified = false;
+    if (isGetOrHeadRequest)
+    {
+        if (request.hasHeader("If-None-Match"))
+            isNotModified = matchesAnyEntityTag(request.header("If-None-Match"), entityTag);
+        else if (request.hasHeader("If-Modified-Since"))
+        {
+            time_t modifiedSince = 0;
+            if (parseHttpDate(trimmed(request.header("If-Modified-Since")), modifiedSince))
+                isNotModified = (fileStatus.st_mtim.tv_sec <= modifiedSince);
+        }
+    }
+    if (isNotModified)
+    {
+        UnixUtils::safeClose(fileDescriptor);
+        appendResponseHeaders(HttpStatusCode::NotModified);
+        appendField("ETag", entityTag);
+        appendField("Last-Modified", lastModified);
+        m_responseSlices.push_back("\r\n");
+        writeResponseSlices();
+        finishResponseWritingAndEmitWroteResponse();
+        return;
+    }
+    auto statusCode = HttpStatusCode::OK;
+    size_t rangeStart = 0;
+    size_t rangeSize = contentSize;
+    std::string contentRange;
+    if (request.method() == HttpRequest::Method::GET && request.hasHeader("Range"))
     {
-        m_pIOChannel->write("Date: ");
-        m_pIOChannel->write(*dateTimeUtc());
-        m_pIOChannel->write("\r\n");
+        // RFC9110 13.1.5. Range is ignored if If-Range does not match the current representation.
+        bool isRangeApplicable = true;
+        if (request.hasHeader("If-Range"))
+        {
+            const auto ifRange = trimmed(request.header("If-Range"));
+            time_t ifRangeDate = 0;
+            isRangeApplicable = ifRange.starts_with('"')
+                                    ? (ifRange == entityTag)
+                                    : (parseHttpDate(ifRange, ifRangeDate) && ifRangeDate == fileStatus.st_mtim.tv_sec);
+        }
+        if (isRangeApplicable)
+        {
+            switch (parseRange(request.header("Range"), contentSize, rangeStart, rangeSize))
+            {
+                case RangeStatus::Ignored:
+                    break;
+                case RangeStatus::Satisfiable:
+                    statusCode = HttpStatusCode::PartialContent;
+                    contentRange.append("bytes ")
+                        .append(std::to_string(rangeStart))
+                        .append("-")
+                        .append(std::to_string(rangeStart + rangeSize - 1))
+                        .append("/")
+                        .append(std::to_string(contentSize));
+                    break;
+                case RangeStatus::Unsatisfiable:
+                    UnixUtils::safeClose(fileDescriptor);
+                    contentRange.append("bytes */").append(std::to_string(contentSize));
+                    appendResponseHeaders(HttpStatusCode::RangeNotSatisfiable);
+                    m_responseSlices.push_back(contentLengthHeader(0));
+                    appendField("Content-Range", contentRange);
+                    m_responseSlices.push_back("\r\n");
+                    writeResponseSlices();
+                    finishResponseWritingAndEmitWroteResponse();
+                    return;
+            }
+        }
+    }
+    appendResponseHeaders(statusCode);
+    m_responseSlices.push_back(contentLengthHeader(rangeSize));
+    if (!mimeType.empty())
+        appendField("Content-Type", mimeType);
+    m_responseSlices.push_back("Accept-Ranges: bytes\r\n");
+    appendField("ETag", entityTag);
+    appendField("Last-Modified", lastModified);
+    if (!contentRange.empty())
+        appendField("Content-Range", contentRange);
+    m_responseSlices.push_back("\r\n");
+    if (isHeadRequest || rangeSize == 0)
+    {
+        writeResponseSlices();
+        UnixUtils::safeClose(fileDescriptor);
+        finishResponseWritingAndEmitWroteResponse();
+        return;
+    }
+    m_fileDescriptor = fileDescriptor;
+    m_fileOffset = contentStart + rangeStart;
+    m_fileBytesLeft = rangeSize;
+    if (canSendFile())
+    {
+        writeResponseSlices();
+        continueWritingFile();
     }
     else
     {
-        m_pIOChannel->write("Date: ");
-        m_pIOChannel->write(getCurrentDate());
-        m_pIOChannel->write("\r\n");
+        // The header block and the first file chunk are handed to the channel together,
+        // so that TLS sockets encrypt them into shared records sent with a single send.
+        IOChannel::WriteBatch writeBatch(*m_pIOChannel);
+        writeResponseSlices();
+        continueWritingFile();
     }
 }
 
-void HttpBrokerPrivate::writeServerHeader()
+bool HttpBrokerPrivate::canSendFile() const
 {
-    m_pIOChannel->write("Server: Kourier\r\n");
+    auto *pTlsSocket = m_pIOChannel->tryCast<TlsSocket*>();
+    return (m_pIOChannel->tryCast<TcpSocket*>() != nullptr) && (pTlsSocket == nullptr || pTlsSocket->isKernelTlsEnabled());
 }
 
-void HttpBrokerPrivate::finishWritingChunkedResponse()
+// File content is only sent after the channel flushes everything written before it. On plain TCP
+// sockets and on TLS sockets encrypting through the kernel, content goes from the page cache to the socket
+// with sendfile. When the socket cannot take more data, one chunk is buffered in the channel so that its
+// sentData signal resumes the transfer. Other TLS sockets need OpenSSL to encrypt the content and always
+// have it buffered chunk by chunk. A chunk written during a write batch joins the data already batched.
+void HttpBrokerPrivate::continueWritingFile()
 {
-    m_pIOChannel->write("0\r\n\r\n");
-    finishResponseWritingAndEmitWroteResponse();
+    static constexpr size_t fileChunkSize = 65536;
+    if (m_isContinuingFileWriting)
+        return;
+    m_isContinuingFileWriting = true;
+    auto *pSocket = m_pIOChannel->tryCast<TcpSocket*>();
+    const bool canSendFile = this->canSendFile();
+    const bool joinsWriteBatch = !canSendFile && m_pIOChannel->isBatchingWrites();
+    while (isWritingFile() && m_fileBytesLeft > 0 && (m_pIOChannel->dataToWrite() == 0 || joinsWriteBatch))
+    {
+        if (canSendFile)
+        {
+            const auto bytesSent = UnixUtils::safeSendFile(pSocket->fileDescriptor(), m_fileDescriptor, m_fileOffset, m_fileBytesLeft);
+            m_fileOffset += bytesSent;
+            m_fileBytesLeft -= bytesSent;
+            if (bytesSent > 0 && m_pBroker)
+                emit m_pBroker->sentData(bytesSent);
+            if (m_fileBytesLeft == 0 || !isWritingFile())
+                break;
+        }
+        if (!m_pFileChunk)
+            m_pFileChunk.reset(new char[fileChunkSize]);
+        const auto bytesToRead = std::min(m_fileBytesLeft, fileChunkSize);
+        const auto bytesRead = UnixUtils::safeReadAt(m_fileDescriptor, m_pFileChunk.get(), bytesToRead, m_fileOffset);
+        if (bytesRead != bytesToRead)
+        {
+            // The file was truncated after the header block has been written. The promised
+            // content length cannot be honored anymore and the connection must be dropped.
+            stopWritingFile();
+            m_isContinuingFileWriting = false;
+            if (pSocket)
+                pSocket->abort();
+            return;
+        }
+        m_fileOffset += bytesRead;
+        m_fileBytesLeft -= bytesRead;
+        m_pIOChannel->write(m_pFileChunk.get(), bytesRead);
+        if (joinsWriteBatch)
+            break;
+    }
+    m_isContinuingFileWriting = false;
+    if (isWritingFile() && m_fileBytesLeft == 0)
+    {
+        stopWritingFile();
+        finishResponseWritingAndEmitWroteResponse();
+    }
 }
 
-std::string HttpBrokerPrivate::getCurrentDate()
+void HttpBrokerPrivate::stopWritingFile()
 {
-    QString date;
-    date.reserve(30);
-    const auto dateTimeUtc = QDateTime::currentDateTimeUtc();
-    const auto dateUtc = dateTimeUtc.date();
-    const auto timeUtc = dateTimeUtc.time();
-    const auto weekDay = dateUtc.dayOfWeek();
-    if (1 <= weekDay && weekDay <= 7 && dateUtc.isValid() && timeUtc.isValid())
+    if (m_fileDescriptor >= 0)
     {
-        std::string_view weekDayStrs[7] = {"Mon, ", "Tue, ", "Wed, ", "Thu, ", "Fri, ", "Sat, ", "Sun, "};
-        date.append(weekDayStrs[weekDay - 1])
-            .append(dateUtc.toString(Qt::RFC2822Date))
-            .append(" ")
-            .append(timeUtc.toString(Qt::RFC2822Date))
-            .append(" GMT");
+        UnixUtils::safeClose(m_fileDescriptor);
+        m_fileDescriptor = -1;
     }
-    return date.toStdString();
+    m_fileOffset = 0;
+    m_fileBytesLeft = 0;
 }
 
 void HttpBrokerPrivate::finishResponseWritingAndEmitWroteResponse()
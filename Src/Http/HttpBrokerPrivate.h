@@ -23,8 +23,10 @@
 #include "../Core/Object.h"
 #include <QObject>
 #include <initializer_list>
+#include <memory>
 #include <utility>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Test::HttpBrokerPrivate {class TestHttpBrokerPrivate;}
@@ -78,6 +80,8 @@ public:
     void writeChunk(std::string_view data);
     void writeLastChunk(std::initializer_list<std::pair<std::string, std::string>> trailers = {}) {doWriteLastChunk(trailers.begin(), trailers.end());}
     void writeLastChunk(const std::vector<std::pair<std::string, std::string>> &trailers) {doWriteLastChunk(trailers.begin(), trailers.end());}
+    void writeFile(std::string_view filePath, size_t offset, size_t length, std::string_view mimeType);
+    void writeFile(int fileDescriptor, size_t offset, size_t length, std::string_view mimeType);
     size_t bytesToSend() const;
     bool hasTrailers() const {return trailersCount() > 0;}
     size_t trailersCount() const;
@@ -90,6 +94,7 @@ public:
     inline void setConnected(bool connected) {m_isConnected = connected;}
     inline void resetResponseWriting()
     {
+        stopWritingFile();
         if (!m_hasWrittenCloseConnectionHeader)
             m_wroteResponse = false;
         if (m_pBroker && m_isConnected)
@@ -100,28 +105,55 @@ public:
         m_pObject = nullptr;
     }
     inline bool responded() const {return m_wroteResponse;}
+    inline bool isWritingFile() const {return m_fileDescriptor >= 0;}
     inline void setBroker(HttpBroker *pBroker) {m_pBroker = pBroker;}
 
 private:
     void onSentData(size_t count);
-    void writeStatusLine(HttpStatusCode statusCode);
-    void writeContentLengthHeader(size_t size);
-    void writeChunkMetadata(size_t size);
-    void writeDateHeader();
-    inline void writeCloseConnectionHeaderIfNecessary()
+    static std::string_view statusLine(HttpStatusCode statusCode);
+    std::string_view contentLengthHeader(size_t size);
+    std::string_view chunkMetadata(size_t size);
+    std::string_view dateHeader();
+    inline void writeStatusLine(HttpStatusCode statusCode) {m_pIOChannel->write(statusLine(statusCode));}
+    inline void writeContentLengthHeader(size_t size) {m_pIOChannel->write(contentLengthHeader(size));}
+    inline void writeChunkMetadata(size_t size) {m_pIOChannel->write(chunkMetadata(size));}
+    inline void writeDateHeader() {m_pIOChannel->write(dateHeader());}
+    inline void writeServerHeader() {m_pIOChannel->write(serverHeader());}
+    static constexpr std::string_view serverHeader() {return "Server: Kourier\r\n";}
+    inline void appendResponseHeaders(HttpStatusCode statusCode)
     {
+        m_responseSlices.push_back(statusLine(statusCode));
+        m_responseSlices.push_back(serverHeader());
+        m_responseSlices.push_back(dateHeader());
         if (m_closeAfterResponding)
         {
             m_hasWrittenCloseConnectionHeader = true;
-            m_pIOChannel->write("Connection: close\r\n");
+            m_responseSlices.push_back("Connection: close\r\n");
         }
     }
-    void writeServerHeader();
+    inline void appendField(std::string_view name, std::string_view value)
+    {
+        m_responseSlices.push_back(name);
+        m_responseSlices.push_back(": ");
+        m_responseSlices.push_back(value);
+        m_responseSlices.push_back("\r\n");
+    }
+    inline void writeResponseSlices()
+    {
+        m_pIOChannel->writev(m_responseSlices.data(), m_responseSlices.size());
+        m_responseSlices.clear();
+    }
     void finishWritingChunkedResponse();
+    void doWriteFile(int fileDescriptor, size_t offset, size_t length, std::string_view mimeType);
+    void continueWritingFile();
+    bool canSendFile() const;
+    void stopWritingFile();
     static std::string getCurrentDate();
     void finishResponseWritingAndEmitWroteResponse();
 
 private:
+    // Responses are gathered as slices and handed to the IOChannel with a single writev call.
+    // Slices reference the caller's data, which is copied at most once, when it cannot be sent right away.
     template<class ItType>
     inline void doWriteResponse(std::string_view body,
         std::string_view mimeType,
@@ -129,37 +161,23 @@ private:
         const ItType itBegin,
         const ItType itEnd)
     {
-        if (m_wroteResponse)
+        if (m_wroteResponse || isWritingFile())
             return;
         if (m_isWritingChunkedResponse)
         {
             finishWritingChunkedResponse();
             return;
         }
-        writeStatusLine(statusCode);
-        writeServerHeader();
-        writeDateHeader();
-        writeCloseConnectionHeaderIfNecessary();
-        if (!body.empty())
-            writeContentLengthHeader(body.size());
-        else
-            m_pIOChannel->write("Content-Length: 0\r\n");
+        appendResponseHeaders(statusCode);
+        m_responseSlices.push_back(contentLengthHeader(body.size()));
         if (!mimeType.empty())
-        {
-            m_pIOChannel->write("Content-Type: ");
-            m_pIOChannel->write(mimeType);
-            m_pIOChannel->write("\r\n");
-        }
+            appendField("Content-Type", mimeType);
         for (auto it = itBegin; it != itEnd; ++it)
-        {
-            m_pIOChannel->write(it->first);
-            m_pIOChannel->write(": ");
-            m_pIOChannel->write(it->second);
-            m_pIOChannel->write("\r\n");
-        }
-        m_pIOChannel->write("\r\n");
+            appendField(it->first, it->second);
+        m_responseSlices.push_back("\r\n");
         if (!body.empty())
-            m_pIOChannel->write(body);
+            m_responseSlices.push_back(body);
+        writeResponseSlices();
         finishResponseWritingAndEmitWroteResponse();
     }
 
@@ -171,7 +189,7 @@ private:
         const ItTrailerType itTrailerBegin,
         const ItTrailerType itTrailerEnd)
     {
-        if (m_wroteResponse)
+        if (m_wroteResponse || isWritingFile())
             return;
         if (m_isWritingChunkedResponse)
         {
@@ -179,37 +197,26 @@ private:
             return;
         }
         m_isWritingChunkedResponse = true;
-        writeStatusLine(statusCode);
-        writeServerHeader();
-        writeDateHeader();
-        writeCloseConnectionHeaderIfNecessary();
+        appendResponseHeaders(statusCode);
         if (!mimeType.empty())
-        {
-            m_pIOChannel->write("Content-Type: ");
-            m_pIOChannel->write(mimeType);
-            m_pIOChannel->write("\r\n");
-        }
-        m_pIOChannel->write("Transfer-Encoding: chunked\r\n");
+            appendField("Content-Type", mimeType);
+        m_responseSlices.push_back("Transfer-Encoding: chunked\r\n");
         if (itTrailerBegin != itTrailerEnd)
         {
-            m_pIOChannel->write("Trailer: ");
-            m_pIOChannel->write(*itTrailerBegin);
+            m_responseSlices.push_back("Trailer: ");
+            m_responseSlices.push_back(*itTrailerBegin);
             auto it = itTrailerBegin;
             while (++it != itTrailerEnd)
             {
-                m_pIOChannel->write(", ");
-                m_pIOChannel->write(*it);
+                m_responseSlices.push_back(", ");
+                m_responseSlices.push_back(*it);
             }
-            m_pIOChannel->write("\r\n");
+            m_responseSlices.push_back("\r\n");
         }
         for (auto it = itHeaderBegin; it != itHeaderEnd; ++it)
-        {
-            m_pIOChannel->write(it->first);
-            m_pIOChannel->write(": ");
-            m_pIOChannel->write(it->second);
-            m_pIOChannel->write("\r\n");
-        }
-        m_pIOChannel->write("\r\n");
+            appendField(it->first, it->second);
+        m_responseSlices.push_back("\r\n");
+        writeResponseSlices();
     }
 
     template<class ItTrailerType>
@@ -218,15 +225,11 @@ private:
         if (!m_isWritingChunkedResponse)
             return;
         m_isWritingChunkedResponse = false;
-        m_pIOChannel->write("0\r\n");
+        m_responseSlices.push_back("0\r\n");
         for (auto it = itTrailerBegin; it != itTrailerEnd; ++it)
-        {
-            m_pIOChannel->write(it->first);
-            m_pIOChannel->write(": ");
-            m_pIOChannel->write(it->second);
-            m_pIOChannel->write("\r\n");
-        }
-        m_pIOChannel->write("\r\n");
+            appendField(it->first, it->second);
+        m_responseSlices.push_back("\r\n");
+        writeResponseSlices();
         finishResponseWritingAndEmitWroteResponse();
     }
 
@@ -240,6 +243,15 @@ private:
     bool m_closeAfterResponding = false;
     bool m_hasWrittenCloseConnectionHeader = false;
     bool m_isConnected = false;
+    std::vector<std::string_view> m_responseSlices;
+    int m_fileDescriptor = -1;
+    size_t m_fileOffset = 0;
+    size_t m_fileBytesLeft = 0;
+    bool m_isContinuingFileWriting = false;
+    std::unique_ptr<char[]> m_pFileChunk;
+    std::string m_dateHeader;
+    char m_contentLengthHeader[40];
+    char m_chunkMetadata[18];
     friend class HttpConnectionHandler;
     friend class Test::HttpBrokerPrivate::TestHttpBrokerPrivate;
 };
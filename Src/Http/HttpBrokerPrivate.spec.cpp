@@ -18,11 +18,21 @@
 #include "HttpBrokerPrivate.h"
 #include "Http/HttpRequestParser.h"
 #include "../Core/IOChannel.h"
+#include "../Core/TcpSocket.h"
+#include "../Core/TlsSocket.h"
+#include "../Core/TlsConfiguration.h"
+#include <Tests/Resources/TcpServer.h>
+#include <Tests/Resources/TlsServer.h>
+#include <Tests/Resources/TlsTestCertificates.h>
 #include <Spectator>
 #include <QDateTime>
+#include <QSemaphore>
+#include <QTemporaryFile>
+#include <limits>
 #include <list>
 #include <initializer_list>
 #include <memory>
+#include <tuple>
 
 
 using Kourier::HttpBrokerPrivate;
@@ -34,6 +44,12 @@ using Kourier::DataSink;
 using Kourier::HttpRequestParser;
 using Kourier::HttpRequestLimits;
 using Kourier::Object;
+using Kourier::TcpSocket;
+using Kourier::TlsSocket;
+using Kourier::TlsConfiguration;
+using Kourier::TcpServer;
+using Kourier::TlsServer;
+using Kourier::TestResources::TlsTestCertificates;
 
 namespace Test::HttpBrokerPrivate
 {
@@ -70,6 +86,13 @@ public:
     RingBuffer &writeBuffer() {return m_writeBuffer;}
     bool &isReadNotificationEnabled() {return m_isReadNotificationEnabled;}
     bool &isWriteNotificationEnabled() {return m_isWriteNotificationEnabled;}
+    std::string drainWriteBuffer()
+    {
+        std::string data(m_writeBuffer.readAll());
+        if (!data.empty())
+            sentData(data.size());
+        return data;
+    }
 
 private:
     DataSource &dataSource() override {std::abort();}
@@ -1526,3 +1549,283 @@ SCENARIO("HttpBrokerPrivate deletes any previously set QObject when setting new
         }
     }
 }
+
+SCENARIO("HttpBrokerPrivate writes files honoring ranges and conditional requests")
+{
+    GIVEN("a private broker and a file")
+    {
+        std::string fileContent;
+        fileContent.reserve(200000);
+        for (auto i = 0; i < 200000; ++i)
+            fileContent.push_back('a' + (i % 26));
+        QTemporaryFile file;
+        REQUIRE(file.open());
+        REQUIRE(file.write(fileContent.data(), fileContent.size()) == qint64(fileContent.size()));
+        REQUIRE(file.flush());
+        const std::string filePath = file.fileName().toStdString();
+        IOChannelTest ioChannel;
+        HttpRequestParser parser(ioChannel, std::make_shared<HttpRequestLimits>());
+        HttpBrokerPrivate brokerPrivate(&ioChannel, &parser);
+        size_t wroteResponseEmissionCounter = 0;
+        Object::connect(&brokerPrivate, &HttpBrokerPrivate::wroteResponse, [&wroteResponseEmissionCounter](){++wroteResponseEmissionCounter;});
+        auto parseRequest = [&](std::string_view request)
+        {
+            ioChannel.readBuffer().write(request);
+            return parser.parse();
+        };
+        auto receiveResponse = [&]() -> std::string
+        {
+            std::string response;
+            while (wroteResponseEmissionCounter == 0)
+            {
+                const auto data = ioChannel.drainWriteBuffer();
+                if (data.empty())
+                    break;
+                response.append(data);
+            }
+            response.append(ioChannel.drainWriteBuffer());
+            return response;
+        };
+        auto headerValue = [](std::string_view response, std::string_view name) -> std::string
+        {
+            const auto headerBlock = response.substr(0, response.find("\r\n\r\n") + 2);
+            const auto index = headerBlock.find(std::string("\r\n").append(name).append(": "));
+            if (index == std::string_view::npos)
+                return {};
+            const auto valueIndex = index + 4 + name.size();
+            return std::string(headerBlock.substr(valueIndex, headerBlock.find("\r\n", valueIndex) - valueIndex));
+        };
+        auto body = [](std::string_view response) {return response.substr(response.find("\r\n\r\n") + 4);};
+
+        WHEN("file is requested")
+        {
+            REQUIRE(parseRequest("GET /file HTTP/1.1\r\nHost: localhost\r\n\r\n") == HttpRequestParser::ParserStatus::ParsedRequest);
+            brokerPrivate.writeFile(filePath, 0, std::numeric_limits<size_t>::max(), "text/plain");
+            REQUIRE(brokerPrivate.isWritingFile());
+            const auto response = receiveResponse();
+
+            THEN("broker writes the whole file in a 200 response")
+            {
+                REQUIRE(wroteResponseEmissionCounter == 1);
+                REQUIRE(!brokerPrivate.isWritingFile());
+                REQUIRE(response.starts_with("HTTP/1.1 200 OK\r\n"));
+                REQUIRE(headerValue(response, "Content-Length") == std::to_string(fileContent.size()));
+                REQUIRE(headerValue(response, "Content-Type") == "text/plain");
+                REQUIRE(headerValue(response, "Accept-Ranges") == "bytes");
+                REQUIRE(!headerValue(response, "ETag").empty());
+                REQUIRE(!headerValue(response, "Last-Modified").empty());
+                REQUIRE(body(response) == fileContent);
+
+                AND_WHEN("file is requested again with matching If-None-Match")
+                {
+                    brokerPrivate.resetResponseWriting();
+                    wroteResponseEmissionCounter = 0;
+                    REQUIRE(parseRequest(std::string("GET /file HTTP/1.1\r\nHost: localhost\r\nIf-None-Match: ").append(headerValue(response, "ETag")).append("\r\n\r\n")) == HttpRequestParser::ParserStatus::ParsedRequest);
+                    brokerPrivate.writeFile(filePath, 0, std::numeric_limits<size_t>::max(), "text/plain");
+
+                    THEN("broker writes a 304 response without body")
+                    {
+                        const auto notModifiedResponse = receiveResponse();
+                        REQUIRE(notModifiedResponse.starts_with("HTTP/1.1 304 Not Modified\r\n"));
+                        REQUIRE(notModifiedResponse.ends_with("\r\n\r\n"));
+                        REQUIRE(headerValue(notModifiedResponse, "ETag") == headerValue(response, "ETag"));
+                    }
+                }
+
+                AND_WHEN("file is requested again with If-Modified-Since set to Last-Modified")
+                {
+                    brokerPrivate.resetResponseWriting();
+                    wroteResponseEmissionCounter = 0;
+                    REQUIRE(parseRequest(std::string("GET /file HTTP/1.1\r\nHost: localhost\r\nIf-Modified-Since: ").append(headerValue(response, "Last-Modified")).append("\r\n\r\n")) == HttpRequestParser::ParserStatus::ParsedRequest);
+                    brokerPrivate.writeFile(filePath, 0, std::numeric_limits<size_t>::max(), "text/plain");
+
+                    THEN("broker writes a 304 response")
+                    {
+                        REQUIRE(receiveResponse().starts_with("HTTP/1.1 304 Not Modified\r\n"));
+                    }
+                }
+            }
+        }
+
+        WHEN("a range of the file is requested")
+        {
+            const auto rangeAndExpectedContent = GENERATE(AS(std::tuple<std::string_view, size_t, size_t>),
+                                                          {"bytes=0-99", 0, 100},
+                                                          {"bytes=150000-", 150000, 50000},
+                                                          {"bytes=-10", 199990, 10},
+                                                          {"bytes=199000-500000", 199000, 1000});
+            REQUIRE(parseRequest(std::string("GET /file HTTP/1.1\r\nHost: localhost\r\nRange: ").append(std::get<0>(rangeAndExpectedContent)).append("\r\n\r\n")) == HttpRequestParser::ParserStatus::ParsedRequest);
+            brokerPrivate.writeFile(filePath, 0, std::numeric_limits<size_t>::max(), {});
+            const auto response = receiveResponse();
+
+            THEN("broker writes the requested range in a 206 response")
+            {
+                const auto start = std::get<1>(rangeAndExpectedContent);
+                const auto size = std::get<2>(rangeAndExpectedContent);
+                REQUIRE(response.starts_with("HTTP/1.1 206 Partial Content\r\n"));
+                REQUIRE(headerValue(response, "Content-Length") == std::to_string(size));
+                REQUIRE(headerValue(response, "Content-Range") == std::string("bytes ").append(std::to_string(start)).append("-").append(std::to_string(start + size - 1)).append("/200000"));
+                REQUIRE(body(response) == std::string_view(fileContent).substr(start, size));
+            }
+        }
+
+        WHEN("an unsatisfiable range is requested")
+        {
+            REQUIRE(parseRequest("GET /file HTTP/1.1\r\nHost: localhost\r\nRange: bytes=200000-\r\n\r\n") == HttpRequestParser::ParserStatus::ParsedRequest);
+            brokerPrivate.writeFile(filePath, 0, std::numeric_limits<size_t>::max(), {});
+            const auto response = receiveResponse();
+
+            THEN("broker writes a 416 response")
+            {
+                REQUIRE(response.starts_with("HTTP/1.1 416 Range Not Satisfiable\r\n"));
+                REQUIRE(headerValue(response, "Content-Range") == "bytes */200000");
+                REQUIRE(body(response).empty());
+            }
+        }
+
+        WHEN("multiple ranges are requested")
+        {
+            REQUIRE(parseRequest("GET /file HTTP/1.1\r\nHost: localhost\r\nRange: bytes=0-9,20-29\r\n\r\n") == HttpRequestParser::ParserStatus::ParsedRequest);
+            brokerPrivate.writeFile(filePath, 100, 50, {});
+            const auto response = receiveResponse();
+
+            THEN("broker ignores the range and writes the selected part of the file")
+            {
+                REQUIRE(response.starts_with("HTTP/1.1 200 OK\r\n"));
+                REQUIRE(body(response) == std::string_view(fileContent).substr(100, 50));
+            }
+        }
+
+        WHEN("file is requested with HEAD")
+        {
+            REQUIRE(parseRequest("HEAD /file HTTP/1.1\r\nHost: localhost\r\n\r\n") == HttpRequestParser::ParserStatus::ParsedRequest);
+            brokerPrivate.writeFile(file.handle(), 0, std::numeric_limits<size_t>::max(), {});
+            const auto response = receiveResponse();
+
+            THEN("broker writes the header block only")
+            {
+                REQUIRE(response.starts_with("HTTP/1.1 200 OK\r\n"));
+                REQUIRE(headerValue(response, "Content-Length") == "200000");
+                REQUIRE(body(response).empty());
+            }
+        }
+
+        WHEN("a missing file is requested")
+        {
+            REQUIRE(parseRequest("GET /file HTTP/1.1\r\nHost: localhost\r\n\r\n") == HttpRequestParser::ParserStatus::ParsedRequest);
+            brokerPrivate.writeFile(std::string(filePath).append(".missing"), 0, std::numeric_limits<size_t>::max(), {});
+
+            THEN("broker writes a 404 response")
+            {
+                REQUIRE(receiveResponse().starts_with("HTTP/1.1 404 Not Found\r\n"));
+            }
+        }
+    }
+}
+
+
+SCENARIO("HttpBrokerPrivate sends files over connected sockets")
+{
+    GIVEN("a file and a server whose peers respond to requests with the file")
+    {
+        const auto usesTls = GENERATE(AS(bool), false, true);
+        const auto [range, rangeStart, rangeSize] = GENERATE(AS(std::tuple<std::string_view, size_t, size_t>),
+                                                             {"", 0, 4 * 1024 * 1024},
+                                                             {"bytes=1000001-3000000", 1000001, 2000000});
+        std::string fileContent;
+        fileContent.reserve(4 * 1024 * 1024);
+        for (size_t i = 0; i < 4 * 1024 * 1024; ++i)
+            fileContent.push_back('a' + (i % 26));
+        QTemporaryFile file;
+        REQUIRE(file.open());
+        REQUIRE(file.write(fileContent.data(), fileContent.size()) == qint64(fileContent.size()));
+        REQUIRE(file.flush());
+        const std::string filePath = file.fileName().toStdString();
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(TlsTestCertificates::CertificateType::ECDSA, certificateFile, privateKeyFile, caCertificateFile);
+        // Server peers send files with sendfile on plain sockets and on TLS sockets whose
+        // kernel encrypts the data. Other TLS sockets send files through OpenSSL.
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+        serverTlsConfiguration.setKernelTlsEnabled(true);
+        TcpServer tcpServer;
+        TlsServer tlsServer(serverTlsConfiguration);
+        std::unique_ptr<TcpSocket> pServerPeer;
+        std::unique_ptr<HttpRequestParser> pServerPeerParser;
+        std::unique_ptr<HttpBrokerPrivate> pServerPeerBroker;
+        bool serverPeerWasWritingFileAfterRequest = false;
+        size_t serverPeerSentFileCount = 0;
+        auto onNewConnection = [&](TcpSocket *pSocket)
+        {
+            REQUIRE(!pServerPeer);
+            pServerPeer.reset(pSocket);
+            // Small socket buffers make sendfile send only part of the file on each call.
+            pServerPeer->setSocketOption(TcpSocket::SocketOption::SendBufferSize, 16384);
+            pServerPeerParser.reset(new HttpRequestParser(*pServerPeer, std::make_shared<HttpRequestLimits>()));
+            pServerPeerBroker.reset(new HttpBrokerPrivate(pServerPeer.get(), pServerPeerParser.get()));
+            Object::connect(pServerPeerBroker.get(), &HttpBrokerPrivate::wroteResponse, [&](){++serverPeerSentFileCount;});
+            Object::connect(pServerPeer.get(), &TcpSocket::receivedData, [&]()
+            {
+                if (pServerPeerParser->parse() == HttpRequestParser::ParserStatus::ParsedRequest)
+                {
+                    pServerPeerBroker->writeFile(filePath, 0, std::numeric_limits<size_t>::max(), "text/plain");
+                    serverPeerWasWritingFileAfterRequest = pServerPeerBroker->isWritingFile();
+                }
+            });
+        };
+        Object::connect(&tcpServer, &TcpServer::newConnection, [&](TcpSocket *pSocket){onNewConnection(pSocket);});
+        Object::connect(&tlsServer, &TlsServer::newConnection, [&](TlsSocket *pSocket){onNewConnection(pSocket);});
+        REQUIRE(usesTls ? tlsServer.listen(QHostAddress::LocalHost) : tcpServer.listen(QHostAddress::LocalHost));
+        const auto serverPort = usesTls ? tlsServer.serverPort() : tcpServer.serverPort();
+
+        WHEN("a client with a small receive buffer requests the file")
+        {
+            TlsConfiguration clientTlsConfiguration;
+            clientTlsConfiguration.addCaCertificate(caCertificateFile);
+            clientTlsConfiguration.setTlsVersion(TlsConfiguration::TlsVersion::TLS_1_3);
+            std::unique_ptr<TcpSocket> pClientPeer(usesTls ? new TlsSocket(clientTlsConfiguration) : new TcpSocket);
+            std::string request("GET /file HTTP/1.1\r\nHost: localhost\r\n");
+            if (!range.empty())
+                request.append("Range: ").append(range).append("\r\n");
+            request.append("\r\n");
+            std::string response;
+            size_t responseSize = 0;
+            QSemaphore clientPeerReceivedResponseSemaphore;
+            Object::connect(pClientPeer.get(), &TcpSocket::connected, [&]()
+            {
+                pClientPeer->setSocketOption(TcpSocket::SocketOption::ReceiveBufferSize, 16384);
+                pClientPeer->write(request);
+            });
+            Object::connect(pClientPeer.get(), &TcpSocket::receivedData, [&]()
+            {
+                response.append(pClientPeer->readAll());
+                const auto headerBlockEnd = response.find("\r\n\r\n");
+                if (responseSize == 0 && headerBlockEnd != std::string::npos)
+                {
+                    static constexpr std::string_view contentLengthField("\r\nContent-Length: ");
+                    const auto contentLengthIndex = response.find(contentLengthField);
+                    REQUIRE(contentLengthIndex < headerBlockEnd);
+                    responseSize = headerBlockEnd + 4 + std::stoull(response.substr(contentLengthIndex + contentLengthField.size()));
+                }
+                if (responseSize > 0 && response.size() >= responseSize)
+                    clientPeerReceivedResponseSemaphore.release();
+            });
+            pClientPeer->connect("127.0.0.1", serverPort);
+
+            THEN("server peer sends the requested part of the file across multiple partial sends")
+            {
+                REQUIRE(TRY_ACQUIRE(clientPeerReceivedResponseSemaphore, 30));
+                REQUIRE(serverPeerWasWritingFileAfterRequest);
+                REQUIRE(serverPeerSentFileCount == 1);
+                REQUIRE(!pServerPeerBroker->isWritingFile());
+                REQUIRE(pServerPeer->dataToWrite() == 0);
+                REQUIRE(response.size() == responseSize);
+                REQUIRE(response.starts_with(range.empty() ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 206 Partial Content\r\n"));
+                REQUIRE(response.substr(response.find("\r\n\r\n") + 4) == std::string_view(fileContent).substr(rangeStart, rangeSize));
+            }
+        }
+    }
+}
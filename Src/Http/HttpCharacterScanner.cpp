@@ -0,0 +1,259 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "HttpCharacterScanner.h"
+#include <x86intrin.h>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+
+namespace Kourier
+{
+
+namespace
+{
+
+// Character classes are encoded as 16-entry tables indexed by the low nibble of a character.
+// Bit n of an entry is set if the character whose high nibble is n belongs to the class.
+// Characters above 0x7F never belong to these classes. SIMD kernels classify a whole block
+// with two byte shuffles, which look up tables within 16-byte lanes. Tables are therefore
+// stored replicated for the widest lane count.
+using T_LookupTable = std::array<uint8_t, 64>;
+
+constexpr T_LookupTable replicate(const std::array<uint8_t, 16> &table)
+{
+    T_LookupTable replicatedTable{};
+    for (size_t i = 0; i < replicatedTable.size(); ++i)
+        replicatedTable[i] = table[i % table.size()];
+    return replicatedTable;
+}
+
+alignas(64) constexpr T_LookupTable highNibbleToRowTable = replicate({0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+alignas(64) constexpr T_LookupTable urlAbsolutePathTable = replicate({0B10111000, 0B11111100, 0B11111000, 0B11111000, 0B11111100, 0B11111000, 0B11111100, 0B11111100, 0B11111100, 0B11111100, 0B11111100, 0B01011100, 0B01010100, 0B01011100, 0B11010100, 0B01110100});
+alignas(64) constexpr T_LookupTable urlQueryTable = replicate({0B10111000, 0B11111100, 0B11111000, 0B11111000, 0B11111100, 0B11111000, 0B11111100, 0B11111100, 0B11111100, 0B11111100, 0B11111100, 0B01011100, 0B01010100, 0B01011100, 0B11010100, 0B01111100});
+alignas(64) constexpr T_LookupTable fieldNameTable = replicate({0B11101000, 0B11111100, 0B11111000, 0B11111100, 0B11111100, 0B11111100, 0B11111100, 0B11111100, 0B11111000, 0B11111000, 0B11110100, 0B01010100, 0B11010000, 0B01010100, 0B11110100, 0B01110000});
+
+// Scalar kernels are the reference implementation the SIMD kernels are tested against.
+constexpr size_t scalarBlockSize = 16;
+
+template <const T_LookupTable &table>
+size_t countClassCharsScalar(const char *pData)
+{
+    size_t count = 0;
+    for (; count < scalarBlockSize; ++count)
+    {
+        const auto ch = static_cast<uint8_t>(pData[count]);
+        if (ch > 0x7F || !((table[ch & 0x0F] >> (ch >> 4)) & 1))
+            break;
+    }
+    return count;
+}
+
+size_t countFieldValueCharsScalar(const char *pData)
+{
+    // field-vchar, SP and HTAB are allowed. Other control characters and DEL are not.
+    size_t count = 0;
+    for (; count < scalarBlockSize; ++count)
+    {
+        const auto ch = static_cast<uint8_t>(pData[count]);
+        if (ch == 0x7F || (ch < 0x20 && ch != '\t'))
+            break;
+    }
+    return count;
+}
+
+size_t countHexDigitsScalar(const char *pData)
+{
+    size_t count = 0;
+    for (; count < scalarBlockSize; ++count)
+    {
+        const auto ch = static_cast<uint8_t>(pData[count]);
+        const auto upperCase = static_cast<uint8_t>(ch & 0xDF);
+        if (!(('0' <= ch && ch <= '9') || ('A' <= upperCase && upperCase <= 'F')))
+            break;
+    }
+    return count;
+}
+
+template <const T_LookupTable &table>
+__attribute__((target("sse4.2"))) size_t countClassCharsSSE42(const char *pData)
+{
+    const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData));
+    const auto rows = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(highNibbleToRowTable.data())),
+                                       _mm_and_si128(_mm_srli_epi16(data, 4), _mm_set1_epi8(0x0F)));
+    const auto columns = _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(table.data())), data);
+    const auto notInClass = _mm_cmpeq_epi8(_mm_and_si128(rows, columns), _mm_setzero_si128());
+    return std::countr_zero(static_cast<uint32_t>(_mm_movemask_epi8(notInClass)) | (1u << 16));
+}
+
+__attribute__((target("sse4.2"))) size_t countFieldValueCharsSSE42(const char *pData)
+{
+    const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData));
+    const auto isControl = _mm_andnot_si128(_mm_cmpeq_epi8(_mm_set1_epi8('\t'), data),
+                                            _mm_and_si128(_mm_cmpgt_epi8(data, _mm_set1_epi8(-1)), _mm_cmpgt_epi8(_mm_set1_epi8(' '), data)));
+    const auto notAllowed = _mm_or_si128(_mm_cmpeq_epi8(_mm_set1_epi8(0x7F), data), isControl);
+    return std::countr_zero(static_cast<uint32_t>(_mm_movemask_epi8(notAllowed)) | (1u << 16));
+}
+
+__attribute__((target("sse4.2"))) size_t countHexDigitsSSE42(const char *pData)
+{
+    const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData));
+    const auto isNotDigit = _mm_or_si128(_mm_cmpgt_epi8(_mm_set1_epi8('0'), data), _mm_cmpgt_epi8(data, _mm_set1_epi8('9')));
+    const auto upperCase = _mm_and_si128(data, _mm_set1_epi8(char(0xDF)));
+    const auto isNotAlpha = _mm_or_si128(_mm_cmpgt_epi8(_mm_set1_epi8('A'), upperCase), _mm_cmpgt_epi8(upperCase, _mm_set1_epi8('F')));
+    return std::countr_zero(static_cast<uint32_t>(_mm_movemask_epi8(_mm_and_si128(isNotDigit, isNotAlpha))) | (1u << 16));
+}
+
+template <const T_LookupTable &table>
+__attribute__((target("avx2"))) size_t countClassCharsAVX2(const char *pData)
+{
+    const auto data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData));
+    const auto rows = _mm256_shuffle_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(highNibbleToRowTable.data())),
+                                          _mm256_and_si256(_mm256_srli_epi16(data, 4), _mm256_set1_epi8(0x0F)));
+    const auto columns = _mm256_shuffle_epi8(_mm256_load_si256(reinterpret_cast<const __m256i*>(table.data())), data);
+    const auto notInClass = _mm256_cmpeq_epi8(_mm256_and_si256(rows, columns), _mm256_setzero_si256());
+    return std::countr_zero(static_cast<uint32_t>(_mm256_movemask_epi8(notInClass)));
+}
+
+__attribute__((target("avx2"))) size_t countFieldValueCharsAVX2(const char *pData)
+{
+    const auto data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData));
+    const auto isControl = _mm256_andnot_si256(_mm256_cmpeq_epi8(_mm256_set1_epi8('\t'), data),
+                                               _mm256_and_si256(_mm256_cmpgt_epi8(data, _mm256_set1_epi8(-1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(' '), data)));
+    const auto notAllowed = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_set1_epi8(0x7F), data), isControl);
+    return std::countr_zero(static_cast<uint32_t>(_mm256_movemask_epi8(notAllowed)));
+}
+
+__attribute__((target("avx2"))) size_t countHexDigitsAVX2(const char *pData)
+{
+    const auto data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pData));
+    const auto isNotDigit = _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8('0'), data), _mm256_cmpgt_epi8(data, _mm256_set1_epi8('9')));
+    const auto upperCase = _mm256_and_si256(data, _mm256_set1_epi8(char(0xDF)));
+    const auto isNotAlpha = _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8('A'), upperCase), _mm256_cmpgt_epi8(upperCase, _mm256_set1_epi8('F')));
+    return std::countr_zero(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(isNotDigit, isNotAlpha))));
+}
+
+template <const T_LookupTable &table>
+__attribute__((target("avx512f,avx512bw"))) size_t countClassCharsAVX512BW(const char *pData)
+{
+    const auto data = _mm512_loadu_si512(pData);
+    const auto rows = _mm512_shuffle_epi8(_mm512_load_si512(highNibbleToRowTable.data()),
+                                          _mm512_and_si512(_mm512_srli_epi16(data, 4), _mm512_set1_epi8(0x0F)));
+    const auto columns = _mm512_shuffle_epi8(_mm512_load_si512(table.data()), data);
+    return std::countr_zero(static_cast<uint64_t>(_mm512_testn_epi8_mask(rows, columns)));
+}
+
+__attribute__((target("avx512f,avx512bw"))) size_t countFieldValueCharsAVX512BW(const char *pData)
+{
+    const auto data = _mm512_loadu_si512(pData);
+    const auto isControl = _mm512_cmplt_epu8_mask(data, _mm512_set1_epi8(' ')) & ~_mm512_cmpeq_epi8_mask(data, _mm512_set1_epi8('\t'));
+    return std::countr_zero(static_cast<uint64_t>(_mm512_cmpeq_epi8_mask(data, _mm512_set1_epi8(0x7F)) | isControl));
+}
+
+__attribute__((target("avx512f,avx512bw"))) size_t countHexDigitsAVX512BW(const char *pData)
+{
+    const auto data = _mm512_loadu_si512(pData);
+    const auto isDigit = _mm512_cmpge_epu8_mask(data, _mm512_set1_epi8('0')) & _mm512_cmple_epu8_mask(data, _mm512_set1_epi8('9'));
+    const auto upperCase = _mm512_and_si512(data, _mm512_set1_epi8(char(0xDF)));
+    const auto isAlpha = _mm512_cmpge_epu8_mask(upperCase, _mm512_set1_epi8('A')) & _mm512_cmple_epu8_mask(upperCase, _mm512_set1_epi8('F'));
+    return std::countr_zero(static_cast<uint64_t>(~(isDigit | isAlpha)));
+}
+
+constexpr HttpCharacterScanner::Kernels scalarKernels{.instructionSet = HttpCharacterScanner::InstructionSet::Scalar,
+                                                      .blockSize = scalarBlockSize,
+                                                      .countUrlAbsolutePathChars = &countClassCharsScalar<urlAbsolutePathTable>,
+                                                      .countUrlQueryChars = &countClassCharsScalar<urlQueryTable>,
+                                                      .countFieldNameChars = &countClassCharsScalar<fieldNameTable>,
+                                                      .countFieldValueChars = &countFieldValueCharsScalar,
+                                                      .countHexDigits = &countHexDigitsScalar};
+
+constexpr HttpCharacterScanner::Kernels sse42Kernels{.instructionSet = HttpCharacterScanner::InstructionSet::SSE42,
+                                                     .blockSize = 16,
+                                                     .countUrlAbsolutePathChars = &countClassCharsSSE42<urlAbsolutePathTable>,
+                                                     .countUrlQueryChars = &countClassCharsSSE42<urlQueryTable>,
+                                                     .countFieldNameChars = &countClassCharsSSE42<fieldNameTable>,
+                                                     .countFieldValueChars = &countFieldValueCharsSSE42,
+                                                     .countHexDigits = &countHexDigitsSSE42};
+
+constexpr HttpCharacterScanner::Kernels avx2Kernels{.instructionSet = HttpCharacterScanner::InstructionSet::AVX2,
+                                                    .blockSize = 32,
+                                                    .countUrlAbsolutePathChars = &countClassCharsAVX2<urlAbsolutePathTable>,
+                                                    .countUrlQueryChars = &countClassCharsAVX2<urlQueryTable>,
+                                                    .countFieldNameChars = &countClassCharsAVX2<fieldNameTable>,
+                                                    .countFieldValueChars = &countFieldValueCharsAVX2,
+                                                    .countHexDigits = &countHexDigitsAVX2};
+
+constexpr HttpCharacterScanner::Kernels avx512BWKernels{.instructionSet = HttpCharacterScanner::InstructionSet::AVX512BW,
+                                                        .blockSize = 64,
+                                                        .countUrlAbsolutePathChars = &countClassCharsAVX512BW<urlAbsolutePathTable>,
+                                                        .countUrlQueryChars = &countClassCharsAVX512BW<urlQueryTable>,
+                                                        .countFieldNameChars = &countClassCharsAVX512BW<fieldNameTable>,
+                                                        .countFieldValueChars = &countFieldValueCharsAVX512BW,
+                                                        .countHexDigits = &countHexDigitsAVX512BW};
+
+static_assert(avx512BWKernels.blockSize == HttpCharacterScanner::maxBlockSize());
+
+}
+
+const HttpCharacterScanner::Kernels * const HttpCharacterScanner::m_pKernels = &HttpCharacterScanner::kernels(HttpCharacterScanner::bestSupportedInstructionSet());
+
+const HttpCharacterScanner::Kernels &HttpCharacterScanner::kernels(InstructionSet instructionSet)
+{
+    switch (instructionSet)
+    {
+        case InstructionSet::Scalar:
+            return scalarKernels;
+        case InstructionSet::SSE42:
+            return sse42Kernels;
+        case InstructionSet::AVX2:
+            return avx2Kernels;
+        case InstructionSet::AVX512BW:
+            return avx512BWKernels;
+    }
+    return scalarKernels;
+}
+
+bool HttpCharacterScanner::isSupported(InstructionSet instructionSet)
+{
+    // Can be called while initializing static objects, before the CPU model is initialized.
+    __builtin_cpu_init();
+    switch (instructionSet)
+    {
+        case InstructionSet::Scalar:
+            return true;
+        case InstructionSet::SSE42:
+            return __builtin_cpu_supports("sse4.2");
+        case InstructionSet::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case InstructionSet::AVX512BW:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    }
+    return false;
+}
+
+HttpCharacterScanner::InstructionSet HttpCharacterScanner::bestSupportedInstructionSet()
+{
+    for (const auto instructionSet : {InstructionSet::AVX512BW, InstructionSet::AVX2, InstructionSet::SSE42})
+    {
+        if (isSupported(instructionSet))
+            return instructionSet;
+    }
+    return InstructionSet::Scalar;
+}
+
+}
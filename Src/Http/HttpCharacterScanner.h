@@ -0,0 +1,62 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_HTTP_CHARACTER_SCANNER_H
+#define KOURIER_HTTP_CHARACTER_SCANNER_H
+
+#include <cstddef>
+
+
+namespace Kourier
+{
+
+// HttpCharacterScanner provides the kernels the HTTP parsers use to skip over runs of
+// characters belonging to a given character class. Each kernel inspects one block of
+// blockSize bytes and returns how many of its leading bytes belong to the class, so
+// returning blockSize means the whole block matched. Kernels may read up to blockSize
+// bytes from the given pointer. The kernels for the best instruction set the CPU supports
+// are chosen once at startup.
+class HttpCharacterScanner
+{
+public:
+    enum class InstructionSet {Scalar, SSE42, AVX2, AVX512BW};
+    using T_Kernel = size_t (*)(const char *pData);
+    struct Kernels
+    {
+        InstructionSet instructionSet;
+        size_t blockSize;
+        T_Kernel countUrlAbsolutePathChars;
+        T_Kernel countUrlQueryChars;
+        T_Kernel countFieldNameChars;
+        T_Kernel countFieldValueChars;
+        T_Kernel countHexDigits;
+    };
+    static inline const Kernels &kernels() {return *m_pKernels;}
+    static const Kernels &kernels(InstructionSet instructionSet);
+    static bool isSupported(InstructionSet instructionSet);
+    static constexpr size_t maxBlockSize() {return 64;}
+
+private:
+    static InstructionSet bestSupportedInstructionSet();
+
+private:
+    static const Kernels * const m_pKernels;
+};
+
+}
+
+#endif // KOURIER_HTTP_CHARACTER_SCANNER_H
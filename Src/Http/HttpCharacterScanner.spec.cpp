@@ -0,0 +1,144 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "HttpCharacterScanner.h"
+#include <Spectator>
+#include <array>
+#include <random>
+#include <string>
+#include <vector>
+
+using Kourier::HttpCharacterScanner;
+
+
+namespace Test::HttpCharacterScanner
+{
+
+using InstructionSet = Kourier::HttpCharacterScanner::InstructionSet;
+using Kernels = Kourier::HttpCharacterScanner::Kernels;
+using T_Kernel = Kourier::HttpCharacterScanner::T_Kernel;
+
+// Scalar kernels process 16-byte blocks. Wider blocks are checked by chaining them.
+size_t referenceCount(T_Kernel scalarKernel, size_t scalarBlockSize, const char *pData, size_t blockSize)
+{
+    size_t count = 0;
+    while (count < blockSize)
+    {
+        const auto matchCount = scalarKernel(pData + count);
+        count += matchCount;
+        if (matchCount != scalarBlockSize)
+            break;
+    }
+    return count;
+}
+
+std::vector<std::pair<std::string, T_Kernel Kernels::*>> kernelMembers()
+{
+    return {{"countUrlAbsolutePathChars", &Kernels::countUrlAbsolutePathChars},
+            {"countUrlQueryChars", &Kernels::countUrlQueryChars},
+            {"countFieldNameChars", &Kernels::countFieldNameChars},
+            {"countFieldValueChars", &Kernels::countFieldValueChars},
+            {"countHexDigits", &Kernels::countHexDigits}};
+}
+
+}
+
+using namespace Test::HttpCharacterScanner;
+
+
+SCENARIO("HttpCharacterScanner selects kernels the CPU supports")
+{
+    GIVEN("the kernels selected at startup")
+    {
+        const auto &kernels = HttpCharacterScanner::kernels();
+
+        THEN("selected kernels use a supported instruction set and fit in the maximum block size")
+        {
+            REQUIRE(HttpCharacterScanner::isSupported(kernels.instructionSet));
+            REQUIRE(HttpCharacterScanner::isSupported(InstructionSet::Scalar));
+            REQUIRE(kernels.blockSize <= HttpCharacterScanner::maxBlockSize());
+            REQUIRE(&kernels == &HttpCharacterScanner::kernels(kernels.instructionSet));
+        }
+    }
+}
+
+
+SCENARIO("HttpCharacterScanner kernels agree with scalar kernels")
+{
+    GIVEN("kernels for an instruction set")
+    {
+        const auto instructionSet = GENERATE(AS(InstructionSet),
+                                             InstructionSet::Scalar,
+                                             InstructionSet::SSE42,
+                                             InstructionSet::AVX2,
+                                             InstructionSet::AVX512BW);
+        if (!HttpCharacterScanner::isSupported(instructionSet))
+            return;
+        const auto &scalarKernels = HttpCharacterScanner::kernels(InstructionSet::Scalar);
+        const auto &kernels = HttpCharacterScanner::kernels(instructionSet);
+        REQUIRE(kernels.instructionSet == instructionSet);
+        REQUIRE(kernels.blockSize % scalarKernels.blockSize == 0);
+        REQUIRE(kernels.blockSize <= HttpCharacterScanner::maxBlockSize());
+
+        WHEN("each byte value is placed at each position of a block of otherwise matching characters")
+        {
+            THEN("kernels return the same count as scalar kernels")
+            {
+                for (const auto &[name, pKernel] : kernelMembers())
+                {
+                    std::array<char, 2 * HttpCharacterScanner::maxBlockSize()> block;
+                    block.fill(name == "countHexDigits" ? 'a' : '0');
+                    for (size_t position = 0; position < kernels.blockSize; ++position)
+                    {
+                        for (int byte = 0; byte < 256; ++byte)
+                        {
+                            const auto previousValue = block[position];
+                            block[position] = static_cast<char>(byte);
+                            const auto expectedCount = referenceCount(scalarKernels.*pKernel, scalarKernels.blockSize, block.data(), kernels.blockSize);
+                            if ((kernels.*pKernel)(block.data()) != expectedCount)
+                                FAIL(std::string(name).append(" failed for byte ").append(std::to_string(byte)).append(" at position ").append(std::to_string(position)).c_str());
+                            block[position] = previousValue;
+                        }
+                    }
+                }
+            }
+        }
+
+        WHEN("kernels scan random data made of characters around class boundaries")
+        {
+            THEN("kernels return the same count as scalar kernels")
+            {
+                std::mt19937 generator(0x4B4F5552);
+                const std::string_view alphabet("09afAFgG:;@/?-._~%!$&'()*+,=\"\t \r\n\x7F\x80\xFF");
+                std::uniform_int_distribution<size_t> alphabetIndex(0, alphabet.size() - 1);
+                std::uniform_int_distribution<int> anyByte(0, 255);
+                std::array<char, 2 * HttpCharacterScanner::maxBlockSize()> block;
+                for (int i = 0; i < 20000; ++i)
+                {
+                    for (auto &ch : block)
+                        ch = (i % 2) ? alphabet[alphabetIndex(generator)] : static_cast<char>(anyByte(generator));
+                    for (const auto &[name, pKernel] : kernelMembers())
+                    {
+                        const auto expectedCount = referenceCount(scalarKernels.*pKernel, scalarKernels.blockSize, block.data(), kernels.blockSize);
+                        if ((kernels.*pKernel)(block.data()) != expectedCount)
+                            FAIL(std::string(name).append(" failed for random block.").c_str());
+                    }
+                }
+            }
+        }
+    }
+}
@@ -16,6 +16,7 @@
 //
 
 #include "HttpChunkMetadataParser.h"
+#include "HttpCharacterScanner.h"
 #include "../Core/IOChannel.h"
 #include "../Core/SimdIterator.h"
 #include <charconv>
@@ -24,7 +25,7 @@
 namespace Kourier
 {
 
-HttpChunkMetadataParser::ChunkMetadataParserStatus HttpChunkMetadataParser::parse(IOChannel &ioChannel, size_t &chunkDataSize, size_t &chunkMetadataSize)
+HttpChunkMetadataParser::ChunkMetadataParserStatus HttpChunkMetadataParser::parse(IOChannel &ioChannel, size_t &chunkDataSize, size_t &chunkMetadataSize, size_t startIndex)
 {
     // chunk-metadata = chunk-size [ chunk-ext ] CRLF
     // chunk-size     = 1*HEXDIG
@@ -36,49 +37,45 @@ HttpChunkMetadataParser::ChunkMetadataParserStatus HttpChunkMetadataParser::pars
     // quoted-pair    = "\" ( HTAB / SP / VCHAR / obs-text )
     chunkDataSize = 0;
     chunkMetadataSize = 0;
-    if (ioChannel.dataAvailable() < 3)
+    assert(startIndex <= ioChannel.dataAvailable());
+    const size_t dataAvailable = ioChannel.dataAvailable() - startIndex;
+    if (dataAvailable < 3)
         return ChunkMetadataParserStatus::NeedsMoreData;
     SimdIterator it(ioChannel);
+    const auto &kernels = HttpCharacterScanner::kernels();
     size_t currentIndex = 0;
-    const auto rawData = it.nextAt(0);
-    const auto isNotDigit = _mm256_or_si256(_mm256_cmpgt_epi8(m_zero, rawData), _mm256_cmpgt_epi8(rawData, m_nine));
-    const auto toUpper = _mm256_and_si256(rawData, m_upperCaseMask);
-    const auto isNotAlpha = _mm256_or_si256(_mm256_cmpgt_epi8(m_upperCaseA, toUpper), _mm256_cmpgt_epi8(toUpper, m_upperCaseF));
-    const auto matchCount = _tzcnt_u32(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(isNotDigit, isNotAlpha))));
-    const auto hexDigitCount = std::min<size_t>(ioChannel.dataAvailable() - 1, matchCount);
+    const auto hexDigitCount = std::min<size_t>(dataAvailable - 1, kernels.countHexDigits(it.at(startIndex)));
     currentIndex += hexDigitCount;
-    if (hexDigitCount > 0 && hexDigitCount <= 12 && ((hexDigitCount + 1) < ioChannel.dataAvailable()))
+    if (hexDigitCount > 0 && hexDigitCount <= 12 && ((hexDigitCount + 1) < dataAvailable))
     {
-        auto chunkDataSizeSlice = ioChannel.slice(0, hexDigitCount);
+        auto chunkDataSizeSlice = ioChannel.slice(startIndex, hexDigitCount);
         auto [ptr, ec] {std::from_chars(chunkDataSizeSlice.data(), chunkDataSizeSlice.data() + hexDigitCount, chunkDataSize, 16)};
         if (std::errc() == ec)
         {
-            if ((currentIndex + 2) > ioChannel.dataAvailable())
+            if ((currentIndex + 2) > dataAvailable)
                 return ChunkMetadataParserStatus::NeedsMoreData;
             while (true)
             {
-                const auto data = it.nextAt(currentIndex);
-                const auto result = _mm256_or_si256(_mm256_cmpeq_epi8(m_del, data), _mm256_andnot_si256(_mm256_cmpeq_epi8(m_htab, data), _mm256_and_si256(_mm256_cmpgt_epi8(data, m_minus1), _mm256_cmpgt_epi8(m_space, data))));
-                const auto matchCount = std::min<size_t>(ioChannel.dataAvailable() - 2 - currentIndex, _tzcnt_u32(static_cast<uint32_t>(_mm256_movemask_epi8(result))));
+                const auto matchCount = std::min<size_t>(dataAvailable - 2 - currentIndex, kernels.countFieldValueChars(it.at(startIndex + currentIndex)));
                 currentIndex += matchCount;
-                if (matchCount == 32)
+                if (matchCount == kernels.blockSize)
                     continue;
-                if (ioChannel.slice(currentIndex, 2) == "\r\n")
+                if (ioChannel.slice(startIndex + currentIndex, 2) == "\r\n")
                 {
                     currentIndex += 2;
                     chunkMetadataSize = currentIndex;
                     if (chunkDataSize > 0)
                         return ChunkMetadataParserStatus::ExpectingChunkData;
-                    else if ((currentIndex + 2) <= ioChannel.dataAvailable() && ioChannel.slice(currentIndex, 2) == "\r\n")
+                    else if ((currentIndex + 2) <= dataAvailable && ioChannel.slice(startIndex + currentIndex, 2) == "\r\n")
                     {
                         chunkMetadataSize += 2;
                         return ChunkMetadataParserStatus::ParsedRequest;
                     }
                     else
-                        return ((currentIndex + 2) <= ioChannel.dataAvailable()) ? ChunkMetadataParserStatus::ExpectingTrailer : ChunkMetadataParserStatus::NeedsMoreData;
+                        return ((currentIndex + 2) <= dataAvailable) ? ChunkMetadataParserStatus::ExpectingTrailer : ChunkMetadataParserStatus::NeedsMoreData;
                 }
-                else if (((currentIndex + 2) == ioChannel.dataAvailable())
-                           && ioChannel.peekChar(currentIndex) != '\r')
+                else if (((currentIndex + 2) == dataAvailable)
+                           && ioChannel.peekChar(startIndex + currentIndex) != '\r')
                 {
                     chunkMetadataSize = currentIndex;
                     return ChunkMetadataParserStatus::NeedsMoreData;
@@ -18,7 +18,6 @@
 #ifndef KOURIER_HTTP_CHUNK_METADATA_PARSER_H
 #define KOURIER_HTTP_CHUNK_METADATA_PARSER_H
 
-#include <x86intrin.h>
 #include <cstddef>
 
 
@@ -30,18 +29,7 @@ class HttpChunkMetadataParser
 {
 public:
     enum class ChunkMetadataParserStatus {ExpectingChunkData, ParsedRequest, ExpectingTrailer, NeedsMoreData, Failed};
-    static ChunkMetadataParserStatus parse(IOChannel &ioChannel, size_t &chunkDataSize, size_t &chunkMetadataSize);
-
-private:
-    static constexpr __m256i m_zero = (__m256i)(__v32qi){char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0'), char('0')};
-    static constexpr __m256i m_nine = (__m256i)(__v32qi){char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9'), char('9')};
-    static constexpr __m256i m_upperCaseMask = (__m256i)(__v32qi){char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF), char(0xDF)};
-    static constexpr __m256i m_upperCaseA = (__m256i)(__v32qi){char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A'), char('A')};
-    static constexpr __m256i m_upperCaseF = (__m256i)(__v32qi){char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F'), char('F')};
-    static constexpr __m256i m_htab = (__m256i)(__v32qi){char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09)};
-    static constexpr __m256i m_space = (__m256i)(__v32qi){char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20)};
-    static constexpr __m256i m_del = (__m256i)(__v32qi){char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F)};
-    static constexpr __m256i m_minus1 = (__m256i)(__v32qi){char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1)};
+    static ChunkMetadataParserStatus parse(IOChannel &ioChannel, size_t &chunkDataSize, size_t &chunkMetadataSize, size_t startIndex = 0);
 };
 
 }
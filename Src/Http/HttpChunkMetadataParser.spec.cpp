@@ -447,3 +447,47 @@ SCENARIO("HttpChunkMetadataParser informs that it expects trailers if chunk meta
         }
     }
 }
+
+
+SCENARIO("HttpChunkMetadataParser parses chunk metadata starting at given index")
+{
+    GIVEN("chunk metadata preceded by data already processed")
+    {
+        const auto chunkMetadata = GENERATE(AS(std::pair<size_t, std::string_view>),
+                                            {1, "1\r\n"},
+                                            {0xFF, "FF;n1;n2;n3\r\n"},
+                                            {0x37ABFF, "37ABFF ; name=value\r\n"});
+        const auto precedingData = GENERATE(AS(std::string_view), "", "a", "5\r\nHello\r\n", "FF\r\n");
+        std::string data(precedingData);
+        data.append(chunkMetadata.second);
+
+        WHEN("chunk metadata is parsed at once")
+        {
+            IOChannelTest ioChannel(data);
+            size_t chunkDataSize = 0;
+            size_t chunkMetadataSize = 0;
+            const auto parserStatus = HttpChunkMetadataParser::parse(ioChannel, chunkDataSize, chunkMetadataSize, precedingData.size());
+
+            THEN("parser parses metadata and informs that chunk data is expected")
+            {
+                REQUIRE(parserStatus == HttpChunkMetadataParser::ChunkMetadataParserStatus::ExpectingChunkData);
+                REQUIRE(chunkDataSize == chunkMetadata.first);
+                REQUIRE(chunkMetadataSize == chunkMetadata.second.size());
+                REQUIRE(ioChannel.dataAvailable() == data.size());
+            }
+        }
+
+        WHEN("chunk metadata is incomplete")
+        {
+            IOChannelTest ioChannel(std::string_view(data).substr(0, data.size() - 1));
+            size_t chunkDataSize = 0;
+            size_t chunkMetadataSize = 0;
+            const auto parserStatus = HttpChunkMetadataParser::parse(ioChannel, chunkDataSize, chunkMetadataSize, precedingData.size());
+
+            THEN("parser informs that it needs more data")
+            {
+                REQUIRE(parserStatus == HttpChunkMetadataParser::ChunkMetadataParserStatus::NeedsMoreData);
+            }
+        }
+    }
+}
@@ -17,6 +17,7 @@
 
 #include "HttpConnectionHandler.h"
 #include "../Core/TcpSocket.h"
+#include <utility>
 
 
 namespace Kourier
@@ -37,9 +38,11 @@ HttpConnectionHandler::HttpConnectionHandler(TcpSocket &socket,
     m_brokerPrivate(&socket, &m_requestParser),
     m_broker(&m_brokerPrivate)
 {
-    m_timer.setSingleShot(true);
-    Object::connect(&m_timer, &Timer::timeout, this, &HttpConnectionHandler::onTimeout);
+    Object::connect(&m_timer, &LazyTimer::timeout, this, &HttpConnectionHandler::onTimeout);
     Object::connect(m_pSocket.get(), &TcpSocket::receivedData, this, &HttpConnectionHandler::onReceivedData);
+    m_pTlsSocket = m_pSocket->tryCast<TlsSocket*>();
+    if (m_pTlsSocket != nullptr)
+        Object::connect(m_pTlsSocket, &TlsSocket::encrypted, this, &HttpConnectionHandler::onEncrypted);
     if (m_idleTimeoutInMSecs.count() > 0)
     {
         m_isInIdleTimeout = true;
@@ -56,10 +59,20 @@ void HttpConnectionHandler::finish()
 }
 
 void HttpConnectionHandler::reset()
+{
+    prepareForNextRequest();
+    restartTimer();
+}
+
+void HttpConnectionHandler::prepareForNextRequest()
 {
     m_parsedRequestMetadata = false;
     m_receivedCompleteRequest = false;
     m_brokerPrivate.resetResponseWriting();
+}
+
+void HttpConnectionHandler::restartTimer()
+{
     if (m_pSocket->dataAvailable() > 0)
     {
         if (m_requestTimeoutInMSecs.count() > 0)
@@ -81,6 +94,8 @@ void HttpConnectionHandler::reset()
 
 void HttpConnectionHandler::onReceivedData()
 {
+    if (m_isWaitingForHandshake)
+        return;
     if (m_receivedCompleteRequest)
     {
         m_timer.stop();
@@ -93,25 +108,38 @@ void HttpConnectionHandler::onReceivedData()
     }
     if (!m_timer.isActive() && m_requestTimeoutInMSecs.count() > 0)
         m_timer.start(m_requestTimeoutInMSecs);
+    // Pipelined requests are processed in a batch. Their responses are written together when this slot
+    // returns and the timer is restarted only once, after the last complete request of the batch.
+    bool hasCompletedRequests = false;
     while (true)
     {
-        switch (m_requestParser.parse())
+        switch (std::exchange(m_resumesParsedRequest, false) ? HttpRequestParser::ParserStatus::ParsedRequest : m_requestParser.parse())
         {
             case HttpRequestParser::ParserStatus::ParsedRequest:
                 if (!m_parsedRequestMetadata)
                 {
+                    // Requests received before the TLS handshake completes came as early data, which can be replayed.
+                    // Unless their route accepts early data, they are processed after the handshake completes.
+                    if (m_pTlsSocket != nullptr
+                        && m_pTlsSocket->state() == TcpSocket::State::Connected
+                        && !m_pTlsSocket->isEncrypted()
+                        && !m_pHttpRequestRouter->acceptsEarlyData(m_requestParser.request().method(), m_requestParser.request().targetPath()))
+                    {
+                        m_isWaitingForHandshake = true;
+                        return;
+                    }
                     m_parsedRequestMetadata = true;
-                    auto pHandler = m_pHttpRequestRouter->getHandler(m_requestParser.request().method(), m_requestParser.request().targetPath());
+                    auto pHandler = m_pHttpRequestRouter->getHandler(m_requestParser.request().method(), m_requestParser.request().targetPath(), m_requestParser.pathParameters());
                     if (pHandler)
                     {
                         try
                         {
                             pHandler(m_requestParser.request(), m_broker);
                             m_receivedCompleteRequest = m_requestParser.request().isComplete();
-                            if (!m_brokerPrivate.responded() && !m_brokerPrivate.hasQObject())
+                            if (!m_brokerPrivate.responded() && !m_brokerPrivate.hasQObject() && !m_brokerPrivate.isWritingFile())
                             {
                                 m_timer.stop();
-                                Object::disconnect(&m_timer, &Timer::timeout, this, &HttpConnectionHandler::onTimeout);
+                                Object::disconnect(&m_timer, &LazyTimer::timeout, this, &HttpConnectionHandler::onTimeout);
                                 Object::disconnect(m_pSocket.get(), &IOChannel::receivedData, this, &HttpConnectionHandler::onReceivedData);
                                 m_pSocket->disconnectFromPeer();
                                 return;
@@ -120,7 +148,7 @@ void HttpConnectionHandler::onReceivedData()
                         catch (...)
                         {
                             m_timer.stop();
-                            Object::disconnect(&m_timer, &Timer::timeout, this, &HttpConnectionHandler::onTimeout);
+                            Object::disconnect(&m_timer, &LazyTimer::timeout, this, &HttpConnectionHandler::onTimeout);
                             Object::disconnect(m_pSocket.get(), &IOChannel::receivedData, this, &HttpConnectionHandler::onReceivedData);
                             m_brokerPrivate.writeResponse(HttpStatusCode::InternalServerError);
                             m_pSocket->disconnectFromPeer();
@@ -130,7 +158,7 @@ void HttpConnectionHandler::onReceivedData()
                     else
                     {
                         m_timer.stop();
-                        Object::disconnect(&m_timer, &Timer::timeout, this, &HttpConnectionHandler::onTimeout);
+                        Object::disconnect(&m_timer, &LazyTimer::timeout, this, &HttpConnectionHandler::onTimeout);
                         Object::disconnect(m_pSocket.get(), &IOChannel::receivedData, this, &HttpConnectionHandler::onReceivedData);
                         m_brokerPrivate.writeResponse(HttpStatusCode::NotFound);
                         if (m_pErrorHandler)
@@ -148,7 +176,8 @@ void HttpConnectionHandler::onReceivedData()
                 {
                     if (m_brokerPrivate.responded())
                     {
-                        reset();
+                        prepareForNextRequest();
+                        hasCompletedRequests = true;
                         continue;
                     }
                     else
@@ -166,7 +195,8 @@ void HttpConnectionHandler::onReceivedData()
                 {
                     if (m_brokerPrivate.responded())
                     {
-                        reset();
+                        prepareForNextRequest();
+                        hasCompletedRequests = true;
                         continue;
                     }
                     else
@@ -178,7 +208,9 @@ void HttpConnectionHandler::onReceivedData()
                 else
                     continue;
             case HttpRequestParser::ParserStatus::NeedsMoreData:
-                if (!m_parsedRequestMetadata && m_pSocket->dataAvailable() == 0)
+                if (hasCompletedRequests && !m_parsedRequestMetadata)
+                    restartTimer();
+                else if (!m_parsedRequestMetadata && m_pSocket->dataAvailable() == 0)
                 {
                     if (m_idleTimeoutInMSecs.count() > 0)
                     {
@@ -191,7 +223,7 @@ void HttpConnectionHandler::onReceivedData()
                 return;
             case HttpRequestParser::ParserStatus::Failed:
                 m_timer.stop();
-                Object::disconnect(&m_timer, &Timer::timeout, this, &HttpConnectionHandler::onTimeout);
+                Object::disconnect(&m_timer, &LazyTimer::timeout, this, &HttpConnectionHandler::onTimeout);
                 Object::disconnect(m_pSocket.get(), &IOChannel::receivedData, this, &HttpConnectionHandler::onReceivedData);
                 m_brokerPrivate.writeResponse(HttpStatusCode::BadRequest);
                 if (m_pErrorHandler)
@@ -202,6 +234,16 @@ void HttpConnectionHandler::onReceivedData()
     }
 }
 
+void HttpConnectionHandler::onEncrypted()
+{
+    if (m_isWaitingForHandshake)
+    {
+        m_isWaitingForHandshake = false;
+        m_resumesParsedRequest = true;
+        onReceivedData();
+    }
+}
+
 void HttpConnectionHandler::onWroteResponse()
 {
     if (m_receivedCompleteRequest)
@@ -218,7 +260,7 @@ void HttpConnectionHandler::onTimeout()
     m_brokerPrivate.writeResponse(HttpStatusCode::RequestTimeout);
     if (m_pErrorHandler)
         m_pErrorHandler->handleError(HttpServer::ServerError::RequestTimeout, m_pSocket->peerAddress(), m_pSocket->peerPort());
-    Object::disconnect(&m_timer, &Timer::timeout, this, &HttpConnectionHandler::onTimeout);
+    Object::disconnect(&m_timer, &LazyTimer::timeout, this, &HttpConnectionHandler::onTimeout);
     Object::disconnect(m_pSocket.get(), &IOChannel::receivedData, this, &HttpConnectionHandler::onReceivedData);
     m_pSocket->disconnectFromPeer();
     return;
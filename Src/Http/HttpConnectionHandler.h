@@ -25,7 +25,8 @@
 #include "HttpBroker.h"
 #include "ErrorHandler.h"
 #include "../Core/TcpSocket.h"
-#include "../Core/Timer.h"
+#include "../Core/TlsSocket.h"
+#include "../Core/LazyTimer.h"
 #include "../Server/ConnectionHandler.h"
 #include <QObject>
 #include <memory>
@@ -52,14 +53,18 @@ public:
 
 private:
     void reset();
+    void prepareForNextRequest();
+    void restartTimer();
     void onReceivedData();
+    void onEncrypted();
     void onWroteResponse();
     void onTimeout();
     void onDisconnected();
 
 private:
-    Timer m_timer;
+    LazyTimer m_timer;
     std::unique_ptr<TcpSocket> m_pSocket;
+    TlsSocket *m_pTlsSocket = nullptr;
     const std::chrono::milliseconds m_requestTimeoutInMSecs = std::chrono::milliseconds(0);
     const std::chrono::milliseconds m_idleTimeoutInMSecs = std::chrono::milliseconds(0);
     HttpRequestParser m_requestParser;
@@ -70,6 +75,8 @@ private:
     bool m_parsedRequestMetadata = false;
     bool m_receivedCompleteRequest = false;
     bool m_isInIdleTimeout = false;
+    bool m_isWaitingForHandshake = false;
+    bool m_resumesParsedRequest = false;
 };
 
 }
@@ -433,6 +433,59 @@ SCENARIO("HttpConnectionHandler processes all requests in buffer without the nee
 }
 
 
+SCENARIO("HttpConnectionHandler writes responses to pipelined requests in order and sends them together")
+{
+    GIVEN("a connected client")
+    {
+        auto tcpSockets = createConnectedSocketPair();
+        std::unique_ptr<TcpSocket> clientSocket(tcpSockets.first);
+        REQUIRE(clientSocket->state() == TcpSocket::State::Connected);
+        auto pHttpRequestRouter = std::make_shared<HttpRequestRouter>();
+        REQUIRE(pHttpRequestRouter->addRoute(HttpRequest::Method::GET, "/", [](const HttpRequest &request, HttpBroker &broker)
+        {
+            broker.writeResponse(request.targetPath());
+        }));
+        HttpConnectionHandler httpConnectionHandler(*tcpSockets.second, std::make_shared<HttpRequestLimits>(), pHttpRequestRouter, 0ms, 0ms);
+        size_t sentDataCount = 0;
+        size_t sentDataSize = 0;
+        Object::connect(tcpSockets.second, &TcpSocket::sentData, [&](size_t count)
+        {
+            ++sentDataCount;
+            sentDataSize += count;
+        });
+        QSemaphore clientReceivedResponsesSemaphore;
+        std::string clientReceivedData;
+        Object::connect(clientSocket.get(), &TcpSocket::receivedData, [&]()
+        {
+            clientReceivedData.append(clientSocket->readAll());
+            if (clientReceivedData.ends_with("/third"))
+                clientReceivedResponsesSemaphore.release();
+        });
+
+        WHEN("three pipelined requests are written at once")
+        {
+            clientSocket->write("GET /first HTTP/1.1\r\nHost: host\r\n\r\n"
+                                "GET /second HTTP/1.1\r\nHost: host\r\n\r\n"
+                                "GET /third HTTP/1.1\r\nHost: host\r\n\r\n");
+
+            THEN("responses are received in request order after being sent with a single write")
+            {
+                REQUIRE(TRY_ACQUIRE(clientReceivedResponsesSemaphore, 10));
+                const auto firstPos = clientReceivedData.find("/first");
+                const auto secondPos = clientReceivedData.find("/second");
+                const auto thirdPos = clientReceivedData.find("/third");
+                REQUIRE(firstPos != std::string::npos);
+                REQUIRE(firstPos < secondPos);
+                REQUIRE(secondPos != std::string::npos);
+                REQUIRE(secondPos < thirdPos);
+                REQUIRE(sentDataCount == 1);
+                REQUIRE(sentDataSize == clientReceivedData.size());
+            }
+        }
+    }
+}
+
+
 SCENARIO("HttpConnectionHandler sends 100-continue before calling handler when request contains Expect: continue header")
 {
     GIVEN("a connected client")
@@ -829,13 +882,11 @@ SCENARIO("HttpConnectionHandler informs if received body data is the last one")
                                 "6\r\nWorld!\r\n"
                                 "0\r\n\r\n");
 
-            THEN("handler gets called and broker emits received data for every chunk in request")
+            THEN("handler gets called and broker emits data of all chunks received together at once")
             {
                 REQUIRE(TRY_ACQUIRE(handlerSemaphore, 1));
-                REQUIRE(bodySemaphore.tryAcquire(4));
-                const std::vector<std::pair<std::string, bool>> expectedEmittedData{{"Hello ", false},
-                                                                                    {"Incredible ", false},
-                                                                                    {"World!", false},
+                REQUIRE(bodySemaphore.tryAcquire(2));
+                const std::vector<std::pair<std::string, bool>> expectedEmittedData{{"Hello Incredible World!", false},
                                                                                     {"", true}};
                 REQUIRE(emittedData == expectedEmittedData);
             }
@@ -18,6 +18,7 @@
 #include "HttpConnectionHandlerFactory.h"
 #include "HttpConnectionHandler.h"
 #include "../Core/TlsSocket.h"
+#include "../Core/TlsSocketPrivate_epoll.h"
 #include <chrono>
 
 
@@ -27,12 +28,13 @@ namespace Kourier
 HttpConnectionHandlerFactory::HttpConnectionHandlerFactory(const HttpServerOptions &httpServerOptions,
     const HttpRequestRouter &httpRequestRouter,
     const TlsConfiguration &tlsConfiguration,
-    std::shared_ptr<ErrorHandler> pErrorHandler) :
+    std::shared_ptr<ErrorHandler> pErrorHandler,
+    std::shared_ptr<TlsCertificateStore> pTlsCertificateStore) :
     m_httpServerOptions(httpServerOptions),
     m_pHttpRequestRouter(std::make_shared<HttpRequestRouter>(httpRequestRouter)),
     m_pErrorHandler(pErrorHandler),
     m_tlsConfiguration(tlsConfiguration),
-    m_tlsContext(TlsContext::Role::Server, m_tlsConfiguration),
+    m_tlsContext(serverTlsContext(m_tlsConfiguration, pTlsCertificateStore)),
     m_pHttpRequestLimits(new HttpRequestLimits{.maxUrlSize = static_cast<size_t>(m_httpServerOptions.getOption(HttpServer::ServerOption::MaxUrlSize)),
                                                .maxHeaderNameSize = static_cast<size_t>(m_httpServerOptions.getOption(HttpServer::ServerOption::MaxHeaderNameSize)),
                                                .maxHeaderValueSize = static_cast<size_t>(m_httpServerOptions.getOption(HttpServer::ServerOption::MaxHeaderValueSize)),
@@ -52,7 +54,13 @@ HttpConnectionHandlerFactory::HttpConnectionHandlerFactory(const HttpServerOptio
 
 ConnectionHandler *HttpConnectionHandlerFactory::create(qintptr socketDescriptor)
 {
-    TcpSocket *pSocket = m_isEncrypted ? new TlsSocket(socketDescriptor, m_tlsConfiguration) : new TcpSocket(socketDescriptor);
+    TcpSocket *pSocket = nullptr;
+    if (!m_isEncrypted)
+        pSocket = new TcpSocket(socketDescriptor);
+    else if (!m_tlsContext.isNull())
+        pSocket = TlsSocketPrivate::createServerSocket(socketDescriptor, m_tlsContext);
+    else
+        pSocket = new TlsSocket(socketDescriptor, m_tlsConfiguration);
     if (pSocket->state() != TcpSocket::State::Connected)
     {
         delete pSocket;
@@ -67,4 +75,21 @@ ConnectionHandler *HttpConnectionHandlerFactory::create(qintptr socketDescriptor
                                          m_pErrorHandler);
 }
 
+TlsContext HttpConnectionHandlerFactory::serverTlsContext(const TlsConfiguration &tlsConfiguration, std::shared_ptr<TlsCertificateStore> pTlsCertificateStore)
+{
+    // Factories are created on their worker's thread, so the context is resolved once per worker
+    // from the thread's context cache and accepted sockets do not have to look it up again.
+    if (tlsConfiguration == TlsConfiguration())
+        return {};
+    try
+    {
+        return TlsContext::fromTlsConfiguration(tlsConfiguration, TlsContext::Role::Server, pTlsCertificateStore);
+    }
+    catch (const RuntimeError&)
+    {
+        // Sockets are created from the configuration instead and report the error.
+        return {};
+    }
+}
+
 }
@@ -24,6 +24,7 @@
 #include "ErrorHandler.h"
 #include "../Core/TlsConfiguration.h"
 #include "../Core/TlsContext.h"
+#include "../Core/TlsCertificateStore.h"
 #include "../Server/ConnectionHandlerFactory.h"
 #include <memory>
 
@@ -37,10 +38,14 @@ public:
     HttpConnectionHandlerFactory(const HttpServerOptions &httpServerOptions,
                                  const HttpRequestRouter &httpRequestRouter,
                                  const TlsConfiguration &tlsConfiguration,
-                                 std::shared_ptr<ErrorHandler> pErrorHandler = {});
+                                 std::shared_ptr<ErrorHandler> pErrorHandler = {},
+                                 std::shared_ptr<TlsCertificateStore> pTlsCertificateStore = {});
     ~HttpConnectionHandlerFactory() override = default;
     ConnectionHandler *create(qintptr socketDescriptor) override;
 
+private:
+    static TlsContext serverTlsContext(const TlsConfiguration &tlsConfiguration, std::shared_ptr<TlsCertificateStore> pTlsCertificateStore);
+
 private:
     const HttpServerOptions m_httpServerOptions;
     const HttpRequestRouter m_httpRequestRouter;
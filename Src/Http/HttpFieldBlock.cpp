@@ -16,44 +16,156 @@
 //
 
 #include "HttpFieldBlock.h"
+#include <array>
 #include <strings.h>
 
 
 namespace Kourier
 {
 
+namespace
+{
+
+// FNV-1a on ASCII-lowercased bytes. As lowercasing is done by setting bit 5,
+// a few non-letters alias each other, so hash matches are always confirmed with strncasecmp.
+// Names split by the ring buffer's wrap are hashed by passing the hash of their first part on.
+constexpr uint32_t hashFieldName(std::string_view fieldName, uint32_t hash = 2166136261u)
+{
+    for (const auto ch : fieldName)
+    {
+        hash ^= static_cast<uint8_t>(ch | 0x20);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+constexpr std::string_view wellKnownFieldNames[] = {
+    "host",
+    "connection",
+    "content-length",
+    "content-type",
+    "content-encoding",
+    "transfer-encoding",
+    "te",
+    "trailer",
+    "expect",
+    "upgrade",
+    "accept",
+    "accept-encoding",
+    "accept-language",
+    "authorization",
+    "cache-control",
+    "cookie",
+    "if-match",
+    "if-none-match",
+    "if-modified-since",
+    "if-unmodified-since",
+    "if-range",
+    "range",
+    "origin",
+    "referer",
+    "user-agent",
+    "x-forwarded-for",
+    "x-forwarded-proto",
+    "x-request-id"
+};
+
+constexpr size_t wellKnownFieldSlotBits = 6;
+
+constexpr uint32_t wellKnownFieldSlot(uint32_t nameHash, uint32_t seed)
+{
+    return (nameHash * seed) >> (32 - wellKnownFieldSlotBits);
+}
+
+constexpr uint32_t findPerfectHashSeed()
+{
+    for (uint32_t seed = 1; seed < (1u << 20); seed += 2)
+    {
+        bool usedSlots[1 << wellKnownFieldSlotBits] = {};
+        bool isPerfectHash = true;
+        for (const auto fieldName : wellKnownFieldNames)
+        {
+            const auto slot = wellKnownFieldSlot(hashFieldName(fieldName), seed);
+            if (usedSlots[slot])
+            {
+                isPerfectHash = false;
+                break;
+            }
+            usedSlots[slot] = true;
+        }
+        if (isPerfectHash)
+            return seed;
+    }
+    return 0;
+}
+
+constexpr uint32_t perfectHashSeed = findPerfectHashSeed();
+static_assert(perfectHashSeed != 0, "Failed to find a perfect hash for well-known field names.");
+
+struct WellKnownFieldName {std::string_view name; uint32_t nameHash = 0;};
+
+constexpr auto wellKnownFieldNameSlots = []()
+{
+    std::array<WellKnownFieldName, (1 << wellKnownFieldSlotBits)> slots{};
+    for (const auto fieldName : wellKnownFieldNames)
+    {
+        const auto nameHash = hashFieldName(fieldName);
+        slots[wellKnownFieldSlot(nameHash, perfectHashSeed)] = {fieldName, nameHash};
+    }
+    return slots;
+}();
+
+inline bool isWellKnownFieldName(uint32_t slot, std::string_view fieldNameHead, std::string_view fieldNameTail, uint32_t nameHash)
+{
+    const auto &wellKnownFieldName = wellKnownFieldNameSlots[slot];
+    return wellKnownFieldName.nameHash == nameHash
+           && wellKnownFieldName.name.size() == (fieldNameHead.size() + fieldNameTail.size())
+           && 0 == strncasecmp(wellKnownFieldName.name.data(), fieldNameHead.data(), fieldNameHead.size())
+           && (fieldNameTail.empty() || 0 == strncasecmp(wellKnownFieldName.name.data() + fieldNameHead.size(), fieldNameTail.data(), fieldNameTail.size()));
+}
+
+}
+
 void HttpFieldBlock::addFieldLine(size_t fieldNameStartIndex,
                                   size_t fieldNameEndIndex,
                                   size_t fieldValueStartIndex,
                                   size_t fieldValueEndIndex)
 {
+    static_assert(sizeof(m_wellKnownFieldsMask) * 8 == m_wellKnownFieldSlotCount && (1 << wellKnownFieldSlotBits) == m_wellKnownFieldSlotCount);
     assert(m_fieldLinesCount < (maxFieldLines() - 1));
-    m_entries[m_fieldLinesCount++] = FieldNameValueSizes{.nameSize = static_cast<uint16_t>(1 + fieldNameEndIndex - fieldNameStartIndex),
-                                                       .valueSize = static_cast<uint16_t>((fieldValueEndIndex >= fieldValueStartIndex) ? 1 + fieldValueEndIndex - fieldValueStartIndex : 0)};
+    const auto nameSize = static_cast<uint16_t>(1 + fieldNameEndIndex - fieldNameStartIndex);
+    // Names are read in place, as slicing names that wrap around the read buffer would copy them.
+    const auto [fieldNameHead, fieldNameTail] = m_pIoChannel->peekSlices(fieldNameStartIndex, nameSize);
+    const auto nameHash = hashFieldName(fieldNameTail, hashFieldName(fieldNameHead));
+    const auto index = m_fieldLinesCount++;
+    m_entries[index] = FieldLineEntry{.nameOffset = static_cast<uint32_t>(fieldNameStartIndex - m_fieldBlockStartIndex),
+                                      .nameHash = nameHash,
+                                      .nameSize = nameSize,
+                                      .valueSize = static_cast<uint16_t>((fieldValueEndIndex >= fieldValueStartIndex) ? 1 + fieldValueEndIndex - fieldValueStartIndex : 0)};
+    const auto slot = wellKnownFieldSlot(nameHash, perfectHashSeed);
+    if (isWellKnownFieldName(slot, fieldNameHead, fieldNameTail, nameHash))
+    {
+        const auto slotBit = uint64_t(1) << slot;
+        if (m_wellKnownFieldsMask & slotBit)
+            ++m_wellKnownFields[slot].count;
+        else
+        {
+            m_wellKnownFieldsMask |= slotBit;
+            m_wellKnownFields[slot] = WellKnownField{.firstIndex = index, .count = 1};
+        }
+    }
 }
 
 bool HttpFieldBlock::hasField(std::string_view fieldName) const
 {
     if (!fieldName.empty())
     {
-        auto nameStartIndex = m_fieldBlockStartIndex;
-        for (auto i = 0; i < m_fieldLinesCount; ++i)
-        {
-            const auto &currentFieldSize = m_entries[i];
-            const auto currentNameStartIndex = nameStartIndex;
-            nameStartIndex += currentFieldSize.nameSize + currentFieldSize.valueSize + 3;
-            if (fieldName.size() != currentFieldSize.nameSize)
-                continue;
-            else
-            {
-                const auto currentFieldName = m_pIoChannel->slice(currentNameStartIndex, currentFieldSize.nameSize);
-                if (0 != strncasecmp(currentFieldName.data(), fieldName.data(), fieldName.size()))
-                    continue;
-                else
-                    return true;
-            }
-        }
-        return false;
+        const auto nameHash = hashFieldName(fieldName);
+        WellKnownField wellKnownField;
+        if (findWellKnownField(fieldName, nameHash, wellKnownField))
+            return wellKnownField.count > 0;
+        else
+            return findField(fieldName, nameHash, 0) >= 0;
     }
     else
         return false;
@@ -64,72 +176,85 @@ int HttpFieldBlock::fieldCount(std::string_view fieldName) const
     int matchCount = 0;
     if (!fieldName.empty())
     {
-        auto nameStartIndex = m_fieldBlockStartIndex;
-        for (auto i = 0; i < m_fieldLinesCount; ++i)
-        {
-            const auto &currentFieldSize = m_entries[i];
-            const auto currentNameStartIndex = nameStartIndex;
-            nameStartIndex += currentFieldSize.nameSize + currentFieldSize.valueSize + 3;
-            if (fieldName.size() != currentFieldSize.nameSize)
-                continue;
-            else
-            {
-                const auto currentFieldName = m_pIoChannel->slice(currentNameStartIndex, currentFieldSize.nameSize);
-                if (0 != strncasecmp(currentFieldName.data(), fieldName.data(), fieldName.size()))
-                    continue;
-                else
-                    ++matchCount;
-            }
-        }
+        const auto nameHash = hashFieldName(fieldName);
+        WellKnownField wellKnownField;
+        if (findWellKnownField(fieldName, nameHash, wellKnownField))
+            return wellKnownField.count;
+        for (auto index = findField(fieldName, nameHash, 0); index >= 0; index = findField(fieldName, nameHash, index + 1))
+            ++matchCount;
     }
     return matchCount;
 }
 
 std::string_view HttpFieldBlock::fieldValue(std::string_view fieldName, int pos) const
 {
-    int currentPos = 0;
-    if (!fieldName.empty())
+    if (!fieldName.empty() && pos > 0)
     {
-        auto nameStartIndex = m_fieldBlockStartIndex;
-        for (auto i = 0; i < m_fieldLinesCount; ++i)
+        const auto nameHash = hashFieldName(fieldName);
+        WellKnownField wellKnownField;
+        int index = -1;
+        if (findWellKnownField(fieldName, nameHash, wellKnownField))
         {
-            const auto &currentFieldSize = m_entries[i];
-            const auto currentNameStartIndex = nameStartIndex;
-            nameStartIndex += currentFieldSize.nameSize + currentFieldSize.valueSize + 3;
-            if (fieldName.size() != currentFieldSize.nameSize)
-                continue;
-            else
-            {
-                const auto currentFieldName = m_pIoChannel->slice(currentNameStartIndex, currentFieldSize.nameSize);
-                if (0 != strncasecmp(currentFieldName.data(), fieldName.data(), fieldName.size()))
-                    continue;
-                else
-                {
-                    if (++currentPos == pos)
-                    {
-                        if (currentFieldSize.valueSize > 0)
-                        {
-                            const int64_t currentFieldValueStartIndex = currentNameStartIndex + currentFieldSize.nameSize + 1;
-                            const auto rawFieldValue = m_pIoChannel->slice(currentFieldValueStartIndex, currentFieldSize.valueSize);
-                            const char *pBegin = rawFieldValue.data();
-                            const char *pEnd = rawFieldValue.data() + rawFieldValue.size() - 1;
-                            while (pBegin < pEnd && (0x20 == *pEnd || 0x09 == *pEnd))
-                                --pEnd;
-                            while (pBegin < pEnd && (0x20 == *pBegin || 0x09 == *pBegin))
-                                ++pBegin;
-                            if ((pEnd > pBegin) || (0x09 != *pBegin && 0x20 != *pBegin))
-                                return std::string_view(pBegin, pEnd - pBegin + 1);
-                            else
-                                return {};
-                        }
-                        else
-                            return {};
-                    }
-                }
-            }
+            if (pos > wellKnownField.count)
+                return {};
+            index = wellKnownField.firstIndex;
         }
+        else
+            index = findField(fieldName, nameHash, 0);
+        for (auto currentPos = 1; currentPos < pos && index >= 0; ++currentPos)
+            index = findField(fieldName, nameHash, index + 1);
+        if (index >= 0)
+            return fieldValueAt(index);
     }
     return {};
 }
 
+bool HttpFieldBlock::findWellKnownField(std::string_view fieldName, uint32_t nameHash, WellKnownField &wellKnownField) const
+{
+    const auto slot = wellKnownFieldSlot(nameHash, perfectHashSeed);
+    if (isWellKnownFieldName(slot, fieldName, {}, nameHash))
+    {
+        wellKnownField = (m_wellKnownFieldsMask & (uint64_t(1) << slot)) ? m_wellKnownFields[slot] : WellKnownField{};
+        return true;
+    }
+    else
+        return false;
+}
+
+int HttpFieldBlock::findField(std::string_view fieldName, uint32_t nameHash, int startIndex) const
+{
+    for (auto i = startIndex; i < m_fieldLinesCount; ++i)
+    {
+        const auto &entry = m_entries[i];
+        if (entry.nameHash != nameHash || entry.nameSize != fieldName.size())
+            continue;
+        const auto currentFieldName = m_pIoChannel->slice(m_fieldBlockStartIndex + entry.nameOffset, entry.nameSize);
+        if (0 == strncasecmp(currentFieldName.data(), fieldName.data(), fieldName.size()))
+            return i;
+    }
+    return -1;
+}
+
+std::string_view HttpFieldBlock::fieldValueAt(int index) const
+{
+    const auto &entry = m_entries[index];
+    if (entry.valueSize > 0)
+    {
+        const int64_t fieldValueStartIndex = m_fieldBlockStartIndex + entry.nameOffset + entry.nameSize + 1;
+        const auto rawFieldValue = m_pIoChannel->slice(fieldValueStartIndex, entry.valueSize);
+        const char *pBegin = rawFieldValue.data();
+        const char *pEnd = rawFieldValue.data() + rawFieldValue.size() - 1;
+        while (pBegin < pEnd && (0x20 == *pEnd || 0x09 == *pEnd))
+            --pEnd;
+        while (pBegin < pEnd && (0x20 == *pBegin || 0x09 == *pBegin))
+            ++pBegin;
+        if ((pEnd > pBegin) || (0x09 != *pBegin && 0x20 != *pBegin))
+            return std::string_view(pBegin, pEnd - pBegin + 1);
+        else
+            return {};
+    }
+    else
+        return {};
+}
+
 }
@@ -21,13 +21,17 @@
 #include "../Core/IOChannel.h"
 #include <string_view>
 #include <limits>
+#include <cstdint>
 
 
 namespace Kourier
 {
 
-struct FieldNameValueSizes {uint16_t nameSize = 0; uint16_t valueSize = 0;};
+struct FieldLineEntry {uint32_t nameOffset = 0; uint32_t nameHash = 0; uint16_t nameSize = 0; uint16_t valueSize = 0;};
 
+// Field lines are indexed by a case-insensitive hash of their names as they are parsed.
+// Well-known field names also get a slot, assigned by a perfect hash computed at compile
+// time, holding the index of their first occurrence and their count.
 class HttpFieldBlock
 {
 public:
@@ -39,18 +43,28 @@ public:
                       size_t fieldValueEndIndex);
     bool hasField(std::string_view fieldName) const;
     int fieldCount(std::string_view fieldName) const;
-    inline void reset(size_t fieldBlockStartIndex) {m_fieldBlockStartIndex = fieldBlockStartIndex; m_fieldLinesCount = 0;}
+    inline void reset(size_t fieldBlockStartIndex) {m_fieldBlockStartIndex = fieldBlockStartIndex; m_fieldLinesCount = 0; m_wellKnownFieldsMask = 0;}
     std::string_view fieldValue(std::string_view fieldName, int pos = 1) const;
     inline int fieldLinesCount() const {return m_fieldLinesCount;}
-    constexpr static size_t maxFieldLines() {return sizeof(m_entries)/sizeof(FieldNameValueSizes);}
+    constexpr static size_t maxFieldLines() {return m_maxFieldLines;}
     constexpr static size_t maxFieldNameSize() {return std::numeric_limits<uint16_t>::max();}
     constexpr static size_t maxFieldValueSize() {return std::numeric_limits<uint16_t>::max();}
 
 private:
+    struct WellKnownField {uint8_t firstIndex = 0; uint8_t count = 0;};
+    bool findWellKnownField(std::string_view fieldName, uint32_t nameHash, WellKnownField &wellKnownField) const;
+    int findField(std::string_view fieldName, uint32_t nameHash, int startIndex) const;
+    std::string_view fieldValueAt(int index) const;
+
+private:
+    static constexpr size_t m_maxFieldLines = 128;
+    static constexpr size_t m_wellKnownFieldSlotCount = 64;
     IOChannel *m_pIoChannel;
     size_t m_fieldBlockStartIndex = 0;
     uint8_t m_fieldLinesCount = 0;
-    FieldNameValueSizes m_entries[128];
+    uint64_t m_wellKnownFieldsMask = 0;
+    WellKnownField m_wellKnownFields[m_wellKnownFieldSlotCount];
+    FieldLineEntry m_entries[m_maxFieldLines];
 };
 
 }
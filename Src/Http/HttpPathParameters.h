@@ -0,0 +1,72 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_HTTP_PATH_PARAMETERS_H
+#define KOURIER_HTTP_PATH_PARAMETERS_H
+
+#include <string_view>
+#include <cstddef>
+
+
+namespace Kourier
+{
+
+class HttpPathParameters
+{
+public:
+    HttpPathParameters() = default;
+    ~HttpPathParameters() = default;
+    static constexpr size_t maxCount() {return m_maxCount;}
+    inline size_t count() const {return m_count;}
+    inline void clear() {m_count = 0;}
+    // Values are kept as positions in the matched path because the path can be a view into a
+    // temporary buffer, such as the one RingBuffer uses for slices spanning its wrap point.
+    inline bool add(std::string_view name, size_t valueIndex, size_t valueSize)
+    {
+        if (m_count == m_maxCount)
+            return false;
+        m_names[m_count] = name;
+        m_valueIndexes[m_count] = valueIndex;
+        m_valueSizes[m_count++] = valueSize;
+        return true;
+    }
+    inline std::string_view name(size_t index) const {return index < m_count ? m_names[index] : std::string_view{};}
+    inline size_t indexOf(std::string_view name) const
+    {
+        for (size_t i = 0; i < m_count; ++i)
+        {
+            if (m_names[i] == name)
+                return i;
+        }
+        return m_count;
+    }
+    inline size_t valueIndex(size_t index) const {return index < m_count ? m_valueIndexes[index] : 0;}
+    inline size_t valueSize(size_t index) const {return index < m_count ? m_valueSizes[index] : 0;}
+    inline std::string_view value(size_t index, std::string_view path) const {return index < m_count ? path.substr(m_valueIndexes[index], m_valueSizes[index]) : std::string_view{};}
+    inline std::string_view value(std::string_view name, std::string_view path) const {return value(indexOf(name), path);}
+
+private:
+    static constexpr size_t m_maxCount = 16;
+    std::string_view m_names[m_maxCount];
+    size_t m_valueIndexes[m_maxCount];
+    size_t m_valueSizes[m_maxCount];
+    size_t m_count = 0;
+};
+
+}
+
+#endif // KOURIER_HTTP_PATH_PARAMETERS_H
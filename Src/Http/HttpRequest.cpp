@@ -79,6 +79,18 @@ Returns the request path.
 Returns the request query. Returns an empty string view if the request has no query.
 */
 
+/*!
+\fn HttpRequest::pathParametersCount()
+Returns the number of parameter and wildcard segments captured from the request path by the route that matched the request.
+*/
+
+/*!
+\fn HttpRequest::pathParameter(std::string_view name)
+Returns the value captured from the request path for the parameter or wildcard segment named \a name in the route that
+matched the request. For example, a request to /users/42/posts handled by the route /users/{id}/posts has the path parameter
+id set to 42. Returns an empty string view if the route has no segment named \a name.
+*/
+
 /*!
 \fn HttpRequest::headersCount()
 Returns the number of field lines in the header block.
@@ -190,6 +202,18 @@ std::string_view HttpRequest::targetQuery() const
     return d->targetQuery();
 }
 
+size_t HttpRequest::pathParametersCount() const
+{
+    Q_D(const HttpRequest);
+    return d->pathParameters().count();
+}
+
+std::string_view HttpRequest::pathParameter(std::string_view name) const
+{
+    Q_D(const HttpRequest);
+    return d->pathParameter(name);
+}
+
 size_t HttpRequest::headersCount() const
 {
     Q_D(const HttpRequest);
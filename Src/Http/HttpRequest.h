@@ -36,6 +36,8 @@ public:
     Method method() const;
     std::string_view targetPath() const;
     std::string_view targetQuery() const;
+    size_t pathParametersCount() const;
+    std::string_view pathParameter(std::string_view name) const;
     size_t headersCount() const;
     size_t headerCount(std::string_view name) const;
     bool hasHeader(std::string_view name) const;
@@ -71,6 +71,13 @@ public:
             m_requestBodySize += currentBodyPartSize;
         m_pendingBodySize -= currentBodyPartSize;
     }
+    inline void appendChunkToCurrentBodyPart(size_t chunkDataSize, size_t appendedSize)
+    {
+        assert(chunked() && m_pendingBodySize == 0 && appendedSize <= chunkDataSize);
+        m_currentBodyPartSize += appendedSize;
+        m_requestBodySize += appendedSize;
+        m_pendingBodySize = chunkDataSize - appendedSize;
+    }
 
 private:
     size_t m_requestBodySize = 0;
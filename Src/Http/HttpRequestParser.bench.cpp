@@ -16,13 +16,16 @@
 //
 
 #include "HttpRequestParser.h"
+#include "HttpCharacterScanner.h"
 #include "../Core/IOChannel.h"
 #include <Spectator>
+#include <QElapsedTimer>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
 #include <utility>
+#include <x86intrin.h>
 
 using Kourier::HttpRequestParser;
 using Kourier::HttpRequest;
@@ -32,6 +35,7 @@ using Kourier::DataSink;
 using Kourier::RingBuffer;
 using Kourier::HttpRequestLimits;
 using Kourier::HttpServer;
+using Kourier::HttpCharacterScanner;
 
 
 namespace Test::HttpRequestParser
@@ -5431,6 +5435,187 @@ SCENARIO("HttpRequestParser enforces limit on chunk metadata")
 }
 
 
+SCENARIO("HttpRequestParser parses pipelined requests crossing the read buffer wrap point")
+{
+    GIVEN("a read buffer that keeps pipelined requests wrapping around its end")
+    {
+        const auto isMirrored = GENERATE(AS(bool), false, true);
+        std::string request("GET /plaintext?key=value&other_key=other_value HTTP/1.1\r\n"
+                            "Host: host.com\r\n"
+                            "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0.0.0 Safari/537.36\r\n"
+                            "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8\r\n"
+                            "Accept-Language: en-US,en;q=0.9\r\n"
+                            "Accept-Encoding: gzip, deflate, br\r\n"
+                            "Cookie: session_id=0123456789abcdef0123456789abcdef; theme=dark; tracking=disabled\r\n"
+                            "Connection: keep-alive\r\n\r\n");
+        constexpr size_t readBufferCapacity = 4096;
+        IOChannelTest ioChannel("");
+        REQUIRE(ioChannel.readBuffer().setCapacity(readBufferCapacity));
+        REQUIRE(ioChannel.readBuffer().setMirrored(isMirrored));
+        REQUIRE(ioChannel.readBuffer().isMirrored() == isMirrored);
+        const size_t pipelinedRequestCount = readBufferCapacity / request.size();
+        for (size_t i = 0; i < pipelinedRequestCount; ++i)
+            REQUIRE(ioChannel.readBuffer().write(request) == request.size());
+        HttpRequestParser parser(ioChannel, std::make_shared<HttpRequestLimits>());
+
+        WHEN("requests are parsed while new ones keep arriving")
+        {
+            constexpr int64_t iterations = 2000000;
+            int64_t counter = 0;
+            QElapsedTimer timer;
+            timer.start();
+            do
+            {
+                if (HttpRequestParser::ParserStatus::ParsedRequest != parser.parse() || parser.request().targetPath() != "/plaintext")
+                    FAIL("Failed to parse request");
+                ioChannel.readBuffer().write(request);
+            }
+            while (++counter < iterations);
+            const auto elapsedTime = timer.nsecsElapsed();
+
+            THEN("parser processes all requests")
+            {
+                WARN(QByteArray("Parser processed ")
+                         .append(QByteArray::number((1000000000.0 * iterations) / elapsedTime))
+                         .append(" req/s with ")
+                         .append(isMirrored ? "mirrored" : "heap-allocated")
+                         .append(" read buffer.").constData());
+            }
+        }
+    }
+}
+
+
+SCENARIO("HttpRequestParser decodes chunked bodies made of chunks of any size")
+{
+    GIVEN("a chunked request whose body is split in chunks of the same size")
+    {
+        const auto chunkSize = GENERATE(AS(size_t), 1, 16, 256, 4096, 65536);
+        constexpr size_t bodySize = 1 << 20;
+        constexpr size_t readSize = 1 << 16;
+        std::string request("POST /upload HTTP/1.1\r\nHost: host.com\r\nTransfer-Encoding: chunked\r\n\r\n");
+        const std::string chunkMetadata = QByteArray::number(qsizetype(chunkSize), 16).append("\r\n").toStdString();
+        const std::string chunkData(chunkSize, 'a');
+        for (size_t i = 0; i < bodySize; i += chunkSize)
+            request.append(chunkMetadata).append(chunkData).append("\r\n");
+        request.append("0\r\n\r\n");
+
+        WHEN("request is parsed as it arrives in fixed-size reads")
+        {
+            constexpr int iterations = 20;
+            int64_t bodyPartCount = 0;
+            int64_t readCount = 0;
+            QElapsedTimer timer;
+            timer.start();
+            for (int i = 0; i < iterations; ++i)
+            {
+                IOChannelTest ioChannel({});
+                HttpRequestParser parser(ioChannel, std::make_shared<HttpRequestLimits>());
+                size_t writtenSize = 0;
+                size_t receivedBodySize = 0;
+                bool hasParsedRequestMetadata = false;
+                while (true)
+                {
+                    const auto parserStatus = parser.parse();
+                    if (parserStatus == HttpRequestParser::ParserStatus::NeedsMoreData)
+                    {
+                        // Parsers asking for more data once the whole request is buffered would spin forever.
+                        if (writtenSize == request.size())
+                            FAIL("Failed to parse chunked body");
+                        const auto size = std::min(readSize, request.size() - writtenSize);
+                        ioChannel.readBuffer().write(request.data() + writtenSize, size);
+                        writtenSize += size;
+                        ++readCount;
+                    }
+                    else if (parserStatus == HttpRequestParser::ParserStatus::ParsedBody)
+                    {
+                        receivedBodySize += parser.request().body().size();
+                        ++bodyPartCount;
+                    }
+                    else if (parserStatus == HttpRequestParser::ParserStatus::ParsedRequest && !hasParsedRequestMetadata)
+                        hasParsedRequestMetadata = true;
+                    else
+                        break;
+                }
+                if (receivedBodySize != bodySize)
+                    FAIL("Failed to parse chunked body");
+            }
+            const auto elapsedTime = timer.nsecsElapsed();
+
+            THEN("parser delivers body data in about one part per read")
+            {
+                WARN(QByteArray("Parser decoded chunked body with ")
+                         .append(QByteArray::number(qsizetype(chunkSize)))
+                         .append("-byte chunks at ")
+                         .append(QByteArray::number((1000.0 * iterations * bodySize) / elapsedTime))
+                         .append(" MB/s delivering ")
+                         .append(QByteArray::number(double(bodyPartCount) / readCount))
+                         .append(" body parts per read.").constData());
+            }
+        }
+    }
+}
+
+
+SCENARIO("HttpCharacterScanner kernels scan character runs at a few cycles per byte")
+{
+    GIVEN("a run of characters matching all character classes")
+    {
+        using InstructionSet = HttpCharacterScanner::InstructionSet;
+        using Kernels = HttpCharacterScanner::Kernels;
+        const auto instructionSet = GENERATE(AS(InstructionSet),
+                                             InstructionSet::Scalar,
+                                             InstructionSet::SSE42,
+                                             InstructionSet::AVX2,
+                                             InstructionSet::AVX512BW);
+        if (!HttpCharacterScanner::isSupported(instructionSet))
+            return;
+        const auto &kernels = HttpCharacterScanner::kernels(instructionSet);
+        const auto kernel = GENERATE(AS(std::pair<std::string_view, HttpCharacterScanner::T_Kernel Kernels::*>),
+                                     {"url path", &Kernels::countUrlAbsolutePathChars},
+                                     {"url query", &Kernels::countUrlQueryChars},
+                                     {"field name", &Kernels::countFieldNameChars},
+                                     {"field value", &Kernels::countFieldValueChars},
+                                     {"hex digits", &Kernels::countHexDigits});
+        constexpr size_t runSize = 4096;
+        const std::string run(runSize + HttpCharacterScanner::maxBlockSize(), 'a');
+        const auto pKernel = kernels.*(kernel.second);
+
+        WHEN("the run is scanned repeatedly")
+        {
+            constexpr int64_t iterations = 100000;
+            size_t scannedBytes = 0;
+            const auto startCycles = __rdtsc();
+            for (int64_t i = 0; i < iterations; ++i)
+            {
+                size_t index = 0;
+                while (index < runSize)
+                {
+                    const auto matchCount = pKernel(run.data() + index);
+                    index += matchCount;
+                    if (matchCount != kernels.blockSize)
+                        break;
+                }
+                scannedBytes += index;
+            }
+            const auto elapsedCycles = __rdtsc() - startCycles;
+
+            THEN("kernels scan the whole run")
+            {
+                REQUIRE(scannedBytes == iterations * runSize);
+                const char *instructionSetNames[] = {"Scalar", "SSE4.2", "AVX2", "AVX-512BW"};
+                WARN(QByteArray(instructionSetNames[static_cast<int>(instructionSet)])
+                         .append(" ")
+                         .append(kernel.first.data(), kernel.first.size())
+                         .append(" kernel: ")
+                         .append(QByteArray::number(double(elapsedCycles) / scannedBytes))
+                         .append(" cycles/byte.").constData());
+            }
+        }
+    }
+}
+
+
 // SCENARIO("HttpRequestParser parses the same http request without headers and body sequentially")
 // {
 //    GIVEN("a get request")
@@ -25,15 +25,23 @@
 namespace Kourier
 {
 
+static_assert(HttpCharacterScanner::maxBlockSize() <= SimdIterator::maxBlockSize());
+
 HttpRequestParser::HttpRequestParser(IOChannel &pIOChannel,
                                      std::shared_ptr<HttpRequestLimits> pHttpRequestLimits) :
     m_ioChannel(pIOChannel),
     m_pHttpRequestLimits(pHttpRequestLimits),
+    m_kernels(HttpCharacterScanner::kernels()),
     m_request(new HttpRequestPrivate(pIOChannel))
 {
     assert(m_pHttpRequestLimits);
 }
 
+HttpPathParameters &HttpRequestParser::pathParameters()
+{
+    return m_request.d_ptr->pathParameters();
+}
+
 size_t HttpRequestParser::trailersCount() const
 {
     return (m_trailersSize > 0) ? m_request.d_ptr->trailersCount() : 0;
@@ -54,8 +62,7 @@ std::string_view HttpRequestParser::trailer(std::string_view name, int pos) cons
     return (m_trailersSize > 0) ? m_request.d_ptr->trailer(name, pos) : std::string_view{};
 }
 
-bool HttpRequestParser::validateHeaderLine(SimdIterator &it,
-                                           size_t fieldNameStartIndex,
+bool HttpRequestParser::validateHeaderLine(size_t fieldNameStartIndex,
                                            size_t fieldNameEndIndex,
                                            size_t fieldValueStartIndex,
                                            size_t fieldValueEndIndex)
@@ -82,13 +89,7 @@ bool HttpRequestParser::validateHeaderLine(SimdIterator &it,
         case 14:
         {
             // Let's check if the field name is Content-Length
-            const auto rawData = it.nextAt(fieldNameStartIndex);
-            const auto rawDataFilter = _mm256_setr_epi8(0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0);
-            const auto headerName = _mm256_and_si256(rawData, rawDataFilter);
-            const auto lowerCaseData = _mm256_setr_epi8('c','o','n','t','e','n','t','-','l','e','n','g','t','h',0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0);
-            const auto upperCaseData = _mm256_setr_epi8('C','O','N','T','E','N','T','-','L','E','N','G','T','H',0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0);
-            const auto result = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(headerName, lowerCaseData), _mm256_cmpeq_epi8(headerName, upperCaseData))));
-            if (UINT32_MAX != result)
+            if (Q_LIKELY(0 != strncasecmp(m_ioChannel.slice(fieldNameStartIndex, fieldNameSize).data(), "Content-Length", 14)))
                 return true;
             else
             {
@@ -103,26 +104,20 @@ bool HttpRequestParser::validateHeaderLine(SimdIterator &it,
                     ++pBegin;
                 if (((pEnd - pBegin) < 19) && ((pEnd > pBegin) || !isWhitespace(*pBegin)))
                 {
-                    const auto rawData = it.nextAt(fieldValueStartIndex + (pBegin - contentLengthValueSlice.data()));
-                    const auto lowerBound = _mm256_set1_epi8('0');
-                    const auto upperBound = _mm256_set1_epi8('9');
-                    const auto matchCount = _tzcnt_u32(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpgt_epi8(lowerBound, rawData), _mm256_cmpgt_epi8(rawData, upperBound)))));
-                    if (matchCount >= (pEnd - pBegin + 1))
+                    // Parsing unsigned values rejects signs, so a value is valid
+                    // only if all its characters are parsed as digits.
+                    size_t size = 0;
+                    auto [ptr, ec] {std::from_chars(pBegin, pEnd + 1, size)};
+                    if (std::errc() == ec && ptr == (pEnd + 1))
                     {
-                        std::string_view lengthSlice(pBegin, pEnd - pBegin + 1);
-                        size_t size = 0;
-                        auto [ptr, ec] {std::from_chars(pBegin, pEnd + 1, size)};
-                        if (std::errc() == ec)
+                        switch (m_request.d_ptr->requestBody().bodyType())
                         {
-                            switch (m_request.d_ptr->requestBody().bodyType())
-                            {
-                                case HttpRequest::BodyType::Chunked:
-                                    return false;
-                                case HttpRequest::BodyType::NoBody:
-                                    m_request.d_ptr->requestBody().setNotChunkedBody(size);
-                                case HttpRequest::BodyType::NotChunked:
-                                    return m_request.d_ptr->requestBodySize() == size;
-                            }
+                            case HttpRequest::BodyType::Chunked:
+                                return false;
+                            case HttpRequest::BodyType::NoBody:
+                                m_request.d_ptr->requestBody().setNotChunkedBody(size);
+                            case HttpRequest::BodyType::NotChunked:
+                                return m_request.d_ptr->requestBodySize() == size;
                         }
                     }
                 }
@@ -132,13 +127,7 @@ bool HttpRequestParser::validateHeaderLine(SimdIterator &it,
         case 17:
         {
             // Let's check if the field name is Transfer-Encoding
-            const auto rawData = it.nextAt(fieldNameStartIndex);
-            const auto rawDataFilter = _mm256_setr_epi8(0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0);
-            const auto headerName = _mm256_and_si256(rawData, rawDataFilter);
-            const auto lowerCaseData = _mm256_setr_epi8('t','r','a','n','s','f','e','r','-','e','n','c','o','d','i','n','g',0,0,0,0,0,0,0,0,0,0,0,0,0,0,0);
-            const auto upperCaseData = _mm256_setr_epi8('T','R','A','N','S','F','E','R','-','E','N','C','O','D','I','N','G',0,0,0,0,0,0,0,0,0,0,0,0,0,0,0);
-            const auto result = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(headerName, lowerCaseData), _mm256_cmpeq_epi8(headerName, upperCaseData))));
-            if (UINT32_MAX != result)
+            if (Q_LIKELY(0 != strncasecmp(m_ioChannel.slice(fieldNameStartIndex, fieldNameSize).data(), "Transfer-Encoding", 17)))
                 return true;
             else
             {
@@ -233,6 +222,7 @@ HttpRequestParser::ParserStatus HttpRequestParser::parseRequestLine()
     }
     m_requestSize = 0;
     m_trailersSize = 0;
+    m_currentBodyPartInputSize = 0;
     m_request.d_ptr->clear();
     return parseRequestLineMethod();
 }
@@ -357,14 +347,9 @@ HttpRequestParser::ParserStatus HttpRequestParser::parseRequestLineAbsolutePath(
     SimdIterator it(m_ioChannel);
     while (true)
     {
-        const auto data = it.nextAt(currentIndex);
-        const auto idxRows = _mm256_shuffle_epi8(m_idxRowsMaskLow, _mm256_srli_epi16(_mm256_and_si256(m_rowNibble, data), 4));
-        const auto columnsLow = _mm256_shuffle_epi8(m_urlAbsolutePathLookupTableLow, data);
-        const auto bits = _mm256_and_si256(idxRows, columnsLow);
-        const auto result = _mm256_cmpeq_epi8(bits, m_zero256Bits);
-        const auto matchCount = std::min<size_t>(m_ioChannel.dataAvailable() - 1 - currentIndex, _tzcnt_u32(static_cast<uint32_t>(_mm256_movemask_epi8(result))));
+        const auto matchCount = std::min<size_t>(m_ioChannel.dataAvailable() - 1 - currentIndex, m_kernels.countUrlAbsolutePathChars(it.at(currentIndex)));
         currentIndex += matchCount;
-        if (matchCount == 32)
+        if (matchCount == m_kernels.blockSize)
             continue;
         switch (m_ioChannel.peekChar(currentIndex))
         {
@@ -468,14 +453,9 @@ HttpRequestParser::ParserStatus HttpRequestParser::parseRequestLineQuery()
     SimdIterator it(m_ioChannel);
     while (true)
     {
-        const auto data = it.nextAt(currentIndex);
-        const auto idxRows = _mm256_shuffle_epi8(m_idxRowsMaskLow, _mm256_srli_epi16(_mm256_and_si256(m_rowNibble, data), 4));
-        const auto columnsLow = _mm256_shuffle_epi8(m_urlQueryLookupTableLow, data);
-        const auto bits = _mm256_and_si256(idxRows, columnsLow);
-        const auto result = _mm256_cmpeq_epi8(bits, m_zero256Bits);
-        const auto matchCount = std::min<size_t>(m_ioChannel.dataAvailable() - 1 - currentIndex, _tzcnt_u32(static_cast<uint32_t>(_mm256_movemask_epi8(result))));
+        const auto matchCount = std::min<size_t>(m_ioChannel.dataAvailable() - 1 - currentIndex, m_kernels.countUrlQueryChars(it.at(currentIndex)));
         currentIndex += matchCount;
-        if (matchCount == 32)
+        if (matchCount == m_kernels.blockSize)
             continue;
         switch (m_ioChannel.peekChar(currentIndex))
         {
@@ -629,14 +609,9 @@ HttpRequestParser::ParserStatus HttpRequestParser::parseHeaders()
         const size_t fieldNameStartIndex = currentIndex;
         while (true)
         {
-            const auto data = it.nextAt(currentIndex);
-            const auto idxRows = _mm256_shuffle_epi8(m_idxRowsMaskLow, _mm256_srli_epi16(_mm256_and_si256(m_rowNibble, data), 4));
-            const auto columnsLow = _mm256_shuffle_epi8(m_fieldNameLookupTableLow, data);
-            const auto bits = _mm256_and_si256(idxRows, columnsLow);
-            const auto result = _mm256_cmpeq_epi8(bits, m_zero256Bits);
-            const auto matchCount = std::min<size_t>(m_ioChannel.dataAvailable() - 1 - currentIndex, _tzcnt_u32(static_cast<uint32_t>(_mm256_movemask_epi8(result))));
+            const auto matchCount = std::min<size_t>(m_ioChannel.dataAvailable() - 1 - currentIndex, m_kernels.countFieldNameChars(it.at(currentIndex)));
             currentIndex += matchCount;
-            if (matchCount == 32)
+            if (matchCount == m_kernels.blockSize)
                 continue;
             if (m_ioChannel.peekChar(currentIndex) == ':')
             {
@@ -671,11 +646,9 @@ HttpRequestParser::ParserStatus HttpRequestParser::parseHeaders()
         const size_t fieldValueStartIndex = ++currentIndex;
         while (true)
         {
-            const auto data = it.nextAt(currentIndex);
-            const auto result = _mm256_or_si256(_mm256_cmpeq_epi8(m_del, data), _mm256_andnot_si256(_mm256_cmpeq_epi8(m_htab, data), _mm256_and_si256(_mm256_cmpgt_epi8(data, m_minus1), _mm256_cmpgt_epi8(m_space, data))));
-            const auto matchCount = std::min<size_t>(m_ioChannel.dataAvailable() - 4 - currentIndex, _tzcnt_u32(static_cast<uint32_t>(_mm256_movemask_epi8(result))));
+            const auto matchCount = std::min<size_t>(m_ioChannel.dataAvailable() - 4 - currentIndex, m_kernels.countFieldValueChars(it.at(currentIndex)));
             currentIndex += matchCount;
-            if (matchCount == 32)
+            if (matchCount == m_kernels.blockSize)
                 continue;
             if (m_ioChannel.slice(currentIndex, 2) == "\r\n")
             {
@@ -708,7 +681,7 @@ HttpRequestParser::ParserStatus HttpRequestParser::parseHeaders()
         const size_t fieldValueEndIndex = currentIndex - 1;
         currentIndex += 2;
         m_requestSize = currentIndex;
-        if (!validateHeaderLine(it, fieldNameStartIndex, fieldNameEndIndex, fieldValueStartIndex, fieldValueEndIndex))
+        if (!validateHeaderLine(fieldNameStartIndex, fieldNameEndIndex, fieldValueStartIndex, fieldValueEndIndex))
         {
             setError(HttpServer::ServerError::MalformedRequest);
             return HttpRequestParser::ParserStatus::Failed;
@@ -796,7 +769,8 @@ HttpRequestParser::ParserStatus HttpRequestParser::parseChunkMetadata()
     // quoted-string  = DQUOTE *( qdtext / quoted-pair ) DQUOTE
     // qdtext         = HTAB / SP / %x21 / %x23-5B / %x5D-7E / obs-text
     // quoted-pair    = "\" ( HTAB / SP / VCHAR / obs-text )
-    m_ioChannel.skip(m_request.d_ptr->requestBody().currentBodyPartIndex() + ((m_request.d_ptr->requestBody().currentBodyPartSize() > 0) ? (m_request.d_ptr->requestBody().currentBodyPartSize() + 2) : 0));
+    m_ioChannel.skip(m_request.d_ptr->requestBody().currentBodyPartIndex() + m_currentBodyPartInputSize);
+    m_currentBodyPartInputSize = 0;
     m_request.d_ptr->requestBody().setCurrentBodyPart(0, 0);
     m_request.d_ptr->fieldBlock().reset(0);
     size_t chunkDataSize = 0;
@@ -863,7 +837,8 @@ HttpRequestParser::ParserStatus HttpRequestParser::parseChunkMetadata()
 
 HttpRequestParser::ParserStatus HttpRequestParser::parseChunkData()
 {
-    m_ioChannel.skip(m_request.d_ptr->requestBody().currentBodyPartIndex() + m_request.d_ptr->requestBody().currentBodyPartSize());
+    m_ioChannel.skip(m_request.d_ptr->requestBody().currentBodyPartIndex() + m_currentBodyPartInputSize);
+    m_currentBodyPartInputSize = 0;
     m_request.d_ptr->requestBody().setCurrentBodyPart(0, 0);
     if (m_ioChannel.dataAvailable() < 3)
         return HttpRequestParser::ParserStatus::NeedsMoreData;
@@ -872,7 +847,11 @@ HttpRequestParser::ParserStatus HttpRequestParser::parseChunkData()
         m_requestSize += m_request.d_ptr->requestBody().pendingBodySize() + 2;
         m_request.d_ptr->requestBody().setCurrentBodyPart(0, m_request.d_ptr->requestBody().pendingBodySize());
         if (m_ioChannel.slice(m_request.d_ptr->requestBody().currentBodyPartSize(), 2) == "\r\n")
+        {
             m_parserState = ParserState::ParsingChunkMetadata;
+            m_currentBodyPartInputSize = m_request.d_ptr->requestBody().currentBodyPartSize() + 2;
+            appendBufferedChunks();
+        }
         else
         {
             setError(HttpServer::ServerError::MalformedRequest);
@@ -883,10 +862,55 @@ HttpRequestParser::ParserStatus HttpRequestParser::parseChunkData()
     {
         m_requestSize += m_ioChannel.dataAvailable() - 2;
         m_request.d_ptr->requestBody().setCurrentBodyPart(0, m_ioChannel.dataAvailable() - 2);
+        m_currentBodyPartInputSize = m_request.d_ptr->requestBody().currentBodyPartSize();
     }
     return (m_request.d_ptr->requestBody().currentBodyPartSize() > 0) ? HttpRequestParser::ParserStatus::ParsedBody : HttpRequestParser::ParserStatus::NeedsMoreData;
 }
 
+void HttpRequestParser::appendBufferedChunks()
+{
+    // Data of chunks already in the read buffer is moved right after the current body part,
+    // so that all buffered body data is delivered as a single contiguous part. Decoding stops
+    // at the last chunk, at large chunks, at incomplete chunk metadata and at anything the
+    // regular path must reject, which is then parsed again by parseChunkMetadata.
+    auto &requestBody = m_request.d_ptr->requestBody();
+    while (true)
+    {
+        size_t chunkDataSize = 0;
+        size_t chunkMetadataSize = 0;
+        if (HttpChunkMetadataParser::parse(m_ioChannel, chunkDataSize, chunkMetadataSize, m_currentBodyPartInputSize) != HttpChunkMetadataParser::ChunkMetadataParserStatus::ExpectingChunkData
+            || chunkMetadataSize > m_pHttpRequestLimits->maxChunkMetadataSize
+            || (m_requestSize + chunkMetadataSize + chunkDataSize + 2) > m_pHttpRequestLimits->maxRequestSize
+            || (requestBody.requestBodySize() + chunkDataSize) > m_pHttpRequestLimits->maxBodySize
+            || chunkDataSize > m_maxMovedChunkDataSize)
+            return;
+        const auto chunkDataIndex = m_currentBodyPartInputSize + chunkMetadataSize;
+        const auto bufferedChunkDataSize = m_ioChannel.dataAvailable() - chunkDataIndex;
+        if ((chunkDataSize + 2) <= bufferedChunkDataSize)
+        {
+            if (m_ioChannel.slice(chunkDataIndex + chunkDataSize, 2) != "\r\n")
+                return;
+            m_ioChannel.moveReadData(requestBody.currentBodyPartSize(), chunkDataIndex, chunkDataSize);
+            requestBody.appendChunkToCurrentBodyPart(chunkDataSize, chunkDataSize);
+            m_requestSize += chunkMetadataSize + chunkDataSize + 2;
+            m_currentBodyPartInputSize = chunkDataIndex + chunkDataSize + 2;
+        }
+        else
+        {
+            // As in parseChunkData, the last two buffered bytes are kept until the chunk is complete.
+            if (bufferedChunkDataSize < 3)
+                return;
+            const auto appendedSize = bufferedChunkDataSize - 2;
+            m_ioChannel.moveReadData(requestBody.currentBodyPartSize(), chunkDataIndex, appendedSize);
+            requestBody.appendChunkToCurrentBodyPart(chunkDataSize, appendedSize);
+            m_requestSize += chunkMetadataSize + appendedSize;
+            m_currentBodyPartInputSize = chunkDataIndex + appendedSize;
+            m_parserState = ParserState::ParsingChunkData;
+            return;
+        }
+    }
+}
+
 HttpRequestParser::ParserStatus HttpRequestParser::parseTrailers()
 {
     size_t currentIndex = m_trailersSize;
@@ -901,14 +925,9 @@ HttpRequestParser::ParserStatus HttpRequestParser::parseTrailers()
         const size_t fieldNameStartIndex = currentIndex;
         while (true)
         {
-            const auto data = it.nextAt(currentIndex);
-            const auto idxRows = _mm256_shuffle_epi8(m_idxRowsMaskLow, _mm256_srli_epi16(_mm256_and_si256(m_rowNibble, data), 4));
-            const auto columnsLow = _mm256_shuffle_epi8(m_fieldNameLookupTableLow, data);
-            const auto bits = _mm256_and_si256(idxRows, columnsLow);
-            const auto result = _mm256_cmpeq_epi8(bits, m_zero256Bits);
-            const auto matchCount = std::min<size_t>(m_ioChannel.dataAvailable() - 1 - currentIndex, _tzcnt_u32(static_cast<uint32_t>(_mm256_movemask_epi8(result))));
+            const auto matchCount = std::min<size_t>(m_ioChannel.dataAvailable() - 1 - currentIndex, m_kernels.countFieldNameChars(it.at(currentIndex)));
             currentIndex += matchCount;
-            if (matchCount == 32)
+            if (matchCount == m_kernels.blockSize)
                 continue;
             if (m_ioChannel.peekChar(currentIndex) == ':')
             {
@@ -943,11 +962,9 @@ HttpRequestParser::ParserStatus HttpRequestParser::parseTrailers()
         const size_t fieldValueStartIndex = ++currentIndex;
         while (true)
         {
-            const auto data = it.nextAt(currentIndex);
-            const auto result = _mm256_or_si256(_mm256_cmpeq_epi8(m_del, data), _mm256_andnot_si256(_mm256_cmpeq_epi8(m_htab, data), _mm256_and_si256(_mm256_cmpgt_epi8(data, m_minus1), _mm256_cmpgt_epi8(m_space, data))));
-            const auto matchCount = std::min<size_t>(m_ioChannel.dataAvailable() - 4 - currentIndex, _tzcnt_u32(static_cast<uint32_t>(_mm256_movemask_epi8(result))));
+            const auto matchCount = std::min<size_t>(m_ioChannel.dataAvailable() - 4 - currentIndex, m_kernels.countFieldValueChars(it.at(currentIndex)));
             currentIndex += matchCount;
-            if (matchCount == 32)
+            if (matchCount == m_kernels.blockSize)
                 continue;
             if (m_ioChannel.slice(currentIndex, 2) == "\r\n")
             {
@@ -19,8 +19,10 @@
 #define KOURIER_HTTP_REQUEST_PARSER_H
 
 #include "HttpRequest.h"
+#include "HttpPathParameters.h"
 #include "HttpRequestLimits.h"
 #include "HttpServer.h"
+#include "HttpCharacterScanner.h"
 #include "../Core/IOChannel.h"
 #include "../Core/SimdIterator.h"
 #include <memory>
@@ -60,6 +62,7 @@ public:
     inline size_t requestSize() const {return m_requestSize;}
     inline HttpServer::ServerError error() const {return m_error;}
     const HttpRequest &request() const {return m_request;}
+    HttpPathParameters &pathParameters();
     size_t trailersCount() const;
     size_t trailerCount(std::string_view name) const;
     bool hasTrailer(std::string_view name) const;
@@ -77,9 +80,9 @@ private:
     ParserStatus parseBody();
     ParserStatus parseChunkMetadata();
     ParserStatus parseChunkData();
+    void appendBufferedChunks();
     ParserStatus parseTrailers();
-    bool validateHeaderLine(SimdIterator &it,
-                            size_t fieldNameStartIndex,
+    bool validateHeaderLine(size_t fieldNameStartIndex,
                             size_t fieldNameEndIndex,
                             size_t fieldValueStartIndex,
                             size_t fieldValueEndIndex);
@@ -95,26 +98,20 @@ private:
     }
 
 private:
+    // Larger chunks are delivered in place, as moving them costs more than delivering another body part.
+    static constexpr size_t m_maxMovedChunkDataSize = 4096;
     IOChannel &m_ioChannel;
     std::shared_ptr<HttpRequestLimits> m_pHttpRequestLimits;
+    const HttpCharacterScanner::Kernels &m_kernels;
     size_t m_requestSize = 0;
     size_t m_trailersSize = 0;
+    size_t m_currentBodyPartInputSize = 0;
     HttpRequest m_request;
     HttpServer::ServerError m_error = HttpServer::ServerError::NoError;
     enum class ParserState {ParsingRequestLine, ParsingHeaders, ParsingBody, ParsingChunkMetadata, ParsingChunkData, ParsingTrailers};
     ParserState m_parserState = ParserState::ParsingRequestLine;
     bool m_alreadyProcessedHostHeaderField = false;
     bool m_hasExpectHeader = false;
-    static constexpr __m256i m_idxRowsMaskLow = (__m256i)(__v32qi){char(0x01), char(0x02), char(0x04), char(0x08), char(0x10), char(0x20), char(0x40), char(0x80), char(0x00), char(0x00), char(0x00), char(0x00), char(0x00), char(0x00), char(0x00), char(0x00), char(0x01), char(0x02), char(0x04), char(0x08), char(0x10), char(0x20), char(0x40), char(0x80), char(0x00), char(0x00), char(0x00), char(0x00), char(0x00), char(0x00), char(0x00), char(0x00)};
-    static constexpr __m256i m_rowNibble = (__m256i)(__v32qi){char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0), char(0xF0)};
-    static constexpr __m256i m_zero256Bits = (__m256i)(__v4di){0, 0, 0, 0};
-    static constexpr __m256i m_urlAbsolutePathLookupTableLow = (__m256i)(__v32qi){char(0B10111000), char(0B11111100), char(0B11111000), char(0B11111000), char(0B11111100), char(0B11111000), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B01011100), char(0B01010100), char(0B01011100), char(0B11010100), char(0B01110100), char(0B10111000), char(0B11111100), char(0B11111000), char(0B11111000), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B01011100), char(0B01010100), char(0B01011100), char(0B11010100), char(0B01110100)};
-    static constexpr __m256i m_urlQueryLookupTableLow = (__m256i)(__v32qi){char(0B10111000), char(0B11111100), char(0B11111000), char(0B11111000), char(0B11111100), char(0B11111000), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B01011100), char(0B01010100), char(0B01011100), char(0B11010100), char(0B01111100), char(0B10111000), char(0B11111100), char(0B11111000), char(0B11111000), char(0B11111100), char(0B11111000), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B01011100), char(0B01010100), char(0B01011100), char(0B11010100), char(0B01111100)};
-    static constexpr __m256i m_fieldNameLookupTableLow = (__m256i)(__v32qi){char(0B11101000), char(0B11111100), char(0B11111000), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111000), char(0B11111000), char(0B11110100), char(0B01010100), char(0B11010000), char(0B01010100), char(0B11110100), char(0B01110000), char(0B11101000), char(0B11111100), char(0B11111000), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111100), char(0B11111000), char(0B11111000), char(0B11110100), char(0B01010100), char(0B11010000), char(0B01010100), char(0B11110100), char(0B01110000)};
-    static constexpr __m256i m_htab = (__m256i)(__v32qi){char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09), char(0x09)};
-    static constexpr __m256i m_space = (__m256i)(__v32qi){char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20), char(0x20)};
-    static constexpr __m256i m_del = (__m256i)(__v32qi){char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F), char(0x7F)};
-    static constexpr __m256i m_minus1 = (__m256i)(__v32qi){char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1), char(-1)};
 };
 
 }
@@ -18,6 +18,8 @@
 #include "HttpRequestParser.h"
 #include "../Core/IOChannel.h"
 #include <Spectator>
+#include <algorithm>
+#include <cctype>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -2482,6 +2484,203 @@ SCENARIO("HttpRequestParser parses http requests with headers and no body")
 }
 
 
+namespace Test::HttpRequestParser
+{
+
+// Field names given as lines of a field block, each with the values of its lines in order.
+// Names without values must not be found in the field block.
+//
+// Well-known field names are indexed in perfect-hash slots. X-^-Id and X-~-Id hash the same, as
+// field names are lowercased by setting bit 5 and ^ and ~ only differ in it. X-Amrbxw and X-Awscra
+// have the same hash, and X-Field-4, X-Field-5 and X-Field-7 fall into the slots of Accept,
+// Content-Type and Accept-Language.
+struct IndexedField
+{
+    std::string_view name;
+    std::vector<std::string_view> values;
+};
+
+enum class NameCase {Lower, Upper, Mixed};
+
+static std::string withCase(std::string_view name, NameCase nameCase)
+{
+    std::string result(name);
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        const bool toUpper = (nameCase == NameCase::Upper) || (nameCase == NameCase::Mixed && (i % 2) == 0);
+        result[i] = toUpper ? std::toupper(static_cast<unsigned char>(result[i])) : std::tolower(static_cast<unsigned char>(result[i]));
+    }
+    return result;
+}
+
+// Writes all first lines of given fields, then all second lines and so on, alternating name cases.
+static std::string fieldLines(const std::vector<IndexedField> &fields)
+{
+    std::string lines;
+    size_t maxLineCount = 0;
+    for (const auto &field : fields)
+        maxLineCount = std::max(maxLineCount, field.values.size());
+    for (size_t i = 0; i < maxLineCount; ++i)
+    {
+        for (const auto &field : fields)
+        {
+            if (i < field.values.size())
+                lines.append(withCase(field.name, (i % 2) ? NameCase::Upper : NameCase::Mixed)).append(": ").append(field.values[i]).append("\r\n");
+        }
+    }
+    return lines;
+}
+
+template <typename HasField, typename FieldCount, typename FieldValue>
+static void checkIndexedFields(const std::vector<IndexedField> &fields, HasField hasField, FieldCount fieldCount, FieldValue fieldValue)
+{
+    for (const auto &field : fields)
+    {
+        for (const auto nameCase : {NameCase::Lower, NameCase::Upper, NameCase::Mixed})
+        {
+            const auto name = withCase(field.name, nameCase);
+            REQUIRE(hasField(name) == !field.values.empty());
+            REQUIRE(fieldCount(name) == field.values.size());
+            for (size_t pos = 1; pos <= field.values.size(); ++pos)
+                REQUIRE(fieldValue(name, int(pos)) == field.values[pos - 1]);
+            REQUIRE(fieldValue(name, int(field.values.size()) + 1).empty());
+            REQUIRE(fieldValue(name, 0).empty());
+        }
+    }
+}
+
+}
+
+
+SCENARIO("HttpRequestParser indexes field names case-insensitively")
+{
+    GIVEN("a request with all well-known field names in mixed case, repeated where allowed, and unknown names whose hashes collide")
+    {
+        std::vector<IndexedField> fields;
+        fields.push_back({"host", {"example.com"}});
+        for (const auto name : {"connection", "content-type", "content-encoding", "te", "trailer", "upgrade", "accept",
+                                "accept-encoding", "accept-language", "authorization", "cache-control", "cookie",
+                                "if-match", "if-none-match", "if-modified-since", "if-unmodified-since", "if-range",
+                                "range", "origin", "referer", "user-agent", "x-forwarded-for", "x-forwarded-proto", "x-request-id"})
+            fields.push_back({name, {"first", "second"}});
+        fields.push_back({"x-^-id", {"caret-1", "caret-2"}});
+        fields.push_back({"x-~-id", {"tilde-1"}});
+        fields.push_back({"x-amrbxw", {"amrbxw-1", "amrbxw-2"}});
+        fields.push_back({"x-awscra", {"awscra-1"}});
+        fields.push_back({"x-field-4", {"field-4"}});
+        fields.push_back({"x-field-5", {"field-5-1", "field-5-2"}});
+        fields.push_back({"x-field-7", {"field-7"}});
+        const std::vector<IndexedField> absentFields = {{"content-length", {}}, {"transfer-encoding", {}}, {"expect", {}}, {"x-absent", {}}};
+        const auto request = std::string("GET / HTTP/1.1\r\n").append(fieldLines(fields)).append("\r\n");
+        IOChannelTest ioChannel(request);
+        HttpRequestParser parser(ioChannel, std::make_shared<HttpRequestLimits>());
+
+        WHEN("the request is parsed")
+        {
+            const auto parserStatus = parser.parse();
+
+            THEN("all field lines are found by name in any case, counted and read by position")
+            {
+                REQUIRE(parserStatus == HttpRequestParser::ParserStatus::ParsedRequest);
+                const auto &httpRequest = parser.request();
+                size_t fieldLineCount = 0;
+                for (const auto &field : fields)
+                    fieldLineCount += field.values.size();
+                REQUIRE(httpRequest.headersCount() == fieldLineCount);
+                const auto hasField = [&](std::string_view name) {return httpRequest.hasHeader(name);};
+                const auto fieldCount = [&](std::string_view name) {return httpRequest.headerCount(name);};
+                const auto fieldValue = [&](std::string_view name, int pos) {return httpRequest.header(name, pos);};
+                checkIndexedFields(fields, hasField, fieldCount, fieldValue);
+                checkIndexedFields(absentFields, hasField, fieldCount, fieldValue);
+            }
+        }
+    }
+
+    GIVEN("a request whose field names are split by the wrap of the read buffer")
+    {
+        const std::vector<IndexedField> fields = {{"host", {"example.com"}},
+                                                  {"accept", {"a1", "a2"}},
+                                                  {"cookie", {"c1", "c2"}},
+                                                  {"x-^-id", {"caret"}},
+                                                  {"x-~-id", {"tilde-1", "tilde-2"}},
+                                                  {"x-amrbxw", {"amrbxw-1", "amrbxw-2"}},
+                                                  {"x-awscra", {"awscra"}},
+                                                  {"x-field-4", {"field-4"}}};
+        const std::vector<IndexedField> absentFields = {{"content-length", {}}, {"user-agent", {}}, {"x-absent", {}}};
+        const auto request = std::string("GET / HTTP/1.1\r\n").append(fieldLines(fields)).append("\r\n");
+        static constexpr size_t readBufferCapacity = 1024;
+        REQUIRE(request.size() < readBufferCapacity);
+
+        WHEN("the request is parsed after being written around the end of the read buffer at every position")
+        {
+            THEN("all field lines are found by name in any case, counted and read by position")
+            {
+                for (size_t wrapPos = 1; wrapPos < request.size(); ++wrapPos)
+                {
+                    IOChannelTest ioChannel("");
+                    REQUIRE(ioChannel.setReadBufferCapacity(readBufferCapacity));
+                    const std::string filler(readBufferCapacity - wrapPos, 'F');
+                    REQUIRE(ioChannel.readBuffer().write(filler) == filler.size());
+                    REQUIRE(ioChannel.readBuffer().write(std::string_view(request).substr(0, wrapPos)) == wrapPos);
+                    REQUIRE(ioChannel.readBuffer().popFront(filler.size()) == filler.size());
+                    REQUIRE(ioChannel.readBuffer().write(std::string_view(request).substr(wrapPos)) == (request.size() - wrapPos));
+                    REQUIRE(ioChannel.readBuffer().peekSlices(0, request.size()).second.size() == (request.size() - wrapPos));
+                    HttpRequestParser parser(ioChannel, std::make_shared<HttpRequestLimits>());
+                    REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
+                    const auto &httpRequest = parser.request();
+                    checkIndexedFields(fields,
+                                       [&](std::string_view name) {return httpRequest.hasHeader(name);},
+                                       [&](std::string_view name) {return httpRequest.headerCount(name);},
+                                       [&](std::string_view name, int pos) {return httpRequest.header(name, pos);});
+                    checkIndexedFields(absentFields,
+                                       [&](std::string_view name) {return httpRequest.hasHeader(name);},
+                                       [&](std::string_view name) {return httpRequest.headerCount(name);},
+                                       [&](std::string_view name, int pos) {return httpRequest.header(name, pos);});
+                }
+            }
+        }
+    }
+
+    GIVEN("a chunked request with well-known and colliding field names in its header and trailer sections")
+    {
+        const std::vector<IndexedField> trailers = {{"cache-control", {"t1", "t2"}},
+                                                    {"x-request-id", {"id"}},
+                                                    {"x-^-id", {"caret-1", "caret-2"}},
+                                                    {"x-~-id", {"tilde"}},
+                                                    {"x-amrbxw", {"amrbxw"}},
+                                                    {"x-awscra", {"awscra-1", "awscra-2"}},
+                                                    {"x-field-5", {"field-5"}}};
+        // Header fields must not be found among trailers.
+        const std::vector<IndexedField> absentTrailers = {{"host", {}}, {"accept", {}}, {"transfer-encoding", {}}, {"x-field-4", {}}};
+        const auto request = std::string("POST / HTTP/1.1\r\nHost: example.com\r\nAccept: a\r\nX-Field-4: f\r\nTransfer-Encoding: chunked\r\n\r\n")
+                                 .append("5\r\nhello\r\n0\r\n")
+                                 .append(fieldLines(trailers))
+                                 .append("\r\n");
+        IOChannelTest ioChannel(request);
+        HttpRequestParser parser(ioChannel, std::make_shared<HttpRequestLimits>());
+
+        WHEN("the request is parsed")
+        {
+            REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
+            REQUIRE(parser.request().headerCount("accept") == 1);
+            REQUIRE(parser.request().header("x-field-4") == "f");
+            REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedBody);
+            REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
+
+            THEN("trailers are found by name in any case, counted and read by position")
+            {
+                REQUIRE(parser.trailersCount() == 10);
+                const auto hasField = [&](std::string_view name) {return parser.hasTrailer(name);};
+                const auto fieldCount = [&](std::string_view name) {return parser.trailerCount(name);};
+                const auto fieldValue = [&](std::string_view name, int pos) {return parser.trailer(name, pos);};
+                checkIndexedFields(trailers, hasField, fieldCount, fieldValue);
+                checkIndexedFields(absentTrailers, hasField, fieldCount, fieldValue);
+            }
+        }
+    }
+}
+
+
 SCENARIO("HttpRequestParser allows spaces around content-length value")
 {
     GIVEN("a request with content-length header value containing spaces before/after the value")
@@ -3589,36 +3788,32 @@ SCENARIO("HttpRequestParser parses requests with chunked bodies")
                     {
                         THEN("parser successfully parses chunked body")
                         {
-                            size_t expectedRequestBodySize = 0;
+                            // Chunks already in the read buffer are delivered as a single body part.
+                            std::string expectedBody;
                             for (const auto &body : bodies)
+                                expectedBody.append(body.second);
+                            if (!expectedBody.empty())
                             {
-                                if (!body.second.empty())
-                                {
-                                    REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedBody);
-                                    expectedRequestBodySize += body.second.size();
-                                    REQUIRE(httpRequest.requestBodySize() == expectedRequestBodySize);
-                                    REQUIRE(httpRequest.chunked());
-                                    REQUIRE(httpRequest.pendingBodySize() == 0);
-                                    REQUIRE(httpRequest.hasBody());
-                                    REQUIRE(httpRequest.body() == body.second);
-                                }
-                                else
-                                {
-                                    REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
-                                    REQUIRE(parser.requestSize() == request.size());
-                                    REQUIRE(httpRequest.requestBodySize() == expectedRequestBodySize);
-                                    REQUIRE(httpRequest.chunked());
-                                    REQUIRE(httpRequest.pendingBodySize() == 0);
-                                    REQUIRE(!httpRequest.hasBody());
-                                    REQUIRE(parser.trailersCount() == trailers.size());
-                                    for (const auto &trailer : trailers)
-                                    {
-                                        REQUIRE(parser.hasTrailer(trailer.first));
-                                        REQUIRE(parser.trailerCount(trailer.first) == 1);
-                                        const auto trailerValue = parser.trailer(trailer.first);
-                                        REQUIRE(QByteArray(trailerValue.data(), trailerValue.size()) == QByteArray(trailer.second.data(), trailer.second.size()).trimmed());
-                                    }
-                                }
+                                REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedBody);
+                                REQUIRE(httpRequest.requestBodySize() == expectedBody.size());
+                                REQUIRE(httpRequest.chunked());
+                                REQUIRE(httpRequest.pendingBodySize() == 0);
+                                REQUIRE(httpRequest.hasBody());
+                                REQUIRE(httpRequest.body() == expectedBody);
+                            }
+                            REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
+                            REQUIRE(parser.requestSize() == request.size());
+                            REQUIRE(httpRequest.requestBodySize() == expectedBody.size());
+                            REQUIRE(httpRequest.chunked());
+                            REQUIRE(httpRequest.pendingBodySize() == 0);
+                            REQUIRE(!httpRequest.hasBody());
+                            REQUIRE(parser.trailersCount() == trailers.size());
+                            for (const auto &trailer : trailers)
+                            {
+                                REQUIRE(parser.hasTrailer(trailer.first));
+                                REQUIRE(parser.trailerCount(trailer.first) == 1);
+                                const auto trailerValue = parser.trailer(trailer.first);
+                                REQUIRE(QByteArray(trailerValue.data(), trailerValue.size()) == QByteArray(trailer.second.data(), trailer.second.size()).trimmed());
                             }
                         }
                     }
@@ -3893,36 +4088,32 @@ SCENARIO("HttpRequestParser parses requests with chunked bodies")
                                         REQUIRE(httpRequest.pendingBodySize() == 0);
                                         REQUIRE(!httpRequest.hasBody());
                                         REQUIRE(httpRequest.bodyType() == HttpRequest::BodyType::Chunked);
-                                        size_t expectedRequestBodySize = 0;
+                                        // Chunks already in the read buffer are delivered as a single body part.
+                                        std::string expectedBody;
                                         for (const auto &body : bodies)
+                                            expectedBody.append(body.second);
+                                        if (!expectedBody.empty())
                                         {
-                                            if (!body.second.empty())
-                                            {
-                                                REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedBody);
-                                                expectedRequestBodySize += body.second.size();
-                                                REQUIRE(httpRequest.requestBodySize() == expectedRequestBodySize);
-                                                REQUIRE(httpRequest.chunked());
-                                                REQUIRE(httpRequest.pendingBodySize() == 0);
-                                                REQUIRE(httpRequest.hasBody());
-                                                REQUIRE(httpRequest.body() == body.second);
-                                            }
-                                            else
-                                            {
-                                                REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
-                                                REQUIRE(parser.requestSize() == currentRequest.size());
-                                                REQUIRE(httpRequest.requestBodySize() == expectedRequestBodySize);
-                                                REQUIRE(httpRequest.chunked());
-                                                REQUIRE(httpRequest.pendingBodySize() == 0);
-                                                REQUIRE(!httpRequest.hasBody());
-                                                REQUIRE(parser.trailersCount() == trailers.size());
-                                                for (const auto &trailer : trailers)
-                                                {
-                                                    REQUIRE(parser.hasTrailer(trailer.first));
-                                                    REQUIRE(parser.trailerCount(trailer.first) == 1);
-                                                    const auto trailerValue = parser.trailer(trailer.first);
-                                                    REQUIRE(QByteArray(trailerValue.data(), trailerValue.size()) == QByteArray(trailer.second.data(), trailer.second.size()).trimmed());
-                                                }
-                                            }
+                                            REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedBody);
+                                            REQUIRE(httpRequest.requestBodySize() == expectedBody.size());
+                                            REQUIRE(httpRequest.chunked());
+                                            REQUIRE(httpRequest.pendingBodySize() == 0);
+                                            REQUIRE(httpRequest.hasBody());
+                                            REQUIRE(httpRequest.body() == expectedBody);
+                                        }
+                                        REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
+                                        REQUIRE(parser.requestSize() == currentRequest.size());
+                                        REQUIRE(httpRequest.requestBodySize() == expectedBody.size());
+                                        REQUIRE(httpRequest.chunked());
+                                        REQUIRE(httpRequest.pendingBodySize() == 0);
+                                        REQUIRE(!httpRequest.hasBody());
+                                        REQUIRE(parser.trailersCount() == trailers.size());
+                                        for (const auto &trailer : trailers)
+                                        {
+                                            REQUIRE(parser.hasTrailer(trailer.first));
+                                            REQUIRE(parser.trailerCount(trailer.first) == 1);
+                                            const auto trailerValue = parser.trailer(trailer.first);
+                                            REQUIRE(QByteArray(trailerValue.data(), trailerValue.size()) == QByteArray(trailer.second.data(), trailer.second.size()).trimmed());
                                         }
                                     }
                                 }
@@ -4079,6 +4270,183 @@ SCENARIO("HttpRequestParser parses requests with chunked bodies")
 }
 
 
+SCENARIO("HttpRequestParser delivers data of all buffered chunks as a single body part")
+{
+    GIVEN("a chunked request whose chunks are received together")
+    {
+        const auto readBufferCapacity = GENERATE(AS(size_t), 0, 256);
+        const auto chunks = GENERATE(AS(std::vector<std::string_view>),
+                                     {"a", "b", "c", "and the last chunk"},
+                                     {"Hello", " ", "World", "! Bye, World!"},
+                                     {"This is the first chunk", "and this is the second one, which is a bit longer than the first one"});
+        std::string chunkedBody;
+        std::string expectedBody;
+        for (const auto &chunk : chunks)
+        {
+            chunkedBody.append(QByteArray::number(qsizetype(chunk.size()), 16).constData()).append(";ext=val\r\n").append(chunk).append("\r\n");
+            expectedBody.append(chunk);
+        }
+        const std::string_view metadata("POST / HTTP/1.1\r\nHost: example.com\r\nTransfer-Encoding: chunked\r\n\r\n");
+        IOChannelTest ioChannel(metadata);
+        if (readBufferCapacity > 0)
+            REQUIRE(ioChannel.setReadBufferCapacity(readBufferCapacity));
+        HttpRequestParser parser(ioChannel, std::make_shared<HttpRequestLimits>());
+        REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
+        REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::NeedsMoreData);
+
+        WHEN("all chunks arrive at once")
+        {
+            REQUIRE(ioChannel.readBuffer().write(chunkedBody) == chunkedBody.size());
+            const auto parserStatus = parser.parse();
+
+            THEN("parser delivers data of all chunks contiguously")
+            {
+                REQUIRE(parserStatus == HttpRequestParser::ParserStatus::ParsedBody);
+                REQUIRE(parser.request().body() == expectedBody);
+                REQUIRE(parser.request().requestBodySize() == expectedBody.size());
+                REQUIRE(parser.request().pendingBodySize() == 0);
+                REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::NeedsMoreData);
+
+                AND_WHEN("last chunk arrives")
+                {
+                    REQUIRE(ioChannel.readBuffer().write("0\r\n\r\n") == 5);
+
+                    THEN("parser finishes parsing the request")
+                    {
+                        REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
+                        REQUIRE(parser.requestSize() == (metadata.size() + chunkedBody.size() + 5));
+                        REQUIRE(parser.request().requestBodySize() == expectedBody.size());
+                        REQUIRE(!parser.request().hasBody());
+                    }
+                }
+            }
+        }
+
+        WHEN("all chunks arrive at once but the last one is incomplete")
+        {
+            // Parser holds back the last two received bytes of incomplete chunks.
+            const auto missingDataSize = chunks.back().size() / 2;
+            const auto missingSize = missingDataSize + 2;
+            REQUIRE(ioChannel.readBuffer().write(std::string_view(chunkedBody).substr(0, chunkedBody.size() - missingSize)) == (chunkedBody.size() - missingSize));
+            const auto parserStatus = parser.parse();
+
+            THEN("parser delivers data of complete chunks and the received part of the last one contiguously")
+            {
+                const auto deliveredSize = expectedBody.size() - missingDataSize - 2;
+                REQUIRE(parserStatus == HttpRequestParser::ParserStatus::ParsedBody);
+                REQUIRE(parser.request().body() == std::string_view(expectedBody).substr(0, deliveredSize));
+                REQUIRE(parser.request().requestBodySize() == deliveredSize);
+                REQUIRE(parser.request().pendingBodySize() == (missingDataSize + 2));
+
+                AND_WHEN("remaining data arrives")
+                {
+                    REQUIRE(ioChannel.readBuffer().write(std::string_view(chunkedBody).substr(chunkedBody.size() - missingSize)) == missingSize);
+                    REQUIRE(ioChannel.readBuffer().write("0\r\n\r\n") == 5);
+
+                    THEN("parser delivers remaining data and finishes parsing the request")
+                    {
+                        REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedBody);
+                        REQUIRE(parser.request().body() == std::string_view(expectedBody).substr(deliveredSize));
+                        REQUIRE(parser.request().requestBodySize() == expectedBody.size());
+                        REQUIRE(parser.request().pendingBodySize() == 0);
+                        REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
+                        REQUIRE(parser.requestSize() == (metadata.size() + chunkedBody.size() + 5));
+                    }
+                }
+            }
+        }
+    }
+}
+
+
+SCENARIO("HttpRequestParser stops looking ahead at buffered chunks it does not move")
+{
+    GIVEN("a chunked request whose first chunk has been received")
+    {
+        const std::string_view metadata("POST / HTTP/1.1\r\nHost: example.com\r\nTransfer-Encoding: chunked\r\n\r\n");
+        IOChannelTest ioChannel(metadata);
+        auto pHttpRequestLimits = std::make_shared<HttpRequestLimits>();
+        HttpRequestParser parser(ioChannel, pHttpRequestLimits);
+        REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
+        REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::NeedsMoreData);
+        const std::string_view firstChunk("3\r\nabc\r\n");
+
+        WHEN("a chunk larger than 4096 bytes arrives together with the first chunk")
+        {
+            const auto largeChunkDataSize = GENERATE(AS(size_t), 4097, 16384);
+            const std::string largeChunkData(largeChunkDataSize, 'x');
+            std::string chunks(firstChunk);
+            chunks.append(QByteArray::number(qsizetype(largeChunkDataSize), 16).constData()).append("\r\n").append(largeChunkData).append("\r\n");
+            REQUIRE(ioChannel.readBuffer().write(chunks) == chunks.size());
+
+            THEN("parser delivers data of the large chunk as a separate body part")
+            {
+                REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedBody);
+                REQUIRE(parser.request().body() == "abc");
+                REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedBody);
+                REQUIRE(parser.request().body() == largeChunkData);
+                REQUIRE(parser.request().requestBodySize() == (3 + largeChunkDataSize));
+                REQUIRE(parser.request().pendingBodySize() == 0);
+                REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::NeedsMoreData);
+
+                AND_WHEN("last chunk arrives")
+                {
+                    REQUIRE(ioChannel.readBuffer().write("0\r\n\r\n") == 5);
+
+                    THEN("parser finishes parsing the request")
+                    {
+                        REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
+                        REQUIRE(parser.requestSize() == (metadata.size() + chunks.size() + 5));
+                    }
+                }
+            }
+        }
+
+        WHEN("a malformed chunk arrives together with the first chunk")
+        {
+            const auto malformedChunk = GENERATE(AS(std::string_view),
+                                                 "3\rXdef\r\n",
+                                                 "0000000000003\r\ndef\r\n",
+                                                 "3\r\ndefXY");
+            std::string chunks(firstChunk);
+            chunks.append(malformedChunk);
+            REQUIRE(ioChannel.readBuffer().write(chunks) == chunks.size());
+
+            THEN("parser delivers data of the first chunk and then fails with a malformed request error")
+            {
+                REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedBody);
+                REQUIRE(parser.request().body() == "abc");
+                REQUIRE(parser.error() == HttpServer::ServerError::NoError);
+                REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::Failed);
+                REQUIRE(parser.error() == HttpServer::ServerError::MalformedRequest);
+            }
+        }
+
+        WHEN("a chunk exceeding request limits arrives together with the first chunk")
+        {
+            const auto exceedsBodyLimit = GENERATE(AS(bool), true, false);
+            if (exceedsBodyLimit)
+                pHttpRequestLimits->maxBodySize = 5;
+            else
+                pHttpRequestLimits->maxChunkMetadataSize = 8;
+            std::string chunks(firstChunk);
+            chunks.append(exceedsBodyLimit ? "4\r\ndefg\r\n" : "4;ext=value\r\ndefg\r\n");
+            REQUIRE(ioChannel.readBuffer().write(chunks) == chunks.size());
+
+            THEN("parser delivers data of the first chunk and then fails with a too big request error")
+            {
+                REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedBody);
+                REQUIRE(parser.request().body() == "abc");
+                REQUIRE(parser.request().requestBodySize() == 3);
+                REQUIRE(parser.error() == HttpServer::ServerError::NoError);
+                REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::Failed);
+                REQUIRE(parser.error() == HttpServer::ServerError::TooBigRequest);
+            }
+        }
+    }
+}
+
+
 SCENARIO("HttpServer responds with 100-Continue status code when client sends expect header with 100-continue value")
 {
     GIVEN("a request containing an Expect: 100-continue header")
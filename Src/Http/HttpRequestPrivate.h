@@ -21,6 +21,7 @@
 #include "HttpRequestLine.h"
 #include "HttpFieldBlock.h"
 #include "HttpRequestBody.h"
+#include "HttpPathParameters.h"
 #include "../Core/TcpSocket.h"
 #include <type_traits>
 #include <cstddef>
@@ -34,16 +35,30 @@ class HttpRequestPrivate
 public:
     HttpRequestPrivate(IOChannel &ioChannel) : m_pIoChannel(&ioChannel), m_fieldBlock(ioChannel) {}
     ~HttpRequestPrivate() = default;
-    inline void clear(){std::memset(&m_requestLine, 0, offsetof(HttpRequestPrivate, m_fieldBlock) - offsetof(HttpRequestPrivate, m_requestLine));}
+    inline void clear()
+    {
+        std::memset(&m_requestLine, 0, offsetof(HttpRequestPrivate, m_fieldBlock) - offsetof(HttpRequestPrivate, m_requestLine));
+        m_pathParameters.clear();
+    }
     inline const HttpRequestLine &requestLine() const {return m_requestLine;}
     inline HttpRequestLine &requestLine() {return m_requestLine;}
     inline const HttpFieldBlock &fieldBlock() const {return m_fieldBlock;}
     inline HttpFieldBlock &fieldBlock() {return m_fieldBlock;}
     inline const HttpRequestBody &requestBody() const {return m_requestBody;}
     inline HttpRequestBody &requestBody() {return m_requestBody;}
+    inline const HttpPathParameters &pathParameters() const {return m_pathParameters;}
+    inline HttpPathParameters &pathParameters() {return m_pathParameters;}
     HttpRequest::Method method() const {return m_requestLine.method();}
     std::string_view targetPath() const {return m_requestLine.targetPathSize() > 0 ? m_pIoChannel->slice(m_requestLine.targetPathStartIndex(), m_requestLine.targetPathSize()) : std::string_view{};}
     std::string_view targetQuery() const {return m_requestLine.targetQuerySize() > 0 ? m_pIoChannel->slice(m_requestLine.targetQueryStartIndex(), m_requestLine.targetQuerySize()) : std::string_view{};}
+    std::string_view pathParameter(std::string_view name) const
+    {
+        // Values are sliced from the read buffer on every access, as the target path the router matched
+        // may have been copied to a temporary buffer that the next slice overwrites.
+        const auto index = m_pathParameters.indexOf(name);
+        const auto valueSize = m_pathParameters.valueSize(index);
+        return valueSize > 0 ? m_pIoChannel->slice(m_requestLine.targetPathStartIndex() + m_pathParameters.valueIndex(index), valueSize) : std::string_view{};
+    }
     size_t headersCount() const {return m_fieldBlock.fieldLinesCount();}
     size_t headerCount(std::string_view name) const {return m_fieldBlock.fieldCount(name);}
     bool hasHeader(std::string_view name) const {return m_fieldBlock.hasField(name);}
@@ -86,6 +101,7 @@ private:
     HttpRequestLine m_requestLine;
     HttpRequestBody m_requestBody;
     HttpFieldBlock m_fieldBlock;
+    HttpPathParameters m_pathParameters;
 };
 
 static_assert(std::is_standard_layout_v<HttpRequestPrivate>);
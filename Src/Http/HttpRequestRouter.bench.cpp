@@ -0,0 +1,124 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "HttpRequestRouter.h"
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <Spectator>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using Kourier::HttpRequestRouter;
+using Kourier::HttpRequest;
+using Kourier::HttpBroker;
+using Kourier::HttpPathParameters;
+
+
+namespace Test::HttpRequestRouter
+{
+
+// Mirrors the former router, which scanned routes sorted in descending order
+// and picked the first one the request path started with.
+class LinearScanRouter
+{
+public:
+    void addRoute(std::string_view path) {m_routes.emplace_back(path);}
+    void sortRoutes() {std::sort(m_routes.begin(), m_routes.end(), std::greater<std::string>());}
+    const std::string *getRoute(std::string_view path) const
+    {
+        for (const auto &route : m_routes)
+        {
+            if (path.starts_with(route))
+                return &route;
+        }
+        return nullptr;
+    }
+
+private:
+    std::vector<std::string> m_routes;
+};
+
+std::vector<std::string> staticRoutes(size_t routeCount)
+{
+    std::vector<std::string> routes;
+    routes.reserve(routeCount);
+    for (size_t i = 0; i < routeCount; ++i)
+        routes.push_back(std::string("/api/v1/resource").append(std::to_string(i)).append("/items"));
+    return routes;
+}
+
+std::vector<std::string> requestPaths(size_t routeCount)
+{
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < routeCount; i += std::max<size_t>(1, routeCount / 64))
+        paths.push_back(std::string("/api/v1/resource").append(std::to_string(i)).append("/items/42"));
+    return paths;
+}
+
+}
+
+using namespace Test::HttpRequestRouter;
+
+
+SCENARIO("HttpRequestRouter benchmarks")
+{
+    static constexpr size_t lookupCount = 1000000;
+    const auto routeCount = GENERATE(AS(size_t), 10, 100, 1000, 10000);
+    const auto routes = staticRoutes(routeCount);
+    const auto paths = requestPaths(routeCount);
+    HttpRequestRouter router;
+    LinearScanRouter linearScanRouter;
+    for (const auto &route : routes)
+    {
+        REQUIRE(router.addRoute(HttpRequest::Method::GET, route, [](const HttpRequest&, HttpBroker&){}));
+        linearScanRouter.addRoute(route);
+    }
+    REQUIRE(router.addRoute(HttpRequest::Method::GET, "/api/v1/users/{id}/posts/{postId}", [](const HttpRequest&, HttpBroker&){}));
+    linearScanRouter.sortRoutes();
+    QElapsedTimer elapsedTimer;
+    size_t matchCount = 0;
+    elapsedTimer.start();
+    for (size_t i = 0; i < lookupCount; ++i)
+    {
+        HttpPathParameters pathParameters;
+        matchCount += (router.getHandler(HttpRequest::Method::GET, paths[i % paths.size()], pathParameters) != nullptr);
+    }
+    const auto radixTreeElapsedTimeInNSecs = std::max<qint64>(1, elapsedTimer.nsecsElapsed());
+    REQUIRE(matchCount == lookupCount);
+    matchCount = 0;
+    const auto linearScanLookupCount = std::max<size_t>(1000, lookupCount / routeCount);
+    elapsedTimer.start();
+    for (size_t i = 0; i < linearScanLookupCount; ++i)
+        matchCount += (linearScanRouter.getRoute(paths[i % paths.size()]) != nullptr);
+    const auto linearScanElapsedTimeInNSecs = std::max<qint64>(1, elapsedTimer.nsecsElapsed());
+    REQUIRE(matchCount == linearScanLookupCount);
+    matchCount = 0;
+    elapsedTimer.start();
+    for (size_t i = 0; i < lookupCount; ++i)
+    {
+        HttpPathParameters pathParameters;
+        matchCount += (router.getHandler(HttpRequest::Method::GET, "/api/v1/users/42/posts/7", pathParameters) != nullptr);
+    }
+    const auto parameterElapsedTimeInNSecs = std::max<qint64>(1, elapsedTimer.nsecsElapsed());
+    REQUIRE(matchCount == lookupCount);
+    WARN(QByteArray("Route count: ").append(QByteArray::number(routeCount)));
+    WARN(QByteArray("Radix tree lookups per second: ").append(QByteArray::number(qint64(lookupCount * 1e9 / radixTreeElapsedTimeInNSecs))));
+    WARN(QByteArray("Radix tree lookups with parameters per second: ").append(QByteArray::number(qint64(lookupCount * 1e9 / parameterElapsedTimeInNSecs))));
+    WARN(QByteArray("Linear scan lookups per second: ").append(QByteArray::number(qint64(linearScanLookupCount * 1e9 / linearScanElapsedTimeInNSecs))));
+}
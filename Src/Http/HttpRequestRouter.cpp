@@ -18,52 +18,284 @@
 #include "HttpRequestRouter.h"
 #include <QUrl>
 #include <QDir>
+#include <algorithm>
 
 
 namespace Kourier
 {
 
-bool HttpRequestRouter::addRoute(HttpRequest::Method method, std::string_view path, RequestHandler pRequestHandler)
+namespace
 {
-    if (!isAbsolutePath(path) && (method != HttpRequest::Method::OPTIONS || path != "*"))
+
+bool isValidParameterName(std::string_view name)
+{
+    if (name.empty())
         return false;
-    else if (pRequestHandler == nullptr)
+    for (const auto ch : name)
+    {
+        if (!(('a' <= ch && ch <= 'z') || ('A' <= ch && ch <= 'Z') || ('0' <= ch && ch <= '9') || ch == '_' || ch == '-'))
+            return false;
+    }
+    return true;
+}
+
+}
+
+struct HttpRequestRouter::Match
+{
+    int32_t routeIndex = -1;
+    size_t matchedSize = 0;
+    size_t valueCount = 0;
+    std::string_view values[HttpPathParameters::maxCount()];
+};
+
+bool HttpRequestRouter::addRoute(HttpRequest::Method method, std::string_view path, RequestHandler pRequestHandler, bool acceptsEarlyData)
+{
+    std::vector<Segment> segments;
+    if (method == HttpRequest::Method::OPTIONS && path == "*")
+        segments.push_back({Segment::Type::Static, path});
+    else if (!parsePath(path, segments))
+        return false;
+    if (pRequestHandler == nullptr)
     {
         m_errorMessage = std::string("Failed to register route ").append(path).append(". Given function pointer is null.");
         return false;
     }
+    if (acceptsEarlyData && !isIdempotent(method))
+    {
+        m_errorMessage = std::string("Failed to register route ").append(path).append(". Early data can only be accepted for idempotent methods.");
+        return false;
+    }
+    auto &rootIndex = m_roots[(size_t)method];
+    if (rootIndex == 0)
+        rootIndex = createNode({});
+    auto nodeIndex = rootIndex;
+    std::vector<std::string> parameterNames;
+    for (const auto &segment : segments)
+    {
+        switch (segment.type)
+        {
+            case Segment::Type::Static:
+                nodeIndex = insertStaticSegment(nodeIndex, segment.text);
+                break;
+            case Segment::Type::Parameter:
+                if (m_nodes[nodeIndex].parameterChild == 0)
+                {
+                    const auto childIndex = createNode({});
+                    m_nodes[nodeIndex].parameterChild = childIndex;
+                }
+                nodeIndex = m_nodes[nodeIndex].parameterChild;
+                parameterNames.emplace_back(segment.text);
+                break;
+            case Segment::Type::Wildcard:
+                if (m_nodes[nodeIndex].wildcardChild == 0)
+                {
+                    const auto childIndex = createNode({});
+                    m_nodes[nodeIndex].wildcardChild = childIndex;
+                }
+                nodeIndex = m_nodes[nodeIndex].wildcardChild;
+                parameterNames.emplace_back(segment.text);
+                break;
+        }
+    }
+    auto &node = m_nodes[nodeIndex];
+    if (node.routeIndex < 0)
+    {
+        node.routeIndex = m_routes.size();
+        m_routes.push_back({pRequestHandler, std::move(parameterNames), acceptsEarlyData});
+    }
     else
+        m_routes[node.routeIndex] = {pRequestHandler, std::move(parameterNames), acceptsEarlyData};
+    return true;
+}
+
+HttpRequestRouter::RequestHandler HttpRequestRouter::getHandler(HttpRequest::Method method, std::string_view path) const
+{
+    HttpPathParameters pathParameters;
+    return getHandler(method, path, pathParameters);
+}
+
+HttpRequestRouter::RequestHandler HttpRequestRouter::getHandler(HttpRequest::Method method, std::string_view path, HttpPathParameters &pathParameters) const
+{
+    pathParameters.clear();
+    const auto rootIndex = m_roots[(size_t)method];
+    if (rootIndex == 0)
+        return nullptr;
+    Match current;
+    Match best;
+    match(rootIndex, path, 0, current, best);
+    if (best.routeIndex < 0)
+        return nullptr;
+    const auto &route = m_routes[best.routeIndex];
+    for (size_t i = 0; i < best.valueCount; ++i)
+        pathParameters.add(route.parameterNames[i], best.values[i].data() - path.data(), best.values[i].size());
+    return route.pHandler;
+}
+
+bool HttpRequestRouter::acceptsEarlyData(HttpRequest::Method method, std::string_view path) const
+{
+    if (!isIdempotent(method))
+        return false;
+    const auto rootIndex = m_roots[(size_t)method];
+    if (rootIndex == 0)
+        return false;
+    Match current;
+    Match best;
+    match(rootIndex, path, 0, current, best);
+    return best.routeIndex >= 0 && m_routes[best.routeIndex].acceptsEarlyData;
+}
+
+void HttpRequestRouter::match(uint32_t nodeIndex, std::string_view path, size_t pos, Match &current, Match &best) const
+{
+    // Keeps the route matching the longest prefix of the path. On ties, static
+    // segments take precedence over parameters, which take precedence over wildcards.
+    const auto &node = m_nodes[nodeIndex];
+    if (node.routeIndex >= 0 && (best.routeIndex < 0 || pos > best.matchedSize))
     {
-        auto &handlers = m_handlers[(size_t)method];
-        auto pos = handlers.begin();
-        while (pos != handlers.end())
+        best = current;
+        best.routeIndex = node.routeIndex;
+        best.matchedSize = pos;
+    }
+    if (pos < path.size())
+    {
+        const auto childPos = node.staticChildFirstChars.find(path[pos]);
+        if (childPos != std::string::npos)
         {
-            if (path > pos->path)
-            {
-                handlers.insert(pos, {method, std::string{path}, pRequestHandler});
-                return true;
-            }
-            else if (path == pos->path)
+            const auto childIndex = node.staticChildren[childPos];
+            const std::string_view childPrefix = m_nodes[childIndex].prefix;
+            if (path.substr(pos).starts_with(childPrefix))
+                match(childIndex, path, pos + childPrefix.size(), current, best);
+        }
+        if (node.parameterChild != 0)
+        {
+            const auto segmentEnd = std::min(path.find('/', pos), path.size());
+            if (segmentEnd > pos)
             {
-                pos->pHandler = pRequestHandler;
-                return true;
+                current.values[current.valueCount++] = path.substr(pos, segmentEnd - pos);
+                match(node.parameterChild, path, segmentEnd, current, best);
+                --current.valueCount;
             }
-            ++pos;
         }
-        handlers.insert(pos, {method, std::string{path}, pRequestHandler});
-        return true;
+    }
+    if (node.wildcardChild != 0 && (best.routeIndex < 0 || path.size() > best.matchedSize))
+    {
+        current.values[current.valueCount++] = path.substr(pos);
+        match(node.wildcardChild, path, path.size(), current, best);
+        --current.valueCount;
     }
 }
 
-HttpRequestRouter::RequestHandler HttpRequestRouter::getHandler(HttpRequest::Method method, std::string_view path) const
+uint32_t HttpRequestRouter::insertStaticSegment(uint32_t nodeIndex, std::string_view text)
+{
+    while (!text.empty())
+    {
+        const auto childPos = m_nodes[nodeIndex].staticChildFirstChars.find(text.front());
+        if (childPos == std::string::npos)
+        {
+            const auto childIndex = createNode(text);
+            auto &node = m_nodes[nodeIndex];
+            node.staticChildFirstChars.push_back(text.front());
+            node.staticChildren.push_back(childIndex);
+            return childIndex;
+        }
+        const auto childIndex = m_nodes[nodeIndex].staticChildren[childPos];
+        const auto childPrefixSize = m_nodes[childIndex].prefix.size();
+        const auto maxCommonSize = std::min(childPrefixSize, text.size());
+        size_t commonSize = 0;
+        while (commonSize < maxCommonSize && m_nodes[childIndex].prefix[commonSize] == text[commonSize])
+            ++commonSize;
+        if (commonSize < childPrefixSize)
+        {
+            // Child's prefix is split so that the common part gets a node of its own.
+            const auto splitIndex = createNode(text.substr(0, commonSize));
+            auto &child = m_nodes[childIndex];
+            child.prefix.erase(0, commonSize);
+            auto &split = m_nodes[splitIndex];
+            split.staticChildFirstChars.push_back(child.prefix.front());
+            split.staticChildren.push_back(childIndex);
+            m_nodes[nodeIndex].staticChildren[childPos] = splitIndex;
+            nodeIndex = splitIndex;
+        }
+        else
+            nodeIndex = childIndex;
+        text.remove_prefix(commonSize);
+    }
+    return nodeIndex;
+}
+
+uint32_t HttpRequestRouter::createNode(std::string_view prefix)
 {
-    auto &handlers = m_handlers[(size_t)method];
-    for (auto &handler : handlers)
+    auto &node = m_nodes.emplace_back();
+    node.prefix = prefix;
+    return m_nodes.size() - 1;
+}
+
+bool HttpRequestRouter::parsePath(std::string_view path, std::vector<Segment> &segments)
+{
+    // Parameter and wildcard segments are replaced by plain ones
+    // before the path is validated as an absolute path.
+    std::string plainPath;
+    size_t staticStart = 0;
+    size_t pos = 0;
+    size_t parameterCount = 0;
+    while (pos < path.size())
     {
-        if (path.starts_with(handler.path))
-            return handler.pHandler;
+        const char ch = path[pos];
+        const bool isSegmentStart = (pos > 0) && (path[pos - 1] == '/');
+        if (isSegmentStart && ch == '{')
+        {
+            const auto closingPos = path.find('}', pos);
+            const auto segmentEnd = std::min(path.find('/', pos), path.size());
+            if (closingPos == std::string_view::npos
+                || (closingPos + 1) != segmentEnd
+                || !isValidParameterName(path.substr(pos + 1, closingPos - pos - 1)))
+            {
+                m_errorMessage = "Failed to add route. Given path contains an invalid parameter segment.";
+                return false;
+            }
+            if (pos > staticStart)
+                segments.push_back({Segment::Type::Static, path.substr(staticStart, pos - staticStart)});
+            segments.push_back({Segment::Type::Parameter, path.substr(pos + 1, closingPos - pos - 1)});
+            plainPath.append(path.substr(staticStart, pos - staticStart)).append("parameter");
+            ++parameterCount;
+            pos = segmentEnd;
+            staticStart = pos;
+        }
+        else if (isSegmentStart && ch == '*')
+        {
+            const auto name = path.substr(pos + 1);
+            if (name.find('/') != std::string_view::npos || (!name.empty() && !isValidParameterName(name)))
+            {
+                m_errorMessage = "Failed to add route. Wildcard segments must be the last segment of the path.";
+                return false;
+            }
+            if (pos > staticStart)
+                segments.push_back({Segment::Type::Static, path.substr(staticStart, pos - staticStart)});
+            segments.push_back({Segment::Type::Wildcard, name});
+            plainPath.append(path.substr(staticStart, pos - staticStart)).append("wildcard");
+            ++parameterCount;
+            pos = path.size();
+            staticStart = pos;
+        }
+        else if (ch == '{' || ch == '}')
+        {
+            m_errorMessage = "Failed to add route. Given path contains an invalid parameter segment.";
+            return false;
+        }
+        else
+            ++pos;
+    }
+    if (staticStart < path.size())
+    {
+        segments.push_back({Segment::Type::Static, path.substr(staticStart)});
+        plainPath.append(path.substr(staticStart));
+    }
+    if (parameterCount > HttpPathParameters::maxCount())
+    {
+        m_errorMessage = std::string("Failed to add route. Routes can have at most ").append(std::to_string(HttpPathParameters::maxCount())).append(" parameter and wildcard segments.");
+        return false;
     }
-    return nullptr;
+    return isAbsolutePath(plainPath);
 }
 
 bool HttpRequestRouter::isAbsolutePath(std::string_view path)
@@ -19,9 +19,11 @@
 #define KOURIER_HTTP_REQUEST_ROUTER_H
 
 #include "HttpRequest.h"
+#include "HttpPathParameters.h"
 #include <vector>
 #include <string>
 #include <string_view>
+#include <cstdint>
 
 
 namespace Kourier
@@ -36,21 +38,48 @@ public:
     HttpRequestRouter &operator=(const HttpRequestRouter&) = default;
     ~HttpRequestRouter() = default;
     typedef void(*RequestHandler)(const HttpRequest &, HttpBroker&);
-    bool addRoute(HttpRequest::Method method, std::string_view path, RequestHandler pRequestHandler);
+    bool addRoute(HttpRequest::Method method, std::string_view path, RequestHandler pRequestHandler, bool acceptsEarlyData = false);
     inline std::string_view errorMessage() const {return m_errorMessage;}
     RequestHandler getHandler(HttpRequest::Method method, std::string_view path) const;
+    RequestHandler getHandler(HttpRequest::Method method, std::string_view path, HttpPathParameters &pathParameters) const;
+    bool acceptsEarlyData(HttpRequest::Method method, std::string_view path) const;
+    static constexpr bool isIdempotent(HttpRequest::Method method) {return method != HttpRequest::Method::POST && method != HttpRequest::Method::PATCH;}
 
 private:
+    struct Segment
+    {
+        enum class Type {Static, Parameter, Wildcard};
+        Type type = Type::Static;
+        std::string_view text;
+    };
+    bool parsePath(std::string_view path, std::vector<Segment> &segments);
     bool isAbsolutePath(std::string_view path);
+    uint32_t insertStaticSegment(uint32_t nodeIndex, std::string_view text);
+    uint32_t createNode(std::string_view prefix);
+    struct Match;
+    void match(uint32_t nodeIndex, std::string_view path, size_t pos, Match &current, Match &best) const;
 
 private:
-    struct HandlerInfo
+    struct Route
     {
-        HttpRequest::Method method = HttpRequest::Method::GET;
-        std::string path;
         RequestHandler pHandler = nullptr;
+        std::vector<std::string> parameterNames;
+        bool acceptsEarlyData = false;
+    };
+    // Routes are kept in a radix tree per method. Nodes refer to each other by index so that
+    // routers can be copied to workers as plain values. Index 0 means no node.
+    struct Node
+    {
+        std::string prefix;
+        std::string staticChildFirstChars;
+        std::vector<uint32_t> staticChildren;
+        uint32_t parameterChild = 0;
+        uint32_t wildcardChild = 0;
+        int32_t routeIndex = -1;
     };
-    std::vector<HandlerInfo> m_handlers[7];
+    std::vector<Route> m_routes;
+    std::vector<Node> m_nodes = std::vector<Node>(1);
+    uint32_t m_roots[7] = {0, 0, 0, 0, 0, 0, 0};
     std::string m_errorMessage;
 };
 
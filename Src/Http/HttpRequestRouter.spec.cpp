@@ -375,3 +375,246 @@ SCENARIO("HttpRequestRouter replaces handler when adding route with existing pat
         }
     }
 }
+
+
+SCENARIO("HttpRequestRouter captures parameter and wildcard segments from request path")
+{
+    GIVEN("a set of routes with parameter and wildcard segments for given method")
+    {
+        const auto method = GENERATE(AS(HttpRequest::Method),
+                                     HttpRequest::Method::POST,
+                                     HttpRequest::Method::PUT,
+                                     HttpRequest::Method::PATCH,
+                                     HttpRequest::Method::DELETE,
+                                     HttpRequest::Method::HEAD,
+                                     HttpRequest::Method::GET,
+                                     HttpRequest::Method::OPTIONS);
+        static std::string route;
+        HttpRequestRouter router;
+        REQUIRE(router.addRoute(method, "/users", [](const HttpRequest &, HttpBroker&){route = "/users";}));
+        REQUIRE(router.addRoute(method, "/users/me", [](const HttpRequest &, HttpBroker&){route = "/users/me";}));
+        REQUIRE(router.addRoute(method, "/users/{id}", [](const HttpRequest &, HttpBroker&){route = "/users/{id}";}));
+        REQUIRE(router.addRoute(method, "/users/{id}/posts/{postId}", [](const HttpRequest &, HttpBroker&){route = "/users/{id}/posts/{postId}";}));
+        REQUIRE(router.addRoute(method, "/files/*filePath", [](const HttpRequest &, HttpBroker&){route = "/files/*filePath";}));
+        REQUIRE(router.addRoute(method, "/files/public", [](const HttpRequest &, HttpBroker&){route = "/files/public";}));
+
+        WHEN("handler is fetched for given method/path")
+        {
+            struct ExpectedMatch
+            {
+                std::string_view path;
+                std::string_view route;
+                std::vector<std::pair<std::string_view, std::string_view>> parameters;
+            };
+            const std::vector<ExpectedMatch> expectedMatches({
+                {"/users", "/users", {}},
+                {"/users/", "/users", {}},
+                {"/users/me", "/users/me", {}},
+                {"/users/mel", "/users/{id}", {{"id", "mel"}}},
+                {"/users/42", "/users/{id}", {{"id", "42"}}},
+                {"/users/42/", "/users/{id}", {{"id", "42"}}},
+                {"/users/42/posts", "/users/{id}", {{"id", "42"}}},
+                {"/users/42/posts/7", "/users/{id}/posts/{postId}", {{"id", "42"}, {"postId", "7"}}},
+                {"/users/me/posts/7", "/users/{id}/posts/{postId}", {{"id", "me"}, {"postId", "7"}}},
+                {"/users/42/posts/7/comments", "/users/{id}/posts/{postId}", {{"id", "42"}, {"postId", "7"}}},
+                {"/files/", "/files/*filePath", {{"filePath", ""}}},
+                {"/files/a/b/c.txt", "/files/*filePath", {{"filePath", "a/b/c.txt"}}},
+                {"/files/public", "/files/public", {}},
+                {"/files/public/a.txt", "/files/*filePath", {{"filePath", "public/a.txt"}}},
+                {"/files/publicity", "/files/*filePath", {{"filePath", "publicity"}}}
+            });
+
+            THEN("handler associated with most specific route is given along with captured segments")
+            {
+                IOChannelTest ioChannel({});
+                HttpRequestParser parser(ioChannel, std::shared_ptr<HttpRequestLimits>(new HttpRequestLimits));
+                TestHttpRequestRouter broker;
+                for (const auto &expectedMatch : expectedMatches)
+                {
+                    Kourier::HttpPathParameters pathParameters;
+                    const auto pHandler = router.getHandler(method, expectedMatch.path, pathParameters);
+                    REQUIRE(pHandler != nullptr);
+                    route.clear();
+                    pHandler(parser.request(), broker.broker());
+                    REQUIRE(route == expectedMatch.route);
+                    REQUIRE(pathParameters.count() == expectedMatch.parameters.size());
+                    for (size_t i = 0; i < expectedMatch.parameters.size(); ++i)
+                    {
+                        REQUIRE(pathParameters.name(i) == expectedMatch.parameters[i].first);
+                        REQUIRE(pathParameters.value(i, expectedMatch.path) == expectedMatch.parameters[i].second);
+                        REQUIRE(pathParameters.value(expectedMatch.parameters[i].first, expectedMatch.path) == expectedMatch.parameters[i].second);
+                    }
+                }
+            }
+        }
+
+        WHEN("handler is fetched for a path not matching any route")
+        {
+            Kourier::HttpPathParameters pathParameters;
+            const auto pHandler = router.getHandler(method, "/posts/42", pathParameters);
+
+            THEN("no handler is given")
+            {
+                REQUIRE(pHandler == nullptr);
+                REQUIRE(pathParameters.count() == 0);
+            }
+        }
+    }
+}
+
+
+SCENARIO("HttpRequestRouter captures parameters from request targets wrapping around the read buffer")
+{
+    GIVEN("a route with parameter and wildcard segments")
+    {
+        static std::vector<std::pair<std::string, std::string>> capturedValues;
+        HttpRequestRouter router;
+        REQUIRE(router.addRoute(HttpRequest::Method::GET, "/users/{id}/posts/{postId}/*rest", [](const HttpRequest &request, HttpBroker&)
+        {
+            capturedValues.clear();
+            capturedValues.emplace_back("id", request.pathParameter("id"));
+            capturedValues.emplace_back("postId", request.pathParameter("postId"));
+            capturedValues.emplace_back("rest", request.pathParameter("rest"));
+            capturedValues.emplace_back("unknown", request.pathParameter("unknown"));
+        }));
+        static constexpr std::string_view request("GET /users/123456789/posts/987654321/a/b/c HTTP/1.1\r\nHost: host\r\n\r\n");
+        const auto targetPathEnd = request.find(" HTTP/1.1");
+
+        WHEN("request is parsed from a read buffer that wraps at every position of the target path")
+        {
+            THEN("handler reads all captured values even after other slices overwrite the temporary buffer")
+            {
+                for (size_t wrapPos = 1; wrapPos <= targetPathEnd; ++wrapPos)
+                {
+                    IOChannelTest ioChannel({});
+                    auto &readBuffer = ioChannel.readBuffer();
+                    REQUIRE(readBuffer.write("x") == 1);
+                    const std::string head(readBuffer.availableFreeSize() - wrapPos, 'x');
+                    REQUIRE(readBuffer.write(head) == head.size());
+                    REQUIRE(readBuffer.popFront(head.size()) == head.size());
+                    REQUIRE(readBuffer.write(request) == request.size());
+                    REQUIRE(readBuffer.popFront(1) == 1);
+                    HttpRequestParser parser(ioChannel, std::make_shared<HttpRequestLimits>());
+                    REQUIRE(parser.parse() == HttpRequestParser::ParserStatus::ParsedRequest);
+                    const auto pHandler = router.getHandler(HttpRequest::Method::GET, parser.request().targetPath(), parser.pathParameters());
+                    REQUIRE(pHandler != nullptr);
+                    REQUIRE(parser.request().pathParametersCount() == 3);
+                    // Slicing the whole request also goes through the temporary buffer and overwrites the copied target path.
+                    REQUIRE(ioChannel.peekAll() == request);
+                    TestHttpRequestRouter broker;
+                    pHandler(parser.request(), broker.broker());
+                    REQUIRE(capturedValues == std::vector<std::pair<std::string, std::string>>({{"id", "123456789"},
+                                                                                                 {"postId", "987654321"},
+                                                                                                 {"rest", "a/b/c"},
+                                                                                                 {"unknown", ""}}));
+                }
+            }
+        }
+    }
+}
+
+
+SCENARIO("HttpRequestRouter validates parameter and wildcard segments")
+{
+    GIVEN("a path with invalid parameter or wildcard segments")
+    {
+        const auto method = GENERATE(AS(HttpRequest::Method),
+                                     HttpRequest::Method::POST,
+                                     HttpRequest::Method::PUT,
+                                     HttpRequest::Method::PATCH,
+                                     HttpRequest::Method::DELETE,
+                                     HttpRequest::Method::HEAD,
+                                     HttpRequest::Method::GET,
+                                     HttpRequest::Method::OPTIONS);
+        const auto invalidPath = GENERATE(AS(std::string_view),
+                                          "/users/{}",
+                                          "/users/{id",
+                                          "/users/id}",
+                                          "/users/{id}x",
+                                          "/users/x{id}",
+                                          "/users/{i d}",
+                                          "/users/{id}/{",
+                                          "/files/*path/more",
+                                          "/files/*pa th",
+                                          "/{a}/{b}/{c}/{d}/{e}/{f}/{g}/{h}/{i}/{j}/{k}/{l}/{m}/{n}/{o}/{p}/{q}");
+
+        WHEN("a route is added with given path")
+        {
+            HttpRequestRouter router;
+            const auto succeeded = router.addRoute(method, invalidPath, (RequestHandler)0x1);
+
+            THEN("HttpRequestRouter fails to add the route")
+            {
+                REQUIRE(!succeeded);
+                REQUIRE(!router.errorMessage().empty());
+            }
+        }
+    }
+
+    GIVEN("a path with valid parameter or wildcard segments")
+    {
+        const auto method = GENERATE(AS(HttpRequest::Method),
+                                     HttpRequest::Method::POST,
+                                     HttpRequest::Method::PUT,
+                                     HttpRequest::Method::PATCH,
+                                     HttpRequest::Method::DELETE,
+                                     HttpRequest::Method::HEAD,
+                                     HttpRequest::Method::GET,
+                                     HttpRequest::Method::OPTIONS);
+        const auto validPath = GENERATE(AS(std::string_view),
+                                        "/users/{id}",
+                                        "/users/{id}/",
+                                        "/users/{user_id}/posts/{post-id}",
+                                        "/files/*",
+                                        "/files/*filePath",
+                                        "/files/{bucket}/*filePath",
+                                        "/a*b",
+                                        "/{a}/{b}/{c}/{d}/{e}/{f}/{g}/{h}/{i}/{j}/{k}/{l}/{m}/{n}/{o}/{p}");
+
+        WHEN("a route is added with given path")
+        {
+            HttpRequestRouter router;
+            const auto succeeded = router.addRoute(method, validPath, (RequestHandler)0x1);
+
+            THEN("HttpRequestRouter adds the route")
+            {
+                REQUIRE(succeeded);
+            }
+        }
+    }
+}
+
+
+SCENARIO("HttpRequestRouter only accepts early data on routes for idempotent methods that opted in")
+{
+    GIVEN("a router")
+    {
+        HttpRequestRouter router;
+        const auto method = GENERATE(AS(HttpRequest::Method),
+                                     HttpRequest::Method::POST,
+                                     HttpRequest::Method::PUT,
+                                     HttpRequest::Method::PATCH,
+                                     HttpRequest::Method::DELETE,
+                                     HttpRequest::Method::HEAD,
+                                     HttpRequest::Method::GET,
+                                     HttpRequest::Method::OPTIONS);
+        const bool isIdempotent = (method != HttpRequest::Method::POST && method != HttpRequest::Method::PATCH);
+
+        WHEN("a route that accepts early data and another one that does not are added")
+        {
+            const bool addedEarlyDataRoute = router.addRoute(method, "/early", [](const HttpRequest &, HttpBroker&){}, true);
+            REQUIRE(router.addRoute(method, "/late", [](const HttpRequest &, HttpBroker&){}));
+
+            THEN("router only accepts early data on the opted-in route if method is idempotent")
+            {
+                REQUIRE(addedEarlyDataRoute == isIdempotent);
+                if (!isIdempotent)
+                    REQUIRE(router.errorMessage() == "Failed to register route /early. Early data can only be accepted for idempotent methods.");
+                REQUIRE(router.acceptsEarlyData(method, "/early") == isIdempotent);
+                REQUIRE(router.acceptsEarlyData(method, "/early/more/specific") == isIdempotent);
+                REQUIRE(!router.acceptsEarlyData(method, "/late"));
+                REQUIRE(!router.acceptsEarlyData(method, "/unknown"));
+            }
+        }
+    }
+}
@@ -18,8 +18,12 @@
 #include "HttpServer.h"
 #include "ErrorHandler.h"
 #include "HttpServerOptions.h"
+#include "HttpConnectionHandlerFactory.h"
 #include "../Core/TcpSocket.h"
 #include "../Core/TlsSocket.h"
+#include "../Core/AsyncQObject.h"
+#include <Tests/Resources/AllocationCounter.h>
+#include <Tests/Resources/SyscallCounter.h>
 #include <Tests/Resources/TlsTestCertificates.h>
 #include <Spectator>
 #include <QProcess>
@@ -31,9 +35,19 @@
 #include <QMutex>
 #include <QElapsedTimer>
 #include <QDeadlineTimer>
+#include <QSemaphore>
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
 
 
 using Kourier::HttpServer;
@@ -45,7 +59,13 @@ using Kourier::Object;
 using Kourier::HttpRequest;
 using Kourier::HttpBroker;
 using Kourier::TlsConfiguration;
+using Kourier::AsyncQObject;
+using Kourier::HttpConnectionHandlerFactory;
+using Kourier::HttpRequestRouter;
+using Kourier::ConnectionHandler;
 using TlsVersion = Kourier::TlsConfiguration::TlsVersion;
+using Kourier::TestResources::AllocationCounter;
+using Kourier::TestResources::SyscallCounter;
 using Kourier::TestResources::TlsTestCertificates;
 using Spectator::SemaphoreAwaiter;
 
@@ -73,7 +93,13 @@ SCENARIO("HttpServer sets default values for its options")
                                          HttpServer::ServerOption::MaxChunkMetadataSize,
                                          HttpServer::ServerOption::MaxRequestSize,
                                          HttpServer::ServerOption::MaxBodySize,
-                                         HttpServer::ServerOption::MaxConnectionCount);
+                                         HttpServer::ServerOption::MaxConnectionCount,
+                                         HttpServer::ServerOption::NativeEventLoop,
+                                         HttpServer::ServerOption::NativeConnectionListener,
+                                         HttpServer::ServerOption::WorkerCpuAffinity,
+                                         HttpServer::ServerOption::BufferPoolLowWatermark,
+                                         HttpServer::ServerOption::BufferPoolHighWatermark,
+                                         HttpServer::ServerOption::IoUringBackend);
             const auto optionValue = server.serverOption(option);
 
             THEN("server sets default values for its options")
@@ -1778,3 +1804,530 @@ SCENARIO("HttpServer does not timeout after a complete request is received")
         }
     }
 }
+
+
+namespace HttpServerBenchmarks
+{
+
+class HttpClients : public QObject
+{
+Q_OBJECT
+public:
+    HttpClients(std::string_view serverAddress,
+                uint16_t serverPort,
+                std::string_view request,
+                size_t connectionCount,
+                size_t requestsPerConnection,
+                size_t pipelineDepth) :
+        m_serverAddress(serverAddress),
+        m_serverPort(serverPort),
+        m_request(request),
+        m_connectionCount(connectionCount),
+        m_requestsPerConnection(requestsPerConnection),
+        m_pipelineDepth(pipelineDepth)
+    {
+        REQUIRE(!m_serverAddress.empty()
+                && (m_serverPort != 0)
+                && !m_request.empty()
+                && m_connectionCount > 0
+                && m_requestsPerConnection > 0
+                && m_pipelineDepth > 0);
+        m_connections.resize(m_connectionCount);
+        for (auto &connection : m_connections)
+            connection.pSocket = new TcpSocket;
+        m_latenciesInNSecs.reserve(m_connectionCount * m_requestsPerConnection);
+        m_elapsedTimer.start();
+    }
+    ~HttpClients() override = default;
+    const std::vector<qint64> &latenciesInNSecs() const {return m_latenciesInNSecs;}
+    size_t readCount() const {return m_readCount;}
+
+public slots:
+    void connectToServer()
+    {
+        // Sends made by clients must not count as server sends.
+        SyscallCounter::excludeCurrentThread();
+        for (auto &connection : m_connections)
+        {
+            auto *pConnection = &connection;
+            auto *pSocket = connection.pSocket;
+            Object::connect(pSocket, &TcpSocket::connected, [this, pConnection]()
+            {
+                if (m_sendsRequestsOnConnect)
+                    sendRequest(*pConnection);
+                if (++m_connectedCount == m_connectionCount)
+                    emit connectedToServer();
+            });
+            Object::connect(pSocket, &TcpSocket::receivedData, [this, pConnection](){processResponses(*pConnection);});
+            Object::connect(pSocket, &TcpSocket::disconnected, [this, pSocket]()
+            {
+                pSocket->scheduleForDeletion();
+                if (++m_disconnectedCount == m_connectionCount)
+                    emit disconnectedFromServer();
+            });
+            Object::connect(pSocket, &TcpSocket::error, [](){FAIL("This code is supposed to be unreachable.");});
+            pSocket->connect(m_serverAddress, m_serverPort);
+        }
+    }
+
+    void connectAndSendRequests()
+    {
+        m_sendsRequestsOnConnect = true;
+        m_elapsedTimer.start();
+        connectToServer();
+    }
+
+    void sendRequests()
+    {
+        m_elapsedTimer.start();
+        const auto requestsToPipeline = std::min(m_pipelineDepth, m_requestsPerConnection);
+        for (auto &connection : m_connections)
+        {
+            for (size_t i = 0; i < requestsToPipeline; ++i)
+                sendRequest(connection);
+        }
+    }
+
+    void disconnectFromServer()
+    {
+        for (auto &connection : m_connections)
+            connection.pSocket->disconnectFromPeer();
+    }
+
+signals:
+    void connectedToServer();
+    void receivedResponses();
+    void disconnectedFromServer();
+
+private:
+    struct Connection
+    {
+        TcpSocket *pSocket = nullptr;
+        std::deque<qint64> requestTimestamps;
+        size_t sentRequests = 0;
+        size_t receivedResponses = 0;
+    };
+
+    void sendRequest(Connection &connection)
+    {
+        connection.requestTimestamps.push_back(m_elapsedTimer.nsecsElapsed());
+        ++connection.sentRequests;
+        connection.pSocket->write(m_request);
+    }
+
+    void processResponses(Connection &connection)
+    {
+        static constexpr std::string_view contentLengthHeader("Content-Length: ");
+        ++m_readCount;
+        while (true)
+        {
+            const auto data = connection.pSocket->peekAll();
+            const auto headersEnd = data.find("\r\n\r\n");
+            if (headersEnd == std::string_view::npos)
+                return;
+            const auto contentLengthPos = data.substr(0, headersEnd).find(contentLengthHeader);
+            REQUIRE(contentLengthPos != std::string_view::npos);
+            size_t contentLength = 0;
+            for (auto i = contentLengthPos + contentLengthHeader.size(); data[i] >= '0' && data[i] <= '9'; ++i)
+                contentLength = 10 * contentLength + (data[i] - '0');
+            const auto responseSize = headersEnd + 4 + contentLength;
+            if (data.size() < responseSize)
+                return;
+            connection.pSocket->skip(responseSize);
+            REQUIRE(!connection.requestTimestamps.empty());
+            m_latenciesInNSecs.push_back(m_elapsedTimer.nsecsElapsed() - connection.requestTimestamps.front());
+            connection.requestTimestamps.pop_front();
+            if (++connection.receivedResponses == m_requestsPerConnection)
+            {
+                if (++m_finishedConnectionCount == m_connectionCount)
+                    emit receivedResponses();
+                return;
+            }
+            else if (connection.sentRequests < m_requestsPerConnection)
+                sendRequest(connection);
+        }
+    }
+
+private:
+    std::vector<Connection> m_connections;
+    std::vector<qint64> m_latenciesInNSecs;
+    QElapsedTimer m_elapsedTimer;
+    const std::string m_serverAddress;
+    const uint16_t m_serverPort;
+    const std::string m_request;
+    const size_t m_connectionCount;
+    const size_t m_requestsPerConnection;
+    const size_t m_pipelineDepth;
+    size_t m_connectedCount = 0;
+    size_t m_readCount = 0;
+    size_t m_finishedConnectionCount = 0;
+    size_t m_disconnectedCount = 0;
+    bool m_sendsRequestsOnConnect = false;
+};
+
+using T_AsyncHttpClients = AsyncQObject<HttpClients, std::string_view, uint16_t, std::string_view, size_t, size_t, size_t>;
+
+static quint16 startServer(HttpServer &server)
+{
+    QSemaphore serverStartedSemaphore;
+    QObject ctxObject;
+    QObject::connect(&server, &HttpServer::started, &ctxObject, [&](){serverStartedSemaphore.release();});
+    QObject::connect(&server, &HttpServer::failed, &ctxObject, [](){FAIL("This code is supposed to be unreachable.");});
+    server.start(QHostAddress("127.0.0.1"), 0);
+    REQUIRE(SemaphoreAwaiter::signalSlotAwareWait(serverStartedSemaphore, 10));
+    return server.serverPort();
+}
+
+static void stopServer(HttpServer &server)
+{
+    QSemaphore serverStoppedSemaphore;
+    QObject ctxObject;
+    QObject::connect(&server, &HttpServer::stopped, &ctxObject, [&](){serverStoppedSemaphore.release();});
+    server.stop();
+    REQUIRE(SemaphoreAwaiter::signalSlotAwareWait(serverStoppedSemaphore, 10));
+}
+
+struct HttpBenchmarkResults
+{
+    double requestsPerSecond = 0;
+    double p50LatencyInUSecs = 0;
+    double p99LatencyInUSecs = 0;
+    double responsesPerRead = 0;
+    double sendsPerResponse = 0;
+};
+
+static HttpBenchmarkResults runHttpBenchmark(HttpServer &server,
+                                             std::string_view request,
+                                             size_t clientThreadCount,
+                                             size_t connectionsPerThread,
+                                             size_t requestsPerConnection,
+                                             size_t pipelineDepth)
+{
+    const auto serverPort = startServer(server);
+    std::vector<std::unique_ptr<T_AsyncHttpClients>> clients(clientThreadCount);
+    for (auto &client : clients)
+        client.reset(new T_AsyncHttpClients("127.0.0.1", serverPort, request, connectionsPerThread, requestsPerConnection, pipelineDepth));
+    std::atomic_size_t connectedClientCount = 0;
+    std::atomic_size_t receivedResponseCount = 0;
+    std::atomic_size_t disconnectedClientCount = 0;
+    QSemaphore clientsDisconnectedSemaphore;
+    QElapsedTimer elapsedTimer;
+    HttpBenchmarkResults results;
+    QObject ctxObject;
+    for (auto &client : clients)
+    {
+        QObject::connect(client->get(), &HttpClients::connectedToServer, &ctxObject, [&]()
+        {
+            if (++connectedClientCount == clientThreadCount)
+            {
+                elapsedTimer.start();
+                SyscallCounter::sendCount = 0;
+                for (auto &client : clients)
+                    QMetaObject::invokeMethod(client->get(), "sendRequests", Qt::QueuedConnection);
+            }
+        });
+        QObject::connect(client->get(), &HttpClients::receivedResponses, &ctxObject, [&]()
+        {
+            if (++receivedResponseCount == clientThreadCount)
+            {
+                const auto elapsedNSecs = elapsedTimer.nsecsElapsed();
+                const size_t sendCount = SyscallCounter::sendCount;
+                const auto responseCount = clientThreadCount * connectionsPerThread * requestsPerConnection;
+                results.requestsPerSecond = (1.0e9 * responseCount) / elapsedNSecs;
+                results.sendsPerResponse = double(sendCount) / responseCount;
+                for (auto &client : clients)
+                    QMetaObject::invokeMethod(client->get(), "disconnectFromServer", Qt::QueuedConnection);
+            }
+        });
+        QObject::connect(client->get(), &HttpClients::disconnectedFromServer, &ctxObject, [&]()
+        {
+            if (++disconnectedClientCount == clientThreadCount)
+                clientsDisconnectedSemaphore.release();
+        });
+    }
+    for (auto &client : clients)
+        QMetaObject::invokeMethod(client->get(), "connectToServer", Qt::QueuedConnection);
+    REQUIRE(SemaphoreAwaiter::signalSlotAwareWait(clientsDisconnectedSemaphore, 60000));
+    std::vector<qint64> latenciesInNSecs;
+    latenciesInNSecs.reserve(clientThreadCount * connectionsPerThread * requestsPerConnection);
+    size_t readCount = 0;
+    for (auto &client : clients)
+    {
+        const auto &clientLatencies = client->get()->latenciesInNSecs();
+        latenciesInNSecs.insert(latenciesInNSecs.end(), clientLatencies.cbegin(), clientLatencies.cend());
+        readCount += client->get()->readCount();
+    }
+    // Clients read once for every batch of responses they find buffered, which only bounds how
+    // the server flushes them. The server's send and sendmsg calls are counted directly
+    // (see SyscallCounter) and reported as sends per response.
+    results.responsesPerRead = double(latenciesInNSecs.size()) / std::max<size_t>(1, readCount);
+    REQUIRE(latenciesInNSecs.size() == clientThreadCount * connectionsPerThread * requestsPerConnection);
+    std::sort(latenciesInNSecs.begin(), latenciesInNSecs.end());
+    results.p50LatencyInUSecs = latenciesInNSecs[(latenciesInNSecs.size() * 50) / 100] / 1000.0;
+    results.p99LatencyInUSecs = latenciesInNSecs[(latenciesInNSecs.size() * 99) / 100] / 1000.0;
+    stopServer(server);
+    return results;
+}
+
+static double runConnectionRateBenchmark(HttpServer &server,
+                                         std::string_view request,
+                                         size_t clientThreadCount,
+                                         size_t connectionsPerThread)
+{
+    const auto serverPort = startServer(server);
+    std::vector<std::unique_ptr<T_AsyncHttpClients>> clients(clientThreadCount);
+    for (auto &client : clients)
+        client.reset(new T_AsyncHttpClients("127.0.0.1", serverPort, request, connectionsPerThread, 1, 1));
+    std::atomic_size_t receivedResponseCount = 0;
+    std::atomic_size_t disconnectedClientCount = 0;
+    QSemaphore clientsDisconnectedSemaphore;
+    QElapsedTimer elapsedTimer;
+    double connectionsPerSecond = 0;
+    QObject ctxObject;
+    for (auto &client : clients)
+    {
+        QObject::connect(client->get(), &HttpClients::receivedResponses, &ctxObject, [&]()
+        {
+            if (++receivedResponseCount == clientThreadCount)
+            {
+                connectionsPerSecond = (1.0e9 * clientThreadCount * connectionsPerThread) / elapsedTimer.nsecsElapsed();
+                for (auto &client : clients)
+                    QMetaObject::invokeMethod(client->get(), "disconnectFromServer", Qt::QueuedConnection);
+            }
+        });
+        QObject::connect(client->get(), &HttpClients::disconnectedFromServer, &ctxObject, [&]()
+        {
+            if (++disconnectedClientCount == clientThreadCount)
+                clientsDisconnectedSemaphore.release();
+        });
+    }
+    // Each connection counts once it has been accepted and served its first request,
+    // so the figure reflects the server's accept path rather than the kernel's handshake.
+    elapsedTimer.start();
+    for (auto &client : clients)
+        QMetaObject::invokeMethod(client->get(), "connectAndSendRequests", Qt::QueuedConnection);
+    REQUIRE(SemaphoreAwaiter::signalSlotAwareWait(clientsDisconnectedSemaphore, 60000));
+    stopServer(server);
+    return connectionsPerSecond;
+}
+
+}
+
+using namespace HttpServerBenchmarks;
+
+
+SCENARIO("HttpServer benchmarks")
+{
+    static constexpr std::string_view request("GET /hello HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+    static constexpr size_t workerCount = 2;
+    static constexpr size_t clientThreadCount = 4;
+    static constexpr size_t connectionsPerThread = 64;
+    static constexpr size_t requestsPerConnection = 1000;
+    const auto nativeEventLoop = GENERATE(AS(int64_t), 0, 1);
+    const auto pipelineDepth = GENERATE(AS(size_t), 1, 16);
+    HttpServer server;
+    REQUIRE(server.addRoute(HttpRequest::Method::GET, "/hello", [](const HttpRequest&, HttpBroker &broker){broker.writeResponse("Hello World!");}));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::WorkerCount, workerCount));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::NativeEventLoop, nativeEventLoop));
+    const auto results = runHttpBenchmark(server, request, clientThreadCount, connectionsPerThread, requestsPerConnection, pipelineDepth);
+    WARN(QByteArray("Event loop: ").append(nativeEventLoop ? "native epoll" : "Qt"));
+    WARN(QByteArray("Pipeline depth: ").append(QByteArray::number(pipelineDepth)));
+    WARN(QByteArray("Requests per second: ").append(QByteArray::number(results.requestsPerSecond)));
+    WARN(QByteArray("p50 latency (us): ").append(QByteArray::number(results.p50LatencyInUSecs)));
+    WARN(QByteArray("p99 latency (us): ").append(QByteArray::number(results.p99LatencyInUSecs)));
+    WARN(QByteArray("Responses per client read: ").append(QByteArray::number(results.responsesPerRead)));
+    WARN(QByteArray("Server sends per response: ").append(QByteArray::number(results.sendsPerResponse)));
+}
+
+
+SCENARIO("HttpServer io_uring backend benchmarks")
+{
+    static constexpr std::string_view request("GET /hello HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+    static constexpr size_t workerCount = 2;
+    static constexpr size_t clientThreadCount = 4;
+    static constexpr size_t connectionsPerThread = 64;
+    static constexpr size_t requestsPerConnection = 1000;
+    const auto ioUringBackend = GENERATE(AS(int64_t), 0, 1);
+    const auto pipelineDepth = GENERATE(AS(size_t), 1, 16);
+    HttpServer server;
+    REQUIRE(server.addRoute(HttpRequest::Method::GET, "/hello", [](const HttpRequest&, HttpBroker &broker){broker.writeResponse("Hello World!");}));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::WorkerCount, workerCount));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::NativeEventLoop, 1));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::NativeConnectionListener, 1));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::IoUringBackend, ioUringBackend));
+    const auto results = runHttpBenchmark(server, request, clientThreadCount, connectionsPerThread, requestsPerConnection, pipelineDepth);
+    WARN(QByteArray("Backend: ").append(ioUringBackend ? "io_uring" : "epoll"));
+    WARN(QByteArray("Pipeline depth: ").append(QByteArray::number(pipelineDepth)));
+    WARN(QByteArray("Requests per second: ").append(QByteArray::number(results.requestsPerSecond)));
+    WARN(QByteArray("p50 latency (us): ").append(QByteArray::number(results.p50LatencyInUSecs)));
+    WARN(QByteArray("p99 latency (us): ").append(QByteArray::number(results.p99LatencyInUSecs)));
+    WARN(QByteArray("Responses per client read: ").append(QByteArray::number(results.responsesPerRead)));
+    WARN(QByteArray("Server sends per response: ").append(QByteArray::number(results.sendsPerResponse)));
+}
+
+
+SCENARIO("HttpServer connection rate benchmarks")
+{
+    static constexpr std::string_view request("GET /hello HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+    static constexpr size_t workerCount = 2;
+    static constexpr size_t clientThreadCount = 4;
+    static constexpr size_t connectionsPerThread = 2500;
+    const auto nativeEventLoop = GENERATE(AS(int64_t), 0, 1);
+    const auto nativeConnectionListener = GENERATE(AS(int64_t), 0, 1);
+    HttpServer server;
+    REQUIRE(server.addRoute(HttpRequest::Method::GET, "/hello", [](const HttpRequest&, HttpBroker &broker){broker.writeResponse("Hello World!");}));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::WorkerCount, workerCount));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::NativeEventLoop, nativeEventLoop));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::NativeConnectionListener, nativeConnectionListener));
+    const auto connectionsPerSecond = runConnectionRateBenchmark(server, request, clientThreadCount, connectionsPerThread);
+    WARN(QByteArray("Event loop: ").append(nativeEventLoop ? "native epoll" : "Qt"));
+    WARN(QByteArray("Connection listener: ").append(nativeConnectionListener ? "SO_REUSEPORT accept4" : "QTcpServer"));
+    WARN(QByteArray("Connections per second: ").append(QByteArray::number(connectionsPerSecond)));
+}
+
+SCENARIO("HttpServer large body response benchmarks")
+{
+    static constexpr std::string_view request("GET /large HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+    static constexpr size_t workerCount = 2;
+    static constexpr size_t clientThreadCount = 4;
+    static constexpr size_t connectionsPerThread = 16;
+    static constexpr size_t requestsPerConnection = 200;
+    static const std::string largeBody(256 * 1024, 'k');
+    const auto nativeEventLoop = GENERATE(AS(int64_t), 0, 1);
+    HttpServer server;
+    REQUIRE(server.addRoute(HttpRequest::Method::GET, "/large", [](const HttpRequest&, HttpBroker &broker){broker.writeResponse(largeBody);}));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::WorkerCount, workerCount));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::NativeEventLoop, nativeEventLoop));
+    const auto results = runHttpBenchmark(server, request, clientThreadCount, connectionsPerThread, requestsPerConnection, 1);
+    WARN(QByteArray("Event loop: ").append(nativeEventLoop ? "native epoll" : "Qt"));
+    WARN(QByteArray("Body size: ").append(QByteArray::number(qsizetype(largeBody.size()))));
+    WARN(QByteArray("Requests per second: ").append(QByteArray::number(results.requestsPerSecond)));
+    WARN(QByteArray("p50 latency (us): ").append(QByteArray::number(results.p50LatencyInUSecs)));
+    WARN(QByteArray("p99 latency (us): ").append(QByteArray::number(results.p99LatencyInUSecs)));
+}
+
+
+SCENARIO("HttpServer many small headers response benchmarks")
+{
+    static constexpr std::string_view request("GET /headers HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+    static constexpr size_t workerCount = 2;
+    static constexpr size_t clientThreadCount = 4;
+    static constexpr size_t connectionsPerThread = 64;
+    static constexpr size_t requestsPerConnection = 1000;
+    static const std::vector<std::pair<std::string, std::string>> headers = []()
+    {
+        std::vector<std::pair<std::string, std::string>> headers;
+        for (auto i = 0; i < 32; ++i)
+            headers.emplace_back(std::string("X-Header-").append(std::to_string(i)), std::string("value-").append(std::to_string(i)));
+        return headers;
+    }();
+    const auto nativeEventLoop = GENERATE(AS(int64_t), 0, 1);
+    const auto pipelineDepth = GENERATE(AS(size_t), 1, 16);
+    HttpServer server;
+    REQUIRE(server.addRoute(HttpRequest::Method::GET, "/headers", [](const HttpRequest&, HttpBroker &broker){broker.writeResponse("Hello World!", HttpBroker::HttpStatusCode::OK, headers);}));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::WorkerCount, workerCount));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::NativeEventLoop, nativeEventLoop));
+    const auto results = runHttpBenchmark(server, request, clientThreadCount, connectionsPerThread, requestsPerConnection, pipelineDepth);
+    WARN(QByteArray("Event loop: ").append(nativeEventLoop ? "native epoll" : "Qt"));
+    WARN(QByteArray("Header count: ").append(QByteArray::number(qsizetype(headers.size()))));
+    WARN(QByteArray("Pipeline depth: ").append(QByteArray::number(pipelineDepth)));
+    WARN(QByteArray("Requests per second: ").append(QByteArray::number(results.requestsPerSecond)));
+    WARN(QByteArray("p50 latency (us): ").append(QByteArray::number(results.p50LatencyInUSecs)));
+    WARN(QByteArray("p99 latency (us): ").append(QByteArray::number(results.p99LatencyInUSecs)));
+}
+
+SCENARIO("HttpServer file response benchmarks")
+{
+    static constexpr std::string_view request("GET /file HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n");
+    static constexpr size_t workerCount = 2;
+    static constexpr size_t clientThreadCount = 4;
+    static constexpr size_t connectionsPerThread = 16;
+    static constexpr size_t requestsPerConnection = 200;
+    static const std::string fileContent(256 * 1024, 'f');
+    static const std::string filePath = []()
+    {
+        static QTemporaryFile file;
+        if (!file.open() || file.write(fileContent.data(), fileContent.size()) != qint64(fileContent.size()) || !file.flush())
+            qFatal("Failed to create file for benchmark.");
+        return file.fileName().toStdString();
+    }();
+    const auto nativeEventLoop = GENERATE(AS(int64_t), 0, 1);
+    const auto fromFile = GENERATE(AS(bool), false, true);
+    HttpServer server;
+    if (fromFile)
+        REQUIRE(server.addRoute(HttpRequest::Method::GET, "/file", [](const HttpRequest&, HttpBroker &broker){broker.writeFile(filePath);}));
+    else
+        REQUIRE(server.addRoute(HttpRequest::Method::GET, "/file", [](const HttpRequest&, HttpBroker &broker){broker.writeResponse(fileContent);}));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::WorkerCount, workerCount));
+    REQUIRE(server.setServerOption(HttpServer::ServerOption::NativeEventLoop, nativeEventLoop));
+    const auto results = runHttpBenchmark(server, request, clientThreadCount, connectionsPerThread, requestsPerConnection, 1);
+    WARN(QByteArray("Event loop: ").append(nativeEventLoop ? "native epoll" : "Qt"));
+    WARN(QByteArray("Response source: ").append(fromFile ? "writeFile (sendfile)" : "writeResponse (memory)"));
+    WARN(QByteArray("Requests per second: ").append(QByteArray::number(results.requestsPerSecond)));
+    WARN(QByteArray("p50 latency (us): ").append(QByteArray::number(results.p50LatencyInUSecs)));
+    WARN(QByteArray("p99 latency (us): ").append(QByteArray::number(results.p99LatencyInUSecs)));
+}
+
+
+SCENARIO("HttpConnectionHandlerFactory allocations per accepted connection")
+{
+    GIVEN("a connection handler factory and a listening socket")
+    {
+        constexpr size_t acceptCount = 10000;
+        HttpConnectionHandlerFactory factory(HttpServerOptions{}, HttpRequestRouter{}, TlsConfiguration{});
+        const auto listeningFd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        REQUIRE(listeningFd >= 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = ::inet_addr("127.0.0.1");
+        address.sin_port = 0;
+        REQUIRE(::bind(listeningFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+        REQUIRE(::listen(listeningFd, 128) == 0);
+        socklen_t addressLength = sizeof(address);
+        REQUIRE(::getsockname(listeningFd, reinterpret_cast<sockaddr*>(&address), &addressLength) == 0);
+        const auto acceptConnection = [&]()
+        {
+            const auto clientFd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            REQUIRE(clientFd >= 0);
+            REQUIRE(::connect(clientFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0);
+            const auto serverFd = ::accept4(listeningFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            REQUIRE(serverFd >= 0);
+            return std::make_pair(clientFd, serverFd);
+        };
+        const auto [warmUpClientFd, warmUpServerFd] = acceptConnection();
+        delete factory.create(warmUpServerFd);
+        ::close(warmUpClientFd);
+
+        WHEN("the factory creates a handler for each accepted connection, which is then destroyed")
+        {
+            size_t allocationCount = 0;
+            size_t handlerCount = 0;
+            qint64 elapsedNSecs = 0;
+            QElapsedTimer elapsedTimer;
+            for (size_t i = 0; i < acceptCount; ++i)
+            {
+                const auto [clientFd, serverFd] = acceptConnection();
+                AllocationCounter::start();
+                elapsedTimer.start();
+                ConnectionHandler *pHandler = factory.create(serverFd);
+                handlerCount += (pHandler != nullptr);
+                delete pHandler;
+                elapsedNSecs += elapsedTimer.nsecsElapsed();
+                allocationCount += AllocationCounter::stop();
+                ::close(clientFd);
+            }
+            const double nsPerAccept = elapsedNSecs / double(acceptCount);
+            const double allocationsPerAccept = allocationCount / double(acceptCount);
+            ::close(listeningFd);
+            WARN(QByteArray("Time per accept (ns): ").append(QByteArray::number(nsPerAccept)));
+            WARN(QByteArray("Allocations per accept: ").append(QByteArray::number(allocationsPerAccept)));
+
+            THEN("factory creates a handler for every accepted connection")
+            {
+                REQUIRE(handlerCount == acceptCount);
+            }
+        }
+    }
+}
+
+#include "HttpServer.bench.moc"
@@ -79,6 +79,18 @@ handler to know why the server failed to call a mapped handler.
  \brief Maximum request body size.
  \var HttpServer::ServerOption::MaxConnectionCount
  \brief Maximum number of connections the server can keep.
+ \var HttpServer::ServerOption::NativeEventLoop
+ \brief Set to 1 to make workers block directly on Kourier's epoll instance instead of nesting it inside Qt's event loop. By default, HttpServer uses Qt's event loop.
+ \var HttpServer::ServerOption::NativeConnectionListener
+ \brief Set to 1 to make each worker accept connections in batches on its own SO_REUSEPORT socket registered in Kourier's epoll instance, letting the kernel balance connections among workers. By default, HttpServer accepts connections through QTcpServer.
+ \var HttpServer::ServerOption::WorkerCpuAffinity
+ \brief Set to 1 to pin each worker thread to its own CPU, or to 2 to pin workers to CPUs spread among NUMA nodes. Pinned workers allocate memory on their local NUMA node and, with NativeConnectionListener set, their listening sockets prefer connections whose packets are processed on the same CPU (SO_INCOMING_CPU). By default, workers are not pinned.
+ \var HttpServer::ServerOption::BufferPoolLowWatermark
+ \brief Number of idle blocks each worker's buffer pool keeps after releasing memory. Connections borrow fixed-size blocks from their worker's pool to store data being read or written and give them back once their buffers drain.
+ \var HttpServer::ServerOption::BufferPoolHighWatermark
+ \brief Number of idle blocks above which each worker's buffer pool releases memory, down to BufferPoolLowWatermark idle blocks.
+ \var HttpServer::ServerOption::IoUringBackend
+ \brief Set to 1 to make workers wait for events on an io_uring instance. Workers then accept connections with multishot accepts, receive data on non-TLS connections with multishot receives into buffers provided to the kernel, and drive timers with multishot timeouts. Workers keep using epoll if the kernel does not support these operations. By default, workers use epoll.
 */
 
 /*!
@@ -102,13 +114,18 @@ handler to know why the server failed to call a mapped handler.
 */
 
 /*!
- \fn HttpServer::addRoute(HttpRequest::Method method, std::string_view path, void (*pFcn)(const HttpRequest&, HttpBroker&))
+ \fn HttpServer::addRoute(HttpRequest::Method method, std::string_view path, void (*pFcn)(const HttpRequest&, HttpBroker&), bool acceptsEarlyData = false)
 Maps the handler identified by \a pFcn to the given \a path for requests containing the given \a method.
 HttpServer always picks the most specific path for handling a given request. You can call HttpBroker::setQObject on the HttpBroker
 object that HttpServer passes to the handler function to postpone responding until after the handler finishes.
 HttpServer monitors responses through the given broker, and after you write a complete response for the current request,
 HttpServer destroys any QObject you set on the broker and processes the next request. See
 [Adding Handlers](@ref AddingHandlers) for more details.
+
+If \a acceptsEarlyData is true, HttpServer processes requests for this route received as TLS 1.3 early data (0-RTT)
+right away, before the handshake completes. As early data can be replayed, only routes for idempotent methods can accept it,
+and addRoute fails if \a acceptsEarlyData is true for POST or PATCH methods. Requests for other routes received as early data
+are processed after the handshake completes. See TlsConfiguration::setMaxEarlyDataSize.
 */
 
 /*!
@@ -138,6 +155,56 @@ HttpServer destroys any QObject you set on the broker and processes the next req
  Makes HttpServer encrypt connections according to the given \a tlsConfiguration.
 */
 
+/*!
+ \fn HttpServer::setSniCertificateKeyPair(std::string_view serverName, std::string_view certificate, std::string_view key, std::string_view keyPassword = "")
+ Makes HttpServer present the certificate in \a certificate, with the private key in \a key, to TLS clients requesting
+ \a serverName through the Server Name Indication (SNI) extension. Given files must be in PEM format, and \a keyPassword
+ decrypts the private key if it is encrypted. \a serverName is either a host name, like *api.example.com*, or a wildcard
+ that covers a single leftmost label, like *\*.example.com*. Exact host names take precedence over wildcards and names are
+ compared case-insensitively. Clients that do not send a server name, or send one without a matching certificate, get the
+ certificate set in the [TLS configuration](@ref Kourier::HttpServer::setTlsConfiguration). All other TLS settings, such as
+ versions, ciphers, peer verification and session resumption, come from the TLS configuration. Sessions established under
+ \a serverName are only resumed by clients requesting a server name that \a serverName covers.
+
+ HttpServer loads the certificate before returning and replaces any certificate already set for \a serverName. You can call
+ this method while the server is running. Workers pick up the change on the next handshake, without being restarted, and
+ connections that already started their handshake keep the certificate they were given. Selecting a certificate costs a
+ hash lookup, disregarding how many certificates are set. Returns false and sets [errorMessage](@ref Kourier::HttpServer::errorMessage)
+ if \a serverName is not valid or if the certificate/key pair cannot be loaded.
+*/
+
+/*!
+ \fn HttpServer::removeSniCertificateKeyPair(std::string_view serverName)
+ Removes the certificate set for \a serverName by [setSniCertificateKeyPair](@ref Kourier::HttpServer::setSniCertificateKeyPair).
+ As with setSniCertificateKeyPair, you can call this method while the server is running. Returns false and sets
+ [errorMessage](@ref Kourier::HttpServer::errorMessage) if no certificate is set for \a serverName.
+*/
+
+/*!
+ \fn HttpServer::sniCertificateCount()
+ Returns the number of server names with a certificate set by [setSniCertificateKeyPair](@ref Kourier::HttpServer::setSniCertificateKeyPair).
+*/
+
+/*!
+ \fn HttpServer::fullTlsHandshakeCount()
+ Returns the number of TLS handshakes completed by all workers that established new sessions, as opposed to resuming cached ones.
+*/
+
+/*!
+ \fn HttpServer::resumedTlsHandshakeCount()
+ Returns the number of TLS handshakes completed by all workers that resumed previously established sessions.
+ See TlsConfiguration::setSessionCacheSize and TlsConfiguration::setSessionTicketsEnabled.
+*/
+
+/*!
+ \fn HttpServer::workerMemoryStatistics()
+ Returns, for each worker started by the last call to [start](@ref Kourier::HttpServer::start), the statistics of the pool
+ its connections borrow buffer blocks from. Statistics report blocks in use by connections, idle blocks kept by the pool,
+ the peak block count and the bytes of buffers too large to fit in a block. See
+ [BufferPoolLowWatermark](@ref Kourier::HttpServer::ServerOption::BufferPoolLowWatermark) and
+ [BufferPoolHighWatermark](@ref Kourier::HttpServer::ServerOption::BufferPoolHighWatermark).
+*/
+
 /*!
  \fn HttpServer::start(const QHostAddress &address, quint16 port)
  Starts HttpServer. HttpServer creates as many workers as set in the [worker count](@ref Kourier::HttpServer::ServerOption::WorkerCount)
@@ -182,10 +249,10 @@ bool HttpServer::isRunning() const
     return d->isRunning();
 }
 
-bool HttpServer::addRoute(HttpRequest::Method method, std::string_view path, void (*pFcn)(const HttpRequest&, HttpBroker&))
+bool HttpServer::addRoute(HttpRequest::Method method, std::string_view path, void (*pFcn)(const HttpRequest&, HttpBroker&), bool acceptsEarlyData)
 {
     Q_D(HttpServer);
-    return d->addRoute(method, path, pFcn);
+    return d->addRoute(method, path, pFcn, acceptsEarlyData);
 }
 
 bool HttpServer::setServerOption(ServerOption option, int64_t value)
@@ -212,6 +279,24 @@ bool HttpServer::setTlsConfiguration(const TlsConfiguration &tlsConfiguration)
     return d->setTlsConfiguration(tlsConfiguration);
 }
 
+bool HttpServer::setSniCertificateKeyPair(std::string_view serverName, std::string_view certificate, std::string_view key, std::string_view keyPassword)
+{
+    Q_D(HttpServer);
+    return d->setSniCertificateKeyPair(serverName, certificate, key, keyPassword);
+}
+
+bool HttpServer::removeSniCertificateKeyPair(std::string_view serverName)
+{
+    Q_D(HttpServer);
+    return d->removeSniCertificateKeyPair(serverName);
+}
+
+size_t HttpServer::sniCertificateCount() const
+{
+    Q_D(const HttpServer);
+    return d->sniCertificateCount();
+}
+
 QHostAddress HttpServer::serverAddress() const
 {
     Q_D(const HttpServer);
@@ -230,6 +315,24 @@ size_t HttpServer::connectionCount() const
     return d->connectionCount();
 }
 
+size_t HttpServer::fullTlsHandshakeCount() const
+{
+    Q_D(const HttpServer);
+    return d->fullTlsHandshakeCount();
+}
+
+size_t HttpServer::resumedTlsHandshakeCount() const
+{
+    Q_D(const HttpServer);
+    return d->resumedTlsHandshakeCount();
+}
+
+std::vector<BufferPool::Statistics> HttpServer::workerMemoryStatistics() const
+{
+    Q_D(const HttpServer);
+    return d->workerMemoryStatistics();
+}
+
 void HttpServer::start(QHostAddress address, quint16 port)
 {
     Q_D(HttpServer);
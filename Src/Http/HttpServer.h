@@ -21,6 +21,7 @@
 #include "HttpRequest.h"
 #include "HttpBroker.h"
 #include "../Core/TlsConfiguration.h"
+#include "../Core/BufferPool.h"
 #include <QHostAddress>
 #include <QObject>
 #include <memory>
@@ -38,7 +39,7 @@ public:
     HttpServer();
     ~HttpServer() override;
     bool isRunning() const;
-    bool addRoute(HttpRequest::Method method, std::string_view path, void(*pFcn)(const HttpRequest&, HttpBroker&));
+    bool addRoute(HttpRequest::Method method, std::string_view path, void(*pFcn)(const HttpRequest&, HttpBroker&), bool acceptsEarlyData = false);
     enum class ServerOption
     {
         WorkerCount,
@@ -55,7 +56,13 @@ public:
         MaxChunkMetadataSize,
         MaxRequestSize,
         MaxBodySize,
-        MaxConnectionCount
+        MaxConnectionCount,
+        NativeEventLoop,
+        NativeConnectionListener,
+        WorkerCpuAffinity,
+        BufferPoolLowWatermark,
+        BufferPoolHighWatermark,
+        IoUringBackend
     };
     bool setServerOption(ServerOption option, int64_t value);
     int64_t serverOption(ServerOption option) const;
@@ -69,9 +76,15 @@ public:
     void setErrorHandler(std::shared_ptr<ErrorHandler> pErrorHandler);
     std::string_view errorMessage() const;
     bool setTlsConfiguration(const TlsConfiguration &tlsConfiguration);
+    bool setSniCertificateKeyPair(std::string_view serverName, std::string_view certificate, std::string_view key, std::string_view keyPassword = "");
+    bool removeSniCertificateKeyPair(std::string_view serverName);
+    size_t sniCertificateCount() const;
     QHostAddress serverAddress() const;
     quint16 serverPort() const;
     size_t connectionCount() const;
+    size_t fullTlsHandshakeCount() const;
+    size_t resumedTlsHandshakeCount() const;
+    std::vector<BufferPool::Statistics> workerMemoryStatistics() const;
 
 public Q_SLOTS:
     void start(QHostAddress address, quint16 port);
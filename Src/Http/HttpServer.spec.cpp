@@ -18,6 +18,8 @@
 #include "HttpServer.h"
 #include "ErrorHandler.h"
 #include "HttpServerOptions.h"
+#include "../Core/EpollEventNotifier.h"
+#include "../Core/IoUring.h"
 #include "../Core/TcpSocket.h"
 #include "../Core/TlsSocket.h"
 #include <Tests/Resources/TlsTestCertificates.h>
@@ -32,14 +34,23 @@
 #include <QMutex>
 #include <QElapsedTimer>
 #include <QDeadlineTimer>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
 
 
 using Kourier::HttpServer;
 using Kourier::ErrorHandler;
 using Kourier::HttpServerOptions;
+using Kourier::EpollEventNotifier;
+using Kourier::IoUring;
 using Kourier::TcpSocket;
 using Kourier::TlsSocket;
 using Kourier::Object;
@@ -75,7 +86,13 @@ SCENARIO("HttpServer sets default values for its options")
                                          HttpServer::ServerOption::MaxChunkMetadataSize,
                                          HttpServer::ServerOption::MaxRequestSize,
                                          HttpServer::ServerOption::MaxBodySize,
-                                         HttpServer::ServerOption::MaxConnectionCount);
+                                         HttpServer::ServerOption::MaxConnectionCount,
+                                         HttpServer::ServerOption::NativeEventLoop,
+                                         HttpServer::ServerOption::NativeConnectionListener,
+                                         HttpServer::ServerOption::WorkerCpuAffinity,
+                                         HttpServer::ServerOption::BufferPoolLowWatermark,
+                                         HttpServer::ServerOption::BufferPoolHighWatermark,
+                                         HttpServer::ServerOption::IoUringBackend);
             const auto optionValue = server.serverOption(option);
 
             THEN("server sets default values for its options")
@@ -653,6 +670,142 @@ SCENARIO("HttpServer does not accept TLS 1.3 clients if it is configured to acce
 }
 
 
+// Connects to server with a blocking OpenSSL client that sends given server name, if any, and returns the
+// type of the public key in the certificate the server presents, or EVP_PKEY_NONE if the handshake fails.
+static int serverCertificateKeyType(quint16 port, TlsVersion tlsVersion, const char *pServerName)
+{
+    std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> pContext(SSL_CTX_new(TLS_client_method()), &SSL_CTX_free);
+    if (!pContext)
+        return EVP_PKEY_NONE;
+    const auto protocolVersion = (tlsVersion == TlsVersion::TLS_1_2) ? TLS1_2_VERSION : TLS1_3_VERSION;
+    SSL_CTX_set_min_proto_version(pContext.get(), protocolVersion);
+    SSL_CTX_set_max_proto_version(pContext.get(), protocolVersion);
+    SSL_CTX_set_verify(pContext.get(), SSL_VERIFY_NONE, nullptr);
+    const auto socketDescriptor = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (socketDescriptor < 0)
+        return EVP_PKEY_NONE;
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int keyType = EVP_PKEY_NONE;
+    std::unique_ptr<SSL, decltype(&SSL_free)> pSSL(nullptr, &SSL_free);
+    if (::connect(socketDescriptor, (const sockaddr*)&address, sizeof(address)) == 0)
+        pSSL.reset(SSL_new(pContext.get()));
+    if (pSSL)
+    {
+        SSL_set_fd(pSSL.get(), socketDescriptor);
+        if (pServerName != nullptr)
+            SSL_set_tlsext_host_name(pSSL.get(), pServerName);
+        if (SSL_connect(pSSL.get()) == 1)
+        {
+            std::unique_ptr<X509, decltype(&X509_free)> pCertificate(SSL_get1_peer_certificate(pSSL.get()), &X509_free);
+            if (pCertificate)
+                keyType = EVP_PKEY_get_base_id(X509_get0_pubkey(pCertificate.get()));
+            SSL_shutdown(pSSL.get());
+        }
+    }
+    pSSL.reset();
+    ::close(socketDescriptor);
+    return keyType;
+}
+
+
+SCENARIO("HttpServer selects certificate by the server name clients indicate")
+{
+    GIVEN("a running server with an RSA certificate in its TLS configuration")
+    {
+        const auto tlsVersion = GENERATE(AS(TlsVersion), TlsVersion::TLS_1_2, TlsVersion::TLS_1_3);
+        std::string rsaCertificateFile;
+        std::string rsaPrivateKeyFile;
+        std::string rsaCaCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(TlsTestCertificates::CertificateType::RSA_2048, rsaCertificateFile, rsaPrivateKeyFile, rsaCaCertificateFile);
+        std::string ecdsaCertificateFile;
+        std::string ecdsaPrivateKeyFile;
+        std::string ecdsaCaCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(TlsTestCertificates::CertificateType::ECDSA, ecdsaCertificateFile, ecdsaPrivateKeyFile, ecdsaCaCertificateFile);
+        HttpServer server;
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(rsaCertificateFile, rsaPrivateKeyFile);
+        serverTlsConfiguration.setTlsVersion(tlsVersion);
+        REQUIRE(server.setTlsConfiguration(serverTlsConfiguration));
+        REQUIRE(server.sniCertificateCount() == 0);
+        QSemaphore serverStartedSemaphore;
+        QObject::connect(&server, &HttpServer::started, [&](){serverStartedSemaphore.release();});
+        QSemaphore serverStoppedSemaphore;
+        QObject::connect(&server, &HttpServer::stopped, [&](){serverStoppedSemaphore.release();});
+        QObject::connect(&server, &HttpServer::failed, [](){Spectator::FAIL("This code is supposed to be unreachable.");});
+        server.start(QHostAddress("127.0.0.1"), 0);
+        REQUIRE(TRY_ACQUIRE(serverStartedSemaphore, 10));
+        const auto serverPort = server.serverPort();
+
+        WHEN("no certificate is set for any server name")
+        {
+            THEN("server presents the certificate from its TLS configuration")
+            {
+                REQUIRE(serverCertificateKeyType(serverPort, tlsVersion, "exact.test.local") == EVP_PKEY_RSA);
+                REQUIRE(serverCertificateKeyType(serverPort, tlsVersion, nullptr) == EVP_PKEY_RSA);
+                server.stop();
+                REQUIRE(TRY_ACQUIRE(serverStoppedSemaphore, 10));
+            }
+        }
+
+        WHEN("invalid server names or certificates are set while server is running")
+        {
+            THEN("server fails to set them")
+            {
+                for (const auto *pServerName : {"", "*", "*.", "*.local", "a..test.local", ".test.local", "test.local.", "a.*.test.local"})
+                {
+                    REQUIRE(!server.setSniCertificateKeyPair(pServerName, ecdsaCertificateFile, ecdsaPrivateKeyFile));
+                    REQUIRE(!server.errorMessage().empty());
+                }
+                REQUIRE(!server.setSniCertificateKeyPair("exact.test.local", ecdsaCertificateFile, rsaPrivateKeyFile));
+                REQUIRE(!server.errorMessage().empty());
+                REQUIRE(!server.removeSniCertificateKeyPair("exact.test.local"));
+                REQUIRE(!server.errorMessage().empty());
+                REQUIRE(server.sniCertificateCount() == 0);
+                server.stop();
+                REQUIRE(TRY_ACQUIRE(serverStoppedSemaphore, 10));
+            }
+        }
+
+        WHEN("ECDSA certificates are set for an exact host name and a wildcard while server is running")
+        {
+            REQUIRE(server.setSniCertificateKeyPair("exact.test.local", ecdsaCertificateFile, ecdsaPrivateKeyFile));
+            REQUIRE(server.setSniCertificateKeyPair("*.wildcard.test.local", ecdsaCertificateFile, ecdsaPrivateKeyFile));
+            REQUIRE(server.sniCertificateCount() == 2);
+
+            THEN("server presents the ECDSA certificate to clients indicating matching server names")
+            {
+                REQUIRE(serverCertificateKeyType(serverPort, tlsVersion, "exact.test.local") == EVP_PKEY_EC);
+                REQUIRE(serverCertificateKeyType(serverPort, tlsVersion, "EXACT.Test.Local") == EVP_PKEY_EC);
+                REQUIRE(serverCertificateKeyType(serverPort, tlsVersion, "host.wildcard.test.local") == EVP_PKEY_EC);
+                REQUIRE(serverCertificateKeyType(serverPort, tlsVersion, "other.exact.test.local") == EVP_PKEY_RSA);
+                REQUIRE(serverCertificateKeyType(serverPort, tlsVersion, "wildcard.test.local") == EVP_PKEY_RSA);
+                REQUIRE(serverCertificateKeyType(serverPort, tlsVersion, "a.host.wildcard.test.local") == EVP_PKEY_RSA);
+                REQUIRE(serverCertificateKeyType(serverPort, tlsVersion, nullptr) == EVP_PKEY_RSA);
+
+                AND_WHEN("certificates are swapped and removed while server is running")
+                {
+                    REQUIRE(server.setSniCertificateKeyPair("*.wildcard.test.local", rsaCertificateFile, rsaPrivateKeyFile));
+                    REQUIRE(server.removeSniCertificateKeyPair("Exact.Test.Local"));
+                    REQUIRE(server.sniCertificateCount() == 1);
+
+                    THEN("server presents the certificates set last without restarting")
+                    {
+                        REQUIRE(server.isRunning());
+                        REQUIRE(serverCertificateKeyType(serverPort, tlsVersion, "exact.test.local") == EVP_PKEY_RSA);
+                        REQUIRE(serverCertificateKeyType(serverPort, tlsVersion, "host.wildcard.test.local") == EVP_PKEY_RSA);
+                        server.stop();
+                        REQUIRE(TRY_ACQUIRE(serverStoppedSemaphore, 10));
+                    }
+                }
+            }
+        }
+    }
+}
+
+
 SCENARIO("HttpServer adds date and time headers")
 {
     GIVEN("a running server")
@@ -1746,6 +1899,93 @@ SCENARIO("HttpServer supports pipelined requests")
 }
 
 
+SCENARIO("HttpServer serves requests with io_uring backend")
+{
+    GIVEN("a running server using the io_uring backend and a connected client")
+    {
+        const auto nativeEventLoop = GENERATE(AS(int64_t), 0, 1);
+        const auto nativeConnectionListener = GENERATE(AS(int64_t), 0, 1);
+        HttpServer server;
+        REQUIRE(server.setServerOption(HttpServer::ServerOption::NativeEventLoop, nativeEventLoop));
+        REQUIRE(server.setServerOption(HttpServer::ServerOption::NativeConnectionListener, nativeConnectionListener));
+        REQUIRE(server.setServerOption(HttpServer::ServerOption::IoUringBackend, 1));
+        static size_t counter{0};
+        counter = 0;
+        // Workers fall back to epoll on kernels lacking the ring operations they need.
+        static std::atomic_size_t requestsHandledOnIoUring{0};
+        requestsHandledOnIoUring = 0;
+        REQUIRE(server.addRoute(HttpRequest::Method::POST, "/", [](const HttpRequest &request, HttpBroker &broker)
+        {
+            if (EpollEventNotifier::isUsingIoUringOnCurrentThread())
+                ++requestsHandledOnIoUring;
+            if (request.isComplete())
+                broker.writeResponse(std::string("Hello World ").append(std::to_string(++counter)));
+            else
+            {
+                broker.setQObject(new QObject);
+                QObject::connect(&broker, &HttpBroker::receivedBodyData, [&](std::string_view data, bool isLastPart)
+                {
+                    if (isLastPart)
+                        broker.writeResponse(std::string("Hello World ").append(std::to_string(++counter)));
+                });
+            }
+        }));
+        QSemaphore serverStartedSemaphore;
+        QObject::connect(&server, &HttpServer::started, [&](){serverStartedSemaphore.release();});
+        QSemaphore serverStoppedSemaphore;
+        QObject::connect(&server, &HttpServer::stopped, [&](){serverStoppedSemaphore.release();});
+        QObject::connect(&server, &HttpServer::failed, [](){Spectator::FAIL("This code is supposed to be unreachable.");});
+        server.start(QHostAddress("127.0.0.1"), 0);
+        REQUIRE(TRY_ACQUIRE(serverStartedSemaphore, 10));
+        REQUIRE(server.isRunning());
+        TcpSocket clientSocket;
+        QSemaphore clientConnectedSemaphore;
+        Object::connect(&clientSocket, &TcpSocket::connected, [&](){clientConnectedSemaphore.release();});
+        QSemaphore receivedResponseSemaphore;
+        Object::connect(&clientSocket, &TcpSocket::receivedData, [&]()
+        {
+            if (clientSocket.peekAll().ends_with("Hello World 2"))
+            {
+                clientSocket.readAll();
+                receivedResponseSemaphore.release();
+            }
+        });
+        QSemaphore clientDisconnectedSemaphore;
+        Object::connect(&clientSocket, &TcpSocket::disconnected, [&](){clientDisconnectedSemaphore.release();});
+        Object::connect(&clientSocket, &TcpSocket::error, [](){Spectator::FAIL("This code is supposed to be unreachable.");});
+        clientSocket.connect(server.serverAddress().toString().toStdString(), server.serverPort());
+        REQUIRE(TRY_ACQUIRE(clientConnectedSemaphore, 10));
+
+        WHEN("client sends requests with bodies larger than the receive buffers of the ring")
+        {
+            const std::string body(64 * 1024, 'k');
+            std::string requests;
+            for (auto i = 0; i < 2; ++i)
+                requests.append("POST / HTTP/1.1\r\nHost: host\r\nContent-Length: ").append(std::to_string(body.size())).append("\r\n\r\n").append(body);
+            clientSocket.write(requests);
+
+            THEN("server receives all request data and responds to both requests on io_uring if the kernel supports it")
+            {
+                REQUIRE(TRY_ACQUIRE(receivedResponseSemaphore, 10));
+                REQUIRE(requestsHandledOnIoUring == (IoUring::isSupported() ? 2 : 0));
+
+                AND_WHEN("client disconnects from server")
+                {
+                    clientSocket.disconnectFromPeer();
+
+                    THEN("server closes the connection")
+                    {
+                        REQUIRE(TRY_ACQUIRE(clientDisconnectedSemaphore, 10));
+                        server.stop();
+                        REQUIRE(TRY_ACQUIRE(serverStoppedSemaphore, 10));
+                    }
+                }
+            }
+        }
+    }
+}
+
+
 SCENARIO("HttpServer does not timeout after a complete request is received")
 {
     GIVEN("a running server with request and idle timeouts and a connected client")
@@ -1790,3 +2030,295 @@ SCENARIO("HttpServer does not timeout after a complete request is received")
         }
     }
 }
+
+
+// Sends given request with a blocking OpenSSL client offering given session, if any, and reads the response
+// until it ends with given body. The request is sent as TLS 1.3 early data if the session allows it, and sent
+// again after the handshake if the server rejects the early data. Given session is replaced by the last
+// session the server issues. Client indicates given server name and presents given certificate, if any.
+struct TlsClientExchange
+{
+    std::string response;
+    int serverCertificateKeyType = EVP_PKEY_NONE;
+    bool isSessionResumed = false;
+    bool hasSentEarlyData = false;
+    bool isEarlyDataAccepted = false;
+};
+
+static TlsClientExchange exchangeOverTls(quint16 port,
+                                         TlsVersion tlsVersion,
+                                         std::string_view request,
+                                         std::string_view responseBody,
+                                         std::unique_ptr<SSL_SESSION, decltype(&SSL_SESSION_free)> &pSession,
+                                         const char *pServerName = nullptr,
+                                         const std::string &certificateFile = {},
+                                         const std::string &privateKeyFile = {})
+{
+    TlsClientExchange exchange;
+    std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> pContext(SSL_CTX_new(TLS_client_method()), &SSL_CTX_free);
+    if (!pContext)
+        return exchange;
+    const auto protocolVersion = (tlsVersion == TlsVersion::TLS_1_2) ? TLS1_2_VERSION : TLS1_3_VERSION;
+    SSL_CTX_set_min_proto_version(pContext.get(), protocolVersion);
+    SSL_CTX_set_max_proto_version(pContext.get(), protocolVersion);
+    SSL_CTX_set_verify(pContext.get(), SSL_VERIFY_NONE, nullptr);
+    if (!certificateFile.empty()
+        && (SSL_CTX_use_certificate_chain_file(pContext.get(), certificateFile.c_str()) != 1
+            || SSL_CTX_use_PrivateKey_file(pContext.get(), privateKeyFile.c_str(), SSL_FILETYPE_PEM) != 1))
+        return exchange;
+    const auto socketDescriptor = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (socketDescriptor < 0)
+        return exchange;
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    std::unique_ptr<SSL, decltype(&SSL_free)> pSSL(nullptr, &SSL_free);
+    if (::connect(socketDescriptor, (const sockaddr*)&address, sizeof(address)) == 0)
+        pSSL.reset(SSL_new(pContext.get()));
+    if (pSSL)
+    {
+        SSL_set_fd(pSSL.get(), socketDescriptor);
+        if (pServerName != nullptr)
+            SSL_set_tlsext_host_name(pSSL.get(), pServerName);
+        if (pSession)
+            SSL_set_session(pSSL.get(), pSession.get());
+        if (pSession && SSL_SESSION_get_max_early_data(pSession.get()) > 0)
+        {
+            size_t bytesWritten = 0;
+            exchange.hasSentEarlyData = (SSL_write_early_data(pSSL.get(), request.data(), request.size(), &bytesWritten) == 1)
+                                        && (bytesWritten == request.size());
+        }
+        if (SSL_connect(pSSL.get()) == 1)
+        {
+            exchange.isSessionResumed = (SSL_session_reused(pSSL.get()) == 1);
+            if (X509 *pCertificate = SSL_get0_peer_certificate(pSSL.get()); pCertificate != nullptr)
+                exchange.serverCertificateKeyType = EVP_PKEY_get_base_id(X509_get0_pubkey(pCertificate));
+            exchange.isEarlyDataAccepted = (SSL_get_early_data_status(pSSL.get()) == SSL_EARLY_DATA_ACCEPTED);
+            if (exchange.isEarlyDataAccepted || SSL_write(pSSL.get(), request.data(), int(request.size())) == int(request.size()))
+            {
+                char buffer[4096];
+                while (!exchange.response.ends_with(responseBody))
+                {
+                    const auto bytesRead = SSL_read(pSSL.get(), buffer, sizeof(buffer));
+                    if (bytesRead <= 0)
+                        break;
+                    exchange.response.append(buffer, bytesRead);
+                }
+            }
+            pSession.reset(SSL_get1_session(pSSL.get()));
+            SSL_shutdown(pSSL.get());
+        }
+    }
+    pSSL.reset();
+    ::close(socketDescriptor);
+    return exchange;
+}
+
+
+SCENARIO("HttpServer resumes TLS sessions and counts full and resumed handshakes")
+{
+    GIVEN("a running server that resumes sessions")
+    {
+        const auto tlsVersion = GENERATE(AS(TlsVersion), TlsVersion::TLS_1_2, TlsVersion::TLS_1_3);
+        const auto [usesSessionCache, usesSessionTickets] = GENERATE(AS(std::pair<bool, bool>),
+                                                                     {true, false},
+                                                                     {false, true});
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(TlsTestCertificates::CertificateType::ECDSA, certificateFile, privateKeyFile, caCertificateFile);
+        HttpServer server;
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.setTlsVersion(tlsVersion);
+        serverTlsConfiguration.setSessionCacheSize(usesSessionCache ? 64 : 0);
+        serverTlsConfiguration.setSessionTicketsEnabled(usesSessionTickets);
+        REQUIRE(server.setTlsConfiguration(serverTlsConfiguration));
+        REQUIRE(server.addRoute(HttpRequest::Method::GET, "/hello", [](const HttpRequest&, HttpBroker &broker){broker.writeResponse("Hello World");}));
+        QSemaphore serverStartedSemaphore;
+        QObject::connect(&server, &HttpServer::started, [&](){serverStartedSemaphore.release();});
+        QSemaphore serverStoppedSemaphore;
+        QObject::connect(&server, &HttpServer::stopped, [&](){serverStoppedSemaphore.release();});
+        QObject::connect(&server, &HttpServer::failed, [](){Spectator::FAIL("This code is supposed to be unreachable.");});
+        server.start(QHostAddress("127.0.0.1"), 0);
+        REQUIRE(TRY_ACQUIRE(serverStartedSemaphore, 10));
+        REQUIRE(server.fullTlsHandshakeCount() == 0);
+        REQUIRE(server.resumedTlsHandshakeCount() == 0);
+
+        WHEN("client connects three times offering the session issued on the previous connection")
+        {
+            std::unique_ptr<SSL_SESSION, decltype(&SSL_SESSION_free)> pSession(nullptr, &SSL_SESSION_free);
+            std::vector<bool> resumedSessions;
+            for (auto i = 0; i < 3; ++i)
+            {
+                const auto exchange = exchangeOverTls(server.serverPort(), tlsVersion, "GET /hello HTTP/1.1\r\nHost: host\r\n\r\n", "Hello World", pSession);
+                REQUIRE(exchange.response.starts_with("HTTP/1.1 200 OK\r\n"));
+                REQUIRE(exchange.response.ends_with("Hello World"));
+                REQUIRE(!exchange.hasSentEarlyData);
+                resumedSessions.push_back(exchange.isSessionResumed);
+            }
+
+            THEN("only the first connection performs a full handshake")
+            {
+                REQUIRE(resumedSessions == std::vector<bool>({false, true, true}));
+                REQUIRE(server.fullTlsHandshakeCount() == 1);
+                REQUIRE(server.resumedTlsHandshakeCount() == 2);
+                server.stop();
+                REQUIRE(TRY_ACQUIRE(serverStoppedSemaphore, 10));
+            }
+        }
+    }
+}
+
+
+SCENARIO("HttpServer verifies client certificates and resumes sessions per server name")
+{
+    GIVEN("a running server that requires client certificates, resumes sessions and has ECDSA certificates set for server names")
+    {
+        const auto tlsVersion = GENERATE(AS(TlsVersion), TlsVersion::TLS_1_2, TlsVersion::TLS_1_3);
+        const auto [usesSessionCache, usesSessionTickets] = GENERATE(AS(std::pair<bool, bool>),
+                                                                     {true, false},
+                                                                     {false, true});
+        std::string rsaCertificateFile;
+        std::string rsaPrivateKeyFile;
+        std::string rsaCaCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(TlsTestCertificates::CertificateType::RSA_2048, rsaCertificateFile, rsaPrivateKeyFile, rsaCaCertificateFile);
+        std::string ecdsaCertificateFile;
+        std::string ecdsaPrivateKeyFile;
+        std::string ecdsaCaCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(TlsTestCertificates::CertificateType::ECDSA, ecdsaCertificateFile, ecdsaPrivateKeyFile, ecdsaCaCertificateFile);
+        HttpServer server;
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(rsaCertificateFile, rsaPrivateKeyFile);
+        serverTlsConfiguration.addCaCertificate(rsaCaCertificateFile);
+        serverTlsConfiguration.setPeerVerifyMode(TlsConfiguration::PeerVerifyMode::On);
+        serverTlsConfiguration.setTlsVersion(tlsVersion);
+        serverTlsConfiguration.setSessionCacheSize(usesSessionCache ? 64 : 0);
+        serverTlsConfiguration.setSessionTicketsEnabled(usesSessionTickets);
+        REQUIRE(server.setTlsConfiguration(serverTlsConfiguration));
+        REQUIRE(server.addRoute(HttpRequest::Method::GET, "/hello", [](const HttpRequest&, HttpBroker &broker){broker.writeResponse("Hello World");}));
+        QSemaphore serverStartedSemaphore;
+        QObject::connect(&server, &HttpServer::started, [&](){serverStartedSemaphore.release();});
+        QSemaphore serverStoppedSemaphore;
+        QObject::connect(&server, &HttpServer::stopped, [&](){serverStoppedSemaphore.release();});
+        QObject::connect(&server, &HttpServer::failed, [](){Spectator::FAIL("This code is supposed to be unreachable.");});
+        server.start(QHostAddress("127.0.0.1"), 0);
+        REQUIRE(TRY_ACQUIRE(serverStartedSemaphore, 10));
+        REQUIRE(server.setSniCertificateKeyPair("exact.test.local", ecdsaCertificateFile, ecdsaPrivateKeyFile));
+        REQUIRE(server.setSniCertificateKeyPair("*.wildcard.test.local", ecdsaCertificateFile, ecdsaPrivateKeyFile));
+        const auto serverPort = server.serverPort();
+        const std::string_view request("GET /hello HTTP/1.1\r\nHost: host\r\n\r\n");
+
+        WHEN("clients indicating a server name with a certificate set connect with and without a client certificate")
+        {
+            std::unique_ptr<SSL_SESSION, decltype(&SSL_SESSION_free)> pSession(nullptr, &SSL_SESSION_free);
+            const auto exchangeWithCertificate = exchangeOverTls(serverPort, tlsVersion, request, "Hello World", pSession, "exact.test.local", rsaCertificateFile, rsaPrivateKeyFile);
+            pSession.reset();
+            const auto exchangeWithoutCertificate = exchangeOverTls(serverPort, tlsVersion, request, "Hello World", pSession, "exact.test.local");
+
+            THEN("server presents the certificate set for the name and only answers the client that presents a trusted certificate")
+            {
+                REQUIRE(exchangeWithCertificate.serverCertificateKeyType == EVP_PKEY_EC);
+                REQUIRE(exchangeWithCertificate.response.starts_with("HTTP/1.1 200 OK\r\n"));
+                REQUIRE(exchangeWithCertificate.response.ends_with("Hello World"));
+                REQUIRE(exchangeWithoutCertificate.response.empty());
+                server.stop();
+                REQUIRE(TRY_ACQUIRE(serverStoppedSemaphore, 10));
+            }
+        }
+
+        WHEN("client with a trusted certificate connects to several server names offering the session issued on the previous connection")
+        {
+            std::unique_ptr<SSL_SESSION, decltype(&SSL_SESSION_free)> pSession(nullptr, &SSL_SESSION_free);
+            std::vector<bool> resumedSessions;
+            std::vector<int> serverCertificateKeyTypes;
+            for (const auto *pServerName : {"exact.test.local", "EXACT.Test.Local", "host.wildcard.test.local", "other.wildcard.test.local", "exact.test.local", static_cast<const char*>(nullptr)})
+            {
+                const auto exchange = exchangeOverTls(serverPort, tlsVersion, request, "Hello World", pSession, pServerName, rsaCertificateFile, rsaPrivateKeyFile);
+                REQUIRE(exchange.response.starts_with("HTTP/1.1 200 OK\r\n"));
+                REQUIRE(exchange.response.ends_with("Hello World"));
+                resumedSessions.push_back(exchange.isSessionResumed);
+                serverCertificateKeyTypes.push_back(exchange.serverCertificateKeyType);
+            }
+
+            THEN("server only resumes sessions established under the certificate entry covering the indicated name")
+            {
+                REQUIRE(resumedSessions == std::vector<bool>({false, true, false, true, false, false}));
+                REQUIRE(serverCertificateKeyTypes == std::vector<int>({EVP_PKEY_EC, EVP_PKEY_EC, EVP_PKEY_EC, EVP_PKEY_EC, EVP_PKEY_EC, EVP_PKEY_RSA}));
+                server.stop();
+                REQUIRE(TRY_ACQUIRE(serverStoppedSemaphore, 10));
+            }
+        }
+    }
+}
+
+
+SCENARIO("HttpServer accepts TLS 1.3 early data once per cached session")
+{
+    GIVEN("a running TLS 1.3 server that accepts early data and has a route accepting early data and another that does not")
+    {
+        const auto route = GENERATE(AS(std::string), "early", "late");
+        std::string certificateFile;
+        std::string privateKeyFile;
+        std::string caCertificateFile;
+        TlsTestCertificates::getFilesFromCertificateType(TlsTestCertificates::CertificateType::ECDSA, certificateFile, privateKeyFile, caCertificateFile);
+        HttpServer server;
+        TlsConfiguration serverTlsConfiguration;
+        serverTlsConfiguration.setCertificateKeyPair(certificateFile, privateKeyFile);
+        serverTlsConfiguration.setTlsVersion(TlsVersion::TLS_1_3);
+        serverTlsConfiguration.setSessionCacheSize(64);
+        serverTlsConfiguration.setMaxEarlyDataSize(16384);
+        REQUIRE(server.setTlsConfiguration(serverTlsConfiguration));
+        REQUIRE(server.addRoute(HttpRequest::Method::GET, "/early", [](const HttpRequest&, HttpBroker &broker){broker.writeResponse("early");}, true));
+        REQUIRE(server.addRoute(HttpRequest::Method::GET, "/late", [](const HttpRequest&, HttpBroker &broker){broker.writeResponse("late");}));
+        QSemaphore serverStartedSemaphore;
+        QObject::connect(&server, &HttpServer::started, [&](){serverStartedSemaphore.release();});
+        QSemaphore serverStoppedSemaphore;
+        QObject::connect(&server, &HttpServer::stopped, [&](){serverStoppedSemaphore.release();});
+        QObject::connect(&server, &HttpServer::failed, [](){Spectator::FAIL("This code is supposed to be unreachable.");});
+        server.start(QHostAddress("127.0.0.1"), 0);
+        REQUIRE(TRY_ACQUIRE(serverStartedSemaphore, 10));
+        const auto serverPort = server.serverPort();
+        const auto request = std::string("GET /").append(route).append(" HTTP/1.1\r\nHost: host\r\n\r\n");
+        std::unique_ptr<SSL_SESSION, decltype(&SSL_SESSION_free)> pSession(nullptr, &SSL_SESSION_free);
+        const auto firstExchange = exchangeOverTls(serverPort, TlsVersion::TLS_1_3, request, route, pSession);
+        REQUIRE(firstExchange.response.ends_with(route));
+        REQUIRE(!firstExchange.hasSentEarlyData);
+        REQUIRE(pSession);
+        REQUIRE(SSL_SESSION_get_max_early_data(pSession.get()) == 16384);
+
+        WHEN("client resumes the session sending the request as early data")
+        {
+            std::unique_ptr<SSL_SESSION, decltype(&SSL_SESSION_free)> pReplayedSession(SSL_SESSION_dup(pSession.get()), &SSL_SESSION_free);
+            const auto exchange = exchangeOverTls(serverPort, TlsVersion::TLS_1_3, request, route, pSession);
+
+            THEN("server accepts the early data and responds to the request on both routes")
+            {
+                REQUIRE(exchange.hasSentEarlyData);
+                REQUIRE(exchange.isSessionResumed);
+                REQUIRE(exchange.isEarlyDataAccepted);
+                REQUIRE(exchange.response.starts_with("HTTP/1.1 200 OK\r\n"));
+                REQUIRE(exchange.response.ends_with(route));
+
+                AND_WHEN("client replays the early data with the same session")
+                {
+                    const auto replayedExchange = exchangeOverTls(serverPort, TlsVersion::TLS_1_3, request, route, pReplayedSession);
+
+                    THEN("server rejects the early data and the session, and responds to the request sent after the full handshake")
+                    {
+                        REQUIRE(replayedExchange.hasSentEarlyData);
+                        REQUIRE(!replayedExchange.isSessionResumed);
+                        REQUIRE(!replayedExchange.isEarlyDataAccepted);
+                        REQUIRE(replayedExchange.response.starts_with("HTTP/1.1 200 OK\r\n"));
+                        REQUIRE(replayedExchange.response.ends_with(route));
+                        REQUIRE(server.fullTlsHandshakeCount() == 2);
+                        REQUIRE(server.resumedTlsHandshakeCount() == 1);
+                        server.stop();
+                        REQUIRE(TRY_ACQUIRE(serverStoppedSemaphore, 10));
+                    }
+                }
+            }
+        }
+    }
+}
@@ -18,6 +18,7 @@
 #include "HttpServerOptions.h"
 #include "HttpRequestLimits.h"
 #include "HttpFieldBlock.h"
+#include "../Core/BufferPool.h"
 #include <QThread>
 
 
@@ -37,6 +38,12 @@ bool HttpServerOptions::setOption(HttpServer::ServerOption option, int64_t value
         case HttpServer::ServerOption::TcpServerBacklogSize:
         case HttpServer::ServerOption::IdleTimeoutInMSecs:
         case HttpServer::ServerOption::RequestTimeoutInMSecs:
+        case HttpServer::ServerOption::NativeEventLoop:
+        case HttpServer::ServerOption::NativeConnectionListener:
+        case HttpServer::ServerOption::WorkerCpuAffinity:
+        case HttpServer::ServerOption::BufferPoolLowWatermark:
+        case HttpServer::ServerOption::BufferPoolHighWatermark:
+        case HttpServer::ServerOption::IoUringBackend:
             break;
         case HttpServer::ServerOption::MaxUrlSize:
         case HttpServer::ServerOption::MaxHeaderNameSize:
@@ -111,6 +118,47 @@ bool HttpServerOptions::setOption(HttpServer::ServerOption option, int64_t value
             }
             else
                 break;
+        case HttpServer::ServerOption::NativeEventLoop:
+            if (value > 1)
+            {
+                m_errorMessage = "Failed to set native event loop option. Value must be either 0 or 1.";
+                return false;
+            }
+            else
+                break;
+        case HttpServer::ServerOption::NativeConnectionListener:
+            if (value > 1)
+            {
+                m_errorMessage = "Failed to set native connection listener option. Value must be either 0 or 1.";
+                return false;
+            }
+            else
+                break;
+        case HttpServer::ServerOption::WorkerCpuAffinity:
+            if (value > 2)
+            {
+                m_errorMessage = "Failed to set worker cpu affinity option. Value must be 0, 1 or 2.";
+                return false;
+            }
+            else
+                break;
+        case HttpServer::ServerOption::IoUringBackend:
+            if (value > 1)
+            {
+                m_errorMessage = "Failed to set io_uring backend option. Value must be either 0 or 1.";
+                return false;
+            }
+            else
+                break;
+        case HttpServer::ServerOption::BufferPoolLowWatermark:
+        case HttpServer::ServerOption::BufferPoolHighWatermark:
+            if (value > std::numeric_limits<int>::max())
+            {
+                m_errorMessage = std::string("Failed to set buffer pool watermark. Maximum possible value is ").append(std::to_string(std::numeric_limits<int>::max())).append(".");
+                return false;
+            }
+            else
+                break;
         case HttpServer::ServerOption::MaxUrlSize:
         case HttpServer::ServerOption::MaxChunkMetadataSize:
         case HttpServer::ServerOption::MaxRequestSize:
@@ -165,6 +213,15 @@ int64_t HttpServerOptions::defaultOptionValue(HttpServer::ServerOption option)
             return HttpRequestLimits().maxBodySize;
         case HttpServer::ServerOption::MaxConnectionCount:
             return 0;
+        case HttpServer::ServerOption::NativeEventLoop:
+        case HttpServer::ServerOption::NativeConnectionListener:
+        case HttpServer::ServerOption::WorkerCpuAffinity:
+        case HttpServer::ServerOption::IoUringBackend:
+            return 0;
+        case HttpServer::ServerOption::BufferPoolLowWatermark:
+            return BufferPool::defaultLowWatermark();
+        case HttpServer::ServerOption::BufferPoolHighWatermark:
+            return BufferPool::defaultHighWatermark();
         default:
             Q_UNREACHABLE();
     }
@@ -179,6 +236,8 @@ int64_t HttpServerOptions::maxOptionValue(HttpServer::ServerOption option)
         case HttpServer::ServerOption::TcpServerBacklogSize:
         case HttpServer::ServerOption::IdleTimeoutInMSecs:
         case HttpServer::ServerOption::RequestTimeoutInMSecs:
+        case HttpServer::ServerOption::BufferPoolLowWatermark:
+        case HttpServer::ServerOption::BufferPoolHighWatermark:
             return std::numeric_limits<int>::max();
         case HttpServer::ServerOption::MaxHeaderNameSize:
         case HttpServer::ServerOption::MaxTrailerNameSize:
@@ -195,6 +254,12 @@ int64_t HttpServerOptions::maxOptionValue(HttpServer::ServerOption option)
         case HttpServer::ServerOption::MaxBodySize:
         case HttpServer::ServerOption::MaxConnectionCount:
             return std::numeric_limits<int64_t>::max();
+        case HttpServer::ServerOption::NativeEventLoop:
+        case HttpServer::ServerOption::NativeConnectionListener:
+        case HttpServer::ServerOption::IoUringBackend:
+            return 1;
+        case HttpServer::ServerOption::WorkerCpuAffinity:
+            return 2;
         default:
             Q_UNREACHABLE();
     }
@@ -50,7 +50,13 @@ SCENARIO("HttpServerOptions returns default option values")
                                          HttpServer::ServerOption::MaxChunkMetadataSize,
                                          HttpServer::ServerOption::MaxRequestSize,
                                          HttpServer::ServerOption::MaxBodySize,
-                                         HttpServer::ServerOption::MaxConnectionCount);
+                                         HttpServer::ServerOption::MaxConnectionCount,
+                                         HttpServer::ServerOption::NativeEventLoop,
+                                         HttpServer::ServerOption::NativeConnectionListener,
+                                         HttpServer::ServerOption::WorkerCpuAffinity,
+                                         HttpServer::ServerOption::BufferPoolLowWatermark,
+                                         HttpServer::ServerOption::BufferPoolHighWatermark,
+                                         HttpServer::ServerOption::IoUringBackend);
             const auto optionValue = serverOptions.getOption(option);
 
             THEN("instance returns expected default value")
@@ -85,7 +91,13 @@ SCENARIO("HttpServerOptions does not accept negative values")
                                          HttpServer::ServerOption::MaxChunkMetadataSize,
                                          HttpServer::ServerOption::MaxRequestSize,
                                          HttpServer::ServerOption::MaxBodySize,
-                                         HttpServer::ServerOption::MaxConnectionCount);
+                                         HttpServer::ServerOption::MaxConnectionCount,
+                                         HttpServer::ServerOption::NativeEventLoop,
+                                         HttpServer::ServerOption::NativeConnectionListener,
+                                         HttpServer::ServerOption::WorkerCpuAffinity,
+                                         HttpServer::ServerOption::BufferPoolLowWatermark,
+                                         HttpServer::ServerOption::BufferPoolHighWatermark,
+                                         HttpServer::ServerOption::IoUringBackend);
             const auto value = GENERATE(AS(int64_t), -1, -52, std::numeric_limits<int64_t>::min() + 1, std::numeric_limits<int64_t>::min());
             const auto succeededToSetNegativeValue = serverOptions.setOption(option, value);
 
@@ -121,7 +133,13 @@ SCENARIO("HttpServerOptions sets maximum option values for request limits and ma
                                          {HttpServer::ServerOption::MaxChunkMetadataSize, true},
                                          {HttpServer::ServerOption::MaxRequestSize, true},
                                          {HttpServer::ServerOption::MaxBodySize, true},
-                                         {HttpServer::ServerOption::MaxConnectionCount, true});
+                                         {HttpServer::ServerOption::MaxConnectionCount, true},
+                                         {HttpServer::ServerOption::NativeEventLoop, false},
+                                         {HttpServer::ServerOption::NativeConnectionListener, false},
+                                         {HttpServer::ServerOption::WorkerCpuAffinity, false},
+                                         {HttpServer::ServerOption::BufferPoolLowWatermark, false},
+                                         {HttpServer::ServerOption::BufferPoolHighWatermark, false},
+                                         {HttpServer::ServerOption::IoUringBackend, false});
             const auto succeeded = serverOptions.setOption(option.first, 0);
             const auto optionValue = serverOptions.getOption(option.first);
 
@@ -361,3 +379,81 @@ SCENARIO("HttpServerOptions does not allow header/trailer line counts greater th
         }
     }
 }
+
+
+SCENARIO("HttpServerOptions only accepts 0 or 1 for boolean options")
+{
+    GIVEN("an HttpServerOptions instance")
+    {
+        HttpServerOptions serverOptions;
+        const auto optionToSet = GENERATE(AS(HttpServer::ServerOption),
+                                          HttpServer::ServerOption::NativeEventLoop,
+                                          HttpServer::ServerOption::NativeConnectionListener,
+                                          HttpServer::ServerOption::IoUringBackend);
+
+        WHEN("either 0 or 1 is set for the option")
+        {
+            const auto value = GENERATE(AS(int64_t), 0, 1);
+            REQUIRE(serverOptions.errorMessage().empty());
+            const auto succeeded = serverOptions.setOption(optionToSet, value);
+
+            THEN("HttpServerOptions succeeds to set the option")
+            {
+                REQUIRE(succeeded);
+                REQUIRE(serverOptions.errorMessage().empty());
+                REQUIRE(value == serverOptions.getOption(optionToSet));
+            }
+        }
+
+        WHEN("a value greater than 1 is set for the option")
+        {
+            const auto value = GENERATE(AS(int64_t), 2, 3, 1024, int64_t(1) << 40);
+            REQUIRE(serverOptions.errorMessage().empty());
+            const auto succeeded = serverOptions.setOption(optionToSet, value);
+
+            THEN("HttpServerOptions fails to set the option")
+            {
+                REQUIRE(!succeeded);
+                REQUIRE(!serverOptions.errorMessage().empty());
+                REQUIRE(HttpServerOptions::defaultOptionValue(optionToSet) == serverOptions.getOption(optionToSet));
+            }
+        }
+    }
+}
+
+
+SCENARIO("HttpServerOptions only accepts 0, 1 or 2 for worker cpu affinity option")
+{
+    GIVEN("an HttpServerOptions instance")
+    {
+        HttpServerOptions serverOptions;
+
+        WHEN("a value between 0 and 2 is set for worker cpu affinity")
+        {
+            const auto value = GENERATE(AS(int64_t), 0, 1, 2);
+            REQUIRE(serverOptions.errorMessage().empty());
+            const auto succeeded = serverOptions.setOption(HttpServer::ServerOption::WorkerCpuAffinity, value);
+
+            THEN("HttpServerOptions succeeds to set worker cpu affinity")
+            {
+                REQUIRE(succeeded);
+                REQUIRE(serverOptions.errorMessage().empty());
+                REQUIRE(value == serverOptions.getOption(HttpServer::ServerOption::WorkerCpuAffinity));
+            }
+        }
+
+        WHEN("a value greater than 2 is set for worker cpu affinity")
+        {
+            const auto value = GENERATE(AS(int64_t), 3, 8, 1024);
+            REQUIRE(serverOptions.errorMessage().empty());
+            const auto succeeded = serverOptions.setOption(HttpServer::ServerOption::WorkerCpuAffinity, value);
+
+            THEN("HttpServerOptions fails to set worker cpu affinity")
+            {
+                REQUIRE(!succeeded);
+                REQUIRE(!serverOptions.errorMessage().empty());
+                REQUIRE(HttpServerOptions::defaultOptionValue(HttpServer::ServerOption::WorkerCpuAffinity) == serverOptions.getOption(HttpServer::ServerOption::WorkerCpuAffinity));
+            }
+        }
+    }
+}
@@ -30,7 +30,8 @@ namespace Kourier
 
 HttpServerPrivate::HttpServerPrivate(HttpServer *pServer) :
     q_ptr(pServer),
-    m_connectionCount(new std::atomic_size_t(0))
+    m_connectionCount(new std::atomic_size_t(0)),
+    m_pTlsCertificateStore(new TlsCertificateStore)
 {
     assert(q_ptr);
 }
@@ -40,9 +41,9 @@ bool HttpServerPrivate::isRunning() const
     return (m_pServer && m_pServer->state() != ExecutionState::Stopped);
 }
 
-bool HttpServerPrivate::addRoute(HttpRequest::Method method, std::string_view path, void (*pFcn)(const HttpRequest&, HttpBroker&))
+bool HttpServerPrivate::addRoute(HttpRequest::Method method, std::string_view path, void (*pFcn)(const HttpRequest&, HttpBroker&), bool acceptsEarlyData)
 {
-    if (m_requestRouter.addRoute(method, path, pFcn))
+    if (m_requestRouter.addRoute(method, path, pFcn, acceptsEarlyData))
         return true;
     else
     {
@@ -92,7 +93,8 @@ void HttpServerPrivate::start(QHostAddress address, quint16 port)
     }
     m_serverAddress = address;
     m_serverPort = port;
-    m_pServer.reset(new Server(std::shared_ptr<ServerWorkerFactory>(new HttpServerWorkerFactory(m_options, m_requestRouter, m_tlsConfiguration, m_pErrorHandler))));
+    m_pBufferPoolRegistry.reset(new BufferPoolRegistry);
+    m_pServer.reset(new Server(std::shared_ptr<ServerWorkerFactory>(new HttpServerWorkerFactory(m_options, m_requestRouter, m_tlsConfiguration, m_pErrorHandler, m_pBufferPoolRegistry, m_pTlsCertificateStore))));
     m_pServer->setWorkerCount(m_options.getOption(HttpServer::ServerOption::WorkerCount));
     QObject::connect(m_pServer.get(), &Server::started, this, &HttpServerPrivate::onServerStarted);
     QObject::connect(m_pServer.get(), &Server::stopped, this, &HttpServerPrivate::onServerStopped);
@@ -110,12 +112,42 @@ bool HttpServerPrivate::setTlsConfiguration(const TlsConfiguration &tlsConfigura
 {
     auto response = TlsContext::validateTlsConfiguration(tlsConfiguration, TlsContext::Role::Server);
     if (response.first)
+    {
         m_tlsConfiguration = tlsConfiguration;
+        m_pTlsSessionCache = TlsSessionCache::fromTlsConfiguration(tlsConfiguration, true);
+    }
     else
         m_errorMessage = response.second;
     return response.first;
 }
 
+bool HttpServerPrivate::setSniCertificateKeyPair(std::string_view serverName, std::string_view certificate, std::string_view key, std::string_view keyPassword)
+{
+    try
+    {
+        m_pTlsCertificateStore->setCertificateKeyPair(serverName, certificate, key, keyPassword);
+        return true;
+    }
+    catch (const RuntimeError &runtimeError)
+    {
+        m_errorMessage = runtimeError.error();
+        if (m_errorMessage.empty())
+            m_errorMessage = std::string("Failed to add certificate for server name ").append(serverName).append(". Unknown TLS error.");
+        return false;
+    }
+}
+
+bool HttpServerPrivate::removeSniCertificateKeyPair(std::string_view serverName)
+{
+    if (m_pTlsCertificateStore->removeCertificateKeyPair(serverName))
+        return true;
+    else
+    {
+        m_errorMessage = std::string("Failed to remove certificate for server name ").append(serverName).append(". No certificate is set for given server name.");
+        return false;
+    }
+}
+
 void Kourier::HttpServerPrivate::setErrorHandler(std::shared_ptr<ErrorHandler> pErrorHandler)
 {
     m_pErrorHandler = pErrorHandler;
@@ -22,6 +22,9 @@
 #include "HttpServerOptions.h"
 #include "HttpRequestRouter.h"
 #include "ErrorHandler.h"
+#include "../Core/TlsSessionCache.h"
+#include "../Core/TlsCertificateStore.h"
+#include "../Core/BufferPool.h"
 #include "../Server/Server.h"
 #include <QObject>
 #include <QPointer>
@@ -41,17 +44,23 @@ public:
     HttpServerPrivate(HttpServer *pServer);
     ~HttpServerPrivate() override = default;
     bool isRunning() const;
-    bool addRoute(HttpRequest::Method method, std::string_view path, void(*pFcn)(const HttpRequest&, HttpBroker&));
+    bool addRoute(HttpRequest::Method method, std::string_view path, void(*pFcn)(const HttpRequest&, HttpBroker&), bool acceptsEarlyData);
     bool setOption(HttpServer::ServerOption option, int64_t value);
     int64_t getOption(HttpServer::ServerOption option) const;
     void start(QHostAddress address, quint16 port);
     void stop();
     std::string_view errorMessage() const {return m_errorMessage;}
     bool setTlsConfiguration(const TlsConfiguration &tlsConfiguration);
+    bool setSniCertificateKeyPair(std::string_view serverName, std::string_view certificate, std::string_view key, std::string_view keyPassword);
+    bool removeSniCertificateKeyPair(std::string_view serverName);
+    size_t sniCertificateCount() const {return m_pTlsCertificateStore->size();}
     void setErrorHandler(std::shared_ptr<ErrorHandler> pErrorHandler);
     QHostAddress serverAddress() const {return m_serverAddress;}
     quint16 serverPort() const {return m_serverPort;}
     size_t connectionCount() const {return m_connectionCount->load();}
+    size_t fullTlsHandshakeCount() const {return m_pTlsSessionCache ? m_pTlsSessionCache->fullHandshakeCount() : 0;}
+    size_t resumedTlsHandshakeCount() const {return m_pTlsSessionCache ? m_pTlsSessionCache->resumedHandshakeCount() : 0;}
+    std::vector<BufferPool::Statistics> workerMemoryStatistics() const {return m_pBufferPoolRegistry ? m_pBufferPoolRegistry->statistics() : std::vector<BufferPool::Statistics>{};}
 
 private:
     void setError(std::string_view errorMessage);
@@ -69,6 +78,9 @@ private:
     std::string m_errorMessage;
     std::unique_ptr<Server> m_pServer;
     TlsConfiguration m_tlsConfiguration;
+    std::shared_ptr<TlsSessionCache> m_pTlsSessionCache;
+    const std::shared_ptr<TlsCertificateStore> m_pTlsCertificateStore;
+    std::shared_ptr<BufferPoolRegistry> m_pBufferPoolRegistry;
     QHostAddress m_serverAddress;
     quint16 m_serverPort = 0;
     Q_DISABLE_COPY_MOVE(HttpServerPrivate)
@@ -22,8 +22,12 @@
 #include "ErrorHandler.h"
 #include "../Core/TlsConfiguration.h"
 #include "../Core/UnixSignalListener.h"
+#include "../Core/CpuAffinity.h"
+#include "../Core/BufferPool.h"
+#include "../Core/EpollEventNotifier.h"
 #include "../Server/ServerWorker.h"
 #include "../Server/QTcpServerBasedConnectionListener.h"
+#include "../Server/EpollConnectionListener.h"
 #include "../Server/ConnectionHandlerRepository.h"
 
 namespace Kourier
@@ -36,17 +40,67 @@ public:
     HttpServerWorker(const HttpServerOptions &httpServerOptions,
                      const HttpRequestRouter &httpRequestRouter,
                      const TlsConfiguration &tlsConfiguration,
-                     std::shared_ptr<ErrorHandler> pErrorHandler = {}) :
-        ServerWorker(std::shared_ptr<ConnectionListener>(new QTcpServerBasedConnectionListener),
-                     std::shared_ptr<ConnectionHandlerFactory>(new HttpConnectionHandlerFactory(httpServerOptions, httpRequestRouter, tlsConfiguration, pErrorHandler)),
-                     std::shared_ptr<ConnectionHandlerRepository>(new ConnectionHandlerRepository))
+                     std::shared_ptr<ErrorHandler> pErrorHandler = {},
+                     int cpu = -1,
+                     std::shared_ptr<BufferPoolRegistry> pBufferPoolRegistry = {},
+                     std::shared_ptr<TlsCertificateStore> pTlsCertificateStore = {}) :
+        HttpServerWorker(setUpCurrentThread(httpServerOptions, cpu),
+                         httpServerOptions,
+                         httpRequestRouter,
+                         tlsConfiguration,
+                         pErrorHandler,
+                         cpu,
+                         pBufferPoolRegistry,
+                         pTlsCertificateStore)
     {
-        UnixSignalListener::blockSignalProcessingForCurrentThread();
     }
 
     ~HttpServerWorker() override = default;
 
 private:
+    struct CurrentThreadSetUp {};
+    HttpServerWorker(CurrentThreadSetUp,
+                     const HttpServerOptions &httpServerOptions,
+                     const HttpRequestRouter &httpRequestRouter,
+                     const TlsConfiguration &tlsConfiguration,
+                     std::shared_ptr<ErrorHandler> pErrorHandler,
+                     int cpu,
+                     std::shared_ptr<BufferPoolRegistry> pBufferPoolRegistry,
+                     std::shared_ptr<TlsCertificateStore> pTlsCertificateStore) :
+        ServerWorker(createConnectionListener(httpServerOptions, cpu),
+                     std::shared_ptr<ConnectionHandlerFactory>(new HttpConnectionHandlerFactory(httpServerOptions, httpRequestRouter, tlsConfiguration, pErrorHandler, pTlsCertificateStore)),
+                     std::shared_ptr<ConnectionHandlerRepository>(new ConnectionHandlerRepository))
+    {
+        UnixSignalListener::blockSignalProcessingForCurrentThread();
+        BufferPool::threadInstance()->setWatermarks(httpServerOptions.getOption(HttpServer::ServerOption::BufferPoolLowWatermark),
+                                                     httpServerOptions.getOption(HttpServer::ServerOption::BufferPoolHighWatermark));
+        if (pBufferPoolRegistry)
+            pBufferPoolRegistry->add(BufferPool::sharedThreadInstance());
+    }
+
+    static CurrentThreadSetUp setUpCurrentThread(const HttpServerOptions &httpServerOptions, int cpu)
+    {
+        // This is the first code to run on the worker's thread, as the delegating constructor
+        // evaluates it before any base or member is initialized. The thread is pinned first so that
+        // the io_uring instance, the listener, the connection handler factory and all connections
+        // are allocated on the cpu's local NUMA node. The thread then switches to io_uring before
+        // the listener and any connection register their operations.
+        if (cpu >= 0 && !CpuAffinity::pinCurrentThread(cpu))
+            qWarning("Failed to pin server worker to cpu %d.", cpu);
+        if (httpServerOptions.getOption(HttpServer::ServerOption::IoUringBackend) == 1
+            && !EpollEventNotifier::enableIoUringOnCurrentThread())
+            qWarning("Failed to enable io_uring backend. Server worker uses epoll.");
+        return {};
+    }
+
+    static std::shared_ptr<ConnectionListener> createConnectionListener(const HttpServerOptions &httpServerOptions, int cpu)
+    {
+        if (httpServerOptions.getOption(HttpServer::ServerOption::NativeConnectionListener) == 0)
+            return std::shared_ptr<ConnectionListener>(new QTcpServerBasedConnectionListener);
+        else
+            return std::shared_ptr<ConnectionListener>(new EpollConnectionListener(cpu));
+    }
+
     Q_DISABLE_COPY_MOVE(HttpServerWorker);
 };
 
@@ -18,6 +18,8 @@
 #include "HttpServerWorkerFactory.h"
 #include "HttpServerWorker.h"
 #include "../Server/AsyncServerWorker.h"
+#include "../Core/EpollEventDispatcher.h"
+#include "../Core/CpuAffinity.h"
 
 
 namespace Kourier
@@ -26,21 +28,44 @@ namespace Kourier
 HttpServerWorkerFactory::HttpServerWorkerFactory(const HttpServerOptions &httpServerOptions,
                                                  const HttpRequestRouter &httpRequestRouter,
                                                  const TlsConfiguration &tlsConfiguration,
-                                                 std::shared_ptr<ErrorHandler> pErrorHandler) :
+                                                 std::shared_ptr<ErrorHandler> pErrorHandler,
+                                                 std::shared_ptr<BufferPoolRegistry> pBufferPoolRegistry,
+                                                 std::shared_ptr<TlsCertificateStore> pTlsCertificateStore) :
     m_options(httpServerOptions),
     m_requestRouter(httpRequestRouter),
     m_tlsConfiguration(tlsConfiguration),
-    m_pErrorHandler(pErrorHandler)
+    m_pErrorHandler(pErrorHandler),
+    m_pBufferPoolRegistry(pBufferPoolRegistry),
+    m_pTlsCertificateStore(pTlsCertificateStore)
 {
+    switch (m_options.getOption(HttpServer::ServerOption::WorkerCpuAffinity))
+    {
+        case 1:
+            m_workerCpus = CpuAffinity::allowedCpus();
+            break;
+        case 2:
+            m_workerCpus = CpuAffinity::numaSpreadCpus();
+            break;
+        default:
+            break;
+    }
 }
 
 std::shared_ptr<ServerWorker> HttpServerWorkerFactory::create()
 {
-    return std::shared_ptr<ServerWorker>(new AsyncServerWorker<HttpServerWorker,
-                                                               const HttpServerOptions &,
-                                                               const HttpRequestRouter &,
-                                                               const TlsConfiguration &,
-                                                               std::shared_ptr<ErrorHandler>>(m_options, m_requestRouter, m_tlsConfiguration, m_pErrorHandler));
+    using T_AsyncHttpServerWorker = AsyncServerWorker<HttpServerWorker,
+                                                      const HttpServerOptions &,
+                                                      const HttpRequestRouter &,
+                                                      const TlsConfiguration &,
+                                                      std::shared_ptr<ErrorHandler>,
+                                                      int,
+                                                      std::shared_ptr<BufferPoolRegistry>,
+                                                      std::shared_ptr<TlsCertificateStore>>;
+    const int cpu = m_workerCpus.empty() ? -1 : m_workerCpus[m_createdWorkerCount++ % m_workerCpus.size()];
+    if (m_options.getOption(HttpServer::ServerOption::NativeEventLoop) == 0)
+        return std::shared_ptr<ServerWorker>(new T_AsyncHttpServerWorker(m_options, m_requestRouter, m_tlsConfiguration, m_pErrorHandler, cpu, m_pBufferPoolRegistry, m_pTlsCertificateStore));
+    else
+        return std::shared_ptr<ServerWorker>(new T_AsyncHttpServerWorker(new EpollEventDispatcher, m_options, m_requestRouter, m_tlsConfiguration, m_pErrorHandler, cpu, m_pBufferPoolRegistry, m_pTlsCertificateStore));
 }
 
 }
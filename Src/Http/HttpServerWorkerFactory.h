@@ -22,8 +22,11 @@
 #include "HttpRequestRouter.h"
 #include "ErrorHandler.h"
 #include "../Core/TlsConfiguration.h"
+#include "../Core/BufferPool.h"
+#include "../Core/TlsCertificateStore.h"
 #include "../Server/ServerWorkerFactory.h"
 #include <QHostAddress>
+#include <vector>
 
 
 namespace Kourier
@@ -35,7 +38,9 @@ public:
     HttpServerWorkerFactory(const HttpServerOptions &httpServerOptions,
                             const HttpRequestRouter &httpRequestRouter,
                             const TlsConfiguration &tlsConfiguration,
-                            std::shared_ptr<ErrorHandler> pErrorHandler = {});
+                            std::shared_ptr<ErrorHandler> pErrorHandler = {},
+                            std::shared_ptr<BufferPoolRegistry> pBufferPoolRegistry = {},
+                            std::shared_ptr<TlsCertificateStore> pTlsCertificateStore = {});
     ~HttpServerWorkerFactory() override = default;
     std::shared_ptr<ServerWorker> create() override;
 
@@ -44,6 +49,10 @@ private:
     const HttpRequestRouter m_requestRouter;
     const TlsConfiguration m_tlsConfiguration;
     const std::shared_ptr<ErrorHandler> m_pErrorHandler;
+    const std::shared_ptr<BufferPoolRegistry> m_pBufferPoolRegistry;
+    const std::shared_ptr<TlsCertificateStore> m_pTlsCertificateStore;
+    std::vector<int> m_workerCpus;
+    size_t m_createdWorkerCount = 0;
     Q_DISABLE_COPY_MOVE(HttpServerWorkerFactory);
 };
 
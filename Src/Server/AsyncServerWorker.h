@@ -51,12 +51,12 @@ public:
     AsyncServerWorker(Args... args) :
         m_worker(args...)
     {
-        if (m_worker.get())
-        {
-            QObject::connect(m_worker.get(), &ServerWorker::started, this, &AsyncServerWorker::onAsyncServerWorkerStarted, Qt::QueuedConnection);
-            QObject::connect(m_worker.get(), &ServerWorker::stopped, this, &AsyncServerWorker::onAsyncServerWorkerStopped, Qt::QueuedConnection);
-            QObject::connect(m_worker.get(), &ServerWorker::failed, this, &AsyncServerWorker::onAsyncServerWorkerFailed, Qt::QueuedConnection);
-        }
+        connectToWorker();
+    }
+    AsyncServerWorker(QAbstractEventDispatcher *pEventDispatcher, Args... args) :
+        m_worker(pEventDispatcher, args...)
+    {
+        connectToWorker();
     }
     ~AsyncServerWorker() override = default;
     ExecutionState state() const override {return m_state;}
@@ -96,6 +96,16 @@ private:
         }
     }
 
+    void connectToWorker()
+    {
+        if (m_worker.get())
+        {
+            QObject::connect(m_worker.get(), &ServerWorker::started, this, &AsyncServerWorker::onAsyncServerWorkerStarted, Qt::QueuedConnection);
+            QObject::connect(m_worker.get(), &ServerWorker::stopped, this, &AsyncServerWorker::onAsyncServerWorkerStopped, Qt::QueuedConnection);
+            QObject::connect(m_worker.get(), &ServerWorker::failed, this, &AsyncServerWorker::onAsyncServerWorkerFailed, Qt::QueuedConnection);
+        }
+    }
+
 private:
     void onAsyncServerWorkerStartedImpl() override
     {
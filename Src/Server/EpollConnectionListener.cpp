@@ -0,0 +1,306 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "EpollConnectionListener.h"
+#include "../Core/EpollEventSource.h"
+#include "../Core/NoDestroy.h"
+#include "../Core/UnixUtils.h"
+#include <QDeadlineTimer>
+#include <QHostAddress>
+#include <QMutex>
+#include <QThread>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+
+namespace Kourier
+{
+
+class EpollConnectionListenerEventSource : public EpollEventSource
+{
+KOURIER_OBJECT(Kourier::EpollConnectionListenerEventSource)
+public:
+    EpollConnectionListenerEventSource(EpollConnectionListener *pListener, qintptr socketDescriptor) :
+        EpollEventSource(EPOLLIN),
+        m_pListener(pListener),
+        m_socketDescriptor(socketDescriptor)
+    {
+        assert(m_pListener && m_socketDescriptor >= 0);
+        m_acceptedSockets.reserve(maxAcceptBatchSize);
+    }
+    ~EpollConnectionListenerEventSource() override = default;
+    int64_t fileDescriptor() const override {return m_socketDescriptor;}
+    inline void detachFromListener() {m_pListener = nullptr;}
+    void start();
+    void stop();
+
+private:
+    void onEvent(uint32_t epollEvents) override;
+    void onCompletion(int32_t result, uint32_t flags) override;
+
+private:
+    static constexpr size_t maxAcceptBatchSize = 128;
+    EpollConnectionListener *m_pListener;
+    const qintptr m_socketDescriptor;
+    std::vector<qintptr> m_acceptedSockets;
+};
+
+void EpollConnectionListenerEventSource::onEvent(uint32_t epollEvents)
+{
+    // The socket is level-triggered. Batches are bounded so that a connection storm
+    // does not starve other event sources, and any connection left in the
+    // backlog is accepted on the next event loop iteration.
+    m_acceptedSockets.clear();
+    while (m_acceptedSockets.size() < maxAcceptBatchSize)
+    {
+        const auto socketDescriptor = ::accept4(m_socketDescriptor, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (socketDescriptor >= 0)
+            m_acceptedSockets.push_back(socketDescriptor);
+        else if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO)
+            continue;
+        else
+            break;
+    }
+    for (const auto socketDescriptor : m_acceptedSockets)
+    {
+        // Listener can be deleted by a slot connected to newConnection.
+        if (m_pListener)
+            m_pListener->newConnection(socketDescriptor);
+        else
+            UnixUtils::safeClose(socketDescriptor);
+    }
+    m_acceptedSockets.clear();
+}
+
+// On threads that use io_uring, connections are accepted with a multishot accept
+// on the ring and the listening socket is not registered on the epoll instance.
+void EpollConnectionListenerEventSource::start()
+{
+    if (!startAccept())
+        setEnabled(true);
+}
+
+void EpollConnectionListenerEventSource::stop()
+{
+    cancelRingOperation();
+    setEnabled(false);
+}
+
+void EpollConnectionListenerEventSource::onCompletion(int32_t result, uint32_t flags)
+{
+    if (result >= 0)
+    {
+        if (m_pListener)
+            m_pListener->newConnection(result);
+        else
+            UnixUtils::safeClose(result);
+    }
+    // The kernel ends multishot accepts on errors other than the ones of aborted connections.
+    if (!(flags & IORING_CQE_F_MORE) && m_pListener)
+        startAccept();
+}
+
+EpollConnectionListener::EpollConnectionListener(int incomingCpu) :
+    m_incomingCpu(incomingCpu)
+{
+}
+
+EpollConnectionListener::~EpollConnectionListener()
+{
+    if (m_pEventSource)
+    {
+        m_pEventSource->stop();
+        m_pEventSource->detachFromListener();
+        m_pEventSource->scheduleForDeletion();
+    }
+    if (m_socketDescriptor >= 0)
+        UnixUtils::safeClose(m_socketDescriptor);
+}
+
+bool EpollConnectionListener::start(QVariant data)
+{
+    if (m_hasAlreadyStarted)
+    {
+        m_errorMessage = "Failed to start connection listener. Connection listener has already started.";
+        return false;
+    }
+    m_hasAlreadyStarted = true;
+    if (data.typeId() != QMetaType::QVariantMap)
+    {
+        m_errorMessage = "Failed to start connection listener. Given data is not a QVariantMap.";
+        return false;
+    }
+    const auto variantMap = data.toMap();
+    if (variantMap.contains("backlogSize"))
+    {
+        if (variantMap["backlogSize"].typeId() != QMetaType::Int)
+        {
+            m_errorMessage = "Failed to start connection listener. Given backlogSize must be an integer.";
+            return false;
+        }
+        const auto backlogSize = variantMap["backlogSize"].toInt();
+        if (backlogSize <= 0)
+        {
+            m_errorMessage = "Failed to start connection listener. Given backlogSize is not a positive integer.";
+            return false;
+        }
+        else
+            m_backlogSize = backlogSize;
+    }
+    if (variantMap.contains("socketDescriptor"))
+    {
+        if (variantMap["socketDescriptor"].typeId() != qMetaTypeId<qintptr>())
+        {
+            m_errorMessage = "Failed to start connection listener. Given socketDescriptor must be a qintptr.";
+            return false;
+        }
+        const auto socketDescriptor = variantMap["socketDescriptor"].value<qintptr>();
+        int isListening = 0;
+        socklen_t optionSize = sizeof(isListening);
+        if (socketDescriptor < 0
+            || getsockopt(socketDescriptor, SOL_SOCKET, SO_ACCEPTCONN, &isListening, &optionSize) != 0
+            || !isListening)
+        {
+            m_errorMessage = "Failed to start connection listener. Given socketDescriptor is not a listening socket.";
+            return false;
+        }
+        const auto flags = fcntl(socketDescriptor, F_GETFL);
+        if (flags == -1 || fcntl(socketDescriptor, F_SETFL, flags | O_NONBLOCK) == -1)
+        {
+            m_errorMessage = "Failed to start connection listener. Failed to make given socketDescriptor non-blocking.";
+            return false;
+        }
+        m_socketDescriptor = socketDescriptor;
+        startAccepting();
+        return true;
+    }
+    if (!variantMap.contains("address"))
+    {
+        m_errorMessage = "Failed to start connection listener. Given data does not contain an address.";
+        return false;
+    }
+    if (!variantMap.contains("port"))
+    {
+        m_errorMessage = "Failed to start connection listener. Given data does not contain a port.";
+        return false;
+    }
+    if (variantMap["address"].typeId() != QMetaType::QByteArray)
+    {
+        m_errorMessage = "Failed to start connection listener. Given address must be a QByteArray.";
+        return false;
+    }
+    if (variantMap["port"].typeId() != QMetaType::UShort)
+    {
+        m_errorMessage = "Failed to start connection listener. Given port must be a quint16.";
+        return false;
+    }
+    const auto port = variantMap["port"].value<quint16>();
+    if (port == 0)
+    {
+        m_errorMessage = "Failed to start connection listener. Given port must be positive.";
+        return false;
+    }
+    if (!createListeningSocket(variantMap["address"].toByteArray(), port))
+        return false;
+    startAccepting();
+    return true;
+}
+
+bool EpollConnectionListener::createListeningSocket(QByteArray address, quint16 port)
+{
+    const QHostAddress hostAddress(QString::fromLatin1(address));
+    if (hostAddress.isNull())
+    {
+        m_errorMessage = "Failed to start connection listener. Given address is not valid.";
+        return false;
+    }
+    struct sockaddr_storage addr{0};
+    int domain;
+    if (hostAddress.protocol() == QHostAddress::IPv4Protocol)
+    {
+        domain = AF_INET;
+        auto *addr4 = (struct sockaddr_in *) &addr;
+        addr4->sin_family = AF_INET;
+        addr4->sin_addr.s_addr = htonl(hostAddress.toIPv4Address());
+        addr4->sin_port = htons(port);
+    }
+    else
+    {
+        domain = AF_INET6;
+        auto *addr6 = (struct sockaddr_in6 *) &addr;
+        addr6->sin6_family = AF_INET6;
+        auto qtIpv6Addr = hostAddress.toIPv6Address();
+        memcpy(&addr6->sin6_addr.s6_addr, &qtIpv6Addr, sizeof(qtIpv6Addr));
+        addr6->sin6_port = htons(port);
+    }
+    static NoDestroy<QMutex> mutex;
+    QMutexLocker locker(&mutex());
+    const int socketFd = socket(domain, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (socketFd < 0)
+    {
+        m_errorMessage = "Failed to create listening socket.";
+        return false;
+    }
+    // Each worker owns a listening socket bound to the same address/port and the
+    // kernel load balances incoming connections among them.
+    const int option = 1;
+    if (setsockopt(socketFd, SOL_SOCKET, SO_REUSEPORT, &option, sizeof(option)))
+    {
+        UnixUtils::safeClose(socketFd);
+        m_errorMessage = "Failed to set SO_REUSEPORT option on socket.";
+        return false;
+    }
+    // Makes the kernel prefer this socket among the reuseport group for connections
+    // whose packets are processed on the cpu this listener's worker is pinned to.
+    if (m_incomingCpu >= 0 && setsockopt(socketFd, SOL_SOCKET, SO_INCOMING_CPU, &m_incomingCpu, sizeof(m_incomingCpu)))
+    {
+        UnixUtils::safeClose(socketFd);
+        m_errorMessage = "Failed to set SO_INCOMING_CPU option on socket.";
+        return false;
+    }
+    QDeadlineTimer deadlineTimer(20000);
+    while(bind(socketFd, (struct sockaddr *) &addr, sizeof(addr)) && !deadlineTimer.hasExpired())
+        QThread::msleep(5);
+    if (deadlineTimer.hasExpired())
+    {
+        UnixUtils::safeClose(socketFd);
+        m_errorMessage = "Failed to bind receive socket";
+        return false;
+    }
+    if (listen(socketFd, m_backlogSize))
+    {
+        UnixUtils::safeClose(socketFd);
+        m_errorMessage = "Failed to make socket listen for connections.";
+        return false;
+    }
+    m_socketDescriptor = socketFd;
+    return true;
+}
+
+void EpollConnectionListener::startAccepting()
+{
+    assert(m_socketDescriptor >= 0 && !m_pEventSource);
+    m_pEventSource = new EpollConnectionListenerEventSource(this, m_socketDescriptor);
+    m_pEventSource->start();
+}
+
+}
@@ -0,0 +1,57 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_EPOLL_CONNECTION_LISTENER_H
+#define KOURIER_EPOLL_CONNECTION_LISTENER_H
+
+#include "ConnectionListener.h"
+#include <string>
+
+
+namespace Kourier
+{
+class EpollConnectionListenerEventSource;
+
+class EpollConnectionListener : public ConnectionListener
+{
+KOURIER_OBJECT(Kourier::EpollConnectionListener)
+public:
+    EpollConnectionListener(int incomingCpu = -1);
+    EpollConnectionListener(const EpollConnectionListener&) = delete;
+    EpollConnectionListener &operator=(const EpollConnectionListener&) = delete;
+    ~EpollConnectionListener() override;
+    bool start(QVariant data) override;
+    std::string_view errorMessage() const override {return m_errorMessage;}
+    int backlogSize() const override {return m_backlogSize;}
+    qintptr socketDescriptor() const override {return m_socketDescriptor;}
+
+private:
+    bool createListeningSocket(QByteArray address, quint16 port);
+    void startAccepting();
+
+private:
+    EpollConnectionListenerEventSource *m_pEventSource = nullptr;
+    std::string m_errorMessage;
+    const int m_incomingCpu;
+    qintptr m_socketDescriptor = -1;
+    int m_backlogSize = 50;
+    bool m_hasAlreadyStarted = false;
+};
+
+}
+
+#endif // KOURIER_EPOLL_CONNECTION_LISTENER_H
@@ -0,0 +1,40 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_TEST_RESOURCES_ALLOCATION_COUNTER_H
+#define KOURIER_TEST_RESOURCES_ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+
+namespace Kourier::TestResources
+{
+
+// Calls to malloc and operator new made by code linked into the benchmarks binary are wrapped at link
+// time (see Src/Tests/Benchmarks/CMakeLists.txt and the wrappers in Object.bench.cpp). The allocator
+// itself is left untouched, and calls are only counted on the thread measuring between start and stop.
+struct AllocationCounter
+{
+    static inline thread_local bool isCounting = false;
+    static inline thread_local size_t count = 0;
+    static void start() {count = 0; isCounting = true;}
+    static size_t stop() {isCounting = false; return count;}
+};
+
+}
+
+#endif // KOURIER_TEST_RESOURCES_ALLOCATION_COUNTER_H
@@ -43,6 +43,7 @@ int main(int argc, char ** argv)
     cmdLineParser.addOption({"request-timeout", "Server responds with HTTP 408 Request Timeout and closes connection if requests are not fully received in <interval> seconds. The default value of 0 disables request timeout.", "interval", "0"});
     cmdLineParser.addOption({"idle-timeout", "Server responds with HTTP 408 Request Timeout and closes connection if connection stays idle for <interval> seconds. The default value of 0 disables idle timeout", "interval", "0"});
     cmdLineParser.addOption({"enable-tls", "Server enables TLS if this option is set. This option does not accept any value."});
+    cmdLineParser.addOption({"io-uring", "Server workers use the io_uring backend if this option is set. Workers fall back to epoll if the kernel does not support the required io_uring features. This option does not accept any value."});
     cmdLineParser.process(app);
     const QHostAddress address(cmdLineParser.value("a"));
     if (address.isNull())
@@ -61,6 +62,7 @@ int main(int argc, char ** argv)
     if (!conversionSucceeded)
         cmdLineParser.showHelp(1);
     const bool enableTls = cmdLineParser.isSet("enable-tls");
+    const bool useIoUring = cmdLineParser.isSet("io-uring");
     HttpServer server;
     if (!server.setServerOption(HttpServer::ServerOption::WorkerCount, workerCount))
         qFatal("Failed to set worker count. %s", !server.errorMessage().empty() ? server.errorMessage().data() : "");
@@ -68,6 +70,8 @@ int main(int argc, char ** argv)
         qFatal("Failed to set request timeout. %s", !server.errorMessage().empty() ? server.errorMessage().data() : "");
     if (!server.setServerOption(HttpServer::ServerOption::IdleTimeoutInSecs, idleTimeoutInSecs))
         qFatal("Failed to set idle timeout. %s", !server.errorMessage().empty() ? server.errorMessage().data() : "");
+    if (!server.setServerOption(HttpServer::ServerOption::IoUringBackend, useIoUring ? 1 : 0))
+        qFatal("Failed to set io_uring backend. %s", !server.errorMessage().empty() ? server.errorMessage().data() : "");
     if (!server.addRoute(HttpRequest::Method::GET, "/", [](const HttpRequest &, HttpBroker &broker){broker.writeResponse("Hello World!");}))
         qFatal("Failed to add default route to server. %s", !server.errorMessage().empty() ? server.errorMessage().data() : "");
     if (enableTls)
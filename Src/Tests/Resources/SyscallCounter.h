@@ -0,0 +1,65 @@
+//
+// Copyright (C) 2025 Glauco Pacheco <glaucopacheco@gmail.com>
+// SPDX-License-Identifier: AGPL-3.0-only
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, version 3 of the License.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef KOURIER_TEST_RESOURCES_SYSCALL_COUNTER_H
+#define KOURIER_TEST_RESOURCES_SYSCALL_COUNTER_H
+
+#include <atomic>
+#include <cstddef>
+
+
+namespace Kourier::TestResources
+{
+
+// Socket syscalls made by Kourier code are wrapped at link time in the benchmarks binary (see
+// Src/Tests/Benchmarks/CMakeLists.txt and the wrappers in TcpSocket.bench.cpp). Calls targeting the
+// tracked file descriptor are counted by kind. Sends are also counted on every socket, except those made
+// by excluded threads, so that benchmarks running clients in-process can count what a server sends.
+struct SyscallCounter
+{
+    static inline std::atomic_int trackedFileDescriptor = -1;
+    static inline std::atomic_size_t ioctlCount = 0;
+    static inline std::atomic_size_t readCount = 0;
+    static inline std::atomic_size_t writeCount = 0;
+    static inline std::atomic_size_t epollCtlCount = 0;
+    static inline std::atomic_size_t sendCount = 0;
+    static inline thread_local bool isCurrentThreadExcluded = false;
+    static void reset(int fileDescriptor)
+    {
+        trackedFileDescriptor = fileDescriptor;
+        ioctlCount = 0;
+        readCount = 0;
+        writeCount = 0;
+        epollCtlCount = 0;
+    }
+    static size_t totalCount() {return ioctlCount + readCount + writeCount + epollCtlCount;}
+    static void count(int fileDescriptor, std::atomic_size_t &counter)
+    {
+        if (fileDescriptor >= 0 && fileDescriptor == trackedFileDescriptor)
+            ++counter;
+    }
+    static void excludeCurrentThread() {isCurrentThreadExcluded = true;}
+    static void countSend()
+    {
+        if (!isCurrentThreadExcluded)
+            sendCount.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+}
+
+#endif // KOURIER_TEST_RESOURCES_SYSCALL_COUNTER_H